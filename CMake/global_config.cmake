@@ -35,6 +35,7 @@ macro(global_set_flags)
 
     if (BUILD_EASYLOGGINGPP)
         add_definitions(-DBUILD_EASYLOGGINGPP)
+        add_definitions(-DLOG_COMPILED_SEVERITY=RS2_LOG_SEVERITY_${LOG_COMPILED_SEVERITY})
     endif()
 
     if(TRACE_API)
@@ -95,6 +96,32 @@ macro(global_target_config)
             $<INSTALL_INTERFACE:include>
             PRIVATE ${USB_INCLUDE_DIRS}
     )
+
+    if(BUILD_WITH_TURBOJPEG)
+        find_path(TURBOJPEG_INCLUDE_DIR turbojpeg.h)
+        find_library(TURBOJPEG_LIBRARY NAMES turbojpeg turbojpeg-static)
+        if(TURBOJPEG_INCLUDE_DIR AND TURBOJPEG_LIBRARY)
+            message(STATUS "Decoding MJPEG with libjpeg-turbo: ${TURBOJPEG_LIBRARY}")
+            target_compile_definitions(${LRS_TARGET} PRIVATE RS2_USE_TURBOJPEG)
+            target_include_directories(${LRS_TARGET} PRIVATE ${TURBOJPEG_INCLUDE_DIR})
+            target_link_libraries(${LRS_TARGET} PRIVATE ${TURBOJPEG_LIBRARY})
+        else()
+            message(STATUS "libjpeg-turbo not found; decoding MJPEG with the built-in decoder")
+        endif()
+    endif()
+
+    if(BUILD_WITH_ZSTD)
+        find_path(ZSTD_INCLUDE_DIR zstd.h)
+        find_library(ZSTD_LIBRARY NAMES zstd zstd_static)
+        if(ZSTD_INCLUDE_DIR AND ZSTD_LIBRARY)
+            message(STATUS "Adding the zstd depth codec: ${ZSTD_LIBRARY}")
+            target_compile_definitions(${LRS_TARGET} PRIVATE RS2_USE_ZSTD)
+            target_include_directories(${LRS_TARGET} PRIVATE ${ZSTD_INCLUDE_DIR})
+            target_link_libraries(${LRS_TARGET} PRIVATE ${ZSTD_LIBRARY})
+        else()
+            message(STATUS "libzstd not found; building without the zstd depth codec")
+        endif()
+    endif()
 endmacro()
 
 macro(add_tm2)
@@ -3,9 +3,12 @@ option(BUILD_WITH_CUDA "Enable CUDA" OFF)
 option(BUILD_GRAPHICAL_EXAMPLES "Build graphical examples and tools. Implies BUILD_GLSL_EXTENSIONS" ON)
 option(BUILD_GLSL_EXTENSIONS "Build GLSL extensions API" ON)
 option(BUILD_WITH_OPENMP "Use OpenMP" OFF)
-option(ENABLE_ZERO_COPY "Enable zero copy functionality" OFF)
+option(BUILD_WITH_TURBOJPEG "Decode MJPEG with libjpeg-turbo when it is installed" ON)
+option(BUILD_WITH_ZSTD "Add the zstd depth codec when libzstd is installed" OFF)
+option(ENABLE_ZERO_COPY "Lend V4L2 buffers to Z16, Y8 and Y16 frames instead of copying them" OFF)
 option(BUILD_WITH_TM2 "Build with support for Intel TM2 tracking device" ON)
 option(BUILD_EASYLOGGINGPP "Build EasyLogging++ as a part of the build" ON)
+set(LOG_COMPILED_SEVERITY "DEBUG" CACHE STRING "Least severe log messages built into the library: DEBUG, INFO, WARN, ERROR, FATAL or NONE")
 option(BUILD_WITH_STATIC_CRT "Build with static link CRT" ON)
 option(HWM_OVER_XU "Send HWM commands over UVC XU control" ON)
 option(BUILD_SHARED_LIBS "Build shared library" ON)
@@ -93,6 +93,8 @@ extern "C" {
         RS2_OPTION_AMBIENT_LIGHT, /**< Change the depth ambient light see rs2_ambient_light for values */
         RS2_OPTION_SENSOR_MODE, /**< The resolution mode: see rs2_sensor_mode for values */
         RS2_OPTION_EMITTER_ALWAYS_ON, /**< Enable Laser On constantly (GS SKU Only) */
+        RS2_OPTION_PROCESSING_THREADS, /**< Maximum number of threads a processing block may use on a single frame, 0 for as many as the shared pool has */
+        RS2_OPTION_OCCLUSION_MASK, /**< Output the mask of the pixels the pointcloud occlusion removal invalidated along with the points */
         RS2_OPTION_COUNT /**< Number of enumeration values. Not a valid input: intended to be used in for-loops. */
     } rs2_option;
 
@@ -42,6 +42,30 @@ rs2_processing_block* rs2_create_sync_processing_block(rs2_error** error);
 */
 rs2_processing_block* rs2_create_pointcloud(rs2_error** error);
 
+/** \brief How rs2_pointcloud_calculate_vertices lays out the vertices it writes. */
+typedef enum rs2_vertex_layout
+{
+    RS2_VERTEX_LAYOUT_XYZ32F,       /**< x, y and z of each vertex in 32-bit floats, as in the vertices of a points frame */
+    RS2_VERTEX_LAYOUT_PLANAR32F,    /**< All x in 32-bit floats, followed by all y, then all z */
+    RS2_VERTEX_LAYOUT_XYZ16F,       /**< x, y and z of each vertex in 16-bit half-precision floats, rounded to nearest even */
+    RS2_VERTEX_LAYOUT_COUNT
+} rs2_vertex_layout;
+
+const char* rs2_vertex_layout_to_string(rs2_vertex_layout layout);
+
+/**
+* Calculates the vertices of a depth frame straight into a buffer of the caller, without allocating a points frame.
+* The vertices are those the pointcloud block outputs for the frame, one per depth pixel, in meters. No texture coordinates are calculated
+* \param[in]  block     A pointcloud processing block
+* \param[in]  depth     Z16 depth frame
+* \param[in]  layout    Layout of the vertices in the buffer
+* \param[out] buffer    Receives the vertices
+* \param[in]  size      Size of the buffer in bytes, at least the number of depth pixels times 12 bytes, or 6 for half-precision vertices
+* \param[out] error     If non-null, receives any error that occurs during this call, otherwise, errors are ignored
+* \return               Number of vertices written
+*/
+int rs2_pointcloud_calculate_vertices(rs2_processing_block* block, const rs2_frame* depth, rs2_vertex_layout layout, void* buffer, int size, rs2_error** error);
+
 /**
 * Creates YUY decoder processing block. This block accepts raw YUY frames and outputs frames of other formats.
 * YUY is a common video format used by a variety of web-cams. It benefits from packing pixels into 2 bytes per pixel
@@ -229,6 +253,17 @@ rs2_processing_block* rs2_create_disparity_transform_block(unsigned char transfo
 */
 rs2_processing_block* rs2_create_hole_filling_filter_block(rs2_error** error);
 
+/**
+* Creates a block running the given depth post-processing filters as one, in a single pass over the frame where the
+* filters allow, and giving the same frames the filters would one after the other. The filters go in the order decimation,
+* depth to disparity, spatial, temporal, disparity to depth, hole filling, any of them left out, and keep their options
+* \param[in] filters   the filter blocks, still owned by the caller
+* \param[in] count     number of filters
+* \param[out] error    if non-null, receives any error that occurs during this call, otherwise, errors are ignored
+* \return              the post-processing block
+*/
+rs2_processing_block* rs2_create_depth_post_processing_block(rs2_processing_block** filters, int count, rs2_error** error);
+
 /**
 * Creates a rates printer block. The printer prints the actual FPS of the invoked frame stream.
 * The block ignores reapiting frames and calculats the FPS only if the frame number of the relevant frame was changed.
@@ -251,6 +286,46 @@ rs2_processing_block* rs2_create_zero_order_invalidation_block(rs2_error** error
 */
 rs2_processing_block* rs2_create_huffman_depth_decompress_block(rs2_error** error);
 
+/**
+* Creates a depth encoder block. Z16 depth frames come out as Z16C frames of the same width and height, encoded losslessly
+* behind a header naming their codec. Every codec given encodes the first frame, and again every 30 frames and whenever the
+* frame size changes, and the one giving the smallest frame encodes the frames that follow
+* \param[in] codecs    comma-separated names of the codecs to encode with, in order of preference: rvl, bitplane, lz4, and zstd
+*                      when the library is built with it. Null or empty for all of them
+* \param[out] error    If non-null, receives any error that occurs during this call, otherwise, errors are ignored
+* \return              depth encoder processing block
+*/
+rs2_processing_block* rs2_create_depth_encoder_block(const char* codecs, rs2_error** error);
+
+/**
+* Creates a depth decoder block, taking Z16C frames of any codec back to Z16 depth
+* \param[out] error    If non-null, receives any error that occurs during this call, otherwise, errors are ignored
+* \return              depth decoder processing block
+*/
+rs2_processing_block* rs2_create_depth_decoder_block(rs2_error** error);
+
+/**
+* Encodes Z16 depth as Z16C frames hold it, for transports of buffers rather than frames
+* \param[in]  codecs   comma-separated names of codecs, as for rs2_create_depth_encoder_block. The first available encodes
+* \param[in]  src      count 16-bit depth values
+* \param[in]  count    number of depth values
+* \param[out] dst      the encoded depth, at least 2 * count + 12 bytes
+* \param[in]  dst_size size of dst in bytes
+* \param[out] error    If non-null, receives any error that occurs during this call, otherwise, errors are ignored
+* \return              size of the encoded depth in bytes
+*/
+int rs2_encode_depth(const char* codecs, const void* src, int count, void* dst, int dst_size, rs2_error** error);
+
+/**
+* Decodes depth rs2_encode_depth or a depth encoder block encoded, of any codec
+* \param[in]  src      the encoded depth
+* \param[in]  size     size of src in bytes
+* \param[out] dst      count 16-bit depth values
+* \param[in]  count    number of depth values, which must be that of the encoded depth
+* \param[out] error    If non-null, receives any error that occurs during this call, otherwise, errors are ignored
+*/
+void rs2_decode_depth(const void* src, int size, void* dst, int count, rs2_error** error);
+
 /**
 * Retrieve processing block specific information, like name.
 * \param[in]  block     The processing block
@@ -29,6 +29,48 @@ const char* rs2_playback_status_to_string(rs2_playback_status status);
 
 typedef void (*rs2_playback_status_changed_callback_ptr)(rs2_playback_status);
 
+/** \brief What a recording device does with frames that arrive while its write queue is full. */
+typedef enum rs2_record_overflow_policy
+{
+    RS2_RECORD_OVERFLOW_POLICY_BLOCK,          /**< Hold the sensor callback until the queue has room. No frame is lost by the recorder, while the sensors that share the thread of the callback are held too */
+    RS2_RECORD_OVERFLOW_POLICY_DROP_FRAMES,    /**< Drop the frames that do not fit in the queue and keep recording. This is the default */
+    RS2_RECORD_OVERFLOW_POLICY_STOP_RECORDING, /**< Stop recording the sensor and raise an error notification, while streaming continues */
+    RS2_RECORD_OVERFLOW_POLICY_COUNT
+} rs2_record_overflow_policy;
+
+const char* rs2_record_overflow_policy_to_string(rs2_record_overflow_policy policy);
+
+/** \brief Write queue counters of a recording device. */
+typedef struct rs2_record_statistics
+{
+    int                queued_frames;    /**< Number of frames waiting to be written */
+    unsigned long long queued_bytes;     /**< Frame data waiting to be written, in bytes */
+    unsigned long long dropped_frames;   /**< Number of frames the overflow policy turned away */
+    unsigned long long written_frames;   /**< Number of frames written to the file */
+    unsigned long long written_bytes;    /**< Frame data written to the file, in bytes, before compression */
+    double             bytes_per_second; /**< Recent rate of frame data written to the file, before compression */
+} rs2_record_statistics;
+
+typedef void (*rs2_playback_batch_frame_callback_ptr)(rs2_frame* frame, int file_index, void* user);
+
+/** \brief Overall progress of a batch playback. */
+typedef struct rs2_playback_batch_progress
+{
+    int                files_done;        /**< Number of files read to the end or failed */
+    int                files_failed;      /**< Number of files that could not be opened or read */
+    unsigned long long frames;            /**< Number of frames handed to the callback */
+    double             frames_per_second; /**< Frames handed to the callback per second since the batch started */
+} rs2_playback_batch_progress;
+
+/** \brief Progress of one file of a batch playback. */
+typedef struct rs2_playback_batch_file_progress
+{
+    unsigned long long position; /**< Timestamp of the last data read, in nanoseconds from the start of the file */
+    unsigned long long duration; /**< Length of the file in nanoseconds, 0 until the file is opened */
+    unsigned long long frames;   /**< Number of frames of this file handed to the callback */
+    int                done;     /**< Non-zero once the file was read to the end or failed */
+} rs2_playback_batch_file_progress;
+
 /**
  * Creates a recording device to record the given device and save it to the given file
  * \param[in]  device    The device to record
@@ -71,6 +113,23 @@ void rs2_record_device_resume(const rs2_device* device, rs2_error** error);
 */
 const char* rs2_record_device_filename(const rs2_device* device, rs2_error** error);
 
+/**
+* Sets how much frame data the recorder may hold before it is written, and what happens to frames arriving past that
+* \param[in]  device              A recording device
+* \param[in]  policy              What to do with a frame that does not fit in the queue
+* \param[in]  max_queued_bytes    Queue size in bytes. A frame larger than the whole queue is still accepted when the queue is empty
+* \param[out] error               If non-null, receives any error that occurs during this call, otherwise, errors are ignored
+*/
+void rs2_record_device_set_overflow_policy(const rs2_device* device, rs2_record_overflow_policy policy, unsigned long long max_queued_bytes, rs2_error** error);
+
+/**
+* Retrieves the write queue depth and throughput of the recorder
+* \param[in]  device      A recording device
+* \param[out] statistics  Receives the queue and write counters since the recorder was created
+* \param[out] error       If non-null, receives any error that occurs during this call, otherwise, errors are ignored
+*/
+void rs2_record_device_get_statistics(const rs2_device* device, rs2_record_statistics* statistics, rs2_error** error);
+
 /**
 * Creates a playback device to play the content of the given file
 * \param[in]  file      Path to the file to play
@@ -186,6 +245,83 @@ void rs2_playback_device_set_playback_speed(const rs2_device* device, float spee
 */
 void rs2_playback_device_stop(const rs2_device* device, rs2_error** error);
 
+/**
+ * Creates a batch playback of several recorded files, for offline processing.
+ * Unlike a playback device, a batch playback is not paced by the recorded timestamps: every frame of every
+ * file is handed to the callback, as fast as the callback returns, and no frame is dropped.
+ * Up to max_concurrent_files files are read at the same time, on the library's shared thread pool,
+ * and the files start in the order of the list.
+ * \param[in]  ctx                   Context to create the playback devices with
+ * \param[in]  files                 Paths of the files to play
+ * \param[in]  count                 Number of files
+ * \param[in]  max_concurrent_files  Number of files read at the same time, 0 for the number of threads of the library's thread pool
+ * \param[out] error                 If non-null, receives any error that occurs during this call, otherwise, errors are ignored
+ * \return A batch playback to start with rs2_playback_batch_start and release with rs2_delete_playback_batch
+ */
+rs2_playback_batch* rs2_create_playback_batch(rs2_context* ctx, const char** files, int count, int max_concurrent_files, rs2_error** error);
+
+/**
+ * Stops a batch playback if still running, and releases it
+ * \param[in] batch  Batch playback to delete
+ */
+void rs2_delete_playback_batch(rs2_playback_batch* batch);
+
+/**
+ * Starts reading the files of a batch playback.
+ * The frames of one file reach the callback in the order they were recorded, one at a time, while frames of
+ * different files may reach it concurrently from different threads. The callback owns the frame it is given
+ * and should release it with rs2_release_frame. Reading a file waits for the callback, so holding on to
+ * frames does not make the playback drop any.
+ * \param[in]  batch     Batch playback to start
+ * \param[in]  callback  Invoked with each frame read, and the index of its file in the list
+ * \param[in]  user      Passed to the callback
+ * \param[out] error     If non-null, receives any error that occurs during this call, otherwise, errors are ignored
+ */
+void rs2_playback_batch_start(rs2_playback_batch* batch, rs2_playback_batch_frame_callback_ptr callback, void* user, rs2_error** error);
+
+/**
+ * Waits for every file of a started batch playback to be read to the end, or to fail
+ * \param[in]  batch       A started batch playback
+ * \param[in]  timeout_ms  Maximum time to wait, in milliseconds
+ * \param[out] error       If non-null, receives any error that occurs during this call, otherwise, errors are ignored
+ * \return Non-zero if the batch is done, 0 if the timeout expired first
+ */
+int rs2_playback_batch_wait(rs2_playback_batch* batch, unsigned int timeout_ms, rs2_error** error);
+
+/**
+ * Stops reading the files of a batch playback, and returns once no more frames will reach the callback.
+ * Files not read to the end are reported as failed. Must not be called from the callback
+ * \param[in]  batch  A batch playback
+ * \param[out] error  If non-null, receives any error that occurs during this call, otherwise, errors are ignored
+ */
+void rs2_playback_batch_stop(rs2_playback_batch* batch, rs2_error** error);
+
+/**
+ * Retrieves the overall progress of a batch playback
+ * \param[in]  batch     A batch playback
+ * \param[out] progress  Receives the progress
+ * \param[out] error     If non-null, receives any error that occurs during this call, otherwise, errors are ignored
+ */
+void rs2_playback_batch_get_progress(const rs2_playback_batch* batch, rs2_playback_batch_progress* progress, rs2_error** error);
+
+/**
+ * Retrieves the progress of one file of a batch playback
+ * \param[in]  batch       A batch playback
+ * \param[in]  file_index  Index of the file in the list the batch was created with
+ * \param[out] progress    Receives the progress
+ * \param[out] error       If non-null, receives any error that occurs during this call, otherwise, errors are ignored
+ */
+void rs2_playback_batch_get_file_progress(const rs2_playback_batch* batch, int file_index, rs2_playback_batch_file_progress* progress, rs2_error** error);
+
+/**
+ * Retrieves the reason a file of a batch playback failed
+ * \param[in]  batch       A batch playback
+ * \param[in]  file_index  Index of the file in the list the batch was created with
+ * \param[out] error       If non-null, receives any error that occurs during this call, otherwise, errors are ignored
+ * \return The error message, empty if the file did not fail. Valid until the batch is deleted
+ */
+const char* rs2_playback_batch_get_file_error(const rs2_playback_batch* batch, int file_index, rs2_error** error);
+
 #ifdef __cplusplus
 }
 #endif
@@ -87,6 +87,7 @@ typedef enum rs2_format
     RS2_FORMAT_INVI            , /**< 8-bit IR stream.  */
     RS2_FORMAT_W10             , /**< Grey-scale image as a bit-packed array. 4 pixel data stream taking 5 bytes */
     RS2_FORMAT_Z16H            , /**< Variable-length Huffman-compressed 16-bit depth values. */
+    RS2_FORMAT_Z16C            , /**< 16-bit depth values encoded losslessly, each frame by the codec named in its header. */
     RS2_FORMAT_COUNT             /**< Number of enumeration values. Not a valid input: intended to be used in for-loops. */
 } rs2_format;
 const char* rs2_format_to_string(rs2_format format);
@@ -276,6 +277,24 @@ void rs2_set_notifications_callback(const rs2_sensor* sensor, rs2_notification_c
 */
 void rs2_set_notifications_callback_cpp(const rs2_sensor* sensor, rs2_notifications_callback* callback, rs2_error** error);
 
+/**
+* set the allocator used for the frame buffers of the specified sensor. The sensor must be closed; the allocator takes effect when it is next opened
+* \param[in] sensor      RealSense sensor
+* \param[in] on_allocate function pointer returning a buffer of at least the requested size in bytes, or null on failure
+* \param[in] on_release  function pointer releasing a buffer previously returned by on_allocate
+* \param[in] user        auxiliary data passed to both functions
+* \param[out] error      if non-null, receives any error that occurs during this call, otherwise, errors are ignored
+*/
+void rs2_set_frame_allocator(const rs2_sensor* sensor, rs2_frame_allocate_ptr on_allocate, rs2_frame_release_ptr on_release, void* user, rs2_error** error);
+
+/**
+* retrieve frame buffer pool counters of the specified sensor
+* \param[in] sensor      RealSense sensor
+* \param[out] statistics receives the pool hits, misses and high-water mark since the sensor was created, across the allocators set on it. Buffers in use are counted for the current allocator only
+* \param[out] error      if non-null, receives any error that occurs during this call, otherwise, errors are ignored
+*/
+void rs2_get_frame_pool_statistics(const rs2_sensor* sensor, rs2_frame_pool_statistics* statistics, rs2_error** error);
+
 /**
 * retrieve description from notification handle
 * \param[in] notification      handle returned from a callback
@@ -9,6 +9,8 @@
 #ifndef LIBREALSENSE_RS2_TYPES_H
 #define LIBREALSENSE_RS2_TYPES_H
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -117,6 +119,17 @@ typedef struct rs2_pose
     unsigned int    mapper_confidence;    /**< Pose map confidence 0x0 - Failed, 0x1 - Low, 0x2 - Medium, 0x3 - High                                      */
 } rs2_pose;
 
+/** \brief Frame buffer pool counters of a single sensor. */
+typedef struct rs2_frame_pool_statistics
+{
+    unsigned long long hits;            /**< Number of frame buffers served from the pool */
+    unsigned long long misses;          /**< Number of frame buffers that had to be requested from the allocator */
+    unsigned long long bytes_allocated; /**< Total number of bytes requested from the allocator */
+    int                in_use;          /**< Number of frame buffers currently held by frames */
+    int                high_water_mark; /**< Maximal number of frame buffers held by frames at the same time */
+    unsigned long long bypasses;        /**< Number of the misses due to every size class of the pool being taken by other sizes */
+} rs2_frame_pool_statistics;
+
 /** \brief Severity of the librealsense logger. */
 typedef enum rs2_log_severity {
     RS2_LOG_SEVERITY_DEBUG, /**< Detailed information about ordinary operations */
@@ -230,6 +243,7 @@ typedef struct rs2_frame_callback rs2_frame_callback;
 typedef struct rs2_log_callback rs2_log_callback;
 typedef struct rs2_syncer rs2_syncer;
 typedef struct rs2_device_serializer rs2_device_serializer;
+typedef struct rs2_playback_batch rs2_playback_batch;
 typedef struct rs2_source rs2_source;
 typedef struct rs2_processing_block rs2_processing_block;
 typedef struct rs2_frame_processor_callback rs2_frame_processor_callback;
@@ -251,6 +265,8 @@ typedef void (*rs2_devices_changed_callback_ptr)(rs2_device_list*, rs2_device_li
 typedef void (*rs2_frame_callback_ptr)(rs2_frame*, void*);
 typedef void (*rs2_frame_processor_callback_ptr)(rs2_frame*, rs2_source*, void*);
 typedef void(*rs2_update_progress_callback_ptr)(const float, void*);
+typedef void* (*rs2_frame_allocate_ptr)(size_t, void*);
+typedef void (*rs2_frame_release_ptr)(void*, size_t, void*);
 
 typedef double      rs2_time_t;     /**< Timestamp format. units are milliseconds */
 typedef long long   rs2_metadata_type; /**< Metadata attribute type is defined as 64 bit signed integer*/
@@ -88,6 +88,7 @@ namespace rs2
     class pipeline;
     class device_hub;
     class software_device;
+    class playback_batch;
 
     /**
     * default librealsense context class
@@ -214,6 +215,7 @@ namespace rs2
         friend class rs2::pipeline;
         friend class rs2::device_hub;
         friend class rs2::software_device;
+        friend class rs2::playback_batch;
 
         std::shared_ptr<rs2_context> _context;
     };
@@ -269,5 +271,106 @@ namespace rs2
         std::shared_ptr<rs2_device_hub> _device_hub;
     };
 
+    /**
+    * playback_batch class - plays several recorded files for offline processing, handing every frame of
+    * every file to a callback as fast as the callback takes them, with no pacing and no dropped frames
+    */
+    class playback_batch
+    {
+    public:
+        /**
+        * \param[in] ctx                   Context to create the playback devices with
+        * \param[in] files                 Paths of the files to play, started in this order
+        * \param[in] max_concurrent_files  Number of files read at the same time, 0 for the number of threads of the library's thread pool
+        */
+        playback_batch(context ctx, const std::vector<std::string>& files, int max_concurrent_files = 0)
+            : _callback(std::make_shared<std::function<void(frame, int)>>())
+        {
+            std::vector<const char*> paths;
+            for (auto&& file : files)
+                paths.push_back(file.c_str());
+
+            rs2_error* e = nullptr;
+            _batch = std::shared_ptr<rs2_playback_batch>(
+                rs2_create_playback_batch(ctx._context.get(), paths.data(), static_cast<int>(paths.size()), max_concurrent_files, &e),
+                rs2_delete_playback_batch);
+            error::handle(e);
+        }
+
+        /**
+        * Start reading the files. The frames of one file reach the callback in recorded order, one at a time,
+        * frames of different files may reach it concurrently
+        * \param[in] callback  Invoked as callback(rs2::frame, int file_index)
+        */
+        template<class T>
+        void start(T callback)
+        {
+            *_callback = std::move(callback);
+
+            rs2_error* e = nullptr;
+            rs2_playback_batch_start(_batch.get(), [](rs2_frame* f, int file_index, void* user) {
+                (*static_cast<std::function<void(frame, int)>*>(user))(frame{ f }, file_index);
+            }, _callback.get(), &e);
+            error::handle(e);
+        }
+
+        /**
+        * Wait for every file to be read to the end, or to fail
+        * \return False if the timeout expired first
+        */
+        bool wait(unsigned int timeout_ms = 0xffffffff) const
+        {
+            rs2_error* e = nullptr;
+            auto res = rs2_playback_batch_wait(_batch.get(), timeout_ms, &e);
+            error::handle(e);
+            return res != 0;
+        }
+
+        /**
+        * Stop reading, returning once no more frames will reach the callback. Must not be called from the callback
+        */
+        void stop() const
+        {
+            rs2_error* e = nullptr;
+            rs2_playback_batch_stop(_batch.get(), &e);
+            error::handle(e);
+        }
+
+        rs2_playback_batch_progress get_progress() const
+        {
+            rs2_error* e = nullptr;
+            rs2_playback_batch_progress progress;
+            rs2_playback_batch_get_progress(_batch.get(), &progress, &e);
+            error::handle(e);
+            return progress;
+        }
+
+        rs2_playback_batch_file_progress get_file_progress(int file_index) const
+        {
+            rs2_error* e = nullptr;
+            rs2_playback_batch_file_progress progress;
+            rs2_playback_batch_get_file_progress(_batch.get(), file_index, &progress, &e);
+            error::handle(e);
+            return progress;
+        }
+
+        /**
+        * \return The reason the file failed, empty if it did not
+        */
+        std::string get_file_error(int file_index) const
+        {
+            rs2_error* e = nullptr;
+            std::string result = rs2_playback_batch_get_file_error(_batch.get(), file_index, &e);
+            error::handle(e);
+            return result;
+        }
+
+        explicit operator std::shared_ptr<rs2_playback_batch>() { return _batch; }
+    private:
+        // Declared first so the batch, which calls it, is released before it
+        std::shared_ptr<std::function<void(frame, int)>> _callback;
+        std::shared_ptr<rs2_playback_batch> _batch;
+    };
+
 }
 #endif // LIBREALSENSE_RS2_CONTEXT_HPP
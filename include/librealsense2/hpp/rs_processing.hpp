@@ -445,6 +445,22 @@ namespace rs2
             throw std::runtime_error("Error occured during execution of the processing block! See the log for more info");
         }
         /**
+        * Calculate the vertices of a depth frame into a buffer of the caller, without allocating a points frame.
+        *
+        * \param[in] depth  - Z16 depth frame.
+        * \param[in] layout - layout of the vertices in the buffer.
+        * \param[out] buffer - receives one vertex per depth pixel.
+        * \param[in] size   - size of the buffer in bytes.
+        * \return number of vertices written.
+        */
+        int calculate_vertices(frame depth, rs2_vertex_layout layout, void* buffer, int size)
+        {
+            rs2_error* e = nullptr;
+            auto count = rs2_pointcloud_calculate_vertices(get(), depth.get(), layout, buffer, size, &e);
+            error::handle(e);
+            return count;
+        }
+        /**
         * Map the point cloud to the given color frame.
         *
         * \param[in] mapped - the frame to be mapped to as texture.
@@ -1028,6 +1044,55 @@ namespace rs2
         }
     };
 
+    class depth_encoder : public filter
+    {
+    public:
+        /**
+        * Create a depth encoder, taking Z16 depth to Z16C frames encoded losslessly
+        * \param[in] codecs - comma-separated names of the codecs to encode with, in order of preference: rvl, bitplane,
+        * lz4, and zstd when the library is built with it. Empty for all of them. The codec giving the smallest frames is
+        * picked again every 30 frames
+        */
+        depth_encoder(const std::string& codecs = "") : filter(init(codecs)) {}
+
+    private:
+        friend class context;
+
+        std::shared_ptr<rs2_processing_block> init(const std::string& codecs)
+        {
+            rs2_error* e = nullptr;
+            auto block = std::shared_ptr<rs2_processing_block>(
+                rs2_create_depth_encoder_block(codecs.c_str(), &e),
+                rs2_delete_processing_block);
+            error::handle(e);
+
+            return block;
+        }
+    };
+
+    class depth_decoder : public filter
+    {
+    public:
+        /**
+        * Create a depth decoder, taking Z16C frames of any codec back to Z16 depth
+        */
+        depth_decoder() : filter(init()) {}
+
+    private:
+        friend class context;
+
+        std::shared_ptr<rs2_processing_block> init()
+        {
+            rs2_error* e = nullptr;
+            auto block = std::shared_ptr<rs2_processing_block>(
+                rs2_create_depth_decoder_block(&e),
+                rs2_delete_processing_block);
+            error::handle(e);
+
+            return block;
+        }
+    };
+
     class hole_filling_filter : public filter
     {
     public:
@@ -1077,6 +1142,36 @@ namespace rs2
         }
     };
 
+    class depth_post_processing : public filter
+    {
+    public:
+        /**
+        * Create a block running depth post-processing filters as one
+        * The frames are those the filters give one after the other, in a single pass over the frame where the filters allow.
+        * \param[in] filters - the decimation, depth to disparity, spatial, temporal, disparity to depth and hole filling
+        * filters in this order, any of them left out. They keep their options, which apply to the frames of this block
+        */
+        depth_post_processing(const std::vector<filter>& filters) : filter(init(filters), 1) {}
+
+    private:
+        friend class context;
+
+        std::shared_ptr<rs2_processing_block> init(const std::vector<filter>& filters)
+        {
+            std::vector<rs2_processing_block*> blocks;
+            for (auto&& f : filters)
+                blocks.push_back(f.get());
+
+            rs2_error* e = nullptr;
+            auto block = std::shared_ptr<rs2_processing_block>(
+                rs2_create_depth_post_processing_block(blocks.data(), static_cast<int>(blocks.size()), &e),
+                rs2_delete_processing_block);
+            error::handle(e);
+
+            return block;
+        }
+    };
+
     class rates_printer : public filter
     {
     public:
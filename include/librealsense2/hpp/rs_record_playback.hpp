@@ -266,6 +266,31 @@ namespace rs2
             error::handle(e);
             return filename;
         }
+
+        /**
+        * Sets how much frame data the recorder may hold before it is written, and what happens to frames arriving past that
+        * \param[in]  policy              What to do with a frame that does not fit in the queue
+        * \param[in]  max_queued_bytes    Queue size in bytes
+        */
+        void set_overflow_policy(rs2_record_overflow_policy policy, unsigned long long max_queued_bytes)
+        {
+            rs2_error* e = nullptr;
+            rs2_record_device_set_overflow_policy(_dev.get(), policy, max_queued_bytes, &e);
+            error::handle(e);
+        }
+
+        /**
+        * Retrieves the write queue depth and throughput of the recorder
+        * \return   queued, dropped and written frames, and the write rate
+        */
+        rs2_record_statistics get_statistics() const
+        {
+            rs2_error* e = nullptr;
+            rs2_record_statistics statistics;
+            rs2_record_device_get_statistics(_dev.get(), &statistics, &e);
+            error::handle(e);
+            return statistics;
+        }
     protected:
         explicit recorder(std::shared_ptr<rs2_device> dev) : device(dev)
         {
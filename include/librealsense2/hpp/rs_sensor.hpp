@@ -213,6 +213,32 @@ namespace rs2
             error::handle(e);
         }
 
+        /**
+        * set the allocator used for the sensor frame buffers while the sensor is closed, applied from the next open
+        * \param[in] on_allocate   returns a buffer of at least the requested size in bytes, or null on failure
+        * \param[in] on_release    releases a buffer previously returned by on_allocate
+        * \param[in] user          auxiliary data passed to both functions
+        */
+        void set_frame_allocator(rs2_frame_allocate_ptr on_allocate, rs2_frame_release_ptr on_release, void* user) const
+        {
+            rs2_error* e = nullptr;
+            rs2_set_frame_allocator(_sensor.get(), on_allocate, on_release, user, &e);
+            error::handle(e);
+        }
+
+        /**
+        * retrieve the frame buffer pool counters of the sensor
+        * \return   pool hits, misses and high-water mark
+        */
+        rs2_frame_pool_statistics get_frame_pool_statistics() const
+        {
+            rs2_error* e = nullptr;
+            rs2_frame_pool_statistics statistics;
+            rs2_get_frame_pool_statistics(_sensor.get(), &statistics, &e);
+            error::handle(e);
+            return statistics;
+        }
+
 
         /**
         * Retrieves the list of stream profiles supported by the sensor.
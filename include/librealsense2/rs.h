@@ -93,6 +93,15 @@ const char * rs2_get_full_log_message( rs2_log_message const * msg, rs2_error**
  */
 void rs2_log(rs2_log_severity severity, const char * message, rs2_error ** error);
 
+/**
+ * Size the worker pool shared by the library's internal dispatchers (frame callbacks, syncers, device pollers, playback).
+ * The pool is process-wide and can be reconfigured at any time; the new settings apply to subsequent work
+ * \param[in] threads            Number of worker threads, 0 for one per hardware thread
+ * \param[in] cpu_affinity_mask  Bit i allows the workers to run on CPU i (first 64 CPUs), 0 leaves them unpinned
+ * \param[out] error  if non-null, receives any error that occurs during this call, otherwise, errors are ignored
+ */
+void rs2_configure_thread_pool(int threads, unsigned long long cpu_affinity_mask, rs2_error** error);
+
 /**
 * Given the 2D depth coordinate (x,y) provide the corresponding depth in metric units
 * \param[in] frame_ref  2D depth pixel coordinates (Left-Upper corner origin)
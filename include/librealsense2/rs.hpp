@@ -30,6 +30,13 @@ namespace rs2
         error::handle(e);
     }
 
+    inline void configure_thread_pool(int threads, unsigned long long cpu_affinity_mask = 0)
+    {
+        rs2_error* e = nullptr;
+        rs2_configure_thread_pool(threads, cpu_affinity_mask, &e);
+        error::handle(e);
+    }
+
     /*
         Interface to the log message data we expose.
     */
@@ -5,6 +5,7 @@
 
 #include "types.h"
 #include "core/streaming.h"
+#include "frame-buffer-pool.h"
 #include <atomic>
 #include <array>
 #include <math.h>
@@ -89,13 +90,14 @@ namespace librealsense
     std::shared_ptr<archive_interface> make_archive(rs2_extension type,
         std::atomic<uint32_t>* in_max_frame_queue_size,
         std::shared_ptr<platform::time_service> ts,
-        std::shared_ptr<metadata_parser_map> parsers);
+        std::shared_ptr<metadata_parser_map> parsers,
+        std::shared_ptr<frame_buffer_pool> pool);
 
     // Define a movable but explicitly noncopyable buffer type to hold our frame data
     class LRS_EXTENSION_API frame : public frame_interface
     {
     public:
-        std::vector<byte> data;
+        frame_buffer data;
         frame_additional_data additional_data;
         std::shared_ptr<metadata_parser_map> metadata_parsers = nullptr;
         explicit frame() : ref_count(0), _kept(false), owner(nullptr), on_release() {}
@@ -170,6 +172,10 @@ namespace librealsense
         void set_blocking(bool state) override { additional_data.is_blocking = state; }
         bool is_blocking() const override { return additional_data.is_blocking; }
 
+    protected:
+        // Owns no data, reading that of the backend buffer it was lent
+        bool borrows_data() const { return data.empty() && on_release.get_data(); }
+
     private:
         // TODO: check boost::intrusive_ptr or an alternative
         std::atomic<int> ref_count; // the reference count is on how many times this placeholder has been observed (not lifetime, not content)
@@ -288,6 +294,12 @@ namespace librealsense
             _bpp = bpp;
         }
 
+        // A frame lent its backend buffer is the size of the copy it stands in for, not of the payload
+        int get_frame_data_size() const override
+        {
+            return borrows_data() ? _stride * _height : frame::get_frame_data_size();
+        }
+
     private:
         int _width, _height, _bpp, _stride;
     };
@@ -172,6 +172,7 @@ namespace librealsense
             const void *    pixels;
             const void *    metadata;
             rs2_time_t      backend_time;
+            bool            lends_buffer;   // the pixels stay valid until the frame continuation runs
         };
 
         typedef std::function<void(stream_profile, frame_object, std::function<void()>)> frame_callback;
@@ -2,9 +2,8 @@
 // Copyright(c) 2020 Intel Corporation. All Rights Reserved.
 
 #include "CompressionFactory.h"
+#include "DepthCompression.h"
 #include "JpegCompression.h"
-#include "Lz4Compression.h"
-#include "RvlCompression.h"
 
 std::shared_ptr<ICompression> CompressionFactory::getObject(int t_width, int t_height, rs2_format t_format, rs2_stream t_streamType, int t_bpp)
 {
@@ -15,7 +14,7 @@ std::shared_ptr<ICompression> CompressionFactory::getObject(int t_width, int t_h
     }
     else if(t_streamType == RS2_STREAM_DEPTH)
     {
-        zipMeth = ZipMethod::lz;
+        zipMeth = ZipMethod::depth;
     }
     if(!isCompressionSupported(t_format, t_streamType))
     {
@@ -25,13 +24,16 @@ std::shared_ptr<ICompression> CompressionFactory::getObject(int t_width, int t_h
     switch(zipMeth)
     {
     case ZipMethod::rvl:
-        return std::make_shared<RvlCompression>(t_width, t_height, t_format, t_bpp);
+        return std::make_shared<DepthCompression>(t_width, t_height, t_format, t_bpp, std::vector<std::string>{"rvl"});
         break;
     case ZipMethod::jpeg:
         return std::make_shared<JpegCompression>(t_width, t_height, t_format, t_bpp);
         break;
     case ZipMethod::lz:
-        return std::make_shared<Lz4Compression>(t_width, t_height, t_format, t_bpp);
+        return std::make_shared<DepthCompression>(t_width, t_height, t_format, t_bpp, std::vector<std::string>{"lz4"});
+        break;
+    case ZipMethod::depth:
+        return std::make_shared<DepthCompression>(t_width, t_height, t_format, t_bpp, std::vector<std::string>{"rvl", "bitplane", "lz4", "zstd"});
         break;
     default:
         ERR << "unknown zip method";
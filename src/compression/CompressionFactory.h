@@ -12,6 +12,7 @@ typedef enum ZipMethod
     rvl,
     jpeg,
     lz,
+    depth, // the smallest of the depth codecs, tried every few frames
 } ZipMethod;
 
 class CompressionFactory
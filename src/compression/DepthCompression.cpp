@@ -0,0 +1,115 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "DepthCompression.h"
+#include <cstring>
+#include <ipDeviceCommon/Statistic.h>
+
+#define PROBE_INTERVAL 30         // frames between tries of all codecs
+#define DEPTH_FRAME_HEADER_SIZE 12 // before each encoded frame, naming its codec
+
+DepthCompression::DepthCompression(int t_width, int t_height, rs2_format t_format, int t_bpp, const std::vector<std::string>& t_codecs)
+    :ICompression(t_width, t_height, t_format, t_bpp)
+{
+    // leave out the codecs this librealsense was built without
+    uint16_t pixel = 0;
+    unsigned char header[DEPTH_FRAME_HEADER_SIZE];
+    for(auto&& codec : t_codecs)
+    {
+        rs2_error* e = nullptr;
+        rs2_encode_depth(codec.c_str(), &pixel, 0, header, sizeof(header), &e);
+        if(e)
+        {
+            INF << "depth codec " << codec << " is not available: " << rs2_get_error_message(e);
+            rs2_free_error(e);
+            continue;
+        }
+        m_codecs.push_back(codec);
+    }
+    if(m_codecs.empty())
+    {
+        ERR << "no depth codec is available, depth is sent as it is";
+        m_codecs.push_back("raw");
+    }
+    m_codec = m_codecs.front();
+    m_buffer.resize(t_width * t_height * sizeof(uint16_t) + DEPTH_FRAME_HEADER_SIZE);
+    m_probeBuffer.resize(m_buffer.size());
+}
+
+int DepthCompression::encode(const std::string& t_codec, unsigned char* t_buffer, int t_size, std::vector<unsigned char>& t_encoded)
+{
+    rs2_error* e = nullptr;
+    int size = rs2_encode_depth(t_codec.c_str(), t_buffer, t_size / sizeof(uint16_t), t_encoded.data(), (int)t_encoded.size(), &e);
+    if(e)
+    {
+        ERR << "Failure trying to compress the data: " << rs2_get_error_message(e);
+        rs2_free_error(e);
+        return -1;
+    }
+    return size;
+}
+
+int DepthCompression::compressBuffer(unsigned char* t_buffer, int t_size, unsigned char* t_compressedBuf)
+{
+    if(t_size + DEPTH_FRAME_HEADER_SIZE > (int)m_buffer.size())
+    {
+        ERR << "depth frame of " << t_size << " bytes does not fit " << m_width << "x" << m_height;
+        return -1;
+    }
+
+    int compressedSize = -1;
+    if(m_compFrameCounter++ % PROBE_INTERVAL == 0 && m_codecs.size() > 1)
+    {
+        // the codec giving the smallest frame encodes it, and the frames up to the next try
+        for(auto&& codec : m_codecs)
+        {
+            int size = encode(codec, t_buffer, t_size, m_probeBuffer);
+            if(size != -1 && (compressedSize == -1 || size < compressedSize))
+            {
+                compressedSize = size;
+                m_codec = codec;
+                m_buffer.swap(m_probeBuffer);
+            }
+        }
+    }
+    else
+    {
+        compressedSize = encode(m_codec, t_buffer, t_size, m_buffer);
+    }
+    if(compressedSize == -1)
+    {
+        return -1;
+    }
+
+    int compressWithHeaderSize = compressedSize + sizeof(compressedSize);
+    if(compressWithHeaderSize > t_size)
+    {
+        ERR << "Compression overflow, destination buffer is smaller than the compressed size.";
+        return -1;
+    }
+    if(m_compFrameCounter % 50 == 1)
+    {
+        INF << "frame " << m_compFrameCounter << "\tdepth\tcompression\t" << m_codec << "\t" << t_size << "\t/\t" << compressedSize;
+    }
+    memcpy(t_compressedBuf, &compressedSize, sizeof(compressedSize));
+    memcpy(t_compressedBuf + sizeof(compressedSize), m_buffer.data(), compressedSize);
+    return compressWithHeaderSize;
+}
+
+int DepthCompression::decompressBuffer(unsigned char* t_buffer, int t_compressedSize, unsigned char* t_uncompressedBuf)
+{
+    int originalSize = m_width * m_height * m_bpp;
+    rs2_error* e = nullptr;
+    rs2_decode_depth(t_buffer, t_compressedSize, t_uncompressedBuf, originalSize / sizeof(uint16_t), &e);
+    if(e)
+    {
+        ERR << "Failure trying to decompress the frame: " << rs2_get_error_message(e);
+        rs2_free_error(e);
+        return -1;
+    }
+    if(m_decompFrameCounter++ % 50 == 0)
+    {
+        INF << "frame " << m_decompFrameCounter << "\tdepth\tdecompression\t" << t_compressedSize << "\t/\t" << originalSize;
+    }
+    return originalSize;
+}
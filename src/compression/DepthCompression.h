@@ -0,0 +1,26 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#pragma once
+
+#include "ICompression.h"
+#include <string>
+#include <vector>
+
+// Z16 depth through the depth codecs of librealsense. Each frame names its codec, so the server may
+// change codecs from frame to frame and the client decodes whichever came
+class DepthCompression : public ICompression
+{
+public:
+    // t_codecs are tried in turn every few frames, the one giving the smallest frame kept until the next try
+    DepthCompression(int t_width, int t_height, rs2_format t_format, int t_bpp, const std::vector<std::string>& t_codecs);
+    int compressBuffer(unsigned char* t_buffer, int t_size, unsigned char* t_compressedBuf);
+    int decompressBuffer(unsigned char* t_buffer, int t_size, unsigned char* t_uncompressedBuf);
+
+private:
+    int encode(const std::string& t_codec, unsigned char* t_buffer, int t_size, std::vector<unsigned char>& t_encoded);
+
+    std::vector<std::string> m_codecs;
+    std::string m_codec;
+    std::vector<unsigned char> m_buffer, m_probeBuffer;
+};
@@ -8,134 +8,365 @@
 #include <thread>
 #include <atomic>
 #include <functional>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <new>
+#include <type_traits>
+#include <set>
+
+#include "thread-pool.h"
 
 const int QUEUE_MAX_SIZE = 10;
-// Simplest implementation of a blocking concurrent queue for thread messaging
+
+// Bounded lock-free ring buffer after D. Vyukov's sequenced MPMC queue.
+// Every cell carries a sequence number telling producers and consumers whether it is
+// theirs to fill or drain, so neither side ever takes a lock.
+// Capacity is rounded up to a power of two.
+template<class T>
+class lock_free_ring
+{
+    struct cell
+    {
+        std::atomic<size_t> sequence;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage; // T is constructed in place
+        T* data() { return reinterpret_cast<T*>(&storage); }
+    };
+
+    std::unique_ptr<cell[]> _buffer;
+    size_t _mask;
+    char _pad0[64];
+    std::atomic<size_t> _enqueue_pos;
+    char _pad1[64];
+    std::atomic<size_t> _dequeue_pos;
+    char _pad2[64];
+
+public:
+    explicit lock_free_ring(size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+
+        _buffer.reset(new cell[size]);
+        _mask = size - 1;
+        for (size_t i = 0; i < size; i++)
+            _buffer[i].sequence.store(i, std::memory_order_relaxed);
+        _enqueue_pos.store(0, std::memory_order_relaxed);
+        _dequeue_pos.store(0, std::memory_order_relaxed);
+    }
+
+    ~lock_free_ring()
+    {
+        while (try_discard());
+    }
+
+    // Moves from item only on success
+    bool try_push(T&& item)
+    {
+        auto pos = _enqueue_pos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            auto& c = _buffer[pos & _mask];
+            auto seq = c.sequence.load(std::memory_order_acquire);
+            auto diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0)
+            {
+                if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    new (&c.storage) T(std::move(item));
+                    c.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+                return false; // full
+            else
+                pos = _enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    bool try_pop(T& item)
+    {
+        return pop_with([&item](T& front) { item = std::move(front); });
+    }
+
+    // Drop the oldest element
+    bool try_discard()
+    {
+        return pop_with([](T&) {});
+    }
+
+    // Oldest element, or nullptr when empty. Only valid while no other thread pops
+    T* front()
+    {
+        auto pos = _dequeue_pos.load(std::memory_order_relaxed);
+        auto& c = _buffer[pos & _mask];
+        if (c.sequence.load(std::memory_order_acquire) != pos + 1)
+            return nullptr;
+        return c.data();
+    }
+
+    bool readable() const
+    {
+        auto pos = _dequeue_pos.load(std::memory_order_relaxed);
+        return _buffer[pos & _mask].sequence.load(std::memory_order_acquire) == pos + 1;
+    }
+
+    size_t size() const
+    {
+        auto deq = _dequeue_pos.load(std::memory_order_relaxed);
+        auto enq = _enqueue_pos.load(std::memory_order_relaxed);
+        return enq > deq ? enq - deq : 0;
+    }
+
+    size_t capacity() const { return _mask + 1; }
+
+private:
+    template<class F>
+    bool pop_with(F consume)
+    {
+        auto pos = _dequeue_pos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            auto& c = _buffer[pos & _mask];
+            auto seq = c.sequence.load(std::memory_order_acquire);
+            auto diff = (intptr_t)seq - (intptr_t)(pos + 1);
+            if (diff == 0)
+            {
+                if (_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    consume(*c.data());
+                    c.data()->~T();
+                    c.sequence.store(pos + _mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+                return false; // empty
+            else
+                pos = _dequeue_pos.load(std::memory_order_relaxed);
+        }
+    }
+};
+
+// Blocking concurrent queue for thread messaging on top of lock_free_ring.
+// Waiting threads spin for a short, self-tuning period before parking on a condition
+// variable, and the other side only touches the mutex when somebody is actually parked
 template<class T>
 class single_consumer_queue
 {
-    std::deque<T> _queue;
+    // Cells the ring is made with at most. Items past them wait in the spill, which keeps queues
+    // of a large capacity, as the record and playback dispatchers are, from allocating all of it
+    static const unsigned int MAX_RING = 1024;
+
+    lock_free_ring<T> _ring;
+    std::deque<T> _spill;           // after the items of the ring, under _mutex
+    std::atomic<size_t> _spilled;
+    std::atomic<bool> _spilling;    // producers go to the spill while it holds anything
+
     std::mutex _mutex;
     std::condition_variable _deq_cv; // not empty signal
-    std::condition_variable _enq_cv; // not empty signal
+    std::condition_variable _enq_cv; // not full signal
+    std::atomic<int> _deq_waiters;
+    std::atomic<int> _enq_waiters;
+    std::atomic<int> _spin_budget;
 
     unsigned int _cap;
-    bool _accepting;
+    std::atomic<bool> _accepting;
 
     // flush mechanism is required to abort wait on cv
     // when need to stop
     std::atomic<bool> _need_to_flush;
     std::atomic<bool> _was_flushed;
+
+    static const int MIN_SPIN = 16;
+    static const int MAX_SPIN = 1024;
+
+    template<class Pred>
+    bool wait_until(std::condition_variable& cv, std::atomic<int>& waiters,
+        std::chrono::steady_clock::time_point deadline, Pred pred)
+    {
+        // Spin first - a handoff at camera rates usually completes within microseconds
+        auto budget = _spin_budget.load(std::memory_order_relaxed);
+        for (auto i = 0; i < budget; i++)
+        {
+            if (pred())
+            {
+                if (budget < MAX_SPIN) _spin_budget.store(budget * 2, std::memory_order_relaxed);
+                return true;
+            }
+            if ((i & 0xF) == 0xF) std::this_thread::yield();
+        }
+        if (budget > MIN_SPIN) _spin_budget.store(budget / 2, std::memory_order_relaxed);
+
+        // Park. Registering as a waiter before re-checking under the mutex pairs with
+        // notify(), so a wakeup cannot slip in between the check and the wait
+        thread_pool::blocking_scope blocking;
+        waiters.fetch_add(1);
+        std::unique_lock<std::mutex> lock(_mutex);
+        auto res = cv.wait_until(lock, deadline, pred);
+        waiters.fetch_sub(1);
+        return res;
+    }
+
+    void notify(std::condition_variable& cv, std::atomic<int>& waiters)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load())
+        {
+            { std::lock_guard<std::mutex> lock(_mutex); }
+            cv.notify_one();
+        }
+    }
+
+    // Make room by discarding the oldest item, as the queue drops frames when over capacity
+    void push_dropping_oldest(T&& item)
+    {
+        while (size() >= _cap && _ring.try_discard());
+        if (_cap > _ring.capacity())
+        {
+            push_or_spill(std::move(item));
+            return;
+        }
+        while (!_ring.try_push(std::move(item)))
+            _ring.try_discard();
+    }
+
+    void push_or_spill(T&& item)
+    {
+        if (!_spilling && _ring.try_push(std::move(item)))
+            return;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_spilling && _ring.try_push(std::move(item)))
+            return;
+        _spill.push_back(std::move(item));
+        _spilled++;
+        _spilling = true;
+    }
+
+    // Moves what the ring has room for out of the spill, in order. False when nothing was spilled
+    bool refill()
+    {
+        if (!_spilling)
+            return false;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        while (!_spill.empty() && _ring.try_push(std::move(_spill.front())))
+        {
+            _spill.pop_front();
+            _spilled--;
+        }
+        if (_spill.empty())
+            _spilling = false;
+        return true;
+    }
+
+    bool pop(T& item)
+    {
+        if (_ring.try_pop(item) || (refill() && _ring.try_pop(item)))
+        {
+            refill();
+            return true;
+        }
+        return false;
+    }
+
 public:
     explicit single_consumer_queue<T>(unsigned int cap = QUEUE_MAX_SIZE)
-        : _queue(), _mutex(), _deq_cv(), _enq_cv(), _cap(cap), _need_to_flush(false), _was_flushed(false), _accepting(true)
+        : _ring(std::min(cap, MAX_RING)), _spilled(0), _spilling(false), _deq_waiters(0), _enq_waiters(0),
+          _spin_budget(MIN_SPIN), _cap(cap), _accepting(true), _need_to_flush(false), _was_flushed(false)
     {}
 
     void enqueue(T&& item)
     {
-        std::unique_lock<std::mutex> lock(_mutex);
         if (_accepting)
         {
-            _queue.push_back(std::move(item));
-            if (_queue.size() > _cap)
-            {
-                _queue.pop_front();
-            }
+            push_dropping_oldest(std::move(item));
         }
-        lock.unlock();
-        _deq_cv.notify_one();
+        notify(_deq_cv, _deq_waiters);
     }
 
     void blocking_enqueue(T&& item)
     {
-        auto pred = [this]()->bool { return _queue.size() < _cap || _need_to_flush; };
+        auto pred = [this]()->bool { return size() < _cap || _need_to_flush; };
 
-        std::unique_lock<std::mutex> lock(_mutex);
         if (_accepting)
         {
-            _enq_cv.wait(lock, pred);
-            _queue.push_back(std::move(item));
+            while (!wait_until(_enq_cv, _enq_waiters, std::chrono::steady_clock::now() + std::chrono::seconds(1), pred));
+            push_dropping_oldest(std::move(item));
         }
-        lock.unlock();
-        _deq_cv.notify_one();
+        notify(_deq_cv, _deq_waiters);
     }
 
 
     bool dequeue(T* item ,unsigned int timeout_ms)
     {
-        std::unique_lock<std::mutex> lock(_mutex);
         _accepting = true;
         _was_flushed = false;
-        const auto ready = [this]() { return (_queue.size() > 0) || _need_to_flush; };
-        if (!ready() && !_deq_cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), ready))
-        {
-            return false;
-        }
+        const auto ready = [this]() { return _ring.readable() || _spilling || _need_to_flush; };
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
 
-        if (_queue.size() <= 0)
+        do
         {
-            return false;
-        }
-        *item = std::move(_queue.front());
-        _queue.pop_front();
-        _enq_cv.notify_one();
-        return true;
+            if (pop(*item))
+            {
+                notify(_enq_cv, _enq_waiters);
+                return true;
+            }
+            if (_need_to_flush)
+                return false;
+        } while (wait_until(_deq_cv, _deq_waiters, deadline, ready));
+
+        return false;
     }
 
     bool try_dequeue(T* item)
     {
-        std::unique_lock<std::mutex> lock(_mutex);
         _accepting = true;
-        if (_queue.size() > 0)
+        if (pop(*item))
         {
-            auto val = std::move(_queue.front());
-            _queue.pop_front();
-            *item = std::move(val);
-            _enq_cv.notify_one();
+            notify(_enq_cv, _enq_waiters);
             return true;
         }
         return false;
     }
 
+    // Valid until the next dequeue, callers must be the only consumer
     bool peek(T** item)
     {
-        std::unique_lock<std::mutex> lock(_mutex);
-
-        if (_queue.size() <= 0)
-        {
-            return false;
-        }
-        *item = &_queue.front();
-        return true;
+        *item = _ring.front();
+        if (!*item && refill())
+            *item = _ring.front();
+        return *item != nullptr;
     }
 
     void clear()
     {
-        std::unique_lock<std::mutex> lock(_mutex);
-
         _accepting = false;
         _need_to_flush = true;
 
+        while (_ring.try_discard());
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _spill.clear();
+        _spilled = 0;
+        _spilling = false;
         _enq_cv.notify_all();
-        while (_queue.size() > 0)
-        {
-            auto item = std::move(_queue.front());
-            _queue.pop_front();
-        }
         _deq_cv.notify_all();
     }
 
     void start()
     {
-        std::unique_lock<std::mutex> lock(_mutex);
         _need_to_flush = false;
         _accepting = true;
     }
 
     size_t size()
     {
-        std::unique_lock<std::mutex> lock(_mutex);
-        return _queue.size();
+        return _ring.size() + _spilled;
     }
 };
 
@@ -186,13 +417,16 @@ public:
     }
 };
 
+// Serial executor (a strand) on top of a thread_pool: items run one at a time and in the
+// order they were invoked, but no thread is held while the dispatcher has nothing to do
 class dispatcher
 {
+    struct strand;
 public:
     class cancellable_timer
     {
     public:
-        cancellable_timer(dispatcher* owner)
+        cancellable_timer(strand* owner)
             : _owner(owner)
         {}
 
@@ -200,117 +434,119 @@ public:
         {
             using namespace std::chrono;
 
-            std::unique_lock<std::mutex> lock(_owner->_was_stopped_mutex);
-            auto good = [&]() { return _owner->_was_stopped.load(); };
-            return !(_owner->_was_stopped_cv.wait_for(lock, milliseconds(ms), good));
+            thread_pool::blocking_scope blocking;
+            std::unique_lock<std::mutex> lock(_owner->was_stopped_mutex);
+            auto good = [&]() { return _owner->was_stopped.load(); };
+            return !(_owner->was_stopped_cv.wait_for(lock, milliseconds(ms), good));
         }
 
     private:
-        dispatcher* _owner;
+        strand* _owner;
     };
 
-    dispatcher(unsigned int cap)
-        : _queue(cap),
-          _was_stopped(true),
-          _was_flushed(false),
-          _is_alive(true)
+    dispatcher(unsigned int cap, thread_pool& pool = thread_pool::get_default())
+        : _strand(std::make_shared<strand>(cap, pool))
     {
-        _thread = std::thread([&]()
-        {
-            int timeout_ms = 5000;
-            while (_is_alive)
-            {
-                std::function<void(cancellable_timer)> item;
-
-                if (_queue.dequeue(&item, timeout_ms))
-                {
-                    cancellable_timer time(this);
-
-                    try
-                    {
-                        item(time);
-                    }
-                    catch(...){}
-                }
-
-#ifndef ANDROID
-                std::unique_lock<std::mutex> lock(_was_flushed_mutex);
-#endif
-                _was_flushed = true;
-                _was_flushed_cv.notify_all();
-#ifndef ANDROID
-                lock.unlock();
-#endif
-            }
-        });
     }
 
     template<class T>
     void invoke(T item, bool is_blocking = false)
     {
-        if (!_was_stopped)
+        if (!_strand->was_stopped)
         {
             if(is_blocking)
-                _queue.blocking_enqueue(std::move(item));
+                _strand->queue.blocking_enqueue(std::move(item));
             else
-                _queue.enqueue(std::move(item));
+                _strand->queue.enqueue(std::move(item));
+            _strand->schedule();
         }
     }
 
+    // Invoke the item once the delay expires, without occupying a worker in the meantime.
+    // Items still waiting for their delay are dropped by stop()
+    template<class T>
+    void invoke_after(std::chrono::milliseconds delay, T item)
+    {
+        std::lock_guard<std::mutex> lock(_strand->timers_mutex);
+        if (_strand->was_stopped)
+            return;
+
+        // The timer holds on to the strand rather than to the dispatcher, which may be gone once it fires
+        std::weak_ptr<strand> owner = _strand;
+        auto id = std::make_shared<uint64_t>(0);
+        *id = _strand->pool.submit_after(delay, [owner, id, item]()
+        {
+            auto s = owner.lock();
+            if (!s)
+                return;
+
+            // Queued under the lock, so stop() either cancels the timer or finds its item in the queue
+            std::lock_guard<std::mutex> lock(s->timers_mutex);
+            if (!s->timers.erase(*id) || s->was_stopped)
+                return;
+            s->queue.enqueue(item);
+            s->schedule();
+        });
+        _strand->timers.insert(*id);
+    }
+
     template<class T>
     void invoke_and_wait(T item, std::function<bool()> exit_condition, bool is_blocking = false)
     {
         bool done = false;
+        auto s = _strand.get();
 
         //action
         auto func = std::move(item);
-        invoke([&, func](dispatcher::cancellable_timer c)
+        invoke([&, s, func](dispatcher::cancellable_timer c)
         {
             func(c);
+            std::lock_guard<std::mutex> lk(s->blocking_invoke_mutex);
             done = true;
-            _blocking_invoke_cv.notify_one();
+            s->blocking_invoke_cv.notify_one();
         }, is_blocking);
 
         //wait
-        std::unique_lock<std::mutex> lk(_blocking_invoke_mutex);
-        _blocking_invoke_cv.wait(lk, [&](){ return done || exit_condition(); });
+        thread_pool::blocking_scope blocking;
+        std::unique_lock<std::mutex> lk(s->blocking_invoke_mutex);
+        s->blocking_invoke_cv.wait(lk, [&](){ return done || exit_condition(); });
     }
 
     void start()
     {
-        std::unique_lock<std::mutex> lock(_was_stopped_mutex);
-        _was_stopped = false;
+        std::unique_lock<std::mutex> lock(_strand->was_stopped_mutex);
+        _strand->was_stopped = false;
 
-        _queue.start();
+        _strand->queue.start();
     }
 
     void stop()
     {
         {
-            std::unique_lock<std::mutex> lock(_was_stopped_mutex);
-            _was_stopped = true;
-            _was_stopped_cv.notify_all();
+            std::unique_lock<std::mutex> lock(_strand->was_stopped_mutex);
+            _strand->was_stopped = true;
+            _strand->was_stopped_cv.notify_all();
         }
 
-        _queue.clear();
+        _strand->cancel_timers();
+        _strand->queue.clear();
 
-        {
-            std::unique_lock<std::mutex> lock(_was_flushed_mutex);
-            _was_flushed = false;
-        }
-
-        std::unique_lock<std::mutex> lock_was_flushed(_was_flushed_mutex);
-        _was_flushed_cv.wait_for(lock_was_flushed, std::chrono::hours(999999), [&]() { return _was_flushed.load(); });
+        // Let the item in flight finish, unless stop was called from that very item
+        if (!_strand->is_draining_here())
+            _strand->wait_until_idle();
 
-        _queue.start();
+        _strand->queue.start();
     }
 
     ~dispatcher()
     {
         stop();
-        _queue.clear();
-        _is_alive = false;
-        _thread.join();
+        _strand->queue.clear();
+
+        // Destroyed from one of its own items, the drain running it holds the strand and lets go of it
+        // on the pool once the item returns. Waiting for that drain here would wait on ourselves
+        if (!_strand->is_draining_here())
+            _strand->wait_until_idle();
     }
 
     bool flush()
@@ -319,62 +555,150 @@ public:
         std::condition_variable cv;
         bool invoked = false;
         auto wait_sucess = std::make_shared<std::atomic_bool>(true);
-        invoke([&, wait_sucess](cancellable_timer t)
+        auto s = _strand.get();
+        invoke([&, s, wait_sucess](cancellable_timer t)
         {
             ///TODO: use _queue to flush, and implement properly
-            if (_was_stopped || !(*wait_sucess))
+            if (s->was_stopped || !(*wait_sucess))
                 return;
 
-            {
-                std::lock_guard<std::mutex> locker(m);
-                invoked = true;
-            }
+            // Notify under the lock: the waiter owns cv and may return as soon as it sees invoked
+            std::lock_guard<std::mutex> locker(m);
+            invoked = true;
             cv.notify_one();
         });
+        thread_pool::blocking_scope blocking;
         std::unique_lock<std::mutex> locker(m);
-        *wait_sucess = cv.wait_for(locker, std::chrono::seconds(10), [&]() { return invoked || _was_stopped; });
+        *wait_sucess = cv.wait_for(locker, std::chrono::seconds(10), [&]() { return invoked || s->was_stopped; });
         return *wait_sucess;
     }
 
     bool empty()
     {
-        return _queue.size() == 0;
+        return _strand->queue.size() == 0;
     }
 
 private:
-    friend cancellable_timer;
-    single_consumer_queue<std::function<void(cancellable_timer)>> _queue;
-    std::thread _thread;
+    // The state items and drains work on. Each drain holds a reference to it, so it outlives a
+    // dispatcher destroyed from one of its own items until the pool is done with that drain
+    struct strand : std::enable_shared_from_this<strand>
+    {
+        // Items drained per pool task, so a busy dispatcher cannot monopolize a worker
+        static const int DRAIN_BATCH = 16;
+
+        strand(unsigned int cap, thread_pool& pool)
+            : queue(cap),
+              pool(pool),
+              was_stopped(true),
+              scheduled(false)
+        {
+        }
 
-    std::atomic<bool> _was_stopped;
-    std::condition_variable _was_stopped_cv;
-    std::mutex _was_stopped_mutex;
+        void schedule()
+        {
+            // Pairs with the fence in drain(): either the drain sees the new item, or this sees it gone
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!scheduled.exchange(true))
+                submit_drain();
+        }
 
-    std::atomic<bool> _was_flushed;
-    std::condition_variable _was_flushed_cv;
-    std::mutex _was_flushed_mutex;
+        void submit_drain()
+        {
+            auto self = shared_from_this();
+            pool.submit([self]() { self->drain(); });
+        }
+
+        void drain()
+        {
+            drain_thread = std::this_thread::get_id();
+            for (int i = 0; i < DRAIN_BATCH; i++)
+            {
+                std::function<void(cancellable_timer)> item;
+                if (!queue.try_dequeue(&item))
+                    break;
+
+                cancellable_timer time(this);
+                try
+                {
+                    item(time);
+                }
+                catch(...){}
+            }
+            drain_thread = std::thread::id();
+
+            // Decided under the mutex, so a waiting destructor cannot proceed while this drain still uses the strand
+            std::lock_guard<std::mutex> lock(idle_mutex);
+            scheduled = false;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (queue.size() > 0 && !scheduled.exchange(true))
+                submit_drain();
+            else
+                idle_cv.notify_all();
+        }
+
+        bool is_draining_here() const
+        {
+            return drain_thread.load() == std::this_thread::get_id();
+        }
+
+        void wait_until_idle()
+        {
+            thread_pool::blocking_scope blocking;
+            std::unique_lock<std::mutex> lock(idle_mutex);
+            idle_cv.wait(lock, [&]() { return !scheduled.load(); });
+        }
+
+        void cancel_timers()
+        {
+            std::set<uint64_t> ids;
+            {
+                std::lock_guard<std::mutex> lock(timers_mutex);
+                ids.swap(timers);
+            }
+            for (auto id : ids)
+                pool.cancel(id);
+        }
+
+        single_consumer_queue<std::function<void(cancellable_timer)>> queue;
+        thread_pool& pool;
+
+        std::atomic<bool> was_stopped;
+        std::condition_variable was_stopped_cv;
+        std::mutex was_stopped_mutex;
+
+        std::atomic<bool> scheduled;
+        std::atomic<std::thread::id> drain_thread;
+        std::condition_variable idle_cv;
+        std::mutex idle_mutex;
 
-    std::condition_variable _blocking_invoke_cv;
-    std::mutex _blocking_invoke_mutex;
+        std::set<uint64_t> timers;
+        std::mutex timers_mutex;
 
-    std::atomic<bool> _is_alive;
+        std::condition_variable blocking_invoke_cv;
+        std::mutex blocking_invoke_mutex;
+    };
+
+    std::shared_ptr<strand> _strand;
 };
 
 template<class T = std::function<void(dispatcher::cancellable_timer)>>
 class active_object
 {
 public:
-    active_object(T operation)
-        : _operation(std::move(operation)), _dispatcher(1), _stopped(true)
+    // With an interval, each iteration is started by a pool timer once the interval has passed,
+    // instead of the operation sleeping on a worker between iterations
+    active_object(T operation, unsigned int interval_ms = 0)
+        : _operation(std::move(operation)), _dispatcher(1), _stopped(true), _interval_ms(interval_ms)
     {
     }
 
     void start()
     {
-        _stopped = false;
+        auto was_stopped = _stopped.exchange(false);
         _dispatcher.start();
 
-        do_loop();
+        if (was_stopped)
+            do_loop();
     }
 
     void stop()
@@ -383,6 +707,12 @@ public:
         _dispatcher.stop();
     }
 
+    // Takes effect from the next iteration
+    void set_interval(unsigned int interval_ms)
+    {
+        _interval_ms = interval_ms;
+    }
+
     ~active_object()
     {
         stop();
@@ -390,37 +720,33 @@ public:
 private:
     void do_loop()
     {
-        _dispatcher.invoke([this](dispatcher::cancellable_timer ct)
+        auto iteration = [this](dispatcher::cancellable_timer ct)
         {
             _operation(ct);
             if (!_stopped)
             {
                 do_loop();
             }
-        });
+        };
+
+        if (_interval_ms)
+            _dispatcher.invoke_after(std::chrono::milliseconds(_interval_ms), iteration);
+        else
+            _dispatcher.invoke(iteration);
     }
 
     T _operation;
     dispatcher _dispatcher;
     std::atomic<bool> _stopped;
+    std::atomic<unsigned int> _interval_ms;
 };
 
 class watchdog
 {
 public:
     watchdog(std::function<void()> operation, uint64_t timeout_ms) :
-            _operation(std::move(operation)), _timeout_ms(timeout_ms)
+            _operation(std::move(operation)), _timeout_ms(timeout_ms), _dispatcher(1)
     {
-        _watcher = std::make_shared<active_object<>>([this](dispatcher::cancellable_timer cancellable_timer)
-        {
-            if(cancellable_timer.try_sleep(_timeout_ms))
-            {
-                if(!_kicked)
-                    _operation();
-                std::lock_guard<std::mutex> lk(_m);
-                _kicked = false;
-            }
-        });
     }
 
     ~watchdog()
@@ -429,18 +755,40 @@ public:
             stop();
     }
 
-    void start() { std::lock_guard<std::mutex> lk(_m); _watcher->start(); _running = true; }
-    void stop() { { std::lock_guard<std::mutex> lk(_m); _running = false; } _watcher->stop(); }
+    void start() { std::lock_guard<std::mutex> lk(_m); _dispatcher.start(); if (!_running) arm(); _running = true; }
+    void stop() { { std::lock_guard<std::mutex> lk(_m); _running = false; } _dispatcher.stop(); }
     bool running() { std::lock_guard<std::mutex> lk(_m); return _running; }
     void set_timeout(uint64_t timeout_ms) { std::lock_guard<std::mutex> lk(_m); _timeout_ms = timeout_ms; }
     void kick() { std::lock_guard<std::mutex> lk(_m); _kicked = true; }
 
 private:
+    // Expects _m to be held. The next check waits on a pool timer rather than a sleeping thread
+    void arm()
+    {
+        _dispatcher.invoke_after(std::chrono::milliseconds(_timeout_ms), [this](dispatcher::cancellable_timer)
+        {
+            bool expired;
+            {
+                std::lock_guard<std::mutex> lk(_m);
+                if (!_running)
+                    return;
+                expired = !_kicked;
+            }
+            if (expired)
+                _operation();
+
+            std::lock_guard<std::mutex> lk(_m);
+            _kicked = false;
+            if (_running)
+                arm();
+        });
+    }
+
     std::mutex _m;
     uint64_t _timeout_ms;
     bool _kicked = false;
     bool _running = false;
     bool _blocker = true;
     std::function<void()> _operation;
-    std::shared_ptr<active_object<>> _watcher;
+    dispatcher _dispatcher; // last, so it is stopped before the state its items use goes away
 };
\ No newline at end of file
@@ -34,6 +34,8 @@ namespace librealsense
                                                        rs2_extension frame_type = RS2_EXTENSION_MOTION_FRAME) = 0;
 
         virtual frame_interface* allocate_composite_frame(std::vector<frame_holder> frames) = 0;
+        // Takes the frames out of the holders, leaving them empty unless the allocation fails
+        virtual frame_interface* allocate_composite_frame(frame_holder* frames, size_t count) = 0;
 
         virtual frame_interface* allocate_points(std::shared_ptr<stream_profile_interface> stream, 
             frame_interface* original, 
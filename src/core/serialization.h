@@ -346,6 +346,8 @@ namespace librealsense
             virtual void disable_stream(const std::vector<device_serializer::stream_identifier>& stream_ids) = 0;
             virtual const std::string& get_file_name() const = 0;
             virtual std::vector<std::shared_ptr<serialized_data>> fetch_last_frames(const nanoseconds& seek_time) = 0;
+            // Number of frames read that may be held at once before the reader skips frames, 0 for no limit
+            virtual void set_frame_queue_size(uint32_t size) = 0;
         };
     }
 }
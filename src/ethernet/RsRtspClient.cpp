@@ -44,7 +44,9 @@ IRsRtsp *RsRTSPClient::getRtspClient(char const *t_rtspURL, char const *t_applic
     UsageEnvironment *env = RSUsageEnvironment::createNew(*scheduler);
 
     RTSPClient::responseBufferSize = 100000;
-    return (IRsRtsp *)new RsRTSPClient(scheduler, env, t_rtspURL, RTSP_CLIENT_VERBOSITY_LEVEL, t_applicationName, t_tunnelOverHTTPPortNum);
+    // The server refuses clients that do not say which network protocol they speak
+    std::string agent = std::string(t_applicationName ? t_applicationName : "librealsense") + " " + RS_NETWORK_PROTOCOL_AGENT + std::to_string(RS_NETWORK_PROTOCOL_VERSION);
+    return (IRsRtsp *)new RsRTSPClient(scheduler, env, t_rtspURL, RTSP_CLIENT_VERBOSITY_LEVEL, agent.c_str(), t_tunnelOverHTTPPortNum);
 }
 
 RsRTSPClient::RsRTSPClient(TaskScheduler *t_scheduler, UsageEnvironment *t_env, char const *t_rtspURL, int t_verbosityLevel, char const *t_applicationName, portNumBits t_tunnelOverHTTPPortNum)
@@ -406,6 +408,15 @@ void RsRTSPClient::continueAfterDESCRIBE(RTSPClient *rtspClient, int resultCode,
         RsMediaSubsession *subsession = iter.next();
         while (subsession != NULL)
         {
+            // Servers from before the depth codec header send no version
+            int protocol = subsession->attrVal_int("protocol");
+            if (protocol != RS_NETWORK_PROTOCOL_VERSION)
+            {
+                rsRtspClient->m_lastReturnValue = {RsRtspReturnCode::ERROR_GENERAL, "rs-server speaks network protocol " + std::to_string(protocol) + ", this client speaks " +
+                                                                                         std::to_string(RS_NETWORK_PROTOCOL_VERSION) + "; use the same librealsense version on both ends"};
+                break;
+            }
+
             // Get more data from the SDP string
             const char *strWidthVal = subsession->attrVal_str("width");
             const char *strHeightVal = subsession->attrVal_str("height");
@@ -11,6 +11,8 @@
 
 #define WRITE_FRAMES_TO_FILE 0
 
+#define POOL_RETRY_INTERVAL_US 2000
+
 RsSink* RsSink::createNew(UsageEnvironment& t_env, MediaSubsession& t_subsession, rs2_video_stream t_stream, MemoryPool* t_memPool, char const* t_streamId)
 {
     return new RsSink(t_env, t_subsession, t_stream, t_memPool, t_streamId);
@@ -59,6 +61,7 @@ RsSink::RsSink(UsageEnvironment& t_env, MediaSubsession& t_subsession, rs2_video
 
 RsSink::~RsSink()
 {
+    envir().taskScheduler().unscheduleDelayedTask(m_retryTask);
     if(m_receiveBuffer != nullptr)
     {
         m_memPool->returnMem(m_receiveBuffer);
@@ -107,9 +110,13 @@ void RsSink::afterGettingFrame(unsigned t_frameSize, unsigned t_numTruncatedByte
         {
             if(CompressionFactory::isCompressionSupported(m_stream.fmt, m_stream.type) && m_iCompress != nullptr)
             {
-                m_to = m_memPool->getNextMem();
+                // decoded straight into the buffer the frame is handed to librealsense in, the one copy it takes
+                m_to = m_memPool->getNextMem(m_bufferSize);
                 if(m_to == nullptr)
                 {
+                    m_memPool->returnMem(m_receiveBuffer);
+                    m_receiveBuffer = nullptr;
+                    continuePlaying();
                     return;
                 }
                 int decompressedSize = m_iCompress->decompressBuffer(m_receiveBuffer + sizeof(RsFrameHeader), header->data.frameSize - sizeof(RsMetadataHeader), m_to + sizeof(RsFrameHeader));
@@ -119,6 +126,11 @@ void RsSink::afterGettingFrame(unsigned t_frameSize, unsigned t_numTruncatedByte
                     memcpy(m_to + sizeof(RsNetworkHeader), m_receiveBuffer + sizeof(RsNetworkHeader), sizeof(RsMetadataHeader));
                     this->m_rtpCallback->on_frame((u_int8_t*)m_to + sizeof(RsNetworkHeader), decompressedSize + sizeof(RsMetadataHeader), t_presentationTime);
                 }
+                else
+                {
+                    m_memPool->returnMem(m_to);
+                }
+                m_to = nullptr;
                 m_memPool->returnMem(m_receiveBuffer);
             }
             else
@@ -150,10 +162,12 @@ Boolean RsSink::continuePlaying()
         return False; // sanity check (should not happen)
 
     // Request the next frame of data from our input source.  "afterGettingFrame()" will get called later, when it arrives:
-    m_receiveBuffer = m_memPool->getNextMem();
+    m_receiveBuffer = m_memPool->getNextMem(m_bufferSize);
     if(m_receiveBuffer == nullptr)
     {
-        return false;
+        // all buffers are held by frames not yet released, try again once some may be
+        m_retryTask = envir().taskScheduler().scheduleDelayedTask(POOL_RETRY_INTERVAL_US, retryPlaying, this);
+        return True;
     }
 
     if(m_stream.uid >= 0 && m_stream.uid < m_afterGettingFunctions.size())
@@ -168,6 +182,13 @@ Boolean RsSink::continuePlaying()
     return True;
 }
 
+void RsSink::retryPlaying(void* t_clientData)
+{
+    RsSink* sink = (RsSink*)t_clientData;
+    sink->m_retryTask = nullptr;
+    sink->continuePlaying();
+}
+
 void RsSink::setCallback(rtp_callback* t_callback)
 {
     this->m_rtpCallback = t_callback;
@@ -34,6 +34,7 @@ private:
     static void afterGettingFrameUid2(void* t_clientData, unsigned t_frameSize, unsigned t_numTruncatedBytes, struct timeval t_presentationTime, unsigned t_durationInMicroseconds);
     static void afterGettingFrameUid3(void* t_clientData, unsigned t_frameSize, unsigned t_numTruncatedBytes, struct timeval t_presentationTime, unsigned t_durationInMicroseconds);
     void afterGettingFrame(unsigned t_frameSize, unsigned t_numTruncatedBytes, struct timeval t_presentationTime, unsigned t_durationInMicroseconds);
+    static void retryPlaying(void* t_clientData);
 
 private:
     // redefined virtual functions:
@@ -51,6 +52,7 @@ private:
     rs2_video_stream m_stream;
     std::shared_ptr<ICompression> m_iCompress;
     MemoryPool* m_memPool;
+    TaskToken m_retryTask = nullptr;
     std::vector<FramedSource::afterGettingFunc*> m_afterGettingFunctions;
 };
 
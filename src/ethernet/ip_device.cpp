@@ -64,6 +64,10 @@ void ip_device::stop_sensor_streams(int sensor_index)
             inject_frames_thread[key].join();
     }
     remote_sensors[sensor_index]->active_streams_keys.clear();
+
+    MemoryPool::Stats stats = rs_rtp_stream::get_memory_pool().getStats();
+    INF << "Memory pool: " << stats.inUse << " buffers in use, " << stats.peakInUse << " at most, " << stats.hits << " reused, "
+        << stats.misses << " allocated, " << stats.released << " freed, " << stats.exhausted << " requests refused";
 }
 
 ip_device::ip_device(rs2::software_device sw_device, std::string ip_address)
@@ -367,18 +371,19 @@ void ip_device::inject_frames_loop(std::shared_ptr<rs_rtp_stream> rtp_stream)
 
         while(rtp_stream.get()->is_enabled == true)
         {
-            if(rtp_stream.get()->queue_size() != 0)
+            // the frame takes over the buffer its pixels were received or decoded into, no copy
+            Raw_Frame frame;
+            if(rtp_stream.get()->extract_frame(frame, std::chrono::milliseconds(RTP_QUEUE_WAIT_INTERVAL)))
             {
-                Raw_Frame* frame = rtp_stream.get()->extract_frame();
-                rtp_stream.get()->frame_data_buff.pixels = frame->m_buffer;
+                rtp_stream.get()->frame_data_buff.pixels = frame.m_buffer;
 
-                rtp_stream.get()->frame_data_buff.timestamp = frame->m_metadata->data.timestamp;
+                rtp_stream.get()->frame_data_buff.timestamp = frame.m_metadata->data.timestamp;
 
                 rtp_stream.get()->frame_data_buff.frame_number++;
-                rtp_stream.get()->frame_data_buff.domain = frame->m_metadata->data.timestampDomain;
+                rtp_stream.get()->frame_data_buff.domain = frame.m_metadata->data.timestampDomain;
 
                 remote_sensors[sensor_id]->sw_sensor->set_metadata(RS2_FRAME_METADATA_FRAME_TIMESTAMP, rtp_stream.get()->frame_data_buff.timestamp);
-                remote_sensors[sensor_id]->sw_sensor->set_metadata(RS2_FRAME_METADATA_ACTUAL_FPS, frame->m_metadata->data.actualFps);
+                remote_sensors[sensor_id]->sw_sensor->set_metadata(RS2_FRAME_METADATA_ACTUAL_FPS, frame.m_metadata->data.actualFps);
                 remote_sensors[sensor_id]->sw_sensor->set_metadata(RS2_FRAME_METADATA_FRAME_COUNTER, rtp_stream.get()->frame_data_buff.frame_number);
                 remote_sensors[sensor_id]->sw_sensor->set_metadata(RS2_FRAME_METADATA_FRAME_EMITTER_MODE, 1);
 
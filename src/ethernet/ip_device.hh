@@ -20,6 +20,8 @@
 
 #define POLLING_SW_DEVICE_STATE_INTERVAL 100
 
+#define RTP_QUEUE_WAIT_INTERVAL 100
+
 #define DEFAULT_PROFILE_FPS 15
 
 #define DEFAULT_PROFILE_WIDTH 424
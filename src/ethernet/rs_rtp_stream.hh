@@ -11,21 +11,22 @@
 
 #include <NetdevLog.h>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+
 const int RTP_QUEUE_MAX_SIZE = 30;
 
+// A received frame, its pixels in a buffer of the memory pool that the frame injected to librealsense
+// takes over
 struct Raw_Frame
 {
+    Raw_Frame() = default;
     Raw_Frame(char* buffer, int size, struct timeval timestamp)
         : m_metadata((RsMetadataHeader*)buffer)
         , m_buffer(buffer + sizeof(RsMetadataHeader))
         , m_size(size)
         , m_timestamp(timestamp){};
-    Raw_Frame(const Raw_Frame&);
-    Raw_Frame& operator=(const Raw_Frame&);
-    ~Raw_Frame()
-    {
-        delete[] m_buffer;
-    };
 
     RsMetadataHeader* m_metadata;
     char* m_buffer;
@@ -60,37 +61,44 @@ public:
         return m_rs_stream.type;
     }
 
-    void insert_frame(Raw_Frame* new_raw_frame)
+    void insert_frame(const Raw_Frame& new_raw_frame)
     {
-        if(queue_size() > RTP_QUEUE_MAX_SIZE)
-        {
-            ERR << "Queue is full. Dropping frame for: " << this->m_rs_stream.uid;
-        }
-        else
         {
             std::lock_guard<std::mutex> lock(this->stream_lock);
-            frames_queue.push(new_raw_frame);
+            if(frames_queue.size() < RTP_QUEUE_MAX_SIZE)
+            {
+                frames_queue.push(new_raw_frame);
+                frames_available.notify_one();
+                return;
+            }
         }
+        ERR << "Queue is full. Dropping frame for: " << this->m_rs_stream.uid;
+        frame_deleter(new_raw_frame.m_buffer);
     }
 
     // extrinsics between this stream to all other streams
     // the key is generated by RsRTSPClient::getStreamProfileUniqueKey function
     std::map<long long int, rs2_extrinsics> extrinsics_map;
 
-    Raw_Frame* extract_frame()
+    // Waits up to t_timeout for a frame, false when none came
+    bool extract_frame(Raw_Frame& t_frame, std::chrono::milliseconds t_timeout)
     {
-        std::lock_guard<std::mutex> lock(this->stream_lock);
-        Raw_Frame* frame = frames_queue.front();
+        std::unique_lock<std::mutex> lock(this->stream_lock);
+        if(!frames_available.wait_for(lock, t_timeout, [this] { return !frames_queue.empty(); }))
+        {
+            return false;
+        }
+        t_frame = frames_queue.front();
         frames_queue.pop();
-        return frame;
+        return true;
     }
 
     void reset_queue()
     {
+        std::lock_guard<std::mutex> lock(this->stream_lock);
         while(!frames_queue.empty())
         {
-            Raw_Frame* frame = frames_queue.front();
-            get_memory_pool().returnMem((unsigned char*)frame->m_buffer - sizeof(RsFrameHeader));
+            frame_deleter(frames_queue.front().m_buffer);
             frames_queue.pop();
         }
         INF << "Frames queue cleaned for " << m_rs_stream.uid;
@@ -104,11 +112,11 @@ public:
 
     static MemoryPool& get_memory_pool()
     {
-        static MemoryPool memory_pool_instance = MemoryPool();
+        static MemoryPool memory_pool_instance;
         return memory_pool_instance;
     }
 
-    bool is_enabled;
+    std::atomic<bool> is_enabled;
 
     rs2_video_stream m_rs_stream;
 
@@ -124,7 +132,9 @@ private:
 
     std::mutex stream_lock;
 
-    std::queue<Raw_Frame*> frames_queue;
+    std::condition_variable frames_available;
+
+    std::queue<Raw_Frame> frames_queue;
 
     std::vector<uint8_t> pixels_buff;
 };
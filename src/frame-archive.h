@@ -16,8 +16,7 @@ namespace librealsense
         std::shared_ptr<metadata_parser_map> _metadata_parsers = nullptr;
         callbacks_heap callback_inflight;
 
-        std::vector<T> freelist; // return frames here
-        std::atomic<bool> recycle_frames;
+        std::shared_ptr<frame_buffer_pool> _pool; // frame buffers are recycled here
         int pending_frames = 0;
         std::recursive_mutex mutex;
         std::shared_ptr<platform::time_service> _time_service;
@@ -29,35 +28,10 @@ namespace librealsense
         T alloc_frame(const size_t size, const frame_additional_data& additional_data, bool requires_memory)
         {
             T backbuffer;
-            //const size_t size = modes[stream].get_image_size(stream);
-            {
-                std::lock_guard<std::recursive_mutex> guard(mutex);
-
-                if (requires_memory)
-                {
-                    // Attempt to obtain a buffer of the appropriate size from the freelist
-                    for (auto it = begin(freelist); it != end(freelist); ++it)
-                    {
-                        if (it->data.size() == size)
-                        {
-                            backbuffer = std::move(*it);
-                            freelist.erase(it);
-                            break;
-                        }
-                    }
-                }
-
-                // Discard buffers that have been in the freelist for longer than 1s
-                for (auto it = begin(freelist); it != end(freelist);)
-                {
-                    if (additional_data.timestamp > it->additional_data.timestamp + 1000) it = freelist.erase(it);
-                    else ++it;
-                }
-            }
-
             if (requires_memory)
             {
-                backbuffer.data.resize(size, 0); // TODO: Allow users to provide a custom allocator for frame buffers
+                backbuffer.data = frame_buffer(frame_buffer_allocator<byte>(_pool));
+                backbuffer.data.resize(size); // buffers are not zero-initialized, producers overwrite the whole frame
             }
             backbuffer.additional_data = additional_data;
             return backbuffer;
@@ -87,13 +61,9 @@ namespace librealsense
                 std::unique_lock<std::recursive_mutex> lock(mutex);
 
                 frame->keep();
-
-                if (recycle_frames)
-                {
-                    freelist.push_back(std::move(*f));
-                }
                 lock.unlock();
 
+                // Releasing the frame hands its buffer back to the pool
                 if (f->is_fixed())
                     published_frames.deallocate(f);
                 else
@@ -164,9 +134,10 @@ namespace librealsense
     public:
         explicit frame_archive(std::atomic<uint32_t>* in_max_frame_queue_size,
             std::shared_ptr<platform::time_service> ts,
-            std::shared_ptr<metadata_parser_map> parsers)
+            std::shared_ptr<metadata_parser_map> parsers,
+            std::shared_ptr<frame_buffer_pool> pool = std::make_shared<frame_buffer_pool>())
             : max_frame_queue_size(in_max_frame_queue_size),
-            mutex(), recycle_frames(true), _time_service(ts),
+            _pool(pool), mutex(), _time_service(ts),
             _metadata_parsers(parsers)
         {
             published_frames_count = 0;
@@ -192,7 +163,6 @@ namespace librealsense
         {
             published_frames.stop_allocation();
             callback_inflight.stop_allocation();
-            recycle_frames = false;
 
             auto callbacks_inflight = callback_inflight.get_size();
             if (callbacks_inflight > 0)
@@ -202,11 +172,6 @@ namespace librealsense
             // wait until user is done with all the stuff he chose to borrow
             callback_inflight.wait_until_empty();
 
-            {
-                std::lock_guard<std::recursive_mutex> guard(mutex);
-                freelist.clear();
-            }
-
             pending_frames = published_frames.get_size();
             if (pending_frames > 0)
             {
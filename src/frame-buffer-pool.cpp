@@ -0,0 +1,218 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "frame-buffer-pool.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace librealsense
+{
+    const size_t POOL_CACHE_LINE_SIZE = 64;
+    const size_t POOL_PAGE_SIZE = 4096;
+    const size_t POOL_HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+    const int POOL_CLASS_RELEASING = std::numeric_limits<int>::min() / 2;
+
+    void* default_frame_memory_provider::allocate(size_t size)
+    {
+#ifdef _WIN32
+        return _aligned_malloc(size, POOL_CACHE_LINE_SIZE);
+#else
+        void* ptr = nullptr;
+        auto alignment = size >= POOL_HUGE_PAGE_SIZE ? POOL_HUGE_PAGE_SIZE : POOL_CACHE_LINE_SIZE;
+        if (posix_memalign(&ptr, alignment, size))
+            return nullptr;
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+        if (alignment == POOL_HUGE_PAGE_SIZE)
+            madvise(ptr, size - size % POOL_HUGE_PAGE_SIZE, MADV_HUGEPAGE); // advisory only, failure is harmless
+#endif
+        return ptr;
+#endif
+    }
+
+    void default_frame_memory_provider::deallocate(void* ptr, size_t size)
+    {
+#ifdef _WIN32
+        _aligned_free(ptr);
+#else
+        free(ptr);
+#endif
+    }
+
+    frame_buffer_pool::frame_buffer_pool(std::shared_ptr<frame_memory_provider> provider)
+        : _provider(std::move(provider)), _hits(0), _misses(0), _bypasses(0), _in_use(0), _high_water_mark(0), _bytes_allocated(0)
+    {
+        for (auto&& c : _classes)
+        {
+            c.size = 0;
+            c.users = 0;
+            for (auto&& slot : c.slots)
+                slot = nullptr;
+        }
+    }
+
+    frame_buffer_pool::~frame_buffer_pool()
+    {
+        trim();
+    }
+
+    size_t frame_buffer_pool::round_up(size_t size)
+    {
+        // Small blocks (composite frame tables, motion samples) are rounded to a cache line,
+        // image buffers to a page so that nearly identical frame sizes share a class
+        auto granularity = size < POOL_PAGE_SIZE ? POOL_CACHE_LINE_SIZE : POOL_PAGE_SIZE;
+        return (size + granularity - 1) / granularity * granularity;
+    }
+
+    frame_buffer_pool::size_class* frame_buffer_pool::pin_class(size_t block_size, bool create)
+    {
+        for (auto&& c : _classes)
+        {
+            auto class_size = c.size.load(std::memory_order_acquire);
+            if (class_size != block_size)
+            {
+                // Claim an unused class; another thread may have claimed it for the same size meanwhile
+                if (class_size || !create ||
+                    !(c.size.compare_exchange_strong(class_size, block_size) || class_size == block_size))
+                    continue;
+            }
+
+            // Once pinned the class is ours, unless trim() released it and it went to another size before
+            if (c.users.fetch_add(1, std::memory_order_acquire) >= 0 && c.size.load(std::memory_order_acquire) == block_size)
+                return &c;
+            unpin_class(&c);
+        }
+        return nullptr;
+    }
+
+    void frame_buffer_pool::unpin_class(size_class* c)
+    {
+        c->users.fetch_sub(1, std::memory_order_release);
+    }
+
+    void* frame_buffer_pool::allocate(size_t size)
+    {
+        auto block_size = round_up(size);
+        void* ptr = nullptr;
+
+        if (auto c = pin_class(block_size, true))
+        {
+            for (auto&& slot : c->slots)
+            {
+                if (slot.load(std::memory_order_relaxed) &&
+                    (ptr = slot.exchange(nullptr, std::memory_order_acquire)))
+                    break;
+            }
+            unpin_class(c);
+        }
+        else
+        {
+            // Every class is taken by other sizes until the next trim()
+            ++_bypasses;
+        }
+
+        if (ptr)
+        {
+            ++_hits;
+        }
+        else
+        {
+            ptr = _provider->allocate(block_size);
+            if (!ptr)
+                throw std::bad_alloc();
+            ++_misses;
+            _bytes_allocated += block_size;
+        }
+
+        auto in_use = ++_in_use;
+        auto high = _high_water_mark.load();
+        while (in_use > high && !_high_water_mark.compare_exchange_weak(high, in_use));
+        return ptr;
+    }
+
+    void frame_buffer_pool::deallocate(void* ptr, size_t size)
+    {
+        if (!ptr) return;
+
+        auto block_size = round_up(size);
+        --_in_use;
+
+        if (auto c = pin_class(block_size, false))
+        {
+            for (auto&& slot : c->slots)
+            {
+                void* expected = nullptr;
+                if (!slot.load(std::memory_order_relaxed) &&
+                    slot.compare_exchange_strong(expected, ptr, std::memory_order_release))
+                {
+                    unpin_class(c);
+                    return;
+                }
+            }
+            unpin_class(c);
+        }
+
+        // The class is full (or the pool ran out of classes) - the buffer is not worth keeping
+        _provider->deallocate(ptr, block_size);
+    }
+
+    void frame_buffer_pool::trim()
+    {
+        for (auto&& c : _classes)
+        {
+            // A class no thread has pinned is released along with its buffers. One in use keeps its size
+            // while its buffers are taken, and one another trim() is releasing is left to it
+            int unused = 0;
+            auto release = c.users.compare_exchange_strong(unused, POOL_CLASS_RELEASING);
+            if (!release && c.users.fetch_add(1) < 0)
+            {
+                unpin_class(&c);
+                continue;
+            }
+
+            auto block_size = c.size.load();
+            for (auto&& slot : c.slots)
+            {
+                if (auto ptr = slot.exchange(nullptr))
+                    _provider->deallocate(ptr, block_size);
+            }
+
+            if (release)
+            {
+                c.size.store(0, std::memory_order_release);
+                c.users.fetch_sub(POOL_CLASS_RELEASING, std::memory_order_release);
+            }
+            else
+                unpin_class(&c);
+        }
+    }
+
+    rs2_frame_pool_statistics frame_buffer_pool::get_statistics() const
+    {
+        rs2_frame_pool_statistics stats;
+        stats.hits = _hits;
+        stats.misses = _misses;
+        stats.bypasses = _bypasses;
+        stats.bytes_allocated = _bytes_allocated;
+        stats.in_use = std::max(0, _in_use.load());
+        stats.high_water_mark = _high_water_mark;
+        return stats;
+    }
+
+    void frame_buffer_pool::continue_statistics(const frame_buffer_pool& previous)
+    {
+        _hits += previous._hits;
+        _misses += previous._misses;
+        _bypasses += previous._bypasses;
+        _bytes_allocated += previous._bytes_allocated;
+        auto high = _high_water_mark.load();
+        auto previous_high = previous._high_water_mark.load();
+        while (previous_high > high && !_high_water_mark.compare_exchange_weak(high, previous_high));
+    }
+}
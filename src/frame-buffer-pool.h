@@ -0,0 +1,156 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#pragma once
+
+#include "../include/librealsense2/h/rs_types.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace librealsense
+{
+    // Source of raw memory for frame buffers. The pool never touches the heap directly,
+    // so users can back frames with pinned, shared or device-visible memory
+    class frame_memory_provider
+    {
+    public:
+        virtual void* allocate(size_t size) = 0;
+        virtual void deallocate(void* ptr, size_t size) = 0;
+        virtual ~frame_memory_provider() = default;
+    };
+
+    // Cache-line aligned heap memory. On Linux, buffers of 2MB and up are aligned to
+    // the huge-page size and advised as huge-page candidates to cut TLB misses on large frames
+    class default_frame_memory_provider : public frame_memory_provider
+    {
+    public:
+        void* allocate(size_t size) override;
+        void deallocate(void* ptr, size_t size) override;
+    };
+
+    // Routes allocations to the functions registered through rs2_set_frame_allocator
+    class user_frame_memory_provider : public frame_memory_provider
+    {
+    public:
+        user_frame_memory_provider(rs2_frame_allocate_ptr on_allocate, rs2_frame_release_ptr on_release, void* user)
+            : _on_allocate(on_allocate), _on_release(on_release), _user(user) {}
+
+        void* allocate(size_t size) override { return _on_allocate(size, _user); }
+        void deallocate(void* ptr, size_t size) override { _on_release(ptr, size, _user); }
+
+    private:
+        rs2_frame_allocate_ptr _on_allocate;
+        rs2_frame_release_ptr _on_release;
+        void* _user;
+    };
+
+    // Recycles frame buffers by size class. Each class owns a fixed set of slots that are
+    // claimed and released with a single atomic exchange, so the streaming threads never
+    // serialize on a lock when allocating or returning a frame buffer.
+    // A class is taken by the first size that needs it and kept until trim(), so the sizes
+    // a sensor streams next get the classes of those it streamed before
+    class frame_buffer_pool
+    {
+    public:
+        static const int SIZE_CLASSES = 8;
+        static const int SLOTS_PER_CLASS = 16;
+
+        explicit frame_buffer_pool(std::shared_ptr<frame_memory_provider> provider = std::make_shared<default_frame_memory_provider>());
+        ~frame_buffer_pool();
+
+        void* allocate(size_t size);
+        void deallocate(void* ptr, size_t size);
+
+        // Release every idle buffer back to the memory provider, and the size classes no thread is using
+        void trim();
+
+        rs2_frame_pool_statistics get_statistics() const;
+
+        // Start the counters from those of the pool this one replaces. Buffers still held return to that pool,
+        // so only its high-water mark is taken over, and none of the buffers it has in use
+        void continue_statistics(const frame_buffer_pool& previous);
+
+    private:
+        frame_buffer_pool(const frame_buffer_pool&) = delete;
+        frame_buffer_pool& operator=(const frame_buffer_pool&) = delete;
+
+        struct size_class
+        {
+            std::atomic<size_t> size;
+            std::atomic<int> users;     // threads that pinned the class, or negative while trim() releases it
+            std::atomic<void*> slots[SLOTS_PER_CLASS];
+        };
+
+        static size_t round_up(size_t size);
+
+        // The class of block_size, claiming an unused one when create is set. It keeps its size until unpinned
+        size_class* pin_class(size_t block_size, bool create);
+        static void unpin_class(size_class* c);
+
+        std::shared_ptr<frame_memory_provider> _provider;
+        size_class _classes[SIZE_CLASSES];
+
+        std::atomic<unsigned long long> _hits;
+        std::atomic<unsigned long long> _misses;
+        std::atomic<unsigned long long> _bypasses;
+        std::atomic<int> _in_use;
+        std::atomic<int> _high_water_mark;
+        std::atomic<unsigned long long> _bytes_allocated;
+    };
+
+    // Stateful allocator binding a container to a frame_buffer_pool.
+    // Elements are default-initialized, so sizing a frame buffer never zero-fills it -
+    // every frame producer overwrites the whole buffer anyway
+    template<class T>
+    class frame_buffer_allocator
+    {
+    public:
+        typedef T value_type;
+        typedef std::true_type propagate_on_container_move_assignment;
+        typedef std::true_type propagate_on_container_swap;
+
+        frame_buffer_allocator() = default;
+        explicit frame_buffer_allocator(std::shared_ptr<frame_buffer_pool> pool) : _pool(std::move(pool)) {}
+        template<class U>
+        frame_buffer_allocator(const frame_buffer_allocator<U>& other) : _pool(other.get_pool()) {}
+
+        T* allocate(size_t n)
+        {
+            if (_pool) return static_cast<T*>(_pool->allocate(n * sizeof(T)));
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+
+        void deallocate(T* ptr, size_t n)
+        {
+            if (_pool) _pool->deallocate(ptr, n * sizeof(T));
+            else ::operator delete(ptr);
+        }
+
+        template<class U>
+        void construct(U* ptr) { ::new(static_cast<void*>(ptr)) U; }
+
+        template<class U, class... Args>
+        void construct(U* ptr, Args&&... args) { ::new(static_cast<void*>(ptr)) U(std::forward<Args>(args)...); }
+
+        template<class U>
+        struct rebind { typedef frame_buffer_allocator<U> other; };
+
+        const std::shared_ptr<frame_buffer_pool>& get_pool() const { return _pool; }
+
+    private:
+        std::shared_ptr<frame_buffer_pool> _pool;
+    };
+
+    template<class T, class U>
+    bool operator==(const frame_buffer_allocator<T>& a, const frame_buffer_allocator<U>& b) { return a.get_pool() == b.get_pool(); }
+
+    template<class T, class U>
+    bool operator!=(const frame_buffer_allocator<T>& a, const frame_buffer_allocator<U>& b) { return !(a == b); }
+
+    typedef std::vector<uint8_t, frame_buffer_allocator<uint8_t>> frame_buffer;
+}
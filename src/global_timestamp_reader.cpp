@@ -129,7 +129,7 @@ namespace librealsense
         _active_object([this](dispatcher::cancellable_timer cancellable_timer)
             {
                 polling(cancellable_timer);
-            })
+            }, sampling_interval_ms)
     {
         //LOG_DEBUG("start new time_diff_keeper ");
     }
@@ -216,15 +216,9 @@ namespace librealsense
 
     void time_diff_keeper::polling(dispatcher::cancellable_timer cancellable_timer)
     {
-        unsigned int time_to_sleep = _poll_intervals_ms + _coefs.is_full() * (9 * _poll_intervals_ms);
-        if (cancellable_timer.try_sleep(time_to_sleep))
-        {
-            update_diff_time();
-        }
-        else
-        {
-            LOG_DEBUG("Notification: time_diff_keeper polling loop is being shut-down");
-        }
+        update_diff_time();
+        // Sample less often once the regression window is full
+        _active_object.set_interval(_poll_intervals_ms + _coefs.is_full() * (9 * _poll_intervals_ms));
     }
 
     double time_diff_keeper::get_system_hw_time(double crnt_hw_time, bool& is_ready)
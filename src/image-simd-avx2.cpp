@@ -0,0 +1,783 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "image-simd.h"
+#include <cmath>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+
+namespace librealsense
+{
+    namespace
+    {
+        enum class yuv_output { y8, y16, rgb8, rgba8, bgr8, bgra8 };
+
+        template<bool UYVY, yuv_output FORMAT>
+        unpack_kernel reference_yuv422()
+        {
+            auto& ref = get_reference_unpack_kernels();
+            switch (FORMAT)
+            {
+            case yuv_output::y8: return ref.yuy2_to_y8;
+            case yuv_output::y16: return ref.yuy2_to_y16;
+            case yuv_output::rgb8: return UYVY ? ref.uyvy_to_rgb8 : ref.yuy2_to_rgb8;
+            case yuv_output::rgba8: return UYVY ? ref.uyvy_to_rgba8 : ref.yuy2_to_rgba8;
+            case yuv_output::bgr8: return UYVY ? ref.uyvy_to_bgr8 : ref.yuy2_to_bgr8;
+            default: return UYVY ? ref.uyvy_to_bgra8 : ref.yuy2_to_bgra8;
+            }
+        }
+
+        // Same arithmetic as the SSE4.1 kernel on 32 pixels at a time. The inputs are regrouped
+        // so that each 128-bit lane converts 16 consecutive pixels, and the lanes are put back
+        // in memory order on the way out
+        template<bool UYVY, yuv_output FORMAT>
+        void unpack_yuv422(uint8_t * const d[], const uint8_t * s, int count)
+        {
+            const int bpp = FORMAT == yuv_output::y8 ? 1 : FORMAT == yuv_output::y16 ? 2
+                : FORMAT == yuv_output::rgb8 || FORMAT == yuv_output::bgr8 ? 3 : 4;
+            const int n = count / 32;
+
+            auto src = reinterpret_cast<const __m256i *>(s);
+            auto dst = reinterpret_cast<__m256i *>(d[0]);
+
+            const __m256i zero = _mm256_setzero_si256();
+            const __m256i n100 = _mm256_set1_epi16(100 << 4);
+            const __m256i n208 = _mm256_set1_epi16(208 << 4);
+            const __m256i n298 = _mm256_set1_epi16(298 << 4);
+            const __m256i n409 = _mm256_set1_epi16(409 << 4);
+            const __m256i n516 = _mm256_set1_epi16(516 << 4);
+            const __m256i evens_odds = _mm256_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15,
+                0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+            const __m256i planar = UYVY
+                ? _mm256_setr_epi8(1, 3, 5, 7, 9, 11, 13, 15, 0, 4, 8, 12, 2, 6, 10, 14,
+                                   1, 3, 5, 7, 9, 11, 13, 15, 0, 4, 8, 12, 2, 6, 10, 14)
+                : _mm256_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 5, 9, 13, 3, 7, 11, 15,
+                                   0, 2, 4, 6, 8, 10, 12, 14, 1, 5, 9, 13, 3, 7, 11, 15);
+
+            for (int i = 0; i < n; i++)
+            {
+                __m256i s0 = _mm256_loadu_si256(&src[i * 2]);
+                __m256i s1 = _mm256_loadu_si256(&src[i * 2 + 1]);
+                // Pixels 0-7 and 16-23, then 8-15 and 24-31
+                __m256i yyyyyyyyuuuuvvvv0 = _mm256_shuffle_epi8(_mm256_permute2x128_si256(s0, s1, 0x20), planar);
+                __m256i yyyyyyyyuuuuvvvv8 = _mm256_shuffle_epi8(_mm256_permute2x128_si256(s0, s1, 0x31), planar);
+
+                if (FORMAT == yuv_output::y8)
+                {
+                    _mm256_storeu_si256(&dst[i], _mm256_unpacklo_epi64(yyyyyyyyuuuuvvvv0, yyyyyyyyuuuuvvvv8));
+                    continue;
+                }
+
+                if (FORMAT == yuv_output::y16)
+                {
+                    __m256i y_0_7 = _mm256_unpacklo_epi8(zero, yyyyyyyyuuuuvvvv0);
+                    __m256i y_8_F = _mm256_unpacklo_epi8(zero, yyyyyyyyuuuuvvvv8);
+                    _mm256_storeu_si256(&dst[i * 2], _mm256_permute2x128_si256(y_0_7, y_8_F, 0x20));
+                    _mm256_storeu_si256(&dst[i * 2 + 1], _mm256_permute2x128_si256(y_0_7, y_8_F, 0x31));
+                    continue;
+                }
+
+                __m256i y16__0_7 = _mm256_unpacklo_epi8(yyyyyyyyuuuuvvvv0, zero);
+                __m256i y16__8_F = _mm256_unpacklo_epi8(yyyyyyyyuuuuvvvv8, zero);
+
+                __m256i uv = _mm256_unpackhi_epi32(yyyyyyyyuuuuvvvv0, yyyyyyyyuuuuvvvv8);
+                __m256i u = _mm256_unpacklo_epi8(uv, uv);
+                __m256i v = _mm256_unpackhi_epi8(uv, uv);
+                __m256i u16__0_7 = _mm256_unpacklo_epi8(u, zero);
+                __m256i u16__8_F = _mm256_unpackhi_epi8(u, zero);
+                __m256i v16__0_7 = _mm256_unpacklo_epi8(v, zero);
+                __m256i v16__8_F = _mm256_unpackhi_epi8(v, zero);
+
+                __m256i c16__0_7 = _mm256_slli_epi16(_mm256_subs_epi16(y16__0_7, _mm256_set1_epi16(16)), 4);
+                __m256i d16__0_7 = _mm256_slli_epi16(_mm256_subs_epi16(u16__0_7, _mm256_set1_epi16(128)), 4);
+                __m256i e16__0_7 = _mm256_slli_epi16(_mm256_subs_epi16(v16__0_7, _mm256_set1_epi16(128)), 4);
+                __m256i r16__0_7 = _mm256_min_epi16(_mm256_set1_epi16(255), _mm256_max_epi16(zero, _mm256_add_epi16(_mm256_mulhi_epi16(c16__0_7, n298), _mm256_mulhi_epi16(e16__0_7, n409))));
+                __m256i g16__0_7 = _mm256_min_epi16(_mm256_set1_epi16(255), _mm256_max_epi16(zero, _mm256_sub_epi16(_mm256_sub_epi16(_mm256_mulhi_epi16(c16__0_7, n298), _mm256_mulhi_epi16(d16__0_7, n100)), _mm256_mulhi_epi16(e16__0_7, n208))));
+                __m256i b16__0_7 = _mm256_min_epi16(_mm256_set1_epi16(255), _mm256_max_epi16(zero, _mm256_add_epi16(_mm256_mulhi_epi16(c16__0_7, n298), _mm256_mulhi_epi16(d16__0_7, n516))));
+
+                __m256i c16__8_F = _mm256_slli_epi16(_mm256_subs_epi16(y16__8_F, _mm256_set1_epi16(16)), 4);
+                __m256i d16__8_F = _mm256_slli_epi16(_mm256_subs_epi16(u16__8_F, _mm256_set1_epi16(128)), 4);
+                __m256i e16__8_F = _mm256_slli_epi16(_mm256_subs_epi16(v16__8_F, _mm256_set1_epi16(128)), 4);
+                __m256i r16__8_F = _mm256_min_epi16(_mm256_set1_epi16(255), _mm256_max_epi16(zero, _mm256_add_epi16(_mm256_mulhi_epi16(c16__8_F, n298), _mm256_mulhi_epi16(e16__8_F, n409))));
+                __m256i g16__8_F = _mm256_min_epi16(_mm256_set1_epi16(255), _mm256_max_epi16(zero, _mm256_sub_epi16(_mm256_sub_epi16(_mm256_mulhi_epi16(c16__8_F, n298), _mm256_mulhi_epi16(d16__8_F, n100)), _mm256_mulhi_epi16(e16__8_F, n208))));
+                __m256i b16__8_F = _mm256_min_epi16(_mm256_set1_epi16(255), _mm256_max_epi16(zero, _mm256_add_epi16(_mm256_mulhi_epi16(c16__8_F, n298), _mm256_mulhi_epi16(d16__8_F, n516))));
+
+                const bool bgr = FORMAT == yuv_output::bgr8 || FORMAT == yuv_output::bgra8;
+                __m256i first16__0_7 = bgr ? b16__0_7 : r16__0_7;
+                __m256i third16__0_7 = bgr ? r16__0_7 : b16__0_7;
+                __m256i first16__8_F = bgr ? b16__8_F : r16__8_F;
+                __m256i third16__8_F = bgr ? r16__8_F : b16__8_F;
+
+                __m256i fg8__0_7 = _mm256_unpacklo_epi8(_mm256_shuffle_epi8(first16__0_7, evens_odds), _mm256_shuffle_epi8(g16__0_7, evens_odds));
+                __m256i ta8__0_7 = _mm256_unpacklo_epi8(_mm256_shuffle_epi8(third16__0_7, evens_odds), _mm256_set1_epi8(-1));
+                __m256i px_0_3 = _mm256_unpacklo_epi16(fg8__0_7, ta8__0_7);
+                __m256i px_4_7 = _mm256_unpackhi_epi16(fg8__0_7, ta8__0_7);
+
+                __m256i fg8__8_F = _mm256_unpacklo_epi8(_mm256_shuffle_epi8(first16__8_F, evens_odds), _mm256_shuffle_epi8(g16__8_F, evens_odds));
+                __m256i ta8__8_F = _mm256_unpacklo_epi8(_mm256_shuffle_epi8(third16__8_F, evens_odds), _mm256_set1_epi8(-1));
+                __m256i px_8_B = _mm256_unpacklo_epi16(fg8__8_F, ta8__8_F);
+                __m256i px_C_F = _mm256_unpackhi_epi16(fg8__8_F, ta8__8_F);
+
+                if (FORMAT == yuv_output::rgba8 || FORMAT == yuv_output::bgra8)
+                {
+                    _mm256_storeu_si256(&dst[i * 4], _mm256_permute2x128_si256(px_0_3, px_4_7, 0x20));
+                    _mm256_storeu_si256(&dst[i * 4 + 1], _mm256_permute2x128_si256(px_8_B, px_C_F, 0x20));
+                    _mm256_storeu_si256(&dst[i * 4 + 2], _mm256_permute2x128_si256(px_0_3, px_4_7, 0x31));
+                    _mm256_storeu_si256(&dst[i * 4 + 3], _mm256_permute2x128_si256(px_8_B, px_C_F, 0x31));
+                }
+                else
+                {
+                    __m256i px0 = _mm256_shuffle_epi8(px_0_3, _mm256_setr_epi8(3, 7, 11, 15, 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14,
+                        3, 7, 11, 15, 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14));
+                    __m256i px1 = _mm256_shuffle_epi8(px_4_7, _mm256_setr_epi8(0, 1, 2, 4, 3, 7, 11, 15, 5, 6, 8, 9, 10, 12, 13, 14,
+                        0, 1, 2, 4, 3, 7, 11, 15, 5, 6, 8, 9, 10, 12, 13, 14));
+                    __m256i px2 = _mm256_shuffle_epi8(px_8_B, _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 3, 7, 11, 15, 10, 12, 13, 14,
+                        0, 1, 2, 4, 5, 6, 8, 9, 3, 7, 11, 15, 10, 12, 13, 14));
+                    __m256i px3 = _mm256_shuffle_epi8(px_C_F, _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, 3, 7, 11, 15,
+                        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, 3, 7, 11, 15));
+
+                    // 48 bytes per lane, lane 0 holding pixels 0-15 and lane 1 pixels 16-31
+                    __m256i out0 = _mm256_alignr_epi8(px1, px0, 4);
+                    __m256i out1 = _mm256_alignr_epi8(px2, px1, 8);
+                    __m256i out2 = _mm256_alignr_epi8(px3, px2, 12);
+                    _mm256_storeu_si256(&dst[i * 3], _mm256_permute2x128_si256(out0, out1, 0x20));
+                    _mm256_storeu_si256(&dst[i * 3 + 1], _mm256_permute2x128_si256(out2, out0, 0x30));
+                    _mm256_storeu_si256(&dst[i * 3 + 2], _mm256_permute2x128_si256(out1, out2, 0x31));
+                }
+            }
+
+            uint8_t * tail[] = { d[0] + n * 32 * bpp };
+            reference_yuv422<UYVY, FORMAT>()(tail, s + n * 64, count - n * 32);
+        }
+
+        // Eight pixels per iteration: four in the first 12 bytes of each lane, packed back to
+        // 24 bytes. The last 8 bytes of each store are rewritten by the next iteration
+        void bgr8_to_rgb8(uint8_t * const d[], const uint8_t * s, int count)
+        {
+            const __m256i spread = _mm256_setr_epi32(0, 1, 2, 3, 3, 4, 5, 6);
+            const __m256i pack = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+            const __m256i swap = _mm256_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 12, 13, 14, 15,
+                2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 12, 13, 14, 15);
+            int i = 0;
+            for (; i + 11 <= count; i += 8)
+            {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + i * 3));
+                v = _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(v, spread), swap);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(d[0] + i * 3), _mm256_permutevar8x32_epi32(v, pack));
+            }
+
+            uint8_t * tail[] = { d[0] + i * 3 };
+            get_reference_unpack_kernels().bgr8_to_rgb8(tail, s + i * 3, count - i);
+        }
+
+        void y8i_to_y8_y8(uint8_t * const d[], const uint8_t * s, int count)
+        {
+            const __m256i evens_odds = _mm256_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15,
+                0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+            auto src = reinterpret_cast<const __m256i *>(s);
+            int i = 0;
+            for (; i + 32 <= count; i += 32, src += 2)
+            {
+                __m256i a = _mm256_shuffle_epi8(_mm256_loadu_si256(src), evens_odds);
+                __m256i b = _mm256_shuffle_epi8(_mm256_loadu_si256(src + 1), evens_odds);
+                // Left pixels 0-7, 16-23, 8-15, 24-31 before the lanes are reordered
+                __m256i left = _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(a, b), 0xd8);
+                __m256i right = _mm256_permute4x64_epi64(_mm256_unpackhi_epi64(a, b), 0xd8);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(d[0] + i), left);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(d[1] + i), right);
+            }
+
+            uint8_t * tail[] = { d[0] + i, d[1] + i };
+            get_reference_unpack_kernels().y8i_to_y8_y8(tail, s + i * 2, count - i);
+        }
+
+        // Four Y12I pixels per lane, see the SSE4.1 kernel
+        inline __m256i unpack_y12i_x8(const uint8_t * s)
+        {
+            const __m256i words = _mm256_setr_epi8(1, 2, 4, 5, 7, 8, 10, 11, 0, 1, 3, 4, 6, 7, 9, 10,
+                1, 2, 4, 5, 7, 8, 10, 11, 0, 1, 3, 4, 6, 7, 9, 10);
+            __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(s))),
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + 12)), 1);
+            v = _mm256_shuffle_epi8(v, words);
+            __m256i x = _mm256_blend_epi16(_mm256_srli_epi16(v, 4), _mm256_and_si256(v, _mm256_set1_epi16(0x0fff)), 0xf0);
+            return _mm256_or_si256(_mm256_slli_epi16(x, 6), _mm256_srli_epi16(x, 4));
+        }
+
+        void y12i_to_y16_y16(uint8_t * const d[], const uint8_t * s, int count)
+        {
+            auto left = reinterpret_cast<uint16_t *>(d[0]);
+            auto right = reinterpret_cast<uint16_t *>(d[1]);
+            int i = 0;
+            for (; i + 18 <= count; i += 16)
+            {
+                __m256i a = unpack_y12i_x8(s + i * 3);
+                __m256i b = unpack_y12i_x8(s + i * 3 + 24);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(left + i), _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(a, b), 0xd8));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(right + i), _mm256_permute4x64_epi64(_mm256_unpackhi_epi64(a, b), 0xd8));
+            }
+
+            uint8_t * tail[] = { d[0] + i * 2, d[1] + i * 2 };
+            get_reference_unpack_kernels().y12i_to_y16_y16(tail, s + i * 3, count - i);
+        }
+
+        void y16_10_to_y8(uint8_t * const d[], const uint8_t * s, int count)
+        {
+            const __m256i low_byte = _mm256_set1_epi16(0xff);
+            auto src = reinterpret_cast<const __m256i *>(s);
+            int i = 0;
+            for (; i + 32 <= count; i += 32, src += 2)
+            {
+                __m256i a = _mm256_and_si256(_mm256_srli_epi16(_mm256_loadu_si256(src), 2), low_byte);
+                __m256i b = _mm256_and_si256(_mm256_srli_epi16(_mm256_loadu_si256(src + 1), 2), low_byte);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(d[0] + i), _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xd8));
+            }
+
+            uint8_t * tail[] = { d[0] + i };
+            get_reference_unpack_kernels().y16_10_to_y8(tail, s + i * 2, count - i);
+        }
+
+        void y16_10_to_y16(uint8_t * const d[], const uint8_t * s, int count)
+        {
+            auto src = reinterpret_cast<const __m256i *>(s);
+            auto dst = reinterpret_cast<__m256i *>(d[0]);
+            int i = 0;
+            for (; i + 16 <= count; i += 16)
+                _mm256_storeu_si256(dst++, _mm256_slli_epi16(_mm256_loadu_si256(src++), 6));
+
+            uint8_t * tail[] = { d[0] + i * 2 };
+            get_reference_unpack_kernels().y16_10_to_y16(tail, s + i * 2, count - i);
+        }
+
+        // Two 5-byte groups per lane, see the SSE4.1 kernel
+        void w10_to_y10bpack(uint8_t * const d[], const uint8_t * s, int count)
+        {
+            const __m256i high = _mm256_setr_epi8(-1, 0, -1, 1, -1, 2, -1, 3, -1, 5, -1, 6, -1, 7, -1, 8,
+                -1, 0, -1, 1, -1, 2, -1, 3, -1, 5, -1, 6, -1, 7, -1, 8);
+            const __m256i low = _mm256_setr_epi8(4, -1, 4, -1, 4, -1, 4, -1, 9, -1, 9, -1, 9, -1, 9, -1,
+                4, -1, 4, -1, 4, -1, 4, -1, 9, -1, 9, -1, 9, -1, 9, -1);
+            const __m256i shifts = _mm256_setr_epi16(64, 16, 4, 1, 64, 16, 4, 1, 64, 16, 4, 1, 64, 16, 4, 1);
+            const __m256i low_bits = _mm256_set1_epi16(0xc0);
+
+            auto dst = reinterpret_cast<__m256i *>(d[0]);
+            int i = 0;
+            for (; i + 24 <= count; i += 16)
+            {
+                auto group = s + i / 4 * 5;
+                __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(group))),
+                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(group + 10)), 1);
+                __m256i lsb = _mm256_and_si256(_mm256_mullo_epi16(_mm256_shuffle_epi8(v, low), shifts), low_bits);
+                _mm256_storeu_si256(dst++, _mm256_or_si256(_mm256_shuffle_epi8(v, high), lsb));
+            }
+
+            uint8_t * tail[] = { d[0] + i * 2 };
+            get_reference_unpack_kernels().w10_to_y10bpack(tail, s + i / 4 * 5, count - i);
+        }
+
+        // Same arithmetic as the SSE4.1 kernel on 8 pixels at a time
+        void project_depth(int32_t * dst, const uint16_t * depth, const float * ray_x, const float * ray_y, int count, const depth_projection& p)
+        {
+            __m256 r[9], t[3], c[5];
+            for (int i = 0; i < 9; i++)
+                r[i] = _mm256_set1_ps(p.rotation[i]);
+            for (int i = 0; i < 3; i++)
+                t[i] = _mm256_set1_ps(p.translation[i]);
+            for (int i = 0; i < 5; i++)
+                c[i] = _mm256_set1_ps(p.coeffs[i]);
+            const __m256 scale = _mm256_set1_ps(p.depth_scale);
+            const __m256 fx = _mm256_set1_ps(p.fx), fy = _mm256_set1_ps(p.fy);
+            const __m256 ppx = _mm256_set1_ps(p.ppx), ppy = _mm256_set1_ps(p.ppy);
+            const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1), two = _mm256_set1_ps(2), half = _mm256_set1_ps(0.5f);
+
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256i d = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(depth + i)));
+                __m256 z = _mm256_mul_ps(_mm256_cvtepi32_ps(d), scale);
+                __m256 px = _mm256_mul_ps(z, _mm256_loadu_ps(ray_x + i));
+                __m256 py = _mm256_mul_ps(z, _mm256_loadu_ps(ray_y + i));
+
+                __m256 x = _mm256_add_ps(_mm256_mul_ps(r[0], px), _mm256_add_ps(_mm256_mul_ps(r[3], py), _mm256_add_ps(_mm256_mul_ps(r[6], z), t[0])));
+                __m256 y = _mm256_add_ps(_mm256_mul_ps(r[1], px), _mm256_add_ps(_mm256_mul_ps(r[4], py), _mm256_add_ps(_mm256_mul_ps(r[7], z), t[1])));
+                __m256 w = _mm256_add_ps(_mm256_mul_ps(r[2], px), _mm256_add_ps(_mm256_mul_ps(r[5], py), _mm256_add_ps(_mm256_mul_ps(r[8], z), t[2])));
+                x = _mm256_div_ps(x, w);
+                y = _mm256_div_ps(y, w);
+
+                if (p.distort)
+                {
+                    __m256 r2 = _mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y));
+                    __m256 r4 = _mm256_mul_ps(r2, r2);
+                    __m256 f = _mm256_add_ps(one, _mm256_add_ps(_mm256_mul_ps(c[0], r2),
+                        _mm256_add_ps(_mm256_mul_ps(c[1], r4), _mm256_mul_ps(c[4], _mm256_mul_ps(r2, r4)))));
+                    __m256 xf = _mm256_mul_ps(x, f);
+                    __m256 yf = _mm256_mul_ps(y, f);
+                    __m256 xy = _mm256_mul_ps(xf, yf);
+                    __m256 tangential = _mm256_mul_ps(c[3], _mm256_add_ps(r2, _mm256_mul_ps(two, _mm256_mul_ps(xf, xf))));
+                    x = _mm256_add_ps(xf, _mm256_add_ps(_mm256_mul_ps(two, _mm256_mul_ps(c[2], xy)), tangential));
+                    y = _mm256_add_ps(yf, _mm256_add_ps(_mm256_mul_ps(two, _mm256_mul_ps(c[3], xy)), tangential));
+                }
+
+                // Pixels without depth come out as 0, 0
+                __m256 valid = _mm256_cmp_ps(z, zero, _CMP_NEQ_UQ);
+                __m256 u = _mm256_and_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, fx), ppx), half), valid);
+                __m256 v = _mm256_and_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(y, fy), ppy), half), valid);
+                // The unpacks interleave within each 128-bit lane, giving pixels 0 1 4 5 and 2 3 6 7
+                __m256 lo = _mm256_unpacklo_ps(u, v);
+                __m256 hi = _mm256_unpackhi_ps(u, v);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i * 2), _mm256_cvtps_epi32(_mm256_permute2f128_ps(lo, hi, 0x20)));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i * 2 + 8), _mm256_cvtps_epi32(_mm256_permute2f128_ps(lo, hi, 0x31)));
+            }
+
+            get_reference_unpack_kernels().project_depth(dst + i * 2, depth + i, ray_x + i, ray_y + i, count - i, p);
+        }
+
+        // The SSE4.1 interleave within each 128-bit lane, points 0-3 in the lower lane and 4-7 in
+        // the upper one; the lanes are put back in memory order on the way out
+        inline void interleave_xyz(__m256 x, __m256 y, __m256 z, __m256& out0, __m256& out1, __m256& out2)
+        {
+            __m256 x0x2y0y2 = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+            __m256 z0z2x1x3 = _mm256_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+            __m256 y1y3z1z3 = _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+            __m256 a = _mm256_shuffle_ps(x0x2y0y2, z0z2x1x3, _MM_SHUFFLE(2, 0, 2, 0));
+            __m256 b = _mm256_shuffle_ps(y1y3z1z3, x0x2y0y2, _MM_SHUFFLE(3, 1, 2, 0));
+            __m256 c = _mm256_shuffle_ps(z0z2x1x3, y1y3z1z3, _MM_SHUFFLE(3, 1, 3, 1));
+            out0 = _mm256_permute2f128_ps(a, b, 0x20);
+            out1 = _mm256_permute2f128_ps(c, a, 0x30);
+            out2 = _mm256_permute2f128_ps(b, c, 0x31);
+        }
+
+        inline __m256 load_depth(const uint16_t * depth, __m256 scale)
+        {
+            __m256i d = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(depth)));
+            return _mm256_mul_ps(scale, _mm256_cvtepi32_ps(d));
+        }
+
+        void deproject_xyz(uint8_t * const dst[], const uint16_t * depth, const float * ray_x, const float * ray_y, int count, float depth_scale)
+        {
+            auto out = reinterpret_cast<float *>(dst[0]);
+            const __m256 scale = _mm256_set1_ps(depth_scale);
+
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256 z = load_depth(depth + i, scale);
+                __m256 xyz0, xyz1, xyz2;
+                interleave_xyz(_mm256_mul_ps(z, _mm256_loadu_ps(ray_x + i)), _mm256_mul_ps(z, _mm256_loadu_ps(ray_y + i)), z, xyz0, xyz1, xyz2);
+                _mm256_storeu_ps(out + i * 3, xyz0);
+                _mm256_storeu_ps(out + i * 3 + 8, xyz1);
+                _mm256_storeu_ps(out + i * 3 + 16, xyz2);
+            }
+
+            uint8_t * tail[] = { reinterpret_cast<uint8_t *>(out + i * 3) };
+            get_reference_unpack_kernels().deproject_xyz(tail, depth + i, ray_x + i, ray_y + i, count - i, depth_scale);
+        }
+
+        void deproject_planar(uint8_t * const dst[], const uint16_t * depth, const float * ray_x, const float * ray_y, int count, float depth_scale)
+        {
+            auto x = reinterpret_cast<float *>(dst[0]);
+            auto y = reinterpret_cast<float *>(dst[1]);
+            auto z = reinterpret_cast<float *>(dst[2]);
+            const __m256 scale = _mm256_set1_ps(depth_scale);
+
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256 d = load_depth(depth + i, scale);
+                _mm256_storeu_ps(x + i, _mm256_mul_ps(d, _mm256_loadu_ps(ray_x + i)));
+                _mm256_storeu_ps(y + i, _mm256_mul_ps(d, _mm256_loadu_ps(ray_y + i)));
+                _mm256_storeu_ps(z + i, d);
+            }
+
+            uint8_t * tail[] = { reinterpret_cast<uint8_t *>(x + i), reinterpret_cast<uint8_t *>(y + i), reinterpret_cast<uint8_t *>(z + i) };
+            get_reference_unpack_kernels().deproject_planar(tail, depth + i, ray_x + i, ray_y + i, count - i, depth_scale);
+        }
+
+        // The integer rounding of the scalar float_to_half, on 8 floats at a time
+        inline __m128i float_to_half(__m256 v)
+        {
+            __m256i f = _mm256_castps_si256(v);
+            const __m256i sign = _mm256_and_si256(f, _mm256_set1_epi32(static_cast<int>(0x80000000u)));
+            f = _mm256_xor_si256(f, sign);
+
+            __m256i nan = _mm256_cmpgt_epi32(f, _mm256_set1_epi32(0x7f800000));
+            __m256i overflow = _mm256_blendv_epi8(_mm256_set1_epi32(0x7c00), _mm256_set1_epi32(0x7e00), nan);
+
+            __m256 shifted = _mm256_add_ps(_mm256_castsi256_ps(f), _mm256_set1_ps(0.5f));
+            __m256i subnormal = _mm256_sub_epi32(_mm256_castps_si256(shifted), _mm256_set1_epi32(0x3f000000));
+
+            __m256i odd = _mm256_and_si256(_mm256_srli_epi32(f, 13), _mm256_set1_epi32(1));
+            __m256i h = _mm256_add_epi32(_mm256_add_epi32(f, _mm256_set1_epi32(static_cast<int>(0xc8000fffu))), odd);
+            h = _mm256_srli_epi32(h, 13);
+
+            h = _mm256_blendv_epi8(h, subnormal, _mm256_cmpgt_epi32(_mm256_set1_epi32(0x38800000), f));
+            h = _mm256_blendv_epi8(h, overflow, _mm256_cmpgt_epi32(f, _mm256_set1_epi32(0x477fffff)));
+            h = _mm256_or_si256(h, _mm256_srli_epi32(sign, 16));
+
+            // Every value fits 16 bits, so the saturating pack only narrows them
+            return _mm_packus_epi32(_mm256_castsi256_si128(h), _mm256_extracti128_si256(h, 1));
+        }
+
+        void deproject_xyz_half(uint8_t * const dst[], const uint16_t * depth, const float * ray_x, const float * ray_y, int count, float depth_scale)
+        {
+            auto out = reinterpret_cast<uint16_t *>(dst[0]);
+            const __m256 scale = _mm256_set1_ps(depth_scale);
+
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256 z = load_depth(depth + i, scale);
+                __m256 xyz0, xyz1, xyz2;
+                interleave_xyz(_mm256_mul_ps(z, _mm256_loadu_ps(ray_x + i)), _mm256_mul_ps(z, _mm256_loadu_ps(ray_y + i)), z, xyz0, xyz1, xyz2);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i * 3), float_to_half(xyz0));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i * 3 + 8), float_to_half(xyz1));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i * 3 + 16), float_to_half(xyz2));
+            }
+
+            uint8_t * tail[] = { reinterpret_cast<uint8_t *>(out + i * 3) };
+            get_reference_unpack_kernels().deproject_xyz_half(tail, depth + i, ray_x + i, ray_y + i, count - i, depth_scale);
+        }
+
+        // Regroups 8 interleaved points so that each 128-bit lane holds 4 of them, and splits
+        // those as the SSE4.1 kernel does
+        inline void load_xyz(const float * in, __m256& x, __m256& y, __m256& z)
+        {
+            __m256 xyz0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(in)), _mm_loadu_ps(in + 12), 1);
+            __m256 xyz1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(in + 4)), _mm_loadu_ps(in + 16), 1);
+            __m256 xyz2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(in + 8)), _mm_loadu_ps(in + 20), 1);
+            __m256 y0z0y1z1 = _mm256_shuffle_ps(xyz0, xyz1, _MM_SHUFFLE(1, 0, 2, 1));
+            __m256 x2y2x3y3 = _mm256_shuffle_ps(xyz1, xyz2, _MM_SHUFFLE(2, 1, 3, 2));
+            x = _mm256_shuffle_ps(xyz0, x2y2x3y3, _MM_SHUFFLE(2, 0, 3, 0));
+            y = _mm256_shuffle_ps(y0z0y1z1, x2y2x3y3, _MM_SHUFFLE(3, 1, 2, 0));
+            z = _mm256_shuffle_ps(y0z0y1z1, xyz2, _MM_SHUFFLE(3, 0, 3, 1));
+        }
+
+        inline void store_pairs(float * out, __m256 u, __m256 v)
+        {
+            __m256 lo = _mm256_unpacklo_ps(u, v);
+            __m256 hi = _mm256_unpackhi_ps(u, v);
+            _mm256_storeu_ps(out, _mm256_permute2f128_ps(lo, hi, 0x20));
+            _mm256_storeu_ps(out + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+        }
+
+        // Same arithmetic as the SSE4.1 kernel on 8 points at a time
+        void texture_map(float * tex, float * pixels, const float * points, int count, const point_projection& p)
+        {
+            __m256 r[9], t[3], c[5];
+            for (int i = 0; i < 9; i++)
+                r[i] = _mm256_set1_ps(p.rotation[i]);
+            for (int i = 0; i < 3; i++)
+                t[i] = _mm256_set1_ps(p.translation[i]);
+            for (int i = 0; i < 5; i++)
+                c[i] = _mm256_set1_ps(p.coeffs[i]);
+            const __m256 c2x2 = _mm256_set1_ps(2 * p.coeffs[2]), c3x2 = _mm256_set1_ps(2 * p.coeffs[3]);
+            const __m256 fx = _mm256_set1_ps(p.fx), fy = _mm256_set1_ps(p.fy);
+            const __m256 ppx = _mm256_set1_ps(p.ppx), ppy = _mm256_set1_ps(p.ppy);
+            const __m256 width = _mm256_set1_ps(p.width), height = _mm256_set1_ps(p.height);
+            const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1), two = _mm256_set1_ps(2);
+
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256 px, py, pz;
+                load_xyz(points + i * 3, px, py, pz);
+
+                __m256 x = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[0], px), _mm256_mul_ps(r[3], py)), _mm256_mul_ps(r[6], pz)), t[0]);
+                __m256 y = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[1], px), _mm256_mul_ps(r[4], py)), _mm256_mul_ps(r[7], pz)), t[1]);
+                __m256 w = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[2], px), _mm256_mul_ps(r[5], py)), _mm256_mul_ps(r[8], pz)), t[2]);
+                x = _mm256_div_ps(x, w);
+                y = _mm256_div_ps(y, w);
+
+                if (p.distort)
+                {
+                    __m256 r2 = _mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y));
+                    __m256 f = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(one, _mm256_mul_ps(c[0], r2)), _mm256_mul_ps(_mm256_mul_ps(c[1], r2), r2)),
+                        _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(c[4], r2), r2), r2));
+                    x = _mm256_mul_ps(x, f);
+                    y = _mm256_mul_ps(y, f);
+                    __m256 dx = _mm256_add_ps(_mm256_add_ps(x, _mm256_mul_ps(_mm256_mul_ps(c2x2, x), y)), _mm256_mul_ps(c[3], _mm256_add_ps(r2, _mm256_mul_ps(_mm256_mul_ps(two, x), x))));
+                    __m256 dy = _mm256_add_ps(_mm256_add_ps(y, _mm256_mul_ps(_mm256_mul_ps(c3x2, x), y)), _mm256_mul_ps(c[2], _mm256_add_ps(r2, _mm256_mul_ps(_mm256_mul_ps(two, y), y))));
+                    x = dx;
+                    y = dy;
+                }
+
+                __m256 valid = _mm256_cmp_ps(pz, zero, _CMP_NEQ_UQ);
+                __m256 u = _mm256_and_ps(_mm256_add_ps(_mm256_mul_ps(x, fx), ppx), valid);
+                __m256 v = _mm256_and_ps(_mm256_add_ps(_mm256_mul_ps(y, fy), ppy), valid);
+                store_pairs(pixels + i * 2, u, v);
+                store_pairs(tex + i * 2, _mm256_div_ps(u, width), _mm256_div_ps(v, height));
+            }
+
+            get_reference_unpack_kernels().texture_map(tex + i * 2, pixels + i * 2, points + i * 3, count - i, p);
+        }
+
+        // Eight table entries gathered at a time, back to front as the scalar kernel. In place, a block
+        // overwrites only depth at twice its own index or more, which has been read already
+        void depth_to_disparity(float * dst, const uint16_t * depth, int count, const float * lut)
+        {
+            const int n = count / 8 * 8;
+            get_reference_unpack_kernels().depth_to_disparity(dst + n, depth + n, count - n, lut);
+            for (int i = n - 8; i >= 0; i -= 8)
+            {
+                __m256i index = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(depth + i)));
+                _mm256_storeu_ps(dst + i, _mm256_i32gather_ps(lut, index, 4));
+            }
+        }
+
+        // Sixteen pixels at a time, divided and rounded as the scalar kernel. The truncated integers
+        // keep their low 16 bits, as the scalar conversion does, and are packed back in order
+        void disparity_to_depth(uint16_t * dst, const float * disparity, int count, float factor)
+        {
+            const __m256 f = _mm256_set1_ps(factor), half = _mm256_set1_ps(0.5f);
+            const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+            const __m256 min_normal = _mm256_set1_ps(1.17549435e-38f);
+            const __m256 infinity = _mm256_castsi256_ps(_mm256_set1_epi32(0x7f800000));
+            const __m256i low = _mm256_set1_epi32(0xffff);
+
+            auto convert = [&](const float * src)
+            {
+                __m256 v = _mm256_loadu_ps(src);
+                __m256 a = _mm256_and_ps(v, abs_mask);
+                __m256 normal = _mm256_and_ps(_mm256_cmp_ps(a, min_normal, _CMP_GE_OQ), _mm256_cmp_ps(a, infinity, _CMP_LT_OQ));
+                __m256i d = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_div_ps(f, v), half));
+                return _mm256_and_si256(_mm256_and_si256(d, _mm256_castps_si256(normal)), low);
+            };
+
+            int i = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                __m256i a = convert(disparity + i);
+                __m256i b = convert(disparity + i + 8);
+                __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), packed);
+            }
+
+            get_reference_unpack_kernels().disparity_to_depth(dst + i, disparity + i, count - i, factor);
+        }
+
+        // As the SSE4.1 scan, 32 bytes at a time
+        template<int BYTES>
+        int find_zero(const uint8_t * src, int count)
+        {
+            const int n = 32 / BYTES;
+            const __m256i zero = _mm256_setzero_si256();
+            int i = 0;
+            for (; i + n <= count; i += n)
+            {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i * BYTES));
+                int mask = _mm256_movemask_epi8(BYTES == 2 ? _mm256_cmpeq_epi16(v, zero) : _mm256_cmpeq_epi32(v, zero));
+                if (mask)
+                    return i + lowest_set_bit(uint32_t(mask)) / BYTES;
+            }
+
+            auto& ref = get_reference_unpack_kernels();
+            return i + (BYTES == 2 ? ref.find_zero_u16 : ref.find_zero_u32)(src + i * BYTES, count - i);
+        }
+
+        int find_nonzero_u16(const uint8_t * src, int count)
+        {
+            const __m256i zero = _mm256_setzero_si256();
+            int i = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i * 2));
+                uint32_t mask = ~uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi16(v, zero)));
+                if (mask)
+                    return i + lowest_set_bit(mask) / 2;
+            }
+            return i + get_reference_unpack_kernels().find_nonzero_u16(src + i * 2, count - i);
+        }
+        inline void sort_pair(__m256i& a, __m256i& b)
+        {
+            __m256i t = _mm256_min_epu16(a, b);
+            b = _mm256_max_epu16(a, b);
+            a = t;
+        }
+
+        // 16 blocks at a time, as the SSE4.1 kernel. The planes are packed within the 128-bit lanes,
+        // which the lane-wise median keeps and a single permute puts back in order
+        void median_2x2(uint16_t * dst, const uint16_t * const rows[], int count)
+        {
+            const __m256i low = _mm256_set1_epi32(0xffff), zero = _mm256_setzero_si256();
+            int i = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                __m256i v[4], zeros = zero;
+                for (int n = 0; n < 2; n++)
+                {
+                    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rows[n] + i * 2));
+                    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rows[n] + i * 2 + 16));
+                    v[n * 2] = _mm256_packus_epi32(_mm256_and_si256(a, low), _mm256_and_si256(b, low));
+                    v[n * 2 + 1] = _mm256_packus_epi32(_mm256_srli_epi32(a, 16), _mm256_srli_epi32(b, 16));
+                }
+                for (int n = 0; n < 4; n++)
+                {
+                    __m256i z = _mm256_cmpeq_epi16(v[n], zero);
+                    zeros = _mm256_sub_epi16(zeros, z);
+                    v[n] = _mm256_or_si256(v[n], z);
+                }
+
+                sort_pair(v[0], v[1]); sort_pair(v[2], v[3]);
+                sort_pair(v[0], v[2]); sort_pair(v[1], v[3]);
+                sort_pair(v[1], v[2]);
+
+                __m256i median = _mm256_blendv_epi8(v[0], v[1], _mm256_cmpgt_epi16(_mm256_set1_epi16(2), zeros));
+                median = _mm256_andnot_si256(_mm256_cmpeq_epi16(zeros, _mm256_set1_epi16(4)), median);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_permute4x64_epi64(median, _MM_SHUFFLE(3, 1, 2, 0)));
+            }
+
+            const uint16_t * tail[] = { rows[0] + i * 2, rows[1] + i * 2 };
+            get_reference_unpack_kernels().median_2x2(dst + i, tail, count - i);
+        }
+
+        // 32 columns at a time, summed in 16 bits as the SSE4.1 kernel
+        void column_sum_u8(uint32_t * sums, const uint8_t * const rows[], int row_count, int count)
+        {
+            const __m256i zero = _mm256_setzero_si256();
+            int i = 0;
+            for (; i + 32 <= count; i += 32)
+            {
+                __m256i lo = zero, hi = zero;
+                for (int n = 0; n < row_count; n++)
+                {
+                    auto src = reinterpret_cast<const __m128i *>(rows[n] + i);
+                    lo = _mm256_add_epi16(lo, _mm256_cvtepu8_epi16(_mm_loadu_si128(src)));
+                    hi = _mm256_add_epi16(hi, _mm256_cvtepu8_epi16(_mm_loadu_si128(src + 1)));
+                }
+                auto out = reinterpret_cast<__m256i *>(sums + i);
+                _mm256_storeu_si256(out, _mm256_cvtepu16_epi32(_mm256_castsi256_si128(lo)));
+                _mm256_storeu_si256(out + 1, _mm256_cvtepu16_epi32(_mm256_extracti128_si256(lo, 1)));
+                _mm256_storeu_si256(out + 2, _mm256_cvtepu16_epi32(_mm256_castsi256_si128(hi)));
+                _mm256_storeu_si256(out + 3, _mm256_cvtepu16_epi32(_mm256_extracti128_si256(hi, 1)));
+            }
+
+            const uint8_t * tail[256];
+            for (int n = 0; n < row_count; n++)
+                tail[n] = rows[n] + i;
+            get_reference_unpack_kernels().column_sum_u8(sums + i, tail, row_count, count - i);
+        }
+
+        // 16 columns at a time, as the SSE4.1 kernel
+        void column_sum_u16(uint32_t * sums, uint32_t * nonzero, const uint16_t * const rows[], int row_count, int count)
+        {
+            const __m256i zero = _mm256_setzero_si256();
+            int i = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                __m256i lo = zero, hi = zero, zeros = zero;
+                for (int n = 0; n < row_count; n++)
+                {
+                    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rows[n] + i));
+                    lo = _mm256_add_epi32(lo, _mm256_cvtepu16_epi32(_mm256_castsi256_si128(v)));
+                    hi = _mm256_add_epi32(hi, _mm256_cvtepu16_epi32(_mm256_extracti128_si256(v, 1)));
+                    zeros = _mm256_sub_epi16(zeros, _mm256_cmpeq_epi16(v, zero));
+                }
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(sums + i), lo);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(sums + i + 8), hi);
+                if (nonzero)
+                {
+                    __m256i k = _mm256_sub_epi16(_mm256_set1_epi16(int16_t(row_count)), zeros);
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(nonzero + i), _mm256_cvtepu16_epi32(_mm256_castsi256_si128(k)));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(nonzero + i + 8), _mm256_cvtepu16_epi32(_mm256_extracti128_si256(k, 1)));
+                }
+            }
+
+            const uint16_t * tail[256];
+            for (int n = 0; n < row_count; n++)
+                tail[n] = rows[n] + i;
+            get_reference_unpack_kernels().column_sum_u16(sums + i, nonzero ? nonzero + i : nullptr, tail, row_count, count - i);
+        }
+
+        // The lanes moved up by n across the halves, the lowest n taking -inf
+        template<int N>
+        inline __m256 shift_up(__m256 v)
+        {
+            const __m256i index = _mm256_setr_epi32(0 - N, 1 - N, 2 - N, 3 - N, 4 - N, 5 - N, 6 - N, 7 - N);
+            return _mm256_blend_ps(_mm256_permutevar8x32_ps(v, index), _mm256_set1_ps(-INFINITY), (1 << N) - 1);
+        }
+
+        // 8 pixels at a time as the SSE4.1 kernel, the depths gathered out of the vertices
+        int occlusion_run(const float * pixels, const float * points, int count, float & max_x, float & max_z)
+        {
+            const __m256 zero = _mm256_setzero_ps(), low = _mm256_set1_ps(-INFINITY);
+            const __m256i z_index = _mm256_setr_epi32(2, 5, 8, 11, 14, 17, 20, 23);
+            __m256 running = _mm256_set1_ps(max_x);
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256 p0 = _mm256_loadu_ps(pixels + i * 2), p1 = _mm256_loadu_ps(pixels + i * 2 + 8);
+                __m256 x = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(
+                    _mm256_shuffle_ps(p0, p1, _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0)));
+                __m256 z = _mm256_i32gather_ps(points + i * 3, z_index, 4);
+
+                __m256 valid = _mm256_cmp_ps(z, zero, _CMP_NEQ_UQ);
+                __m256 prefix = _mm256_blendv_ps(low, x, valid);
+                prefix = _mm256_max_ps(prefix, shift_up<1>(prefix));
+                prefix = _mm256_max_ps(prefix, shift_up<2>(prefix));
+                prefix = _mm256_max_ps(prefix, shift_up<4>(prefix));
+                __m256 before = _mm256_max_ps(shift_up<1>(prefix), running);
+                if (_mm256_movemask_ps(_mm256_andnot_ps(_mm256_cmp_ps(x, before, _CMP_GT_OQ), valid)))
+                    break;
+
+                int with_depth = _mm256_movemask_ps(valid);
+                if (with_depth)
+                {
+                    running = _mm256_permutevar8x32_ps(prefix, _mm256_set1_epi32(7));
+                    int last = 7;
+                    while (!(with_depth >> last & 1))
+                        last--;
+                    max_z = points[(i + last) * 3 + 2];
+                }
+            }
+
+            max_x = _mm256_cvtss_f32(running);
+            return i + get_reference_unpack_kernels().occlusion_run(pixels + i * 2, points + i * 3, count - i, max_x, max_z);
+        }
+    }
+
+    bool fill_avx2_kernels(unpack_kernels& k)
+    {
+        k.yuy2_to_y8 = unpack_yuv422<false, yuv_output::y8>;
+        k.yuy2_to_y16 = unpack_yuv422<false, yuv_output::y16>;
+        k.yuy2_to_rgb8 = unpack_yuv422<false, yuv_output::rgb8>;
+        k.yuy2_to_rgba8 = unpack_yuv422<false, yuv_output::rgba8>;
+        k.yuy2_to_bgr8 = unpack_yuv422<false, yuv_output::bgr8>;
+        k.yuy2_to_bgra8 = unpack_yuv422<false, yuv_output::bgra8>;
+        k.uyvy_to_rgb8 = unpack_yuv422<true, yuv_output::rgb8>;
+        k.uyvy_to_rgba8 = unpack_yuv422<true, yuv_output::rgba8>;
+        k.uyvy_to_bgr8 = unpack_yuv422<true, yuv_output::bgr8>;
+        k.uyvy_to_bgra8 = unpack_yuv422<true, yuv_output::bgra8>;
+        k.bgr8_to_rgb8 = bgr8_to_rgb8;
+        k.y8i_to_y8_y8 = y8i_to_y8_y8;
+        k.y12i_to_y16_y16 = y12i_to_y16_y16;
+        k.y16_10_to_y8 = y16_10_to_y8;
+        k.y16_10_to_y16 = y16_10_to_y16;
+        k.w10_to_y10bpack = w10_to_y10bpack;
+        k.project_depth = project_depth;
+        k.deproject_xyz = deproject_xyz;
+        k.deproject_planar = deproject_planar;
+        k.deproject_xyz_half = deproject_xyz_half;
+        k.texture_map = texture_map;
+        k.depth_to_disparity = depth_to_disparity;
+        k.disparity_to_depth = disparity_to_depth;
+        k.find_zero_u16 = find_zero<2>;
+        k.find_zero_u32 = find_zero<4>;
+        k.find_nonzero_u16 = find_nonzero_u16;
+        k.median_2x2 = median_2x2;
+        k.column_sum_u8 = column_sum_u8;
+        k.column_sum_u16 = column_sum_u16;
+        k.occlusion_run = occlusion_run;
+        // An 8x8 tile of 8 or 16-bit pixels fits the 128-bit kernels, those are kept, as is the 3x3
+        // median, whose planes of stride 3 the in-lane shuffles of AVX2 cannot gather, and the bit
+        // planes, whose 64 values are a few 128-bit registers
+        return true;
+    }
+}
+
+#else
+
+namespace librealsense
+{
+    bool fill_avx2_kernels(unpack_kernels&) { return false; }
+}
+
+#endif
@@ -0,0 +1,215 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "image-simd.h"
+
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+#include <immintrin.h>
+
+namespace librealsense
+{
+    namespace
+    {
+        // Sixteen pixels per iteration, four at the start of each lane. The last 16 bytes of
+        // each store are rewritten by the next iteration
+        void bgr8_to_rgb8(uint8_t * const d[], const uint8_t * s, int count)
+        {
+            const __m512i spread = _mm512_setr_epi32(0, 1, 2, 3, 3, 4, 5, 6, 6, 7, 8, 9, 9, 10, 11, 12);
+            const __m512i pack = _mm512_setr_epi32(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, 15, 15, 15, 15);
+            const __m512i swap = _mm512_broadcast_i32x4(_mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 12, 13, 14, 15));
+            int i = 0;
+            for (; i + 22 <= count; i += 16)
+            {
+                __m512i v = _mm512_loadu_si512(s + i * 3);
+                v = _mm512_shuffle_epi8(_mm512_permutexvar_epi32(spread, v), swap);
+                _mm512_storeu_si512(d[0] + i * 3, _mm512_permutexvar_epi32(pack, v));
+            }
+
+            uint8_t * tail[] = { d[0] + i * 3 };
+            get_reference_unpack_kernels().bgr8_to_rgb8(tail, s + i * 3, count - i);
+        }
+
+        void y8i_to_y8_y8(uint8_t * const d[], const uint8_t * s, int count)
+        {
+            const __m512i evens_odds = _mm512_broadcast_i32x4(_mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15));
+            const __m512i lefts = _mm512_setr_epi64(0, 2, 4, 6, 8, 10, 12, 14);
+            const __m512i rights = _mm512_setr_epi64(1, 3, 5, 7, 9, 11, 13, 15);
+            int i = 0;
+            for (; i + 64 <= count; i += 64)
+            {
+                // Each lane holds 8 left then 8 right pixels after the shuffle
+                __m512i a = _mm512_shuffle_epi8(_mm512_loadu_si512(s + i * 2), evens_odds);
+                __m512i b = _mm512_shuffle_epi8(_mm512_loadu_si512(s + i * 2 + 64), evens_odds);
+                _mm512_storeu_si512(d[0] + i, _mm512_permutex2var_epi64(a, lefts, b));
+                _mm512_storeu_si512(d[1] + i, _mm512_permutex2var_epi64(a, rights, b));
+            }
+
+            uint8_t * tail[] = { d[0] + i, d[1] + i };
+            get_reference_unpack_kernels().y8i_to_y8_y8(tail, s + i * 2, count - i);
+        }
+
+        void y16_10_to_y8(uint8_t * const d[], const uint8_t * s, int count)
+        {
+            int i = 0;
+            for (; i + 32 <= count; i += 32)
+            {
+                // The narrowing keeps the low byte, as the scalar cast does
+                __m512i v = _mm512_srli_epi16(_mm512_loadu_si512(s + i * 2), 2);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(d[0] + i), _mm512_cvtepi16_epi8(v));
+            }
+
+            uint8_t * tail[] = { d[0] + i };
+            get_reference_unpack_kernels().y16_10_to_y8(tail, s + i * 2, count - i);
+        }
+
+        void y16_10_to_y16(uint8_t * const d[], const uint8_t * s, int count)
+        {
+            int i = 0;
+            for (; i + 32 <= count; i += 32)
+                _mm512_storeu_si512(d[0] + i * 2, _mm512_slli_epi16(_mm512_loadu_si512(s + i * 2), 6));
+
+            uint8_t * tail[] = { d[0] + i * 2 };
+            get_reference_unpack_kernels().y16_10_to_y16(tail, s + i * 2, count - i);
+        }
+
+        // Splits 48 interleaved floats into the x, y and z of 16 points: a first permute picks
+        // what each of them needs from the first two input registers, a second the rest from the third
+        struct xyz_permutes
+        {
+            __m512i first[3], second[3];
+
+            xyz_permutes()
+            {
+                for (int k = 0; k < 3; k++)
+                {
+                    alignas(64) int32_t a[16], b[16];
+                    for (int j = 0; j < 16; j++)
+                    {
+                        // Component k of point j is float n of the input
+                        int n = j * 3 + k;
+                        a[j] = n < 32 ? n : 0;
+                        b[j] = n < 32 ? j : n - 16;
+                    }
+                    first[k] = _mm512_load_si512(a);
+                    second[k] = _mm512_load_si512(b);
+                }
+            }
+        };
+
+        // Same arithmetic as the SSE4.1 kernel on 16 points at a time. This unit is built without
+        // contracting multiplies and adds, which AVX-512 would otherwise fuse
+        void texture_map(float * tex, float * pixels, const float * points, int count, const point_projection& p)
+        {
+            __m512 r[9], t[3], c[5];
+            for (int i = 0; i < 9; i++)
+                r[i] = _mm512_set1_ps(p.rotation[i]);
+            for (int i = 0; i < 3; i++)
+                t[i] = _mm512_set1_ps(p.translation[i]);
+            for (int i = 0; i < 5; i++)
+                c[i] = _mm512_set1_ps(p.coeffs[i]);
+            const __m512 c2x2 = _mm512_set1_ps(2 * p.coeffs[2]), c3x2 = _mm512_set1_ps(2 * p.coeffs[3]);
+            const __m512 fx = _mm512_set1_ps(p.fx), fy = _mm512_set1_ps(p.fy);
+            const __m512 ppx = _mm512_set1_ps(p.ppx), ppy = _mm512_set1_ps(p.ppy);
+            const __m512 width = _mm512_set1_ps(p.width), height = _mm512_set1_ps(p.height);
+            const __m512 zero = _mm512_setzero_ps(), one = _mm512_set1_ps(1), two = _mm512_set1_ps(2);
+            const xyz_permutes perm;
+            const __m512i pairs_lo = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+            const __m512i pairs_hi = _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+
+            int i = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                __m512 in[3] = { _mm512_loadu_ps(points + i * 3), _mm512_loadu_ps(points + i * 3 + 16), _mm512_loadu_ps(points + i * 3 + 32) };
+                __m512 xyz[3];
+                for (int k = 0; k < 3; k++)
+                    xyz[k] = _mm512_permutex2var_ps(_mm512_permutex2var_ps(in[0], perm.first[k], in[1]), perm.second[k], in[2]);
+                __m512 px = xyz[0], py = xyz[1], pz = xyz[2];
+
+                __m512 x = _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(r[0], px), _mm512_mul_ps(r[3], py)), _mm512_mul_ps(r[6], pz)), t[0]);
+                __m512 y = _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(r[1], px), _mm512_mul_ps(r[4], py)), _mm512_mul_ps(r[7], pz)), t[1]);
+                __m512 w = _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(r[2], px), _mm512_mul_ps(r[5], py)), _mm512_mul_ps(r[8], pz)), t[2]);
+                x = _mm512_div_ps(x, w);
+                y = _mm512_div_ps(y, w);
+
+                if (p.distort)
+                {
+                    __m512 r2 = _mm512_add_ps(_mm512_mul_ps(x, x), _mm512_mul_ps(y, y));
+                    __m512 f = _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(one, _mm512_mul_ps(c[0], r2)), _mm512_mul_ps(_mm512_mul_ps(c[1], r2), r2)),
+                        _mm512_mul_ps(_mm512_mul_ps(_mm512_mul_ps(c[4], r2), r2), r2));
+                    x = _mm512_mul_ps(x, f);
+                    y = _mm512_mul_ps(y, f);
+                    __m512 dx = _mm512_add_ps(_mm512_add_ps(x, _mm512_mul_ps(_mm512_mul_ps(c2x2, x), y)), _mm512_mul_ps(c[3], _mm512_add_ps(r2, _mm512_mul_ps(_mm512_mul_ps(two, x), x))));
+                    __m512 dy = _mm512_add_ps(_mm512_add_ps(y, _mm512_mul_ps(_mm512_mul_ps(c3x2, x), y)), _mm512_mul_ps(c[2], _mm512_add_ps(r2, _mm512_mul_ps(_mm512_mul_ps(two, y), y))));
+                    x = dx;
+                    y = dy;
+                }
+
+                __mmask16 valid = _mm512_cmp_ps_mask(pz, zero, _CMP_NEQ_UQ);
+                __m512 u = _mm512_maskz_add_ps(valid, _mm512_mul_ps(x, fx), ppx);
+                __m512 v = _mm512_maskz_add_ps(valid, _mm512_mul_ps(y, fy), ppy);
+                _mm512_storeu_ps(pixels + i * 2, _mm512_permutex2var_ps(u, pairs_lo, v));
+                _mm512_storeu_ps(pixels + i * 2 + 16, _mm512_permutex2var_ps(u, pairs_hi, v));
+                u = _mm512_div_ps(u, width);
+                v = _mm512_div_ps(v, height);
+                _mm512_storeu_ps(tex + i * 2, _mm512_permutex2var_ps(u, pairs_lo, v));
+                _mm512_storeu_ps(tex + i * 2 + 16, _mm512_permutex2var_ps(u, pairs_hi, v));
+            }
+
+            get_reference_unpack_kernels().texture_map(tex + i * 2, pixels + i * 2, points + i * 3, count - i, p);
+        }
+
+        // The compares give a bit per element; the tail is loaded under a mask, the elements past
+        // the end reading as non-zero
+        int find_zero_u16(const uint8_t * src, int count)
+        {
+            auto p = reinterpret_cast<const uint16_t *>(src);
+            const __m512i zero = _mm512_setzero_si512();
+            for (int i = 0; i < count; i += 32)
+            {
+                __mmask32 valid = count - i >= 32 ? ~__mmask32(0) : (__mmask32(1) << (count - i)) - 1;
+                __mmask32 mask = _mm512_mask_cmpeq_epi16_mask(valid, _mm512_maskz_loadu_epi16(valid, p + i), zero);
+                if (mask)
+                    return i + lowest_set_bit(mask);
+            }
+            return count;
+        }
+
+        int find_zero_u32(const uint8_t * src, int count)
+        {
+            auto p = reinterpret_cast<const uint32_t *>(src);
+            const __m512i zero = _mm512_setzero_si512();
+            for (int i = 0; i < count; i += 16)
+            {
+                __mmask16 valid = count - i >= 16 ? __mmask16(0xffff) : __mmask16((1u << (count - i)) - 1);
+                __mmask16 mask = _mm512_mask_cmpeq_epi32_mask(valid, _mm512_maskz_loadu_epi32(valid, p + i), zero);
+                if (mask)
+                    return i + lowest_set_bit(mask);
+            }
+            return count;
+        }
+    }
+
+    // Only the byte-shuffling kernels, the texture mapping and the hole scans gain from the wider registers; the
+    // YUV conversions, the packed 10 and 12-bit formats and the deprojection, which is bound by
+    // memory bandwidth, keep their AVX2 kernels
+    bool fill_avx512_kernels(unpack_kernels& k)
+    {
+        k.bgr8_to_rgb8 = bgr8_to_rgb8;
+        k.y8i_to_y8_y8 = y8i_to_y8_y8;
+        k.y16_10_to_y8 = y16_10_to_y8;
+        k.y16_10_to_y16 = y16_10_to_y16;
+        k.texture_map = texture_map;
+        k.find_zero_u16 = find_zero_u16;
+        k.find_zero_u32 = find_zero_u32;
+        return true;
+    }
+}
+
+#else
+
+namespace librealsense
+{
+    bool fill_avx512_kernels(unpack_kernels&) { return false; }
+}
+
+#endif
@@ -0,0 +1,450 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "image-simd.h"
+#include <cmath>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+
+namespace librealsense
+{
+    namespace
+    {
+        enum class yuv_output { y8, y16, rgb8, rgba8, bgr8, bgra8 };
+
+        template<bool UYVY, yuv_output FORMAT>
+        unpack_kernel reference_yuv422()
+        {
+            auto& ref = get_reference_unpack_kernels();
+            switch (FORMAT)
+            {
+            case yuv_output::y8: return ref.yuy2_to_y8;
+            case yuv_output::y16: return ref.yuy2_to_y16;
+            case yuv_output::rgb8: return UYVY ? ref.uyvy_to_rgb8 : ref.yuy2_to_rgb8;
+            case yuv_output::rgba8: return UYVY ? ref.uyvy_to_rgba8 : ref.yuy2_to_rgba8;
+            case yuv_output::bgr8: return UYVY ? ref.uyvy_to_bgr8 : ref.yuy2_to_bgr8;
+            default: return UYVY ? ref.uyvy_to_bgra8 : ref.yuy2_to_bgra8;
+            }
+        }
+
+        // Upper 16 bits of the 32-bit products, as _mm_mulhi_epi16
+        inline int16x8_t mulhi(int16x8_t a, int16_t k)
+        {
+            return vcombine_s16(vshrn_n_s32(vmull_n_s16(vget_low_s16(a), k), 16),
+                                vshrn_n_s32(vmull_n_s16(vget_high_s16(a), k), 16));
+        }
+
+        // (x - offset) * 16
+        inline int16x8_t scaled(uint8x8_t x, int16_t offset)
+        {
+            return vshlq_n_s16(vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(x)), vdupq_n_s16(offset)), 4);
+        }
+
+        inline uint8x16_t zip(uint8x8_t even, uint8x8_t odd)
+        {
+            uint8x8x2_t z = vzip_u8(even, odd);
+            return vcombine_u8(z.val[0], z.val[1]);
+        }
+
+        // 16 pixels per iteration, even and odd pixels sharing their U and V
+        template<bool UYVY, yuv_output FORMAT>
+        void unpack_yuv422(uint8_t * const d[], const uint8_t * s, int count)
+        {
+            const int bpp = FORMAT == yuv_output::y8 ? 1 : FORMAT == yuv_output::y16 ? 2
+                : FORMAT == yuv_output::rgb8 || FORMAT == yuv_output::bgr8 ? 3 : 4;
+            const int n = count / 16;
+            auto dst = d[0];
+
+            for (int i = 0; i < n; i++, s += 32, dst += 16 * bpp)
+            {
+                uint8x8x4_t px = vld4_u8(s);
+                uint8x8_t y_even = UYVY ? px.val[1] : px.val[0];
+                uint8x8_t y_odd = UYVY ? px.val[3] : px.val[2];
+
+                if (FORMAT == yuv_output::y8)
+                {
+                    vst1q_u8(dst, zip(y_even, y_odd));
+                    continue;
+                }
+
+                if (FORMAT == yuv_output::y16)
+                {
+                    uint8x16_t y = zip(y_even, y_odd);
+                    auto out = reinterpret_cast<uint16_t *>(dst);
+                    vst1q_u16(out, vshll_n_u8(vget_low_u8(y), 8));
+                    vst1q_u16(out + 8, vshll_n_u8(vget_high_u8(y), 8));
+                    continue;
+                }
+
+                int16x8_t d16 = scaled(UYVY ? px.val[0] : px.val[1], 128);
+                int16x8_t e16 = scaled(UYVY ? px.val[2] : px.val[3], 128);
+                int16x8_t dr = mulhi(e16, 409 << 4);
+                int16x8_t dg = vaddq_s16(mulhi(d16, 100 << 4), mulhi(e16, 208 << 4));
+                int16x8_t db = mulhi(d16, 516 << 4);
+
+                int16x8_t cy_even = mulhi(scaled(y_even, 16), 298 << 4);
+                int16x8_t cy_odd = mulhi(scaled(y_odd, 16), 298 << 4);
+
+                // Saturating narrowing clamps to [0, 255]
+                uint8x16_t r = zip(vqmovun_s16(vaddq_s16(cy_even, dr)), vqmovun_s16(vaddq_s16(cy_odd, dr)));
+                uint8x16_t g = zip(vqmovun_s16(vsubq_s16(cy_even, dg)), vqmovun_s16(vsubq_s16(cy_odd, dg)));
+                uint8x16_t b = zip(vqmovun_s16(vaddq_s16(cy_even, db)), vqmovun_s16(vaddq_s16(cy_odd, db)));
+
+                const bool bgr = FORMAT == yuv_output::bgr8 || FORMAT == yuv_output::bgra8;
+                if (FORMAT == yuv_output::rgb8 || FORMAT == yuv_output::bgr8)
+                {
+                    uint8x16x3_t out;
+                    out.val[0] = bgr ? b : r;
+                    out.val[1] = g;
+                    out.val[2] = bgr ? r : b;
+                    vst3q_u8(dst, out);
+                }
+                else
+                {
+                    uint8x16x4_t out;
+                    out.val[0] = bgr ? b : r;
+                    out.val[1] = g;
+                    out.val[2] = bgr ? r : b;
+                    out.val[3] = vdupq_n_u8(255);
+                    vst4q_u8(dst, out);
+                }
+            }
+
+            uint8_t * tail[] = { dst };
+            reference_yuv422<UYVY, FORMAT>()(tail, s, count - n * 16);
+        }
+
+        void bgr8_to_rgb8(uint8_t * const d[], const uint8_t * s, int count)
+        {
+            int i = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                uint8x16x3_t px = vld3q_u8(s + i * 3);
+                uint8x16_t b = px.val[0];
+                px.val[0] = px.val[2];
+                px.val[2] = b;
+                vst3q_u8(d[0] + i * 3, px);
+            }
+
+            uint8_t * tail[] = { d[0] + i * 3 };
+            get_reference_unpack_kernels().bgr8_to_rgb8(tail, s + i * 3, count - i);
+        }
+
+        void y8i_to_y8_y8(uint8_t * const d[], const uint8_t * s, int count)
+        {
+            int i = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                uint8x16x2_t px = vld2q_u8(s + i * 2);
+                vst1q_u8(d[0] + i, px.val[0]);
+                vst1q_u8(d[1] + i, px.val[1]);
+            }
+
+            uint8_t * tail[] = { d[0] + i, d[1] + i };
+            get_reference_unpack_kernels().y8i_to_y8_y8(tail, s + i * 2, count - i);
+        }
+
+        inline uint16x8_t widen_10_bit(uint16x8_t x)
+        {
+            return vorrq_u16(vshlq_n_u16(x, 6), vshrq_n_u16(x, 4));
+        }
+
+        void y12i_to_y16_y16(uint8_t * const d[], const uint8_t * s, int count)
+        {
+            auto left = reinterpret_cast<uint16_t *>(d[0]);
+            auto right = reinterpret_cast<uint16_t *>(d[1]);
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                uint8x8x3_t px = vld3_u8(s + i * 3);
+                uint16x8_t l = vorrq_u16(vshll_n_u8(px.val[2], 4), vmovl_u8(vshr_n_u8(px.val[1], 4)));
+                uint16x8_t r = vorrq_u16(vshll_n_u8(vand_u8(px.val[1], vdup_n_u8(0xf)), 8), vmovl_u8(px.val[0]));
+                vst1q_u16(left + i, widen_10_bit(l));
+                vst1q_u16(right + i, widen_10_bit(r));
+            }
+
+            uint8_t * tail[] = { d[0] + i * 2, d[1] + i * 2 };
+            get_reference_unpack_kernels().y12i_to_y16_y16(tail, s + i * 3, count - i);
+        }
+
+        void y16_10_to_y8(uint8_t * const d[], const uint8_t * s, int count)
+        {
+            auto src = reinterpret_cast<const uint16_t *>(s);
+            int i = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                // The narrowing keeps the low byte, as the scalar cast does
+                uint8x8_t a = vshrn_n_u16(vld1q_u16(src + i), 2);
+                uint8x8_t b = vshrn_n_u16(vld1q_u16(src + i + 8), 2);
+                vst1q_u8(d[0] + i, vcombine_u8(a, b));
+            }
+
+            uint8_t * tail[] = { d[0] + i };
+            get_reference_unpack_kernels().y16_10_to_y8(tail, s + i * 2, count - i);
+        }
+
+        void y16_10_to_y16(uint8_t * const d[], const uint8_t * s, int count)
+        {
+            auto src = reinterpret_cast<const uint16_t *>(s);
+            auto dst = reinterpret_cast<uint16_t *>(d[0]);
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+                vst1q_u16(dst + i, vshlq_n_u16(vld1q_u16(src + i), 6));
+
+            uint8_t * tail[] = { d[0] + i * 2 };
+            get_reference_unpack_kernels().y16_10_to_y16(tail, s + i * 2, count - i);
+        }
+
+        // NEON has no byte mask; the compare is narrowed to a 64-bit lane of 8 or 16 bits per element
+        int find_zero_u16(const uint8_t * src, int count)
+        {
+            auto p = reinterpret_cast<const uint16_t *>(src);
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                uint8x8_t zeros = vmovn_u16(vceqq_u16(vld1q_u16(p + i), vdupq_n_u16(0)));
+                uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(zeros), 0);
+                if (mask)
+                    return i + lowest_set_bit(mask) / 8;
+            }
+            return i + get_reference_unpack_kernels().find_zero_u16(src + i * 2, count - i);
+        }
+
+        int find_zero_u32(const uint8_t * src, int count)
+        {
+            auto p = reinterpret_cast<const uint32_t *>(src);
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                uint16x4_t zeros = vmovn_u32(vceqq_u32(vld1q_u32(p + i), vdupq_n_u32(0)));
+                uint64_t mask = vget_lane_u64(vreinterpret_u64_u16(zeros), 0);
+                if (mask)
+                    return i + lowest_set_bit(mask) / 16;
+            }
+            return i + get_reference_unpack_kernels().find_zero_u32(src + i * 4, count - i);
+        }
+
+        int find_nonzero_u16(const uint8_t * src, int count)
+        {
+            auto p = reinterpret_cast<const uint16_t *>(src);
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                uint16x8_t v = vld1q_u16(p + i);
+                uint8x8_t nonzeros = vmovn_u16(vtstq_u16(v, v));
+                uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(nonzeros), 0);
+                if (mask)
+                    return i + lowest_set_bit(mask) / 8;
+            }
+            return i + get_reference_unpack_kernels().find_nonzero_u16(src + i * 2, count - i);
+        }
+        inline void sort_pair(uint16x8_t& a, uint16x8_t& b)
+        {
+            uint16x8_t t = vminq_u16(a, b);
+            b = vmaxq_u16(a, b);
+            a = t;
+        }
+
+        // As the SSE4.1 kernels: zeros made the largest value, the lanes sorted and the median of the k
+        // non-zero ones picked at (k - 1) / 2. The structure loads split the blocks into planes
+        template<int N>
+        uint16x8_t median_of(uint16x8_t * v)
+        {
+            uint16x8_t zeros = vdupq_n_u16(0);
+            for (int n = 0; n < N; n++)
+            {
+                uint16x8_t z = vceqq_u16(v[n], vdupq_n_u16(0));
+                zeros = vsubq_u16(zeros, z);
+                v[n] = vorrq_u16(v[n], z);
+            }
+
+            if (N == 4)
+            {
+                sort_pair(v[0], v[1]); sort_pair(v[2], v[3]);
+                sort_pair(v[0], v[2]); sort_pair(v[1], v[3]);
+                sort_pair(v[1], v[2]);
+            }
+            else
+            {
+                sort_pair(v[0], v[1]); sort_pair(v[3], v[4]); sort_pair(v[6], v[7]);
+                sort_pair(v[1], v[2]); sort_pair(v[4], v[5]); sort_pair(v[7], v[8]);
+                sort_pair(v[0], v[1]); sort_pair(v[3], v[4]); sort_pair(v[6], v[7]);
+                sort_pair(v[0], v[3]); sort_pair(v[3], v[6]); sort_pair(v[0], v[3]);
+                sort_pair(v[1], v[4]); sort_pair(v[4], v[7]); sort_pair(v[1], v[4]);
+                sort_pair(v[2], v[5]); sort_pair(v[5], v[8]); sort_pair(v[2], v[5]);
+                sort_pair(v[1], v[3]); sort_pair(v[5], v[7]); sort_pair(v[2], v[6]);
+                sort_pair(v[4], v[6]); sort_pair(v[2], v[4]); sort_pair(v[2], v[3]);
+                sort_pair(v[5], v[6]);
+            }
+
+            uint16x8_t median = v[0];
+            for (int i = 1; i <= (N - 1) / 2; i++)
+                median = vbslq_u16(vcltq_u16(zeros, vdupq_n_u16(uint16_t(N - 2 * i))), v[i], median);
+            return vbicq_u16(median, vceqq_u16(zeros, vdupq_n_u16(N)));
+        }
+
+        void median_2x2(uint16_t * dst, const uint16_t * const rows[], int count)
+        {
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                uint16x8x2_t r0 = vld2q_u16(rows[0] + i * 2), r1 = vld2q_u16(rows[1] + i * 2);
+                uint16x8_t v[] = { r0.val[0], r0.val[1], r1.val[0], r1.val[1] };
+                vst1q_u16(dst + i, median_of<4>(v));
+            }
+
+            const uint16_t * tail[] = { rows[0] + i * 2, rows[1] + i * 2 };
+            get_reference_unpack_kernels().median_2x2(dst + i, tail, count - i);
+        }
+
+        void median_3x3(uint16_t * dst, const uint16_t * const rows[], int count)
+        {
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                uint16x8_t v[9];
+                for (int n = 0; n < 3; n++)
+                {
+                    uint16x8x3_t r = vld3q_u16(rows[n] + i * 3);
+                    v[n * 3] = r.val[0];
+                    v[n * 3 + 1] = r.val[1];
+                    v[n * 3 + 2] = r.val[2];
+                }
+                vst1q_u16(dst + i, median_of<9>(v));
+            }
+
+            const uint16_t * tail[] = { rows[0] + i * 3, rows[1] + i * 3, rows[2] + i * 3 };
+            get_reference_unpack_kernels().median_3x3(dst + i, tail, count - i);
+        }
+
+        // 16 columns at a time, summed in 16 bits
+        void column_sum_u8(uint32_t * sums, const uint8_t * const rows[], int row_count, int count)
+        {
+            int i = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                uint16x8_t lo = vdupq_n_u16(0), hi = vdupq_n_u16(0);
+                for (int n = 0; n < row_count; n++)
+                {
+                    uint8x16_t v = vld1q_u8(rows[n] + i);
+                    lo = vaddw_u8(lo, vget_low_u8(v));
+                    hi = vaddw_u8(hi, vget_high_u8(v));
+                }
+                vst1q_u32(sums + i, vmovl_u16(vget_low_u16(lo)));
+                vst1q_u32(sums + i + 4, vmovl_u16(vget_high_u16(lo)));
+                vst1q_u32(sums + i + 8, vmovl_u16(vget_low_u16(hi)));
+                vst1q_u32(sums + i + 12, vmovl_u16(vget_high_u16(hi)));
+            }
+
+            const uint8_t * tail[256];
+            for (int n = 0; n < row_count; n++)
+                tail[n] = rows[n] + i;
+            get_reference_unpack_kernels().column_sum_u8(sums + i, tail, row_count, count - i);
+        }
+
+        void column_sum_u16(uint32_t * sums, uint32_t * nonzero, const uint16_t * const rows[], int row_count, int count)
+        {
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                uint32x4_t lo = vdupq_n_u32(0), hi = vdupq_n_u32(0);
+                uint16x8_t zeros = vdupq_n_u16(0);
+                for (int n = 0; n < row_count; n++)
+                {
+                    uint16x8_t v = vld1q_u16(rows[n] + i);
+                    lo = vaddw_u16(lo, vget_low_u16(v));
+                    hi = vaddw_u16(hi, vget_high_u16(v));
+                    zeros = vsubq_u16(zeros, vceqq_u16(v, vdupq_n_u16(0)));
+                }
+                vst1q_u32(sums + i, lo);
+                vst1q_u32(sums + i + 4, hi);
+                if (nonzero)
+                {
+                    uint16x8_t k = vsubq_u16(vdupq_n_u16(uint16_t(row_count)), zeros);
+                    vst1q_u32(nonzero + i, vmovl_u16(vget_low_u16(k)));
+                    vst1q_u32(nonzero + i + 4, vmovl_u16(vget_high_u16(k)));
+                }
+            }
+
+            const uint16_t * tail[256];
+            for (int n = 0; n < row_count; n++)
+                tail[n] = rows[n] + i;
+            get_reference_unpack_kernels().column_sum_u16(sums + i, nonzero ? nonzero + i : nullptr, tail, row_count, count - i);
+        }
+
+        // As the SSE4.1 kernel, the structure loads splitting x and z out of the pixels and vertices.
+        // The NaN a maximum here gives fails the block all the same
+        int occlusion_run(const float * pixels, const float * points, int count, float & max_x, float & max_z)
+        {
+            const float32x4_t zero = vdupq_n_f32(0), low = vdupq_n_f32(-INFINITY);
+            float32x4_t running = vdupq_n_f32(max_x);
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                float32x4_t x = vld2q_f32(pixels + i * 2).val[0];
+                float32x4_t z = vld3q_f32(points + i * 3).val[2];
+
+                uint32x4_t valid = vmvnq_u32(vceqq_f32(z, zero));
+                float32x4_t prefix = vbslq_f32(valid, x, low);
+                prefix = vmaxq_f32(prefix, vextq_f32(low, prefix, 3));
+                prefix = vmaxq_f32(prefix, vextq_f32(low, prefix, 2));
+                float32x4_t before = vmaxq_f32(vextq_f32(low, prefix, 3), running);
+                uint16x4_t failed = vmovn_u32(vbicq_u32(valid, vcgtq_f32(x, before)));
+                if (vget_lane_u64(vreinterpret_u64_u16(failed), 0))
+                    break;
+
+                uint64_t with_depth = vget_lane_u64(vreinterpret_u64_u16(vmovn_u32(valid)), 0);
+                if (with_depth)
+                {
+                    running = vdupq_lane_f32(vget_high_f32(prefix), 1);
+                    int last = 3;
+                    while (!(with_depth >> (last * 16) & 1))
+                        last--;
+                    max_z = points[(i + last) * 3 + 2];
+                }
+            }
+
+            max_x = vgetq_lane_f32(running, 0);
+            return i + get_reference_unpack_kernels().occlusion_run(pixels + i * 2, points + i * 3, count - i, max_x, max_z);
+        }
+    }
+
+    // The 5-byte W10 groups and the tile rotations stay with the scalar references
+    bool fill_neon_kernels(unpack_kernels& k)
+    {
+        k.yuy2_to_y8 = unpack_yuv422<false, yuv_output::y8>;
+        k.yuy2_to_y16 = unpack_yuv422<false, yuv_output::y16>;
+        k.yuy2_to_rgb8 = unpack_yuv422<false, yuv_output::rgb8>;
+        k.yuy2_to_rgba8 = unpack_yuv422<false, yuv_output::rgba8>;
+        k.yuy2_to_bgr8 = unpack_yuv422<false, yuv_output::bgr8>;
+        k.yuy2_to_bgra8 = unpack_yuv422<false, yuv_output::bgra8>;
+        k.uyvy_to_rgb8 = unpack_yuv422<true, yuv_output::rgb8>;
+        k.uyvy_to_rgba8 = unpack_yuv422<true, yuv_output::rgba8>;
+        k.uyvy_to_bgr8 = unpack_yuv422<true, yuv_output::bgr8>;
+        k.uyvy_to_bgra8 = unpack_yuv422<true, yuv_output::bgra8>;
+        k.bgr8_to_rgb8 = bgr8_to_rgb8;
+        k.y8i_to_y8_y8 = y8i_to_y8_y8;
+        k.y12i_to_y16_y16 = y12i_to_y16_y16;
+        k.y16_10_to_y8 = y16_10_to_y8;
+        k.y16_10_to_y16 = y16_10_to_y16;
+        k.find_zero_u16 = find_zero_u16;
+        k.find_zero_u32 = find_zero_u32;
+        k.find_nonzero_u16 = find_nonzero_u16;
+        k.median_2x2 = median_2x2;
+        k.median_3x3 = median_3x3;
+        k.column_sum_u8 = column_sum_u8;
+        k.column_sum_u16 = column_sum_u16;
+        k.occlusion_run = occlusion_run;
+        return true;
+    }
+}
+
+#else
+
+namespace librealsense
+{
+    bool fill_neon_kernels(unpack_kernels&) { return false; }
+}
+
+#endif
@@ -0,0 +1,787 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "image-simd.h"
+#include <cmath>
+
+// MSVC offers the SSE4.1 intrinsics on x64 without defining the macro
+#if defined(__SSE4_1__) || (defined(_MSC_VER) && defined(_M_X64))
+#include <smmintrin.h>
+
+namespace librealsense
+{
+    namespace
+    {
+        enum class yuv_output { y8, y16, rgb8, rgba8, bgr8, bgra8 };
+
+        // Shuffles 8 packed 4:2:2 pixels to yyyyyyyyuuuuvvvv
+        inline __m128i yuv422_planar_mask(bool uyvy)
+        {
+            return uyvy ? _mm_setr_epi8(1, 3, 5, 7, 9, 11, 13, 15, 0, 4, 8, 12, 2, 6, 10, 14)
+                        : _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 5, 9, 13, 3, 7, 11, 15);
+        }
+
+        template<bool UYVY, yuv_output FORMAT>
+        unpack_kernel reference_yuv422()
+        {
+            auto& ref = get_reference_unpack_kernels();
+            switch (FORMAT)
+            {
+            case yuv_output::y8: return ref.yuy2_to_y8;
+            case yuv_output::y16: return ref.yuy2_to_y16;
+            case yuv_output::rgb8: return UYVY ? ref.uyvy_to_rgb8 : ref.yuy2_to_rgb8;
+            case yuv_output::rgba8: return UYVY ? ref.uyvy_to_rgba8 : ref.yuy2_to_rgba8;
+            case yuv_output::bgr8: return UYVY ? ref.uyvy_to_bgr8 : ref.yuy2_to_bgr8;
+            default: return UYVY ? ref.uyvy_to_bgra8 : ref.yuy2_to_bgra8;
+            }
+        }
+
+        // 16 pixels per iteration. Branches on FORMAT are folded away at compile time
+        template<bool UYVY, yuv_output FORMAT>
+        void unpack_yuv422(uint8_t * const d[], const uint8_t * s, int count)
+        {
+            const int bpp = FORMAT == yuv_output::y8 ? 1 : FORMAT == yuv_output::y16 ? 2
+                : FORMAT == yuv_output::rgb8 || FORMAT == yuv_output::bgr8 ? 3 : 4;
+            const int n = count / 16;
+
+            auto src = reinterpret_cast<const __m128i *>(s);
+            auto dst = reinterpret_cast<__m128i *>(d[0]);
+
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i n100 = _mm_set1_epi16(100 << 4);
+            const __m128i n208 = _mm_set1_epi16(208 << 4);
+            const __m128i n298 = _mm_set1_epi16(298 << 4);
+            const __m128i n409 = _mm_set1_epi16(409 << 4);
+            const __m128i n516 = _mm_set1_epi16(516 << 4);
+            const __m128i evens_odds = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+            const __m128i planar = yuv422_planar_mask(UYVY);
+
+            for (int i = 0; i < n; i++)
+            {
+                __m128i yyyyyyyyuuuuvvvv0 = _mm_shuffle_epi8(_mm_loadu_si128(&src[i * 2]), planar);
+                __m128i yyyyyyyyuuuuvvvv8 = _mm_shuffle_epi8(_mm_loadu_si128(&src[i * 2 + 1]), planar);
+
+                if (FORMAT == yuv_output::y8)
+                {
+                    _mm_storeu_si128(&dst[i], _mm_unpacklo_epi64(yyyyyyyyuuuuvvvv0, yyyyyyyyuuuuvvvv8));
+                    continue;
+                }
+
+                if (FORMAT == yuv_output::y16)
+                {
+                    // Y in the high byte of each 16-bit output
+                    _mm_storeu_si128(&dst[i * 2], _mm_unpacklo_epi8(zero, yyyyyyyyuuuuvvvv0));
+                    _mm_storeu_si128(&dst[i * 2 + 1], _mm_unpacklo_epi8(zero, yyyyyyyyuuuuvvvv8));
+                    continue;
+                }
+
+                __m128i y16__0_7 = _mm_unpacklo_epi8(yyyyyyyyuuuuvvvv0, zero);
+                __m128i y16__8_F = _mm_unpacklo_epi8(yyyyyyyyuuuuvvvv8, zero);
+
+                // Retrieve all 16 U and V components as 16-bit values, each duplicated for its pixel pair
+                __m128i uv = _mm_unpackhi_epi32(yyyyyyyyuuuuvvvv0, yyyyyyyyuuuuvvvv8);
+                __m128i u = _mm_unpacklo_epi8(uv, uv);
+                __m128i v = _mm_unpackhi_epi8(uv, uv);
+                __m128i u16__0_7 = _mm_unpacklo_epi8(u, zero);
+                __m128i u16__8_F = _mm_unpackhi_epi8(u, zero);
+                __m128i v16__0_7 = _mm_unpacklo_epi8(v, zero);
+                __m128i v16__8_F = _mm_unpackhi_epi8(v, zero);
+
+                __m128i c16__0_7 = _mm_slli_epi16(_mm_subs_epi16(y16__0_7, _mm_set1_epi16(16)), 4);
+                __m128i d16__0_7 = _mm_slli_epi16(_mm_subs_epi16(u16__0_7, _mm_set1_epi16(128)), 4);
+                __m128i e16__0_7 = _mm_slli_epi16(_mm_subs_epi16(v16__0_7, _mm_set1_epi16(128)), 4);
+                __m128i r16__0_7 = _mm_min_epi16(_mm_set1_epi16(255), _mm_max_epi16(zero, _mm_add_epi16(_mm_mulhi_epi16(c16__0_7, n298), _mm_mulhi_epi16(e16__0_7, n409))));
+                __m128i g16__0_7 = _mm_min_epi16(_mm_set1_epi16(255), _mm_max_epi16(zero, _mm_sub_epi16(_mm_sub_epi16(_mm_mulhi_epi16(c16__0_7, n298), _mm_mulhi_epi16(d16__0_7, n100)), _mm_mulhi_epi16(e16__0_7, n208))));
+                __m128i b16__0_7 = _mm_min_epi16(_mm_set1_epi16(255), _mm_max_epi16(zero, _mm_add_epi16(_mm_mulhi_epi16(c16__0_7, n298), _mm_mulhi_epi16(d16__0_7, n516))));
+
+                __m128i c16__8_F = _mm_slli_epi16(_mm_subs_epi16(y16__8_F, _mm_set1_epi16(16)), 4);
+                __m128i d16__8_F = _mm_slli_epi16(_mm_subs_epi16(u16__8_F, _mm_set1_epi16(128)), 4);
+                __m128i e16__8_F = _mm_slli_epi16(_mm_subs_epi16(v16__8_F, _mm_set1_epi16(128)), 4);
+                __m128i r16__8_F = _mm_min_epi16(_mm_set1_epi16(255), _mm_max_epi16(zero, _mm_add_epi16(_mm_mulhi_epi16(c16__8_F, n298), _mm_mulhi_epi16(e16__8_F, n409))));
+                __m128i g16__8_F = _mm_min_epi16(_mm_set1_epi16(255), _mm_max_epi16(zero, _mm_sub_epi16(_mm_sub_epi16(_mm_mulhi_epi16(c16__8_F, n298), _mm_mulhi_epi16(d16__8_F, n100)), _mm_mulhi_epi16(e16__8_F, n208))));
+                __m128i b16__8_F = _mm_min_epi16(_mm_set1_epi16(255), _mm_max_epi16(zero, _mm_add_epi16(_mm_mulhi_epi16(c16__8_F, n298), _mm_mulhi_epi16(d16__8_F, n516))));
+
+                // Interleave into four registers of four pixels each, in (R, G, B, A) or (B, G, R, A) order
+                const bool bgr = FORMAT == yuv_output::bgr8 || FORMAT == yuv_output::bgra8;
+                __m128i first16__0_7 = bgr ? b16__0_7 : r16__0_7;
+                __m128i third16__0_7 = bgr ? r16__0_7 : b16__0_7;
+                __m128i first16__8_F = bgr ? b16__8_F : r16__8_F;
+                __m128i third16__8_F = bgr ? r16__8_F : b16__8_F;
+
+                __m128i fg8__0_7 = _mm_unpacklo_epi8(_mm_shuffle_epi8(first16__0_7, evens_odds), _mm_shuffle_epi8(g16__0_7, evens_odds));
+                __m128i ta8__0_7 = _mm_unpacklo_epi8(_mm_shuffle_epi8(third16__0_7, evens_odds), _mm_set1_epi8(-1));
+                __m128i px_0_3 = _mm_unpacklo_epi16(fg8__0_7, ta8__0_7);
+                __m128i px_4_7 = _mm_unpackhi_epi16(fg8__0_7, ta8__0_7);
+
+                __m128i fg8__8_F = _mm_unpacklo_epi8(_mm_shuffle_epi8(first16__8_F, evens_odds), _mm_shuffle_epi8(g16__8_F, evens_odds));
+                __m128i ta8__8_F = _mm_unpacklo_epi8(_mm_shuffle_epi8(third16__8_F, evens_odds), _mm_set1_epi8(-1));
+                __m128i px_8_B = _mm_unpacklo_epi16(fg8__8_F, ta8__8_F);
+                __m128i px_C_F = _mm_unpackhi_epi16(fg8__8_F, ta8__8_F);
+
+                if (FORMAT == yuv_output::rgba8 || FORMAT == yuv_output::bgra8)
+                {
+                    _mm_storeu_si128(&dst[i * 4], px_0_3);
+                    _mm_storeu_si128(&dst[i * 4 + 1], px_4_7);
+                    _mm_storeu_si128(&dst[i * 4 + 2], px_8_B);
+                    _mm_storeu_si128(&dst[i * 4 + 3], px_C_F);
+                }
+                else
+                {
+                    // Shuffle the triples to the start and end of each register, then align them
+                    __m128i px0 = _mm_shuffle_epi8(px_0_3, _mm_setr_epi8(3, 7, 11, 15, 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14));
+                    __m128i px1 = _mm_shuffle_epi8(px_4_7, _mm_setr_epi8(0, 1, 2, 4, 3, 7, 11, 15, 5, 6, 8, 9, 10, 12, 13, 14));
+                    __m128i px2 = _mm_shuffle_epi8(px_8_B, _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 3, 7, 11, 15, 10, 12, 13, 14));
+                    __m128i px3 = _mm_shuffle_epi8(px_C_F, _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, 3, 7, 11, 15));
+
+                    _mm_storeu_si128(&dst[i * 3], _mm_alignr_epi8(px1, px0, 4));
+                    _mm_storeu_si128(&dst[i * 3 + 1], _mm_alignr_epi8(px2, px1, 8));
+                    _mm_storeu_si128(&dst[i * 3 + 2], _mm_alignr_epi8(px3, px2, 12));
+                }
+            }
+
+            uint8_t * tail[] = { d[0] + n * 16 * bpp };
+            reference_yuv422<UYVY, FORMAT>()(tail, s + n * 32, count - n * 16);
+        }
+
+        // Five pixels per 16-byte register, the 16th byte is rewritten by the next iteration
+        void bgr8_to_rgb8(uint8_t * const d[], const uint8_t * s, int count)
+        {
+            const __m128i swap = _mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 14, 13, 12, 15);
+            int i = 0;
+            for (; i + 6 <= count; i += 5)
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(d[0] + i * 3),
+                    _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i * 3)), swap));
+
+            uint8_t * tail[] = { d[0] + i * 3 };
+            get_reference_unpack_kernels().bgr8_to_rgb8(tail, s + i * 3, count - i);
+        }
+
+        void y8i_to_y8_y8(uint8_t * const d[], const uint8_t * s, int count)
+        {
+            const __m128i evens_odds = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+            auto src = reinterpret_cast<const __m128i *>(s);
+            int i = 0;
+            for (; i + 16 <= count; i += 16, src += 2)
+            {
+                __m128i a = _mm_shuffle_epi8(_mm_loadu_si128(src), evens_odds);
+                __m128i b = _mm_shuffle_epi8(_mm_loadu_si128(src + 1), evens_odds);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(d[0] + i), _mm_unpacklo_epi64(a, b));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(d[1] + i), _mm_unpackhi_epi64(a, b));
+            }
+
+            uint8_t * tail[] = { d[0] + i, d[1] + i };
+            get_reference_unpack_kernels().y8i_to_y8_y8(tail, s + i * 2, count - i);
+        }
+
+        // Four Y12I pixels (12 bytes) to their left and right 12-bit values, widened to 16 bits
+        inline __m128i unpack_y12i_x4(const uint8_t * s)
+        {
+            // Left words from bytes 1-2 of each pixel, right words from bytes 0-1
+            const __m128i words = _mm_setr_epi8(1, 2, 4, 5, 7, 8, 10, 11, 0, 1, 3, 4, 6, 7, 9, 10);
+            __m128i v = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(s)), words);
+            __m128i x = _mm_blend_epi16(_mm_srli_epi16(v, 4), _mm_and_si128(v, _mm_set1_epi16(0x0fff)), 0xf0);
+            return _mm_or_si128(_mm_slli_epi16(x, 6), _mm_srli_epi16(x, 4));
+        }
+
+        void y12i_to_y16_y16(uint8_t * const d[], const uint8_t * s, int count)
+        {
+            auto left = reinterpret_cast<uint16_t *>(d[0]);
+            auto right = reinterpret_cast<uint16_t *>(d[1]);
+            int i = 0;
+            for (; i + 10 <= count; i += 8)
+            {
+                __m128i a = unpack_y12i_x4(s + i * 3);
+                __m128i b = unpack_y12i_x4(s + i * 3 + 12);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(left + i), _mm_unpacklo_epi64(a, b));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(right + i), _mm_unpackhi_epi64(a, b));
+            }
+
+            uint8_t * tail[] = { d[0] + i * 2, d[1] + i * 2 };
+            get_reference_unpack_kernels().y12i_to_y16_y16(tail, s + i * 3, count - i);
+        }
+
+        void y16_10_to_y8(uint8_t * const d[], const uint8_t * s, int count)
+        {
+            const __m128i low_byte = _mm_set1_epi16(0xff);
+            auto src = reinterpret_cast<const __m128i *>(s);
+            int i = 0;
+            for (; i + 16 <= count; i += 16, src += 2)
+            {
+                __m128i a = _mm_and_si128(_mm_srli_epi16(_mm_loadu_si128(src), 2), low_byte);
+                __m128i b = _mm_and_si128(_mm_srli_epi16(_mm_loadu_si128(src + 1), 2), low_byte);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(d[0] + i), _mm_packus_epi16(a, b));
+            }
+
+            uint8_t * tail[] = { d[0] + i };
+            get_reference_unpack_kernels().y16_10_to_y8(tail, s + i * 2, count - i);
+        }
+
+        void y16_10_to_y16(uint8_t * const d[], const uint8_t * s, int count)
+        {
+            auto src = reinterpret_cast<const __m128i *>(s);
+            auto dst = reinterpret_cast<__m128i *>(d[0]);
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+                _mm_storeu_si128(dst++, _mm_slli_epi16(_mm_loadu_si128(src++), 6));
+
+            uint8_t * tail[] = { d[0] + i * 2 };
+            get_reference_unpack_kernels().y16_10_to_y16(tail, s + i * 2, count - i);
+        }
+
+        // Two 5-byte groups to eight 16-bit pixels: the upper bits go to the high byte, and the
+        // packed low bits of each pixel are multiplied up to bits 6-7
+        void w10_to_y10bpack(uint8_t * const d[], const uint8_t * s, int count)
+        {
+            const __m128i high = _mm_setr_epi8(-1, 0, -1, 1, -1, 2, -1, 3, -1, 5, -1, 6, -1, 7, -1, 8);
+            const __m128i low = _mm_setr_epi8(4, -1, 4, -1, 4, -1, 4, -1, 9, -1, 9, -1, 9, -1, 9, -1);
+            const __m128i shifts = _mm_setr_epi16(64, 16, 4, 1, 64, 16, 4, 1);
+            const __m128i low_bits = _mm_set1_epi16(0xc0);
+
+            auto dst = reinterpret_cast<__m128i *>(d[0]);
+            int i = 0;
+            for (; i + 16 <= count; i += 8)
+            {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i / 4 * 5));
+                __m128i lsb = _mm_and_si128(_mm_mullo_epi16(_mm_shuffle_epi8(v, low), shifts), low_bits);
+                _mm_storeu_si128(dst++, _mm_or_si128(_mm_shuffle_epi8(v, high), lsb));
+            }
+
+            uint8_t * tail[] = { d[0] + i * 2 };
+            get_reference_unpack_kernels().w10_to_y10bpack(tail, s + i / 4 * 5, count - i);
+        }
+
+        // Rows are loaded bottom-up, so that after a transpose output row r is column 7 - r
+        void rotate_8x8_u8(uint8_t * dst, int dst_stride, const uint8_t * src, int src_stride)
+        {
+            __m128i r[8];
+            for (int k = 0; k < 8; k++)
+                r[k] = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + (7 - k) * src_stride));
+
+            __m128i a = _mm_unpacklo_epi8(r[0], r[1]);
+            __m128i b = _mm_unpacklo_epi8(r[2], r[3]);
+            __m128i c = _mm_unpacklo_epi8(r[4], r[5]);
+            __m128i e = _mm_unpacklo_epi8(r[6], r[7]);
+            __m128i ab_0_3 = _mm_unpacklo_epi16(a, b);
+            __m128i ab_4_7 = _mm_unpackhi_epi16(a, b);
+            __m128i ce_0_3 = _mm_unpacklo_epi16(c, e);
+            __m128i ce_4_7 = _mm_unpackhi_epi16(c, e);
+            __m128i cols[4] = {
+                _mm_unpacklo_epi32(ab_0_3, ce_0_3), // columns 0 and 1
+                _mm_unpackhi_epi32(ab_0_3, ce_0_3),
+                _mm_unpacklo_epi32(ab_4_7, ce_4_7),
+                _mm_unpackhi_epi32(ab_4_7, ce_4_7),
+            };
+
+            for (int k = 0; k < 4; k++)
+            {
+                _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + (7 - k * 2) * dst_stride), cols[k]);
+                _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + (6 - k * 2) * dst_stride), _mm_srli_si128(cols[k], 8));
+            }
+        }
+
+        void rotate_8x8_u16(uint8_t * dst, int dst_stride, const uint8_t * src, int src_stride)
+        {
+            __m128i r[8];
+            for (int k = 0; k < 8; k++)
+                r[k] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + (7 - k) * src_stride));
+
+            __m128i a[8], b[8];
+            for (int k = 0; k < 4; k++)
+            {
+                a[k * 2] = _mm_unpacklo_epi16(r[k * 2], r[k * 2 + 1]);
+                a[k * 2 + 1] = _mm_unpackhi_epi16(r[k * 2], r[k * 2 + 1]);
+            }
+            for (int k = 0; k < 2; k++)
+            {
+                b[k * 4] = _mm_unpacklo_epi32(a[k * 4], a[k * 4 + 2]);         // columns 0-1 of 4 rows
+                b[k * 4 + 1] = _mm_unpackhi_epi32(a[k * 4], a[k * 4 + 2]);     // columns 2-3
+                b[k * 4 + 2] = _mm_unpacklo_epi32(a[k * 4 + 1], a[k * 4 + 3]); // columns 4-5
+                b[k * 4 + 3] = _mm_unpackhi_epi32(a[k * 4 + 1], a[k * 4 + 3]); // columns 6-7
+            }
+            for (int k = 0; k < 4; k++)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + (7 - k * 2) * dst_stride), _mm_unpacklo_epi64(b[k], b[k + 4]));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + (6 - k * 2) * dst_stride), _mm_unpackhi_epi64(b[k], b[k + 4]));
+            }
+        }
+
+        // The arithmetic of the SSE align, 4 pixels at a time
+        void project_depth(int32_t * dst, const uint16_t * depth, const float * ray_x, const float * ray_y, int count, const depth_projection& p)
+        {
+            __m128 r[9], t[3], c[5];
+            for (int i = 0; i < 9; i++)
+                r[i] = _mm_set1_ps(p.rotation[i]);
+            for (int i = 0; i < 3; i++)
+                t[i] = _mm_set1_ps(p.translation[i]);
+            for (int i = 0; i < 5; i++)
+                c[i] = _mm_set1_ps(p.coeffs[i]);
+            const __m128 scale = _mm_set1_ps(p.depth_scale);
+            const __m128 fx = _mm_set1_ps(p.fx), fy = _mm_set1_ps(p.fy);
+            const __m128 ppx = _mm_set1_ps(p.ppx), ppy = _mm_set1_ps(p.ppy);
+            const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1), two = _mm_set1_ps(2), half = _mm_set1_ps(0.5f);
+
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128i d = _mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(depth + i)));
+                __m128 z = _mm_mul_ps(_mm_cvtepi32_ps(d), scale);
+                __m128 px = _mm_mul_ps(z, _mm_loadu_ps(ray_x + i));
+                __m128 py = _mm_mul_ps(z, _mm_loadu_ps(ray_y + i));
+
+                __m128 x = _mm_add_ps(_mm_mul_ps(r[0], px), _mm_add_ps(_mm_mul_ps(r[3], py), _mm_add_ps(_mm_mul_ps(r[6], z), t[0])));
+                __m128 y = _mm_add_ps(_mm_mul_ps(r[1], px), _mm_add_ps(_mm_mul_ps(r[4], py), _mm_add_ps(_mm_mul_ps(r[7], z), t[1])));
+                __m128 w = _mm_add_ps(_mm_mul_ps(r[2], px), _mm_add_ps(_mm_mul_ps(r[5], py), _mm_add_ps(_mm_mul_ps(r[8], z), t[2])));
+                x = _mm_div_ps(x, w);
+                y = _mm_div_ps(y, w);
+
+                if (p.distort)
+                {
+                    __m128 r2 = _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y));
+                    __m128 r4 = _mm_mul_ps(r2, r2);
+                    __m128 f = _mm_add_ps(one, _mm_add_ps(_mm_mul_ps(c[0], r2),
+                        _mm_add_ps(_mm_mul_ps(c[1], r4), _mm_mul_ps(c[4], _mm_mul_ps(r2, r4)))));
+                    __m128 xf = _mm_mul_ps(x, f);
+                    __m128 yf = _mm_mul_ps(y, f);
+                    __m128 xy = _mm_mul_ps(xf, yf);
+                    __m128 tangential = _mm_mul_ps(c[3], _mm_add_ps(r2, _mm_mul_ps(two, _mm_mul_ps(xf, xf))));
+                    x = _mm_add_ps(xf, _mm_add_ps(_mm_mul_ps(two, _mm_mul_ps(c[2], xy)), tangential));
+                    y = _mm_add_ps(yf, _mm_add_ps(_mm_mul_ps(two, _mm_mul_ps(c[3], xy)), tangential));
+                }
+
+                // Pixels without depth come out as 0, 0
+                __m128 valid = _mm_cmpneq_ps(z, zero);
+                __m128 u = _mm_and_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, fx), ppx), half), valid);
+                __m128 v = _mm_and_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(y, fy), ppy), half), valid);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 2), _mm_cvtps_epi32(_mm_unpacklo_ps(u, v)));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 2 + 4), _mm_cvtps_epi32(_mm_unpackhi_ps(u, v)));
+            }
+
+            get_reference_unpack_kernels().project_depth(dst + i * 2, depth + i, ray_x + i, ray_y + i, count - i, p);
+        }
+
+        // Interleaves the x, y and z of 4 points into 12 floats
+        inline void store_xyz(float * out, __m128 x, __m128 y, __m128 z)
+        {
+            __m128 x0x2y0y2 = _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+            __m128 z0z2x1x3 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+            __m128 y1y3z1z3 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+            _mm_storeu_ps(out, _mm_shuffle_ps(x0x2y0y2, z0z2x1x3, _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(out + 4, _mm_shuffle_ps(y1y3z1z3, x0x2y0y2, _MM_SHUFFLE(3, 1, 2, 0)));
+            _mm_storeu_ps(out + 8, _mm_shuffle_ps(z0z2x1x3, y1y3z1z3, _MM_SHUFFLE(3, 1, 3, 1)));
+        }
+
+        // Splits 12 interleaved floats into the x, y and z of 4 points
+        inline void load_xyz(const float * in, __m128& x, __m128& y, __m128& z)
+        {
+            __m128 xyz0 = _mm_loadu_ps(in), xyz1 = _mm_loadu_ps(in + 4), xyz2 = _mm_loadu_ps(in + 8);
+            __m128 y0z0y1z1 = _mm_shuffle_ps(xyz0, xyz1, _MM_SHUFFLE(1, 0, 2, 1));
+            __m128 x2y2x3y3 = _mm_shuffle_ps(xyz1, xyz2, _MM_SHUFFLE(2, 1, 3, 2));
+            x = _mm_shuffle_ps(xyz0, x2y2x3y3, _MM_SHUFFLE(2, 0, 3, 0));
+            y = _mm_shuffle_ps(y0z0y1z1, x2y2x3y3, _MM_SHUFFLE(3, 1, 2, 0));
+            z = _mm_shuffle_ps(y0z0y1z1, xyz2, _MM_SHUFFLE(3, 0, 3, 1));
+        }
+
+        void deproject_xyz(uint8_t * const dst[], const uint16_t * depth, const float * ray_x, const float * ray_y, int count, float depth_scale)
+        {
+            auto out = reinterpret_cast<float *>(dst[0]);
+            const __m128 scale = _mm_set1_ps(depth_scale);
+
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128i d = _mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(depth + i)));
+                __m128 z = _mm_mul_ps(scale, _mm_cvtepi32_ps(d));
+                store_xyz(out + i * 3, _mm_mul_ps(z, _mm_loadu_ps(ray_x + i)), _mm_mul_ps(z, _mm_loadu_ps(ray_y + i)), z);
+            }
+
+            uint8_t * tail[] = { reinterpret_cast<uint8_t *>(out + i * 3) };
+            get_reference_unpack_kernels().deproject_xyz(tail, depth + i, ray_x + i, ray_y + i, count - i, depth_scale);
+        }
+
+        void texture_map(float * tex, float * pixels, const float * points, int count, const point_projection& p)
+        {
+            __m128 r[9], t[3], c[5];
+            for (int i = 0; i < 9; i++)
+                r[i] = _mm_set1_ps(p.rotation[i]);
+            for (int i = 0; i < 3; i++)
+                t[i] = _mm_set1_ps(p.translation[i]);
+            for (int i = 0; i < 5; i++)
+                c[i] = _mm_set1_ps(p.coeffs[i]);
+            const __m128 c2x2 = _mm_set1_ps(2 * p.coeffs[2]), c3x2 = _mm_set1_ps(2 * p.coeffs[3]);
+            const __m128 fx = _mm_set1_ps(p.fx), fy = _mm_set1_ps(p.fy);
+            const __m128 ppx = _mm_set1_ps(p.ppx), ppy = _mm_set1_ps(p.ppy);
+            const __m128 width = _mm_set1_ps(p.width), height = _mm_set1_ps(p.height);
+            const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1), two = _mm_set1_ps(2);
+
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 px, py, pz;
+                load_xyz(points + i * 3, px, py, pz);
+
+                __m128 x = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r[0], px), _mm_mul_ps(r[3], py)), _mm_mul_ps(r[6], pz)), t[0]);
+                __m128 y = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r[1], px), _mm_mul_ps(r[4], py)), _mm_mul_ps(r[7], pz)), t[1]);
+                __m128 w = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r[2], px), _mm_mul_ps(r[5], py)), _mm_mul_ps(r[8], pz)), t[2]);
+                x = _mm_div_ps(x, w);
+                y = _mm_div_ps(y, w);
+
+                if (p.distort)
+                {
+                    __m128 r2 = _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y));
+                    __m128 f = _mm_add_ps(_mm_add_ps(_mm_add_ps(one, _mm_mul_ps(c[0], r2)), _mm_mul_ps(_mm_mul_ps(c[1], r2), r2)),
+                        _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(c[4], r2), r2), r2));
+                    x = _mm_mul_ps(x, f);
+                    y = _mm_mul_ps(y, f);
+                    __m128 dx = _mm_add_ps(_mm_add_ps(x, _mm_mul_ps(_mm_mul_ps(c2x2, x), y)), _mm_mul_ps(c[3], _mm_add_ps(r2, _mm_mul_ps(_mm_mul_ps(two, x), x))));
+                    __m128 dy = _mm_add_ps(_mm_add_ps(y, _mm_mul_ps(_mm_mul_ps(c3x2, x), y)), _mm_mul_ps(c[2], _mm_add_ps(r2, _mm_mul_ps(_mm_mul_ps(two, y), y))));
+                    x = dx;
+                    y = dy;
+                }
+
+                // Points without depth come out as 0, 0
+                __m128 valid = _mm_cmpneq_ps(pz, zero);
+                __m128 u = _mm_and_ps(_mm_add_ps(_mm_mul_ps(x, fx), ppx), valid);
+                __m128 v = _mm_and_ps(_mm_add_ps(_mm_mul_ps(y, fy), ppy), valid);
+                _mm_storeu_ps(pixels + i * 2, _mm_unpacklo_ps(u, v));
+                _mm_storeu_ps(pixels + i * 2 + 4, _mm_unpackhi_ps(u, v));
+                u = _mm_div_ps(u, width);
+                v = _mm_div_ps(v, height);
+                _mm_storeu_ps(tex + i * 2, _mm_unpacklo_ps(u, v));
+                _mm_storeu_ps(tex + i * 2 + 4, _mm_unpackhi_ps(u, v));
+            }
+
+            get_reference_unpack_kernels().texture_map(tex + i * 2, pixels + i * 2, points + i * 3, count - i, p);
+        }
+
+        // 16 bytes compared at a time, the byte mask of the first match divided down to its element
+        template<int BYTES>
+        int find_zero(const uint8_t * src, int count)
+        {
+            const int n = 16 / BYTES;
+            const __m128i zero = _mm_setzero_si128();
+            int i = 0;
+            for (; i + n <= count; i += n)
+            {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * BYTES));
+                int mask = _mm_movemask_epi8(BYTES == 2 ? _mm_cmpeq_epi16(v, zero) : _mm_cmpeq_epi32(v, zero));
+                if (mask)
+                    return i + lowest_set_bit(uint32_t(mask)) / BYTES;
+            }
+
+            auto& ref = get_reference_unpack_kernels();
+            return i + (BYTES == 2 ? ref.find_zero_u16 : ref.find_zero_u32)(src + i * BYTES, count - i);
+        }
+
+        int find_nonzero_u16(const uint8_t * src, int count)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 2));
+                int mask = ~_mm_movemask_epi8(_mm_cmpeq_epi16(v, zero)) & 0xffff;
+                if (mask)
+                    return i + lowest_set_bit(uint32_t(mask)) / 2;
+            }
+            return i + get_reference_unpack_kernels().find_nonzero_u16(src + i * 2, count - i);
+        }
+
+        // Bit b of each value is shifted to the sign of its lane, which the signed saturation down to
+        // bytes keeps, and the byte mask gathers the signs of 16 values at a time
+        void bitplane_pack(uint64_t * planes, const uint16_t * src, int bits)
+        {
+            __m128i v[8];
+            for (int j = 0; j < 8; j++)
+                v[j] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + j * 8));
+
+            for (int b = 0; b < bits; b++)
+            {
+                const __m128i shift = _mm_cvtsi32_si128(15 - b);
+                uint64_t plane = 0;
+                for (int j = 0; j < 4; j++)
+                {
+                    __m128i bytes = _mm_packs_epi16(_mm_sll_epi16(v[2 * j], shift), _mm_sll_epi16(v[2 * j + 1], shift));
+                    plane |= uint64_t(uint32_t(_mm_movemask_epi8(bytes))) << (16 * j);
+                }
+                planes[b] = plane;
+            }
+        }
+
+        // Each byte of a plane is broadcast to 8 lanes, and each lane tests its own bit of it
+        void bitplane_unpack(uint16_t * dst, const uint64_t * planes, int bits)
+        {
+            const __m128i lane_bits = _mm_setr_epi16(1, 2, 4, 8, 16, 32, 64, 128);
+            __m128i v[8];
+            for (int j = 0; j < 8; j++)
+                v[j] = _mm_setzero_si128();
+
+            for (int b = 0; b < bits; b++)
+            {
+                const __m128i bit = _mm_set1_epi16(static_cast<short>(1 << b));
+                for (int j = 0; j < 8; j++)
+                {
+                    __m128i byte = _mm_set1_epi16(static_cast<short>((planes[b] >> (8 * j)) & 0xff));
+                    __m128i set = _mm_cmpeq_epi16(_mm_and_si128(byte, lane_bits), lane_bits);
+                    v[j] = _mm_or_si128(v[j], _mm_and_si128(set, bit));
+                }
+            }
+
+            for (int j = 0; j < 8; j++)
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + j * 8), v[j]);
+        }
+        inline void sort_pair(__m128i& a, __m128i& b)
+        {
+            __m128i t = _mm_min_epu16(a, b);
+            b = _mm_max_epu16(a, b);
+            a = t;
+        }
+
+        // The lower median of the non-zero lanes of v[0..N): the zeros are made the largest value and
+        // the lanes sorted, then the median of the k non-zero ones is the ((k - 1) / 2)th
+        template<int N>
+        __m128i median_of(__m128i * v)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            __m128i zeros = zero;
+            for (int n = 0; n < N; n++)
+            {
+                __m128i z = _mm_cmpeq_epi16(v[n], zero);
+                zeros = _mm_sub_epi16(zeros, z);
+                v[n] = _mm_or_si128(v[n], z);
+            }
+
+            if (N == 4)
+            {
+                sort_pair(v[0], v[1]); sort_pair(v[2], v[3]);
+                sort_pair(v[0], v[2]); sort_pair(v[1], v[3]);
+                sort_pair(v[1], v[2]);
+            }
+            else
+            {
+                sort_pair(v[0], v[1]); sort_pair(v[3], v[4]); sort_pair(v[6], v[7]);
+                sort_pair(v[1], v[2]); sort_pair(v[4], v[5]); sort_pair(v[7], v[8]);
+                sort_pair(v[0], v[1]); sort_pair(v[3], v[4]); sort_pair(v[6], v[7]);
+                sort_pair(v[0], v[3]); sort_pair(v[3], v[6]); sort_pair(v[0], v[3]);
+                sort_pair(v[1], v[4]); sort_pair(v[4], v[7]); sort_pair(v[1], v[4]);
+                sort_pair(v[2], v[5]); sort_pair(v[5], v[8]); sort_pair(v[2], v[5]);
+                sort_pair(v[1], v[3]); sort_pair(v[5], v[7]); sort_pair(v[2], v[6]);
+                sort_pair(v[4], v[6]); sort_pair(v[2], v[4]); sort_pair(v[2], v[3]);
+                sort_pair(v[5], v[6]);
+            }
+
+            // The ith is the median where there are at least 2i + 1 non-zero lanes
+            __m128i median = v[0];
+            for (int i = 1; i <= (N - 1) / 2; i++)
+                median = _mm_blendv_epi8(median, v[i], _mm_cmplt_epi16(zeros, _mm_set1_epi16(int16_t(N - 2 * i))));
+            return _mm_andnot_si128(_mm_cmpeq_epi16(zeros, _mm_set1_epi16(N)), median);
+        }
+
+        // 8 blocks at a time, the left and right pixels of the blocks split into planes
+        void median_2x2(uint16_t * dst, const uint16_t * const rows[], int count)
+        {
+            const __m128i low = _mm_set1_epi32(0xffff);
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                __m128i v[4];
+                for (int n = 0; n < 2; n++)
+                {
+                    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[n] + i * 2));
+                    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[n] + i * 2 + 8));
+                    v[n * 2] = _mm_packus_epi32(_mm_and_si128(a, low), _mm_and_si128(b, low));
+                    v[n * 2 + 1] = _mm_packus_epi32(_mm_srli_epi32(a, 16), _mm_srli_epi32(b, 16));
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), median_of<4>(v));
+            }
+
+            const uint16_t * tail[] = { rows[0] + i * 2, rows[1] + i * 2 };
+            get_reference_unpack_kernels().median_2x2(dst + i, tail, count - i);
+        }
+
+        // The Mth pixel of 8 blocks of 3 in a, b and c. Each vector holds pixels of the plane at
+        // positions the others do not, so the plane is blended together and then put in order
+        template<int M>
+        __m128i stride3_plane(__m128i a, __m128i b, __m128i c)
+        {
+            switch (M)
+            {
+            case 0: return _mm_shuffle_epi8(_mm_blend_epi16(_mm_blend_epi16(a, b, 0x92), c, 0x24),
+                _mm_setr_epi8(0, 1, 6, 7, 12, 13, 2, 3, 8, 9, 14, 15, 4, 5, 10, 11));
+            case 1: return _mm_shuffle_epi8(_mm_blend_epi16(_mm_blend_epi16(a, b, 0x24), c, 0x49),
+                _mm_setr_epi8(2, 3, 8, 9, 14, 15, 4, 5, 10, 11, 0, 1, 6, 7, 12, 13));
+            default: return _mm_shuffle_epi8(_mm_blend_epi16(_mm_blend_epi16(a, b, 0x49), c, 0x92),
+                _mm_setr_epi8(4, 5, 10, 11, 0, 1, 6, 7, 12, 13, 2, 3, 8, 9, 14, 15));
+            }
+        }
+
+        void median_3x3(uint16_t * dst, const uint16_t * const rows[], int count)
+        {
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                __m128i v[9];
+                for (int n = 0; n < 3; n++)
+                {
+                    auto src = reinterpret_cast<const __m128i *>(rows[n] + i * 3);
+                    __m128i a = _mm_loadu_si128(src), b = _mm_loadu_si128(src + 1), c = _mm_loadu_si128(src + 2);
+                    v[n * 3] = stride3_plane<0>(a, b, c);
+                    v[n * 3 + 1] = stride3_plane<1>(a, b, c);
+                    v[n * 3 + 2] = stride3_plane<2>(a, b, c);
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), median_of<9>(v));
+            }
+
+            const uint16_t * tail[] = { rows[0] + i * 3, rows[1] + i * 3, rows[2] + i * 3 };
+            get_reference_unpack_kernels().median_3x3(dst + i, tail, count - i);
+        }
+
+        // 16 columns at a time, summed in 16 bits, which 256 rows of 8 bits do not overflow
+        void column_sum_u8(uint32_t * sums, const uint8_t * const rows[], int row_count, int count)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            int i = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                __m128i lo = zero, hi = zero;
+                for (int n = 0; n < row_count; n++)
+                {
+                    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[n] + i));
+                    lo = _mm_add_epi16(lo, _mm_unpacklo_epi8(v, zero));
+                    hi = _mm_add_epi16(hi, _mm_unpackhi_epi8(v, zero));
+                }
+                auto out = reinterpret_cast<__m128i *>(sums + i);
+                _mm_storeu_si128(out, _mm_unpacklo_epi16(lo, zero));
+                _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(lo, zero));
+                _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(hi, zero));
+                _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(hi, zero));
+            }
+
+            const uint8_t * tail[256];
+            for (int n = 0; n < row_count; n++)
+                tail[n] = rows[n] + i;
+            get_reference_unpack_kernels().column_sum_u8(sums + i, tail, row_count, count - i);
+        }
+
+        // 8 columns at a time, the zeros counted down from the number of rows
+        void column_sum_u16(uint32_t * sums, uint32_t * nonzero, const uint16_t * const rows[], int row_count, int count)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                __m128i lo = zero, hi = zero, zeros = zero;
+                for (int n = 0; n < row_count; n++)
+                {
+                    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[n] + i));
+                    lo = _mm_add_epi32(lo, _mm_unpacklo_epi16(v, zero));
+                    hi = _mm_add_epi32(hi, _mm_unpackhi_epi16(v, zero));
+                    zeros = _mm_sub_epi16(zeros, _mm_cmpeq_epi16(v, zero));
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(sums + i), lo);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(sums + i + 4), hi);
+                if (nonzero)
+                {
+                    __m128i k = _mm_sub_epi16(_mm_set1_epi16(int16_t(row_count)), zeros);
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(nonzero + i), _mm_unpacklo_epi16(k, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(nonzero + i + 4), _mm_unpackhi_epi16(k, zero));
+                }
+            }
+
+            const uint16_t * tail[256];
+            for (int n = 0; n < row_count; n++)
+                tail[n] = rows[n] + i;
+            get_reference_unpack_kernels().column_sum_u16(sums + i, nonzero ? nonzero + i : nullptr, tail, row_count, count - i);
+        }
+
+        // The lanes moved up by n, the lowest n taking -inf, which no maximum picks
+        template<int N>
+        inline __m128 shift_up(__m128 v)
+        {
+            const __m128 low = _mm_set1_ps(-INFINITY);
+            return _mm_blend_ps(_mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), N * 4)), low, (1 << N) - 1);
+        }
+
+        // 4 pixels at a time. The lanes without depth take -inf, a prefix maximum gives each lane the
+        // largest x before it, and a block passes when every lane with depth is above that. The block
+        // that does not, a NaN among it, is left to the reference from its first pixel
+        int occlusion_run(const float * pixels, const float * points, int count, float & max_x, float & max_z)
+        {
+            const __m128 zero = _mm_setzero_ps(), low = _mm_set1_ps(-INFINITY);
+            __m128 running = _mm_set1_ps(max_x);
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 p0 = _mm_loadu_ps(pixels + i * 2), p1 = _mm_loadu_ps(pixels + i * 2 + 4);
+                __m128 x = _mm_shuffle_ps(p0, p1, _MM_SHUFFLE(2, 0, 2, 0));
+                __m128 v0 = _mm_loadu_ps(points + i * 3), v1 = _mm_loadu_ps(points + i * 3 + 4), v2 = _mm_loadu_ps(points + i * 3 + 8);
+                __m128 z = _mm_shuffle_ps(_mm_shuffle_ps(v0, v1, _MM_SHUFFLE(1, 1, 2, 2)), v2, _MM_SHUFFLE(3, 0, 2, 0));
+
+                __m128 valid = _mm_cmpneq_ps(z, zero);
+                __m128 prefix = _mm_blendv_ps(low, x, valid);
+                prefix = _mm_max_ps(prefix, shift_up<1>(prefix));
+                prefix = _mm_max_ps(prefix, shift_up<2>(prefix));
+                __m128 before = _mm_max_ps(shift_up<1>(prefix), running);
+                if (_mm_movemask_ps(_mm_andnot_ps(_mm_cmpgt_ps(x, before), valid)))
+                    break;
+
+                int with_depth = _mm_movemask_ps(valid);
+                if (with_depth)
+                {
+                    running = _mm_shuffle_ps(prefix, prefix, _MM_SHUFFLE(3, 3, 3, 3));
+                    int last = 3;
+                    while (!(with_depth >> last & 1))
+                        last--;
+                    max_z = points[(i + last) * 3 + 2];
+                }
+            }
+
+            max_x = _mm_cvtss_f32(running);
+            return i + get_reference_unpack_kernels().occlusion_run(pixels + i * 2, points + i * 3, count - i, max_x, max_z);
+        }
+    }
+
+    bool fill_sse41_kernels(unpack_kernels& k)
+    {
+        k.yuy2_to_y8 = unpack_yuv422<false, yuv_output::y8>;
+        k.yuy2_to_y16 = unpack_yuv422<false, yuv_output::y16>;
+        k.yuy2_to_rgb8 = unpack_yuv422<false, yuv_output::rgb8>;
+        k.yuy2_to_rgba8 = unpack_yuv422<false, yuv_output::rgba8>;
+        k.yuy2_to_bgr8 = unpack_yuv422<false, yuv_output::bgr8>;
+        k.yuy2_to_bgra8 = unpack_yuv422<false, yuv_output::bgra8>;
+        k.uyvy_to_rgb8 = unpack_yuv422<true, yuv_output::rgb8>;
+        k.uyvy_to_rgba8 = unpack_yuv422<true, yuv_output::rgba8>;
+        k.uyvy_to_bgr8 = unpack_yuv422<true, yuv_output::bgr8>;
+        k.uyvy_to_bgra8 = unpack_yuv422<true, yuv_output::bgra8>;
+        k.bgr8_to_rgb8 = bgr8_to_rgb8;
+        k.y8i_to_y8_y8 = y8i_to_y8_y8;
+        k.y12i_to_y16_y16 = y12i_to_y16_y16;
+        k.y16_10_to_y8 = y16_10_to_y8;
+        k.y16_10_to_y16 = y16_10_to_y16;
+        k.w10_to_y10bpack = w10_to_y10bpack;
+        k.rotate_8x8_u8 = rotate_8x8_u8;
+        k.rotate_8x8_u16 = rotate_8x8_u16;
+        k.project_depth = project_depth;
+        k.deproject_xyz = deproject_xyz;
+        k.texture_map = texture_map;
+        k.find_zero_u16 = find_zero<2>;
+        k.find_zero_u32 = find_zero<4>;
+        k.find_nonzero_u16 = find_nonzero_u16;
+        k.bitplane_pack = bitplane_pack;
+        k.bitplane_unpack = bitplane_unpack;
+        k.median_2x2 = median_2x2;
+        k.median_3x3 = median_3x3;
+        k.column_sum_u8 = column_sum_u8;
+        k.column_sum_u16 = column_sum_u16;
+        k.occlusion_run = occlusion_run;
+        return true;
+    }
+}
+
+#else
+
+namespace librealsense
+{
+    bool fill_sse41_kernels(unpack_kernels&) { return false; }
+}
+
+#endif
@@ -0,0 +1,616 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "image-simd.h"
+
+#include <cmath>
+#include <cstring>
+#include <initializer_list>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define LRS_SIMD_X86
+#ifdef _WIN32
+#include <intrin.h>
+#include <immintrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace librealsense
+{
+    namespace
+    {
+        ///////////////////////
+        // Scalar references //
+        ///////////////////////
+
+        // The fixed-point YUV conversion of the vector kernels: c, d and e are scaled by 16 and
+        // every product keeps only its upper 16 bits, so each term is rounded down separately
+        inline int mulhi(int a, int b) { return (a * b) >> 16; }
+        inline uint8_t clamp_byte(int v) { return static_cast<uint8_t>(v < 0 ? 0 : v > 255 ? 255 : v); }
+
+        template<bool UYVY, int BPP, bool BGR>
+        void yuv422_to_rgb(uint8_t * const dst[], const uint8_t * src, int count)
+        {
+            auto out = dst[0];
+            for (int i = 0; i + 2 <= count; i += 2, src += 4)
+            {
+                const int y[2] = { UYVY ? src[1] : src[0], UYVY ? src[3] : src[2] };
+                const int d = ((UYVY ? src[0] : src[1]) - 128) * 16;
+                const int e = ((UYVY ? src[2] : src[3]) - 128) * 16;
+                for (int k = 0; k < 2; k++, out += BPP)
+                {
+                    const int c = (y[k] - 16) * 16;
+                    auto r = clamp_byte(mulhi(c, 298 << 4) + mulhi(e, 409 << 4));
+                    auto g = clamp_byte(mulhi(c, 298 << 4) - mulhi(d, 100 << 4) - mulhi(e, 208 << 4));
+                    auto b = clamp_byte(mulhi(c, 298 << 4) + mulhi(d, 516 << 4));
+                    out[0] = BGR ? b : r;
+                    out[1] = g;
+                    out[2] = BGR ? r : b;
+                    if (BPP == 4) out[3] = 255;
+                }
+            }
+        }
+
+        void yuy2_to_y8(uint8_t * const dst[], const uint8_t * src, int count)
+        {
+            for (int i = 0; i < count; i++)
+                dst[0][i] = src[i * 2];
+        }
+
+        void yuy2_to_y16(uint8_t * const dst[], const uint8_t * src, int count)
+        {
+            auto out = reinterpret_cast<uint16_t*>(dst[0]);
+            for (int i = 0; i < count; i++)
+                out[i] = static_cast<uint16_t>(src[i * 2] << 8);
+        }
+
+        void bgr8_to_rgb8(uint8_t * const dst[], const uint8_t * src, int count)
+        {
+            auto out = dst[0];
+            for (int i = 0; i < count; i++, src += 3, out += 3)
+            {
+                auto b = src[0];
+                out[1] = src[1];
+                out[0] = src[2];
+                out[2] = b;
+            }
+        }
+
+        void y8i_to_y8_y8(uint8_t * const dst[], const uint8_t * src, int count)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                dst[0][i] = src[i * 2];
+                dst[1][i] = src[i * 2 + 1];
+            }
+        }
+
+        // Y12I packs the right pixel in the low 12 bits and the left one in the high 12 bits of
+        // 3 bytes. They carry 10-bit data, widened to 16 bits as x * 64 + x / 16
+        void y12i_to_y16_y16(uint8_t * const dst[], const uint8_t * src, int count)
+        {
+            auto left = reinterpret_cast<uint16_t*>(dst[0]);
+            auto right = reinterpret_cast<uint16_t*>(dst[1]);
+            for (int i = 0; i < count; i++, src += 3)
+            {
+                int l = src[2] << 4 | src[1] >> 4;
+                int r = (src[1] & 0xf) << 8 | src[0];
+                left[i] = static_cast<uint16_t>(l << 6 | l >> 4);
+                right[i] = static_cast<uint16_t>(r << 6 | r >> 4);
+            }
+        }
+
+        void y16_10_to_y8(uint8_t * const dst[], const uint8_t * src, int count)
+        {
+            auto in = reinterpret_cast<const uint16_t*>(src);
+            for (int i = 0; i < count; i++)
+                dst[0][i] = static_cast<uint8_t>(in[i] >> 2);
+        }
+
+        void y16_10_to_y16(uint8_t * const dst[], const uint8_t * src, int count)
+        {
+            auto in = reinterpret_cast<const uint16_t*>(src);
+            auto out = reinterpret_cast<uint16_t*>(dst[0]);
+            for (int i = 0; i < count; i++)
+                out[i] = static_cast<uint16_t>(in[i] << 6);
+        }
+
+        // Four 10-bit pixels in 5 bytes: the upper 8 bits of each, then their 2 low bits packed
+        void w10_to_y10bpack(uint8_t * const dst[], const uint8_t * src, int count)
+        {
+            auto out = reinterpret_cast<uint16_t*>(dst[0]);
+            for (int i = 0; i < count / 4; i++, src += 5)
+            {
+                *out++ = static_cast<uint16_t>(((src[0] << 2) | (src[4] & 3)) << 6);
+                *out++ = static_cast<uint16_t>(((src[1] << 2) | ((src[4] >> 2) & 3)) << 6);
+                *out++ = static_cast<uint16_t>(((src[2] << 2) | ((src[4] >> 4) & 3)) << 6);
+                *out++ = static_cast<uint16_t>(((src[3] << 2) | ((src[4] >> 6) & 3)) << 6);
+            }
+        }
+
+        // Output row r holds source column 7 - r, read from the bottom up
+        template<int SIZE>
+        void rotate_8x8(uint8_t * dst, int dst_stride, const uint8_t * src, int src_stride)
+        {
+            for (int r = 0; r < 8; r++)
+                for (int k = 0; k < 8; k++)
+                    memcpy(dst + r * dst_stride + k * SIZE, src + (7 - k) * src_stride + (7 - r) * SIZE, SIZE);
+        }
+
+        // As cvtps2dq rounds: to nearest even, and to INT32_MIN when out of range or NaN
+        inline int32_t round_to_int(float v)
+        {
+            if (!(v >= -2147483648.f && v < 2147483648.f))
+                return INT32_MIN;
+            return static_cast<int32_t>(std::nearbyint(v));
+        }
+
+        // Every step rounds to float in the order the vector kernels take, so the results are
+        // bit-exact with them as long as the compiler does not fuse the multiplies and adds
+        void project_depth(int32_t * dst, const uint16_t * depth, const float * ray_x, const float * ray_y, int count, const depth_projection& p)
+        {
+            auto r = p.rotation;
+            auto t = p.translation;
+            auto c = p.coeffs;
+            for (int i = 0; i < count; i++, dst += 2)
+            {
+                float z = depth[i] * p.depth_scale;
+                if (z == 0)
+                {
+                    dst[0] = dst[1] = 0;
+                    continue;
+                }
+
+                float px = z * ray_x[i];
+                float py = z * ray_y[i];
+                float x = r[0] * px + (r[3] * py + (r[6] * z + t[0]));
+                float y = r[1] * px + (r[4] * py + (r[7] * z + t[1]));
+                float w = r[2] * px + (r[5] * py + (r[8] * z + t[2]));
+                x = x / w;
+                y = y / w;
+
+                if (p.distort)
+                {
+                    float r2 = x * x + y * y;
+                    float f = 1 + (c[0] * r2 + (c[1] * (r2 * r2) + c[4] * (r2 * (r2 * r2))));
+                    float xf = x * f;
+                    float yf = y * f;
+                    // Both coordinates take the tangential term of x, as the SSE align always has
+                    float tangential = c[3] * (r2 + 2 * (xf * xf));
+                    x = xf + (2 * (c[2] * (xf * yf)) + tangential);
+                    y = yf + (2 * (c[3] * (xf * yf)) + tangential);
+                }
+
+                dst[0] = round_to_int((x * p.fx + p.ppx) + 0.5f);
+                dst[1] = round_to_int((y * p.fy + p.ppy) + 0.5f);
+            }
+        }
+
+        // The vertices of the scalar pointcloud, depth times the ray at z = 1
+        void deproject_xyz(uint8_t * const dst[], const uint16_t * depth, const float * ray_x, const float * ray_y, int count, float depth_scale)
+        {
+            auto out = reinterpret_cast<float*>(dst[0]);
+            for (int i = 0; i < count; i++, out += 3)
+            {
+                float z = depth_scale * depth[i];
+                out[0] = z * ray_x[i];
+                out[1] = z * ray_y[i];
+                out[2] = z;
+            }
+        }
+
+        void deproject_planar(uint8_t * const dst[], const uint16_t * depth, const float * ray_x, const float * ray_y, int count, float depth_scale)
+        {
+            auto x = reinterpret_cast<float*>(dst[0]);
+            auto y = reinterpret_cast<float*>(dst[1]);
+            auto z = reinterpret_cast<float*>(dst[2]);
+            for (int i = 0; i < count; i++)
+            {
+                z[i] = depth_scale * depth[i];
+                x[i] = z[i] * ray_x[i];
+                y[i] = z[i] * ray_y[i];
+            }
+        }
+
+        // Rounds to nearest even in integer steps the vector kernels can take too: normal halves
+        // add the rounding bias to the bits directly, subnormal ones let a float addition round
+        inline uint16_t float_to_half(float v)
+        {
+            uint32_t f;
+            memcpy(&f, &v, sizeof(f));
+            const uint32_t sign = f & 0x80000000u;
+            f ^= sign;
+
+            uint32_t h;
+            if (f >= 0x47800000u)                   // too large for a half, infinity or NaN
+                h = f > 0x7f800000u ? 0x7e00 : 0x7c00;
+            else if (f < 0x38800000u)               // subnormal half or zero
+            {
+                // Adding 0.5 shifts the mantissa right into the half position, rounded
+                float a;
+                memcpy(&a, &f, sizeof(a));
+                a += 0.5f;
+                memcpy(&h, &a, sizeof(h));
+                h -= 0x3f000000u;
+            }
+            else
+                h = (f + 0xc8000fffu + ((f >> 13) & 1)) >> 13;
+            return static_cast<uint16_t>(h | (sign >> 16));
+        }
+
+        void deproject_xyz_half(uint8_t * const dst[], const uint16_t * depth, const float * ray_x, const float * ray_y, int count, float depth_scale)
+        {
+            auto out = reinterpret_cast<uint16_t*>(dst[0]);
+            for (int i = 0; i < count; i++, out += 3)
+            {
+                float z = depth_scale * depth[i];
+                out[0] = float_to_half(z * ray_x[i]);
+                out[1] = float_to_half(z * ray_y[i]);
+                out[2] = float_to_half(z);
+            }
+        }
+
+        // Written as rsutil.h writes it, so the rounding steps are those of the scalar pointcloud
+        void texture_map(float * tex, float * pixels, const float * points, int count, const point_projection& p)
+        {
+            auto r = p.rotation;
+            auto t = p.translation;
+            auto c = p.coeffs;
+            for (int i = 0; i < count; i++, points += 3, tex += 2, pixels += 2)
+            {
+                if (!points[2])
+                {
+                    tex[0] = tex[1] = pixels[0] = pixels[1] = 0;
+                    continue;
+                }
+
+                float px = r[0] * points[0] + r[3] * points[1] + r[6] * points[2] + t[0];
+                float py = r[1] * points[0] + r[4] * points[1] + r[7] * points[2] + t[1];
+                float pz = r[2] * points[0] + r[5] * points[1] + r[8] * points[2] + t[2];
+                float x = px / pz;
+                float y = py / pz;
+
+                if (p.distort)
+                {
+                    float r2 = x * x + y * y;
+                    float f = 1 + c[0] * r2 + c[1] * r2 * r2 + c[4] * r2 * r2 * r2;
+                    x *= f;
+                    y *= f;
+                    float dx = x + 2 * c[2] * x * y + c[3] * (r2 + 2 * x * x);
+                    float dy = y + 2 * c[3] * x * y + c[2] * (r2 + 2 * y * y);
+                    x = dx;
+                    y = dy;
+                }
+
+                pixels[0] = x * p.fx + p.ppx;
+                pixels[1] = y * p.fy + p.ppy;
+                tex[0] = pixels[0] / p.width;
+                tex[1] = pixels[1] / p.height;
+            }
+        }
+
+        // Back to front, so that in place every depth is read before the wider disparity overwrites it
+        void depth_to_disparity(float * dst, const uint16_t * depth, int count, const float * lut)
+        {
+            auto src = reinterpret_cast<const uint8_t *>(depth);
+            auto out = reinterpret_cast<uint8_t *>(dst);
+            for (int i = count - 1; i >= 0; i--)
+            {
+                uint16_t d;
+                memcpy(&d, src + i * sizeof(d), sizeof(d));
+                memcpy(out + i * sizeof(float), &lut[d], sizeof(float));
+            }
+        }
+
+        // Front to back, the narrower depth trailing the disparity it is made of
+        void disparity_to_depth(uint16_t * dst, const float * disparity, int count, float factor)
+        {
+            auto src = reinterpret_cast<const uint8_t *>(disparity);
+            auto out = reinterpret_cast<uint8_t *>(dst);
+            for (int i = 0; i < count; i++)
+            {
+                float input;
+                memcpy(&input, src + i * sizeof(input), sizeof(input));
+                uint16_t d = std::isnormal(input) ? static_cast<uint16_t>((factor / input) + 0.5f) : 0;
+                memcpy(out + i * sizeof(d), &d, sizeof(d));
+            }
+        }
+
+        template<typename T>
+        int find_zero(const uint8_t * src, int count)
+        {
+            auto p = reinterpret_cast<const T*>(src);
+            int i = 0;
+            while (i < count && p[i])
+                i++;
+            return i;
+        }
+
+        int find_nonzero_u16(const uint8_t * src, int count)
+        {
+            auto p = reinterpret_cast<const uint16_t*>(src);
+            int i = 0;
+            while (i < count && !p[i])
+                i++;
+            return i;
+        }
+
+        void bitplane_pack(uint64_t * planes, const uint16_t * src, int bits)
+        {
+            for (int b = 0; b < bits; b++)
+            {
+                uint64_t plane = 0;
+                for (int i = 0; i < 64; i++)
+                    plane |= uint64_t((src[i] >> b) & 1) << i;
+                planes[b] = plane;
+            }
+        }
+
+        void bitplane_unpack(uint16_t * dst, const uint64_t * planes, int bits)
+        {
+            for (int i = 0; i < 64; i++)
+            {
+                int value = 0;
+                for (int b = 0; b < bits; b++)
+                    value |= int((planes[b] >> i) & 1) << b;
+                dst[i] = static_cast<uint16_t>(value);
+            }
+        }
+
+        // The non-zero pixels of each block sorted in as they come
+        template<int SCALE>
+        void median(uint16_t * dst, const uint16_t * const rows[], int count)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                uint16_t sorted[SCALE * SCALE];
+                int k = 0;
+                for (int n = 0; n < SCALE; n++)
+                {
+                    for (int m = 0; m < SCALE; m++)
+                    {
+                        uint16_t v = rows[n][i * SCALE + m];
+                        if (!v)
+                            continue;
+                        int j = k++;
+                        for (; j > 0 && sorted[j - 1] > v; j--)
+                            sorted[j] = sorted[j - 1];
+                        sorted[j] = v;
+                    }
+                }
+                dst[i] = k ? sorted[(k - 1) / 2] : 0;
+            }
+        }
+
+        void column_sum_u8(uint32_t * sums, const uint8_t * const rows[], int row_count, int count)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                uint32_t sum = 0;
+                for (int n = 0; n < row_count; n++)
+                    sum += rows[n][i];
+                sums[i] = sum;
+            }
+        }
+
+        void column_sum_u16(uint32_t * sums, uint32_t * nonzero, const uint16_t * const rows[], int row_count, int count)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                uint32_t sum = 0, k = 0;
+                for (int n = 0; n < row_count; n++)
+                {
+                    sum += rows[n][i];
+                    k += rows[n][i] != 0;
+                }
+                sums[i] = sum;
+                if (nonzero)
+                    nonzero[i] = k;
+            }
+        }
+
+        // Stops at the first pixel with depth whose x is not above every x before it. The occlusion
+        // filter takes that pixel from there, and NaN coordinates with it
+        int occlusion_run(const float * pixels, const float * points, int count, float & max_x, float & max_z)
+        {
+            int i = 0;
+            for (; i < count; i++)
+            {
+                float z = points[i * 3 + 2];
+                if (!z)
+                    continue;
+                float x = pixels[i * 2];
+                if (!(x > max_x))
+                    break;
+                max_x = x;
+                max_z = z;
+            }
+            return i;
+        }
+
+        unpack_kernels make_reference_kernels()
+        {
+            unpack_kernels k;
+            k.level = simd_level::scalar;
+            k.yuy2_to_y8 = yuy2_to_y8;
+            k.yuy2_to_y16 = yuy2_to_y16;
+            k.yuy2_to_rgb8 = yuv422_to_rgb<false, 3, false>;
+            k.yuy2_to_rgba8 = yuv422_to_rgb<false, 4, false>;
+            k.yuy2_to_bgr8 = yuv422_to_rgb<false, 3, true>;
+            k.yuy2_to_bgra8 = yuv422_to_rgb<false, 4, true>;
+            k.uyvy_to_rgb8 = yuv422_to_rgb<true, 3, false>;
+            k.uyvy_to_rgba8 = yuv422_to_rgb<true, 4, false>;
+            k.uyvy_to_bgr8 = yuv422_to_rgb<true, 3, true>;
+            k.uyvy_to_bgra8 = yuv422_to_rgb<true, 4, true>;
+            k.bgr8_to_rgb8 = bgr8_to_rgb8;
+            k.y8i_to_y8_y8 = y8i_to_y8_y8;
+            k.y12i_to_y16_y16 = y12i_to_y16_y16;
+            k.y16_10_to_y8 = y16_10_to_y8;
+            k.y16_10_to_y16 = y16_10_to_y16;
+            k.w10_to_y10bpack = w10_to_y10bpack;
+            k.rotate_8x8_u8 = rotate_8x8<1>;
+            k.rotate_8x8_u16 = rotate_8x8<2>;
+            k.project_depth = project_depth;
+            k.deproject_xyz = deproject_xyz;
+            k.deproject_planar = deproject_planar;
+            k.deproject_xyz_half = deproject_xyz_half;
+            k.texture_map = texture_map;
+            k.depth_to_disparity = depth_to_disparity;
+            k.disparity_to_depth = disparity_to_depth;
+            k.find_zero_u16 = find_zero<uint16_t>;
+            k.find_zero_u32 = find_zero<uint32_t>;
+            k.find_nonzero_u16 = find_nonzero_u16;
+            k.bitplane_pack = bitplane_pack;
+            k.bitplane_unpack = bitplane_unpack;
+            k.median_2x2 = median<2>;
+            k.median_3x3 = median<3>;
+            k.column_sum_u8 = column_sum_u8;
+            k.column_sum_u16 = column_sum_u16;
+            k.occlusion_run = occlusion_run;
+            return k;
+        }
+
+        //////////////////////
+        // CPU capabilities //
+        //////////////////////
+
+        struct cpu_features
+        {
+            bool sse41 = false;
+            bool avx2 = false;
+            bool avx512 = false;
+        };
+
+#ifdef LRS_SIMD_X86
+        void cpuid(int info[4], int leaf, int subleaf)
+        {
+#ifdef _WIN32
+            __cpuidex(info, leaf, subleaf);
+#else
+            __cpuid_count(leaf, subleaf, info[0], info[1], info[2], info[3]);
+#endif
+        }
+
+        uint64_t xgetbv()
+        {
+#ifdef _WIN32
+            return _xgetbv(0);
+#else
+            uint32_t eax, edx;
+            __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+            return (uint64_t(edx) << 32) | eax;
+#endif
+        }
+
+        cpu_features detect_cpu_features()
+        {
+            cpu_features res;
+            int info[4];
+            cpuid(info, 0, 0);
+            auto max_leaf = info[0];
+            if (max_leaf < 1)
+                return res;
+
+            cpuid(info, 1, 0);
+            res.sse41 = (info[2] & (1 << 19)) != 0;
+            // The OS has to save the wider registers on context switches, not only the CPU support them
+            bool osxsave = (info[2] & (1 << 27)) != 0;
+            uint64_t xcr0 = osxsave ? xgetbv() : 0;
+            bool ymm_state = (xcr0 & 0x06) == 0x06;
+            bool zmm_state = (xcr0 & 0xe6) == 0xe6;
+
+            if (max_leaf >= 7)
+            {
+                cpuid(info, 7, 0);
+                res.avx2 = ymm_state && (info[1] & (1 << 5)) != 0;
+                res.avx512 = zmm_state && (info[1] & (1 << 16)) != 0 && (info[1] & (1 << 30)) != 0; // F and BW
+            }
+            return res;
+        }
+#else
+        cpu_features detect_cpu_features() { return cpu_features(); }
+#endif
+
+        const cpu_features& get_cpu_features()
+        {
+            static const cpu_features features = detect_cpu_features();
+            return features;
+        }
+
+        unpack_kernels select_best_kernels()
+        {
+            unpack_kernels k;
+            for (auto level : { simd_level::avx512, simd_level::avx2, simd_level::sse41, simd_level::neon })
+            {
+                if (get_unpack_kernels(level, k))
+                    return k;
+            }
+            return get_reference_unpack_kernels();
+        }
+    }
+
+    const char* get_string(simd_level level)
+    {
+        switch (level)
+        {
+        case simd_level::scalar: return "scalar";
+        case simd_level::sse41: return "SSE4.1";
+        case simd_level::avx2: return "AVX2";
+        case simd_level::avx512: return "AVX-512";
+        case simd_level::neon: return "NEON";
+        default: return "unknown";
+        }
+    }
+
+    const unpack_kernels& get_reference_unpack_kernels()
+    {
+        static const unpack_kernels kernels = make_reference_kernels();
+        return kernels;
+    }
+
+    const unpack_kernels& get_unpack_kernels()
+    {
+        static const unpack_kernels kernels = select_best_kernels();
+        return kernels;
+    }
+
+    bool get_unpack_kernels(simd_level level, unpack_kernels& kernels)
+    {
+        auto k = get_reference_unpack_kernels();
+        auto& cpu = get_cpu_features();
+
+        switch (level)
+        {
+        case simd_level::scalar:
+            break;
+        case simd_level::neon:
+            // NEON is part of every ARM target this builds for, so the build decides alone
+            if (!fill_neon_kernels(k))
+                return false;
+            break;
+        case simd_level::avx512:
+        case simd_level::avx2:
+        case simd_level::sse41:
+            // Each x86 level builds on the one below it
+            if (!cpu.sse41 || !fill_sse41_kernels(k))
+                return false;
+            if (level == simd_level::sse41)
+                break;
+            if (!cpu.avx2 || !fill_avx2_kernels(k))
+                return false;
+            if (level == simd_level::avx2)
+                break;
+            if (!cpu.avx512 || !fill_avx512_kernels(k))
+                return false;
+            break;
+        default:
+            return false;
+        }
+
+        k.level = level;
+        kernels = k;
+        return true;
+    }
+}
@@ -0,0 +1,193 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#pragma once
+#ifndef LIBREALSENSE_IMAGE_SIMD_H
+#define LIBREALSENSE_IMAGE_SIMD_H
+
+#include <cstdint>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace librealsense
+{
+    // Pixel format kernels behind the format converters, and the depth projections behind the
+    // align and pointcloud blocks, selected at runtime for the best instruction set both the build and the CPU support. Every kernel has a scalar reference
+    // and the vectorized versions are bit-exact with it; each level only overrides the kernels
+    // it accelerates and inherits the rest from the level below.
+    // The per-ISA kernels live in translation units built with their own instruction set flags
+    // (image-simd-*.cpp), so nothing outside them may assume more than the baseline ISA
+    enum class simd_level
+    {
+        scalar,
+        sse41,
+        avx2,
+        avx512,
+        neon,
+    };
+
+    const char* get_string(simd_level level);
+
+    // dst holds one plane per output stream, count is in pixels
+    typedef void (*unpack_kernel)(uint8_t * const dst[], const uint8_t * src, int count);
+    // Rotates an 8x8 tile by 90 degrees, strides are in bytes
+    typedef void (*rotate_kernel)(uint8_t * dst, int dst_stride, const uint8_t * src, int src_stride);
+
+    // Where align moves depth pixels: the ray of each depth pixel is scaled by its depth, taken
+    // through the extrinsics into the other camera and projected onto its image
+    struct depth_projection
+    {
+        float depth_scale;
+        float rotation[9];      // column-major, as in rs2_extrinsics
+        float translation[3];
+        float fx, fy, ppx, ppy;
+        float coeffs[5];
+        bool distort;           // through the modified Brown-Conrady model of the other camera
+    };
+
+    // ray_x and ray_y are the depth camera rays at z = 1. dst gets the projected pixels as x, y
+    // pairs rounded to nearest even, 0, 0 where there is no depth and INT32_MIN where the
+    // projection is not finite
+    typedef void (*project_kernel)(int32_t * dst, const uint16_t * depth, const float * ray_x, const float * ray_y, int count, const depth_projection& p);
+
+    // Pointcloud vertices: the depth camera rays at z = 1 scaled by the depth in meters, as
+    // rs2_deproject_pixel_to_point would put them. dst holds the xyz vertices in one plane, or x, y
+    // and z in three planes for the planar layout. Half-precision vertices round to nearest even
+    typedef void (*deproject_kernel)(uint8_t * const dst[], const uint16_t * depth, const float * ray_x, const float * ray_y, int count, float depth_scale);
+
+    // Where pointcloud vertices land on the texture: through the extrinsics into the other camera
+    // and onto its image, in the order of operations of rs2_transform_point_to_point and
+    // rs2_project_point_to_pixel
+    struct point_projection
+    {
+        float rotation[9];      // column-major, as in rs2_extrinsics
+        float translation[3];
+        float fx, fy, ppx, ppy;
+        float coeffs[5];
+        float width, height;
+        bool distort;           // through the modified or inverse Brown-Conrady model of the other camera
+    };
+
+    // points are xyz vertices. tex gets the u, v texture coordinates and pixels the x, y image
+    // coordinates of each, both 0, 0 where the vertex has no depth
+    typedef void (*texture_kernel)(float * tex, float * pixels, const float * points, int count, const point_projection& p);
+
+    // Depth to disparity through a table of the disparity of every 16-bit depth, which has 0 for no
+    // depth. dst may be depth itself, the disparity then taking the place of the depth in a buffer
+    // large enough for it
+    typedef void (*disparity_lut_kernel)(float * dst, const uint16_t * depth, int count, const float * lut);
+
+    // Disparity to depth, factor / disparity rounded to nearest, 0 where the disparity is not a
+    // normal float. Depth beyond 16 bits is not defined. dst may be disparity itself
+    typedef void (*disparity_to_depth_kernel)(uint16_t * dst, const float * disparity, int count, float factor);
+
+    // Index of the first zero element of src, count if there is none. count is in elements; a
+    // 32-bit element is zero when all its bits are, which for float pixels means no data
+    typedef int (*scan_kernel)(const uint8_t * src, int count);
+
+    // The bit planes of a block of 64 values: plane b has bit b of value i at its bit i. Only the
+    // lower bits planes are packed, the bits above them are zero in the values unpacked
+    typedef void (*bitplane_pack_kernel)(uint64_t * planes, const uint16_t * src, int bits);
+    typedef void (*bitplane_unpack_kernel)(uint16_t * dst, const uint64_t * planes, int bits);
+
+    // Depth decimation by the median of the non-zero pixels of each block of scale x scale, the lower
+    // of the two middle ones for an even number of them and 0 for none. rows are the scale input rows
+    // from the first block on, count is in blocks
+    typedef void (*median_kernel)(uint16_t * dst, const uint16_t * const rows[], int count);
+
+    // Sums of the columns of row_count rows, at most 256 of them, count is in columns. For 16-bit
+    // pixels nonzero, when not null, gets the number of non-zero pixels of each column
+    typedef void (*column_sum_u8_kernel)(uint32_t * sums, const uint8_t * const rows[], int row_count, int count);
+    typedef void (*column_sum_u16_kernel)(uint32_t * sums, uint32_t * nonzero, const uint16_t * const rows[], int row_count, int count);
+
+    // The monotonic occlusion scan along a row of pointcloud vertices: the number of leading pixels
+    // it passes without invalidating any, those without depth and those whose texture x is above
+    // max_x, the largest before them. max_x and max_z follow the last pixel with depth of the run.
+    // pixels are the x, y texture pixels and points the xyz vertices
+    typedef int (*occlusion_run_kernel)(const float * pixels, const float * points, int count, float & max_x, float & max_z);
+
+    struct unpack_kernels
+    {
+        simd_level level;
+
+        unpack_kernel yuy2_to_y8;
+        unpack_kernel yuy2_to_y16;
+        unpack_kernel yuy2_to_rgb8;
+        unpack_kernel yuy2_to_rgba8;
+        unpack_kernel yuy2_to_bgr8;
+        unpack_kernel yuy2_to_bgra8;
+
+        unpack_kernel uyvy_to_rgb8;
+        unpack_kernel uyvy_to_rgba8;
+        unpack_kernel uyvy_to_bgr8;
+        unpack_kernel uyvy_to_bgra8;
+
+        unpack_kernel bgr8_to_rgb8;
+        unpack_kernel y8i_to_y8_y8;         // left and right planes
+        unpack_kernel y12i_to_y16_y16;      // left and right planes
+        unpack_kernel y16_10_to_y8;         // INVI, and the IR half of INZI
+        unpack_kernel y16_10_to_y16;
+        unpack_kernel w10_to_y10bpack;      // count is a multiple of 4
+
+        rotate_kernel rotate_8x8_u8;
+        rotate_kernel rotate_8x8_u16;
+
+        project_kernel project_depth;
+
+        deproject_kernel deproject_xyz;
+        deproject_kernel deproject_planar;
+        deproject_kernel deproject_xyz_half;
+        texture_kernel texture_map;
+
+        disparity_lut_kernel depth_to_disparity;
+        disparity_to_depth_kernel disparity_to_depth;
+
+        scan_kernel find_zero_u16;          // depth holes
+        scan_kernel find_zero_u32;          // disparity holes
+        scan_kernel find_nonzero_u16;       // the end of a depth hole
+
+        bitplane_pack_kernel bitplane_pack;
+        bitplane_unpack_kernel bitplane_unpack;
+
+        median_kernel median_2x2;
+        median_kernel median_3x3;
+        column_sum_u8_kernel column_sum_u8;
+        column_sum_u16_kernel column_sum_u16;
+
+        occlusion_run_kernel occlusion_run;
+    };
+
+    // Index of the lowest set bit of a non-zero mask, the first lane a vector compare matched
+    inline int lowest_set_bit(uint64_t mask)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        if (_BitScanForward(&index, static_cast<unsigned long>(mask)))
+            return int(index);
+        _BitScanForward(&index, static_cast<unsigned long>(mask >> 32));
+        return int(index) + 32;
+#else
+        return __builtin_ctzll(mask);
+#endif
+    }
+
+    // Kernels for the best level available, detected once
+    const unpack_kernels& get_unpack_kernels();
+
+    // The scalar references, also finishing the tails the vector kernels leave over
+    const unpack_kernels& get_reference_unpack_kernels();
+
+    // Kernels for a specific level, false if the build or the CPU does not support it.
+    // Used to test the levels against each other
+    bool get_unpack_kernels(simd_level level, unpack_kernels& kernels);
+
+    // Each instruction set unit fills in what it accelerates, returning false when it was
+    // built without its instruction set
+    bool fill_sse41_kernels(unpack_kernels& kernels);
+    bool fill_avx2_kernels(unpack_kernels& kernels);
+    bool fill_avx512_kernels(unpack_kernels& kernels);
+    bool fill_neon_kernels(unpack_kernels& kernels);
+}
+
+#endif
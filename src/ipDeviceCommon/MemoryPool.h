@@ -5,92 +5,168 @@
 
 #include <ipDeviceCommon/RsCommon.h>
 
-#include <iostream>
-#include <mutex>
-#include <queue>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 
 #include "NetdevLog.h"
 
-#define POOL_SIZE 100
+#define POOL_SIZE 100           // buffers handed out at most at a time
+#define POOL_FREE_SLOTS 8       // returned buffers kept per size
+#define POOL_CLASS_STEPS 4      // sizes per power of two, rounding a buffer up by at most a quarter
+#define POOL_MIN_SIZE 4096
+#define POOL_REPORT_INTERVAL 5  // seconds between reports of an exhausted pool
 
+// Buffers of the sizes frames take, reused without locks. Each size, rounded up, keeps a few free
+// buffers in slots taken and filled with atomic exchanges, so any thread may get or return buffers.
+// Buffers are allocated when first needed, up to POOL_SIZE handed out at a time, after which
+// getNextMem returns nullptr until some come back
 class MemoryPool
 {
-
 public:
-    MemoryPool()
+    struct Stats
+    {
+        int inUse;          // handed out now
+        int peakInUse;
+        long long hits;     // given a buffer returned before
+        long long misses;   // given a new buffer
+        long long exhausted; // refused, POOL_SIZE being handed out
+        long long released; // returned to a full size and freed
+    };
+
+    MemoryPool(int t_capacity = POOL_SIZE)
+        : m_capacity(t_capacity)
     {
-        //alloc memory
-        std::unique_lock<std::mutex> lk(m_mutex);
-        for(int i = 0; i < POOL_SIZE; i++)
+        for(auto& slot : m_free)
         {
-            unsigned char *mem = new unsigned char[sizeof(RsFrameHeader) + MAX_FRAME_SIZE]; //TODO:to use OutPacketBuffer::maxSize;
-            m_pool.push(mem);
+            slot = nullptr;
         }
-        lk.unlock();
     }
 
-    MemoryPool(const MemoryPool& obj)
+    MemoryPool(const MemoryPool&) = delete;
+    MemoryPool& operator=(const MemoryPool&) = delete;
+
+    ~MemoryPool()
     {
-        m_pool = obj.m_pool;
+        for(auto& slot : m_free)
+        {
+            delete[] slot.exchange(nullptr);
+        }
     }
 
-    MemoryPool& operator=(const MemoryPool&& obj)
+    // A buffer of at least t_size bytes
+    unsigned char* getNextMem(size_t t_size = sizeof(RsFrameHeader) + MAX_FRAME_SIZE)
     {
-        m_pool = obj.m_pool;
-        return *this;
+        if(m_inUse.fetch_add(1) >= m_capacity)
+        {
+            m_inUse--;
+            m_exhausted++;
+            reportExhausted();
+            return nullptr;
+        }
+        updatePeak();
+
+        int sizeClass = classOf(t_size);
+        for(int i = 0; i < POOL_FREE_SLOTS; i++)
+        {
+            unsigned char* mem = m_free[sizeClass * POOL_FREE_SLOTS + i].exchange(nullptr);
+            if(mem != nullptr)
+            {
+                m_hits++;
+                return mem + HEADER_SIZE;
+            }
+        }
+
+        m_misses++;
+        unsigned char* mem = new unsigned char[HEADER_SIZE + classSize(sizeClass)];
+        *(int*)mem = sizeClass;
+        return mem + HEADER_SIZE;
     }
 
-    unsigned char* getNextMem()
+    void returnMem(unsigned char* t_mem)
     {
-        unsigned char* mem = nullptr;
-        std::unique_lock<std::mutex> lk(m_mutex);
-        if(!m_pool.empty())
+        if(t_mem == nullptr)
         {
-            mem = m_pool.front();
-            m_pool.pop();
+            ERR << "returnMem: invalid address";
+            return;
         }
-        else
+
+        unsigned char* mem = t_mem - HEADER_SIZE;
+        int sizeClass = *(int*)mem;
+        m_inUse--;
+        for(int i = 0; i < POOL_FREE_SLOTS; i++)
         {
-            ERR << "getNextMem: pool is empty";
+            unsigned char* empty = nullptr;
+            if(m_free[sizeClass * POOL_FREE_SLOTS + i].compare_exchange_strong(empty, mem))
+            {
+                return;
+            }
         }
-        lk.unlock();
-        return mem;
+        m_released++;
+        delete[] mem;
     }
 
-    void returnMem(unsigned char* t_mem)
+    // The size of the buffers getNextMem(t_size) returns
+    static size_t bufferSize(size_t t_size)
+    {
+        return classSize(classOf(t_size));
+    }
+
+    Stats getStats() const
+    {
+        return {m_inUse.load(), m_peakInUse.load(), m_hits.load(), m_misses.load(), m_exhausted.load(), m_released.load()};
+    }
+
+private:
+    // before each buffer, its size class, keeping the buffer 16-byte aligned
+    static const size_t HEADER_SIZE = 16;
+    static const int CLASSES = 64 * POOL_CLASS_STEPS;
+
+    static int classOf(size_t t_size)
     {
-        if(t_mem != nullptr)
+        if(t_size < POOL_MIN_SIZE)
         {
-            std::unique_lock<std::mutex> lk(m_mutex);
-            m_pool.push(t_mem);
-            lk.unlock();
+            t_size = POOL_MIN_SIZE;
         }
-        else
+        int power = 0;
+        while((size_t(1) << (power + 1)) <= t_size)
         {
-            ERR << "returnMem: invalid address";
+            power++;
         }
+        size_t step = (size_t(1) << power) / POOL_CLASS_STEPS;
+        return power * POOL_CLASS_STEPS + int((t_size - (size_t(1) << power) + step - 1) / step);
     }
 
-    ~MemoryPool()
+    static size_t classSize(int t_class)
+    {
+        int power = t_class / POOL_CLASS_STEPS;
+        return (size_t(1) << power) + (t_class % POOL_CLASS_STEPS) * ((size_t(1) << power) / POOL_CLASS_STEPS);
+    }
+
+    void updatePeak()
     {
-        std::unique_lock<std::mutex> lk(m_mutex);
-        while(!m_pool.empty())
+        int inUse = m_inUse.load();
+        int peak = m_peakInUse.load();
+        while(inUse > peak && !m_peakInUse.compare_exchange_weak(peak, inUse))
         {
-            unsigned char* mem = m_pool.front();
-            m_pool.pop();
-            if(mem != nullptr)
-            {
-                delete mem;
-            }
-            else
-            {
-                ERR << "~memory_pool: invalid address";
-            }
         }
-        lk.unlock();
     }
 
-private:
-    std::queue<unsigned char*> m_pool;
-    std::mutex m_mutex;
+    void reportExhausted()
+    {
+        long long now = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        long long last = m_lastReport.load();
+        if(now - last >= POOL_REPORT_INTERVAL && m_lastReport.compare_exchange_strong(last, now))
+        {
+            Stats stats = getStats();
+            ERR << "getNextMem: pool is empty, " << stats.inUse << " buffers in use, " << stats.exhausted << " requests refused so far";
+        }
+    }
+
+    const int m_capacity;
+    std::atomic<unsigned char*> m_free[CLASSES * POOL_FREE_SLOTS];
+    std::atomic<int> m_inUse{0}, m_peakInUse{0};
+    std::atomic<long long> m_hits{0}, m_misses{0}, m_exhausted{0}, m_released{0};
+    std::atomic<long long> m_lastReport{-POOL_REPORT_INTERVAL};
 };
@@ -52,4 +52,10 @@ const int MAX_MESSAGE_SIZE = MAX_FRAME_SIZE + sizeof(RsFrameHeader);
 const unsigned int SDP_MAX_LINE_LENGHT = 4000;
 const unsigned int RTP_TIMESTAMP_FREQ = 90000;
 
+// What goes over the wire, raised with each change peers of other versions would misread:
+// 2 - compressed depth frames start with the header of the depth codec that made them (rs2_encode_depth)
+const int RS_NETWORK_PROTOCOL_VERSION = 2;
+// Clients say which version they speak in their User-Agent, the server in the "protocol" field of each stream
+const std::string RS_NETWORK_PROTOCOL_AGENT("rs-network-protocol/");
+
 #pragma pack(pop)
@@ -1101,8 +1101,18 @@ namespace librealsense
             throw linux_backend_exception(to_string() << " custom sensor " << custom_sensor_name << " not found!");
         }
 
-        void v4l_hid_device::foreach_hid_device(std::function<void(const hid_device_info&)> action)
+        void v4l_hid_device::foreach_hid_device(std::function<void(const hid_device_info&)> action,
+                                                const std::string& usb_path)
         {
+            auto under_usb_path = [&usb_path](const std::string& elem)
+            {
+                if (usb_path.empty())
+                    return true;
+                char device_path[PATH_MAX] = {};
+                return realpath(elem.c_str(), device_path) != nullptr &&
+                       std::string(device_path).compare(0, usb_path.size() + 1, usb_path + "/") == 0;
+            };
+
             // Common HID Sensors
             DIR* dir = nullptr;
             struct dirent* ent = nullptr;
@@ -1120,6 +1130,9 @@ namespace librealsense
 
             for (auto& elem : common_sensors)
             {
+                if (!under_usb_path(elem))
+                    continue;
+
                 hid_device_info hid_dev_info{};
                 if(!get_hid_device_info(elem.c_str(), hid_dev_info))
                 {
@@ -1163,6 +1176,9 @@ namespace librealsense
 
             for (auto& elem : custom_sensors)
             {
+                if (!under_usb_path(elem))
+                    continue;
+
                 hid_device_info hid_dev_info{};
                 if(!get_hid_device_info(elem.c_str(), hid_dev_info))
                 {
@@ -209,7 +209,9 @@ namespace librealsense
                                                         const std::string& report_name,
                                                         custom_sensor_report_field report_field);
 
-            static void foreach_hid_device(std::function<void(const hid_device_info&)> action);
+            // usb_path, when given, limits the devices to those under the sysfs path of one USB device
+            static void foreach_hid_device(std::function<void(const hid_device_info&)> action,
+                                           const std::string& usb_path = "");
 
         private:
             static bool get_hid_device_info(const char* dev_path, hid_device_info& device_info);
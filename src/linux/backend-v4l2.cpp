@@ -3,6 +3,8 @@
 
 #include "backend-v4l2.h"
 #include "backend-hid.h"
+#include "uevent-device-watcher.h"
+#include "capture-reactor.h"
 #include "backend.h"
 #include "types.h"
 #include "usb/usb-enumerator.h"
@@ -445,7 +447,8 @@ namespace librealsense
 
         void v4l_uvc_device::foreach_uvc_device(
                 std::function<void(const uvc_device_info&,
-                                   const std::string&)> action)
+                                   const std::string&)> action,
+                const std::string& usb_path)
         {
             // Enumerate all subdevices present on the system
             DIR * dir = opendir("/sys/class/video4linux");
@@ -475,6 +478,10 @@ namespace librealsense
                         continue;
                 }
 
+                // Skipped before any of its attributes is read
+                if (!usb_path.empty() && real_path.compare(0, usb_path.size() + 1, usb_path + "/") != 0)
+                    continue;
+
                 try
                 {
                     uint16_t vid, pid, mi;
@@ -630,11 +637,9 @@ namespace librealsense
               _is_capturing(false),
               _is_alive(true),
               _is_started(false),
-              _thread(nullptr),
               _named_mtx(nullptr),
               _use_memory_map(use_memory_map),
-              _fd(-1),
-              _stop_pipe_fd{}
+              _fd(-1)
         {
             foreach_uvc_device([&info, this](const uvc_device_info& i, const std::string& name)
             {
@@ -655,11 +660,8 @@ namespace librealsense
         v4l_uvc_device::~v4l_uvc_device()
         {
             _is_capturing = false;
-            if (_thread && _thread->joinable()) _thread->join();
-            for (auto&& fd : _fds)
-            {
-                try { if (fd) ::close(fd);} catch (...) {}
-            }
+            if (_reactor) _reactor->remove(_fd);
+            if (_fd > 0) ::close(_fd);
         }
 
         void v4l_uvc_device::probe_and_commit(stream_profile profile, frame_callback callback, int buffers)
@@ -752,7 +754,9 @@ namespace librealsense
                 streamon();
 
                 _is_capturing = true;
-                _thread = std::unique_ptr<std::thread>(new std::thread([this](){ capture_loop(); }));
+                _reactor = capture_reactor::get_default();
+                _reactor->add(_fd, [this]() { on_frames_ready(); }, [this]() { on_frames_timeout(); },
+                    std::chrono::milliseconds(5000));
             }
         }
 
@@ -766,11 +770,9 @@ namespace librealsense
             _is_capturing = false;
             _is_started = false;
 
-            // Stop nn-demand frames polling
-            signal_stop();
-
-            _thread->join();
-            _thread.reset();
+            // Once removed, no frame is dequeued any more
+            _reactor->remove(_fd);
+            _reactor.reset();
 
             // Notify kernel
             streamoff();
@@ -814,186 +816,109 @@ namespace librealsense
             return fourcc_buff;
         }
 
-        void v4l_uvc_device::signal_stop()
+        bool v4l_uvc_device::dequeue_frame()
         {
-            char buff[1]={};
-            if (write(_stop_pipe_fd[1], buff, 1) < 0)
+            v4l2_buffer buf = {};
+            buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            buf.memory = _use_memory_map ? V4L2_MEMORY_MMAP : V4L2_MEMORY_USERPTR;
+            if(xioctl(_fd, VIDIOC_DQBUF, &buf) < 0)
             {
-                 throw linux_backend_exception("Could not signal video capture thread to stop. Error write to pipe.");
+                LOG_DEBUG_V4L("Dequeued empty buf for fd " << std::dec << _fd);
+                if(errno == EAGAIN)
+                    return false;
+
+                throw linux_backend_exception(to_string() << "xioctl(VIDIOC_DQBUF) failed for fd: " << _fd);
             }
-        }
+            LOG_DEBUG_V4L("Dequeued buf " << std::dec << buf.index << " for fd " << _fd << " seq " << buf.sequence);
 
-        void v4l_uvc_device::poll()
-        {
-             fd_set fds{};
-             FD_ZERO(&fds);
-             for (auto fd : _fds)
-             {
-                 FD_SET(fd, &fds);
-             }
+            bool md_extracted = false;
+            buffers_mgr buf_mgr(_use_memory_map);
+            // RAII to handle exceptions
+            std::unique_ptr<int, std::function<void(int*)> > md_poller(new int(0),
+                [this,&buf_mgr,&md_extracted](int* d)
+                {
+                    if (!md_extracted) acquire_metadata(buf_mgr);
+                    delete d;
+                });
 
-            struct timespec mono_time;
-            int ret = clock_gettime(CLOCK_MONOTONIC, &mono_time);
-            if (ret) throw linux_backend_exception("could not query time!");
+            auto buffer = _buffers[buf.index];
+            buf_mgr.handle_buffer(e_video_buf,_fd, buf,buffer);
 
-            struct timeval expiration_time = { mono_time.tv_sec + 5, mono_time.tv_nsec / 1000 };
-            int val = 0;
-            do {
-                struct timeval remaining;
-                ret = clock_gettime(CLOCK_MONOTONIC, &mono_time);
-                if (ret) throw linux_backend_exception("could not query time!");
-
-                struct timeval current_time = { mono_time.tv_sec, mono_time.tv_nsec / 1000 };
-                timersub(&expiration_time, &current_time, &remaining);
-                if (timercmp(&current_time, &expiration_time, <)) {
-                    val = select(_max_fd + 1, &fds, nullptr, nullptr, &remaining);
-                }
-                else {
-                    val = 0;
+            if (_is_started)
+            {
+                if(buf.bytesused == 0)
+                {
+                    LOG_INFO("Empty video frame arrived");
+                    return true;
                 }
-            } while (val < 0 && errno == EINTR);
 
-            if(val < 0)
-            {
-                stop_data_capture();
-            }
-            else
-            {
-                if(val > 0)
+                // Relax the required frame size for compressed formats, i.e. MJPG, Z16H
+                // Drop partial and overflow frames (assumes D4XX metadata only)
+                bool compressed_format = val_in_range(_profile.format, { 0x4d4a5047U , 0x5a313648U});
+                bool partial_frame = (!compressed_format && (buf.bytesused < buffer->get_full_length() - MAX_META_DATA_SIZE));
+                bool overflow_frame = (buf.bytesused ==  buffer->get_length_frame_only() + MAX_META_DATA_SIZE);
+                if (partial_frame || overflow_frame)
                 {
-                    if(FD_ISSET(_stop_pipe_fd[0], &fds) || FD_ISSET(_stop_pipe_fd[1], &fds))
+                    auto percentage = (100 * buf.bytesused) / buffer->get_full_length();
+                    std::stringstream s;
+                    if (partial_frame)
                     {
-                        if(!_is_capturing)
+                        s << "Incomplete video frame detected!\nSize " << buf.bytesused
+                            << " out of " << buffer->get_full_length() << " bytes (" << percentage << "%)";
+                        if (overflow_frame)
                         {
-                            LOG_INFO("V4L stream is closed");
-                            return;
-                        }
-                        else
-                        {
-                            LOG_ERROR("Stop pipe was signalled during streaming");
-                            return;
+                            s << ". Overflow detected: payload size " << buffer->get_length_frame_only();
+                            LOG_ERROR("Corrupted UVC frame data, underflow and overflow reported:\n" << s.str().c_str());
                         }
                     }
-                    else // Check and acquire data buffers from kernel
+                    else
                     {
-                        bool md_extracted = false;
-                        buffers_mgr buf_mgr(_use_memory_map);
-                        // RAII to handle exceptions
-                        std::unique_ptr<int, std::function<void(int*)> > md_poller(new int(0),
-                            [this,&buf_mgr,&md_extracted,&fds](int* d)
-                            {
-                                if (!md_extracted) acquire_metadata(buf_mgr,fds);
-                                delete d;
-                            });
+                        if (overflow_frame)
+                            s << "overflow video frame detected!\nSize " << buf.bytesused
+                                << ", payload size " << buffer->get_length_frame_only();
+                    }
+                    librealsense::notification n = { RS2_NOTIFICATION_CATEGORY_FRAME_CORRUPTED, 0, RS2_LOG_SEVERITY_WARN, s.str()};
 
-                        if(FD_ISSET(_fd, &fds))
-                        {
-                            FD_CLR(_fd,&fds);
-                            v4l2_buffer buf = {};
-                            buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-                            buf.memory = _use_memory_map ? V4L2_MEMORY_MMAP : V4L2_MEMORY_USERPTR;
-                            if(xioctl(_fd, VIDIOC_DQBUF, &buf) < 0)
-                            {
-                                LOG_DEBUG_V4L("Dequeued empty buf for fd " << std::dec << _fd);
-                                if(errno == EAGAIN)
-                                    return;
+                    _error_handler(n);
+                }
+                else
+                {
+                    auto timestamp = (double)buf.timestamp.tv_sec*1000.f + (double)buf.timestamp.tv_usec/1000.f;
+                    timestamp = monotonic_to_realtime(timestamp);
 
-                                throw linux_backend_exception(to_string() << "xioctl(VIDIOC_DQBUF) failed for fd: " << _fd);
-                            }
-                            LOG_DEBUG_V4L("Dequeued buf " << std::dec << buf.index << " for fd " << _fd << " seq " << buf.sequence);
+                    // Read metadata. For metadata note performs a blocking call to ensure video and metadata sync
+                    acquire_metadata(buf_mgr,compressed_format);
+                    md_extracted = true;
 
-                            auto buffer = _buffers[buf.index];
-                            buf_mgr.handle_buffer(e_video_buf,_fd, buf,buffer);
+                    //if (val > 1)
+                    //    LOG_INFO("Frame buf ready, md size: " << std::dec << (int)buf_mgr.metadata_size() << " seq. id: " << buf.sequence);
+                    frame_object fo{ std::min(buf.bytesused - buf_mgr.metadata_size(), buffer->get_length_frame_only()), buf_mgr.metadata_size(),
+                        buffer->get_frame_start(), buf_mgr.metadata_start(), timestamp, true };
 
-                            if (_is_started)
-                            {
-                                if(buf.bytesused == 0)
-                                {
-                                    LOG_INFO("Empty video frame arrived");
-                                    return;
-                                }
+                    buffer->attach_buffer(buf);
+                    buf_mgr.handle_buffer(e_video_buf,-1); // transfer new buffer request to the frame callback
 
-                                // Relax the required frame size for compressed formats, i.e. MJPG, Z16H
-                                // Drop partial and overflow frames (assumes D4XX metadata only)
-                                bool compressed_format = val_in_range(_profile.format, { 0x4d4a5047U , 0x5a313648U});
-                                bool partial_frame = (!compressed_format && (buf.bytesused < buffer->get_full_length() - MAX_META_DATA_SIZE));
-                                bool overflow_frame = (buf.bytesused ==  buffer->get_length_frame_only() + MAX_META_DATA_SIZE);
-                                if (partial_frame || overflow_frame)
-                                {
-                                    auto percentage = (100 * buf.bytesused) / buffer->get_full_length();
-                                    std::stringstream s;
-                                    if (partial_frame)
-                                    {
-                                        s << "Incomplete video frame detected!\nSize " << buf.bytesused
-                                            << " out of " << buffer->get_full_length() << " bytes (" << percentage << "%)";
-                                        if (overflow_frame)
-                                        {
-                                            s << ". Overflow detected: payload size " << buffer->get_length_frame_only();
-                                            LOG_ERROR("Corrupted UVC frame data, underflow and overflow reported:\n" << s.str().c_str());
-                                        }
-                                    }
-                                    else
-                                    {
-                                        if (overflow_frame)
-                                            s << "overflow video frame detected!\nSize " << buf.bytesused
-                                                << ", payload size " << buffer->get_length_frame_only();
-                                    }
-                                    librealsense::notification n = { RS2_NOTIFICATION_CATEGORY_FRAME_CORRUPTED, 0, RS2_LOG_SEVERITY_WARN, s.str()};
-
-                                    _error_handler(n);
-                                }
-                                else
-                                {
-                                    auto timestamp = (double)buf.timestamp.tv_sec*1000.f + (double)buf.timestamp.tv_usec/1000.f;
-                                    timestamp = monotonic_to_realtime(timestamp);
-
-                                    // Read metadata. For metadata note performs a blocking call to ensure video and metadata sync
-                                    acquire_metadata(buf_mgr,fds,compressed_format);
-                                    md_extracted = true;
-
-                                    //if (val > 1)
-                                    //    LOG_INFO("Frame buf ready, md size: " << std::dec << (int)buf_mgr.metadata_size() << " seq. id: " << buf.sequence);
-                                    frame_object fo{ std::min(buf.bytesused - buf_mgr.metadata_size(), buffer->get_length_frame_only()), buf_mgr.metadata_size(),
-                                        buffer->get_frame_start(), buf_mgr.metadata_start(), timestamp };
-
-                                    buffer->attach_buffer(buf);
-                                    buf_mgr.handle_buffer(e_video_buf,-1); // transfer new buffer request to the frame callback
-
-                                    if (buf_mgr.verify_vd_md_sync())
-                                    {
-                                        //Invoke user callback and enqueue next frame
-                                        _callback(_profile, fo, [buf_mgr]() mutable {
-                                            buf_mgr.request_next_frame();
-                                        });
-                                    }
-                                    else
-                                    {
-                                        LOG_WARNING("Video frame dropped, video and metadata buffers inconsistency");
-                                    }
-                                }
-                            }
-                            else
-                            {
-                                LOG_INFO("Video frame arrived in idle mode."); // TODO - verification
-                            }
-                        }
-                        else
-                        {
-                            LOG_WARNING("FD_ISSET signal false - no data on video node sink");
-                        }
+                    if (buf_mgr.verify_vd_md_sync())
+                    {
+                        //Invoke user callback and enqueue next frame
+                        _callback(_profile, fo, [buf_mgr]() mutable {
+                            buf_mgr.request_next_frame();
+                        });
+                    }
+                    else
+                    {
+                        LOG_WARNING("Video frame dropped, video and metadata buffers inconsistency");
                     }
                 }
-                else // (val==0)
-                {
-                    LOG_WARNING("Frames didn't arrived within 5 seconds");
-                    librealsense::notification n = {RS2_NOTIFICATION_CATEGORY_FRAMES_TIMEOUT, 0, RS2_LOG_SEVERITY_WARN,  "Frames didn't arrived within 5 seconds"};
-
-                    _error_handler(n);
-                }
             }
+            else
+            {
+                LOG_INFO("Video frame arrived in idle mode."); // TODO - verification
+            }
+            return true;
         }
 
-        void v4l_uvc_device::acquire_metadata(buffers_mgr & buf_mgr,fd_set &, bool compressed_format)
+        void v4l_uvc_device::acquire_metadata(buffers_mgr & buf_mgr, bool compressed_format)
         {
             if (has_metadata())
                 buf_mgr.set_md_from_video_node(compressed_format);
@@ -1296,25 +1221,34 @@ namespace librealsense
             }
         }
 
-        void v4l_uvc_device::capture_loop()
+        // Takes every buffer the kernel filled by now, one wake of the reactor for all of them
+        void v4l_uvc_device::on_frames_ready()
         {
             try
             {
-                while(_is_capturing)
-                {
-                    poll();
-                }
+                while (_is_capturing && dequeue_frame());
             }
             catch (const std::exception& ex)
             {
                 LOG_ERROR(ex.what());
 
+                // Not served any more, as the capture thread of the device used to end on errors
+                _reactor->remove(_fd);
+
                 librealsense::notification n = {RS2_NOTIFICATION_CATEGORY_UNKNOWN_ERROR, 0, RS2_LOG_SEVERITY_ERROR, ex.what()};
 
                 _error_handler(n);
             }
         }
 
+        void v4l_uvc_device::on_frames_timeout()
+        {
+            LOG_WARNING("Frames didn't arrived within 5 seconds");
+            librealsense::notification n = {RS2_NOTIFICATION_CATEGORY_FRAMES_TIMEOUT, 0, RS2_LOG_SEVERITY_WARN,  "Frames didn't arrived within 5 seconds"};
+
+            _error_handler(n);
+        }
+
         bool v4l_uvc_device::has_metadata() const
         {
             return !_use_memory_map;
@@ -1362,14 +1296,6 @@ namespace librealsense
             if(_fd < 0)
                 throw linux_backend_exception(to_string() <<__FUNCTION__ << " Cannot open '" << _name);
 
-            if (pipe(_stop_pipe_fd) < 0)
-                throw linux_backend_exception(to_string() <<__FUNCTION__ << " Cannot create pipe!");
-
-            if (_fds.size())
-                throw linux_backend_exception(to_string() <<__FUNCTION__ << " Device descriptor is already allocated");
-
-            _fds.insert(_fds.end(),{_fd,_stop_pipe_fd[0],_stop_pipe_fd[1]});
-            _max_fd = *std::max_element(_fds.begin(),_fds.end());
 
             v4l2_capability cap = {};
             if(xioctl(_fd, VIDIOC_QUERYCAP, &cap) < 0)
@@ -1409,14 +1335,7 @@ namespace librealsense
             if(::close(_fd) < 0)
                 throw linux_backend_exception("v4l_uvc_device: close(_fd) failed");
 
-            if(::close(_stop_pipe_fd[0]) < 0)
-               throw linux_backend_exception("v4l_uvc_device: close(_stop_pipe_fd[0]) failed");
-            if(::close(_stop_pipe_fd[1]) < 0)
-               throw linux_backend_exception("v4l_uvc_device: close(_stop_pipe_fd[1]) failed");
-
             _fd = 0;
-            _stop_pipe_fd[0] = _stop_pipe_fd[1] = 0;
-            _fds.clear();
         }
 
         void v4l_uvc_device::set_format(stream_profile profile)
@@ -1509,9 +1428,6 @@ namespace librealsense
             //The minimal video/metadata nodes syncer will be implemented by using two blocking calls:
             // 1. Obtain video node data.
             // 2. Obtain metadata
-            //     To revert to multiplexing mode uncomment the next line
-            // _fds.push_back(_md_fd);
-            _max_fd = *std::max_element(_fds.begin(),_fds.end());
 
             v4l2_capability cap = {};
             if(xioctl(_md_fd, VIDIOC_QUERYCAP, &cap) < 0)
@@ -1588,16 +1504,14 @@ namespace librealsense
         }
 
         // Retrieve metadata from a dedicated UVC node. For kernels 4.16+
-        void v4l_uvc_meta_device::acquire_metadata(buffers_mgr & buf_mgr,fd_set &fds, bool)
+        void v4l_uvc_meta_device::acquire_metadata(buffers_mgr & buf_mgr, bool)
         {
             // Metadata is calculated once per frame
             if (buf_mgr.metadata_size())
                 return;
 
-            //Use blocking metadata node polling. Uncomment the next lines to revert to multiplexing I/O mode
-            //if(FD_ISSET(_md_fd, &fds))
+            // Read right after the video node, rather than watched by the capture reactor on its own
             {
-                //FD_CLR(_md_fd,&fds);
                 v4l2_buffer buf{};
                 buf.type = LOCAL_V4L2_BUF_TYPE_META_CAPTURE;
                 buf.memory = _use_memory_map ? V4L2_MEMORY_MMAP : V4L2_MEMORY_USERPTR;
@@ -1706,9 +1620,50 @@ namespace librealsense
             return std::make_shared<os_time_service>();
         }
 
+        // The sysfs scans of the backend, narrowed to the USB device a uevent was under
+        class v4l_device_scanner : public device_scanner
+        {
+        public:
+            v4l_device_scanner(const v4l_backend* backend) : _backend(backend) {}
+
+            std::vector<uvc_device_info> query_uvc_devices(const std::string& usb_path) const override
+            {
+                std::vector<uvc_device_info> uvc_nodes;
+                v4l_uvc_device::foreach_uvc_device(
+                [&uvc_nodes](const uvc_device_info& i, const std::string&)
+                {
+                    uvc_nodes.push_back(i);
+                }, usb_path);
+                return uvc_nodes;
+            }
+
+            std::vector<hid_device_info> query_hid_devices(const std::string& usb_path) const override
+            {
+                std::vector<hid_device_info> results;
+                v4l_hid_device::foreach_hid_device([&](const hid_device_info& hid_dev_info){
+                    results.push_back(hid_dev_info);
+                }, usb_path);
+                return results;
+            }
+
+            std::vector<usb_device_info> query_usb_devices() const override
+            {
+                return _backend->query_usb_devices();
+            }
+
+        private:
+            const v4l_backend* _backend;
+        };
+
         std::shared_ptr<device_watcher> v4l_backend::create_device_watcher() const
         {
-            return std::make_shared<polling_device_watcher>(this);
+            auto socket = uevent_device_watcher::open_netlink_socket();
+            if (socket < 0)
+            {
+                LOG_WARNING("Cannot listen to device uevents, errno " << errno << ", polling for devices instead");
+                return std::make_shared<polling_device_watcher>(this);
+            }
+            return std::make_shared<uevent_device_watcher>(std::make_shared<v4l_device_scanner>(this), socket);
         }
 
         std::shared_ptr<backend> create_backend()
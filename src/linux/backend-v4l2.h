@@ -213,9 +213,12 @@ namespace librealsense
             std::array<kernel_buf_guard, e_max_kernel_buf_type> buffers;
         };
 
+        class capture_reactor;
+
         class v4l_uvc_interface
         {
-            virtual void capture_loop() = 0;
+            virtual void on_frames_ready() = 0;
+            virtual void on_frames_timeout() = 0;
 
             virtual bool has_metadata() const = 0;
 
@@ -229,15 +232,17 @@ namespace librealsense
             virtual void set_format(stream_profile profile) = 0;
             virtual void prepare_capture_buffers() = 0;
             virtual void stop_data_capture() = 0;
-            virtual void acquire_metadata(buffers_mgr & buf_mgr,fd_set &fds, bool compressed_format) = 0;
+            virtual void acquire_metadata(buffers_mgr & buf_mgr, bool compressed_format) = 0;
         };
 
         class v4l_uvc_device : public uvc_device, public v4l_uvc_interface
         {
         public:
+            // usb_path, when given, limits the nodes to those under the sysfs path of one USB device
             static void foreach_uvc_device(
                     std::function<void(const uvc_device_info&,
-                                       const std::string&)> action);
+                                       const std::string&)> action,
+                    const std::string& usb_path = "");
 
             v4l_uvc_device(const uvc_device_info& info, bool use_memory_map = false);
 
@@ -255,9 +260,8 @@ namespace librealsense
 
             std::string fourcc_to_string(uint32_t id) const;
 
-            void signal_stop();
-
-            void poll();
+            // Dequeues one buffer the kernel filled, if there is any, and hands it on
+            bool dequeue_frame();
 
             void set_power_state(power_state state) override;
             power_state get_power_state() const override { return _state; }
@@ -284,7 +288,8 @@ namespace librealsense
         protected:
             static uint32_t get_cid(rs2_option option);
 
-            virtual void capture_loop() override;
+            virtual void on_frames_ready() override;
+            virtual void on_frames_timeout() override;
 
             virtual bool has_metadata() const override;
 
@@ -298,7 +303,7 @@ namespace librealsense
             virtual void set_format(stream_profile profile) override;
             virtual void prepare_capture_buffers() override;
             virtual void stop_data_capture() override;
-            virtual void acquire_metadata(buffers_mgr & buf_mgr,fd_set &fds, bool compressed_format = false) override;
+            virtual void acquire_metadata(buffers_mgr & buf_mgr, bool compressed_format = false) override;
 
             power_state _state = D3;
             std::string _name = "";
@@ -312,15 +317,12 @@ namespace librealsense
             std::atomic<bool> _is_capturing;
             std::atomic<bool> _is_alive;
             std::atomic<bool> _is_started;
-            std::unique_ptr<std::thread> _thread;
+            std::shared_ptr<capture_reactor> _reactor;  // serves the video node while streaming
             std::unique_ptr<named_mutex> _named_mtx;
             bool _use_memory_map;
-            int _max_fd = 0;                    // specifies the maximal pipe number the polling process will monitor
-            std::vector<int>  _fds;             // list the file descriptors to be monitored during frames polling
 
         private:
             int _fd = 0;          // prevent unintentional abuse in derived class
-            int _stop_pipe_fd[2]; // write to _stop_pipe_fd[1] and read from _stop_pipe_fd[0]
 
         };
 
@@ -342,7 +344,7 @@ namespace librealsense
             void unmap_device_descriptor();
             void set_format(stream_profile profile);
             void prepare_capture_buffers();
-            virtual void acquire_metadata(buffers_mgr & buf_mgr,fd_set &fds, bool compressed_format=false);
+            virtual void acquire_metadata(buffers_mgr & buf_mgr, bool compressed_format=false);
 
             int _md_fd = -1;
             std::string _md_name = "";
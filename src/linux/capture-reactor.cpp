@@ -0,0 +1,325 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "capture-reactor.h"
+#include "../types.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+namespace librealsense
+{
+    namespace platform
+    {
+        namespace
+        {
+            // The registration whose handler runs on this thread, which removing itself does not wait for
+            thread_local const void* serving_registration = nullptr;
+
+            const int MAX_EVENTS = 16;
+
+            std::chrono::steady_clock::rep now()
+            {
+                return std::chrono::steady_clock::now().time_since_epoch().count();
+            }
+        }
+
+        capture_reactor::capture_reactor(size_t threads, std::vector<int> cpus)
+        {
+            _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+            if (_epoll_fd < 0)
+                throw linux_backend_exception("capture reactor: epoll_create1 failed");
+
+            // Each thread takes one count of the stop event off as it leaves
+            _stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK | EFD_SEMAPHORE);
+            _wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+            for (auto fd : { _stop_fd, _wake_fd })
+            {
+                epoll_event event = {};
+                event.events = EPOLLIN;
+                event.data.fd = fd;
+                if (fd < 0 || epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0)
+                {
+                    if (_stop_fd >= 0) ::close(_stop_fd);
+                    if (_wake_fd >= 0) ::close(_wake_fd);
+                    ::close(_epoll_fd);
+                    throw linux_backend_exception("capture reactor: cannot create its events");
+                }
+            }
+
+            if (!threads)
+                threads = std::max(1u, std::min(4u, std::thread::hardware_concurrency()));
+
+            _events_per_wait = MAX_EVENTS;
+            _cpus = std::move(cpus);
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (size_t i = 0; i < threads; i++)
+                start_thread();
+        }
+
+        capture_reactor::~capture_reactor()
+        {
+            std::vector<std::thread> threads;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                threads.swap(_threads);
+            }
+            uint64_t stop = threads.size();
+            if (write(_stop_fd, &stop, sizeof(stop)) < 0)
+                LOG_ERROR("capture reactor: cannot signal stop, errno " << errno);
+            for (auto&& t : threads)
+                t.join();
+            ::close(_stop_fd);
+            ::close(_wake_fd);
+            ::close(_epoll_fd);
+        }
+
+        std::shared_ptr<capture_reactor> capture_reactor::get_default()
+        {
+            static std::mutex mutex;
+            static std::weak_ptr<capture_reactor> instance;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            auto reactor = instance.lock();
+            if (!reactor)
+            {
+                size_t threads = 0;
+                if (auto content = getenv("LRS_CAPTURE_THREADS"))
+                    threads = static_cast<size_t>(std::max(0, atoi(content)));
+
+                std::vector<int> cpus;
+                if (auto content = getenv("LRS_CAPTURE_CPUS"))
+                {
+                    std::istringstream list(content);
+                    std::string cpu;
+                    while (std::getline(list, cpu, ','))
+                    {
+                        auto n = atoi(cpu.c_str());
+                        if (n >= 0 && n < CPU_SETSIZE && !cpu.empty())
+                            cpus.push_back(n);
+                    }
+                }
+
+                reactor = std::make_shared<capture_reactor>(threads, cpus);
+                instance = reactor;
+            }
+            return reactor;
+        }
+
+        size_t capture_reactor::threads() const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _threads.size();
+        }
+
+        // Called with _mutex held
+        void capture_reactor::start_thread()
+        {
+            _threads.emplace_back([this]() { run(); });
+
+            // With more threads, each takes a descriptor at a time, and leaves the others to the rest of them
+            if (_threads.size() > 1)
+                _events_per_wait = 1;
+
+            if (!_cpus.empty())
+            {
+                cpu_set_t cpu_set;
+                CPU_ZERO(&cpu_set);
+                for (auto cpu : _cpus)
+                    CPU_SET(cpu, &cpu_set);
+                if (pthread_setaffinity_np(_threads.back().native_handle(), sizeof(cpu_set), &cpu_set))
+                    LOG_WARNING("capture reactor: cannot pin its threads to the CPUs asked for");
+            }
+        }
+
+        void capture_reactor::add(int fd, handler on_ready, handler on_timeout, std::chrono::milliseconds timeout)
+        {
+            auto r = std::make_shared<registration>();
+            r->fd = fd;
+            r->on_ready = std::move(on_ready);
+            r->on_timeout = std::move(on_timeout);
+            r->timeout = timeout;
+            r->last_event = now();
+            r->removed = false;
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_registrations.emplace(fd, r).second)
+                throw linux_backend_exception(to_string() << "capture reactor: fd " << fd << " is already served");
+
+            epoll_event event = {};
+            event.events = EPOLLIN | EPOLLPRI | EPOLLONESHOT;
+            event.data.fd = fd;
+            if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0)
+            {
+                _registrations.erase(fd);
+                throw linux_backend_exception(to_string() << "capture reactor: cannot watch fd " << fd << ", errno " << errno);
+            }
+
+            // A thread for each descriptor, so that one held in its handler leaves the others served
+            if (_registrations.size() > _threads.size())
+                start_thread();
+
+            // The threads waiting may now have a nearer timeout to keep
+            uint64_t wake = 1;
+            if (write(_wake_fd, &wake, sizeof(wake)) < 0)
+                LOG_ERROR("capture reactor: cannot wake its threads, errno " << errno);
+        }
+
+        void capture_reactor::remove(int fd)
+        {
+            std::shared_ptr<registration> r;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                auto it = _registrations.find(fd);
+                if (it == _registrations.end())
+                    return;
+                r = it->second;
+                _registrations.erase(it);
+                epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+            }
+
+            r->removed = true;
+            if (serving_registration != r.get())
+            {
+                std::lock_guard<std::mutex> wait_for_handlers(r->serving);
+            }
+        }
+
+        void capture_reactor::run()
+        {
+            epoll_event events[MAX_EVENTS];
+            while (true)
+            {
+                auto count = epoll_wait(_epoll_fd, events, _events_per_wait, time_to_next_timeout());
+                if (count < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    LOG_ERROR("capture reactor: epoll_wait failed, errno " << errno);
+                    return;
+                }
+
+                for (int i = 0; i < count; i++)
+                {
+                    auto fd = events[i].data.fd;
+                    if (fd == _stop_fd)
+                    {
+                        uint64_t value = 0;
+                        if (read(_stop_fd, &value, sizeof(value)) == sizeof(value))
+                            return;
+                        continue;
+                    }
+                    if (fd == _wake_fd)
+                    {
+                        // Every thread waiting is woken, and the first to read takes the event off
+                        uint64_t value;
+                        if (read(_wake_fd, &value, sizeof(value)) < 0) {}
+                        continue;
+                    }
+
+                    std::shared_ptr<registration> r;
+                    {
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        auto it = _registrations.find(fd);
+                        if (it != _registrations.end())
+                            r = it->second;
+                    }
+                    if (r)
+                        serve(r);
+                }
+
+                check_timeouts();
+            }
+        }
+
+        void capture_reactor::serve(const std::shared_ptr<registration>& r)
+        {
+            {
+                std::lock_guard<std::mutex> lock(r->serving);
+                if (r->removed)
+                    return;
+
+                r->last_event = now();
+                serving_registration = r.get();
+                try
+                {
+                    r->on_ready();
+                }
+                catch (const std::exception& e)
+                {
+                    LOG_ERROR("capture reactor: handler of fd " << r->fd << " failed: " << e.what());
+                }
+                serving_registration = nullptr;
+            }
+
+            // Once removed, the descriptor is out of the set, or is another one's by now
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!r->removed)
+            {
+                epoll_event event = {};
+                event.events = EPOLLIN | EPOLLPRI | EPOLLONESHOT;
+                event.data.fd = r->fd;
+                if (epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, r->fd, &event) < 0)
+                    LOG_ERROR("capture reactor: cannot re-arm fd " << r->fd << ", errno " << errno);
+            }
+        }
+
+        void capture_reactor::check_timeouts()
+        {
+            std::vector<std::shared_ptr<registration>> expired;
+            auto t = now();
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                for (auto&& r : _registrations)
+                {
+                    if (t - r.second->last_event.load() >= r.second->timeout.count())
+                        expired.push_back(r.second);
+                }
+            }
+
+            for (auto&& r : expired)
+            {
+                // Another thread serving it, for frames or for its timeout, takes the event as well
+                std::unique_lock<std::mutex> lock(r->serving, std::try_to_lock);
+                if (!lock || r->removed || t - r->last_event.load() < r->timeout.count())
+                    continue;
+
+                r->last_event = t;
+                serving_registration = r.get();
+                try
+                {
+                    r->on_timeout();
+                }
+                catch (const std::exception& e)
+                {
+                    LOG_ERROR("capture reactor: timeout handler of fd " << r->fd << " failed: " << e.what());
+                }
+                serving_registration = nullptr;
+            }
+        }
+
+        int capture_reactor::time_to_next_timeout() const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_registrations.empty())
+                return -1;
+
+            auto t = now();
+            auto next = std::chrono::steady_clock::duration::max().count();
+            for (auto&& r : _registrations)
+                next = std::min(next, r.second->last_event.load() + r.second->timeout.count() - t);
+
+            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::duration(std::max<std::chrono::steady_clock::rep>(0, next)));
+            return static_cast<int>(std::min<long long>(ms.count() + 1, 60000));
+        }
+    }
+}
@@ -0,0 +1,82 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace librealsense
+{
+    namespace platform
+    {
+        // One epoll set for the nodes of every streaming V4L2 device, served by a few threads in place of a
+        // thread and a select() per device. A descriptor is armed one-shot and re-armed once its handler
+        // returns, so the handler of a device never runs on two threads at a time, while another thread
+        // takes the devices that come ready meanwhile. Handlers are meant to take all the buffers that are
+        // ready before they return.
+        // There are never fewer threads than descriptors, so a handler slow to return, as the frame
+        // callbacks it runs may be, holds up its own device but leaves a thread to each of the others
+        // Each descriptor has its timeout too: once no event came for that long, its timeout handler runs,
+        // and again after every further timeout with no event
+        class capture_reactor
+        {
+        public:
+            typedef std::function<void()> handler;
+
+            // The threads to start with, where 0 takes one per core up to 4. More are started as more descriptors
+            // are added. The threads are pinned to the given CPUs when there are any
+            capture_reactor(size_t threads = 0, std::vector<int> cpus = {});
+            ~capture_reactor();
+
+            capture_reactor(const capture_reactor&) = delete;
+            capture_reactor& operator=(const capture_reactor&) = delete;
+
+            // The reactor the devices share, for as long as any of them streams. LRS_CAPTURE_THREADS sets its
+            // threads and LRS_CAPTURE_CPUS, a comma separated list, the CPUs they are pinned to
+            static std::shared_ptr<capture_reactor> get_default();
+
+            void add(int fd, handler on_ready, handler on_timeout, std::chrono::milliseconds timeout);
+
+            // Once it returns the handlers of fd are not running and are not called again. From within the
+            // handlers of fd it returns right away, and they are not called again once they return
+            void remove(int fd);
+
+            size_t threads() const;
+
+        private:
+            struct registration
+            {
+                int fd;
+                handler on_ready;
+                handler on_timeout;
+                std::chrono::steady_clock::duration timeout;
+                std::atomic<std::chrono::steady_clock::rep> last_event;
+                std::atomic<bool> removed;
+                std::mutex serving;     // held while a handler runs
+            };
+
+            void start_thread();
+            void run();
+            void serve(const std::shared_ptr<registration>& r);
+            void check_timeouts();
+            int time_to_next_timeout() const;
+
+            int _epoll_fd;
+            int _stop_fd;           // eventfds, to stop the threads and to have them compute their timeouts again
+            int _wake_fd;
+            std::atomic<int> _events_per_wait;
+            std::vector<int> _cpus;
+
+            mutable std::mutex _mutex;
+            std::map<int, std::shared_ptr<registration>> _registrations;
+            std::vector<std::thread> _threads;
+        };
+    }
+}
@@ -0,0 +1,389 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "uevent-device-watcher.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <linux/netlink.h>
+
+namespace librealsense
+{
+    namespace platform
+    {
+        namespace
+        {
+            // The multicast groups of NETLINK_KOBJECT_UEVENT
+            const unsigned KERNEL_UEVENTS = 1;
+            const unsigned UDEV_UEVENTS = 2;
+
+            // How udevd prefixes the uevents it passes on, the magic in network order
+            struct udev_header
+            {
+                char prefix[8];
+                uint32_t magic;
+                uint32_t header_size;
+                uint32_t properties_off;
+                uint32_t properties_len;
+            };
+            const uint32_t UDEV_MAGIC = 0xfeedcafe;
+
+            // Once events keep coming for this many settle times, the pending ones are scanned anyway
+            const int MAX_SETTLE_DELAYS = 10;
+
+            void read_properties(const char* begin, const char* end, uevent& event)
+            {
+                while (begin < end)
+                {
+                    auto length = strnlen(begin, end - begin);
+                    std::string property(begin, length);
+                    begin += length + 1;
+
+                    auto equals = property.find('=');
+                    if (equals == std::string::npos)
+                        continue;
+                    auto key = property.substr(0, equals);
+                    auto value = property.substr(equals + 1);
+                    if (key == "ACTION") event.action = value;
+                    else if (key == "DEVPATH") event.devpath = value;
+                    else if (key == "SUBSYSTEM") event.subsystem = value;
+                    else if (key == "DEVTYPE") event.devtype = value;
+                }
+            }
+
+            // As usb2/2-1/2-1.4, unlike root hubs (usb2) and interfaces (2-1.4:1.0)
+            bool is_usb_device_name(const std::string& name)
+            {
+                auto dash = name.find('-');
+                if (dash == 0 || dash == std::string::npos || dash + 1 == name.size())
+                    return false;
+                for (size_t i = 0; i < name.size(); i++)
+                {
+                    auto c = name[i];
+                    if (i != dash && !isdigit(static_cast<unsigned char>(c)) && !(c == '.' && i > dash + 1))
+                        return false;
+                }
+                return true;
+            }
+
+            bool is_under(const std::string& path, const std::string& parent)
+            {
+                return path.size() > parent.size() && path[parent.size()] == '/' &&
+                    path.compare(0, parent.size(), parent) == 0;
+            }
+
+            template<class T>
+            void replace_under(std::vector<T>& nodes, const std::string& usb_path, std::vector<T> found)
+            {
+                nodes.erase(std::remove_if(nodes.begin(), nodes.end(), [&](const T& node)
+                {
+                    return is_under(node.device_path, usb_path);
+                }), nodes.end());
+                nodes.insert(nodes.end(), found.begin(), found.end());
+            }
+        }
+
+        bool uevent::parse(const char* buffer, size_t size, uevent& event)
+        {
+            event = {};
+            auto end = buffer + size;
+            udev_header header;
+            if (size >= sizeof(header) && strncmp(buffer, "libudev", sizeof(header.prefix)) == 0)
+            {
+                memcpy(&header, buffer, sizeof(header));
+                if (ntohl(header.magic) != UDEV_MAGIC || header.properties_off > size || header.properties_len > size - header.properties_off)
+                    return false;
+                read_properties(buffer + header.properties_off, buffer + header.properties_off + header.properties_len, event);
+            }
+            else
+            {
+                // The summary line carries nothing the properties after it do not
+                auto length = strnlen(buffer, size);
+                if (std::find(buffer, buffer + length, '@') == buffer + length)
+                    return false;
+                read_properties(buffer + length + 1, end, event);
+            }
+            return !event.action.empty() && !event.devpath.empty();
+        }
+
+        std::string uevent::usb_path() const
+        {
+            // The last USB device on the path, the one behind the hubs before it
+            std::string path;
+            size_t begin = 0;
+            while (begin < devpath.size())
+            {
+                auto end = devpath.find('/', begin + 1);
+                if (end == std::string::npos)
+                    end = devpath.size();
+                if (is_usb_device_name(devpath.substr(begin + 1, end - begin - 1)))
+                    path = "/sys" + devpath.substr(0, end);
+                begin = end;
+            }
+            return path;
+        }
+
+        uevent_device_watcher::uevent_device_watcher(std::shared_ptr<device_scanner> scanner, int socket,
+            std::chrono::milliseconds settle)
+            : _scanner(std::move(scanner)), _socket(socket), _stop_pipe_fd{ -1, -1 }, _settle(settle),
+              _pending_usb_devices(false), _pending_all(false)
+        {
+            if (pipe(_stop_pipe_fd) < 0)
+            {
+                ::close(_socket);
+                throw linux_backend_exception("uevent watcher: cannot create pipe!");
+            }
+
+            _devices_data = { _scanner->query_uvc_devices(""),
+                              _scanner->query_usb_devices(),
+                              _scanner->query_hid_devices("") };
+        }
+
+        uevent_device_watcher::~uevent_device_watcher()
+        {
+            stop();
+            ::close(_stop_pipe_fd[0]);
+            ::close(_stop_pipe_fd[1]);
+            ::close(_socket);
+        }
+
+        int uevent_device_watcher::open_netlink_socket()
+        {
+            auto fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
+            if (fd < 0)
+                return -1;
+
+            // The uevents of udevd are those that come once the device nodes have their permissions
+            sockaddr_nl address = {};
+            address.nl_family = AF_NETLINK;
+            address.nl_groups = KERNEL_UEVENTS | UDEV_UEVENTS;
+            if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+            {
+                ::close(fd);
+                return -1;
+            }
+
+            // A hub coming up takes a few hundred events
+            int buffer_size = 1 << 20;
+            setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+
+            // The credentials of the sender come with each datagram, to tell udevd from other processes
+            int pass_credentials = 1;
+            setsockopt(fd, SOL_SOCKET, SO_PASSCRED, &pass_credentials, sizeof(pass_credentials));
+            return fd;
+        }
+
+        void uevent_device_watcher::start(device_changed_callback callback)
+        {
+            stop();
+            _callback = std::move(callback);
+            _thread = std::thread([this]() { run(); });
+        }
+
+        void uevent_device_watcher::stop()
+        {
+            if (!_thread.joinable())
+                return;
+
+            char buff[1] = {};
+            if (write(_stop_pipe_fd[1], buff, 1) < 0)
+                LOG_ERROR("uevent watcher: cannot signal stop, errno " << errno);
+            _thread.join();
+            if (read(_stop_pipe_fd[0], buff, 1) < 0)
+                LOG_ERROR("uevent watcher: cannot drain stop pipe, errno " << errno);
+        }
+
+        void uevent_device_watcher::run()
+        {
+            while (true)
+            {
+                auto pending = _pending_all || _pending_usb_devices || !_pending_paths.empty();
+                auto timeout = -1;
+                if (pending)
+                {
+                    auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - _pending_since);
+                    timeout = static_cast<int>(std::max<long long>(0, std::min(_settle.count(), (_settle * MAX_SETTLE_DELAYS - waited).count())));
+                }
+
+                pollfd fds[2] = { { _socket, POLLIN, 0 }, { _stop_pipe_fd[0], POLLIN, 0 } };
+                auto ready = poll(fds, 2, timeout);
+                if (ready < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    LOG_ERROR("uevent watcher: poll failed, errno " << errno);
+                    return;
+                }
+
+                if (fds[1].revents)
+                    return;
+
+                if (fds[0].revents & (POLLHUP | POLLNVAL))
+                {
+                    LOG_ERROR("uevent watcher: the uevent socket closed");
+                    return;
+                }
+                if (fds[0].revents & POLLERR)
+                {
+                    // As ENOBUFS once the kernel overran the socket. Reading the error clears it
+                    int error = 0;
+                    socklen_t length = sizeof(error);
+                    getsockopt(_socket, SOL_SOCKET, SO_ERROR, &error, &length);
+                    LOG_WARNING("uevent watcher: socket error " << error << ", uevents may be lost, enumerating all devices");
+                    lost_uevents();
+                }
+                if (fds[0].revents & POLLIN)
+                    receive();
+
+                // Quiet for the settle time, or kept busy for too long
+                if (ready == 0 || (pending && timeout == 0))
+                    update();
+            }
+        }
+
+        void uevent_device_watcher::receive()
+        {
+            char buffer[8192];
+            char control[CMSG_SPACE(sizeof(ucred))];
+            while (true)
+            {
+                sockaddr_storage sender = {};
+                iovec data = { buffer, sizeof(buffer) };
+                msghdr message = {};
+                message.msg_name = &sender;
+                message.msg_namelen = sizeof(sender);
+                message.msg_iov = &data;
+                message.msg_iovlen = 1;
+                message.msg_control = control;
+                message.msg_controllen = sizeof(control);
+
+                auto size = recvmsg(_socket, &message, MSG_DONTWAIT);
+                if (size < 0)
+                {
+                    if (errno == ENOBUFS)
+                    {
+                        LOG_WARNING("uevent watcher: uevents were lost, enumerating all devices");
+                        lost_uevents();
+                        continue;
+                    }
+                    if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                        LOG_ERROR("uevent watcher: recv failed, errno " << errno);
+                    return;
+                }
+
+                if (!from_trusted_sender(message))
+                {
+                    LOG_DEBUG("uevent watcher: dropped a uevent sent by neither the kernel nor udevd");
+                    continue;
+                }
+
+                uevent event;
+                if (uevent::parse(buffer, static_cast<size_t>(size), event))
+                    on_uevent(event);
+            }
+        }
+
+        bool uevent_device_watcher::from_trusted_sender(const msghdr& message)
+        {
+            // Any process may send to a netlink socket; other sockets, as the socket pairs of tests, are the process's own
+            auto sender = static_cast<const sockaddr_nl*>(message.msg_name);
+            if (message.msg_namelen < sizeof(sockaddr_nl) || sender->nl_family != AF_NETLINK)
+                return true;
+            if (sender->nl_pid == 0)
+                return true;
+
+            // udevd runs as root
+            for (auto header = CMSG_FIRSTHDR(&message); header; header = CMSG_NXTHDR(const_cast<msghdr*>(&message), header))
+            {
+                if (header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_CREDENTIALS)
+                {
+                    ucred credentials;
+                    memcpy(&credentials, CMSG_DATA(header), sizeof(credentials));
+                    return credentials.uid == 0;
+                }
+            }
+            return false;
+        }
+
+        void uevent_device_watcher::lost_uevents()
+        {
+            // Nothing short of a full enumeration tells what changed meanwhile
+            if (!_pending_all && !_pending_usb_devices && _pending_paths.empty())
+                _pending_since = std::chrono::steady_clock::now();
+            _pending_all = true;
+        }
+
+        void uevent_device_watcher::on_uevent(const uevent& event)
+        {
+            if (event.action != "add" && event.action != "remove")
+                return;
+
+            auto usb_device = event.subsystem == "usb" && event.devtype == "usb_device";
+            auto path = event.usb_path();
+            if (!usb_device && path.empty())
+                return;
+
+            if (!_pending_all && !_pending_usb_devices && _pending_paths.empty())
+                _pending_since = std::chrono::steady_clock::now();
+            if (usb_device)
+                _pending_usb_devices = true;
+            if (!path.empty())
+                _pending_paths.insert(path);
+        }
+
+        void uevent_device_watcher::update()
+        {
+            auto curr = _devices_data;
+            auto scanned = false;
+            try
+            {
+                if (_pending_all)
+                {
+                    curr = { _scanner->query_uvc_devices(""), _scanner->query_usb_devices(), _scanner->query_hid_devices("") };
+                }
+                else
+                {
+                    // A hub scanned again takes the devices behind it along
+                    std::vector<std::string> paths;
+                    for (auto&& path : _pending_paths)
+                    {
+                        if (std::none_of(paths.begin(), paths.end(), [&](const std::string& p) { return is_under(path, p); }))
+                            paths.push_back(path);
+                    }
+
+                    for (auto&& path : paths)
+                    {
+                        replace_under(curr.uvc_devices, path, _scanner->query_uvc_devices(path));
+                        replace_under(curr.hid_devices, path, _scanner->query_hid_devices(path));
+                    }
+                    if (_pending_usb_devices)
+                        curr.usb_devices = _scanner->query_usb_devices();
+                }
+                scanned = true;
+            }
+            catch (const std::exception& e)
+            {
+                LOG_ERROR("uevent watcher: scanning devices failed: " << e.what());
+            }
+            _pending_paths.clear();
+            _pending_usb_devices = false;
+            _pending_all = false;
+
+            if (scanned && (list_changed(_devices_data.uvc_devices, curr.uvc_devices) ||
+                list_changed(_devices_data.usb_devices, curr.usb_devices) ||
+                list_changed(_devices_data.hid_devices, curr.hid_devices)))
+            {
+                auto prev = _devices_data;
+                _devices_data = curr;
+                _callback(prev, curr);
+            }
+        }
+    }
+}
@@ -0,0 +1,104 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#pragma once
+
+#include "../backend.h"
+#include "../types.h"
+
+#include <chrono>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+
+namespace librealsense
+{
+    namespace platform
+    {
+        // A device uevent, as the kernel multicasts it ("ACTION@DEVPATH" followed by KEY=VALUE strings, each
+        // ending in '\0') or as udevd passes it on once its rules ran (a "libudev" header followed by the same
+        // KEY=VALUE strings)
+        struct uevent
+        {
+            std::string action;
+            std::string devpath;        // under /sys
+            std::string subsystem;
+            std::string devtype;
+
+            static bool parse(const char* buffer, size_t size, uevent& event);
+
+            // The sysfs path of the USB device the event is of or under, as /sys/devices/.../usb2/2-1/2-1.4,
+            // empty for a device off the USB buses
+            std::string usb_path() const;
+        };
+
+        // Where the watcher looks up the devices of a USB device once a uevent touched it
+        class device_scanner
+        {
+        public:
+            // The nodes whose sysfs path is under usb_path, or every node for an empty one
+            virtual std::vector<uvc_device_info> query_uvc_devices(const std::string& usb_path) const = 0;
+            virtual std::vector<hid_device_info> query_hid_devices(const std::string& usb_path) const = 0;
+            virtual std::vector<usb_device_info> query_usb_devices() const = 0;
+
+            virtual ~device_scanner() = default;
+        };
+
+        // Keeps the backend device group in step with the uevents read off a socket, rather than re-enumerating
+        // it all every few seconds. A burst of events, as a camera coming up makes, is taken in until the
+        // socket has been quiet for the settle time; then only the USB devices the events were under are
+        // scanned again, and the callback is given the group before and after them. The USB device list,
+        // which libusb enumerates in one go, is only queried again once a USB device came or went.
+        // The socket is any the uevents can be read from one datagram each: a netlink socket in the kernel
+        // and udev uevent groups by default, or one end of a socket pair tests write uevents to
+        class uevent_device_watcher : public device_watcher
+        {
+        public:
+            // Takes the socket over. The device group is enumerated in full up front
+            uevent_device_watcher(std::shared_ptr<device_scanner> scanner, int socket,
+                std::chrono::milliseconds settle = std::chrono::milliseconds(100));
+            ~uevent_device_watcher();
+
+            void start(device_changed_callback callback) override;
+            void stop() override;
+
+            // A NETLINK_KOBJECT_UEVENT socket bound to the uevents of the kernel and of udevd, or -1
+            static int open_netlink_socket();
+
+        private:
+            void run();
+
+            // Reads the datagrams waiting on the socket into the pending changes
+            void receive();
+            void on_uevent(const uevent& event);
+
+            // Whether a netlink datagram came from the kernel or from a root process, as udevd, rather than
+            // from any process that sent to the socket
+            static bool from_trusted_sender(const msghdr& message);
+
+            // Once the socket dropped uevents, the next update enumerates all devices
+            void lost_uevents();
+
+            // Scans the USB devices the pending events were under and reports the group if it changed
+            void update();
+
+            std::shared_ptr<device_scanner> _scanner;
+            int _socket;
+            int _stop_pipe_fd[2];
+            std::chrono::milliseconds _settle;
+            std::thread _thread;
+
+            std::set<std::string> _pending_paths;
+            bool _pending_usb_devices;
+            bool _pending_all;
+            std::chrono::steady_clock::time_point _pending_since;
+
+            backend_device_group _devices_data;
+            device_changed_callback _callback;
+        };
+    }
+}
@@ -0,0 +1,302 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "log-ring.h"
+
+#include <chrono>
+#include <cstddef>
+
+namespace librealsense
+{
+    std::atomic<int> log_threshold(RS2_LOG_SEVERITY_NONE);
+
+    namespace
+    {
+        template<class T>
+        const uint8_t* replay(std::ostream& out, const uint8_t* value)
+        {
+            T v;
+            memcpy(&v, value, sizeof(T));
+            out << v;
+            return value + sizeof(T);
+        }
+    }
+
+    void log_entry::format(std::ostream& out) const
+    {
+        if (text)
+        {
+            out << *text;
+            return;
+        }
+
+        auto p = payload, end = payload + size;
+        while (p < end)
+        {
+            switch (static_cast<arg_type>(*p++))
+            {
+            case boolean: p = replay<bool>(out, p); break;
+            case character: p = replay<char>(out, p); break;
+            case signed_character: p = replay<signed char>(out, p); break;
+            case unsigned_character: p = replay<unsigned char>(out, p); break;
+            case short_integer: p = replay<short>(out, p); break;
+            case unsigned_short_integer: p = replay<unsigned short>(out, p); break;
+            case integer: p = replay<int>(out, p); break;
+            case unsigned_integer: p = replay<unsigned int>(out, p); break;
+            case long_integer: p = replay<long>(out, p); break;
+            case unsigned_long_integer: p = replay<unsigned long>(out, p); break;
+            case long_long_integer: p = replay<long long>(out, p); break;
+            case unsigned_long_long_integer: p = replay<unsigned long long>(out, p); break;
+            case single_real: p = replay<float>(out, p); break;
+            case double_real: p = replay<double>(out, p); break;
+            case pointer: p = replay<const void*>(out, p); break;
+            case stream_manipulator: p = replay<std::ostream& (*)(std::ostream&)>(out, p); break;
+            case base_manipulator: p = replay<std::ios_base& (*)(std::ios_base&)>(out, p); break;
+            case character_string:
+            {
+                // No field width can be set without std::setw, which is formatted by the logging thread,
+                // so writing the characters is as good as streaming them
+                uint16_t length;
+                memcpy(&length, p, sizeof(length));
+                p += sizeof(length);
+                out.write(reinterpret_cast<const char*>(p), length);
+                p += length;
+                break;
+            }
+            default:
+                return;
+            }
+        }
+    }
+
+    log_record::log_record(rs2_log_severity severity, const char* file, int line, const char* function)
+    {
+        _entry.severity = severity;
+        _entry.file = file;
+        _entry.line = line;
+        _entry.function = function;
+        _entry.thread = std::this_thread::get_id();
+        _entry.text = nullptr;
+        _entry.size = 0;
+    }
+
+    log_record::~log_record()
+    {
+        try
+        {
+            if (_text)
+            {
+                auto message = _text->str();
+                _entry.size = 0;
+                _text.reset();
+                if (!put_string(message.data(), message.size()))
+                    _entry.text = new std::string(std::move(message));
+            }
+            log_commit(_entry);
+        }
+        catch (...)
+        {
+        }
+        delete _entry.text;
+    }
+
+    log_record& log_record::operator<<(const char* value)
+    {
+        if (!value || !put_string(value, strlen(value)))
+            text() << value;
+        return *this;
+    }
+
+    log_record& log_record::operator<<(const std::string& value)
+    {
+        if (!put_string(value.data(), value.size()))
+            text() << value;
+        return *this;
+    }
+
+    bool log_record::put_string(const char* value, size_t length)
+    {
+        if (_text || _entry.size + 1 + sizeof(uint16_t) + length > log_entry::PAYLOAD_SIZE)
+            return false;
+
+        auto p = _entry.payload + _entry.size;
+        auto l = static_cast<uint16_t>(length);
+        *p++ = log_entry::character_string;
+        memcpy(p, &l, sizeof(l));
+        memcpy(p + sizeof(l), value, length);
+        _entry.size += 1 + sizeof(l) + length;
+        return true;
+    }
+
+    std::ostream& log_record::text()
+    {
+        if (!_text)
+        {
+            _text.reset(new std::ostringstream());
+            _entry.format(*_text);
+        }
+        return *_text;
+    }
+
+    log_ring::log_ring(dispatcher dispatch, size_t capacity)
+        : _dispatch(std::move(dispatch)), _mask(1), _enqueued(0), _dispatched(0),
+          _running(false), _idle(false), _flushing(0), _flush_target(0), _stopping(false)
+    {
+        while (_mask < capacity)
+            _mask <<= 1;
+        _mask--;
+    }
+
+    log_ring::~log_ring()
+    {
+        stop();
+    }
+
+    void log_ring::start()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_running || _stopping)
+            return;
+
+        // The slots are only taken up once a sink is open
+        _slots.reset(new slot[_mask + 1]);
+        for (size_t i = 0; i <= _mask; i++)
+        {
+            _slots[i].sequence.store(i, std::memory_order_relaxed);
+            _slots[i].entry.text = nullptr;
+        }
+
+        _thread = std::thread([this]() { run(); });
+        _thread_id = _thread.get_id();
+        _running.store(true, std::memory_order_release);
+    }
+
+    void log_ring::stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_running)
+                return;
+            _running.store(false, std::memory_order_release);
+            _stopping = true;
+            _wake.notify_one();
+        }
+        _thread.join();
+    }
+
+    void log_ring::push(log_entry& entry)
+    {
+        if (!is_running() || std::this_thread::get_id() == _thread_id)
+        {
+            std::ostringstream stream;
+            dispatch(entry, stream);
+            return;
+        }
+
+        auto position = _enqueued.load(std::memory_order_relaxed);
+        slot* s;
+        while (true)
+        {
+            s = &_slots[position & _mask];
+            auto difference = static_cast<std::ptrdiff_t>(s->sequence.load(std::memory_order_acquire) - position);
+            if (difference == 0)
+            {
+                if (_enqueued.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else
+            {
+                // A slot still holding the message of the previous lap means the ring is full
+                if (difference < 0)
+                    std::this_thread::yield();
+                position = _enqueued.load(std::memory_order_relaxed);
+            }
+        }
+
+        s->entry = entry;
+        entry.text = nullptr;
+        s->sequence.store(position + 1, std::memory_order_release);
+
+        // Pairs with the fence of run() going idle: either this sees it idle or it sees the message. Only the
+        // first to see it idle wakes it
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_idle.load(std::memory_order_relaxed) && _idle.exchange(false))
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _wake.notify_one();
+        }
+    }
+
+    void log_ring::flush()
+    {
+        if (!is_running() || std::this_thread::get_id() == _thread_id)
+            return;
+
+        auto target = _enqueued.load(std::memory_order_acquire);
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (target > _flush_target)
+            _flush_target = target;
+        ++_flushing;
+        _wake.notify_one();
+        _flushed.wait(lock, [&]() { return _dispatched.load() >= target; });
+        --_flushing;
+    }
+
+    void log_ring::dispatch(const log_entry& entry, std::ostringstream& stream) const
+    {
+        // The formatting state a new stream starts with
+        stream.str(std::string());
+        stream.clear();
+        stream.flags(std::ios_base::skipws | std::ios_base::dec);
+        stream.precision(6);
+        stream.width(0);
+        stream.fill(' ');
+
+        entry.format(stream);
+        _dispatch(entry, stream.str());
+    }
+
+    void log_ring::run()
+    {
+        std::ostringstream stream;
+        size_t position = 0;
+        while (true)
+        {
+            auto& s = _slots[position & _mask];
+            if (s.sequence.load(std::memory_order_acquire) == position + 1)
+            {
+                try
+                {
+                    dispatch(s.entry, stream);
+                }
+                catch (...)
+                {
+                }
+                delete s.entry.text;
+                s.entry.text = nullptr;
+                s.sequence.store(position + _mask + 1, std::memory_order_release);
+
+                // Flushes are woken once the last of them has its messages out, not on every message
+                _dispatched.store(++position);
+                if (_flushing.load() && position >= _flush_target.load())
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _flushed.notify_all();
+                }
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(_mutex);
+            _idle.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (s.sequence.load(std::memory_order_acquire) != position + 1)
+            {
+                // Once stopped, only the messages of slots already claimed are waited for
+                if (_stopping && _enqueued.load() == position)
+                    break;
+                _wake.wait_for(lock, std::chrono::milliseconds(100));
+            }
+            _idle.store(false, std::memory_order_relaxed);
+        }
+    }
+}
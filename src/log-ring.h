@@ -0,0 +1,194 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+// The LOG_* messages, taken down in binary by the threads logging them and formatted on a thread of their own
+
+#pragma once
+
+#include "../include/librealsense2/h/rs_types.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+namespace librealsense
+{
+    // The least severe messages any sink is open to, RS2_LOG_SEVERITY_NONE while none is.
+    // The LOG_* macros check it before anything of the message is evaluated
+    extern std::atomic<int> log_threshold;
+
+    inline bool log_enabled(rs2_log_severity severity)
+    {
+        return severity >= log_threshold.load(std::memory_order_relaxed);
+    }
+
+    // A message on its way through the log ring: where it was logged from, and the values streamed into it,
+    // each tagged by its type, to be replayed into a stream in the order they came. A message that streams a
+    // type with no binary form here, or does not fit the payload, is formatted by the thread logging it
+    // and travels as text
+    struct log_entry
+    {
+        enum arg_type : uint8_t
+        {
+            boolean, character, signed_character, unsigned_character,
+            short_integer, unsigned_short_integer, integer, unsigned_integer,
+            long_integer, unsigned_long_integer, long_long_integer, unsigned_long_long_integer,
+            single_real, double_real, pointer, character_string,
+            stream_manipulator, base_manipulator
+        };
+
+        static const size_t PAYLOAD_SIZE = 208;
+
+        rs2_log_severity severity;
+        const char* file;
+        int line;
+        const char* function;
+        std::thread::id thread;
+        std::string* text;      // the formatted message when it did not fit the payload, owned by the entry
+        size_t size;            // of the payload in use
+        uint8_t payload[PAYLOAD_SIZE];
+
+        // Replays the values into out, or writes the text
+        void format(std::ostream& out) const;
+    };
+
+    // Built by the LOG_* macros, which only get here once the severity passed the threshold, and passed to the
+    // logger as the statement ends. Integers, reals, strings and pointers are copied into the entry, together
+    // with the manipulators of std::ios_base and std::ostream, so formatting them is left to the log ring.
+    // Anything else streamed is formatted here, after replaying what came before it
+    class log_record
+    {
+    public:
+        log_record(rs2_log_severity severity, const char* file, int line, const char* function);
+        ~log_record();
+
+        log_record(const log_record&) = delete;
+        log_record& operator=(const log_record&) = delete;
+
+        log_record& operator<<(bool value) { return put(log_entry::boolean, value); }
+        log_record& operator<<(char value) { return put(log_entry::character, value); }
+        log_record& operator<<(signed char value) { return put(log_entry::signed_character, value); }
+        log_record& operator<<(unsigned char value) { return put(log_entry::unsigned_character, value); }
+        log_record& operator<<(short value) { return put(log_entry::short_integer, value); }
+        log_record& operator<<(unsigned short value) { return put(log_entry::unsigned_short_integer, value); }
+        log_record& operator<<(int value) { return put(log_entry::integer, value); }
+        log_record& operator<<(unsigned int value) { return put(log_entry::unsigned_integer, value); }
+        log_record& operator<<(long value) { return put(log_entry::long_integer, value); }
+        log_record& operator<<(unsigned long value) { return put(log_entry::unsigned_long_integer, value); }
+        log_record& operator<<(long long value) { return put(log_entry::long_long_integer, value); }
+        log_record& operator<<(unsigned long long value) { return put(log_entry::unsigned_long_long_integer, value); }
+        log_record& operator<<(float value) { return put(log_entry::single_real, value); }
+        log_record& operator<<(double value) { return put(log_entry::double_real, value); }
+        log_record& operator<<(const char* value);
+        log_record& operator<<(char* value) { return *this << static_cast<const char*>(value); }
+        log_record& operator<<(const std::string& value);
+        log_record& operator<<(std::ostream& (*manipulator)(std::ostream&)) { return put(log_entry::stream_manipulator, manipulator); }
+        log_record& operator<<(std::ios_base& (*manipulator)(std::ios_base&)) { return put(log_entry::base_manipulator, manipulator); }
+
+        // Printed as addresses, unlike the character strings, function and volatile pointers an ostream takes
+        template<class T, typename std::enable_if<!std::is_function<T>::value && !std::is_volatile<T>::value &&
+            !std::is_same<typename std::remove_cv<T>::type, char>::value &&
+            !std::is_same<typename std::remove_cv<T>::type, signed char>::value &&
+            !std::is_same<typename std::remove_cv<T>::type, unsigned char>::value, int>::type = 0>
+        log_record& operator<<(T* value)
+        {
+            return put(log_entry::pointer, static_cast<const void*>(value));
+        }
+
+        template<class T>
+        log_record& operator<<(const T& value)
+        {
+            text() << value;
+            return *this;
+        }
+
+    private:
+        template<class T>
+        log_record& put(log_entry::arg_type type, T value)
+        {
+            if (!_text && _entry.size + 1 + sizeof(T) <= log_entry::PAYLOAD_SIZE)
+            {
+                _entry.payload[_entry.size] = type;
+                memcpy(_entry.payload + _entry.size + 1, &value, sizeof(T));
+                _entry.size += 1 + sizeof(T);
+            }
+            else
+                text() << value;
+            return *this;
+        }
+
+        bool put_string(const char* value, size_t length);
+
+        // Formats the message from here on, starting with the values taken down so far
+        std::ostream& text();
+
+        log_entry _entry;
+        std::unique_ptr<std::ostringstream> _text;
+    };
+
+    // Hands a finished record to the logger: to its log ring, or straight to its sinks for FATAL messages.
+    // Takes the text of the entry
+    void log_commit(log_entry& entry);
+
+    // Messages on their way from the threads logging them to one thread that formats and dispatches them to
+    // the sinks. Any thread may push without taking a lock: a slot is claimed by advancing the enqueue
+    // counter and published by its sequence number (a bounded queue after Vyukov, with a single consumer).
+    // A full ring makes the logging thread wait for a slot rather than lose a message. Until start, and on
+    // the ring's own thread, which logs from within the sinks, messages are dispatched on the spot
+    class log_ring
+    {
+    public:
+        typedef std::function<void(const log_entry&, const std::string&)> dispatcher;
+
+        // capacity, in messages, is rounded up to a power of 2
+        log_ring(dispatcher dispatch, size_t capacity = 1024);
+        ~log_ring();
+
+        void start();
+        bool is_running() const { return _running.load(std::memory_order_acquire); }
+
+        void push(log_entry& entry);
+
+        // Returns once every message pushed before it has been dispatched
+        void flush();
+
+        // Formats the entry and dispatches it on the calling thread
+        void dispatch(const log_entry& entry, std::ostringstream& stream) const;
+
+    private:
+        struct slot
+        {
+            std::atomic<size_t> sequence;
+            log_entry entry;
+        };
+
+        void run();
+        void stop();
+
+        dispatcher _dispatch;
+        std::unique_ptr<slot[]> _slots;
+        size_t _mask;
+
+        std::atomic<size_t> _enqueued;
+        std::atomic<size_t> _dispatched;
+        std::atomic<bool> _running;
+        std::atomic<bool> _idle;
+        std::atomic<int> _flushing;
+        std::atomic<size_t> _flush_target;
+        bool _stopping;
+
+        std::mutex _mutex;
+        std::condition_variable _wake;
+        std::condition_variable _flushed;
+        std::thread _thread;
+        std::thread::id _thread_id;
+    };
+}
@@ -29,6 +29,21 @@ void librealsense::log_to_callback( rs2_log_severity min_severity, log_callback_
     logger.log_to_callback( min_severity, callback );
 }
 
+void librealsense::reset_logger()
+{
+    logger.reset();
+}
+
+void librealsense::flush_log()
+{
+    logger.flush();
+}
+
+void librealsense::log_commit( log_entry& entry )
+{
+    logger.commit( entry );
+}
+
 #else // BUILD_EASYLOGGINGPP
 
 void librealsense::log_to_console(rs2_log_severity min_severity)
@@ -39,5 +54,13 @@ void librealsense::log_to_file(rs2_log_severity min_severity, const char * file_
 {
 }
 
+void librealsense::reset_logger()
+{
+}
+
+void librealsense::flush_log()
+{
+}
+
 #endif // BUILD_EASYLOGGINGPP
 
@@ -26,10 +26,14 @@ namespace librealsense
         std::mutex log_mutex;
         std::ofstream log_file;
         std::vector< std::string > callback_dispatchers;
+        std::vector< rs2_log_severity > callback_severities;
 
         std::string filename;
         const std::string log_id = NAME;
 
+        // Last, so it stops, dispatching what is left to the sinks, before anything else goes
+        log_ring ring{ [this]( log_entry const& entry, std::string const& message ) { dispatch( entry, message ); } };
+
     public:
         static el::Level severity_to_level(rs2_log_severity severity)
         {
@@ -62,8 +66,11 @@ namespace librealsense
             }
         }
 
-        void open() const
+        void open()
         {
+            // Messages logged before go by the sinks they were logged to
+            ring.flush();
+
             el::Configurations defaultConf;
             defaultConf.setToDefault();
             // To set GLOBAL configurations you may use
@@ -89,6 +96,7 @@ namespace librealsense
             }
 
             el::Loggers::reconfigureLogger(log_id, defaultConf);
+            update_threshold();
         }
 
         void open_def() const
@@ -104,6 +112,65 @@ namespace librealsense
         }
 
 
+        // The LOG_* macros only evaluate messages some sink takes, and once one does, the log ring starts.
+        // With no sink open, every message goes to easylogging on the spot, as it always did, for the
+        // dispatch callbacks installed there
+        void update_threshold()
+        {
+            auto threshold = std::min( minimum_console_severity, minimum_file_severity );
+            for( auto severity : callback_severities )
+                threshold = std::min( threshold, severity );
+
+            if( threshold < RS2_LOG_SEVERITY_NONE )
+                ring.start();
+            else
+                threshold = RS2_LOG_SEVERITY_DEBUG;
+            log_threshold.store( threshold );
+        }
+
+        // On the thread of the log ring, the thread that logged the message is the one %thread shows
+        void dispatch( log_entry const& entry, std::string const& message )
+        {
+            static thread_local std::thread::id named_after;
+            if( entry.thread != named_after )
+            {
+                std::ostringstream id;
+                id << entry.thread;
+                el::Helpers::setThreadName( id.str() );
+                named_after = entry.thread;
+            }
+
+            el::base::Writer( severity_to_level( entry.severity ), entry.file, entry.line, entry.function )
+                .construct( 1, NAME ) << message;
+        }
+
+        void commit( log_entry& entry )
+        {
+            // Easylogging aborts on fatal messages, so every message before goes out first
+            if( entry.severity == RS2_LOG_SEVERITY_FATAL )
+            {
+                ring.flush();
+                std::ostringstream stream;
+                ring.dispatch( entry, stream );
+            }
+            else
+                ring.push( entry );
+        }
+
+        void flush()
+        {
+            ring.flush();
+        }
+
+        void reset()
+        {
+            remove_callbacks();
+            minimum_console_severity = RS2_LOG_SEVERITY_NONE;
+            minimum_file_severity = RS2_LOG_SEVERITY_NONE;
+            open_def();
+            update_threshold();
+        }
+
         logger_type()
             : filename(to_string() << datetime_string() << ".log")
         {
@@ -115,9 +182,15 @@ namespace librealsense
             else
             {
                 open_def();
+                update_threshold();
             }
         }
 
+        ~logger_type()
+        {
+            log_threshold.store( RS2_LOG_SEVERITY_NONE );
+        }
+
         static bool try_get_log_severity(rs2_log_severity& severity)
         {
             static const char* severity_var_name = "LRS_LOG_LEVEL";
@@ -187,9 +260,12 @@ namespace librealsense
     public:
         void remove_callbacks()
         {
+            ring.flush();
             for( auto const& dispatch : callback_dispatchers )
                 el::Helpers::uninstallLogDispatchCallback< elpp_dispatcher >( dispatch );
             callback_dispatchers.clear();
+            callback_severities.clear();
+            update_threshold();
         }
 
         void log_to_callback( rs2_log_severity min_severity, log_callback_ptr callback )
@@ -212,6 +288,8 @@ namespace librealsense
                 auto dispatcher = el::Helpers::logDispatchCallback< elpp_dispatcher >( dispatch_name );
                 dispatcher->callback = callback;
                 dispatcher->min_severity = min_severity;
+                callback_severities.push_back( min_severity );
+                update_threshold();
                 
                 // Remove the default logger (which will log to standard out/err) or it'll still be active
                 //el::Helpers::uninstallLogDispatchCallback< el::base::DefaultLogDispatchCallback >( "DefaultLogDispatchCallback" );
@@ -0,0 +1,210 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include <algorithm>
+#include "playback_batch.h"
+#include "playback_device.h"
+#include "media/ros/ros_reader.h"
+#include "thread-pool.h"
+
+using namespace librealsense;
+
+playback_batch::playback_batch(std::shared_ptr<context> ctx, std::vector<std::string> files, int max_concurrent_files) :
+    _ctx(ctx),
+    _max_concurrent_files(max_concurrent_files),
+    _started(false),
+    _stopping(false),
+    _next_file(0),
+    _in_flight(0),
+    _files_done(0),
+    _files_failed(0),
+    _frames(0)
+{
+    if (files.empty())
+        throw invalid_value_exception("Batch playback needs at least one file");
+    if (max_concurrent_files < 0)
+        throw invalid_value_exception(to_string() << "Invalid number of concurrent files: " << max_concurrent_files);
+
+    if (_max_concurrent_files == 0)
+        _max_concurrent_files = std::max(1u, thread_pool::get_default().get_threads());
+
+    for (auto&& file : files)
+    {
+        _files.emplace_back(new file_state());
+        _files.back()->path = file;
+    }
+}
+
+playback_batch::~playback_batch()
+{
+    try
+    {
+        stop();
+    }
+    catch (...)
+    {
+        LOG_ERROR("Error while stopping batch playback");
+    }
+}
+
+void playback_batch::start(frame_callback callback)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (_started)
+        throw wrong_api_call_sequence_exception("Batch playback was already started");
+
+    _callback = callback;
+    _started = true;
+    _start_time = _end_time = std::chrono::steady_clock::now();
+    start_next_files(lock);
+}
+
+bool playback_batch::wait(std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (!_started)
+        throw wrong_api_call_sequence_exception("Batch playback was not started");
+
+    thread_pool::blocking_scope blocking;
+    return _cv.wait_for(lock, timeout, [this]() {
+        return _in_flight == 0 && (_stopping || _next_file == static_cast<int>(_files.size()));
+    });
+}
+
+void playback_batch::stop()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _stopping = true;
+
+    thread_pool::blocking_scope blocking;
+    _cv.wait(lock, [this]() { return _in_flight == 0; });
+}
+
+playback_batch::progress playback_batch::get_progress() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    progress p;
+    p.files_done = _files_done;
+    p.files_failed = _files_failed;
+    p.frames = _frames;
+
+    bool finished = _in_flight == 0 && (_stopping || _next_file == static_cast<int>(_files.size()));
+    auto end = finished ? _end_time : std::chrono::steady_clock::now();
+    auto elapsed = std::chrono::duration<double>(end - _start_time).count();
+    p.frames_per_second = _started && elapsed > 0 ? p.frames / elapsed : 0;
+    return p;
+}
+
+playback_batch::file_progress playback_batch::get_file_progress(int file) const
+{
+    if (file < 0 || file >= static_cast<int>(_files.size()))
+        throw invalid_value_exception(to_string() << "Invalid file index: " << file);
+
+    auto& state = *_files[file];
+    file_progress p;
+    p.position = state.position;
+    p.duration = state.duration;
+    p.frames = state.frames;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    p.done = state.status == file_status::done || state.status == file_status::failed;
+    return p;
+}
+
+const char* playback_batch::get_file_error(int file) const
+{
+    if (file < 0 || file >= static_cast<int>(_files.size()))
+        throw invalid_value_exception(to_string() << "Invalid file index: " << file);
+
+    // The error is set before the file is failed and never after, so it outlives any reader
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto& state = *_files[file];
+    return state.status == file_status::failed ? state.error.c_str() : "";
+}
+
+void playback_batch::start_next_files(std::unique_lock<std::mutex>& lock)
+{
+    while (!_stopping && _in_flight < _max_concurrent_files && _next_file < static_cast<int>(_files.size()))
+    {
+        int file = _next_file++;
+        _files[file]->status = file_status::reading;
+        _in_flight++;
+        thread_pool::get_default().submit([this, file]() { read_slice(file); });
+    }
+
+    if (_in_flight == 0)
+    {
+        _end_time = std::chrono::steady_clock::now();
+        _cv.notify_all();
+    }
+}
+
+void playback_batch::read_slice(int file)
+{
+    auto& state = *_files[file];
+    bool stopping;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        stopping = _stopping;
+    }
+    if (stopping)
+    {
+        finish_file(file, file_status::failed, "Batch playback was stopped before the end of the file");
+        return;
+    }
+
+    bool more;
+    try
+    {
+        if (!state.device)
+        {
+            state.device = std::make_shared<playback_device>(_ctx, std::make_shared<ros_reader>(state.path, _ctx));
+            state.duration = state.device->get_duration();
+            state.device->start_batch();
+        }
+
+        more = state.device->read_batch(SLICE_ITEMS, [&](frame_holder frame) {
+            state.frames++;
+            _frames++;
+            _callback(std::move(frame), file);
+        });
+        state.position = state.device->get_position();
+    }
+    catch (const std::exception& e)
+    {
+        LOG_ERROR("Batch playback of " << state.path << " failed: " << e.what());
+        finish_file(file, file_status::failed, e.what());
+        return;
+    }
+    catch (...)
+    {
+        finish_file(file, file_status::failed, "Unknown error");
+        return;
+    }
+
+    if (!more)
+    {
+        state.position = state.duration.load();
+        finish_file(file, file_status::done, "");
+        return;
+    }
+
+    thread_pool::get_default().submit([this, file]() { read_slice(file); });
+}
+
+void playback_batch::finish_file(int file, file_status status, const std::string& error)
+{
+    auto& state = *_files[file];
+    state.device.reset();
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    state.status = status;
+    _files_done++;
+    if (status == file_status::failed)
+    {
+        state.error = error;
+        _files_failed++;
+    }
+    _in_flight--;
+    start_next_files(lock);
+}
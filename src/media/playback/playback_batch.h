@@ -0,0 +1,106 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "archive.h"
+
+namespace librealsense
+{
+    class context;
+    class playback_device;
+
+    // Plays a list of recorded files for offline processing: every frame of every file is handed
+    // to the callback in file order, as fast as the callback takes them, with up to
+    // max_concurrent_files files read side by side on the shared thread pool.
+    // Each file is read in short slices, one slice of a file in flight at a time, so the frames of
+    // one file reach the callback from one thread at a time and in order, while frames of different
+    // files may arrive concurrently. A file that fails to open or read is reported through
+    // get_file_error() and does not stop the others
+    class playback_batch
+    {
+    public:
+        // Frames read from a file before its slice hands the thread back to the pool
+        static const size_t SLICE_ITEMS = 16;
+
+        typedef std::function<void(frame_holder, int)> frame_callback;
+
+        struct progress
+        {
+            int files_done;     // read to the end or failed
+            int files_failed;
+            unsigned long long frames;
+            double frames_per_second;
+        };
+
+        struct file_progress
+        {
+            uint64_t position;  // nanoseconds into the file
+            uint64_t duration;
+            unsigned long long frames;
+            bool done;
+        };
+
+        // 0 concurrent files selects the number of pool threads
+        playback_batch(std::shared_ptr<context> ctx, std::vector<std::string> files, int max_concurrent_files);
+        ~playback_batch();
+
+        void start(frame_callback callback);
+
+        // Returns false if the files are still being read when the timeout expires
+        bool wait(std::chrono::milliseconds timeout);
+
+        // Waits for the slices in flight to finish; must not be called from the callback
+        void stop();
+
+        progress get_progress() const;
+        file_progress get_file_progress(int file) const;
+        // Empty until the file fails; the message then stays as long as the batch
+        const char* get_file_error(int file) const;
+
+    private:
+        enum class file_status { pending, reading, done, failed };
+
+        struct file_state
+        {
+            std::string path;
+            std::shared_ptr<playback_device> device;
+            file_status status = file_status::pending;
+            std::atomic<uint64_t> position{ 0 };
+            std::atomic<uint64_t> duration{ 0 };
+            std::atomic<unsigned long long> frames{ 0 };
+            std::string error;          // set once, as the file fails
+        };
+
+        playback_batch(const playback_batch&) = delete;
+        playback_batch& operator=(const playback_batch&) = delete;
+
+        void start_next_files(std::unique_lock<std::mutex>& lock);
+        void read_slice(int file);
+        void finish_file(int file, file_status status, const std::string& error);
+
+        std::shared_ptr<context> _ctx;
+        std::vector<std::unique_ptr<file_state>> _files;
+        int _max_concurrent_files;
+        frame_callback _callback;
+
+        mutable std::mutex _mutex;
+        std::condition_variable _cv;
+        bool _started;
+        bool _stopping;
+        int _next_file;
+        int _in_flight;         // files with a slice queued or running
+        int _files_done;
+        int _files_failed;
+        std::atomic<unsigned long long> _frames;
+        std::chrono::steady_clock::time_point _start_time, _end_time;
+    };
+}
@@ -614,6 +614,73 @@ void playback_device::try_looping()
     do_loop(read_action);
 }
 
+void playback_device::start_batch()
+{
+    if (m_is_started)
+        throw wrong_api_call_sequence_exception("Batch reading can not start while the playback device is streaming");
+
+    std::vector<device_serializer::stream_identifier> streams;
+    m_batch_streams.clear();
+    for (auto&& sensor : m_sensors)
+    {
+        for (auto&& profile : sensor.second->get_stream_profiles())
+        {
+            device_serializer::stream_identifier id{ get_device_index(), sensor.first, profile->get_stream_type(), static_cast<uint32_t>(profile->get_stream_index()) };
+            if (m_batch_streams.emplace(id, profile).second)
+                streams.push_back(id);
+        }
+    }
+
+    //The caller holds on to frames for as long as it takes, the reader waits for it rather than skipping frames
+    m_reader->reset();
+    m_reader->set_frame_queue_size(0);
+    m_reader->enable_stream(streams);
+    m_prev_timestamp = device_serializer::nanoseconds(0);
+}
+
+bool playback_device::read_batch(size_t max_items, const std::function<void(frame_holder)>& on_frame)
+{
+    for (size_t i = 0; i < max_items; i++)
+    {
+        std::shared_ptr<serialized_data> data = m_reader->read_next_data();
+        if (data->as<serialized_end_of_file>())
+            return false;
+
+        m_prev_timestamp = data->get_timestamp();
+
+        if (auto frame = data->as<serialized_frame>())
+        {
+            if (data->is<serialized_invalid_frame>())
+            {
+                LOG_WARNING("Bad frame from reader, ignoring");
+                continue;
+            }
+            auto it = m_batch_streams.find(frame->stream_id);
+            if (it == m_batch_streams.end())
+            {
+                std::string error_msg = to_string() << "Unexpected stream while playing file (Read stream = " << frame->stream_id << ")";
+                LOG_ERROR(error_msg);
+                throw invalid_value_exception(error_msg);
+            }
+            auto sensor = m_sensors.at(frame->stream_id.sensor_index);
+            frame->frame->get_owner()->set_sensor(sensor);
+            frame->frame->set_stream(it->second);
+            frame->frame->set_sensor(sensor);
+            frame->frame->set_blocking(true);
+            on_frame(std::move(frame->frame));
+        }
+        else if (auto option_data = data->as<serialized_option>())
+        {
+            m_sensors.at(option_data->sensor_id.sensor_index)->update_option(option_data->option_id, option_data->option);
+        }
+        else if (auto notification_data = data->as<serialized_notification>())
+        {
+            m_sensors.at(notification_data->sensor_id.sensor_index)->raise_notification(notification_data->notif);
+        }
+    }
+    return true;
+}
+
 const std::string& playback_device::get_file_name() const
 {
     return m_reader->get_file_name();
@@ -48,6 +48,14 @@ namespace librealsense
         static bool try_extend_snapshot(std::shared_ptr<extension_snapshot>& e, rs2_extension extension_type, void** ext);
         bool is_valid() const override;
 
+        // Batch reading drives the device from the caller instead of its sensors, as fast as the
+        // caller goes: start_batch() enables every recorded stream from the start of the file, and
+        // each read_batch() reads up to max_items on the calling thread, handing the frames with the
+        // profiles of their recorded streams straight to on_frame. No frame is paced or skipped.
+        // Returns false at the end of the file
+        void start_batch();
+        bool read_batch(size_t max_items, const std::function<void(frame_holder)>& on_frame);
+
         std::vector<tagged_profile> get_profiles_tags() const override { return std::vector<tagged_profile>(); };//no hard-coded default streams for playback
         void tag_profiles(stream_profiles profiles) const override
         {
@@ -92,6 +100,7 @@ namespace librealsense
         std::map<int, std::pair<uint32_t, rs2_extrinsics>> m_extrinsics_map;
         device_serializer::nanoseconds m_last_published_timestamp;
         std::mutex m_last_published_timestamp_mutex;
+        std::map<device_serializer::stream_identifier, std::shared_ptr<stream_profile_interface>> m_batch_streams;
     };
 
     MAP_EXTENSION(RS2_EXTENSION_PLAYBACK, playback_device);
@@ -12,8 +12,19 @@ using namespace librealsense;
 librealsense::record_device::record_device(std::shared_ptr<librealsense::device_interface> device,
                                       std::shared_ptr<librealsense::device_serializer::writer> serializer):
     m_write_thread([](){return std::make_shared<dispatcher>(std::numeric_limits<unsigned int>::max());}),
+    m_record_pause_time(0),
+    m_overflow_policy(RS2_RECORD_OVERFLOW_POLICY_DROP_FRAMES),
+    m_max_cached_data_size(MAX_CACHED_DATA_SIZE),
+    m_closing(false),
+    m_queued_frames(0),
+    m_dropped_frames(0),
+    m_written_frames(0),
+    m_written_bytes(0),
+    m_rate_window_start(std::chrono::steady_clock::now()),
+    m_rate_window_bytes(0),
+    m_bytes_per_second(0),
     m_is_recording(true),
-    m_record_pause_time(0)
+    m_cached_data_size(0)
 {
     if (device == nullptr)
     {
@@ -53,6 +64,13 @@ std::vector<std::shared_ptr<librealsense::record_sensor>> librealsense::record_d
 
 librealsense::record_device::~record_device()
 {
+    {
+        // Release the sensor callbacks waiting for room in the queue
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closing = true;
+    }
+    m_queue_space.notify_all();
+
     for (auto&& s : m_sensors)
     {
         s->on_notification -= m_on_notification_token;
@@ -124,23 +142,48 @@ void librealsense::record_device::write_data(size_t sensor_index, librealsense::
         initialize_recording();
     });
 
-    //TODO: restore: uint64_t data_size = frame.frame->get_frame_data_size();
-    uint64_t cached_data_size = m_cached_data_size; //TODO: restore: (+ data_size)
-    if (cached_data_size > MAX_CACHED_DATA_SIZE)
+    uint64_t data_size = frame ? frame->get_frame_data_size() : 0;
     {
-        LOG_WARNING("Recorder reached maximum cache size, frame dropped");
-        on_error("Recorder reached maximum cache size, frame dropped");
-        return;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        // A frame larger than the whole queue still goes through once the queue is empty
+        auto has_room = [&]() { return m_cached_data_size == 0 || m_cached_data_size + data_size <= m_max_cached_data_size; };
+        if (!has_room())
+        {
+            switch (m_overflow_policy)
+            {
+            case RS2_RECORD_OVERFLOW_POLICY_BLOCK:
+            {
+                // The sensor callback may run on a thread of the shared pool, which may then take on another
+                thread_pool::blocking_scope blocking;
+                m_queue_space.wait(lock, [&]() { return m_closing || has_room(); });
+                if (m_closing)
+                    return;
+                break;
+            }
+            case RS2_RECORD_OVERFLOW_POLICY_DROP_FRAMES:
+                m_dropped_frames++;
+                LOG_DEBUG("Recorder reached maximum cache size, frame dropped");
+                return;
+            default:
+                m_dropped_frames++;
+                lock.unlock();
+                LOG_WARNING("Recorder reached maximum cache size, frame dropped");
+                on_error("Recorder reached maximum cache size, frame dropped");
+                return;
+            }
+        }
+        m_cached_data_size += data_size;
+        m_queued_frames++;
     }
 
-    m_cached_data_size = cached_data_size;
     auto capture_time = get_capture_time();
     //TODO: remove usage of shared pointer when frame_holder is copyable
     auto frame_holder_ptr = std::make_shared<frame_holder>();
     *frame_holder_ptr = std::move(frame);
-    (*m_write_thread)->invoke([this, frame_holder_ptr, sensor_index, capture_time/*, data_size*/, on_error](dispatcher::cancellable_timer t) {
+    (*m_write_thread)->invoke([this, frame_holder_ptr, sensor_index, capture_time, data_size, on_error](dispatcher::cancellable_timer t) {
         if (m_is_recording == false)
         {
+            frame_dequeued(data_size, false);
             return; //Recording is paused
         }
         std::call_once(m_first_frame_flag, [&]()
@@ -162,15 +205,68 @@ void librealsense::record_device::write_data(size_t sensor_index, librealsense::
             auto stream_type = frame_holder_ptr->frame->get_stream()->get_stream_type();
             auto stream_index = static_cast<uint32_t>(frame_holder_ptr->frame->get_stream()->get_stream_index());
             m_ros_writer->write_frame({ device_index, static_cast<uint32_t>(sensor_index), stream_type, stream_index }, capture_time, std::move(*frame_holder_ptr));
-            //TODO: restore: std::lock_guard<std::mutex> locker(m_mutex);  m_cached_data_size -= data_size;
+            frame_dequeued(data_size, true);
         }
         catch(std::exception& e)
         {
+            frame_dequeued(data_size, false);
             on_error(to_string() << "Failed to write frame. " << e.what());
         }
     });
 }
 
+void librealsense::record_device::frame_dequeued(uint64_t data_size, bool written)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cached_data_size -= data_size;
+        m_queued_frames--;
+
+        if (written)
+        {
+            m_written_frames++;
+            m_written_bytes += data_size;
+            m_rate_window_bytes += data_size;
+
+            auto now = std::chrono::steady_clock::now();
+            auto window = std::chrono::duration<double>(now - m_rate_window_start).count();
+            if (window >= 1.0)
+            {
+                m_bytes_per_second = m_rate_window_bytes / window;
+                m_rate_window_start = now;
+                m_rate_window_bytes = 0;
+            }
+        }
+    }
+    m_queue_space.notify_all();
+}
+
+void librealsense::record_device::set_overflow_policy(rs2_record_overflow_policy policy, uint64_t max_queued_bytes)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_overflow_policy = policy;
+        m_max_cached_data_size = max_queued_bytes;
+    }
+    m_queue_space.notify_all();
+}
+
+rs2_record_statistics librealsense::record_device::get_statistics() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    rs2_record_statistics statistics;
+    statistics.queued_frames = m_queued_frames;
+    statistics.queued_bytes = m_cached_data_size;
+    statistics.dropped_frames = m_dropped_frames;
+    statistics.written_frames = m_written_frames;
+    statistics.written_bytes = m_written_bytes;
+
+    // Nothing written for a while reads as a falling rate, not the last full second
+    auto window = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_rate_window_start).count();
+    statistics.bytes_per_second = window >= 2.0 ? m_rate_window_bytes / window : m_bytes_per_second;
+    return statistics;
+}
+
 const std::string& librealsense::record_device::get_info(rs2_camera_info info) const
 {
     return m_device->get_info(info);
@@ -424,7 +520,6 @@ void record_device::initialize_recording()
 {
     //Expected to be called once when recording to file actually starts
     m_capture_time_base = std::chrono::high_resolution_clock::now();
-    m_cached_data_size = 0;
 }
 void record_device::stop_gracefully(to_string error_msg)
 {
@@ -39,6 +39,8 @@ namespace librealsense
         void pause_recording();
         void resume_recording();
         const std::string& get_filename() const;
+        void set_overflow_policy(rs2_record_overflow_policy policy, uint64_t max_queued_bytes);
+        rs2_record_statistics get_statistics() const;
         platform::backend_device_group get_device_data() const override;
         std::pair<uint32_t, rs2_extrinsics> get_extrinsics(const stream_interface& stream) const override;
         bool is_valid() const override;
@@ -55,6 +57,7 @@ namespace librealsense
         void write_header();
         std::chrono::nanoseconds get_capture_time() const;
         void write_data(size_t sensor_index, frame_holder f, std::function<void(std::string const&)> on_error);
+        void frame_dequeued(uint64_t data_size, bool written);
         void write_sensor_extension_snapshot(size_t sensor_index, rs2_extension ext, std::shared_ptr<extension_snapshot> snapshot, std::function<void(std::string const&)> on_error);
         void write_notification(size_t sensor_index, const notification& n);
         std::vector<std::shared_ptr<record_sensor>> create_record_sensors(std::shared_ptr<device_interface> m_device);
@@ -70,7 +73,20 @@ namespace librealsense
         std::chrono::high_resolution_clock::duration m_record_pause_time;
         std::chrono::high_resolution_clock::time_point m_time_of_pause;
 
-        std::mutex m_mutex;
+        // Write queue accounting, guarded by m_mutex
+        mutable std::mutex m_mutex;
+        std::condition_variable m_queue_space;
+        rs2_record_overflow_policy m_overflow_policy;
+        uint64_t m_max_cached_data_size;
+        bool m_closing;
+        int m_queued_frames;
+        uint64_t m_dropped_frames;
+        uint64_t m_written_frames;
+        uint64_t m_written_bytes;
+        std::chrono::steady_clock::time_point m_rate_window_start;
+        uint64_t m_rate_window_bytes;
+        double m_bytes_per_second;
+
         bool m_is_recording;
         std::once_flag m_first_frame_flag;
         int m_on_notification_token;
@@ -1,7 +1,9 @@
 // License: Apache 2.0. See LICENSE file in root directory.
 // Copyright(c) 2019 Intel Corporation. All Rights Reserved.
 
+#include <cstdlib>
 #include <cstring>
+#include <functional>
 #include "ros_reader.h"
 #include "ds5/ds5-device.h"
 #include "ivcam/sr300.h"
@@ -15,6 +17,7 @@
 #include "proc/zero-order.h"
 #include "proc/depth-decompress.h"
 #include "std_msgs/Float32MultiArray.h"
+#include "thread-pool.h"
 
 namespace librealsense
 {
@@ -25,7 +28,8 @@ namespace librealsense
         m_total_duration(0),
         m_file_path(file),
         m_context(ctx),
-        m_version(0)
+        m_version(0),
+        m_frame_queue_size(-1)
     {
         try
         {
@@ -114,33 +118,57 @@ namespace librealsense
     std::vector<std::shared_ptr<serialized_data>> ros_reader::fetch_last_frames(const nanoseconds& seek_time)
     {
         std::vector<std::shared_ptr<serialized_data>> result;
-        rosbag::View view(m_file, FalseQuery());
         auto as_rostime = to_rostime(seek_time);
         auto start_time = to_rostime(get_static_file_info_timestamp());
 
         for (auto topic : m_enabled_streams_topics)
         {
-            view.addQuery(m_file, rosbag::TopicQuery(topic), start_time, as_rostime);
-        }
-        std::map<device_serializer::stream_identifier, rs2rosinternal::Time> last_frames;
-        for (auto&& m : view)
-        {
-            if (m.isType<sensor_msgs::Image>() || m.isType<sensor_msgs::Imu>())
-            {
-                auto id = ros_topic::get_stream_identifier(m.getTopic());
-                last_frames[id] = m.getTime();
-            }
-        }
-        for (auto&& kvp : last_frames)
-        {
-            auto topic = ros_topic::frame_data_topic(kvp.first);
-            rosbag::View view(m_file, rosbag::TopicQuery(topic), kvp.second, kvp.second);
+            auto& times = get_frame_times(topic);
+            auto last = std::upper_bound(times.begin(), times.end(), as_rostime);
+            if (last == times.begin() || *(last - 1) < start_time)
+                continue;
+
+            rosbag::View view(m_file, rosbag::TopicQuery(topic), *(last - 1), *(last - 1));
             auto msg = view.begin();
             auto new_frame = create_frame(*msg);
             result.push_back(new_frame);
         }
         return result;
     }
+
+    const std::vector<rs2rosinternal::Time>& ros_reader::get_frame_times(const std::string& topic)
+    {
+        auto it = m_frame_times.find(topic);
+        if (it != m_frame_times.end())
+            return it->second;
+
+        // The times come from the index of the bag, no message is read. Topics of other
+        // messages than images and motion samples are left empty
+        auto& times = m_frame_times[topic];
+        rosbag::View view(m_file, rosbag::TopicQuery(topic));
+        for (auto&& m : view)
+        {
+            if (!m.isType<sensor_msgs::Image>() && !m.isType<sensor_msgs::Imu>())
+                break;
+            times.push_back(m.getTime());
+        }
+        return times;
+    }
+
+    std::string ros_reader::index_cache_path(const std::string& file)
+    {
+        auto dir = getenv("LRS_PLAYBACK_INDEX_CACHE");
+        if (!dir || !*dir)
+            return "";
+
+        // Named after the bag and its path, so bags of the same name in other folders keep their own
+        std::string path = dir;
+        if (path.back() != '/' && path.back() != '\\')
+            path += '/';
+        auto name = file.substr(file.find_last_of("/\\") + 1);
+        return path + name + "." + std::to_string(std::hash<std::string>()(file)) + ".idx";
+    }
+
     nanoseconds ros_reader::query_duration() const
     {
         return m_total_duration;
@@ -149,10 +177,13 @@ namespace librealsense
     void ros_reader::reset()
     {
         m_file.close();
+        m_file.setIndexCachePath(index_cache_path(m_file_path));
+        m_file.setChunkPrefetch([](std::function<void()> task) { thread_pool::get_default().submit(task); }, PREFETCH_CHUNKS);
         m_file.open(m_file_path, rosbag::BagMode::Read);
+        m_frame_times.clear();
         m_version = read_file_version(m_file);
         m_samples_view = nullptr;
-        m_frame_source = std::make_shared<frame_source>(m_version == 1 ? 128 : 32);
+        m_frame_source = std::make_shared<frame_source>(m_frame_queue_size >= 0 ? static_cast<uint32_t>(m_frame_queue_size) : m_version == 1 ? 128 : 32);
         m_frame_source->init(m_metadata_parser_map);
         m_initial_device_description = read_device_description(get_static_file_info_timestamp(), true);
     }
@@ -241,6 +272,12 @@ namespace librealsense
         return m_file_path;
     }
 
+    void ros_reader::set_frame_queue_size(uint32_t size)
+    {
+        m_frame_queue_size = size;
+        m_frame_source->set_max_publish_list_size(size);
+    }
+
     std::shared_ptr<serialized_frame> ros_reader::create_frame(const rosbag::MessageInstance& msg)
     {
         auto next_msg_topic = msg.getTopic();
@@ -404,7 +441,9 @@ namespace librealsense
     frame_holder ros_reader::create_image_from_message(const rosbag::MessageInstance &image_data) const
     {
         LOG_DEBUG("Trying to create an image frame from message");
-        auto msg = instantiate_msg<sensor_msgs::Image>(image_data);
+        // The image is deserialized straight into a buffer of the frame pool, which the frame then takes over
+        typedef sensor_msgs::Image_<frame_buffer_allocator<void>> pooled_image;
+        auto msg = instantiate_msg<pooled_image>(image_data, frame_buffer_allocator<void>(m_frame_source->get_frame_pool()));
         frame_additional_data additional_data{};
         std::chrono::duration<double, std::milli> timestamp_ms(std::chrono::duration<double>(msg->header.stamp.toSec()));
         additional_data.timestamp = timestamp_ms.count();
@@ -427,7 +466,7 @@ namespace librealsense
         }
 
         frame_interface* frame = m_frame_source->alloc_frame((stream_id.stream_type == RS2_STREAM_DEPTH) ? RS2_EXTENSION_DEPTH_FRAME : RS2_EXTENSION_VIDEO_FRAME,
-            msg->data.size(), additional_data, true);
+            msg->data.size(), additional_data, false);
         if (frame == nullptr)
         {
             LOG_WARNING("Failed to allocate new frame");
@@ -436,7 +475,7 @@ namespace librealsense
         librealsense::video_frame* video_frame = static_cast<librealsense::video_frame*>(frame);
         video_frame->assign(msg->width, msg->height, msg->step, msg->step / msg->width * 8);
         rs2_format stream_format;
-        convert(msg->encoding, stream_format);
+        convert(std::string(msg->encoding.c_str()), stream_format);
         //attaching a temp stream to the frame. Playback sensor should assign the real stream
         frame->set_stream(std::make_shared<video_stream_profile>(platform::stream_profile{}));
         frame->get_stream()->set_format(stream_format);
@@ -13,6 +13,13 @@ namespace librealsense
     class ros_reader: public device_serializer::reader
     {
     public:
+        // Chunks decompressed ahead of playback on the shared thread pool
+        static const uint32_t PREFETCH_CHUNKS = 4;
+
+        // The message index of the bags read is cached in the directory LRS_PLAYBACK_INDEX_CACHE names,
+        // so opening a bag again does not seek through all of it. Nothing is cached when it is not set
+        static std::string index_cache_path(const std::string& file);
+
         ros_reader(const std::string& file, const std::shared_ptr<context>& ctx);
         device_snapshot query_device_description(const nanoseconds& time) override;
         std::shared_ptr<serialized_data> read_next_data() override;
@@ -23,13 +30,14 @@ namespace librealsense
         virtual void enable_stream(const std::vector<device_serializer::stream_identifier>& stream_ids) override;
         virtual void disable_stream(const std::vector<device_serializer::stream_identifier>& stream_ids) override;
         const std::string& get_file_name() const override;
+        void set_frame_queue_size(uint32_t size) override;
 
     private:
 
-        template <typename ROS_TYPE>
-        static typename ROS_TYPE::ConstPtr instantiate_msg(const rosbag::MessageInstance& msg)
+        template <typename ROS_TYPE, typename... Args>
+        static typename ROS_TYPE::Ptr instantiate_msg(const rosbag::MessageInstance& msg, Args&&... args)
         {
-            typename ROS_TYPE::ConstPtr msg_instnance_ptr = msg.instantiate<ROS_TYPE>();
+            typename ROS_TYPE::Ptr msg_instnance_ptr = msg.instantiate<ROS_TYPE>(std::forward<Args>(args)...);
             if (msg_instnance_ptr == nullptr)
             {
                 throw io_exception(to_string()
@@ -131,6 +139,7 @@ namespace librealsense
         static notification create_notification(const rosbag::Bag& file, const rosbag::MessageInstance& message_instance);
         static std::shared_ptr<options_container> read_sensor_options(const rosbag::Bag& file, device_serializer::sensor_identifier sensor_id, const nanoseconds& timestamp, uint32_t file_version);
         static std::vector<std::string> get_topics(std::unique_ptr<rosbag::View>& view);
+        const std::vector<rs2rosinternal::Time>& get_frame_times(const std::string& topic);
 
         std::shared_ptr<metadata_parser_map>    m_metadata_parser_map;
         device_snapshot                         m_initial_device_description;
@@ -141,7 +150,9 @@ namespace librealsense
         std::unique_ptr<rosbag::View>           m_samples_view;
         rosbag::View::iterator                  m_samples_itrator;
         std::vector<std::string>                m_enabled_streams_topics;
+        std::map<std::string, std::vector<rs2rosinternal::Time>> m_frame_times; // per frame topic, sorted
         std::shared_ptr<context>                m_context;
         uint32_t                                m_version;
+        int64_t                                 m_frame_queue_size; // -1 for the default of the file version
     };
 }
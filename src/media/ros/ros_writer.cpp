@@ -10,6 +10,7 @@
 #include "proc/zero-order.h"
 #include "proc/depth-decompress.h"
 #include "ros_writer.h"
+#include "thread-pool.h"
 #include "l500/l500-motion.h"
 #include "l500/l500-depth.h"
 
@@ -17,13 +18,17 @@ namespace librealsense
 {
     using namespace device_serializer;
 
-    ros_writer::ros_writer(const std::string& file, bool compress_while_record) : m_file_path(file)
+    ros_writer::ros_writer(const std::string& file, bool compress_while_record, uint32_t max_pending_chunks) : m_file_path(file)
     {
         LOG_INFO("Compression while record is set to " << (compress_while_record ? "ON" : "OFF"));
         m_bag.open(file, rosbag::BagMode::Write);
         if (compress_while_record)
         {
             m_bag.setCompression(rosbag::CompressionType::LZ4);
+            // Chunks are compressed on the shared pool while the write thread moves on to the next
+            // frames; the write thread still writes them to the file, in order
+            if (max_pending_chunks)
+                m_bag.setChunkExecutor([](std::function<void()> task) { thread_pool::get_default().submit(task); }, max_pending_chunks);
         }
         write_file_version();
     }
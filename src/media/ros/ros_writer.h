@@ -12,7 +12,11 @@ namespace librealsense
     class ros_writer: public writer
     {
     public:
-        explicit ros_writer(const std::string& file, bool compress_while_record);
+        // Chunks that may be waiting for compression before writing a frame blocks
+        static const uint32_t MAX_PENDING_CHUNKS = 8;
+
+        // With no pending chunks, each chunk is compressed on the write thread as it closes
+        explicit ros_writer(const std::string& file, bool compress_while_record, uint32_t max_pending_chunks = MAX_PENDING_CHUNKS);
         void write_device_description(const librealsense::device_snapshot& device_description) override;
         void write_frame(const stream_identifier& stream_id, const nanoseconds& timestamp, frame_holder&& frame) override;
         void write_snapshot(uint32_t device_index, const nanoseconds& timestamp, rs2_extension type, const std::shared_ptr<extension_snapshot>& snapshot) override;
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "synthetic-stream.h"
+#include "mjpeg-decoder.h"
 
 namespace librealsense
 {
@@ -46,8 +47,14 @@ namespace librealsense
 
     protected:
         mjpeg_converter(const char* name, rs2_format target_format) :
-            color_converter(name, target_format) {};
+            color_converter(name, target_format)
+        {
+            register_processing_threads_option();
+        }
         void process_function(byte * const dest[], const byte * source, int width, int height, int actual_size, int input_size) override;
+
+    private:
+        mjpeg_decoder _decoder;
     };
 
     class LRS_EXTENSION_API bgr_to_rgb : public color_converter
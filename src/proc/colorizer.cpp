@@ -132,6 +132,15 @@ namespace librealsense
         { 0, 0, 0 },
         } };
 
+    // A color of a color map as 4 bytes, RGB8 and one to spare
+    static inline uint32_t pack_color(const float3& c)
+    {
+        const uint8_t rgb[4] = { (uint8_t)c.x, (uint8_t)c.y, (uint8_t)c.z, 0 };
+        uint32_t packed;
+        memcpy(&packed, rgb, sizeof(packed));
+        return packed;
+    }
+
     colorizer::colorizer()
         : colorizer("Depth Visualization")
     {}
@@ -210,6 +219,102 @@ namespace librealsense
 
         auto hist_opt = std::make_shared<ptr_option<bool>>(false, true, true, true, &_equalize, "Perform histogram equalization");
         register_option(RS2_OPTION_HISTOGRAM_EQUALIZATION_ENABLED, hist_opt);
+        register_processing_threads_option();
+    }
+
+    template<typename T>
+    void colorizer::build_histogram(const T* depth_data, int width, int height)
+    {
+        _band_histograms.resize(HISTOGRAM_BANDS * MAX_DEPTH);
+        parallel_for(HISTOGRAM_BANDS, [&](int begin, int end)
+        {
+            for (int band = begin; band < end; band++)
+            {
+                auto hist = _band_histograms.data() + band * MAX_DEPTH;
+                memset(hist, 0, MAX_DEPTH * sizeof(int));
+                auto first = size_t(height) * band / HISTOGRAM_BANDS;
+                auto last = size_t(height) * (band + 1) / HISTOGRAM_BANDS;
+                count_histogram(hist, depth_data, first * width, last * width);
+            }
+        });
+
+        // Sum up the bands into the cumulative histogram update_histogram gives
+        auto bands = _band_histograms.data();
+        for (auto i = 0; i < MAX_DEPTH; ++i)
+        {
+            int count = 0;
+            for (int band = 0; band < HISTOGRAM_BANDS; band++)
+                count += bands[band * MAX_DEPTH + i];
+            _hist_data[i] = i >= 2 ? _hist_data[i - 1] + count : count;
+        }
+    }
+
+    void colorizer::update_equalized_lut(const color_map& cm)
+    {
+        _lut.resize(MAX_DEPTH);
+        _lut_range = false;
+
+        // A frame of zeros only is black, whatever the table holds
+        auto pixels = (float)_hist_data[MAX_DEPTH - 1];
+        if (!pixels)
+        {
+            std::fill(_lut.begin(), _lut.end(), 0);
+            return;
+        }
+
+        for (auto i = 0; i < MAX_DEPTH; ++i)
+        {
+            // Depth values not in the frame leave the histogram flat, and the color as it was
+            if (i && _hist_data[i] == _hist_data[i - 1])
+                _lut[i] = _lut[i - 1];
+            else
+                _lut[i] = pack_color(cm.get(_hist_data[i] / pixels));
+        }
+    }
+
+    void colorizer::update_range_lut(const color_map& cm)
+    {
+        if (_lut_range && _lut_map == _map_index && _lut_min == _min && _lut_max == _max && _lut_units == _depth_units)
+            return;
+
+        _lut.resize(MAX_DEPTH);
+        auto min = _min;
+        auto max = _max;
+        for (auto i = 0; i < MAX_DEPTH; ++i)
+        {
+            float data = static_cast<float>(i);
+            _lut[i] = pack_color(cm.get((data * _depth_units - min) / (max - min)));
+        }
+
+        _lut_range = true;
+        _lut_map = _map_index;
+        _lut_min = _min;
+        _lut_max = _max;
+        _lut_units = _depth_units;
+    }
+
+    template<typename T>
+    void colorizer::make_rgb_data_lut(const T* depth_data, uint8_t* rgb_data, int width, int height)
+    {
+        const uint32_t* lut = _lut.data();
+        parallel_for(height, [&](int begin, int end)
+        {
+            auto first = size_t(begin) * width, last = size_t(end) * width;
+            if (first == last)
+                return;
+
+            // Each pixel is stored in 4 bytes, the last one overwritten by the next pixel. The last pixel
+            // of the rows, which may be next to those of another thread, is stored in 3
+            for (auto i = first; i < last - 1; ++i)
+            {
+                auto d = depth_data[i];
+                uint32_t c = d ? lut[static_cast<int>(d)] : 0;
+                memcpy(rgb_data + i * 3, &c, 4);
+            }
+            auto d = depth_data[last - 1];
+            uint32_t c = d ? lut[static_cast<int>(d)] : 0;
+            memcpy(rgb_data + (last - 1) * 3, &c, 3);
+        });
     }
 
     bool colorizer::should_process(const rs2::frame& frame)
@@ -240,23 +345,20 @@ namespace librealsense
             auto depth_format = depth.get_profile().format();
             const auto w = depth.get_width(), h = depth.get_height();
             auto rgb_data = reinterpret_cast<uint8_t*>(const_cast<void *>(rgb.get_data()));
-            auto coloring_function = [&, this](float data) {
-                auto hist_data = _hist_data[(int)data];
-                auto pixels = (float)_hist_data[MAX_DEPTH - 1];
-                return (hist_data / pixels);
-            };
 
             if (depth_format == RS2_FORMAT_DISPARITY32)
             {
                 auto depth_data = reinterpret_cast<const float*>(depth.get_data());
-                update_histogram(_hist_data, depth_data, w, h);
-                make_rgb_data<float>(depth_data, rgb_data, w, h, coloring_function);
+                build_histogram(depth_data, w, h);
+                update_equalized_lut(*_maps[_map_index]);
+                make_rgb_data_lut<float>(depth_data, rgb_data, w, h);
             }
             else if (depth_format == RS2_FORMAT_Z16)
             {
                 auto depth_data = reinterpret_cast<const uint16_t*>(depth.get_data());
-                update_histogram(_hist_data, depth_data, w, h);
-                make_rgb_data<uint16_t>(depth_data, rgb_data, w, h, coloring_function);
+                build_histogram(depth_data, w, h);
+                update_equalized_lut(*_maps[_map_index]);
+                make_rgb_data_lut<uint16_t>(depth_data, rgb_data, w, h);
             }
         };
 
@@ -283,12 +385,8 @@ namespace librealsense
             else if (depth_format == RS2_FORMAT_Z16)
             {
                 auto depth_data = reinterpret_cast<const uint16_t*>(depth.get_data());
-                auto min = _min;
-                auto max = _max;
-                auto coloring_function = [&, this](float data) {
-                    return (data * _depth_units - min) / (max - min);
-                };
-                make_rgb_data<uint16_t>(depth_data, rgb_data, w, h, coloring_function);
+                update_range_lut(*_maps[_map_index]);
+                make_rgb_data_lut<uint16_t>(depth_data, rgb_data, w, h);
             }
         };
 
@@ -106,14 +106,21 @@ namespace librealsense {
         static void update_histogram(int* hist, const T* depth_data, int w, int h)
         {
             memset(hist, 0, MAX_DEPTH * sizeof(int));
-            for (auto i = 0; i < w*h; ++i)
+            count_histogram(hist, depth_data, 0, size_t(w) * h);
+
+            for (auto i = 2; i < MAX_DEPTH; ++i) hist[i] += hist[i - 1]; // Build a cumulative histogram for the indices in [1,0xFFFF]
+        }
+
+        // Adds the depth values of pixels [begin, end) to a histogram that is not cumulative yet
+        template<typename T>
+        static void count_histogram(int* hist, const T* depth_data, size_t begin, size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
             {
                 T depth_val = depth_data[i];
                 int index = static_cast< int >( depth_val );
                 hist[index] += 1;
             }
-
-            for (auto i = 2; i < MAX_DEPTH; ++i) hist[i] += hist[i - 1]; // Build a cumulative histogram for the indices in [1,0xFFFF]
         }
 
         static const int MAX_DEPTH = 0x10000;
@@ -155,6 +162,21 @@ namespace librealsense {
             }
         }
 
+        // As update_histogram, into _hist_data, with the frame counted in row bands across the shared pool
+        template<typename T>
+        void build_histogram(const T* depth_data, int width, int height);
+
+        // Color of every depth value, as make_rgb_data would give it, for the histogram in _hist_data
+        // or for the range of the options
+        void update_equalized_lut(const color_map& cm);
+        void update_range_lut(const color_map& cm);
+
+        // make_rgb_data through _lut: one lookup per pixel
+        template<typename T>
+        void make_rgb_data_lut(const T* depth_data, uint8_t* rgb_data, int width, int height);
+
+        static const int HISTOGRAM_BANDS = 4;
+
         float _min, _max;
         bool _equalize;
 
@@ -163,6 +185,12 @@ namespace librealsense {
 
         std::vector<int> _histogram;
         int* _hist_data;
+        std::vector<int> _band_histograms;  // counts of each row band, HISTOGRAM_BANDS x MAX_DEPTH
+
+        std::vector<uint32_t> _lut;         // RGB8 color of each depth value, padded to 4 bytes
+        bool    _lut_range = false;         // _lut is for the fixed range the options below select
+        int     _lut_map = -1;
+        float   _lut_min = 0.f, _lut_max = 0.f, _lut_units = 0.f;
 
         int _preset = 0;
         rs2::stream_profile _target_stream_profile;
@@ -4,6 +4,7 @@
 #include "../include/librealsense2/hpp/rs_sensor.hpp"
 #include "../include/librealsense2/hpp/rs_processing.hpp"
 
+#include <algorithm>
 #include <numeric>
 #include <cmath>
 #include "environment.h"
@@ -12,193 +13,124 @@
 #include "core/video.h"
 #include "proc/synthetic-stream.h"
 #include "proc/decimation-filter.h"
+#include "image-simd.h"
 
 
-#define PIX_SORT(a,b) { if ((a)>(b)) PIX_SWAP((a),(b)); }
-#define PIX_SWAP(a,b) { pixelvalue temp=(a);(a)=(b);(b)=temp; }
-#define PIX_MIN(a,b) ((a)>(b)) ? (b) : (a)
-#define PIX_MAX(a,b) ((a)>(b)) ? (a) : (b)
-
 namespace librealsense
 {
-    /*----------------------------------------------------------------------------
-    Function :   opt_med3()
-    In       :   pointer to array of 3 pixel values
-    Out      :   a pixelvalue
-    Job      :   optimized search of the median of 3 pixel values
-    Notice   :   found on sci.image.processing
-    cannot go faster unless assumptions are made
-    on the nature of the input signal.
-    ---------------------------------------------------------------------------*/
-    template <class pixelvalue>
-    inline pixelvalue opt_med3(pixelvalue * p)
-    {
-        PIX_SORT(p[0], p[1]);
-        PIX_SORT(p[1], p[2]);
-        PIX_SORT(p[0], p[1]);
-        return p[1];
-    }
-
-    /*
-    ** opt_med4()
-    hacked version
-    **/
-    template <class pixelvalue>
-    inline pixelvalue opt_med4(pixelvalue * p)
-    {
-        PIX_SORT(p[0], p[1]);
-        PIX_SORT(p[2], p[3]);
-        PIX_SORT(p[0], p[2]);
-        PIX_SORT(p[1], p[3]);
-        return PIX_MIN(p[1], p[2]);
-    }
-
-    /*----------------------------------------------------------------------------
-    Function :   opt_med5()
-    In       :   pointer to array of 5 pixel values
-    Out      :   a pixelvalue
-    Job      :   optimized search of the median of 5 pixel values
-    Notice   :   found on sci.image.processing
-    cannot go faster unless assumptions are made
-    on the nature of the input signal.
-    ---------------------------------------------------------------------------*/
-    template <class pixelvalue>
-    inline pixelvalue opt_med5(pixelvalue * p)
-    {
-        PIX_SORT(p[0], p[1]);
-        PIX_SORT(p[3], p[4]);
-        p[3] = PIX_MAX(p[0], p[3]);
-        p[1] = PIX_MIN(p[1], p[4]);
-        PIX_SORT(p[1], p[2]);
-        p[2] = PIX_MIN(p[2], p[3]);
-        return PIX_MAX(p[1], p[2]);
-    }
-
-    /*----------------------------------------------------------------------------
-    Function :   opt_med6()
-    In       :   pointer to array of 6 pixel values
-    Out      :   a pixelvalue
-    Job      :   optimized search of the median of 6 pixel values
-    Notice   :   from Christoph_John@gmx.de
-    based on a selection network which was proposed in
-    "FAST, EFFICIENT MEDIAN FILTERS WITH EVEN LENGTH WINDOWS"
-    J.P. HAVLICEK, K.A. SAKADY, G.R.KATZ
-    If you need larger even length kernels check the paper
-    ---------------------------------------------------------------------------*/
-    template <class pixelvalue>
-    inline pixelvalue opt_med6(pixelvalue * p)
-    {
-        PIX_SORT(p[1], p[2]);
-        PIX_SORT(p[3], p[4]);
-        PIX_SORT(p[0], p[1]);
-        PIX_SORT(p[2], p[3]);
-        PIX_SORT(p[4], p[5]);
-        PIX_SORT(p[1], p[2]);
-        PIX_SORT(p[3], p[4]);
-        PIX_SORT(p[0], p[1]);
-        PIX_SORT(p[2], p[3]);
-        p[4] = PIX_MIN(p[4], p[5]);
-        p[2] = PIX_MAX(p[1], p[2]);
-        p[3] = PIX_MIN(p[3], p[4]);
-        return PIX_MIN(p[2], p[3]);
-    }
+    const uint8_t decimation_min_val = 1;
+    const uint8_t decimation_max_val = 8;    // Decimation levels according to the reference design
+    const uint8_t decimation_default_val = 2;
+    const uint8_t decimation_step = 1;    // Linear decimation
 
-    /*----------------------------------------------------------------------------
-    Function :   opt_med7()
-    In       :   pointer to array of 7 pixel values
-    Out      :   a pixelvalue
-    Job      :   optimized search of the median of 7 pixel values
-    Notice   :   found on sci.image.processing
-    cannot go faster unless assumptions are made
-    on the nature of the input signal.
-    ---------------------------------------------------------------------------*/
-    template <class pixelvalue>
-    inline pixelvalue opt_med7(pixelvalue * p)
+    namespace
     {
-        PIX_SORT(p[0], p[5]);
-        PIX_SORT(p[0], p[3]);
-        PIX_SORT(p[1], p[6]);
-        PIX_SORT(p[2], p[4]);
-        PIX_SORT(p[0], p[1]);
-        PIX_SORT(p[3], p[5]);
-        PIX_SORT(p[2], p[6]);
-        p[3] = PIX_MAX(p[2], p[3]);
-        p[3] = PIX_MIN(p[3], p[6]);
-        p[4] = PIX_MIN(p[4], p[5]);
-        PIX_SORT(p[1], p[4]);
-        p[3] = PIX_MAX(p[1], p[3]);
-        return PIX_MIN(p[3], p[4]);
-    }
+        // Output pixels per pass of the column sums, which keeps the sums of up to 8 x 8 blocks of
+        // 4 bytes on the stack
+        const size_t sum_chunk = 32;
+
+        // Box average of the blocks of one output row of the formats other than depth, their real
+        // pixels only. rows are the scale input rows; the columns are summed down the block rows
+        // first and then across each block, the sums being the same in either order
+        void decimate_row(rs2_format format, size_t bpp, const uint8_t * const rows[], uint8_t * out,
+            size_t real_width, size_t scale)
+        {
+            auto& k = get_unpack_kernels();
+            const size_t patch_size = scale * scale;
+            const size_t s2 = scale >> 1;
+            const bool odd = (scale & 1);
+            const bool yuv422 = format == RS2_FORMAT_YUYV || format == RS2_FORMAT_UYVY;
+            // Whole macro-pixels of 4:2:2, which sum_chunk being even keeps within a chunk
+            const size_t pixels = yuv422 ? (real_width >> 1) * 2 : real_width;
+
+            uint32_t sums[sum_chunk * decimation_max_val * 4];
+            const uint8_t * chunk_rows[decimation_max_val];
+            const uint16_t * chunk_rows_16[decimation_max_val];
+
+            for (size_t i = 0; i < pixels; i += sum_chunk)
+            {
+                const size_t blocks = std::min(sum_chunk, pixels - i);
+                for (size_t n = 0; n < scale; n++)
+                {
+                    chunk_rows[n] = rows[n] + i * scale * bpp;
+                    chunk_rows_16[n] = reinterpret_cast<const uint16_t *>(chunk_rows[n]);
+                }
 
-    /*----------------------------------------------------------------------------
-    Function :   opt_med9()
-    Hacked version of opt_med9()
-    */
-    template <class pixelvalue>
-    inline pixelvalue opt_med8(pixelvalue * p)
-    {
-        PIX_SORT(p[0], p[1]);
-        PIX_SORT(p[3], p[4]);
-        PIX_SORT(p[6], p[7]);
-        PIX_SORT(p[2], p[3]);
-        PIX_SORT(p[5], p[6]);
-        PIX_SORT(p[3], p[4]);
-        PIX_SORT(p[6], p[7]);
-        p[4] = PIX_MIN(p[4], p[7]);
-        PIX_SORT(p[3], p[6]);
-        p[5] = PIX_MAX(p[2], p[5]);
-        p[3] = PIX_MAX(p[0], p[3]);
-        p[1] = PIX_MIN(p[1], p[4]);
-        p[3] = PIX_MIN(p[3], p[6]);
-        PIX_SORT(p[3], p[1]);
-        p[3] = PIX_MAX(p[5], p[3]);
-        return PIX_MIN(p[3], p[1]);
-    }
+                if (format == RS2_FORMAT_Y16)
+                    k.column_sum_u16(sums, nullptr, chunk_rows_16, int(scale), int(blocks * scale));
+                else
+                    k.column_sum_u8(sums, chunk_rows, int(scale), int(blocks * scale * bpp));
 
-    /*----------------------------------------------------------------------------
-    Function :   opt_med9()
-    In       :   pointer to an array of 9 pixelvalues
-    Out      :   a pixelvalue
-    Job      :   optimized search of the median of 9 pixelvalues
-    Notice   :   in theory, cannot go faster without assumptions on the
-    signal.
-    Formula from:
-    XILINX XCELL magazine, vol. 23 by John L. Smith
-
-    The input array is modified in the process
-    The result array is guaranteed to contain the median
-    value
-    in middle position, but other elements are NOT sorted.
-    ---------------------------------------------------------------------------*/
-    template <class pixelvalue>
-    inline pixelvalue opt_med9(pixelvalue * p)
-    {
-        PIX_SORT(p[1], p[2]);
-        PIX_SORT(p[4], p[5]);
-        PIX_SORT(p[7], p[8]);
-        PIX_SORT(p[0], p[1]);
-        PIX_SORT(p[3], p[4]);
-        PIX_SORT(p[6], p[7]);
-        PIX_SORT(p[1], p[2]);
-        PIX_SORT(p[4], p[5]);
-        PIX_SORT(p[7], p[8]);
-        p[3] = PIX_MAX(p[0], p[3]);
-        p[5] = PIX_MIN(p[5], p[8]);
-        PIX_SORT(p[4], p[7]);
-        p[6] = PIX_MAX(p[3], p[6]);
-        p[4] = PIX_MAX(p[1], p[4]);
-        p[2] = PIX_MIN(p[2], p[5]);
-        p[4] = PIX_MIN(p[4], p[7]);
-        PIX_SORT(p[4], p[2]);
-        p[4] = PIX_MAX(p[6], p[4]);
-        return PIX_MIN(p[4], p[2]);
+                auto q = out + i * bpp;
+                if (yuv422)
+                {
+                    // The luma of each pixel and the chroma shared by each pair, the chroma of a
+                    // pair the block splits counted once
+                    for (size_t b = 0; b < blocks; b += 2)
+                    {
+                        auto p = sums + b * scale * 2;
+                        auto luma = [&](size_t offset)
+                        {
+                            uint32_t sum = 0;
+                            for (size_t m = 0; m < scale; ++m)
+                                sum += p[offset + m * 2];
+                            return uint8_t(sum / patch_size);
+                        };
+                        auto chroma = [&](size_t offset)
+                        {
+                            uint32_t sum = 0;
+                            for (size_t m = 0; m < s2; ++m)
+                                sum += 2 * p[offset + m * 4];
+                            if (odd)
+                                sum += p[offset + s2 * 4];
+                            return uint8_t(sum / patch_size);
+                        };
+
+                        if (format == RS2_FORMAT_YUYV)
+                        {
+                            *q++ = luma(0);
+                            *q++ = chroma(1);
+                            *q++ = luma(s2 * 4 + (odd ? 2 : 0));
+                            *q++ = chroma(3);
+                        }
+                        else
+                        {
+                            *q++ = chroma(0);
+                            *q++ = luma(1);
+                            *q++ = chroma(2);
+                            *q++ = luma(s2 * 4 + (odd ? 3 : 1));
+                        }
+                    }
+                }
+                else if (format == RS2_FORMAT_Y16)
+                {
+                    auto q16 = reinterpret_cast<uint16_t *>(q);
+                    for (size_t b = 0; b < blocks; b++)
+                    {
+                        uint32_t sum = 0;
+                        for (size_t m = 0; m < scale; ++m)
+                            sum += sums[b * scale + m];
+                        q16[b] = uint16_t(sum / patch_size);
+                    }
+                }
+                else
+                {
+                    // Y8 and the channels of RGB and RGBA each averaged on their own
+                    for (size_t b = 0; b < blocks; b++)
+                    {
+                        for (size_t c = 0; c < bpp; c++)
+                        {
+                            uint32_t sum = 0;
+                            for (size_t m = 0; m < scale; ++m)
+                                sum += sums[(b * scale + m) * bpp + c];
+                            *q++ = uint8_t(sum / patch_size);
+                        }
+                    }
+                }
+            }
+        }
     }
 
-    const uint8_t decimation_min_val = 1;
-    const uint8_t decimation_max_val = 8;    // Decimation levels according to the reference design
-    const uint8_t decimation_default_val = 2;
-    const uint8_t decimation_step = 1;    // Linear decimation
-
     decimation_filter::decimation_filter() :
         stream_filter_processing_block("Decimation Filter"),
         _decimation_factor(decimation_default_val),
@@ -239,6 +171,7 @@ namespace librealsense
         });
 
         register_option(RS2_OPTION_FILTER_MAGNITUDE, decimation_control);
+        register_processing_threads_option();
     }
 
     rs2::frame decimation_filter::process_frame(const rs2::frame_source& source, const rs2::frame& f)
@@ -357,483 +290,111 @@ namespace librealsense
     void decimation_filter::decimate_depth(const uint16_t * frame_data_in, uint16_t * frame_data_out,
         size_t width_in, size_t height_in, size_t scale)
     {
-        // Use median filtering
-        std::vector<uint16_t> working_kernel(_kernel_size);
-        auto wk_begin = working_kernel.data();
-        auto wk_itr = wk_begin;
-        std::vector<uint16_t*> pixel_raws(scale);
-        uint16_t* block_start = const_cast<uint16_t*>(frame_data_in);
-
-        if (scale == 2 || scale == 3)
+        // Output rows are independent of each other, bands of them go to the thread pool
+        parallel_for(int(_real_height), [&](int begin, int end)
         {
-            for (int j = 0; j < _real_height; j++)
-            {
-                uint16_t *p{};
-                // Mark the beginning of each of the N lines that the filter will run upon
-                for (size_t i = 0; i < pixel_raws.size(); i++)
-                    pixel_raws[i] = block_start + (width_in*i);
-
-                for (size_t i = 0, chunk_offset = 0; i < _real_width; i++)
-                {
-                    wk_itr = wk_begin;
-                    // extract data the kernel to process
-                    for (size_t n = 0; n < scale; ++n)
-                    {
-                        p = pixel_raws[n] + chunk_offset;
-                        for (size_t m = 0; m < scale; ++m)
-                        {
-                            if (*(p + m))
-                                *wk_itr++ = *(p + m);
-                        }
-                    }
-
-                    // For even-size kernels pick the member one below the middle
-                    auto ks = (int)(wk_itr - wk_begin);
-                    if (ks == 0)
-                        *frame_data_out++ = 0;
-                    else
-                    {
-                        switch (ks)
-                        {
-                        case 1:
-                            *frame_data_out++ = working_kernel[0];
-                            break;
-                        case 2:
-                            *frame_data_out++ = PIX_MIN(working_kernel[0], working_kernel[1]);
-                            break;
-                        case 3:
-                            *frame_data_out++ = opt_med3<uint16_t>(working_kernel.data());
-                            break;
-                        case 4:
-                            *frame_data_out++ = opt_med4<uint16_t>(working_kernel.data());
-                            break;
-                        case 5:
-                            *frame_data_out++ = opt_med5<uint16_t>(working_kernel.data());
-                            break;
-                        case 6:
-                            *frame_data_out++ = opt_med6<uint16_t>(working_kernel.data());
-                            break;
-                        case 7:
-                            *frame_data_out++ = opt_med7<uint16_t>(working_kernel.data());
-                            break;
-                        case 8:
-                            *frame_data_out++ = opt_med8<uint16_t>(working_kernel.data());
-                            break;
-                        case 9:
-                            *frame_data_out++ = opt_med9<uint16_t>(working_kernel.data());
-                            break;
-                        }
-                    }
+            decimate_depth_rows(frame_data_in, frame_data_out + size_t(begin) * _padded_width, width_in, scale,
+                _real_width, _padded_width, begin, end);
+        });
 
-                    chunk_offset += scale;
-                }
+        // Fill-in the padded rows with zeros
+        std::fill(frame_data_out + size_t(_real_height) * _padded_width,
+            frame_data_out + size_t(_padded_height) * _padded_width, uint16_t(0));
+    }
 
-                // Fill-in the padded colums with zeros
-                for (int j = _real_width; j < _padded_width; j++)
-                    *frame_data_out++ = 0;
+    void decimation_filter::decimate_depth_rows(const uint16_t * frame_data_in, uint16_t * frame_data_out,
+        size_t width_in, size_t scale, size_t real_width, size_t padded_width, size_t row_begin, size_t row_end)
+    {
+        auto& k = get_unpack_kernels();
+        const uint16_t * rows[decimation_max_val];
+        uint32_t sums[sum_chunk * decimation_max_val], nonzero[sum_chunk * decimation_max_val];
 
-                // Skip N lines to the beginnig of the next processing segment
-                block_start += width_in * scale;
-            }
-        }
-        else
+        for (size_t j = row_begin; j < row_end; j++)
         {
-            for (int j = 0; j < _real_height; j++)
+            // Mark the beginning of each of the N lines that the filter will run upon
+            for (size_t n = 0; n < scale; n++)
+                rows[n] = frame_data_in + (j * scale + n) * width_in;
+
+            // Median of the non-zero pixels of the 2x2 and 3x3 blocks, for even-size kernels the
+            // member one below the middle
+            if (scale == 2)
+                k.median_2x2(frame_data_out, rows, int(real_width));
+            else if (scale == 3)
+                k.median_3x3(frame_data_out, rows, int(real_width));
+            else
             {
-                uint16_t *p{};
-                // Mark the beginning of each of the N lines that the filter will run upon
-                for (size_t i = 0; i < pixel_raws.size(); i++)
-                    pixel_raws[i] = block_start + (width_in*i);
-
-                for (size_t i = 0, chunk_offset = 0; i < _real_width; i++)
+                // Mean of the non-zero pixels of the larger blocks
+                for (size_t i = 0; i < real_width; i += sum_chunk)
                 {
-                    int sum = 0;
-                    int counter = 0;
+                    const size_t blocks = std::min(sum_chunk, real_width - i);
+                    const uint16_t * chunk_rows[decimation_max_val];
+                    for (size_t n = 0; n < scale; n++)
+                        chunk_rows[n] = rows[n] + i * scale;
+                    k.column_sum_u16(sums, nonzero, chunk_rows, int(scale), int(blocks * scale));
 
-                    // extract data the kernel to process
-                    for (size_t n = 0; n < scale; ++n)
+                    for (size_t b = 0; b < blocks; b++)
                     {
-                        p = pixel_raws[n] + chunk_offset;
+                        int sum = 0;
+                        int counter = 0;
                         for (size_t m = 0; m < scale; ++m)
                         {
-                            if (*(p + m))
-                            {
-                                sum += p[m];
-                                ++counter;
-                            }
+                            sum += sums[b * scale + m];
+                            counter += nonzero[b * scale + m];
                         }
+                        frame_data_out[i + b] = (counter == 0 ? 0 : sum / counter);
                     }
-
-                    *frame_data_out++ = (counter == 0 ? 0 : sum / counter);
-                    chunk_offset += scale;
                 }
-
-                // Fill-in the padded colums with zeros
-                for (int j = _real_width; j < _padded_width; j++)
-                    *frame_data_out++ = 0;
-
-                // Skip N lines to the beginnig of the next processing segment
-                block_start += width_in * scale;
             }
-        }
 
-        // Fill-in the padded rows with zeros
-        for (auto v = _real_height; v < _padded_height; ++v)
-        {
-            for (auto u = 0; u < _padded_width; ++u)
-                *frame_data_out++ = 0;
+            // Fill-in the padded colums with zeros
+            std::fill(frame_data_out + real_width, frame_data_out + padded_width, uint16_t(0));
+            frame_data_out += padded_width;
         }
     }
 
     void decimation_filter::decimate_others(rs2_format format, const void * frame_data_in, void * frame_data_out,
         size_t width_in, size_t height_in, size_t scale)
     {
-        int sum = 0;
-        auto patch_size = scale * scale;
-
+        size_t bpp;
         switch (format)
         {
+        case RS2_FORMAT_Y8: bpp = 1; break;
         case RS2_FORMAT_YUYV:
-        {
-            uint8_t* from = (uint8_t*)frame_data_in;
-            uint8_t* p = nullptr;
-            uint8_t* q = (uint8_t*)frame_data_out;
-
-            auto w_2 = width_in >> 1;
-            auto rw_2 = _real_width >> 1;
-            auto pw_2 = _padded_width >> 1;
-            auto s2 = scale >> 1;
-            bool odd = (scale & 1);
-            for (int j = 0; j < _real_height; ++j)
-            {
-                for (int i = 0; i < rw_2; ++i)
-                {
-                    p = from + scale * (j * w_2 + i) * 4;
-                    sum = 0;
-                    for (int n = 0; n < scale; ++n)
-                    {
-                        for (int m = 0; m < scale; ++m)
-                            sum += p[m * 2];
-
-                        p += w_2 * 4;
-                    }
-                    *q++ = (uint8_t)(sum / patch_size);
-
-                    p = from + scale * (j * w_2 + i) * 4 + 1;
-                    sum = 0;
-                    for (int n = 0; n < scale; ++n)
-                    {
-                        for (int m = 0; m < s2; ++m)
-                            sum += 2 * p[m * 4];
-
-                        if (odd)
-                            sum += p[s2 * 4];
-
-                        p += w_2 * 4;
-                    }
-                    *q++ = (uint8_t)(sum / patch_size);
-
-                    p = from + scale * (j * w_2 + i) * 4 + s2 * 4 + (odd ? 2 : 0);
-                    sum = 0;
-                    for (int n = 0; n < scale; ++n)
-                    {
-                        for (int m = 0; m < scale; ++m)
-                            sum += p[m * 2];
-
-                        p += w_2 * 4;
-                    }
-                    *q++ = (uint8_t)(sum / patch_size);
-
-                    p = from + scale * (j * w_2 + i) * 4 + 3;
-                    sum = 0;
-                    for (int n = 0; n < scale; ++n)
-                    {
-                        for (int m = 0; m < s2; ++m)
-                            sum += 2 * p[m * 4];
-
-                        if (odd)
-                            sum += p[s2 * 4];
-
-                        p += w_2 * 4;
-                    }
-                    *q++ = (uint8_t)(sum / patch_size);
-                }
-
-                for (int i = rw_2; i < pw_2; ++i)
-                {
-                    *q++ = 0;
-                    *q++ = 0;
-                    *q++ = 0;
-                    *q++ = 0;
-                }
-            }
-
-            for (int j = _real_height; j < _padded_height; ++j)
-            {
-                for (int i = 0; i < _padded_width; ++i)
-                {
-                    *q++ = 0;
-                    *q++ = 0;
-                }
-            }
-        }
-        break;
-
         case RS2_FORMAT_UYVY:
-        {
-            uint8_t* from = (uint8_t*)frame_data_in;
-            uint8_t* p = nullptr;
-            uint8_t* q = (uint8_t*)frame_data_out;
-
-            auto w_2 = width_in >> 1;
-            auto rw_2 = _real_width >> 1;
-            auto pw_2 = _padded_width >> 1;
-            auto s2 = scale >> 1;
-            bool odd = (scale & 1);
-            for (int j = 0; j < _real_height; ++j)
-            {
-                for (int i = 0; i < rw_2; ++i)
-                {
-                    p = from + scale * (j * w_2 + i) * 4;
-                    sum = 0;
-                    for (int n = 0; n < scale; ++n)
-                    {
-                        for (int m = 0; m < s2; ++m)
-                            sum += 2 * p[m * 4];
-
-                        if (odd)
-                            sum += p[s2 * 4];
-
-                        p += w_2 * 4;
-                    }
-                    *q++ = (uint8_t)(sum / patch_size);
-
-                    p = from + scale * (j * w_2 + i) * 4 + 1;
-                    sum = 0;
-                    for (int n = 0; n < scale; ++n)
-                    {
-                        for (int m = 0; m < scale; ++m)
-                            sum += p[m * 2];
-
-                        p += w_2 * 4;
-                    }
-                    *q++ = (uint8_t)(sum / patch_size);
-
-                    p = from + scale * (j * w_2 + i) * 4 + 2;
-                    sum = 0;
-                    for (int n = 0; n < scale; ++n)
-                    {
-                        for (int m = 0; m < s2; ++m)
-                            sum += 2 * p[m * 4];
-
-                        if (odd)
-                            sum += p[s2 * 4];
-
-                        p += w_2 * 4;
-                    }
-                    *q++ = (uint8_t)(sum / patch_size);
-
-                    p = from + scale * (j * w_2 + i) * 4 + s2 * 4 + (odd ? 3 : 1);
-                    sum = 0;
-                    for (int n = 0; n < scale; ++n)
-                    {
-                        for (int m = 0; m < scale; ++m)
-                            sum += p[m * 2];
-
-                        p += w_2 * 4;
-                    }
-                    *q++ = (uint8_t)(sum / patch_size);
-                }
-
-                for (int i = rw_2; i < pw_2; ++i)
-                {
-                    *q++ = 0;
-                    *q++ = 0;
-                    *q++ = 0;
-                    *q++ = 0;
-                }
-            }
-
-            for (int j = _real_height; j < _padded_height; ++j)
-            {
-                for (int i = 0; i < _padded_width; ++i)
-                {
-                    *q++ = 0;
-                    *q++ = 0;
-                }
-            }
-        }
-        break;
-
+        case RS2_FORMAT_Y16: bpp = 2; break;
         case RS2_FORMAT_RGB8:
-        case RS2_FORMAT_BGR8:
-        {
-            uint8_t* from = (uint8_t*)frame_data_in;
-            uint8_t* p = nullptr;
-            uint8_t* q = (uint8_t*)frame_data_out;;
-
-            for (int j = 0; j < _real_height; ++j)
-            {
-                for (int i = 0; i < _real_width; ++i)
-                {
-                    for (int k = 0; k < 3; ++k)
-                    {
-                        p = from + scale * (j * width_in + i) * 3 + k;
-                        sum = 0;
-                        for (int n = 0; n < scale; ++n)
-                        {
-                            for (int m = 0; m < scale; ++m)
-                                sum += p[m * 3];
-
-                            p += width_in * 3;
-                        }
-
-                        *q++ = (uint8_t)(sum / patch_size);
-                    }
-                }
-
-                for (int i = _real_width; i < _padded_width; ++i)
-                {
-                    *q++ = 0;
-                    *q++ = 0;
-                    *q++ = 0;
-                }
-            }
-
-            for (int j = _real_height; j < _padded_height; ++j)
-            {
-                for (int i = 0; i < _padded_width; ++i)
-                {
-                    *q++ = 0;
-                    *q++ = 0;
-                    *q++ = 0;
-                }
-            }
-        }
-        break;
-
+        case RS2_FORMAT_BGR8: bpp = 3; break;
         case RS2_FORMAT_RGBA8:
-        case RS2_FORMAT_BGRA8:
-        {
-            uint8_t* from = (uint8_t*)frame_data_in;
-            uint8_t* p = nullptr;
-            uint8_t* q = (uint8_t*)frame_data_out;
-
-            for (int j = 0; j < _real_height; ++j)
-            {
-                for (int i = 0; i < _real_width; ++i)
-                {
-                    for (int k = 0; k < 4; ++k)
-                    {
-                        p = from + scale * (j * width_in + i) * 4 + k;
-                        sum = 0;
-                        for (int n = 0; n < scale; ++n)
-                        {
-                            for (int m = 0; m < scale; ++m)
-                                sum += p[m * 4];
-
-                            p += width_in * 4;
-                        }
-
-                        *q++ = (uint8_t)(sum / patch_size);
-                    }
-                }
-
-                for (int i = _real_width; i < _padded_width; ++i)
-                {
-                    *q++ = 0;
-                    *q++ = 0;
-                    *q++ = 0;
-                    *q++ = 0;
-                }
-            }
-
-            for (int j = _real_height; j < _padded_height; ++j)
-            {
-                for (int i = 0; i < _padded_width; ++i)
-                {
-                    *q++ = 0;
-                    *q++ = 0;
-                    *q++ = 0;
-                    *q++ = 0;
-                }
-            }
+        case RS2_FORMAT_BGRA8: bpp = 4; break;
+        default: return;
         }
-        break;
 
-        case RS2_FORMAT_Y8:
-        {
-            uint8_t* from = (uint8_t*)frame_data_in;
-            uint8_t* p = nullptr;
-            uint8_t* q = (uint8_t*)frame_data_out;
+        auto from = static_cast<const uint8_t *>(frame_data_in);
+        auto q = static_cast<uint8_t *>(frame_data_out);
+        const bool yuv422 = format == RS2_FORMAT_YUYV || format == RS2_FORMAT_UYVY;
+        // In whole macro-pixels for 4:2:2
+        const size_t stride_in = yuv422 ? (width_in >> 1) * 4 : width_in * bpp;
+        const size_t stride_out = _padded_width * bpp;
+        const size_t real_width = _real_width;
+        const size_t real_bytes = yuv422 ? (real_width >> 1) * 4 : real_width * bpp;
 
-            for (int j = 0; j < _real_height; ++j)
-            {
-                for (int i = 0; i < _real_width; ++i)
-                {
-                    p = from + scale * (j * width_in + i);
-                    sum = 0;
-                    for (int n = 0; n < scale; ++n)
-                    {
-                        for (int m = 0; m < scale; ++m)
-                            sum += p[m];
-
-                        p += width_in;
-                    }
-
-                    *q++ = (uint8_t)(sum / patch_size);
-                }
-
-                for (int i = _real_width; i < _padded_width; ++i)
-                    *q++ = 0;
-            }
-
-            for (int j = _real_height; j < _padded_height; ++j)
-            {
-                for (int i = 0; i < _padded_width; ++i)
-                    *q++ = 0;
-            }
-        }
-        break;
-
-        case RS2_FORMAT_Y16:
+        parallel_for(int(_real_height), [&](int begin, int end)
         {
-            uint16_t* from = (uint16_t*)frame_data_in;
-            uint16_t* p = nullptr;
-            uint16_t* q = (uint16_t*)frame_data_out;
-
-            for (int j = 0; j < _real_height; ++j)
+            const uint8_t * rows[decimation_max_val];
+            for (size_t j = begin; j < size_t(end); j++)
             {
-                for (int i = 0; i < _real_width; ++i)
-                {
-                    p = from + scale * (j * width_in + i);
-                    sum = 0;
-                    for (int n = 0; n < scale; ++n)
-                    {
-                        for (int m = 0; m < scale; ++m)
-                            sum += p[m];
-
-                        p += width_in;
-                    }
+                for (size_t n = 0; n < scale; n++)
+                    rows[n] = from + (j * scale + n) * stride_in;
 
-                    *q++ = (uint16_t)(sum / patch_size);
-                }
+                auto row = q + j * stride_out;
+                decimate_row(format, bpp, rows, row, real_width, scale);
 
-                for (int i = _real_width; i < _padded_width; ++i)
-                    *q++ = 0;
-            }
-
-            for (int j = _real_height; j < _padded_height; ++j)
-            {
-                for (int i = 0; i < _padded_width; ++i)
-                    *q++ = 0;
+                // Fill-in the padded colums with zeros
+                std::fill(row + real_bytes, row + stride_out, uint8_t(0));
             }
-        }
-        break;
+        });
 
-        default:
-            break;
-        }
+        // Fill-in the padded rows with zeros
+        std::fill(q + size_t(_real_height) * stride_out, q + size_t(_padded_height) * stride_out, uint8_t(0));
     }
 }
-
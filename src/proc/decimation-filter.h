@@ -21,11 +21,18 @@ namespace librealsense
         void decimate_depth(const uint16_t * frame_data_in, uint16_t * frame_data_out,
             size_t width_in, size_t height_in, size_t scale);
 
+        // Output rows [row_begin, row_end) of decimate_depth, padded columns included, written from
+        // frame_data_out on; frame_data_in is the whole input frame
+        static void decimate_depth_rows(const uint16_t * frame_data_in, uint16_t * frame_data_out,
+            size_t width_in, size_t scale, size_t real_width, size_t padded_width, size_t row_begin, size_t row_end);
+
         void decimate_others(rs2_format format, const void * frame_data_in, void * frame_data_out,
             size_t width_in, size_t height_in, size_t scale);
         rs2::frame process_frame(const rs2::frame_source& source, const rs2::frame& f) override;
 
     private:
+        friend class depth_post_processing;
+
         void    update_output_profile(const rs2::frame& f);
 
         uint8_t                 _decimation_factor;
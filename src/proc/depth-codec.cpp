@@ -0,0 +1,718 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "proc/depth-codec.h"
+#include "image-simd.h"
+#include "types.h"
+#include "environment.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+#include "../third-party/realsense-file/lz4/lz4.h"
+#ifdef RS2_USE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace librealsense
+{
+    namespace
+    {
+        inline uint32_t zigzag(uint16_t value, uint16_t previous)
+        {
+            // Deltas wrap around 16 bits, so that every one takes 16 bits at most
+            int32_t delta = static_cast<int16_t>(static_cast<uint16_t>(value - previous));
+            return (static_cast<uint32_t>(delta) << 1) ^ static_cast<uint32_t>(delta >> 31);
+        }
+
+        inline uint16_t unzigzag(uint32_t code, uint16_t previous)
+        {
+            return static_cast<uint16_t>(previous + ((code >> 1) ^ (0u - (code & 1))));
+        }
+
+        inline void store_u32(uint8_t * dst, uint32_t value)
+        {
+            for (int i = 0; i < 4; i++)
+                dst[i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+
+        inline uint32_t load_u32(const uint8_t * src)
+        {
+            return uint32_t(src[0]) | uint32_t(src[1]) << 8 | uint32_t(src[2]) << 16 | uint32_t(src[3]) << 24;
+        }
+
+        inline void store_u64(uint8_t * dst, uint64_t value)
+        {
+            store_u32(dst, static_cast<uint32_t>(value));
+            store_u32(dst + 4, static_cast<uint32_t>(value >> 32));
+        }
+
+        inline uint64_t load_u64(const uint8_t * src)
+        {
+            return uint64_t(load_u32(src)) | uint64_t(load_u32(src + 4)) << 32;
+        }
+
+        void throw_corrupt(const depth_codec& codec)
+        {
+            throw invalid_value_exception(to_string() << "depth frame is not valid " << codec.name() << " data");
+        }
+
+        class raw_codec : public depth_codec
+        {
+        public:
+            depth_codec_id id() const override { return depth_codec_id::raw; }
+            const char* name() const override { return "raw"; }
+
+            size_t encode(uint8_t * dst, size_t capacity, const uint16_t * src, size_t count) const override
+            {
+                auto size = count * sizeof(uint16_t);
+                if (size > capacity)
+                    return 0;
+                memcpy(dst, src, size);
+                return size;
+            }
+
+            void decode(uint16_t * dst, size_t count, const uint8_t * src, size_t size) const override
+            {
+                if (size != count * sizeof(uint16_t))
+                    throw_corrupt(*this);
+                memcpy(dst, src, size);
+            }
+        };
+
+        ///////////////////////////////////////////////////////////////////////
+        // RVL: runs of zeros and of non-zeros, the non-zeros as deltas      //
+        ///////////////////////////////////////////////////////////////////////
+
+        // Values as 3-bit groups from the lowest up, each in a nibble whose top bit is set when more
+        // follow, the nibbles packed into 32-bit words from their top down
+        class nibble_writer
+        {
+        public:
+            nibble_writer(uint8_t * dst, size_t capacity)
+                : _dst(dst), _start(dst), _end(dst + capacity / 4 * 4) {}
+
+            void put(uint32_t value)
+            {
+                if (value < 8)
+                {
+                    push(value, 4);
+                    return;
+                }
+
+                uint64_t code = 0;
+                int bits = 0;
+                do
+                {
+                    uint32_t nibble = value & 7;
+                    value >>= 3;
+                    if (value)
+                        nibble |= 8;
+                    code = code << 4 | nibble;
+                    bits += 4;
+                } while (value);
+
+                if (bits > 32)
+                {
+                    push(code >> 32, bits - 32);
+                    bits = 32;
+                }
+                push(code & 0xffffffff, bits);
+            }
+
+            bool overflow() const { return _overflow; }
+
+            // The size written, the last word padded with zeros
+            size_t finish()
+            {
+                if (_bits)
+                    store(static_cast<uint32_t>(_pending << (32 - _bits)));
+                _bits = 0;
+                return _overflow ? 0 : _dst - _start;
+            }
+
+        private:
+            // The pending bits are the lower _bits of _pending, less than 32 of them
+            void push(uint64_t code, int bits)
+            {
+                _pending = _pending << bits | code;
+                _bits += bits;
+                if (_bits >= 32)
+                {
+                    _bits -= 32;
+                    store(static_cast<uint32_t>(_pending >> _bits));
+                }
+            }
+
+            void store(uint32_t word)
+            {
+                if (_dst == _end)
+                {
+                    _overflow = true;
+                    return;
+                }
+                store_u32(_dst, word);
+                _dst += 4;
+            }
+
+            uint8_t * _dst;
+            uint8_t * _start;
+            uint8_t * _end;
+            uint64_t _pending = 0;
+            int _bits = 0;
+            bool _overflow = false;
+        };
+
+        // Decodes the values of one or two nibbles, which are most of the deltas of smooth depth, from
+        // the next 8 bits by table
+        struct nibble_table
+        {
+            uint8_t length[256];    // in nibbles, 0 for values of more than 2
+            uint8_t value[256];
+
+            nibble_table()
+            {
+                for (int byte = 0; byte < 256; byte++)
+                {
+                    int first = byte >> 4, second = byte & 15;
+                    length[byte] = !(first & 8) ? 1 : !(second & 8) ? 2 : 0;
+                    value[byte] = static_cast<uint8_t>(!(first & 8) ? first : (first & 7) | (second & 7) << 3);
+                }
+            }
+        };
+
+        const nibble_table rvl_nibbles;
+
+        class nibble_reader
+        {
+        public:
+            nibble_reader(const uint8_t * src, size_t size)
+                : _src(src), _words(size / 4) {}
+
+            uint32_t get()
+            {
+                if (_bits < 32)
+                    refill();
+                auto byte = static_cast<uint8_t>(_bits_left_aligned >> 56);
+                if (auto length = rvl_nibbles.length[byte])
+                {
+                    consume(length * 4);
+                    return rvl_nibbles.value[byte];
+                }
+
+                uint32_t value = 0;
+                for (int shift = 0; shift < 33; shift += 3)
+                {
+                    if (_bits < 4)
+                        refill();
+                    auto nibble = static_cast<uint32_t>(_bits_left_aligned >> 60);
+                    consume(4);
+                    value |= (nibble & 7) << shift;
+                    if (!(nibble & 8))
+                        return value;
+                }
+                _corrupt = true;
+                return 0;
+            }
+
+            // Whether the values read went past the end, or one of them was longer than any value
+            bool corrupt() const
+            {
+                return _corrupt || (_read > _words && (_read - _words) * 32 > size_t(_bits));
+            }
+
+        private:
+            // Words past the end read as zeros, which decode as zeros until the pixels run out
+            void refill()
+            {
+                uint32_t word = _read < _words ? load_u32(_src + _read * 4) : 0;
+                _read++;
+                _bits_left_aligned |= uint64_t(word) << (32 - _bits);
+                _bits += 32;
+            }
+
+            void consume(int bits)
+            {
+                _bits_left_aligned <<= bits;
+                _bits -= bits;
+            }
+
+            const uint8_t * _src;
+            size_t _words;
+            size_t _read = 0;
+            uint64_t _bits_left_aligned = 0;
+            int _bits = 0;
+            bool _corrupt = false;
+        };
+
+        // The run scans are vector kernels, so the long runs of holes and of valid depth are skipped
+        // over 8 or 16 pixels at a time
+        class rvl_codec : public depth_codec
+        {
+        public:
+            depth_codec_id id() const override { return depth_codec_id::rvl; }
+            const char* name() const override { return "rvl"; }
+
+            size_t encode(uint8_t * dst, size_t capacity, const uint16_t * src, size_t count) const override
+            {
+                auto& kernels = get_unpack_kernels();
+                auto bytes = reinterpret_cast<const uint8_t *>(src);
+                nibble_writer writer(dst, capacity);
+                uint16_t previous = 0;
+                size_t i = 0;
+                while (i < count && !writer.overflow())
+                {
+                    auto left = static_cast<int>(std::min<size_t>(count - i, INT32_MAX));
+                    auto zeros = kernels.find_nonzero_u16(bytes + i * 2, left);
+                    i += zeros;
+                    auto nonzeros = kernels.find_zero_u16(bytes + i * 2, left - zeros);
+                    writer.put(zeros);
+                    writer.put(nonzeros);
+                    for (auto end = i + nonzeros; i < end; i++)
+                    {
+                        writer.put(zigzag(src[i], previous));
+                        previous = src[i];
+                    }
+                }
+                return writer.finish();
+            }
+
+            void decode(uint16_t * dst, size_t count, const uint8_t * src, size_t size) const override
+            {
+                nibble_reader reader(src, size);
+                uint16_t previous = 0;
+                size_t i = 0;
+                while (i < count)
+                {
+                    size_t zeros = reader.get();
+                    if (zeros > count - i)
+                        throw_corrupt(*this);
+                    memset(dst + i, 0, zeros * sizeof(uint16_t));
+                    i += zeros;
+
+                    size_t nonzeros = reader.get();
+                    if (nonzeros > count - i)
+                        throw_corrupt(*this);
+                    for (auto end = i + nonzeros; i < end; i++)
+                        dst[i] = previous = unzigzag(reader.get(), previous);
+
+                    if (reader.corrupt())
+                        throw_corrupt(*this);
+                }
+            }
+        };
+
+        ///////////////////////////////////////////////////////////////////////
+        // Bit planes: blocks of 64 zigzag deltas, as many planes as they    //
+        // take                                                              //
+        ///////////////////////////////////////////////////////////////////////
+
+        // Each block is a byte of its plane count, with ALL_ZEROS when it is a hole alone, and HAS_HOLES
+        // when it is partly one. The holes of such a block follow as a mask of its valid pixels, then
+        // the planes of its deltas. A hole has no delta, each pixel's being from the last valid one
+        // before it, so the edges of holes cost nothing. The last block is padded with its last pixel
+        class bitplane_codec : public depth_codec
+        {
+        public:
+            static const int BLOCK = 64;
+            static const uint8_t HAS_HOLES = 0x80;
+            static const uint8_t ALL_ZEROS = 0x40;
+
+            depth_codec_id id() const override { return depth_codec_id::bitplane; }
+            const char* name() const override { return "bitplane"; }
+
+            size_t encode(uint8_t * dst, size_t capacity, const uint16_t * src, size_t count) const override
+            {
+                auto& kernels = get_unpack_kernels();
+                auto out = dst, end = dst + capacity;
+                uint16_t block[BLOCK], residuals[BLOCK];
+                uint64_t planes[16];
+                uint16_t previous = 0;
+
+                for (size_t i = 0; i < count; i += BLOCK)
+                {
+                    auto pixels = src + i;
+                    if (count - i < BLOCK)
+                    {
+                        auto n = count - i;
+                        std::copy(pixels, pixels + n, block);
+                        std::fill(block + n, block + BLOCK, pixels[n - 1]);
+                        pixels = block;
+                    }
+
+                    uint64_t valid = 0;
+                    uint32_t bits_used = 0;
+                    for (int j = 0; j < BLOCK; j++)
+                    {
+                        auto value = pixels[j];
+                        uint32_t residual = 0;
+                        if (value)
+                        {
+                            residual = zigzag(value, previous);
+                            previous = value;
+                            valid |= uint64_t(1) << j;
+                        }
+                        residuals[j] = static_cast<uint16_t>(residual);
+                        bits_used |= residual;
+                    }
+
+                    int bits = 0;
+                    while (bits_used >> bits)
+                        bits++;
+
+                    auto holes = valid != ~uint64_t(0);
+                    size_t block_size = !valid ? 1 : 1 + (holes ? 8 : 0) + bits * 8;
+                    if (size_t(end - out) < block_size)
+                        return 0;
+
+                    if (!valid)
+                    {
+                        *out++ = ALL_ZEROS;
+                        continue;
+                    }
+                    *out++ = static_cast<uint8_t>(bits | (holes ? HAS_HOLES : 0));
+                    if (holes)
+                    {
+                        store_u64(out, valid);
+                        out += 8;
+                    }
+                    kernels.bitplane_pack(planes, residuals, bits);
+                    for (int b = 0; b < bits; b++, out += 8)
+                        store_u64(out, planes[b]);
+                }
+                return out - dst;
+            }
+
+            void decode(uint16_t * dst, size_t count, const uint8_t * src, size_t size) const override
+            {
+                auto& kernels = get_unpack_kernels();
+                auto in = src, end = src + size;
+                uint16_t block[BLOCK], residuals[BLOCK];
+                uint64_t planes[16];
+                uint16_t previous = 0;
+
+                for (size_t i = 0; i < count; i += BLOCK)
+                {
+                    auto pixels = count - i < BLOCK ? block : dst + i;
+                    if (in == end)
+                        throw_corrupt(*this);
+                    auto flags = *in++;
+                    if (flags == ALL_ZEROS)
+                    {
+                        std::fill(pixels, pixels + BLOCK, 0);
+                    }
+                    else
+                    {
+                        int bits = flags & 0x1f;
+                        auto holes = (flags & HAS_HOLES) != 0;
+                        if (bits > 16 || (flags & ~(HAS_HOLES | 0x1f)) || size_t(end - in) < (holes ? 8u : 0u) + bits * 8)
+                            throw_corrupt(*this);
+
+                        uint64_t valid = ~uint64_t(0);
+                        if (holes)
+                        {
+                            valid = load_u64(in);
+                            in += 8;
+                        }
+                        for (int b = 0; b < bits; b++, in += 8)
+                            planes[b] = load_u64(in);
+                        kernels.bitplane_unpack(residuals, planes, bits);
+
+                        if (!holes)
+                        {
+                            for (int j = 0; j < BLOCK; j++)
+                                pixels[j] = previous = unzigzag(residuals[j], previous);
+                        }
+                        else
+                        {
+                            for (int j = 0; j < BLOCK; j++)
+                            {
+                                if ((valid >> j) & 1)
+                                    pixels[j] = previous = unzigzag(residuals[j], previous);
+                                else
+                                    pixels[j] = 0;
+                            }
+                        }
+                    }
+
+                    if (pixels == block)
+                        std::copy(block, block + (count - i), dst + i);
+                }
+                if (in != end)
+                    throw_corrupt(*this);
+            }
+        };
+
+        class lz4_codec : public depth_codec
+        {
+        public:
+            depth_codec_id id() const override { return depth_codec_id::lz4; }
+            const char* name() const override { return "lz4"; }
+
+            size_t encode(uint8_t * dst, size_t capacity, const uint16_t * src, size_t count) const override
+            {
+                auto size = LZ4_compress_default(reinterpret_cast<const char *>(src), reinterpret_cast<char *>(dst),
+                    static_cast<int>(count * sizeof(uint16_t)), static_cast<int>(std::min<size_t>(capacity, INT32_MAX)));
+                return size > 0 ? size_t(size) : 0;
+            }
+
+            void decode(uint16_t * dst, size_t count, const uint8_t * src, size_t size) const override
+            {
+                auto expected = static_cast<int>(count * sizeof(uint16_t));
+                if (LZ4_decompress_safe(reinterpret_cast<const char *>(src), reinterpret_cast<char *>(dst), static_cast<int>(size), expected) != expected)
+                    throw_corrupt(*this);
+            }
+        };
+
+#ifdef RS2_USE_ZSTD
+        class zstd_codec : public depth_codec
+        {
+        public:
+            depth_codec_id id() const override { return depth_codec_id::zstd; }
+            const char* name() const override { return "zstd"; }
+
+            size_t encode(uint8_t * dst, size_t capacity, const uint16_t * src, size_t count) const override
+            {
+                auto size = ZSTD_compress(dst, capacity, src, count * sizeof(uint16_t), 1);
+                return ZSTD_isError(size) ? 0 : size;
+            }
+
+            void decode(uint16_t * dst, size_t count, const uint8_t * src, size_t size) const override
+            {
+                auto expected = count * sizeof(uint16_t);
+                if (ZSTD_decompress(dst, expected, src, size) != expected)
+                    throw_corrupt(*this);
+            }
+        };
+#endif
+    }
+
+    depth_codec_registry::depth_codec_registry()
+    {
+        _codecs.push_back(std::make_shared<raw_codec>());
+        _codecs.push_back(std::make_shared<rvl_codec>());
+        _codecs.push_back(std::make_shared<bitplane_codec>());
+        _codecs.push_back(std::make_shared<lz4_codec>());
+#ifdef RS2_USE_ZSTD
+        _codecs.push_back(std::make_shared<zstd_codec>());
+#endif
+    }
+
+    depth_codec_registry& depth_codec_registry::instance()
+    {
+        static depth_codec_registry registry;
+        return registry;
+    }
+
+    void depth_codec_registry::add(std::shared_ptr<depth_codec> codec)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = std::find_if(_codecs.begin(), _codecs.end(), [&](const std::shared_ptr<depth_codec>& c) { return c->id() >= codec->id(); });
+        if (it != _codecs.end() && (*it)->id() == codec->id())
+            *it = codec;
+        else
+            _codecs.insert(it, codec);
+    }
+
+    std::shared_ptr<depth_codec> depth_codec_registry::find(depth_codec_id id) const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto&& c : _codecs)
+        {
+            if (c->id() == id)
+                return c;
+        }
+        return nullptr;
+    }
+
+    std::shared_ptr<depth_codec> depth_codec_registry::find(const std::string& name) const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto&& c : _codecs)
+        {
+            if (name == c->name())
+                return c;
+        }
+        return nullptr;
+    }
+
+    std::vector<std::string> depth_codec_registry::names() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::vector<std::string> result;
+        for (auto&& c : _codecs)
+        {
+            if (c->id() != depth_codec_id::raw)
+                result.push_back(c->name());
+        }
+        return result;
+    }
+
+    std::vector<std::shared_ptr<depth_codec>> depth_codec_registry::select(const std::string& names) const
+    {
+        std::vector<std::shared_ptr<depth_codec>> result;
+        if (names.empty())
+        {
+            for (auto&& name : this->names())
+                result.push_back(find(name));
+            return result;
+        }
+
+        std::istringstream list(names);
+        std::string name;
+        while (std::getline(list, name, ','))
+        {
+            name.erase(0, name.find_first_not_of(' '));
+            name.erase(name.find_last_not_of(' ') + 1);
+            auto codec = find(name);
+            if (codec && std::find(result.begin(), result.end(), codec) == result.end())
+                result.push_back(codec);
+        }
+        return result;
+    }
+
+    void depth_frame_header::write(uint8_t * dst) const
+    {
+        dst[0] = 'Z';
+        dst[1] = 'C';
+        dst[2] = VERSION;
+        dst[3] = static_cast<uint8_t>(codec);
+        store_u32(dst + 4, pixels);
+        store_u32(dst + 8, payload);
+    }
+
+    bool depth_frame_header::read(const uint8_t * src, size_t size, depth_frame_header& header)
+    {
+        if (size < SIZE || src[0] != 'Z' || src[1] != 'C' || src[2] != VERSION)
+            return false;
+        header.codec = static_cast<depth_codec_id>(src[3]);
+        header.pixels = load_u32(src + 4);
+        header.payload = load_u32(src + 8);
+        return true;
+    }
+
+    depth_frame_encoder::depth_frame_encoder(const std::string& codecs, int probe_interval)
+        : _codecs(depth_codec_registry::instance().select(codecs)), _probe_interval(probe_interval)
+    {
+        if (_codecs.empty())
+            throw invalid_value_exception(to_string() << "none of the depth codecs \"" << codecs << "\" is available");
+        _current = _codecs.front();
+    }
+
+    size_t depth_frame_encoder::encode(uint8_t * dst, const uint16_t * src, size_t count)
+    {
+        if (_codecs.size() > 1 && _probe_interval > 0 && (count != _last_count || --_frames_to_probe <= 0))
+        {
+            _last_count = count;
+            _frames_to_probe = _probe_interval;
+            _scratch.resize(max_encoded_size(count));
+
+            size_t best = 0;
+            for (auto&& codec : _codecs)
+            {
+                auto size = encode_with(*codec, _scratch.data(), src, count);
+                if (!best || size < best)
+                {
+                    best = size;
+                    _current = codec;
+                    memcpy(dst, _scratch.data(), size);
+                }
+            }
+            return best;
+        }
+
+        _last_count = count;
+        return encode_with(*_current, dst, src, count);
+    }
+
+    size_t depth_frame_encoder::encode_with(const depth_codec& codec, uint8_t * dst, const uint16_t * src, size_t count)
+    {
+        depth_frame_header header{ codec.id(), static_cast<uint32_t>(count), 0 };
+        auto raw_size = count * sizeof(uint16_t);
+        auto payload = dst + depth_frame_header::SIZE;
+
+        // Anything but smaller than the pixels is stored as they are
+        auto size = raw_size ? codec.encode(payload, raw_size - 1, src, count) : 0;
+        if (!size)
+        {
+            header.codec = depth_codec_id::raw;
+            memcpy(payload, src, raw_size);
+            size = raw_size;
+        }
+
+        header.payload = static_cast<uint32_t>(size);
+        header.write(dst);
+        return depth_frame_header::SIZE + size;
+    }
+
+    depth_codec_id decode_depth_frame(uint16_t * dst, size_t count, const uint8_t * src, size_t size)
+    {
+        depth_frame_header header;
+        if (!depth_frame_header::read(src, size, header))
+            throw invalid_value_exception("not an encoded depth frame");
+        if (header.pixels != count || header.payload > size - depth_frame_header::SIZE)
+            throw invalid_value_exception(to_string() << "encoded depth frame of " << header.pixels << " pixels and "
+                << header.payload << " bytes does not fit " << count << " pixels in " << size << " bytes");
+
+        auto codec = depth_codec_registry::instance().find(header.codec);
+        if (!codec)
+            throw invalid_value_exception(to_string() << "depth frame of codec " << int(header.codec) << ", which this build does not have");
+        codec->decode(dst, count, src + depth_frame_header::SIZE, header.payload);
+        return header.codec;
+    }
+
+    depth_encoder::depth_encoder(const std::string& codecs)
+        : functional_processing_block("Depth Encoder", RS2_FORMAT_Z16C, RS2_STREAM_DEPTH, RS2_EXTENSION_VIDEO_FRAME),
+        _encoder(codecs)
+    {
+        get_option(RS2_OPTION_STREAM_FILTER).set(RS2_STREAM_DEPTH);
+        get_option(RS2_OPTION_STREAM_FORMAT_FILTER).set(RS2_FORMAT_Z16);
+    }
+
+    rs2::frame depth_encoder::prepare_frame(const rs2::frame_source& source, const rs2::frame& f)
+    {
+        init_profiles_info(&f);
+        auto vf = f.as<rs2::video_frame>();
+        int width = vf.get_width();
+        int height = vf.get_height();
+        int stride = width * _target_bpp + int((depth_frame_header::SIZE + height - 1) / height);
+        return source.allocate_video_frame(_target_stream_profile, f, _target_bpp, width, height, stride, _extension_type);
+    }
+
+    void depth_encoder::process_function(byte * const dest[], const byte * source, int width, int height, int actual_size, int input_size)
+    {
+        _encoder.encode(dest[0], reinterpret_cast<const uint16_t *>(source), size_t(width) * height);
+    }
+
+    depth_decoder::depth_decoder()
+        : functional_processing_block("Depth Decoder", RS2_FORMAT_Z16, RS2_STREAM_DEPTH, RS2_EXTENSION_DEPTH_FRAME)
+    {
+        get_option(RS2_OPTION_STREAM_FILTER).set(RS2_STREAM_DEPTH);
+        get_option(RS2_OPTION_STREAM_FORMAT_FILTER).set(RS2_FORMAT_Z16C);
+    }
+
+    rs2::frame depth_decoder::process_frame(const rs2::frame_source& source, const rs2::frame& f)
+    {
+        auto ret = prepare_frame(source, f);
+        auto vf = ret.as<rs2::video_frame>();
+        byte* planes[1] = { static_cast<byte *>(const_cast<void *>(ret.get_data())) };
+
+        // The encoded size is that of the frame, the size of the payload being in its header
+        process_function(planes, static_cast<const byte *>(f.get_data()), vf.get_width(), vf.get_height(), 0, f.get_data_size());
+        return ret;
+    }
+
+    void depth_decoder::process_function(byte * const dest[], const byte * source, int width, int height, int actual_size, int input_size)
+    {
+        try
+        {
+            decode_depth_frame(reinterpret_cast<uint16_t *>(dest[0]), size_t(width) * height, source, size_t(input_size));
+        }
+        catch (const std::exception& e)
+        {
+            LOG_INFO("Depth decoding failed, ts: " << static_cast<uint64_t>(environment::get_instance().get_time_service()->get_time())
+                << " , " << e.what());
+        }
+    }
+}
@@ -0,0 +1,145 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#pragma once
+
+#include "proc/synthetic-stream.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace librealsense
+{
+    // Lossless codecs for Z16 depth, shared by the depth encoder and decoder blocks and by the network
+    // device. Each encoded frame starts with a header naming its codec, so the codec may change from
+    // one frame to the next and a decoder takes whichever came
+    enum class depth_codec_id : uint8_t
+    {
+        raw = 0,
+        rvl = 1,        // zero runs and nibble-coded deltas
+        bitplane = 2,   // zigzag deltas in bit planes of 64 pixels
+        lz4 = 3,
+        zstd = 4,       // when built with libzstd
+    };
+
+    class depth_codec
+    {
+    public:
+        virtual ~depth_codec() = default;
+
+        virtual depth_codec_id id() const = 0;
+        virtual const char* name() const = 0;
+
+        // Returns the size written to dst, or 0 when the pixels take more than capacity bytes encoded
+        virtual size_t encode(uint8_t * dst, size_t capacity, const uint16_t * src, size_t count) const = 0;
+
+        // Throws when src is not count pixels encoded by this codec
+        virtual void decode(uint16_t * dst, size_t count, const uint8_t * src, size_t size) const = 0;
+    };
+
+    // The codecs by id and by name, the built-in ones registered up front
+    class depth_codec_registry
+    {
+    public:
+        static depth_codec_registry& instance();
+
+        // Takes the place of a codec of the same id
+        void add(std::shared_ptr<depth_codec> codec);
+
+        std::shared_ptr<depth_codec> find(depth_codec_id id) const;
+        std::shared_ptr<depth_codec> find(const std::string& name) const;
+
+        // All but raw, in the order of their ids
+        std::vector<std::string> names() const;
+
+        // The codecs of a comma-separated list of names, in its order, leaving out the names not
+        // registered. An empty list takes all but raw
+        std::vector<std::shared_ptr<depth_codec>> select(const std::string& names) const;
+
+    private:
+        depth_codec_registry();
+
+        mutable std::mutex _mutex;
+        std::vector<std::shared_ptr<depth_codec>> _codecs;
+    };
+
+    // The header before each encoded frame: "ZC", its version, the codec id, and the pixel count and
+    // the payload size as 32-bit little-endian
+    struct depth_frame_header
+    {
+        static const size_t SIZE = 12;
+        static const uint8_t VERSION = 1;
+
+        depth_codec_id codec;
+        uint32_t pixels;
+        uint32_t payload;
+
+        void write(uint8_t * dst) const;
+
+        // False when src does not start with a header of this version
+        static bool read(const uint8_t * src, size_t size, depth_frame_header& header);
+    };
+
+    // Encodes the frames of a stream with the codecs a receiver takes, given in order of preference.
+    // Every codec encodes the first frame, and again every probe_interval frames and whenever the frame
+    // size changes, and the one giving the smallest frame encodes the frames that follow. A probe
+    // interval of 0 keeps the first codec. Frames the codec does not make smaller are stored raw
+    class depth_frame_encoder
+    {
+    public:
+        explicit depth_frame_encoder(const std::string& codecs = "", int probe_interval = 30);
+
+        // The most a frame of count pixels takes encoded: the header and the pixels stored raw
+        static size_t max_encoded_size(size_t count) { return depth_frame_header::SIZE + count * sizeof(uint16_t); }
+
+        // dst holds max_encoded_size(count) bytes. Returns the size written
+        size_t encode(uint8_t * dst, const uint16_t * src, size_t count);
+
+        // The codec the next frame is encoded with
+        depth_codec_id current() const { return _current ? _current->id() : depth_codec_id::raw; }
+
+    private:
+        size_t encode_with(const depth_codec& codec, uint8_t * dst, const uint16_t * src, size_t count);
+
+        std::vector<std::shared_ptr<depth_codec>> _codecs;
+        std::shared_ptr<depth_codec> _current;
+        int _probe_interval;
+        int _frames_to_probe = 0;
+        size_t _last_count = 0;
+        std::vector<uint8_t> _scratch;
+    };
+
+    // Decodes a frame of any registered codec, returning its codec. Throws when src is not an encoded
+    // frame of count pixels
+    depth_codec_id decode_depth_frame(uint16_t * dst, size_t count, const uint8_t * src, size_t size);
+
+    // Z16 depth to Z16C frames, which keep the width and height of their depth and have rows wide
+    // enough for the header too
+    class depth_encoder : public functional_processing_block
+    {
+    public:
+        explicit depth_encoder(const std::string& codecs = "");
+
+    protected:
+        rs2::frame prepare_frame(const rs2::frame_source& source, const rs2::frame& f) override;
+        void process_function(byte * const dest[], const byte * source, int width, int height, int actual_size, int input_size) override;
+
+    private:
+        depth_frame_encoder _encoder;
+    };
+
+    // Z16C frames of any codec back to Z16 depth
+    class depth_decoder : public functional_processing_block
+    {
+    public:
+        depth_decoder();
+
+    protected:
+        rs2::frame process_frame(const rs2::frame_source& source, const rs2::frame& f) override;
+        void process_function(byte * const dest[], const byte * source, int width, int height, int actual_size, int input_size) override;
+    };
+}
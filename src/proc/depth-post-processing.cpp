@@ -0,0 +1,336 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "../include/librealsense2/hpp/rs_sensor.hpp"
+#include "../include/librealsense2/hpp/rs_processing.hpp"
+
+#include <set>
+#include "proc/depth-post-processing.h"
+#include "proc/decimation-filter.h"
+#include "proc/disparity-transform.h"
+#include "proc/spatial-filter.h"
+#include "proc/temporal-filter.h"
+#include "proc/hole-filling-filter.h"
+
+namespace librealsense
+{
+    // The places of the filters in the chain
+    enum post_processing_place
+    {
+        decimation_place,
+        to_disparity_place,
+        spatial_place,
+        temporal_place,
+        to_depth_place,
+        hole_filling_place
+    };
+
+    depth_post_processing::depth_post_processing(const std::vector<std::shared_ptr<processing_block_interface>>& filters)
+        : stream_filter_processing_block("Depth Post-Processing"),
+        _stereoscopic_depth(false),
+        _d2d_convert_factor(0.f),
+        _cur_frame_index(0),
+        _temporal_profile(nullptr),
+        _temporal_disparity(false),
+        _temporal_alpha(-1.f),
+        _temporal_delta(0),
+        _temporal_persistence(0)
+    {
+        _stream_filter.stream = RS2_STREAM_DEPTH;
+        _stream_filter.format = RS2_FORMAT_Z16;
+
+        // Each filter takes the first place of its kind after the filter before it. A filter given twice
+        // would be locked twice on every frame
+        std::set<processing_block_interface*> given;
+        int next = decimation_place;
+        for (auto&& block : filters)
+        {
+            if (!block || !given.insert(block.get()).second)
+                throw invalid_value_exception("Depth post-processing takes each filter once");
+
+            auto decimation = std::dynamic_pointer_cast<decimation_filter>(block);
+            auto disparity = std::dynamic_pointer_cast<disparity_transform>(block);
+            auto spatial = std::dynamic_pointer_cast<spatial_filter>(block);
+            auto temporal = std::dynamic_pointer_cast<temporal_filter>(block);
+            auto hole_filling = std::dynamic_pointer_cast<hole_filling_filter>(block);
+
+            int place = -1;
+            if (decimation && next <= decimation_place) place = decimation_place;
+            else if (disparity && next <= to_disparity_place) place = to_disparity_place;
+            else if (spatial && next <= spatial_place) place = spatial_place;
+            else if (temporal && next <= temporal_place) place = temporal_place;
+            else if (disparity && next <= to_depth_place) place = to_depth_place;
+            else if (hole_filling && next <= hole_filling_place) place = hole_filling_place;
+
+            if (place < 0)
+                throw invalid_value_exception(to_string() << "Depth post-processing can not run "
+                    << block->get_info(RS2_CAMERA_INFO_NAME) << " here; the filters go in the order decimation, "
+                    << "depth to disparity, spatial, temporal, disparity to depth, hole filling");
+            next = place + 1;
+
+            switch (place)
+            {
+            case decimation_place: _decimation = decimation; break;
+            case to_disparity_place: _to_disparity = disparity; break;
+            case spatial_place: _spatial = spatial; break;
+            case temporal_place: _temporal = temporal; break;
+            case to_depth_place: _to_depth = disparity; break;
+            case hole_filling_place: _hole_filling = hole_filling; break;
+            }
+        }
+
+        register_processing_threads_option();
+    }
+
+    rs2::frame depth_post_processing::process_frame(const rs2::frame_source& source, const rs2::frame& f)
+    {
+        // The options of the filters hold still until the frame is out
+        std::vector<std::unique_lock<std::mutex>> locks;
+        if (_decimation) locks.emplace_back(_decimation->_mutex);
+        if (_to_disparity) locks.emplace_back(_to_disparity->_mutex);
+        if (_spatial) locks.emplace_back(_spatial->_mutex);
+        if (_temporal) locks.emplace_back(_temporal->_mutex);
+        if (_to_depth) locks.emplace_back(_to_depth->_mutex);
+        if (_hole_filling) locks.emplace_back(_hole_filling->_mutex);
+
+        auto depth = f.as<rs2::video_frame>();
+        frame_layout l;
+        l.depth = static_cast<const uint16_t*>(depth.get_data());
+        l.depth_width = depth.get_width();
+        l.width = l.real_width = depth.get_width();
+        l.height = l.real_height = depth.get_height();
+        l.temporal_mask = 0;
+
+        auto profile = f.get_profile();
+        if (_decimation)
+        {
+            _decimation->update_output_profile(f);
+            profile = _decimation->_target_stream_profile;
+            l.real_width = _decimation->_real_width;
+            l.real_height = _decimation->_real_height;
+            l.width = _decimation->_padded_width;
+            l.height = _decimation->_padded_height;
+        }
+
+        // The transforms convert frames in the domain they convert from, of stereo sensors only
+        l.disparity = _stereoscopic_depth && _to_disparity && _to_disparity->_transform_to_disparity;
+        if (profile.get() != _source_stream_profile.get())
+        {
+            auto info = disparity_info::update_info_from_frame(f, profile.as<rs2::video_stream_profile>());
+            _stereoscopic_depth = info.stereoscopic_depth;
+            _d2d_convert_factor = info.d2d_convert_factor;
+            if (_stereoscopic_depth && (!_disparity_lut || _disparity_lut->d2d_convert_factor != _d2d_convert_factor))
+                _disparity_lut = disparity_lut::get(_d2d_convert_factor);
+            l.disparity = _stereoscopic_depth && _to_disparity && _to_disparity->_transform_to_disparity;
+        }
+        bool out_disparity = l.disparity;
+        if (_stereoscopic_depth && _to_depth && _to_depth->_transform_to_disparity != l.disparity)
+            out_disparity = !l.disparity;
+        update_target_profile(profile, out_disparity);
+
+        if (_temporal)
+        {
+            update_temporal_state(l.width * l.height, l.disparity);
+            l.temporal_mask = 1 << _cur_frame_index;
+        }
+
+        const size_t bpp = out_disparity ? sizeof(float) : sizeof(uint16_t);
+        auto tgt = source.allocate_video_frame(_target_stream_profile, f, int(bpp), int(l.width), int(l.height), int(l.width * bpp),
+            out_disparity ? RS2_EXTENSION_DISPARITY_FRAME : RS2_EXTENSION_DEPTH_FRAME);
+        if (!tgt)
+            return tgt;
+
+        auto out = const_cast<void*>(tgt.get_data());
+        if (l.disparity && out_disparity)
+            filter<float, float>(l, static_cast<float*>(out));
+        else if (l.disparity)
+            filter<float, uint16_t>(l, static_cast<uint16_t*>(out));
+        else if (out_disparity)
+            filter<uint16_t, float>(l, static_cast<float*>(out));
+        else
+            filter<uint16_t, uint16_t>(l, static_cast<uint16_t*>(out));
+
+        if (_temporal)
+            _cur_frame_index = (_cur_frame_index + 1) % 8;
+        return tgt;
+    }
+
+    void depth_post_processing::update_target_profile(rs2::stream_profile profile, bool out_disparity)
+    {
+        auto format = out_disparity ? RS2_FORMAT_DISPARITY32 : RS2_FORMAT_Z16;
+        if (profile.get() != _source_stream_profile.get() || _target_stream_profile.format() != format)
+        {
+            _source_stream_profile = profile;
+            _target_stream_profile = profile.clone(RS2_STREAM_DEPTH, 0, format);
+        }
+    }
+
+    void depth_post_processing::update_temporal_state(size_t pixels, bool disparity)
+    {
+        // The history starts over where temporal_filter would start it over: on new options, and on frames
+        // of another profile or domain, which reach it in a new profile
+        bool restart = _temporal->_alpha_param != _temporal_alpha || _temporal->_delta_param != _temporal_delta;
+        if (restart)
+            _cur_frame_index = 0;
+
+        if (restart || _temporal->_persistence_param != _temporal_persistence
+            || _source_stream_profile.get() != _temporal_profile || disparity != _temporal_disparity)
+        {
+            _temporal_alpha = _temporal->_alpha_param;
+            _temporal_delta = _temporal->_delta_param;
+            _temporal_persistence = _temporal->_persistence_param;
+            _temporal_profile = _source_stream_profile.get();
+            _temporal_disparity = disparity;
+
+            _last_frame.assign(pixels * (disparity ? sizeof(float) : sizeof(uint16_t)), 0);
+            _history.assign(pixels, 0);
+        }
+    }
+
+    void depth_post_processing::convert_domain(const uint16_t* in, float* out, size_t count) const
+    {
+        disparity_transform::convert(in, out, count, *_disparity_lut);
+    }
+
+    void depth_post_processing::convert_domain(const float* in, uint16_t* out, size_t count) const
+    {
+        disparity_transform::convert(in, out, count, _d2d_convert_factor);
+    }
+
+    template<typename T, typename O>
+    void depth_post_processing::filter(const frame_layout& l, O* out)
+    {
+        const bool fp = std::is_floating_point<T>::value;
+        const bool same = std::is_same<T, O>::value;
+        const size_t width = l.width, height = l.height;
+        const size_t scale = _decimation ? _decimation->_patch_size : 1;
+
+        // Row j of the frame as the spatial filter gets it: decimated, and in disparity when converted.
+        // Decimated depth is converted in place, in the row it was decimated into
+        auto depth_row = [&](size_t j, T* row)
+        {
+            if (j >= l.real_height)
+            {
+                std::fill(row, row + width, T(0));
+                return;
+            }
+
+            const uint16_t* depth = l.depth + j * l.depth_width;
+            if (_decimation)
+            {
+                auto decimated = reinterpret_cast<uint16_t*>(row);
+                decimation_filter::decimate_depth_rows(l.depth, decimated, l.depth_width, scale, l.real_width, width, j, j + 1);
+                depth = decimated;
+            }
+
+            if (fp)
+                disparity_transform::convert(depth, reinterpret_cast<float*>(row), width, *_disparity_lut);
+            else if (depth != reinterpret_cast<uint16_t*>(row))
+                std::copy(depth, depth + width, reinterpret_cast<uint16_t*>(row));
+        };
+
+        // The stages after the spatial filter, each of them on its own pixels
+        T* last_frame = reinterpret_cast<T*>(_last_frame.data());
+        auto finish_row = [&](size_t j, T* row)
+        {
+            if (_spatial && fp && _spatial->_holes_filling_mode)
+                _spatial->intertial_holes_fill<T>(row, width, 0, 1);
+            if (_temporal)
+                _temporal->temp_jw_smooth_pixels<T>(row, last_frame + j * width, _history.data() + j * width, l.temporal_mask, 0, width);
+            if (!same)
+                convert_domain(row, out + j * width, width);
+        };
+
+        auto fill_holes = [&](size_t row_begin, size_t row_end)
+        {
+            if (_hole_filling)
+                _hole_filling->apply_hole_filling<O>(out, width, height, row_begin, row_end);
+        };
+
+        // Filling from around takes the row above as filled and the one below as not, so it runs a row behind
+        // the other stages, in order. Filling from the left stays in the row
+        const bool in_order = _hole_filling && _hole_filling->_hole_filling_mode != hf_fill_from_left;
+
+        T* frame = nullptr;
+        if (_spatial)
+        {
+            if (same)
+                frame = reinterpret_cast<T*>(out);
+            else
+            {
+                _frame.resize(width * height * sizeof(T));
+                frame = reinterpret_cast<T*>(_frame.data());
+            }
+
+            const float alpha = _spatial->_spatial_alpha_param;
+            const float delta = static_cast<float>(_spatial->_spatial_delta_param);
+            auto horizontal = [&](size_t row_begin, size_t row_end)
+            {
+                if (fp)
+                    _spatial->recursive_filter_horizontal_fp(frame, width, height, alpha, delta, row_begin, row_end);
+                else
+                    _spatial->recursive_filter_horizontal<T>(frame, width, height, alpha, delta, row_begin, row_end);
+            };
+
+            const size_t column_block = spatial_filter::COLUMN_BLOCK;
+            auto vertical = [&]()
+            {
+                parallel_for(int((width + column_block - 1) / column_block), [&](int begin, int end)
+                {
+                    auto col_begin = size_t(begin) * column_block;
+                    auto col_end = std::min(size_t(end) * column_block, width);
+                    if (fp)
+                        _spatial->recursive_filter_vertical_fp(frame, width, height, alpha, delta, col_begin, col_end);
+                    else
+                        _spatial->recursive_filter_vertical<T>(frame, width, height, alpha, delta, col_begin, col_end);
+                });
+            };
+
+            // The first horizontal pass takes each row as it comes out of decimation
+            parallel_for(int(height), [&](int begin, int end)
+            {
+                for (size_t j = begin; j < size_t(end); j++)
+                {
+                    depth_row(j, frame + j * width);
+                    horizontal(j, j + 1);
+                }
+            });
+            vertical();
+
+            for (int i = 1; i < _spatial->_spatial_iterations; i++)
+            {
+                parallel_for(int(height), [&](int begin, int end) { horizontal(begin, end); });
+                vertical();
+            }
+        }
+
+        auto output_rows = [&](size_t row_begin, size_t row_end)
+        {
+            std::vector<T> buffer(!frame && !same ? width : 0);
+            for (size_t j = row_begin; j < row_end; j++)
+            {
+                T* row;
+                if (frame)
+                    row = frame + j * width;
+                else
+                {
+                    row = same ? reinterpret_cast<T*>(out + j * width) : buffer.data();
+                    depth_row(j, row);
+                }
+                finish_row(j, row);
+
+                if (!in_order)
+                    fill_holes(j, j + 1);
+                else if (j > row_begin)
+                    fill_holes(j - 1, j);
+            }
+            if (in_order && row_end > row_begin)
+                fill_holes(row_end - 1, row_end);
+        };
+
+        if (in_order)
+            output_rows(0, height);
+        else
+            parallel_for(int(height), [&](int begin, int end) { output_rows(begin, end); });
+    }
+}
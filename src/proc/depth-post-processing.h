@@ -0,0 +1,80 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+// Runs a chain of depth post-processing filters as one block, in one pass over the frame where the filters allow
+
+#pragma once
+
+#include "../include/librealsense2/hpp/rs_frame.hpp"
+#include "../include/librealsense2/hpp/rs_processing.hpp"
+#include "synthetic-stream.h"
+
+namespace librealsense
+{
+    class decimation_filter;
+    class disparity_transform;
+    class spatial_filter;
+    class temporal_filter;
+    class hole_filling_filter;
+    struct disparity_lut;
+
+    // Takes the decimation, depth to disparity, spatial, temporal, disparity to depth and hole filling
+    // filters in this order, any of them left out, and gives the frame the chain of them would, bit for bit.
+    // The filters keep their options and are read on every frame; the frame state, temporal history
+    // included, is the block's own. Each row goes through the row-local stages while it is in cache and
+    // only the vertical passes of the spatial filter see the whole frame, so one output frame is allocated
+    // instead of one per filter
+    class depth_post_processing : public stream_filter_processing_block
+    {
+    public:
+        depth_post_processing(const std::vector<std::shared_ptr<processing_block_interface>>& filters);
+
+    protected:
+        rs2::frame process_frame(const rs2::frame_source& source, const rs2::frame& f) override;
+
+    private:
+        struct frame_layout
+        {
+            const uint16_t* depth;      // input frame
+            size_t depth_width;
+            size_t width, height;       // of the output
+            size_t real_width, real_height; // rows and columns holding decimated data, the rest are padding
+            bool disparity;             // between the disparity transforms
+            unsigned char temporal_mask;
+        };
+
+        void update_target_profile(rs2::stream_profile profile, bool out_disparity);
+        void update_temporal_state(size_t pixels, bool disparity);
+
+        template<typename T, typename O>
+        void filter(const frame_layout& l, O* out);
+
+        // The change of domain by the second transform, none for chains that end in the domain they filter in
+        void convert_domain(const uint16_t* in, float* out, size_t count) const;
+        void convert_domain(const float* in, uint16_t* out, size_t count) const;
+        template<typename T>
+        void convert_domain(const T*, T*, size_t) const {}
+
+        std::shared_ptr<decimation_filter>      _decimation;
+        std::shared_ptr<disparity_transform>    _to_disparity;
+        std::shared_ptr<spatial_filter>         _spatial;
+        std::shared_ptr<temporal_filter>        _temporal;
+        std::shared_ptr<disparity_transform>    _to_depth;
+        std::shared_ptr<hole_filling_filter>    _hole_filling;
+
+        rs2::stream_profile     _source_stream_profile;     // decimated, when decimating
+        rs2::stream_profile     _target_stream_profile;
+        bool                    _stereoscopic_depth;
+        float                   _d2d_convert_factor;
+        std::shared_ptr<const disparity_lut> _disparity_lut;
+
+        std::vector<uint8_t>    _frame;                     // the frame between the spatial passes, when not the output
+        std::vector<uint8_t>    _last_frame;                // temporal state, as in temporal_filter
+        std::vector<uint8_t>    _history;
+        uint8_t                 _cur_frame_index;
+        const rs2_stream_profile* _temporal_profile;        // the state above is for frames of this profile
+        bool                    _temporal_disparity;
+        float                   _temporal_alpha;            // options the state was gathered with
+        uint8_t                 _temporal_delta;
+        uint8_t                 _temporal_persistence;
+    };
+}
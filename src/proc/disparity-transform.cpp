@@ -15,6 +15,40 @@
 
 namespace librealsense
 {
+    std::shared_ptr<const disparity_lut> disparity_lut::get(float d2d_convert_factor)
+    {
+        static std::mutex mutex;
+        static std::vector<std::weak_ptr<const disparity_lut>> cache;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        std::shared_ptr<const disparity_lut> lut;
+        for (auto it = cache.begin(); it != cache.end();)
+        {
+            auto cached = it->lock();
+            if (!cached)
+            {
+                it = cache.erase(it);
+                continue;
+            }
+            if (cached->d2d_convert_factor == d2d_convert_factor)
+                lut = cached;
+            ++it;
+        }
+
+        if (!lut)
+        {
+            auto table = std::make_shared<disparity_lut>();
+            table->d2d_convert_factor = d2d_convert_factor;
+            table->disparity.resize(std::numeric_limits<uint16_t>::max() + 1);
+            table->disparity[0] = 0;
+            for (size_t depth = 1; depth < table->disparity.size(); depth++)
+                table->disparity[depth] = d2d_convert_factor / static_cast<float>(depth);
+            lut = table;
+            cache.push_back(lut);
+        }
+        return lut;
+    }
+
     disparity_transform::disparity_transform(bool transform_to_disparity):
         generic_processing_block(transform_to_disparity ? "Depth to Disparity" : "Disparity to Depth"),
         _transform_to_disparity(transform_to_disparity),
@@ -70,12 +104,18 @@ namespace librealsense
 
         if (_stereoscopic_depth && (tgt = prepare_target_frame(f, source)))
         {
-            auto src = f.as<rs2::video_frame>();
+            auto src = f.get_data();
+            auto dst = const_cast<void*>(tgt.get_data());
+            const size_t count = _width * _height;
 
             if (_transform_to_disparity)
-                convert<uint16_t, float>(src.get_data(), const_cast<void*>(tgt.get_data()));
+            {
+                if (!_lut || _lut->d2d_convert_factor != _d2d_convert_factor)
+                    _lut = disparity_lut::get(_d2d_convert_factor);
+                convert(static_cast<const uint16_t*>(src), static_cast<float*>(dst), count, *_lut);
+            }
             else
-                convert<float, uint16_t>(src.get_data(), const_cast<void*>(tgt.get_data()));
+                convert(static_cast<const float*>(src), static_cast<uint16_t*>(dst), count, _d2d_convert_factor);
         }
 
         return tgt;
@@ -8,9 +8,21 @@
 #include "../include/librealsense2/hpp/rs_frame.hpp"
 #include "../include/librealsense2/hpp/rs_processing.hpp"
 #include "synthetic-stream.h"
+#include "image-simd.h"
 
 namespace librealsense
 {
+    // The disparity of every 16-bit depth for one conversion factor, 0 for no depth, as dividing the
+    // factor by the depth gives it. Transforms of the same factor share one table for as long as any
+    // of them holds it
+    struct disparity_lut
+    {
+        float d2d_convert_factor;
+        std::vector<float> disparity;
+
+        static std::shared_ptr<const disparity_lut> get(float d2d_convert_factor);
+    };
+
     class disparity_transform : public generic_processing_block
     {
     public:
@@ -18,36 +30,24 @@ namespace librealsense
         bool should_process(const rs2::frame& frame) override;
         rs2::frame process_frame(const rs2::frame_source& source, const rs2::frame& f) override;
 
-    protected:
-        rs2::frame prepare_target_frame(const rs2::frame& f, const rs2::frame_source& source);
-
-        template<typename Tin, typename Tout>
-        void convert(const void* in_data, void* out_data)
+        // Depth to disparity through the table, disparity to depth by division, with the vector kernels.
+        // Either converts in place when in and out are one buffer, large enough for the disparity
+        static void convert(const uint16_t* in, float* out, size_t count, const disparity_lut& lut)
         {
-            static_assert((std::is_arithmetic<Tin>::value), "disparity transform requires numeric type for input data");
-            static_assert((std::is_arithmetic<Tout>::value), "disparity transform requires numeric type for output data");
-
-            auto in = reinterpret_cast<const Tin*>(in_data);
-            auto out = reinterpret_cast<Tout*>(out_data);
-
-            bool fp = (std::is_floating_point<Tin>::value);
-            const float round = fp ? 0.5f : 0.f;
+            get_unpack_kernels().depth_to_disparity(out, in, int(count), lut.disparity.data());
+        }
 
-            float input{};
-            //TODO SSE optimize
-            for (auto i = 0; i < _height; i++)
-                for (auto j = 0; j < _width; j++)
-                {
-                    input = *in;
-                    if (std::isnormal(input))
-                        *out++ = static_cast<Tout>((_d2d_convert_factor / input)+round);
-                    else
-                        *out++ = 0;
-                    in++;
-                }
+        static void convert(const float* in, uint16_t* out, size_t count, float d2d_convert_factor)
+        {
+            get_unpack_kernels().disparity_to_depth(out, in, int(count), d2d_convert_factor);
         }
 
+    protected:
+        rs2::frame prepare_target_frame(const rs2::frame& f, const rs2::frame_source& source);
+
     private:
+        friend class depth_post_processing;
+
         void    update_transformation_profile(const rs2::frame& f);
 
         void    on_set_mode(bool to_disparity);
@@ -60,6 +60,7 @@ namespace librealsense
         float                   _stereo_baseline_meter; // in meters
         float                   _depth_units;
         float                   _d2d_convert_factor;
+        std::shared_ptr<const disparity_lut> _lut;
         size_t                  _width, _height;
         size_t                  _bpp;
     };
@@ -75,6 +76,13 @@ namespace librealsense
         };
 
         static info update_info_from_frame(const rs2::frame& f)
+        {
+            return update_info_from_frame(f, f.get_profile().as<rs2::video_stream_profile>());
+        }
+
+        // As above, for a frame about to be resized into the given profile: the focal length is
+        // that of the profile, so that blocks producing a decimated frame can convert it in place
+        static info update_info_from_frame(const rs2::frame& f, const rs2::video_stream_profile& vp)
         {
             // Check if the new frame originated from stereo-based depth sensor
             // and retrieve the stereo baseline parameter that will be used in transformations
@@ -107,7 +115,6 @@ namespace librealsense
 
             if (info.stereoscopic_depth)
             {
-                auto vp = f.get_profile().as<rs2::video_stream_profile>();
                 auto focal_lenght_mm = vp.get_intrinsics().fx;
                 const uint8_t fractional_bits = 5;
                 const uint8_t fractions = 1 << fractional_bits;
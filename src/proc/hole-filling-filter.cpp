@@ -49,6 +49,7 @@ namespace librealsense
         });
 
         register_option(RS2_OPTION_HOLES_FILL, hole_filling_mode);
+        register_processing_threads_option();
     }
 
     rs2::frame hole_filling_filter::process_frame(const rs2::frame_source& source, const rs2::frame& f)
@@ -56,11 +57,21 @@ namespace librealsense
         update_configuration(f);
         auto tgt = prepare_target_frame(f, source);
 
-        // Hole filling pass
-        if (_extension_type == RS2_EXTENSION_DISPARITY_FRAME)
-            apply_hole_filling<float>(const_cast<void*>(tgt.get_data()));
+        // Hole filling pass. Rows filled from the left are independent of each other, while filling
+        // from around takes the row above as filled and goes down the frame in order
+        auto data = const_cast<void*>(tgt.get_data());
+        auto fill = [&](int begin, int end)
+        {
+            if (_extension_type == RS2_EXTENSION_DISPARITY_FRAME)
+                apply_hole_filling<float>(data, _width, _height, begin, end);
+            else
+                apply_hole_filling<uint16_t>(data, _width, _height, begin, end);
+        };
+
+        if (_hole_filling_mode == hf_fill_from_left)
+            parallel_for(int(_height), fill);
         else
-            apply_hole_filling<uint16_t>(const_cast<void*>(tgt.get_data()));
+            fill(0, int(_height));
 
         return tgt;
     }
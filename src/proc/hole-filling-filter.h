@@ -4,6 +4,7 @@
 #pragma once
 
 #include "synthetic-stream.h"
+#include "image-simd.h"
 
 namespace librealsense
 {
@@ -26,23 +27,24 @@ namespace librealsense
 
         rs2::frame prepare_target_frame(const rs2::frame& f, const rs2::frame_source& source);
 
+        // Fills rows [row_begin, row_end) of a width x height image. Filling from around reads the
+        // rows above and below, the one above as filled already
         template<typename T>
-        void apply_hole_filling(void * image_data)
+        void apply_hole_filling(void * image_data, size_t width, size_t height, size_t row_begin, size_t row_end)
         {
-            bool fp = (std::is_floating_point<T>::value);
             T* data = reinterpret_cast<T*>(image_data);
 
             // Select and apply the appropriate hole filling method
             switch (_hole_filling_mode)
             {
             case hf_fill_from_left:
-                holes_fill_left(data, _width, _height, _stride);
+                holes_fill<hf_fill_from_left>(data, width, height, row_begin, row_end);
                 break;
             case hf_farest_from_around:
-                holes_fill_farest(data, _width, _height, _stride);
+                holes_fill<hf_farest_from_around>(data, width, height, row_begin, row_end);
                 break;
             case hf_nearest_from_around:
-                holes_fill_nearest(data, _width, _height, _stride);
+                holes_fill<hf_nearest_from_around>(data, width, height, row_begin, row_end);
                 break;
             default:
                 throw invalid_value_exception(to_string()
@@ -50,115 +52,66 @@ namespace librealsense
             }
         }
 
-        // Implementations of the hole-filling methods
-        template<typename T>
-        inline void holes_fill_left(T* image_data, size_t width, size_t height, size_t stride)
+        // A disparity pixel is a hole when all its bits are zero, so -0.f is not one
+        static inline bool is_hole(uint16_t value) { return !value; }
+        static inline bool is_hole(float value)
         {
-            std::function<bool(T*)> fp_oper = [](T* ptr) { return !*((int *)ptr); };
-            std::function<bool(T*)> uint_oper = [](T* ptr) { return !(*ptr); };
-            auto empty = (std::is_floating_point<T>::value) ? fp_oper : uint_oper;
-
-            T* p = image_data;
-
-            for (int j = 0; j < height; ++j)
-            {
-                ++p;
-                for (int i = 1; i < width; ++i)
-                {
-                    if (empty(p))
-                        *p = *(p - 1);
-                    ++p;
-                }
-            }
+            uint32_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+            return !bits;
         }
 
-        template<typename T>
-        inline void holes_fill_farest(T* image_data, size_t width, size_t height, size_t stride)
+        // What fills the hole at p: the pixel to the left, or the farest or nearest of the five
+        // neighbours above, to the left and below, starting from the one above
+        template<uint8_t MODE, typename T>
+        static inline T fill_value(const T* p, ptrdiff_t width)
         {
-            std::function<bool(T*)> fp_oper = [](T* ptr) { return !*((int *)ptr); };
-            std::function<bool(T*)> uint_oper = [](T* ptr) { return !(*ptr); };
-            auto empty = (std::is_floating_point<T>::value) ? fp_oper : uint_oper;
+            if (MODE == hf_fill_from_left)
+                return p[-1];
 
-            T tmp = 0;
-            T * p = image_data + width;
-            T * q = nullptr;
-            for (int j = 1; j < height - 1; ++j)
+            T tmp = p[-width];
+            const T around[] = { p[-width - 1], p[-1], p[width - 1], p[width] };
+            for (auto q : around)
             {
-                ++p;
-                for (int i = 1; i < width; ++i)
-                {
-                    if (empty(p))
-                    {
-                        tmp = *(p - width);
-
-                        q = p - width - 1;
-                        if (*q > tmp)
-                            tmp = *q;
-
-                        q = p - 1;
-                        if (*q > tmp)
-                            tmp = *q;
-
-                        q = p + width - 1;
-                        if (*q > tmp)
-                            tmp = *q;
-
-                        q = p + width;
-                        if (*q > tmp)
-                            tmp = *q;
-
-                        *p = tmp;
-                    }
-
-                    p++;
-                }
+                if (MODE == hf_farest_from_around ? q > tmp : !is_hole(q) && q < tmp)
+                    tmp = q;
             }
+            return tmp;
         }
 
-        template<typename T>
-        inline void holes_fill_nearest(T* image_data, size_t width, size_t height, size_t stride)
+        // One instantiation per mode and pixel type. Each row is scanned for holes with the vector
+        // kernels and the runs of them found are filled left to right, so a hole sees the holes before
+        // it filled. The first column is never filled
+        template<uint8_t MODE, typename T>
+        void holes_fill(T* image_data, size_t width, size_t height, size_t row_begin, size_t row_end)
         {
-            std::function<bool(T*)> fp_oper = [](T* ptr) { return !*((int *)ptr); };
-            std::function<bool(T*)> uint_oper = [](T* ptr) { return !(*ptr); };
-            auto empty = (std::is_floating_point<T>::value) ? fp_oper : uint_oper;
+            const bool around = MODE != hf_fill_from_left;
+            auto& kernels = get_unpack_kernels();
+            auto find_hole = sizeof(T) == sizeof(uint16_t) ? kernels.find_zero_u16 : kernels.find_zero_u32;
+
+            // From around, the first and last rows have no neighbours on one side and are left as they are
+            const size_t first = around ? std::max<size_t>(row_begin, 1) : row_begin;
+            const size_t last = around ? std::min<size_t>(row_end, height - 1) : row_end;
+            if (width < 2)
+                return;
 
-            T tmp = 0;
-            T * p = image_data + width;
-            T * q = nullptr;
-            for (int j = 1; j < height - 1; ++j)
+            for (size_t j = first; j < last; ++j)
             {
-                ++p;
-                for (int i = 1; i < width; ++i)
+                T* row = image_data + j * width;
+                size_t i = 1;
+                while (true)
                 {
-                    if (empty(p))
-                    {
-                        tmp = *(p - width);
-
-                        q = p - width - 1;
-                        if (!empty(q) && (*q < tmp))
-                            tmp = *q;
-
-                        q = p - 1;
-                        if (!empty(q) && (*q < tmp))
-                            tmp = *q;
-
-                        q = p + width - 1;
-                        if (!empty(q) && (*q < tmp))
-                            tmp = *q;
-
-                        q = p + width;
-                        if (!empty(q) && (*q < tmp))
-                            tmp = *q;
-
-                        *p = tmp;
-                    }
-
-                    p++;
+                    i += find_hole(reinterpret_cast<const uint8_t*>(row + i), int(width - i));
+                    if (i == width)
+                        break;
+                    for (; i < width && is_hole(row[i]); ++i)
+                        row[i] = fill_value<MODE>(row + i, ptrdiff_t(width));
                 }
             }
         }
 
     private:
+        friend class depth_post_processing;
 
         size_t                  _width, _height, _stride;
         size_t                  _bpp;
@@ -0,0 +1,916 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "mjpeg-decoder.h"
+
+#include "thread-pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+#ifdef RS2_USE_TURBOJPEG
+#include <turbojpeg.h>
+#endif
+
+namespace librealsense
+{
+    namespace
+    {
+        // Natural order index of each zigzag position
+        const uint8_t zigzag[64] = {
+             0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+            12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+            35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+            58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63 };
+
+        // The typical Huffman tables of the JPEG standard (Annex K.3). UVC cameras commonly
+        // leave the DHT segment out of their MJPEG frames and expect these
+        const uint8_t dc_luma_bits[16] = { 0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0 };
+        const uint8_t dc_chroma_bits[16] = { 0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0 };
+        const uint8_t dc_values[12] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+
+        const uint8_t ac_luma_bits[16] = { 0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d };
+        const uint8_t ac_luma_values[162] = {
+            0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+            0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+            0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+            0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+            0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+            0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+            0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+            0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+            0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+            0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+            0xf9, 0xfa };
+
+        const uint8_t ac_chroma_bits[16] = { 0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77 };
+        const uint8_t ac_chroma_values[162] = {
+            0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+            0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+            0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+            0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+            0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+            0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+            0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5,
+            0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+            0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+            0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+            0xf9, 0xfa };
+
+        // JFIF YCbCr to RGB, scaled by 2^14
+        const int CR_R = 22970, CB_G = -5638, CR_G = -11700, CB_B = 29032;
+
+        inline uint8_t clamp_u8(int v) { return static_cast<uint8_t>(v < 0 ? 0 : v > 255 ? 255 : v); }
+        inline int16_t clamp_s16(int v) { return static_cast<int16_t>(v < -32768 ? -32768 : v > 32767 ? 32767 : v); }
+
+        inline int read_u16(const uint8_t* p) { return p[0] << 8 | p[1]; }
+
+        int gcd(int a, int b) { while (b) { int t = a % b; a = b; b = t; } return a; }
+
+        inline uint64_t load_big_endian_64(const uint8_t* p)
+        {
+            uint64_t x;
+            std::memcpy(&x, p, sizeof(x));
+#ifdef _MSC_VER
+            return _byteswap_uint64(x);
+#else
+            return __builtin_bswap64(x);
+#endif
+        }
+
+        inline bool has_ff_byte(uint64_t x)
+        {
+            uint64_t inverted = ~x;
+            return ((inverted - 0x0101010101010101ULL) & ~inverted & 0x8080808080808080ULL) != 0;
+        }
+
+        // MSB-first reader over the entropy-coded data. Stuffed zero bytes are dropped, and a
+        // marker ends the data: from there on the reader yields zeros
+        class bit_reader
+        {
+        public:
+            bit_reader(const uint8_t* pos, const uint8_t* end) : _p(pos), _end(end), _bits(0), _count(0) {}
+
+            void reset(const uint8_t* pos) { _p = pos; _bits = 0; _count = 0; }
+
+            // Keeps at least 57 bits buffered, enough for a code and its extra bits
+            void fill()
+            {
+                if (_count > 56)
+                    return;
+
+                // Whole bytes at once while there is nothing to unstuff
+                if (_p + 8 <= _end)
+                {
+                    uint64_t next = load_big_endian_64(_p);
+                    if (!has_ff_byte(next))
+                    {
+                        int bytes = (64 - _count) >> 3;
+                        _bits |= (next >> (64 - bytes * 8)) << (64 - bytes * 8 - _count);
+                        _p += bytes;
+                        _count += bytes * 8;
+                        return;
+                    }
+                }
+
+                while (_count <= 56)
+                {
+                    uint64_t b = 0;
+                    if (_p < _end)
+                    {
+                        b = *_p;
+                        if (b != 0xFF) _p++;
+                        else if (_p + 1 < _end && _p[1] == 0) _p += 2;
+                        else b = 0;
+                    }
+                    _bits |= b << (56 - _count);
+                    _count += 8;
+                }
+            }
+
+            uint32_t peek16() const { return static_cast<uint32_t>(_bits >> 48); }
+            void skip(int n) { _bits <<= n; _count -= n; }
+
+            // Reads s bits as a signed coefficient (F.2.2.1)
+            int receive_extend(int s)
+            {
+                int v = static_cast<int>(_bits >> (64 - s));
+                skip(s);
+                return v < (1 << (s - 1)) ? v - (1 << s) + 1 : v;
+            }
+
+        private:
+            const uint8_t* _p;
+            const uint8_t* _end;
+            uint64_t _bits;
+            int _count;
+        };
+
+        // Integer IDCT of the dequantized coefficients in natural order. The constants are those
+        // of the IJG islow IDCT scaled by 4096, regrouped per input so the vector version can
+        // use one multiply-add per pair of inputs; both versions give identical output
+        const int16_t IDCT_EVEN[2][2] = { { 2217, -5350 }, { 5352, 2217 } };   // t2, t3 from s2, s6
+        const int16_t IDCT_ODD[4][4] = {                                        // from s7, s5, s3, s1
+            { -5680, 4816, -3218, 1131 },
+            { 4816, 1132, -5681, 3219 },
+            { -3218, -5681, -1129, 4816 },
+            { 1131, 3219, 4816, 5683 } };
+
+        inline void idct_1d(const int s[8], int bias, int shift, int out[8])
+        {
+            int t0 = (s[0] + s[4]) * 4096, t1 = (s[0] - s[4]) * 4096;
+            int t2 = s[2] * IDCT_EVEN[0][0] + s[6] * IDCT_EVEN[0][1];
+            int t3 = s[2] * IDCT_EVEN[1][0] + s[6] * IDCT_EVEN[1][1];
+            int x0 = t0 + t3 + bias, x3 = t0 - t3 + bias, x1 = t1 + t2 + bias, x2 = t1 - t2 + bias;
+
+            int o[4];
+            for (int i = 0; i < 4; i++)
+                o[i] = s[7] * IDCT_ODD[i][0] + s[5] * IDCT_ODD[i][1] + s[3] * IDCT_ODD[i][2] + s[1] * IDCT_ODD[i][3];
+
+            out[0] = (x0 + o[3]) >> shift; out[7] = (x0 - o[3]) >> shift;
+            out[1] = (x1 + o[2]) >> shift; out[6] = (x1 - o[2]) >> shift;
+            out[2] = (x2 + o[1]) >> shift; out[5] = (x2 - o[1]) >> shift;
+            out[3] = (x3 + o[0]) >> shift; out[4] = (x3 - o[0]) >> shift;
+        }
+
+        const int COLUMN_BIAS = 512, COLUMN_SHIFT = 10;
+        const int ROW_BIAS = 65536 + (128 << 17), ROW_SHIFT = 17;
+
+#ifndef __SSSE3__
+        void idct_8x8(const int16_t* in, uint8_t* out, int stride)
+        {
+            int16_t tmp[64];
+            int s[8], v[8];
+            for (int c = 0; c < 8; c++)
+            {
+                for (int i = 0; i < 8; i++) s[i] = in[i * 8 + c];
+                idct_1d(s, COLUMN_BIAS, COLUMN_SHIFT, v);
+                for (int i = 0; i < 8; i++) tmp[i * 8 + c] = clamp_s16(v[i]);
+            }
+            for (int r = 0; r < 8; r++)
+            {
+                for (int i = 0; i < 8; i++) s[i] = tmp[r * 8 + i];
+                idct_1d(s, ROW_BIAS, ROW_SHIFT, v);
+                for (int i = 0; i < 8; i++) out[r * stride + i] = clamp_u8(v[i]);
+            }
+        }
+#else
+        inline __m128i pair(int16_t a, int16_t b) { return _mm_setr_epi16(a, b, a, b, a, b, a, b); }
+
+        // The 1-D IDCT of eight columns at once, s[i] holding input i of every column
+#ifdef _MSC_VER
+        __forceinline
+#else
+        inline __attribute__((always_inline))
+#endif
+        void idct_1d(const __m128i s[8], int bias, int shift, __m128i out[8])
+        {
+            const __m128i e0 = pair(4096, 4096), e1 = pair(4096, -4096);
+            const __m128i e2 = pair(IDCT_EVEN[0][0], IDCT_EVEN[0][1]), e3 = pair(IDCT_EVEN[1][0], IDCT_EVEN[1][1]);
+            const __m128i rounding = _mm_set1_epi32(bias);
+
+            __m128i s04[2] = { _mm_unpacklo_epi16(s[0], s[4]), _mm_unpackhi_epi16(s[0], s[4]) };
+            __m128i s26[2] = { _mm_unpacklo_epi16(s[2], s[6]), _mm_unpackhi_epi16(s[2], s[6]) };
+            __m128i s71[2] = { _mm_unpacklo_epi16(s[7], s[1]), _mm_unpackhi_epi16(s[7], s[1]) };
+            __m128i s53[2] = { _mm_unpacklo_epi16(s[5], s[3]), _mm_unpackhi_epi16(s[5], s[3]) };
+
+            __m128i result[8][2];
+            for (int h = 0; h < 2; h++)
+            {
+                __m128i t0 = _mm_madd_epi16(s04[h], e0), t1 = _mm_madd_epi16(s04[h], e1);
+                __m128i t2 = _mm_madd_epi16(s26[h], e2), t3 = _mm_madd_epi16(s26[h], e3);
+                __m128i x0 = _mm_add_epi32(_mm_add_epi32(t0, t3), rounding);
+                __m128i x3 = _mm_add_epi32(_mm_sub_epi32(t0, t3), rounding);
+                __m128i x1 = _mm_add_epi32(_mm_add_epi32(t1, t2), rounding);
+                __m128i x2 = _mm_add_epi32(_mm_sub_epi32(t1, t2), rounding);
+
+                __m128i o[4];
+                for (int i = 0; i < 4; i++)
+                    o[i] = _mm_add_epi32(_mm_madd_epi16(s71[h], pair(IDCT_ODD[i][0], IDCT_ODD[i][3])),
+                                         _mm_madd_epi16(s53[h], pair(IDCT_ODD[i][1], IDCT_ODD[i][2])));
+
+                result[0][h] = _mm_srai_epi32(_mm_add_epi32(x0, o[3]), shift);
+                result[7][h] = _mm_srai_epi32(_mm_sub_epi32(x0, o[3]), shift);
+                result[1][h] = _mm_srai_epi32(_mm_add_epi32(x1, o[2]), shift);
+                result[6][h] = _mm_srai_epi32(_mm_sub_epi32(x1, o[2]), shift);
+                result[2][h] = _mm_srai_epi32(_mm_add_epi32(x2, o[1]), shift);
+                result[5][h] = _mm_srai_epi32(_mm_sub_epi32(x2, o[1]), shift);
+                result[3][h] = _mm_srai_epi32(_mm_add_epi32(x3, o[0]), shift);
+                result[4][h] = _mm_srai_epi32(_mm_sub_epi32(x3, o[0]), shift);
+            }
+            for (int i = 0; i < 8; i++)
+                out[i] = _mm_packs_epi32(result[i][0], result[i][1]);
+        }
+
+        inline void transpose_8x8(__m128i r[8])
+        {
+            __m128i a0 = _mm_unpacklo_epi16(r[0], r[1]), a1 = _mm_unpackhi_epi16(r[0], r[1]);
+            __m128i a2 = _mm_unpacklo_epi16(r[2], r[3]), a3 = _mm_unpackhi_epi16(r[2], r[3]);
+            __m128i a4 = _mm_unpacklo_epi16(r[4], r[5]), a5 = _mm_unpackhi_epi16(r[4], r[5]);
+            __m128i a6 = _mm_unpacklo_epi16(r[6], r[7]), a7 = _mm_unpackhi_epi16(r[6], r[7]);
+            __m128i b0 = _mm_unpacklo_epi32(a0, a2), b1 = _mm_unpackhi_epi32(a0, a2);
+            __m128i b2 = _mm_unpacklo_epi32(a1, a3), b3 = _mm_unpackhi_epi32(a1, a3);
+            __m128i b4 = _mm_unpacklo_epi32(a4, a6), b5 = _mm_unpackhi_epi32(a4, a6);
+            __m128i b6 = _mm_unpacklo_epi32(a5, a7), b7 = _mm_unpackhi_epi32(a5, a7);
+            r[0] = _mm_unpacklo_epi64(b0, b4); r[1] = _mm_unpackhi_epi64(b0, b4);
+            r[2] = _mm_unpacklo_epi64(b1, b5); r[3] = _mm_unpackhi_epi64(b1, b5);
+            r[4] = _mm_unpacklo_epi64(b2, b6); r[5] = _mm_unpackhi_epi64(b2, b6);
+            r[6] = _mm_unpacklo_epi64(b3, b7); r[7] = _mm_unpackhi_epi64(b3, b7);
+        }
+
+        void idct_8x8(const int16_t* in, uint8_t* out, int stride)
+        {
+            __m128i rows[8], v[8];
+            for (int i = 0; i < 8; i++)
+                rows[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 8));
+
+            idct_1d(rows, COLUMN_BIAS, COLUMN_SHIFT, v);
+            transpose_8x8(v);
+            idct_1d(v, ROW_BIAS, ROW_SHIFT, rows);
+            transpose_8x8(rows);
+
+            for (int i = 0; i < 8; i++)
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i * stride), _mm_packus_epi16(rows[i], rows[i]));
+        }
+#endif
+
+        // A block with no AC coefficients is flat; same result as the full IDCT
+        inline void idct_dc_only(int16_t dc, uint8_t* out, int stride)
+        {
+            auto value = clamp_u8(((clamp_s16(dc * 4) + 16) >> 5) + 128);
+            for (int i = 0; i < 8; i++)
+                std::memset(out + i * stride, value, 8);
+        }
+
+        // Horizontal 2x upsampling with the triangle filter libjpeg and stb_image use
+        void upsample_h2(uint8_t* out, const uint8_t* in, int count)
+        {
+            if (count == 1)
+            {
+                out[0] = out[1] = in[0];
+                return;
+            }
+            out[0] = in[0];
+            out[1] = static_cast<uint8_t>((in[0] * 3 + in[1] + 2) >> 2);
+            int i = 1;
+#ifdef __SSSE3__
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i two = _mm_set1_epi16(2);
+            for (; i + 9 <= count; i += 8)
+            {
+                __m128i previous = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + i - 1)), zero);
+                __m128i current = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + i)), zero);
+                __m128i next = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + i + 1)), zero);
+                __m128i n = _mm_add_epi16(_mm_add_epi16(current, _mm_add_epi16(current, current)), two);
+                __m128i even = _mm_srli_epi16(_mm_add_epi16(n, previous), 2);
+                __m128i odd = _mm_srli_epi16(_mm_add_epi16(n, next), 2);
+                __m128i packed = _mm_packus_epi16(even, odd);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2), _mm_unpacklo_epi8(packed, _mm_srli_si128(packed, 8)));
+            }
+#endif
+            for (; i < count - 1; i++)
+            {
+                int n = 3 * in[i] + 2;
+                out[i * 2] = static_cast<uint8_t>((n + in[i - 1]) >> 2);
+                out[i * 2 + 1] = static_cast<uint8_t>((n + in[i + 1]) >> 2);
+            }
+            out[count * 2 - 2] = static_cast<uint8_t>((in[count - 2] * 3 + in[count - 1] + 2) >> 2);
+            out[count * 2 - 1] = in[count - 1];
+        }
+
+        template<bool BGR, int BPP>
+        void ycbcr_to_rgb(uint8_t* out, const uint8_t* y, const uint8_t* cb, const uint8_t* cr, int count)
+        {
+            int i = 0;
+#ifdef __SSSE3__
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i offset = _mm_set1_epi16(128);
+            const __m128i rounding = _mm_set1_epi32(1 << 13);
+            const __m128i to_r = pair(0, CR_R), to_g = pair(CB_G, CR_G), to_b = pair(CB_B, 0);
+            const __m128i alpha = _mm_set1_epi8(-1);
+            const __m128i drop_alpha = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+            for (; i + 8 <= count; i += 8)
+            {
+                __m128i y16 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(y + i)), zero);
+                __m128i cb16 = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(cb + i)), zero), offset);
+                __m128i cr16 = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(cr + i)), zero), offset);
+
+                __m128i c[2] = { _mm_unpacklo_epi16(cb16, cr16), _mm_unpackhi_epi16(cb16, cr16) };
+                __m128i luma[2] = { _mm_add_epi32(_mm_slli_epi32(_mm_unpacklo_epi16(y16, zero), 14), rounding),
+                                    _mm_add_epi32(_mm_slli_epi32(_mm_unpackhi_epi16(y16, zero), 14), rounding) };
+                __m128i r[2], g[2], b[2];
+                for (int h = 0; h < 2; h++)
+                {
+                    r[h] = _mm_srai_epi32(_mm_add_epi32(luma[h], _mm_madd_epi16(c[h], to_r)), 14);
+                    g[h] = _mm_srai_epi32(_mm_add_epi32(luma[h], _mm_madd_epi16(c[h], to_g)), 14);
+                    b[h] = _mm_srai_epi32(_mm_add_epi32(luma[h], _mm_madd_epi16(c[h], to_b)), 14);
+                }
+                __m128i r8 = _mm_packus_epi16(_mm_packs_epi32(r[0], r[1]), zero);
+                __m128i g8 = _mm_packus_epi16(_mm_packs_epi32(g[0], g[1]), zero);
+                __m128i b8 = _mm_packus_epi16(_mm_packs_epi32(b[0], b[1]), zero);
+
+                __m128i first = _mm_unpacklo_epi8(BGR ? b8 : r8, g8);
+                __m128i second = _mm_unpacklo_epi8(BGR ? r8 : b8, alpha);
+                __m128i lo = _mm_unpacklo_epi16(first, second), hi = _mm_unpackhi_epi16(first, second);
+
+                auto dst = out + i * BPP;
+                if (BPP == 4)
+                {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), lo);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16), hi);
+                }
+                else
+                {
+                    lo = _mm_shuffle_epi8(lo, drop_alpha);
+                    hi = _mm_shuffle_epi8(hi, drop_alpha);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_or_si128(lo, _mm_slli_si128(hi, 12)));
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 16), _mm_srli_si128(hi, 4));
+                }
+            }
+#endif
+            for (; i < count; i++)
+            {
+                int luma = (y[i] << 14) + (1 << 13);
+                int u = cb[i] - 128, v = cr[i] - 128;
+                uint8_t r = clamp_u8((luma + v * CR_R) >> 14);
+                uint8_t g = clamp_u8((luma + u * CB_G + v * CR_G) >> 14);
+                uint8_t b = clamp_u8((luma + u * CB_B) >> 14);
+                auto dst = out + i * BPP;
+                dst[0] = BGR ? b : r;
+                dst[1] = g;
+                dst[2] = BGR ? r : b;
+                if (BPP == 4) dst[3] = 255;
+            }
+        }
+
+        inline int decode_symbol(bit_reader& reader, const jpeg_huffman_table& table)
+        {
+            reader.fill();
+            uint32_t look = reader.peek16();
+            int fast = look >> 7;
+            if (table.fast_length[fast])
+            {
+                reader.skip(table.fast_length[fast]);
+                return table.fast_symbol[fast];
+            }
+            for (int length = 10; length <= 16; length++)
+            {
+                if (look < table.max_code[length])
+                {
+                    reader.skip(length);
+                    return table.symbols[static_cast<int>(look >> (16 - length)) + table.delta[length]];
+                }
+            }
+            return -1;
+        }
+
+        // Decodes and dequantizes one block into natural order (F.2.2)
+        bool decode_block(bit_reader& reader, const jpeg_huffman_table& dc, const jpeg_huffman_table& ac,
+                          const uint16_t* quant, int& predictor, int16_t block[64], bool& has_ac)
+        {
+            std::memset(block, 0, 64 * sizeof(int16_t));
+            has_ac = false;
+
+            int size = decode_symbol(reader, dc);
+            if (size < 0 || size > 11)
+                return false;
+            if (size)
+                predictor += reader.receive_extend(size);
+            block[0] = static_cast<int16_t>(predictor * quant[0]);
+
+            for (int k = 1; k < 64; )
+            {
+                reader.fill();
+                int fast = ac.fast_ac[reader.peek16() >> 7];
+                if (fast)
+                {
+                    k += (fast >> 4) & 15;
+                    if (k > 63)
+                        return false;
+                    reader.skip(fast & 15);
+                    block[zigzag[k]] = static_cast<int16_t>((fast >> 8) * quant[k]);
+                    has_ac = true;
+                    k++;
+                    continue;
+                }
+
+                int rs = decode_symbol(reader, ac);
+                if (rs < 0)
+                    return false;
+                int run = rs >> 4;
+                size = rs & 15;
+                if (!size)
+                {
+                    if (run != 15)
+                        break; // end of block
+                    k += 16;
+                    continue;
+                }
+                k += run;
+                if (k > 63)
+                    return false;
+                block[zigzag[k]] = static_cast<int16_t>(reader.receive_extend(size) * quant[k]);
+                has_ac = true;
+                k++;
+            }
+            return true;
+        }
+
+        struct default_tables
+        {
+            jpeg_huffman_table dc[2], ac[2];
+
+            default_tables()
+            {
+                dc[0].build(dc_luma_bits, dc_values, 12);
+                dc[1].build(dc_chroma_bits, dc_values, 12);
+                ac[0].build(ac_luma_bits, ac_luma_values, 162);
+                ac[1].build(ac_chroma_bits, ac_chroma_values, 162);
+            }
+        };
+
+        const default_tables& get_default_tables()
+        {
+            static default_tables tables;
+            return tables;
+        }
+    }
+
+    bool jpeg_huffman_table::build(const uint8_t bits[16], const uint8_t* values, int count)
+    {
+        std::memset(fast_length, 0, sizeof(fast_length));
+        std::memset(max_code, 0, sizeof(max_code));
+        std::memcpy(symbols, values, count);
+
+        int code = 0, k = 0;
+        for (int length = 1; length <= 16; length++)
+        {
+            delta[length] = k - code;
+            for (int i = 0; i < bits[length - 1]; i++, k++, code++)
+            {
+                if (code >= (1 << length))
+                    return false;
+                if (length <= 9)
+                {
+                    int first = code << (9 - length);
+                    for (int j = 0; j < (1 << (9 - length)); j++)
+                    {
+                        fast_symbol[first + j] = values[k];
+                        fast_length[first + j] = static_cast<uint8_t>(length);
+                    }
+                }
+            }
+            if (bits[length - 1])
+                max_code[length] = static_cast<uint32_t>(code) << (16 - length);
+            code <<= 1;
+        }
+        if (k != count)
+            return false;
+
+        // Meaningful for AC tables only
+        for (int i = 0; i < 512; i++)
+        {
+            fast_ac[i] = 0;
+            int length = fast_length[i];
+            int run = fast_symbol[i] >> 4, size = fast_symbol[i] & 15;
+            if (!length || !size || length + size > 9)
+                continue;
+            int extra = (i >> (9 - length - size)) & ((1 << size) - 1);
+            int value = extra < (1 << (size - 1)) ? extra - (1 << size) + 1 : extra;
+            if (value >= -128 && value <= 127)
+                fast_ac[i] = static_cast<int16_t>(value * 256 + run * 16 + length + size);
+        }
+        return true;
+    }
+}
+
+namespace librealsense
+{
+    mjpeg_decoder::mjpeg_decoder(bool use_turbojpeg)
+        : _quant_defined(0), _dc_defined(3), _ac_defined(3), _component_count(0), _width(0), _height(0), _hmax(1), _vmax(1), _mcus_x(0), _mcus_y(0),
+          _restart_interval(0), _src(nullptr), _scan(nullptr), _end(nullptr), _turbo(nullptr)
+    {
+#ifdef RS2_USE_TURBOJPEG
+        if (use_turbojpeg)
+            _turbo = tjInitDecompress();
+#endif
+    }
+
+    mjpeg_decoder::~mjpeg_decoder()
+    {
+#ifdef RS2_USE_TURBOJPEG
+        if (_turbo)
+            tjDestroy(_turbo);
+#endif
+    }
+
+    bool mjpeg_decoder::parse_headers(const uint8_t* src, int size)
+    {
+        _src = src;
+        _end = src + size;
+        _scan = nullptr;
+        _component_count = 0;
+        _restart_interval = 0;
+
+        // Tables are those of this frame only: UVC cameras leave the Huffman tables out, so those
+        // start as the standard ones, and a table the frame neither defines nor defaults fails it
+        auto& defaults = get_default_tables();
+        _dc[0] = defaults.dc[0]; _dc[1] = defaults.dc[1];
+        _ac[0] = defaults.ac[0]; _ac[1] = defaults.ac[1];
+        _quant_defined = 0;
+        _dc_defined = _ac_defined = 3;
+
+        if (size < 4 || src[0] != 0xFF || src[1] != 0xD8)
+            return false;
+
+        auto p = src + 2;
+        while (p + 4 <= _end)
+        {
+            if (*p != 0xFF)
+                return false;
+            int marker = p[1];
+            if (marker == 0xFF) // fill byte
+            {
+                p++;
+                continue;
+            }
+            int length = read_u16(p + 2);
+            auto segment = p + 4;
+            auto segment_end = p + 2 + length;
+            if (length < 2 || segment_end > _end)
+                return false;
+
+            switch (marker)
+            {
+            case 0xDB: // DQT
+                for (auto q = segment; q < segment_end; )
+                {
+                    int precision = q[0] >> 4, id = q[0] & 15;
+                    if (id > 3 || q + 1 + 64 * (precision + 1) > segment_end)
+                        return false;
+                    for (int k = 0; k < 64; k++)
+                        _quant[id][k] = static_cast<uint16_t>(precision ? read_u16(q + 1 + k * 2) : q[1 + k]);
+                    _quant_defined |= 1 << id;
+                    q += 1 + 64 * (precision + 1);
+                }
+                break;
+
+            case 0xC4: // DHT
+                for (auto q = segment; q < segment_end; )
+                {
+                    int table_class = q[0] >> 4, id = q[0] & 15;
+                    if (table_class > 1 || id > 3 || q + 17 > segment_end)
+                        return false;
+                    int count = 0;
+                    for (int i = 0; i < 16; i++)
+                        count += q[1 + i];
+                    if (count > 256 || q + 17 + count > segment_end)
+                        return false;
+                    auto& table = table_class ? _ac[id] : _dc[id];
+                    if (!table.build(q + 1, q + 17, count))
+                        return false;
+                    (table_class ? _ac_defined : _dc_defined) |= 1 << id;
+                    q += 17 + count;
+                }
+                break;
+
+            case 0xC0: // SOF0, baseline
+            case 0xC1: // SOF1, extended sequential Huffman
+            {
+                if (length < 8 || segment[0] != 8)
+                    return false;
+                _height = read_u16(segment + 1);
+                _width = read_u16(segment + 3);
+                _component_count = segment[5];
+                if ((_component_count != 1 && _component_count != 3) || length < 8 + 3 * _component_count)
+                    return false;
+                for (int i = 0; i < _component_count; i++)
+                {
+                    auto c = segment + 6 + i * 3;
+                    _components[i].id = c[0];
+                    _components[i].h = c[1] >> 4;
+                    _components[i].v = c[1] & 15;
+                    _components[i].quant = c[2] & 3;
+                }
+                break;
+            }
+
+            case 0xC2: case 0xC3: case 0xC5: case 0xC6: case 0xC7:
+            case 0xC9: case 0xCA: case 0xCB: case 0xCD: case 0xCE: case 0xCF:
+                return false; // progressive, lossless, hierarchical or arithmetic-coded
+
+            case 0xDD: // DRI
+                _restart_interval = read_u16(segment);
+                break;
+
+            case 0xDA: // SOS
+            {
+                int count = segment[0];
+                if (!_component_count || count != _component_count || length != 6 + 2 * count)
+                    return false;
+                for (int i = 0; i < count; i++)
+                {
+                    auto c = segment + 1 + i * 2;
+                    if (c[0] != _components[i].id)
+                        return false;
+                    _components[i].dc_table = c[1] >> 4;
+                    _components[i].ac_table = c[1] & 15;
+                    if (_components[i].dc_table > 3 || _components[i].ac_table > 3)
+                        return false;
+                    if (!(_dc_defined >> _components[i].dc_table & 1) || !(_ac_defined >> _components[i].ac_table & 1)
+                        || !(_quant_defined >> _components[i].quant & 1))
+                        return false;
+                }
+                auto spectral = segment + 1 + count * 2;
+                if (spectral[0] != 0 || spectral[1] != 63 || spectral[2] != 0)
+                    return false;
+                _scan = segment_end;
+                break;
+            }
+
+            case 0xD9: // EOI
+                return false;
+
+            default: // APPn, COM and the like
+                break;
+            }
+
+            if (_scan)
+                break;
+            p = segment_end;
+        }
+        if (!_scan)
+            return false;
+
+        // Single-component scans are not interleaved, one block per MCU whatever the sampling
+        if (_component_count == 1)
+        {
+            _components[0].h = _components[0].v = 1;
+        }
+        else
+        {
+            for (int i = 1; i < 3; i++)
+                if (_components[i].h != 1 || _components[i].v != 1)
+                    return false;
+        }
+        _hmax = _components[0].h;
+        _vmax = _components[0].v;
+        if (_hmax < 1 || _hmax > 2 || _vmax < 1 || _vmax > 2 || !_width || !_height)
+            return false;
+
+        _mcus_x = (_width + 8 * _hmax - 1) / (8 * _hmax);
+        _mcus_y = (_height + 8 * _vmax - 1) / (8 * _vmax);
+        return true;
+    }
+
+    bool mjpeg_decoder::find_restarts()
+    {
+        _restarts.clear();
+        auto p = _scan;
+        while (p + 1 < _end)
+        {
+            p = static_cast<const uint8_t*>(std::memchr(p, 0xFF, _end - p - 1));
+            if (!p)
+                break;
+            int marker = p[1];
+            if (marker >= 0xD0 && marker <= 0xD7)
+                _restarts.push_back(static_cast<int>(p + 2 - _src));
+            else if (marker != 0 && marker != 0xFF)
+                break; // EOI, or anything else that ends the scan
+            p++;
+        }
+        int expected = (_mcus_x * _mcus_y - 1) / _restart_interval;
+        return static_cast<int>(_restarts.size()) >= expected;
+    }
+
+    bool mjpeg_decoder::decode_rows(int first_row, int last_row, rs2_format format, uint8_t* dst, scratch& s) const
+    {
+        const bool luma_only = format == RS2_FORMAT_Y8;
+        int stride[3];
+        for (int c = 0; c < _component_count; c++)
+        {
+            stride[c] = _mcus_x * _components[c].h * 8;
+            auto size = static_cast<size_t>(stride[c] * _components[c].v * 8);
+            if (s.planes[c].size() < size)
+                s.planes[c].resize(size);
+        }
+        for (auto&& row : s.chroma)
+        {
+            if (row.size() < static_cast<size_t>(_width + 1))
+                row.resize(_width + 1);
+        }
+        if (_component_count == 1)
+        {
+            std::fill(s.chroma[0].begin(), s.chroma[0].end(), uint8_t(128));
+            std::fill(s.chroma[1].begin(), s.chroma[1].end(), uint8_t(128));
+        }
+
+        int mcu = first_row * _mcus_x;
+        const uint8_t* start = _scan;
+        if (_restart_interval && mcu)
+        {
+            // Bands start on a restart boundary
+            int index = mcu / _restart_interval - 1;
+            if (index >= static_cast<int>(_restarts.size()))
+                return false;
+            start = _src + _restarts[index];
+        }
+        bit_reader reader(start, _end);
+        int predictors[3] = { 0, 0, 0 };
+        int16_t block[64];
+        bool has_ac;
+
+        for (int row = first_row; row < last_row; row++)
+        {
+            for (int x = 0; x < _mcus_x; x++, mcu++)
+            {
+                if (_restart_interval && mcu && mcu % _restart_interval == 0)
+                {
+                    int index = mcu / _restart_interval - 1;
+                    if (index >= static_cast<int>(_restarts.size()))
+                        return false;
+                    reader.reset(_src + _restarts[index]);
+                    predictors[0] = predictors[1] = predictors[2] = 0;
+                }
+
+                for (int c = 0; c < _component_count; c++)
+                {
+                    auto& comp = _components[c];
+                    for (int by = 0; by < comp.v; by++)
+                    {
+                        for (int bx = 0; bx < comp.h; bx++)
+                        {
+                            if (!decode_block(reader, _dc[comp.dc_table], _ac[comp.ac_table], _quant[comp.quant], predictors[c], block, has_ac))
+                                return false;
+                            if (luma_only && c)
+                                continue;
+                            auto out = s.planes[c].data() + by * 8 * stride[c] + (x * comp.h + bx) * 8;
+                            if (has_ac)
+                                idct_8x8(block, out, stride[c]);
+                            else
+                                idct_dc_only(block[0], out, stride[c]);
+                        }
+                    }
+                }
+            }
+
+            int top = row * 8 * _vmax;
+            int bottom = std::min(top + 8 * _vmax, _height);
+            for (int y = top; y < bottom; y++)
+                convert_row(y, y - top, format, dst, s);
+        }
+        return true;
+    }
+
+    void mjpeg_decoder::convert_row(int y, int row_y, rs2_format format, uint8_t* dst, scratch& s) const
+    {
+        auto luma = s.planes[0].data() + row_y * _mcus_x * _hmax * 8;
+        if (format == RS2_FORMAT_Y8)
+        {
+            std::memcpy(dst + y * _width, luma, _width);
+            return;
+        }
+
+        const uint8_t* cb = s.chroma[0].data();
+        const uint8_t* cr = s.chroma[1].data();
+        if (_component_count == 3)
+        {
+            int offset = (row_y / _vmax) * _mcus_x * 8;
+            cb = s.planes[1].data() + offset;
+            cr = s.planes[2].data() + offset;
+            if (_hmax == 2)
+            {
+                int count = (_width + 1) / 2;
+                upsample_h2(s.chroma[0].data(), cb, count);
+                upsample_h2(s.chroma[1].data(), cr, count);
+                cb = s.chroma[0].data();
+                cr = s.chroma[1].data();
+            }
+        }
+
+        switch (format)
+        {
+        case RS2_FORMAT_RGB8: ycbcr_to_rgb<false, 3>(dst + y * _width * 3, luma, cb, cr, _width); break;
+        case RS2_FORMAT_BGR8: ycbcr_to_rgb<true, 3>(dst + y * _width * 3, luma, cb, cr, _width); break;
+        case RS2_FORMAT_RGBA8: ycbcr_to_rgb<false, 4>(dst + y * _width * 4, luma, cb, cr, _width); break;
+        case RS2_FORMAT_BGRA8: ycbcr_to_rgb<true, 4>(dst + y * _width * 4, luma, cb, cr, _width); break;
+        default: break;
+        }
+    }
+
+    std::unique_ptr<mjpeg_decoder::scratch> mjpeg_decoder::acquire_scratch()
+    {
+        std::lock_guard<std::mutex> lock(_scratch_mutex);
+        if (_free_scratch.empty())
+            return std::unique_ptr<scratch>(new scratch());
+        auto s = std::move(_free_scratch.back());
+        _free_scratch.pop_back();
+        return s;
+    }
+
+    void mjpeg_decoder::release_scratch(std::unique_ptr<scratch> s)
+    {
+        std::lock_guard<std::mutex> lock(_scratch_mutex);
+        _free_scratch.push_back(std::move(s));
+    }
+
+    bool mjpeg_decoder::decode(const uint8_t* src, int size, rs2_format format, uint8_t* dst, int width, int height, unsigned int max_workers)
+    {
+        switch (format)
+        {
+        case RS2_FORMAT_RGB8: case RS2_FORMAT_BGR8: case RS2_FORMAT_RGBA8: case RS2_FORMAT_BGRA8: case RS2_FORMAT_Y8:
+            break;
+        default:
+            return false;
+        }
+
+        if (!parse_headers(src, size) || _width != width || _height != height)
+            return false;
+
+        // Bands have to start on a restart boundary, which is every band_rows MCU rows
+        int band_rows = _mcus_y, bands = 1;
+        if (_restart_interval && max_workers != 1 && width * height >= PARALLEL_MIN_PIXELS)
+        {
+            band_rows = _restart_interval / gcd(_restart_interval, _mcus_x);
+            bands = (_mcus_y + band_rows - 1) / band_rows;
+        }
+
+#ifdef RS2_USE_TURBOJPEG
+        if (bands < 2 && _turbo)
+        {
+            int pixel_format = format == RS2_FORMAT_RGB8 ? TJPF_RGB : format == RS2_FORMAT_BGR8 ? TJPF_BGR
+                : format == RS2_FORMAT_RGBA8 ? TJPF_RGBA : format == RS2_FORMAT_BGRA8 ? TJPF_BGRA : TJPF_GRAY;
+            if (tjDecompress2(static_cast<tjhandle>(_turbo), src, static_cast<unsigned long>(size), dst,
+                              width, 0, height, pixel_format, TJFLAG_FASTDCT) == 0)
+                return true;
+        }
+#endif
+
+        if (_restart_interval && !find_restarts())
+            return false;
+
+        if (bands < 2)
+        {
+            auto s = acquire_scratch();
+            bool ok = decode_rows(0, _mcus_y, format, dst, *s);
+            release_scratch(std::move(s));
+            return ok;
+        }
+
+        std::atomic<bool> ok(true);
+        thread_pool::get_default().parallel_for(bands, max_workers, [&](int begin, int end)
+        {
+            auto s = acquire_scratch();
+            if (!decode_rows(begin * band_rows, std::min(end * band_rows, _mcus_y), format, dst, *s))
+                ok = false;
+            release_scratch(std::move(s));
+        });
+        return ok;
+    }
+}
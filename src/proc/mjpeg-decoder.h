@@ -0,0 +1,98 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#pragma once
+
+#include "types.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace librealsense
+{
+    struct jpeg_huffman_table
+    {
+        uint8_t fast_symbol[512];   // indexed by the next 9 bits
+        uint8_t fast_length[512];   // 0 for codes longer than 9 bits
+        uint32_t max_code[17];      // per length, left-aligned to 16 bits
+        int delta[17];              // from a code to its symbol index, per length
+        uint8_t symbols[256];
+        int16_t fast_ac[512];       // AC codes that fit 9 bits with their extra bits: value << 8 | run << 4 | length
+
+        // From the code counts per length and the symbols of a DHT segment
+        bool build(const uint8_t bits[16], const uint8_t* values, int count);
+    };
+
+    // Baseline JPEG decoder for MJPEG color streams. Frames are decoded one MCU row at a time
+    // straight into the frame buffer in the target format (RGB8, BGR8, RGBA8, BGRA8 or Y8), and
+    // the table storage and row buffers are kept between frames, so a steady stream allocates
+    // nothing. The tables themselves are those of each frame, reset at its SOI.
+    // Frames with restart markers are split into bands of MCU rows decoded in parallel on the
+    // shared thread pool. When libjpeg-turbo was found at configure time it takes the frames
+    // that are not split. 4:2:2 chroma is upsampled with the same filter as libjpeg; 4:2:0
+    // chroma rows are repeated rather than interpolated
+    class mjpeg_decoder
+    {
+    public:
+        // Frames smaller than this are decoded on the calling thread
+        static const int PARALLEL_MIN_PIXELS = 640 * 480;
+
+        // Without libjpeg-turbo every frame goes through the built-in decoder, as it does in
+        // builds where libjpeg-turbo was not found
+        explicit mjpeg_decoder(bool use_turbojpeg = true);
+        ~mjpeg_decoder();
+
+        // Returns false, leaving the output partly written, if the frame is corrupt, does not
+        // match the given size, or is not a baseline 8-bit JPEG with one component or with
+        // 1x1 sampled chroma (progressive and arithmetic-coded frames among them)
+        bool decode(const uint8_t* src, int size, rs2_format format, uint8_t* dst, int width, int height, unsigned int max_workers);
+
+    private:
+        mjpeg_decoder(const mjpeg_decoder&) = delete;
+        mjpeg_decoder& operator=(const mjpeg_decoder&) = delete;
+
+        struct component
+        {
+            int id;
+            int h, v;
+            int quant;
+            int dc_table, ac_table;
+        };
+
+        // Per-thread state, pooled between frames
+        struct scratch
+        {
+            std::vector<uint8_t> planes[3];     // one MCU row of each component
+            std::vector<uint8_t> chroma[2];     // upsampled chroma of one pixel row
+        };
+
+        bool parse_headers(const uint8_t* src, int size);
+        bool find_restarts();
+        bool decode_rows(int first_row, int last_row, rs2_format format, uint8_t* dst, scratch& s) const;
+        void convert_row(int y, int row_y, rs2_format format, uint8_t* dst, scratch& s) const;
+
+        std::unique_ptr<scratch> acquire_scratch();
+        void release_scratch(std::unique_ptr<scratch> s);
+
+        uint16_t _quant[4][64];     // in zigzag order
+        jpeg_huffman_table _dc[4], _ac[4];
+        uint8_t _quant_defined, _dc_defined, _ac_defined; // a bit per table id, set since the frame's SOI
+        component _components[3];
+        int _component_count;
+        int _width, _height;
+        int _hmax, _vmax;
+        int _mcus_x, _mcus_y;
+        int _restart_interval;
+
+        const uint8_t* _src;
+        const uint8_t* _scan;           // first byte of the entropy-coded data
+        const uint8_t* _end;
+        std::vector<int> _restarts;     // offset past each restart marker
+
+        std::mutex _scratch_mutex;
+        std::vector<std::unique_ptr<scratch>> _free_scratch;
+
+        void* _turbo;                   // tjhandle, when built with libjpeg-turbo
+    };
+}
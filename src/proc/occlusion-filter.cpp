@@ -5,14 +5,16 @@
 #include "../include/librealsense2/rsutil.h"
 
 #include "proc/occlusion-filter.h"
+#include <algorithm>
 #include <vector>
 #include <cmath>
 
-#include "proc/rotation-transform.h"
+#include "image-simd.h"
+#include "thread-pool.h"
 
-#define ROTATION_BUFFER_SIZE 32 // minimum limit that could be divided by all resolutions
 #define VERTICAL_SCAN_WINDOW_SIZE 16
 #define DEPTH_OCCLUSION_THRESHOLD 0.5f //meters
+#define VERTICAL_SCAN_STRIPE 64 // columns per task, whole cache lines of depth and texels per row
 
 namespace librealsense
 {
@@ -20,53 +22,78 @@ namespace librealsense
     {
     }
 
+    void occlusion_filter::texel_z_buffer::resize(size_t width, size_t height)
+    {
+        _width = static_cast<float>(width);
+        _height = static_cast<float>(height);
+        _tiles_per_row = static_cast<uint32_t>((width + TILE_SIZE - 1) >> TILE_BITS);
+        auto tiles = _tiles_per_row * ((height + TILE_SIZE - 1) >> TILE_BITS);
+        _depth.resize(tiles << (2 * TILE_BITS));
+        _stamps.assign(tiles, 0);
+        _frame = 0;
+    }
+
+    void occlusion_filter::texel_z_buffer::next_frame()
+    {
+        // Once in 2^32 frames the stamps would come around to a frame of the past
+        if (++_frame == 0)
+        {
+            std::fill(_stamps.begin(), _stamps.end(), 0);
+            _frame = 1;
+        }
+    }
+
+    uint32_t occlusion_filter::texel_z_buffer::index(float x, float y) const
+    {
+        if (!(x > 0.f && x < _width && y > 0.f && y < _height))
+            return npos;
+
+        // Within the texture, so the truncation fits an int
+        auto tx = static_cast<uint32_t>(static_cast<int>(x)), ty = static_cast<uint32_t>(static_cast<int>(y));
+        auto tile = (ty >> TILE_BITS) * _tiles_per_row + (tx >> TILE_BITS);
+        return (tile << (2 * TILE_BITS)) + ((ty & (TILE_SIZE - 1)) << TILE_BITS) + (tx & (TILE_SIZE - 1));
+    }
+
+    float& occlusion_filter::texel_z_buffer::at(uint32_t index)
+    {
+        auto tile = index >> (2 * TILE_BITS);
+        if (_stamps[tile] != _frame)
+        {
+            auto begin = _depth.begin() + (size_t(tile) << (2 * TILE_BITS));
+            std::fill(begin, begin + TILE_SIZE * TILE_SIZE, 0.f);
+            _stamps[tile] = _frame;
+        }
+        return _depth[index];
+    }
+
     void occlusion_filter::set_texel_intrinsics(const rs2_intrinsics& in)
     {
         _texels_intrinsics = in;
-        _texels_depth.resize(_texels_intrinsics.value().width*_texels_intrinsics.value().height);
+        _texels_depth.resize(_texels_intrinsics.value().width, _texels_intrinsics.value().height);
     }
 
-   void occlusion_filter::process(float3* points, float2* uv_map, const std::vector<float2> & pix_coord, const rs2::depth_frame& depth) const
+    void occlusion_filter::process(float3* points, float2* uv_map, const std::vector<float2> & pix_coord, const rs2::depth_frame& depth,
+        uint8_t* mask, unsigned int max_threads)
     {
+        if (mask)
+            memset(mask, 0, pix_coord.size());
+
         switch (_occlusion_filter)
         {
         case occlusion_none:
             break;
         case occlusion_monotonic_scan:
-            monotonic_heuristic_invalidation(points, uv_map, pix_coord, depth);
+            monotonic_heuristic_invalidation(points, pix_coord, depth, mask, max_threads);
+            break;
+        case occlusion_z_buffer:
+            comprehensive_invalidation(points, uv_map, pix_coord, mask, max_threads);
             break;
         default:
             throw std::runtime_error(to_string() << "Unsupported occlusion filter type " << _occlusion_filter << " requested");
             break;
         }
     }
-   template<size_t SIZE>
-   void rotate_image_optimized(byte* dest[], const byte* source, int width, int height)
-   {
-
-       auto width_out = height;
-       auto height_out = width;
-
-       auto out = dest[0];
-       byte buffer[ROTATION_BUFFER_SIZE][ROTATION_BUFFER_SIZE * SIZE];
-       for (int i = 0; i < height; i = i + ROTATION_BUFFER_SIZE)
-       {
-           for (int j = 0; j < width; j = j + ROTATION_BUFFER_SIZE)
-           {
-               for (int ii = 0; ii < ROTATION_BUFFER_SIZE; ii++) {
-                   for (int jj = 0; jj < ROTATION_BUFFER_SIZE; jj++) {
-                       auto source_index = (j + jj + (width * (i + ii))) * SIZE; // capture a buffer from source
-                       memcpy((void*)&(buffer[ROTATION_BUFFER_SIZE - jj - 1][(ROTATION_BUFFER_SIZE - ii - 1) * SIZE]), &source[source_index], SIZE);
-                   }
-               }
-               for (int ii = 0; ii < ROTATION_BUFFER_SIZE; ii++) { // copy buffer to out
-                   auto out_index = ((height - (i + ROTATION_BUFFER_SIZE - 1) - 1) + (width - (j + ROTATION_BUFFER_SIZE - 1) - 1 + ii) * height) * SIZE;
-                   memcpy(&out[out_index], (buffer + ii), SIZE * ROTATION_BUFFER_SIZE);
-               }
-
-           }
-       }
-   }
+
     // IMPORTANT! This implementation is based on the assumption that the RGB sensor is positioned strictly to the left of the depth sensor.
     // namely D415/D435 and SR300. The implementation WILL NOT work properly for different setups
     // Heuristic occlusion invalidation algorithm:
@@ -75,177 +102,184 @@ namespace librealsense
     // -  The occlusion is designated as U coordinate for a given pixel is less than the U coordinate of the predecessing pixel.
     // -  The UV mapping for the occluded pixel is reset to (0,0). Later on the (0,0) coordinate in the texture map is overwritten
     //    with a invalidation color such as black/magenta according to the purpose (production/debugging)
-   void occlusion_filter::monotonic_heuristic_invalidation(float3* points, float2* uv_map, const std::vector<float2>& pix_coord, const rs2::depth_frame& depth) const
-   {
-       float occZTh = 0.1f; //meters
-       int occDilationSz = 1;
-       auto points_width = _depth_intrinsics->width;
-       auto points_height = _depth_intrinsics->height;
-       auto pixels_ptr = pix_coord.data();
-       auto points_ptr = points;
-       auto uv_map_ptr = uv_map;
-       float maxInLine = -1;
-       float maxZ = 0;
-
-       if (_occlusion_scanning == horizontal)
-       {
-           {
-               for (size_t y = 0; y < points_height; ++y)
-               {
-                   maxInLine = -1;
-                   maxZ = 0;
-                   int occDilationLeft = 0;
-
-                   for (size_t x = 0; x < points_width; ++x)
-                   {
-                       if (points_ptr->z)
-                       {
-                           //Occlusion detection
-                           if (pixels_ptr->x < maxInLine || (pixels_ptr->x == maxInLine && (points_ptr->z - maxZ) > occZTh))
-                           {
-                               *points_ptr = { 0, 0, 0 };
-                               occDilationLeft = occDilationSz;
-                           }
-                           else
-                           {
-                               maxInLine = pixels_ptr->x;
-                               maxZ = points_ptr->z;
-                               if (occDilationLeft > 0)
-                               {
-                                   *points_ptr = { 0, 0, 0 };
-                                   occDilationLeft--;
-                               }
-                           }
-                       }
-                       ++points_ptr;
-                       ++uv_map_ptr;
-                       ++pixels_ptr;
-                   }
-               }
-           }
-       }
-       else if (_occlusion_scanning == vertical)
-       {
-           auto rotated_depth_width = _depth_intrinsics->height;
-           auto rotated_depth_height = _depth_intrinsics->width;
-           auto depth_ptr = (byte*)(depth.get_data());
-           std::allocator<byte> alloc;
-           byte* depth_planes[1];
-           depth_planes[0] = (byte*)alloc.allocate(depth.get_bytes_per_pixel() * points_width * points_height);
-
-           rotate_image_optimized<2>(depth_planes, (const byte*)(depth.get_data()), points_width, points_height);
-
-           // scan depth frame after rotation: check if there is a noticed jump between adjacen pixels in Z-axis (depth), it means there could be occlusion.
-           // save suspected points and run occlusion-invalidation vertical scan only on them
-           // after rotation : height = points_width , width = points_height
-           for (int i = 0; i < rotated_depth_height; i++)
-           {
-               for (int j = 0; j < rotated_depth_width; j++)
-               {
-                   // before depth frame rotation: occlusion detected in the positive direction of Y
-                   // after rotation : scan from right to left (positive direction of X) to detect occlusion
-                   // compare depth each pixel only with the pixel on its right (i,j+1)
-                   auto index = (j + (rotated_depth_width * i));
-                   auto uv_index = ((rotated_depth_height - i - 1) + (rotated_depth_width - j - 1) * rotated_depth_height);
-                   auto index_right = index + 1;
-                   uint16_t* diff_depth_ptr = (uint16_t*)depth_planes[0];
-                   uint16_t diff_right = abs((uint16_t)(*(diff_depth_ptr + index)) - (uint16_t)(*(diff_depth_ptr + index_right)));
-                   float scaled_threshold = DEPTH_OCCLUSION_THRESHOLD / _depth_units;
-                   if (diff_right > scaled_threshold)
-                   {
-                       points_ptr = points + uv_index;
-                       uv_map_ptr = uv_map + uv_index;
-
-                       if (j >= VERTICAL_SCAN_WINDOW_SIZE) {
-                           maxInLine = (uv_map_ptr - 1 * points_width)->y;
-                           for (size_t y = 0; y <= VERTICAL_SCAN_WINDOW_SIZE; ++y)
-                           {
-                               if (((uv_map_ptr + y * points_width)->y < maxInLine))
-                               {
-                                   *(points_ptr + y * points_width) = { 0.f, 0.f };
-                               }
-                               else
-                               {
-                                   break;
-                               }
-
-                           }
-
-                       }
-                   }
-               }
-           }
-       }
-   }
-    // Prepare texture map without occlusion that for every texture coordinate there no more than one depth point that is mapped to it
-    // i.e. for every (u,v) map coordinate we select the depth point with minimum Z. all other points that are mapped to this texel will be invalidated
-    // Algo input data:
-    // Vector of 3D [xyz] coordinates of depth_width*depth_height size
-    // Vector of 2D [i,j] coordinates where the val[i,j] stores the texture coordinate (s,t) for the corresponding (i,j) pixel in depth frame
-    // Algo intermediate data:
-    // Vector of depth values (floats) in size of the mapped texture (different from depth width*height) where
-    // each (i,j) cell holds the minimal Z among all the depth pixels that are mapped to the specific texel
-    void occlusion_filter::comprehensive_invalidation(float3* points, float2* uv_map, const std::vector<float2> & pix_coord) const
+    // Each row, or each column for sensors aligned vertically, only reads and invalidates its own pixels, so
+    // they are scanned in parallel
+    void occlusion_filter::monotonic_heuristic_invalidation(float3* points, const std::vector<float2>& pix_coord, const rs2::depth_frame& depth,
+        uint8_t* mask, unsigned int max_threads)
     {
-        auto depth_points = points;
-        auto mapped_pix = pix_coord.data();
-        size_t mapped_tex_width = _texels_intrinsics->width;
-        size_t mapped_tex_height = _texels_intrinsics->height;
         size_t points_width = _depth_intrinsics->width;
         size_t points_height = _depth_intrinsics->height;
+        auto& pool = thread_pool::get_default();
 
-        static const float z_threshold = 0.05f; // Compensate for temporal noise when comparing Z values
+        if (_occlusion_scanning == horizontal)
+        {
+            pool.parallel_for(int(points_height), max_threads, [&](int begin, int end)
+            {
+                horizontal_scan(points, pix_coord.data(), mask, points_width, begin, end);
+            });
+        }
+        else if (_occlusion_scanning == vertical)
+        {
+            auto depth_data = static_cast<const uint16_t*>(depth.get_data());
+            auto stripes = int((points_width + VERTICAL_SCAN_STRIPE - 1) / VERTICAL_SCAN_STRIPE);
+            pool.parallel_for(stripes, max_threads, [&](int begin, int end)
+            {
+                vertical_scan(points, pix_coord.data(), depth_data, mask, points_width, points_height,
+                    begin * VERTICAL_SCAN_STRIPE, std::min<size_t>(end * VERTICAL_SCAN_STRIPE, points_width));
+            });
+        }
+    }
 
-        // Clear previous data
-        memset((void*)(_texels_depth.data()), 0, _texels_depth.size() * sizeof(float));
+    // The pixels that pass by keeping the texture x rising are skipped in runs by the scan kernel; the
+    // pixel it stops at, and those the dilation after an occlusion takes, are decided here
+    void occlusion_filter::horizontal_scan(float3* points, const float2* pixels, uint8_t* mask, size_t width, size_t begin, size_t end) const
+    {
+        const float occZTh = 0.1f; //meters
+        const int occDilationSz = 1;
+        auto run = get_unpack_kernels().occlusion_run;
 
-        // Pass1 -generate texels mapping with minimal depth for each texel involved
-        for (size_t i = 0; i < points_height; i++)
+        for (size_t y = begin; y < end; ++y)
         {
-            for (size_t j = 0; j < points_width; j++)
+            auto points_ptr = points + y * width;
+            auto pixels_ptr = pixels + y * width;
+            auto mask_ptr = mask ? mask + y * width : nullptr;
+            float maxInLine = -1;
+            float maxZ = 0;
+            int occDilationLeft = 0;
+
+            for (size_t x = 0; x < width; ++x)
             {
-                if ((depth_points->z > 0.0001f) &&
-                    (mapped_pix->x > 0.f) && (mapped_pix->x < mapped_tex_width) &&
-                    (mapped_pix->y > 0.f) && (mapped_pix->y < mapped_tex_height))
+                if (!occDilationLeft)
                 {
-                    size_t texel_index = (size_t)(mapped_pix->y)*mapped_tex_width + (size_t)(mapped_pix->x);
+                    x += run(&pixels_ptr[x].x, &points_ptr[x].x, int(width - x), maxInLine, maxZ);
+                    if (x == width)
+                        break;
+                }
 
-                    if ((_texels_depth[texel_index] < 0.0001f) || ((_texels_depth[texel_index] + z_threshold) > depth_points->z))
+                auto& point = points_ptr[x];
+                auto& pixel = pixels_ptr[x];
+                if (point.z)
+                {
+                    //Occlusion detection
+                    if (pixel.x < maxInLine || (pixel.x == maxInLine && (point.z - maxZ) > occZTh))
                     {
-                        _texels_depth[texel_index] = depth_points->z;
+                        point = { 0, 0, 0 };
+                        occDilationLeft = occDilationSz;
+                        if (mask_ptr)
+                            mask_ptr[x] = 1;
+                    }
+                    else
+                    {
+                        maxInLine = pixel.x;
+                        maxZ = point.z;
+                        if (occDilationLeft > 0)
+                        {
+                            point = { 0, 0, 0 };
+                            occDilationLeft--;
+                            if (mask_ptr)
+                                mask_ptr[x] = 1;
+                        }
                     }
                 }
-
-                ++depth_points;
-                ++mapped_pix;
             }
         }
+    }
 
-        mapped_pix = pix_coord.data();
-        depth_points = points;
-        auto uv_ptr = uv_map;
-
-        // Pass2 -invalidate depth texels with occlusion traits
-        for (size_t i = 0; i < points_height; i++)
+    // Check each depth pixel against the one above it: a noticeable jump in depth means there could be an
+    // occlusion, and only there the texture y is scanned down the window below it. The top row has no
+    // pixel above it to compare with. Rows are walked top to bottom over a stripe of columns, which
+    // changes nothing for a column but reads the frame a cache line at a time
+    void occlusion_filter::vertical_scan(float3* points, const float2* pixels, const uint16_t* depth, uint8_t* mask,
+        size_t width, size_t height, size_t begin, size_t end) const
+    {
+        float scaled_threshold = DEPTH_OCCLUSION_THRESHOLD / _depth_units;
+        for (size_t row = 1; row + VERTICAL_SCAN_WINDOW_SIZE < height; ++row)
         {
-            for (size_t j = 0; j < points_width; j++)
+            auto above = depth + (row - 1) * width;
+            auto current = depth + row * width;
+            for (size_t col = begin; col < end; ++col)
             {
-                if ((depth_points->z > 0.0001f) &&
-                    (mapped_pix->x > 0.f) && (mapped_pix->x < mapped_tex_width) &&
-                    (mapped_pix->y > 0.f) && (mapped_pix->y < mapped_tex_height))
+                uint16_t diff = abs(int(current[col]) - int(above[col]));
+                if (diff > scaled_threshold)
                 {
-                    size_t texel_index = (size_t)(mapped_pix->y)*mapped_tex_width + (size_t)(mapped_pix->x);
-
-                    if ((_texels_depth[texel_index] > 0.0001f) && ((_texels_depth[texel_index] + z_threshold) < depth_points->z))
+                    auto index = row * width + col;
+                    float maxInLine = pixels[index - width].y;
+                    for (size_t y = 0; y <= VERTICAL_SCAN_WINDOW_SIZE; ++y)
                     {
-                        *uv_ptr = { 0.f, 0.f };
+                        auto i = index + y * width;
+                        if (pixels[i].y < maxInLine)
+                        {
+                            points[i] = { 0.f, 0.f, 0.f };
+                            if (mask)
+                                mask[i] = 1;
+                        }
+                        else
+                        {
+                            break;
+                        }
                     }
                 }
+            }
+        }
+    }
+
+    // Prepare texture map without occlusion that for every texture coordinate there no more than one depth point that is mapped to it
+    // i.e. for every (u,v) map coordinate we select the depth point with minimum Z. all other points that are mapped to this texel will be invalidated
+    // Algo input data:
+    // Vector of 3D [xyz] coordinates of depth_width*depth_height size
+    // Vector of 2D [i,j] coordinates where the val[i,j] stores the texture coordinate (s,t) for the corresponding (i,j) pixel in depth frame
+    // Algo intermediate data:
+    // The z-buffer of the size of the mapped texture (different from depth width*height) where
+    // each (i,j) cell holds the minimal Z among all the depth pixels that are mapped to the specific texel
+    // The z-buffer is filled in pixel order, since which depth a texel keeps depends on the order the pixels
+    // come in, and the texel of each pixel is kept for the invalidation, which is split across threads
+    void occlusion_filter::comprehensive_invalidation(float3* points, float2* uv_map, const std::vector<float2> & pix_coord,
+        uint8_t* mask, unsigned int max_threads)
+    {
+        auto mapped_pix = pix_coord.data();
+        size_t count = pix_coord.size();
+        auto& pool = thread_pool::get_default();
+        const int chunk = 4096;
+        const int chunks = int((count + chunk - 1) / chunk);
+
+        static const float z_threshold = 0.05f; // Compensate for temporal noise when comparing Z values
+
+        _texel_indices.resize(count);
+        _texels_depth.next_frame();
+
+        // Pass1 -generate texels mapping with minimal depth for each texel involved
+        for (size_t i = 0; i < count; i++)
+        {
+            auto index = points[i].z > 0.0001f ? _texels_depth.index(mapped_pix[i].x, mapped_pix[i].y) : texel_z_buffer::npos;
+            _texel_indices[i] = index;
+            if (index == texel_z_buffer::npos)
+                continue;
 
-                ++depth_points;
-                ++mapped_pix;
-                ++uv_ptr;
+            auto& texel = _texels_depth.at(index);
+            if ((texel < 0.0001f) || ((texel + z_threshold) > points[i].z))
+            {
+                texel = points[i].z;
             }
         }
+
+        // Pass2 -invalidate depth texels with occlusion traits
+        pool.parallel_for(chunks, max_threads, [&](int begin, int end)
+        {
+            auto indices = _texel_indices.data();
+            for (size_t i = size_t(begin) * chunk, last = std::min(size_t(end) * chunk, count); i < last; i++)
+            {
+                auto index = indices[i];
+                if (index == texel_z_buffer::npos)
+                    continue;
+
+                auto texel = _texels_depth.get(index);
+                if ((texel > 0.0001f) && ((texel + z_threshold) < points[i].z))
+                {
+                    uv_map[i] = { 0.f, 0.f };
+                    if (mask)
+                        mask[i] = 1;
+                }
+            }
+        });
     }
 }
@@ -11,6 +11,7 @@ namespace librealsense
         occlusion_min,
         occlusion_none,
         occlusion_monotonic_scan,
+        occlusion_z_buffer,
         occlusion_max
     };
 
@@ -28,13 +29,18 @@ namespace librealsense
 
         bool active(void) const { return (occlusion_none != _occlusion_filter); };
 
-        void process(float3* points, float2* uv_map, const std::vector<float2> & pix_coord, const rs2::depth_frame& depth) const;
+        // Invalidates the points, or in z-buffer mode the texture coordinates, of the pixels the other
+        // camera does not see. mask, when given, gets 1 for each pixel invalidated and 0 for the rest.
+        // The passes are split across at most max_threads threads of the shared pool, 0 for all of it
+        void process(float3* points, float2* uv_map, const std::vector<float2> & pix_coord, const rs2::depth_frame& depth,
+            uint8_t* mask = nullptr, unsigned int max_threads = 0);
 
         void set_mode(uint8_t filter_type) { _occlusion_filter = (occlusion_rect_type)filter_type; }
         void set_scanning(uint8_t scanning) { _occlusion_scanning = (occlusion_scanning_type)scanning; }
 
         void set_texel_intrinsics(const rs2_intrinsics& in);
         void set_depth_intrinsics(const rs2_intrinsics& in) { _depth_intrinsics = in; }
+        void set_depth_units(float units) { _depth_units = units; }
 
         occlusion_scanning_type find_scanning_direction(const rs2_extrinsics& extr)
         {
@@ -53,12 +59,43 @@ namespace librealsense
 
         friend class pointcloud;
 
-        void monotonic_heuristic_invalidation(float3* points, float2* uv_map, const std::vector<float2> & pix_coord, const rs2::depth_frame& depth) const;;
-        void comprehensive_invalidation(float3* points, float2* uv_map, const std::vector<float2> & pix_coord) const;
+        // Nearest depth per texel of the other camera, kept from frame to frame in tiles of 32 x 32
+        // texels. A tile is cleared by the first frame that maps depth into it after the frame stamp
+        // moves on, so a frame costs the tiles it touches rather than the whole texture
+        class texel_z_buffer
+        {
+        public:
+            static const size_t TILE_BITS = 5;
+            static const size_t TILE_SIZE = 1 << TILE_BITS;
+
+            void resize(size_t width, size_t height);
+            void next_frame();
+
+            // Of the texel under a texture pixel, npos for pixels outside the texture
+            uint32_t index(float x, float y) const;
+
+            float& at(uint32_t index); // clears the tile for this frame
+            float get(uint32_t index) const { return _stamps[index >> (2 * TILE_BITS)] == _frame ? _depth[index] : 0.f; }
+
+            static const uint32_t npos = uint32_t(-1);
+
+        private:
+            float _width = 0, _height = 0;     // compared with the texture pixels as floats
+            uint32_t _tiles_per_row = 0;
+            std::vector<float> _depth;          // tile by tile, each row by row
+            std::vector<uint32_t> _stamps;      // frame of the last clearing, per tile
+            uint32_t _frame = 0;
+        };
+
+        void monotonic_heuristic_invalidation(float3* points, const std::vector<float2> & pix_coord, const rs2::depth_frame& depth, uint8_t* mask, unsigned int max_threads);
+        void horizontal_scan(float3* points, const float2* pixels, uint8_t* mask, size_t width, size_t begin, size_t end) const;
+        void vertical_scan(float3* points, const float2* pixels, const uint16_t* depth, uint8_t* mask, size_t width, size_t height, size_t begin, size_t end) const;
+        void comprehensive_invalidation(float3* points, float2* uv_map, const std::vector<float2> & pix_coord, uint8_t* mask, unsigned int max_threads);
 
         optional_value<rs2_intrinsics>              _depth_intrinsics;
         optional_value<rs2_intrinsics>              _texels_intrinsics;
-        mutable std::vector<float>                  _texels_depth; // Temporal translation table of (mapped_x*mapped_y) holds the minimal depth value among all depth pixels mapped to that texel
+        texel_z_buffer                              _texels_depth;  // holds the minimal depth among all depth pixels mapped to each texel
+        std::vector<uint32_t>                       _texel_indices; // of each depth pixel in the z-buffer, between its passes
         occlusion_rect_type                         _occlusion_filter;
         occlusion_scanning_type                     _occlusion_scanning;
         float                                       _depth_units;
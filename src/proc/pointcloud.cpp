@@ -9,35 +9,120 @@
 #include "option.h"
 #include "environment.h"
 #include "context.h"
+#include "image-simd.h"
 #include <iostream>
 
 #ifdef RS2_USE_CUDA
 #include "proc/cuda/cuda-pointcloud.h"
 #endif
-#ifdef __SSSE3__
-#include "proc/sse/sse-pointcloud.h"
-#endif
 
 namespace librealsense
 {
-    template<class MAP_DEPTH> void deproject_depth(float * points, const rs2_intrinsics & intrin, const uint16_t * depth, MAP_DEPTH map_depth)
+    namespace
+    {
+        bool same_intrinsics(const rs2_intrinsics& a, const rs2_intrinsics& b)
+        {
+            return !memcmp(&a, &b, sizeof(a));
+        }
+
+        // The rays are deprojected at a depth of 1, so scaling them by a depth gives the point
+        // rs2_deproject_pixel_to_point would, to the bit, whatever the distortion model
+        std::shared_ptr<const depth_rays> make_depth_rays(const rs2_intrinsics& intrinsics)
+        {
+            auto rays = std::make_shared<depth_rays>();
+            rays->intrinsics = intrinsics;
+            rays->x.resize(intrinsics.width * intrinsics.height);
+            rays->y.resize(intrinsics.width * intrinsics.height);
+            for (int y = 0, i = 0; y < intrinsics.height; ++y)
+            {
+                for (int x = 0; x < intrinsics.width; ++x, ++i)
+                {
+                    const float pixel[] = { (float)x, (float)y };
+                    float point[3];
+                    rs2_deproject_pixel_to_point(point, &intrinsics, pixel, 1.f);
+                    rays->x[i] = point[0];
+                    rays->y[i] = point[1];
+                }
+            }
+            return rays;
+        }
+
+        // The vector kernels cover the models most cameras report; the others project point by point
+        bool make_point_projection(const rs2_intrinsics& intrinsics, const rs2_extrinsics& extrinsics, point_projection& p)
+        {
+            switch (intrinsics.model)
+            {
+            case RS2_DISTORTION_NONE:
+            case RS2_DISTORTION_BROWN_CONRADY:
+                p.distort = false;
+                break;
+            case RS2_DISTORTION_MODIFIED_BROWN_CONRADY:
+            case RS2_DISTORTION_INVERSE_BROWN_CONRADY:
+                p.distort = true;
+                break;
+            default:
+                return false;
+            }
+            std::copy(std::begin(extrinsics.rotation), std::end(extrinsics.rotation), p.rotation);
+            std::copy(std::begin(extrinsics.translation), std::end(extrinsics.translation), p.translation);
+            std::copy(std::begin(intrinsics.coeffs), std::end(intrinsics.coeffs), p.coeffs);
+            p.fx = intrinsics.fx;
+            p.fy = intrinsics.fy;
+            p.ppx = intrinsics.ppx;
+            p.ppy = intrinsics.ppy;
+            p.width = static_cast<float>(intrinsics.width);
+            p.height = static_cast<float>(intrinsics.height);
+            return true;
+        }
+
+        // Over the three planes of the planar layout
+        size_t get_vertex_size(rs2_vertex_layout layout)
+        {
+            switch (layout)
+            {
+            case RS2_VERTEX_LAYOUT_XYZ32F: return 3 * sizeof(float);
+            case RS2_VERTEX_LAYOUT_PLANAR32F: return 3 * sizeof(float);
+            case RS2_VERTEX_LAYOUT_XYZ16F: return 3 * sizeof(uint16_t);
+            default: throw invalid_value_exception(to_string() << "Unsupported vertex layout " << layout);
+            }
+        }
+    }
+
+    std::shared_ptr<const depth_rays> depth_rays::get(const rs2_intrinsics& intrinsics)
     {
-        for (int y = 0; y < intrin.height; ++y)
+        static std::mutex mutex;
+        static std::vector<std::weak_ptr<const depth_rays>> cache;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        std::shared_ptr<const depth_rays> rays;
+        for (auto it = cache.begin(); it != cache.end();)
         {
-            for (int x = 0; x < intrin.width; ++x)
+            auto cached = it->lock();
+            if (!cached)
             {
-                const float pixel[] = { (float)x, (float)y };
-                rs2_deproject_pixel_to_point(points, &intrin, pixel, map_depth(*depth++));
-                points += 3;
+                it = cache.erase(it);
+                continue;
             }
+            if (same_intrinsics(cached->intrinsics, intrinsics))
+                rays = cached;
+            ++it;
+        }
+
+        if (!rays)
+        {
+            rays = make_depth_rays(intrinsics);
+            cache.push_back(rays);
         }
+        return rays;
     }
 
     const float3 * pointcloud::depth_to_points(rs2::points output, 
         const rs2_intrinsics &depth_intrinsics, const rs2::depth_frame& depth_frame, float depth_scale)
     {
         auto image = output.get_vertices();
-        deproject_depth((float*)image, depth_intrinsics, (const uint16_t*)depth_frame.get_data(), [depth_scale](uint16_t z) { return depth_scale * z; });
+        uint8_t* dst[] = { (uint8_t*)image };
+        get_unpack_kernels().deproject_xyz(dst, (const uint16_t*)depth_frame.get_data(), _rays->x.data(), _rays->y.data(),
+            depth_intrinsics.width * depth_intrinsics.height, depth_scale);
         return (float3*)image;
     }
 
@@ -67,27 +152,25 @@ namespace librealsense
         {
             _output_stream = depth.get_profile().as<rs2::video_stream_profile>().clone(
                 RS2_STREAM_DEPTH, depth.get_profile().stream_index(), RS2_FORMAT_XYZ32F);
+            _mask_stream = depth.get_profile().as<rs2::video_stream_profile>().clone(
+                RS2_STREAM_DEPTH, depth.get_profile().stream_index(), RS2_FORMAT_Y8);
             _depth_stream = depth;
             _depth_intrinsics = optional_value<rs2_intrinsics>();
             _depth_units = optional_value<float>();
             _extrinsics = optional_value<rs2_extrinsics>();
         }
 
-        bool found_depth_intrinsics = false;
-        bool found_depth_units = false;
-
-        if (!_depth_intrinsics)
+        // The intrinsics are read on every frame, so that the rays follow a new calibration
+        auto stream_profile = depth.get_profile();
+        if (auto video = stream_profile.as<rs2::video_stream_profile>())
         {
-            auto stream_profile = depth.get_profile();
-            if (auto video = stream_profile.as<rs2::video_stream_profile>())
+            auto intrinsics = video.get_intrinsics();
+            if (!_depth_intrinsics || !same_intrinsics(*_depth_intrinsics, intrinsics))
             {
-                _depth_intrinsics = video.get_intrinsics();
-                _pixels_map.resize(_depth_intrinsics->height*_depth_intrinsics->width);
-                _occlusion_filter->set_depth_intrinsics(_depth_intrinsics.value());
-
-                preprocess();
-
-                found_depth_intrinsics = true;
+                _depth_intrinsics = intrinsics;
+                _pixels_map.resize(intrinsics.height * intrinsics.width);
+                _occlusion_filter->set_depth_intrinsics(intrinsics);
+                _rays = depth_rays::get(intrinsics);
             }
         }
 
@@ -95,7 +178,6 @@ namespace librealsense
         {
             auto sensor = ((frame_interface*)depth.get())->get_sensor().get();
             _depth_units = sensor->get_option(RS2_OPTION_DEPTH_UNITS).query();
-            found_depth_units = true;
         }
 
         set_extrinsics();
@@ -108,20 +190,22 @@ namespace librealsense
             _prev_stream_filter = _stream_filter;
         }
 
-        if (_extrinsics.has_value() && other.get_profile().get() == _other_stream.get_profile().get())
-            return;
-
-        _other_stream = other;
-        _other_intrinsics = optional_value<rs2_intrinsics>();
-        _extrinsics = optional_value<rs2_extrinsics>();
+        if (!_extrinsics.has_value() || other.get_profile().get() != _other_stream.get_profile().get())
+        {
+            _other_stream = other;
+            _other_intrinsics = optional_value<rs2_intrinsics>();
+            _extrinsics = optional_value<rs2_extrinsics>();
+        }
 
-        if (!_other_intrinsics)
+        // Read on every frame, as the depth intrinsics are
+        auto stream_profile = _other_stream.get_profile();
+        if (auto video = stream_profile.as<rs2::video_stream_profile>())
         {
-            auto stream_profile = _other_stream.get_profile();
-            if (auto video = stream_profile.as<rs2::video_stream_profile>())
+            auto intrinsics = video.get_intrinsics();
+            if (!_other_intrinsics || !same_intrinsics(*_other_intrinsics, intrinsics))
             {
-                _other_intrinsics = video.get_intrinsics();
-                _occlusion_filter->set_texel_intrinsics(_other_intrinsics.value());
+                _other_intrinsics = intrinsics;
+                _occlusion_filter->set_texel_intrinsics(intrinsics);
             }
         }
 
@@ -138,6 +222,14 @@ namespace librealsense
     {
         auto tex_ptr = (float2*)output.get_texture_coordinates();
 
+        point_projection projection;
+        if (make_point_projection(other_intrinsics, extr, projection))
+        {
+            get_unpack_kernels().texture_map(reinterpret_cast<float*>(tex_ptr), reinterpret_cast<float*>(pixels_ptr),
+                reinterpret_cast<const float*>(points), width * height, projection);
+            return;
+        }
+
         for (unsigned int y = 0; y < height; ++y)
         {
             for (unsigned int x = 0; x < width; ++x)
@@ -178,6 +270,15 @@ namespace librealsense
 
         auto vid_frame = depth.as<rs2::video_frame>();
 
+        // The pixels the occlusion removal invalidated, 1 for each, when the mask was asked for
+        rs2::frame mask;
+        if (_occlusion_mask)
+        {
+            auto width = vid_frame.get_width();
+            mask = source.allocate_video_frame(_mask_stream, depth, 1, width, vid_frame.get_height(), width, RS2_EXTENSION_VIDEO_FRAME);
+        }
+        auto mask_data = mask ? static_cast<uint8_t*>(const_cast<void*>(mask.get_data())) : nullptr;
+
         // Pixels calculated in the mapped texture. Used in post-processing filters
         float2* pixels_ptr = _pixels_map.data();
         rs2_intrinsics mapped_intr;
@@ -204,14 +305,61 @@ namespace librealsense
                 if (_occlusion_filter->find_scanning_direction(extr) == vertical)
                 {
                     _occlusion_filter->set_scanning(static_cast<uint8_t>(vertical));
-                    _occlusion_filter->_depth_units = _depth_units.value();
+                    _occlusion_filter->set_depth_units(_depth_units.value());
                 }
-                _occlusion_filter->process(pframe->get_vertices(), pframe->get_texture_coordinates(), _pixels_map, depth);
+                _occlusion_filter->process(pframe->get_vertices(), pframe->get_texture_coordinates(), _pixels_map, depth,
+                    mask_data, _processing_threads);
+                mask_data = nullptr;
             }
         }
+
+        if (mask_data)
+            memset(mask_data, 0, _pixels_map.size());
+        if (mask)
+            return source.allocate_composite_frame({ res, mask });
         return res;
     }
 
+    int pointcloud::calculate_vertices(const rs2::frame& depth, rs2_vertex_layout layout, void* buffer, size_t size)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!depth.is<rs2::depth_frame>() || depth.get_profile().format() != RS2_FORMAT_Z16)
+            throw invalid_value_exception("Vertices are calculated from Z16 depth frames only");
+
+        inspect_depth_frame(depth);
+        auto count = _depth_intrinsics->width * _depth_intrinsics->height;
+        auto needed = count * get_vertex_size(layout);
+        if (size < needed)
+            throw invalid_value_exception(to_string() << "Buffer of " << size << " bytes is too small for " << count
+                << " vertices in " << get_string(layout) << ", " << needed << " bytes are needed");
+
+        auto& kernels = get_unpack_kernels();
+        auto data = static_cast<const uint16_t*>(depth.get_data());
+        auto out = static_cast<uint8_t*>(buffer);
+        switch (layout)
+        {
+        case RS2_VERTEX_LAYOUT_XYZ32F:
+        {
+            uint8_t* dst[] = { out };
+            kernels.deproject_xyz(dst, data, _rays->x.data(), _rays->y.data(), count, *_depth_units);
+            break;
+        }
+        case RS2_VERTEX_LAYOUT_PLANAR32F:
+        {
+            uint8_t* dst[] = { out, out + count * sizeof(float), out + count * 2 * sizeof(float) };
+            kernels.deproject_planar(dst, data, _rays->x.data(), _rays->y.data(), count, *_depth_units);
+            break;
+        }
+        default:
+        {
+            uint8_t* dst[] = { out };
+            kernels.deproject_xyz_half(dst, data, _rays->x.data(), _rays->y.data(), count, *_depth_units);
+            break;
+        }
+        }
+        return count;
+    }
+
     pointcloud::pointcloud()
         : pointcloud("Pointcloud")
     {}
@@ -238,7 +386,14 @@ namespace librealsense
         });
         occlusion_invalidation->set_description(1.f, "Off");
         occlusion_invalidation->set_description(2.f, "On");
+        occlusion_invalidation->set_description(3.f, "Z-buffer");
         register_option(RS2_OPTION_FILTER_MAGNITUDE, occlusion_invalidation);
+
+        auto occlusion_mask = std::make_shared<ptr_option<bool>>(false, true, true, false, &_occlusion_mask,
+            "Output a Y8 frame of the depth pixels the occlusion removal invalidated along with the points");
+        register_option(RS2_OPTION_OCCLUSION_MASK, occlusion_mask);
+
+        register_processing_threads_option();
     }
 
     bool pointcloud::should_process(const rs2::frame& frame)
@@ -284,6 +439,7 @@ namespace librealsense
 
     rs2::frame pointcloud::process_frame(const rs2::frame_source& source, const rs2::frame& f)
     {
+        std::lock_guard<std::mutex> lock(_mutex);
         rs2::frame rv;
         if (auto composite = f.as<rs2::frameset>())
         {
@@ -309,17 +465,21 @@ namespace librealsense
         return rv;
     }
 
+    // The points and the occlusion mask of a single depth frame go out together, as a frameset
+    rs2::frame pointcloud::prepare_output(const rs2::frame_source& source, rs2::frame input, std::vector<rs2::frame> results)
+    {
+        if (results.size() > 1 && !input.is<rs2::frameset>())
+            return source.allocate_composite_frame(results);
+        return stream_filter_processing_block::prepare_output(source, input, results);
+    }
+
     std::shared_ptr<pointcloud> pointcloud::create()
     {
         #ifdef RS2_USE_CUDA
             return std::make_shared<librealsense::pointcloud_cuda>();
-        #else
-        #ifdef __SSSE3__
-            return std::make_shared<librealsense::pointcloud_sse>();
         #else
             return std::make_shared<librealsense::pointcloud>();
         #endif
-        #endif
     }
 
     bool pointcloud::run__occlusion_filter(const rs2_extrinsics& extr)
@@ -3,11 +3,24 @@
 
 #pragma once
 #include "../include/librealsense2/hpp/rs_frame.hpp"
+#include "synthetic-stream.h"
+#include <mutex>
 
 namespace librealsense
 {
     class occlusion_filter;
 
+    // The ray of every pixel of a depth camera at z = 1, which turns deprojection into a
+    // multiplication by the depth. Pointclouds of the same intrinsics share one table for as long
+    // as any of them holds it
+    struct depth_rays
+    {
+        rs2_intrinsics intrinsics;
+        std::vector<float> x, y;
+
+        static std::shared_ptr<const depth_rays> get(const rs2_intrinsics& intrinsics);
+    };
+
     class LRS_EXTENSION_API pointcloud : public stream_filter_processing_block
     {
     public:
@@ -15,6 +28,10 @@ namespace librealsense
 
         pointcloud();
 
+        // Writes the vertices of a Z16 depth frame into the caller's buffer in the given layout,
+        // one per depth pixel, and returns their number. No texture coordinates are calculated
+        int calculate_vertices(const rs2::frame& depth, rs2_vertex_layout layout, void* buffer, size_t size);
+
         virtual const float3 * depth_to_points(
             rs2::points output,
             const rs2_intrinsics &depth_intrinsics, 
@@ -29,7 +46,6 @@ namespace librealsense
             const rs2_extrinsics& extr,
             float2* pixels_ptr);
         virtual rs2::points allocate_points(const rs2::frame_source& source, const rs2::frame& f);
-        virtual void preprocess() {}
         virtual bool run__occlusion_filter(const rs2_extrinsics& extr);
 
     protected:
@@ -37,17 +53,21 @@ namespace librealsense
 
         bool should_process(const rs2::frame& frame) override;
         rs2::frame process_frame(const rs2::frame_source& source, const rs2::frame& f) override;
+        rs2::frame prepare_output(const rs2::frame_source& source, rs2::frame input, std::vector<rs2::frame> results) override;
 
         optional_value<rs2_intrinsics>         _depth_intrinsics;
         optional_value<rs2_intrinsics>         _other_intrinsics;
         optional_value<float>                  _depth_units;
         optional_value<rs2_extrinsics>         _extrinsics;
         std::shared_ptr<occlusion_filter>      _occlusion_filter;
+        std::shared_ptr<const depth_rays>      _rays;
 
         // Intermediate translation table of (depth_x*depth_y) with actual texel coordinates per depth pixel
         std::vector<float2>                    _pixels_map;
 
         rs2::stream_profile _output_stream;
+        rs2::stream_profile _mask_stream;       // Y8 of the depth stream, for the occlusion mask
+        bool _occlusion_mask = false;           // output the mask along with the points
         rs2::frame _other_stream;
         rs2::frame _depth_stream;
 
@@ -57,5 +77,8 @@ namespace librealsense
         void set_extrinsics();
 
         stream_filter _prev_stream_filter;
+
+        // Between processing and calculate_vertices, which may come from another thread
+        std::mutex _mutex;
     };
 }
@@ -7,6 +7,7 @@
 #include "../include/librealsense2/hpp/rs_processing.hpp"
 #include "context.h"
 #include "image.h"
+#include "image-simd.h"
 #include "stream.h"
 
 namespace librealsense
@@ -19,25 +20,14 @@ namespace librealsense
         auto height_out = width;
 
         auto out = dest[0];
-        byte buffer[8][8 * SIZE]; // = { 0 };
+        auto rotate_tile = SIZE == 1 ? get_unpack_kernels().rotate_8x8_u8 : get_unpack_kernels().rotate_8x8_u16;
         for (int i = 0; i <= height - 8; i = i + 8)
         {
             for (int j = 0; j <= width - 8; j = j + 8)
             {
-                for (int ii = 0; ii < 8; ++ii)
-                {
-                    for (int jj = 0; jj < 8; ++jj)
-                    {
-                        auto source_index = ((j + jj) + (width * (i + ii))) * SIZE;
-                        memcpy((void*)(&buffer[7 - jj][(7 - ii) * SIZE]), &source[source_index], SIZE);
-                    }
-                }
-
-                for (int ii = 0; ii < 8; ++ii)
-                {
-                    auto out_index = (((height_out - 8 - j + 1) * width_out) - i - 8 + (ii)* width_out);
-                    memcpy(&out[(out_index)* SIZE], &(buffer[ii]), 8 * SIZE);
-                }
+                auto source_index = (j + width * i) * SIZE;
+                auto out_index = (((height_out - 8 - j + 1) * width_out) - i - 8);
+                rotate_tile(&out[out_index * SIZE], int(width_out * SIZE), &source[source_index], int(width * SIZE));
             }
         }
     }
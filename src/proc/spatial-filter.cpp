@@ -142,6 +142,7 @@ namespace librealsense
         register_option(RS2_OPTION_FILTER_SMOOTH_DELTA, spatial_filter_delta);
         register_option(RS2_OPTION_FILTER_MAGNITUDE, spatial_filter_iterations);
         register_option(RS2_OPTION_HOLES_FILL, holes_filling_mode);
+        register_processing_threads_option();
     }
 
     rs2::frame spatial_filter::process_frame(const rs2::frame_source& source, const rs2::frame& f)
@@ -223,21 +224,21 @@ namespace librealsense
         return tgt;
     }
 
-    void spatial_filter::recursive_filter_horizontal_fp(void * image_data, float alpha, float deltaZ)
+    void spatial_filter::recursive_filter_horizontal_fp(void * image_data, size_t width, size_t height, float alpha, float deltaZ, size_t row_begin, size_t row_end)
     {
         float *image = reinterpret_cast<float*>(image_data);
 
         int v, u;
 
-        for (v = 0; v < _height;) {
+        for (v = int(row_begin); v < row_end;) {
             // left to right
-            float *im = image + v * _width;
+            float *im = image + v * width;
             float state = *im;
             float previousInnovation = state;
 
             im++;
             float innovation = *im;
-            u = int(_width) - 1;
+            u = int(width) - 1;
             if (!(*(int*)&previousInnovation > 0))
                 goto CurrentlyInvalidLR;
             // else fall through
@@ -292,9 +293,9 @@ namespace librealsense
         DoneLR:
 
             // right to left
-            im = image + (v + 1) * _width - 2;  // end of row - two pixels
+            im = image + (v + 1) * width - 2;  // end of row - two pixels
             previousInnovation = state = im[1];
-            u = int(_width) - 1;
+            u = int(width) - 1;
             innovation = *im;
             if (!(*(int*)&previousInnovation > 0))
                 goto CurrentlyInvalidRL;
@@ -351,7 +352,7 @@ namespace librealsense
         }
     }
 
-    void spatial_filter::recursive_filter_vertical_fp(void * image_data, float alpha, float deltaZ)
+    void spatial_filter::recursive_filter_vertical_fp(void * image_data, size_t width, size_t height, float alpha, float deltaZ, size_t col_begin, size_t col_end)
     {
         float *image = reinterpret_cast<float*>(image_data);
 
@@ -359,14 +360,14 @@ namespace librealsense
 
         // we'll do one column at a time, top to bottom, bottom to top, left to right,
 
-        for (u = 0; u < _width;) {
+        for (u = int(col_begin); u < col_end;) {
 
             float *im = image + u;
             float state = im[0];
             float previousInnovation = state;
 
-            v = int(_height) - 1;
-            im += _width;
+            v = int(height) - 1;
+            im += width;
             float innovation = *im;
 
             if (!(*(int*)&previousInnovation > 0))
@@ -390,7 +391,7 @@ namespace librealsense
                     if (v <= 0)
                         goto DoneTB;
                     previousInnovation = innovation;
-                    im += _width;
+                    im += width;
                     innovation = *im;
                 }
                 else {  // switch to CurrentlyInvalid state
@@ -398,7 +399,7 @@ namespace librealsense
                     if (v <= 0)
                         goto DoneTB;
                     previousInnovation = innovation;
-                    im += _width;
+                    im += width;
                     innovation = *im;
                     goto CurrentlyInvalidTB;
                 }
@@ -411,22 +412,22 @@ namespace librealsense
                     goto DoneTB;
                 if (*(int*)&innovation > 0) { // switch to CurrentlyValid state
                     previousInnovation = state = innovation;
-                    im += _width;
+                    im += width;
                     innovation = *im;
                     goto CurrentlyValidTB;
                 }
                 else {
-                    im += _width;
+                    im += width;
                     innovation = *im;
                 }
             }
         DoneTB:
 
-            im = image + u + (_height - 2) * _width;
-            state = im[_width];
+            im = image + u + (height - 2) * width;
+            state = im[width];
             previousInnovation = state;
             innovation = *im;
-            v = int(_height) - 1;
+            v = int(height) - 1;
             if (!(*(int*)&previousInnovation > 0))
                 goto CurrentlyInvalidBT;
             // else fall through
@@ -447,7 +448,7 @@ namespace librealsense
                     if (v <= 0)
                         goto DoneBT;
                     previousInnovation = innovation;
-                    im -= _width;
+                    im -= width;
                     innovation = *im;
                 }
                 else {  // switch to CurrentlyInvalid state
@@ -455,7 +456,7 @@ namespace librealsense
                     if (v <= 0)
                         goto DoneBT;
                     previousInnovation = innovation;
-                    im -= _width;
+                    im -= width;
                     innovation = *im;
                     goto CurrentlyInvalidBT;
                 }
@@ -468,12 +469,12 @@ namespace librealsense
                     goto DoneBT;
                 if (*(int*)&innovation > 0) { // switch to CurrentlyValid state
                     previousInnovation = state = innovation;
-                    im -= _width;
+                    im -= width;
                     innovation = *im;
                     goto CurrentlyValidBT;
                 }
                 else {
-                    im -= _width;
+                    im -= width;
                     innovation = *im;
                 }
             }
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <map>
 #include <vector>
 #include <cmath>
@@ -35,31 +36,47 @@ namespace librealsense
             static_assert((std::is_arithmetic<T>::value), "Spatial filter assumes numeric types");
             bool fp = (std::is_floating_point<T>::value);
 
+            // Rows are independent in the horizontal pass and columns in the vertical one, so each
+            // pass is split into stripes across the shared pool. Column stripes are whole cache lines wide
+            const int rows = int(_height);
+            const int column_blocks = int((_width + COLUMN_BLOCK - 1) / COLUMN_BLOCK);
+            auto columns = [this](int block) { return std::min(size_t(block) * COLUMN_BLOCK, _width); };
+
             for (int i = 0; i < iterations; i++)
             {
                 if (fp)
                 {
-                    recursive_filter_horizontal_fp(frame_data, alpha, delta);
-                    recursive_filter_vertical_fp(frame_data, alpha, delta);
+                    parallel_for(rows, [&](int begin, int end) {
+                        recursive_filter_horizontal_fp(frame_data, _width, _height, alpha, delta, begin, end); });
+                    parallel_for(column_blocks, [&](int begin, int end) {
+                        recursive_filter_vertical_fp(frame_data, _width, _height, alpha, delta, columns(begin), columns(end)); });
                 }
                 else
                 {
-                    recursive_filter_horizontal<T>(frame_data, alpha, delta);
-                    recursive_filter_vertical<T>(frame_data, alpha, delta);
+                    parallel_for(rows, [&](int begin, int end) {
+                        recursive_filter_horizontal<T>(frame_data, _width, _height, alpha, delta, begin, end); });
+                    parallel_for(column_blocks, [&](int begin, int end) {
+                        recursive_filter_vertical<T>(frame_data, _width, _height, alpha, delta, columns(begin), columns(end)); });
                 }
             }
 
             // Disparity domain hole filling requires a second pass over the frame data
             // For depth domain a more efficient in-place hole filling is performed
             if (_holes_filling_mode && fp)
-                intertial_holes_fill<T>(static_cast<T*>(frame_data));
+                parallel_for(rows, [&](int begin, int end) {
+                    intertial_holes_fill<T>(static_cast<T*>(frame_data), _width, begin, end); });
         }
 
-        void recursive_filter_horizontal_fp(void * image_data, float alpha, float deltaZ);
-        void recursive_filter_vertical_fp(void * image_data, float alpha, float deltaZ);
+        // Columns handled by one vertical-pass stripe are a multiple of this, so that no two
+        // workers write to the same cache line
+        static const size_t COLUMN_BLOCK = 32;
+
+        // The passes work on a width x height image, over the given rows or columns of it
+        void recursive_filter_horizontal_fp(void * image_data, size_t width, size_t height, float alpha, float deltaZ, size_t row_begin, size_t row_end);
+        void recursive_filter_vertical_fp(void * image_data, size_t width, size_t height, float alpha, float deltaZ, size_t col_begin, size_t col_end);
 
         template <typename T>
-        void  recursive_filter_horizontal(void * image_data, float alpha, float deltaZ)
+        void  recursive_filter_horizontal(void * image_data, size_t width, size_t height, float alpha, float deltaZ, size_t row_begin, size_t row_end)
         {
             size_t v{}, u{};
 
@@ -75,14 +92,14 @@ namespace librealsense
             auto image = reinterpret_cast<T*>(image_data);
             size_t cur_fill = 0;
 
-            for (v = 0; v < _height; v++)
+            for (v = row_begin; v < row_end; v++)
             {
                 // left to right
-                T *im = image + v * _width;
+                T *im = image + v * width;
                 T val0 = im[0];
                 cur_fill = 0;
 
-                for (u = 1; u < _width - 1; u++)
+                for (u = 1; u < width - 1; u++)
                 {
                     T val1 = im[1];
 
@@ -115,11 +132,11 @@ namespace librealsense
                 }
 
                 // right to left
-                im = image + (v + 1) * _width - 2;  // end of row - two pixels
+                im = image + (v + 1) * width - 2;  // end of row - two pixels
                 T val1 = im[1];
                 cur_fill = 0;
 
-                for (u = _width - 1; u > 0; u--)
+                for (u = width - 1; u > 0; u--)
                 {
                     T val0 = im[0];
 
@@ -154,7 +171,7 @@ namespace librealsense
         }
 
         template <typename T>
-        void recursive_filter_vertical(void * image_data, float alpha, float deltaZ)
+        void recursive_filter_vertical(void * image_data, size_t width, size_t height, float alpha, float deltaZ, size_t col_begin, size_t col_end)
         {
             size_t v{}, u{};
 
@@ -173,15 +190,16 @@ namespace librealsense
 
             // top to bottom
 
-            T *im = image;
+            T *im = nullptr;
             T im0{};
             T imw{};
-            for (v = 1; v < _height; v++)
+            for (v = 1; v < height; v++)
             {
-                for (u = 0; u < _width; u++)
+                im = image + (v - 1) * width + col_begin;
+                for (u = col_begin; u < col_end; u++)
                 {
                     im0 = im[0];
-                    imw = im[_width];
+                    imw = im[width];
 
                     //if ((fabs(im0) >= valid_threshold) && (fabs(imw) >= valid_threshold))
                     {
@@ -189,7 +207,7 @@ namespace librealsense
                         if (diff < delta_z)
                         {
                             float filtered = imw * alpha + im0 * (1.f - alpha);
-                            im[_width] = static_cast<T>(filtered + round);
+                            im[width] = static_cast<T>(filtered + round);
                         }
                     }
                     im += 1;
@@ -197,13 +215,13 @@ namespace librealsense
             }
 
             // bottom to top
-            im = image + (_height - 2) * _width;
-            for (v = 1; v < _height; v++, im -= (_width * 2))
+            for (v = height - 1; v > 0; v--)
             {
-                for (u = 0; u < _width; u++)
+                im = image + (v - 1) * width + col_begin;
+                for (u = col_begin; u < col_end; u++)
                 {
                     im0 = im[0];
-                    imw = im[_width];
+                    imw = im[width];
 
                     if ((fabs(im0) >= valid_threshold) && (fabs(imw) >= valid_threshold))
                     {
@@ -220,7 +238,7 @@ namespace librealsense
         }
 
         template<typename T>
-        inline void intertial_holes_fill(T* image_data)
+        inline void intertial_holes_fill(T* image_data, size_t width, size_t row_begin, size_t row_end)
         {
             std::function<bool(T*)> fp_oper = [](T* ptr) { return !*((int *)ptr); };
             std::function<bool(T*)> uint_oper = [](T* ptr) { return !(*ptr); };
@@ -228,14 +246,14 @@ namespace librealsense
 
             size_t cur_fill = 0;
 
-            T* p = image_data;
-            for (int j = 0; j < _height; ++j)
+            T* p = image_data + row_begin * width;
+            for (size_t j = row_begin; j < row_end; ++j)
             {
                 ++p;
                 cur_fill = 0;
 
                 //Left to Right
-                for (size_t i = 1; i < _width; ++i)
+                for (size_t i = 1; i < width; ++i)
                 {
                     if (empty(p))
                     {
@@ -251,7 +269,7 @@ namespace librealsense
                 --p;
                 cur_fill = 0;
                 //Right to left
-                for (size_t i = 1; i < _width; ++i)
+                for (size_t i = 1; i < width; ++i)
                 {
                     if (empty(p))
                     {
@@ -262,11 +280,12 @@ namespace librealsense
                         cur_fill = 0;
                     --p;
                 }
-                p += _width;
+                p += width;
             }
         }
 
     private:
+        friend class depth_post_processing;
 
         float                   _spatial_alpha_param;
         uint8_t                 _spatial_delta_param;
@@ -3,7 +3,8 @@
 #ifdef __SSSE3__
 
 #include "sse-align.h"
-#include <tmmintrin.h> // For SSE3 intrinsic used in unpack_yuy2_sse
+#include <algorithm>
+#include <iterator>
 #include "../include/librealsense2/hpp/rs_sensor.hpp"
 #include "../include/librealsense2/hpp/rs_processing.hpp"
 #include "../include/librealsense2/rsutil.h"
@@ -12,6 +13,7 @@
 #include "proc/synthetic-stream.h"
 #include "environment.h"
 #include "stream.h"
+#include "thread-pool.h"
 
 using namespace librealsense;
 
@@ -25,173 +27,19 @@ bool is_special_resolution(const rs2_intrinsics& depth, const rs2_intrinsics& to
     return false;
 }
 
-template<rs2_distortion dist>
-inline void distorte_x_y(const __m128 & x, const __m128 & y, __m128 * distorted_x, __m128 * distorted_y, const rs2_intrinsics& to)
+depth_projection make_projection(float depth_scale, const rs2_intrinsics& to, const rs2_extrinsics& from_to_other, bool distort)
 {
-    *distorted_x = x;
-    *distorted_y = y;
-}
-template<>
-inline void distorte_x_y<RS2_DISTORTION_MODIFIED_BROWN_CONRADY>(const __m128& x, const __m128& y, __m128* distorted_x, __m128* distorted_y, const rs2_intrinsics& to)
-{
-    __m128 c[5];
-    auto one = _mm_set_ps1(1);
-    auto two = _mm_set_ps1(2);
-
-    for (int i = 0; i < 5; ++i)
-    {
-        c[i] = _mm_set_ps1(to.coeffs[i]);
-    }
-    auto r2_0 = _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y));
-    auto r3_0 = _mm_add_ps(_mm_mul_ps(c[1], _mm_mul_ps(r2_0, r2_0)), _mm_mul_ps(c[4], _mm_mul_ps(r2_0, _mm_mul_ps(r2_0, r2_0))));
-    auto f_0 = _mm_add_ps(one, _mm_add_ps(_mm_mul_ps(c[0], r2_0), r3_0));
-
-    auto x_f0 = _mm_mul_ps(x, f_0);
-    auto y_f0 = _mm_mul_ps(y, f_0);
-
-    auto r4_0 = _mm_mul_ps(c[3], _mm_add_ps(r2_0, _mm_mul_ps(two, _mm_mul_ps(x_f0, x_f0))));
-    auto d_x0 = _mm_add_ps(x_f0, _mm_add_ps(_mm_mul_ps(two, _mm_mul_ps(c[2], _mm_mul_ps(x_f0, y_f0))), r4_0));
-
-    auto r5_0 = _mm_mul_ps(c[2], _mm_add_ps(r2_0, _mm_mul_ps(two, _mm_mul_ps(y_f0, y_f0))));
-    auto d_y0 = _mm_add_ps(y_f0, _mm_add_ps(_mm_mul_ps(two, _mm_mul_ps(c[3], _mm_mul_ps(x_f0, y_f0))), r4_0));
-
-    *distorted_x = d_x0;
-    *distorted_y = d_y0;
-}
-
-
-template<rs2_distortion dist>
-inline void get_texture_map_sse(const uint16_t * depth,
-    float depth_scale,
-    const unsigned int size,
-    const float * pre_compute_x, const float * pre_compute_y,
-    byte * pixels_ptr_int,
-    const rs2_intrinsics& to,
-    const rs2_extrinsics& from_to_other)
-{
-    //mask for shuffle
-    const __m128i mask0 = _mm_set_epi8((char)0xff, (char)0xff, (char)7, (char)6, (char)0xff, (char)0xff, (char)5, (char)4,
-        (char)0xff, (char)0xff, (char)3, (char)2, (char)0xff, (char)0xff, (char)1, (char)0);
-    const __m128i mask1 = _mm_set_epi8((char)0xff, (char)0xff, (char)15, (char)14, (char)0xff, (char)0xff, (char)13, (char)12,
-        (char)0xff, (char)0xff, (char)11, (char)10, (char)0xff, (char)0xff, (char)9, (char)8);
-
-    auto scale = _mm_set_ps1(depth_scale);
-
-    auto mapx = pre_compute_x;
-    auto mapy = pre_compute_y;
-
-    auto res = reinterpret_cast<__m128i*>(pixels_ptr_int);
-
-    __m128 r[9];
-    __m128 t[3];
-    __m128 c[5];
-
-    for (int i = 0; i < 9; ++i)
-    {
-        r[i] = _mm_set_ps1(from_to_other.rotation[i]);
-    }
-    for (int i = 0; i < 3; ++i)
-    {
-        t[i] = _mm_set_ps1(from_to_other.translation[i]);
-    }
-    for (int i = 0; i < 5; ++i)
-    {
-        c[i] = _mm_set_ps1(to.coeffs[i]);
-    }
-    auto zero = _mm_set_ps1(0);
-    auto fx = _mm_set_ps1(to.fx);
-    auto fy = _mm_set_ps1(to.fy);
-    auto ppx = _mm_set_ps1(to.ppx);
-    auto ppy = _mm_set_ps1(to.ppy);
-
-    for (unsigned int i = 0; i < size; i += 8)
-    {
-        auto x0 = _mm_load_ps(mapx + i);
-        auto x1 = _mm_load_ps(mapx + i + 4);
-
-        auto y0 = _mm_load_ps(mapy + i);
-        auto y1 = _mm_load_ps(mapy + i + 4);
-
-
-        __m128i d = _mm_load_si128((__m128i const*)(depth + i));        //d7 d7 d6 d6 d5 d5 d4 d4 d3 d3 d2 d2 d1 d1 d0 d0
-
-                                                                        //split the depth pixel to 2 registers of 4 floats each
-        __m128i d0 = _mm_shuffle_epi8(d, mask0);        // 00 00 d3 d3 00 00 d2 d2 00 00 d1 d1 00 00 d0 d0
-        __m128i d1 = _mm_shuffle_epi8(d, mask1);        // 00 00 d7 d7 00 00 d6 d6 00 00 d5 d5 00 00 d4 d4
-
-        __m128 depth0 = _mm_cvtepi32_ps(d0); //convert depth to float
-        __m128 depth1 = _mm_cvtepi32_ps(d1); //convert depth to float
-
-        depth0 = _mm_mul_ps(depth0, scale);
-        depth1 = _mm_mul_ps(depth1, scale);
-
-        auto p0x = _mm_mul_ps(depth0, x0);
-        auto p0y = _mm_mul_ps(depth0, y0);
-
-        auto p1x = _mm_mul_ps(depth1, x1);
-        auto p1y = _mm_mul_ps(depth1, y1);
-
-        auto p_x0 = _mm_add_ps(_mm_mul_ps(r[0], p0x), _mm_add_ps(_mm_mul_ps(r[3], p0y), _mm_add_ps(_mm_mul_ps(r[6], depth0), t[0])));
-        auto p_y0 = _mm_add_ps(_mm_mul_ps(r[1], p0x), _mm_add_ps(_mm_mul_ps(r[4], p0y), _mm_add_ps(_mm_mul_ps(r[7], depth0), t[1])));
-        auto p_z0 = _mm_add_ps(_mm_mul_ps(r[2], p0x), _mm_add_ps(_mm_mul_ps(r[5], p0y), _mm_add_ps(_mm_mul_ps(r[8], depth0), t[2])));
-
-        auto p_x1 = _mm_add_ps(_mm_mul_ps(r[0], p1x), _mm_add_ps(_mm_mul_ps(r[3], p1y), _mm_add_ps(_mm_mul_ps(r[6], depth1), t[0])));
-        auto p_y1 = _mm_add_ps(_mm_mul_ps(r[1], p1x), _mm_add_ps(_mm_mul_ps(r[4], p1y), _mm_add_ps(_mm_mul_ps(r[7], depth1), t[1])));
-        auto p_z1 = _mm_add_ps(_mm_mul_ps(r[2], p1x), _mm_add_ps(_mm_mul_ps(r[5], p1y), _mm_add_ps(_mm_mul_ps(r[8], depth1), t[2])));
-
-        p_x0 = _mm_div_ps(p_x0, p_z0);
-        p_y0 = _mm_div_ps(p_y0, p_z0);
-
-        p_x1 = _mm_div_ps(p_x1, p_z1);
-        p_y1 = _mm_div_ps(p_y1, p_z1);
-
-        distorte_x_y<dist>(p_x0, p_y0, &p_x0, &p_y0, to);
-        distorte_x_y<dist>(p_x1, p_y1, &p_x1, &p_y1, to);
-
-        //zero the x and y if z is zero
-        auto cmp = _mm_cmpneq_ps(depth0, zero);
-        p_x0 = _mm_and_ps(_mm_add_ps(_mm_mul_ps(p_x0, fx), ppx), cmp);
-        p_y0 = _mm_and_ps(_mm_add_ps(_mm_mul_ps(p_y0, fy), ppy), cmp);
-
-
-        p_x1 = _mm_add_ps(_mm_mul_ps(p_x1, fx), ppx);
-        p_y1 = _mm_add_ps(_mm_mul_ps(p_y1, fy), ppy);
-
-        cmp = _mm_cmpneq_ps(depth0, zero);
-        auto half = _mm_set_ps1(0.5);
-        auto u_round0 = _mm_and_ps(_mm_add_ps(p_x0, half), cmp);
-        auto v_round0 = _mm_and_ps(_mm_add_ps(p_y0, half), cmp);
-
-        auto uuvv1_0 = _mm_shuffle_ps(u_round0, v_round0, _MM_SHUFFLE(1, 0, 1, 0));
-        auto uuvv2_0 = _mm_shuffle_ps(u_round0, v_round0, _MM_SHUFFLE(3, 2, 3, 2));
-
-        auto res1_0 = _mm_shuffle_ps(uuvv1_0, uuvv1_0, _MM_SHUFFLE(3, 1, 2, 0));
-        auto res2_0 = _mm_shuffle_ps(uuvv2_0, uuvv2_0, _MM_SHUFFLE(3, 1, 2, 0));
-
-        auto res1_int0 = _mm_cvtps_epi32(res1_0);
-        auto res2_int0 = _mm_cvtps_epi32(res2_0);
-
-        _mm_stream_si128(&res[0], res1_int0);
-        _mm_stream_si128(&res[1], res2_int0);
-        res += 2;
-
-        cmp = _mm_cmpneq_ps(depth1, zero);
-        auto u_round1 = _mm_and_ps(_mm_add_ps(p_x1, half), cmp);
-        auto v_round1 = _mm_and_ps(_mm_add_ps(p_y1, half), cmp);
-
-        auto uuvv1_1 = _mm_shuffle_ps(u_round1, v_round1, _MM_SHUFFLE(1, 0, 1, 0));
-        auto uuvv2_1 = _mm_shuffle_ps(u_round1, v_round1, _MM_SHUFFLE(3, 2, 3, 2));
-
-        auto res1 = _mm_shuffle_ps(uuvv1_1, uuvv1_1, _MM_SHUFFLE(3, 1, 2, 0));
-        auto res2 = _mm_shuffle_ps(uuvv2_1, uuvv2_1, _MM_SHUFFLE(3, 1, 2, 0));
-
-        auto res1_int1 = _mm_cvtps_epi32(res1);
-        auto res2_int1 = _mm_cvtps_epi32(res2);
-
-        _mm_stream_si128(&res[0], res1_int1);
-        _mm_stream_si128(&res[1], res2_int1);
-        res += 2;
-    }
+    depth_projection p;
+    p.depth_scale = depth_scale;
+    std::copy(std::begin(from_to_other.rotation), std::end(from_to_other.rotation), p.rotation);
+    std::copy(std::begin(from_to_other.translation), std::end(from_to_other.translation), p.translation);
+    p.fx = to.fx;
+    p.fy = to.fy;
+    p.ppx = to.ppx;
+    p.ppy = to.ppy;
+    std::copy(std::begin(to.coeffs), std::end(to.coeffs), p.coeffs);
+    p.distort = distort;
+    return p;
 }
 
 image_transform::image_transform(const rs2_intrinsics& from, float depth_scale)
@@ -240,158 +88,204 @@ void image_transform::pre_compute_x_y_map(std::vector<float>& pre_compute_map_x,
     }
 }
 
+void image_transform::project_rows(const uint16_t* z_pixels, int first_row, int last_row,
+    const depth_projection& projection, bool bottom_right)
+{
+    auto& map_x = bottom_right ? _pre_compute_map_x_bottom_right : _pre_compute_map_x_top_left;
+    auto& map_y = bottom_right ? _pre_compute_map_y_bottom_right : _pre_compute_map_y_top_left;
+    auto& pixels = bottom_right ? _pixel_bottom_right_int : _pixel_top_left_int;
+
+    auto begin = first_row * _depth.width;
+    get_unpack_kernels().project_depth(reinterpret_cast<int32_t*>(pixels.data() + begin), z_pixels + begin,
+        map_x.data() + begin, map_y.data() + begin, (last_row - first_row) * _depth.width, projection);
+}
+
 void image_transform::align_depth_to_other(const uint16_t* z_pixels, uint16_t* dest, int bpp, const rs2_intrinsics& depth, const rs2_intrinsics& to,
-    const rs2_extrinsics& from_to_other)
+    const rs2_extrinsics& from_to_other, unsigned int max_workers)
 {
-    switch (to.model)
+    auto projection = make_projection(_depth_scale, to, from_to_other, to.model == RS2_DISTORTION_MODIFIED_BROWN_CONRADY);
+
+    float fov[2];
+    rs2_fov(&depth, fov);
+    float2 pixels_per_angle_depth = { (float)depth.width / fov[0], (float)depth.height / fov[1] };
+
+    rs2_fov(&to, fov);
+    float2 pixels_per_angle_target = { (float)to.width / fov[0], (float)to.height / fov[1] };
+
+    // Where depth pixels are larger than the target ones, each covers the rectangle between its corners
+    bool both_corners = pixels_per_angle_depth.x < pixels_per_angle_target.x || pixels_per_angle_depth.y < pixels_per_angle_target.y || is_special_resolution(depth, to);
+    auto& bottom_right = both_corners ? _pixel_bottom_right_int : _pixel_top_left_int;
+
+    auto& pool = thread_pool::get_default();
+    const int bands = (_depth.height + BAND_ROWS - 1) / BAND_ROWS;
+    auto band_row = [this](int band) { return std::min(band * BAND_ROWS, _depth.height); };
+    auto workers = std::min(max_workers ? max_workers : pool.get_threads(), static_cast<unsigned int>(bands));
+
+    if (workers <= 1)
     {
-    case RS2_DISTORTION_MODIFIED_BROWN_CONRADY:
-        align_depth_to_other_sse<RS2_DISTORTION_MODIFIED_BROWN_CONRADY>(z_pixels, dest, depth, to, from_to_other);
-        break;
-    default:
-        align_depth_to_other_sse(z_pixels, dest, depth, to, from_to_other);
-        break;
+        // On one thread the tiles would only add a copy
+        project_rows(z_pixels, 0, _depth.height, projection, false);
+        if (both_corners)
+            project_rows(z_pixels, 0, _depth.height, projection, true);
+        move_depth_to_other(z_pixels, 0, _depth.height, dest, 0, to, _pixel_top_left_int, bottom_right);
+        return;
     }
-}
 
-inline void image_transform::move_depth_to_other(const uint16_t* z_pixels, uint16_t* dest, const rs2_intrinsics& to,
-    const std::vector<librealsense::int2>& pixel_top_left_int,
-    const std::vector<librealsense::int2>& pixel_bottom_right_int)
-{
-    for (int y = 0; y < _depth.height; ++y)
+    _tiles.resize(bands);
+    pool.parallel_for(bands, workers, [&](int begin, int end)
     {
-        for (int x = 0; x < _depth.width; ++x)
+        for (int band = begin; band < end; band++)
         {
-            auto depth_pixel_index = y * _depth.width + x;
-            // Skip over depth pixels with the value of zero, we have no depth data so we will not write anything into our aligned images
-            if (z_pixels[depth_pixel_index])
+            project_rows(z_pixels, band_row(band), band_row(band + 1), projection, false);
+            if (both_corners)
+                project_rows(z_pixels, band_row(band), band_row(band + 1), projection, true);
+            scatter_band(z_pixels, band_row(band), band_row(band + 1), _tiles[band], to, _pixel_top_left_int, bottom_right);
+        }
+    });
+
+    // Each stripe of output rows takes the nearest depth of every tile reaching into it
+    const int stripes = (to.height + BAND_ROWS - 1) / BAND_ROWS;
+    pool.parallel_for(stripes, workers, [&](int begin, int end)
+    {
+        const int first = begin * BAND_ROWS, last = std::min(end * BAND_ROWS, to.height);
+        for (auto&& tile : _tiles)
+        {
+            const int tile_last = std::min(last, tile.first_row + tile.rows);
+            for (int y = std::max(first, tile.first_row); y < tile_last; ++y)
             {
-                for (int other_y = pixel_top_left_int[depth_pixel_index].y; other_y <= pixel_bottom_right_int[depth_pixel_index].y; ++other_y)
+                auto in = tile.z.data() + (y - tile.first_row) * to.width;
+                auto out = dest + y * to.width;
+                for (int x = 0; x < to.width; ++x)
                 {
-                    for (int other_x = pixel_top_left_int[depth_pixel_index].x; other_x <= pixel_bottom_right_int[depth_pixel_index].x; ++other_x)
-                    {
-                        if (other_x < 0 || other_y < 0 || other_x >= to.width || other_y >= to.height)
-                            continue;
-                        auto other_ind = other_y * to.width + other_x;
-
-                        dest[other_ind] = dest[other_ind] ? std::min(dest[other_ind], z_pixels[depth_pixel_index]) : z_pixels[depth_pixel_index];
-                    }
+                    // Taking one off wraps the empty 0 around to the farthest depth, out of the minimum's way
+                    uint16_t a = out[x] - 1, b = in[x] - 1;
+                    out[x] = (a < b ? a : b) + 1;
                 }
             }
         }
-    }
+    });
 }
 
-void image_transform::align_other_to_depth(const uint16_t* z_pixels, const byte* source, byte* dest, int bpp, const rs2_intrinsics& to,
-    const rs2_extrinsics& from_to_other)
+void image_transform::move_depth_to_other(const uint16_t* z_pixels, int first_row, int last_row,
+    uint16_t* dest, int dest_first_row, const rs2_intrinsics& to,
+    const std::vector<librealsense::int2>& pixel_top_left_int,
+    const std::vector<librealsense::int2>& pixel_bottom_right_int)
 {
-    switch (to.model)
+    for (int depth_pixel_index = first_row * _depth.width; depth_pixel_index < last_row * _depth.width; ++depth_pixel_index)
     {
-    case RS2_DISTORTION_MODIFIED_BROWN_CONRADY:
-    case RS2_DISTORTION_INVERSE_BROWN_CONRADY:
-        align_other_to_depth_sse<RS2_DISTORTION_MODIFIED_BROWN_CONRADY>(z_pixels, source, dest, bpp, to, from_to_other);
-        break;
-    default:
-        align_other_to_depth_sse(z_pixels, source, dest, bpp, to, from_to_other);
-        break;
+        // Skip over depth pixels with the value of zero, we have no depth data so we will not write anything into our aligned images
+        auto z = z_pixels[depth_pixel_index];
+        if (!z)
+            continue;
+
+        // Only the part of the rectangle inside the other image is written
+        const int x0 = std::max(pixel_top_left_int[depth_pixel_index].x, 0);
+        const int y0 = std::max(pixel_top_left_int[depth_pixel_index].y, 0);
+        const int x1 = std::min(pixel_bottom_right_int[depth_pixel_index].x, to.width - 1);
+        const int y1 = std::min(pixel_bottom_right_int[depth_pixel_index].y, to.height - 1);
+        for (int other_y = y0; other_y <= y1; ++other_y)
+        {
+            auto row = dest + (other_y - dest_first_row) * to.width;
+            for (int other_x = x0; other_x <= x1; ++other_x)
+                row[other_x] = row[other_x] ? std::min(row[other_x], z) : z;
+        }
     }
 }
 
-
-template<rs2_distortion dist>
-inline void image_transform::align_depth_to_other_sse(const uint16_t * z_pixels, uint16_t * dest, const rs2_intrinsics& depth, const rs2_intrinsics& to,
-    const rs2_extrinsics& from_to_other)
+void image_transform::scatter_band(const uint16_t* z_pixels, int first_row, int last_row, band_tile& tile, const rs2_intrinsics& to,
+    const std::vector<librealsense::int2>& pixel_top_left_int,
+    const std::vector<librealsense::int2>& pixel_bottom_right_int)
 {
-    get_texture_map_sse<dist>(z_pixels, _depth_scale, _depth.height*_depth.width, _pre_compute_map_x_top_left.data(),
-        _pre_compute_map_y_top_left.data(), (byte*)_pixel_top_left_int.data(), to, from_to_other);
-
-    float fov[2];
-    rs2_fov(&depth, fov);
-    float2 pixels_per_angle_depth = { (float)depth.width / fov[0], (float)depth.height / fov[1] };
-
-    rs2_fov(&to, fov);
-    float2 pixels_per_angle_target = { (float)to.width / fov[0], (float)to.height / fov[1] };
-
-    if (pixels_per_angle_depth.x < pixels_per_angle_target.x || pixels_per_angle_depth.y < pixels_per_angle_target.y || is_special_resolution(depth, to))
+    // The tile spans the output rows the band reaches
+    int top = to.height, bottom = -1;
+    for (int depth_pixel_index = first_row * _depth.width; depth_pixel_index < last_row * _depth.width; ++depth_pixel_index)
     {
-        get_texture_map_sse<dist>(z_pixels, _depth_scale, _depth.height*_depth.width, _pre_compute_map_x_bottom_right.data(),
-            _pre_compute_map_y_bottom_right.data(), (byte*)_pixel_bottom_right_int.data(), to, from_to_other);
-
-        move_depth_to_other(z_pixels, dest, to, _pixel_top_left_int, _pixel_bottom_right_int);
-    }
-    else
-    {
-        move_depth_to_other(z_pixels, dest, to, _pixel_top_left_int, _pixel_top_left_int);
+        if (!z_pixels[depth_pixel_index])
+            continue;
+        const int x0 = std::max(pixel_top_left_int[depth_pixel_index].x, 0);
+        const int y0 = std::max(pixel_top_left_int[depth_pixel_index].y, 0);
+        const int x1 = std::min(pixel_bottom_right_int[depth_pixel_index].x, to.width - 1);
+        const int y1 = std::min(pixel_bottom_right_int[depth_pixel_index].y, to.height - 1);
+        if (x0 > x1 || y0 > y1)
+            continue;
+        top = std::min(top, y0);
+        bottom = std::max(bottom, y1);
     }
 
+    tile.first_row = top;
+    tile.rows = std::max(bottom - top + 1, 0);
+    tile.z.assign(size_t(tile.rows) * to.width, 0);
+    if (tile.rows)
+        move_depth_to_other(z_pixels, first_row, last_row, tile.z.data(), tile.first_row, to, pixel_top_left_int, pixel_bottom_right_int);
 }
 
-template<rs2_distortion dist>
-inline void image_transform::align_other_to_depth_sse(const uint16_t * z_pixels, const byte * source, byte * dest, int bpp, const rs2_intrinsics& to,
-    const rs2_extrinsics& from_to_other)
+void image_transform::align_other_to_depth(const uint16_t* z_pixels, const byte* source, byte* dest, int bpp, const rs2_intrinsics& to,
+    const rs2_extrinsics& from_to_other, unsigned int max_workers)
 {
-    get_texture_map_sse<dist>(z_pixels, _depth_scale, _depth.height*_depth.width, _pre_compute_map_x_top_left.data(),
-        _pre_compute_map_y_top_left.data(), (byte*)_pixel_top_left_int.data(), to, from_to_other);
+    auto projection = make_projection(_depth_scale, to, from_to_other,
+        to.model == RS2_DISTORTION_MODIFIED_BROWN_CONRADY || to.model == RS2_DISTORTION_INVERSE_BROWN_CONRADY);
 
-    std::vector<int2>& bottom_right = _pixel_top_left_int;
-    if (to.height < _depth.height && to.width < _depth.width)
-    {
-        get_texture_map_sse<dist>(z_pixels, _depth_scale, _depth.height*_depth.width, _pre_compute_map_x_bottom_right.data(),
-            _pre_compute_map_y_bottom_right.data(), (byte*)_pixel_bottom_right_int.data(), to, from_to_other);
-
-        bottom_right = _pixel_bottom_right_int;
-    }
+    // Onto a smaller image, both corners of a depth pixel have always been taken from the
+    // bottom-right map, so it takes the one pixel under that corner
+    bool bottom_right = to.height < _depth.height && to.width < _depth.width;
+    auto& corners = bottom_right ? _pixel_bottom_right_int : _pixel_top_left_int;
 
-    switch (bpp)
+    // Every depth pixel only writes its own output pixel, the bands need no tiles
+    const int bands = (_depth.height + BAND_ROWS - 1) / BAND_ROWS;
+    thread_pool::get_default().parallel_for(bands, max_workers, [&](int begin, int end)
     {
-    case 1:
-        move_other_to_depth(z_pixels, reinterpret_cast<const bytes<1>*>(source), reinterpret_cast<bytes<1>*>(dest), to,
-            _pixel_top_left_int, bottom_right);
-        break;
-    case 2:
-        move_other_to_depth(z_pixels, reinterpret_cast<const bytes<2>*>(source), reinterpret_cast<bytes<2>*>(dest), to,
-            _pixel_top_left_int, bottom_right);
-        break;
-    case 3:
-        move_other_to_depth(z_pixels, reinterpret_cast<const bytes<3>*>(source), reinterpret_cast<bytes<3>*>(dest), to,
-            _pixel_top_left_int, bottom_right);
-        break;
-    case 4:
-        move_other_to_depth(z_pixels, reinterpret_cast<const bytes<4>*>(source), reinterpret_cast<bytes<4>*>(dest), to,
-            _pixel_top_left_int, bottom_right);
-        break;
-    default:
-        break;
-    }
+        const int first_row = begin * BAND_ROWS, last_row = std::min(end * BAND_ROWS, _depth.height);
+        project_rows(z_pixels, first_row, last_row, projection, bottom_right);
+
+        switch (bpp)
+        {
+        case 1:
+            move_other_to_depth(z_pixels, reinterpret_cast<const bytes<1>*>(source), reinterpret_cast<bytes<1>*>(dest), to,
+                first_row, last_row, corners, corners);
+            break;
+        case 2:
+            move_other_to_depth(z_pixels, reinterpret_cast<const bytes<2>*>(source), reinterpret_cast<bytes<2>*>(dest), to,
+                first_row, last_row, corners, corners);
+            break;
+        case 3:
+            move_other_to_depth(z_pixels, reinterpret_cast<const bytes<3>*>(source), reinterpret_cast<bytes<3>*>(dest), to,
+                first_row, last_row, corners, corners);
+            break;
+        case 4:
+            move_other_to_depth(z_pixels, reinterpret_cast<const bytes<4>*>(source), reinterpret_cast<bytes<4>*>(dest), to,
+                first_row, last_row, corners, corners);
+            break;
+        default:
+            break;
+        }
+    });
 }
 
 template<class T >
 void image_transform::move_other_to_depth(const uint16_t* z_pixels,
     const T* source,
     T* dest, const rs2_intrinsics& to,
+    int first_row, int last_row,
     const std::vector<librealsense::int2>& pixel_top_left_int,
     const std::vector<librealsense::int2>& pixel_bottom_right_int)
 {
     // Iterate over the pixels of the depth image
-    for (int y = 0; y < _depth.height; ++y)
+    for (int depth_pixel_index = first_row * _depth.width; depth_pixel_index < last_row * _depth.width; ++depth_pixel_index)
     {
-        for (int x = 0; x < _depth.width; ++x)
+        // Skip over depth pixels with the value of zero, we have no depth data so we will not write anything into our aligned images
+        if (!z_pixels[depth_pixel_index])
+            continue;
+
+        // The last pixel of the rectangle inside the other image is the one that sticks
+        const int x0 = std::max(pixel_top_left_int[depth_pixel_index].x, 0);
+        const int y0 = std::max(pixel_top_left_int[depth_pixel_index].y, 0);
+        const int x1 = std::min(pixel_bottom_right_int[depth_pixel_index].x, to.width - 1);
+        const int y1 = std::min(pixel_bottom_right_int[depth_pixel_index].y, to.height - 1);
+        for (int other_y = y0; other_y <= y1; ++other_y)
         {
-            auto depth_pixel_index = y * _depth.width + x;
-            // Skip over depth pixels with the value of zero, we have no depth data so we will not write anything into our aligned images
-            if (z_pixels[depth_pixel_index])
+            for (int other_x = x0; other_x <= x1; ++other_x)
             {
-                for (int other_y = pixel_top_left_int[depth_pixel_index].y; other_y <= pixel_bottom_right_int[depth_pixel_index].y; ++other_y)
-                {
-                    for (int other_x = pixel_top_left_int[depth_pixel_index].x; other_x <= pixel_bottom_right_int[depth_pixel_index].x; ++other_x)
-                    {
-                        if (other_x < 0 || other_y < 0 || other_x >= to.width || other_y >= to.height)
-                            continue;
-                        auto other_ind = other_y * to.width + other_x;
-
-                        dest[depth_pixel_index] = source[other_ind];
-                    }
-                }
+                dest[depth_pixel_index] = source[other_y * to.width + other_x];
             }
         }
     }
@@ -421,7 +315,7 @@ void align_sse::align_z_to_other(rs2::video_frame& aligned, const rs2::video_fra
         _stream_transform = std::make_shared<image_transform>(z_intrin, z_scale);
         _stream_transform->pre_compute_x_y_map_corners();
     }
-    _stream_transform->align_depth_to_other(z_pixels, reinterpret_cast<uint16_t*>(aligned_data), 2, z_intrin, other_intrin, z_to_other);
+    _stream_transform->align_depth_to_other(z_pixels, reinterpret_cast<uint16_t*>(aligned_data), 2, z_intrin, other_intrin, z_to_other, _processing_threads);
 }
 
 void align_sse::align_other_to_z(rs2::video_frame& aligned, const rs2::video_frame& depth, const rs2::video_frame& other, float z_scale)
@@ -446,6 +340,6 @@ void align_sse::align_other_to_z(rs2::video_frame& aligned, const rs2::video_fra
         _stream_transform->pre_compute_x_y_map_corners();
     }
 
-    _stream_transform->align_other_to_depth(z_pixels, other_pixels, aligned_data, other.get_bytes_per_pixel(), other_intrin, z_to_other);
+    _stream_transform->align_other_to_depth(z_pixels, other_pixels, aligned_data, other.get_bytes_per_pixel(), other_intrin, z_to_other, _processing_threads);
 }
 #endif
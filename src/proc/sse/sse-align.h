@@ -4,31 +4,49 @@
 #ifdef __SSSE3__
 
 #include "proc/align.h"
+#include "image-simd.h"
 
 namespace librealsense
 {
+    // Moves depth pixels onto another image. A frame is split into bands of depth rows on the
+    // shared thread pool: each band projects its pixels, then scatters them into a private tile
+    // of the output rows it reaches, and the tiles are merged keeping the nearest depth. The
+    // nearest depth wins whatever the order, so the output does not depend on the split
     class image_transform
     {
     public:
+        // Depth rows per band, and output rows per merge stripe
+        static const int BAND_ROWS = 32;
 
         image_transform(const rs2_intrinsics& from,
             float depth_scale);
 
-        inline void align_depth_to_other(const uint16_t* z_pixels,
+        // 0 workers for the whole pool
+        void align_depth_to_other(const uint16_t* z_pixels,
             uint16_t* dest, int bpp,
             const rs2_intrinsics& depth,
             const rs2_intrinsics& to,
-            const rs2_extrinsics& from_to_other);
+            const rs2_extrinsics& from_to_other,
+            unsigned int max_workers);
 
-        inline void align_other_to_depth(const uint16_t* z_pixels,
+        void align_other_to_depth(const uint16_t* z_pixels,
             const byte* source,
             byte* dest, int bpp, const rs2_intrinsics& to,
-            const rs2_extrinsics& from_to_other);
+            const rs2_extrinsics& from_to_other,
+            unsigned int max_workers);
 
         void pre_compute_x_y_map_corners();
 
     private:
 
+        // Output rows one band reached, nearest depth per pixel and 0 where it wrote nothing
+        struct band_tile
+        {
+            int first_row = 0;
+            int rows = 0;
+            std::vector<uint16_t> z;
+        };
+
         const rs2_intrinsics _depth;
         float _depth_scale;
 
@@ -40,31 +58,32 @@ namespace librealsense
         std::vector<int2> _pixel_top_left_int;
         std::vector<int2> _pixel_bottom_right_int;
 
+        std::vector<band_tile> _tiles;
+
         void pre_compute_x_y_map(std::vector<float>& pre_compute_map_x,
             std::vector<float>& pre_compute_map_y,
             float offset = 0);
 
-        template<rs2_distortion dist = RS2_DISTORTION_NONE>
-        inline void align_depth_to_other_sse(const uint16_t* z_pixels,
-            uint16_t* dest, const rs2_intrinsics& depth,
-            const rs2_intrinsics& to,
-            const rs2_extrinsics& from_to_other);
+        // Projects the depth pixels of rows [first_row, last_row) through one corner map
+        void project_rows(const uint16_t* z_pixels, int first_row, int last_row,
+            const depth_projection& projection, bool bottom_right);
 
-        template<rs2_distortion dist = RS2_DISTORTION_NONE>
-        inline void align_other_to_depth_sse(const uint16_t* z_pixels,
-            const byte* source,
-            byte* dest, int bpp, const rs2_intrinsics& to,
-            const rs2_extrinsics& from_to_other);
+        void move_depth_to_other(const uint16_t* z_pixels,
+            int first_row, int last_row,
+            uint16_t* dest, int dest_first_row, const rs2_intrinsics& to,
+            const std::vector<int2>& pixel_top_left_int,
+            const std::vector<int2>& pixel_bottom_right_int);
 
-        inline void move_depth_to_other(const uint16_t* z_pixels,
-            uint16_t* dest, const rs2_intrinsics& to,
+        void scatter_band(const uint16_t* z_pixels,
+            int first_row, int last_row, band_tile& tile, const rs2_intrinsics& to,
             const std::vector<int2>& pixel_top_left_int,
             const std::vector<int2>& pixel_bottom_right_int);
 
         template<class T >
-        inline void move_other_to_depth(const uint16_t* z_pixels,
+        void move_other_to_depth(const uint16_t* z_pixels,
             const T* source,
             T* dest, const rs2_intrinsics& to,
+            int first_row, int last_row,
             const std::vector<int2>& pixel_top_left_int,
             const std::vector<int2>& pixel_bottom_right_int);
 
@@ -73,7 +92,10 @@ namespace librealsense
     class align_sse : public align
     {
     public:
-        align_sse(rs2_stream to_stream) : align(to_stream, "Align (SSE3)") {}
+        align_sse(rs2_stream to_stream) : align(to_stream, "Align (SSE3)")
+        {
+            register_processing_threads_option();
+        }
 
     protected:
         void reset_cache(rs2_stream from, rs2_stream to) override;
@@ -13,16 +13,7 @@ namespace librealsense
     {
         _matcher->set_callback([this](frame_holder f, syncronization_environment env)
         {
-            std::stringstream ss;
-            ss << "SYNCED: ";
-            auto composite = dynamic_cast<composite_frame*>(f.frame);
-            for (int i = 0; i < composite->get_embedded_frames_count(); i++)
-            {
-                auto matched = composite->get_frame(i);
-                ss << matched->get_stream()->get_stream_type() << " " << matched->get_frame_number() << ", "<<std::fixed<< matched->get_frame_timestamp()<<" ";
-            }
-
-            LOG_DEBUG(ss.str());
+            LOG_DEBUG("SYNCED: " << frame_description{ f.frame });
             env.matches.enqueue(std::move(f));
         });
 
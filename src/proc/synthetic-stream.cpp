@@ -30,6 +30,18 @@ namespace librealsense
         _source.init(std::shared_ptr<metadata_parser_map>());
     }
 
+    void processing_block::register_processing_threads_option()
+    {
+        auto processing_threads = std::make_shared<ptr_option<uint8_t>>(
+            0, 64, 1, 0, &_processing_threads, "Maximum threads used per frame, 0 for the whole shared pool");
+        register_option(RS2_OPTION_PROCESSING_THREADS, processing_threads);
+    }
+
+    void processing_block::parallel_for(int count, const std::function<void(int, int)>& body)
+    {
+        thread_pool::get_default().parallel_for(count, _processing_threads, body);
+    }
+
     void processing_block::invoke(frame_holder f)
     {
         auto callback = _source.begin_callback();
@@ -112,6 +124,7 @@ namespace librealsense
 
         bool disparity_result_frame = false;
         bool depth_result_frame = false;
+        bool encoded_result_frame = false;
 
         for (auto f : results)
         {
@@ -120,6 +133,8 @@ namespace librealsense
                 disparity_result_frame = true;
             if (format == RS2_FORMAT_Z16)
                 depth_result_frame = true;
+            if (format == RS2_FORMAT_Z16C)
+                encoded_result_frame = true;
         }
 
         std::vector<rs2::frame> original_set;
@@ -127,9 +142,9 @@ namespace librealsense
             composite.foreach_rs([&](const rs2::frame& frame)
             {
                 auto format = frame.get_profile().format();
-                if (depth_result_frame &&  val_in_range(format, { RS2_FORMAT_DISPARITY32, RS2_FORMAT_DISPARITY16, RS2_FORMAT_Z16H }))
+                if (depth_result_frame &&  val_in_range(format, { RS2_FORMAT_DISPARITY32, RS2_FORMAT_DISPARITY16, RS2_FORMAT_Z16H, RS2_FORMAT_Z16C }))
                     return;
-                if (disparity_result_frame && format == RS2_FORMAT_Z16)
+                if ((disparity_result_frame || encoded_result_frame) && format == RS2_FORMAT_Z16)
                     return;
                 original_set.push_back(frame);
             });
@@ -448,27 +463,32 @@ namespace librealsense
     }
 
     frame_interface* synthetic_source::allocate_composite_frame(std::vector<frame_holder> holders)
+    {
+        return allocate_composite_frame(holders.data(), holders.size());
+    }
+
+    frame_interface* synthetic_source::allocate_composite_frame(frame_holder* holders, size_t count)
     {
         frame_additional_data d{};
 
         auto req_size = 0;
-        for (auto&& f : holders)
-            req_size += get_embeded_frames_size(f.frame);
+        for (size_t i = 0; i < count; i++)
+            req_size += get_embeded_frames_size(holders[i].frame);
 
         auto res = _actual_source.alloc_frame(RS2_EXTENSION_COMPOSITE_FRAME, req_size * sizeof(rs2_frame*), d, true);
         if (!res) return nullptr;
 
         auto cf = static_cast<composite_frame*>(res);
 
-        for (auto&& f : holders)
+        for (size_t i = 0; i < count; i++)
         {
-            if (f.is_blocking())
+            if (holders[i].is_blocking())
                 res->set_blocking(true);
         }
 
         auto frames = cf->get_frames();
-        for (auto&& f : holders)
-            copy_frames(std::move(f), frames);
+        for (size_t i = 0; i < count; i++)
+            copy_frames(std::move(holders[i]), frames);
         frames -= req_size;
 
         auto releaser = [frames, req_size]()
@@ -32,6 +32,7 @@ namespace librealsense
             rs2_extension frame_type = RS2_EXTENSION_MOTION_FRAME) override;
 
         frame_interface* allocate_composite_frame(std::vector<frame_holder> frames) override;
+        frame_interface* allocate_composite_frame(frame_holder* frames, size_t count) override;
 
         frame_interface* allocate_points(std::shared_ptr<stream_profile_interface> stream, 
             frame_interface* original, rs2_extension frame_type = RS2_EXTENSION_POINTS) override;
@@ -57,10 +58,18 @@ namespace librealsense
 
         virtual ~processing_block() { _source.flush(); }
     protected:
+        // For blocks that split a frame across the shared thread pool: exposes the per-block
+        // worker cap as RS2_OPTION_PROCESSING_THREADS
+        void register_processing_threads_option();
+
+        // Run body(begin, end) over [0, count) in contiguous stripes, within the worker cap
+        void parallel_for(int count, const std::function<void(int, int)>& body);
+
         frame_source _source;
         std::mutex _mutex;
         frame_processor_callback_ptr _callback;
         synthetic_source _source_wrapper;
+        uint8_t _processing_threads = 0;
     };
 
     class LRS_EXTENSION_API generic_processing_block : public processing_block
@@ -99,6 +99,7 @@ namespace librealsense
 
         register_option(RS2_OPTION_FILTER_SMOOTH_ALPHA, temporal_filter_alpha);
         register_option(RS2_OPTION_FILTER_SMOOTH_DELTA, temporal_filter_delta);
+        register_processing_threads_option();
 
         on_set_persistence_control(_persistence_param);
         on_set_delta(_delta_param);
@@ -165,11 +166,14 @@ namespace librealsense
             _current_frm_size_pixels = _width * _height;
 
             _last_frame.clear();
-            _last_frame.resize(_current_frm_size_pixels*_bpp);
-
             _history.clear();
-            _history.resize(_current_frm_size_pixels*_bpp);
+        }
 
+        // Also after the options cleared the state
+        if (_last_frame.empty())
+        {
+            _last_frame.resize(_current_frm_size_pixels*_bpp);
+            _history.resize(_current_frm_size_pixels*_bpp);
         }
     }
 
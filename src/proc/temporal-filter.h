@@ -4,6 +4,7 @@
 #pragma once
 #include "types.h"
 #include "synthetic-stream.h"
+#include <algorithm>
 
 namespace librealsense
 {
@@ -25,6 +26,25 @@ namespace librealsense
         {
             static_assert((std::is_arithmetic<T>::value), "temporal filter assumes numeric types");
 
+            unsigned char mask = 1 << _cur_frame_index;
+
+            // pass one -- go through image and update all
+            // Every pixel only depends on its own history, so the frame is split into stripes
+            // across the shared pool, on cache-line multiples so no two workers share a line
+            const int blocks = int((_current_frm_size_pixels + PIXEL_BLOCK - 1) / PIXEL_BLOCK);
+            parallel_for(blocks, [&](int begin, int end)
+            {
+                const size_t last = std::min(size_t(end) * PIXEL_BLOCK, _current_frm_size_pixels);
+                temp_jw_smooth_pixels<T>(frame_data, _last_frame_data, history, mask, size_t(begin) * PIXEL_BLOCK, last);
+            });
+
+            _cur_frame_index = (_cur_frame_index + 1) % 8;  // at end of cycle
+        }
+
+        // Pixels [begin, end) of one pass, for the frame phase selected by mask
+        template<typename T>
+        void temp_jw_smooth_pixels(void* frame_data, void * _last_frame_data, uint8_t *history, unsigned char mask, size_t begin, size_t end)
+        {
             const bool fp = (std::is_floating_point<T>::value);
 
             T delta_z = static_cast<T>(_delta_param);
@@ -32,10 +52,7 @@ namespace librealsense
             auto frame          = reinterpret_cast<T*>(frame_data);
             auto _last_frame    = reinterpret_cast<T*>(_last_frame_data);
 
-            unsigned char mask = 1 << _cur_frame_index;
-
-            // pass one -- go through image and update all
-            for (size_t i = 0; i < _current_frm_size_pixels; i++)
+            for (size_t i = begin; i < end; i++)
             {
                 T cur_val = frame[i];
                 T prev_val = _last_frame[i];
@@ -80,11 +97,14 @@ namespace librealsense
                     history[i] &= ~mask;
                 }
             }
-
-            _cur_frame_index = (_cur_frame_index + 1) % 8;  // at end of cycle
         }
 
+        // Pixels per stripe unit of the parallel pass
+        static const size_t PIXEL_BLOCK = 64;
+
     private:
+        friend class depth_post_processing;
+
         void on_set_persistence_control(uint8_t val);
         void on_set_alpha(float val);
         void on_set_delta(float val);
@@ -29,15 +29,18 @@
 #include "proc/spatial-filter.h"
 #include "proc/zero-order.h"
 #include "proc/hole-filling-filter.h"
+#include "proc/depth-post-processing.h"
 #include "proc/color-formats-converter.h"
 #include "proc/rates-printer.h"
 #include "media/playback/playback_device.h"
+#include "media/playback/playback_batch.h"
 #include "stream.h"
 #include "../include/librealsense2/h/rs_types.h"
 #include "pipeline/pipeline.h"
 #include "environment.h"
 #include "proc/temporal-filter.h"
 #include "proc/depth-decompress.h"
+#include "proc/depth-codec.h"
 #include "software-device.h"
 #include "global_timestamp_reader.h"
 #include "auto-calibrated-device.h"
@@ -99,6 +102,11 @@ struct rs2_pipeline_profile
     std::shared_ptr<librealsense::pipeline::profile> profile;
 };
 
+struct rs2_playback_batch
+{
+    std::shared_ptr<librealsense::playback_batch> batch;
+};
+
 struct rs2_frame_queue
 {
     explicit rs2_frame_queue(int cap)
@@ -668,6 +676,36 @@ void rs2_set_notifications_callback(const rs2_sensor* sensor, rs2_notification_c
 }
 HANDLE_EXCEPTIONS_AND_RETURN(, sensor, on_notification, user)
 
+void rs2_set_frame_allocator(const rs2_sensor* sensor, rs2_frame_allocate_ptr on_allocate, rs2_frame_release_ptr on_release, void* user, rs2_error** error) BEGIN_API_CALL
+{
+    VALIDATE_NOT_NULL(sensor);
+    if (!on_allocate != !on_release)
+        throw std::runtime_error("on_allocate and on_release must be either both set or both null");
+
+    auto sensor_base = dynamic_cast<librealsense::sensor_base*>(sensor->sensor);
+    if (!sensor_base)
+        throw std::runtime_error("This sensor does not support a custom frame allocator");
+
+    std::shared_ptr<librealsense::frame_memory_provider> provider;
+    if (on_allocate)
+        provider = std::make_shared<librealsense::user_frame_memory_provider>(on_allocate, on_release, user);
+    sensor_base->set_frame_allocator(provider);
+}
+HANDLE_EXCEPTIONS_AND_RETURN(, sensor, on_allocate, on_release, user)
+
+void rs2_get_frame_pool_statistics(const rs2_sensor* sensor, rs2_frame_pool_statistics* statistics, rs2_error** error) BEGIN_API_CALL
+{
+    VALIDATE_NOT_NULL(sensor);
+    VALIDATE_NOT_NULL(statistics);
+
+    auto sensor_base = dynamic_cast<librealsense::sensor_base*>(sensor->sensor);
+    if (!sensor_base)
+        throw std::runtime_error("This sensor does not support frame pool statistics");
+
+    *statistics = sensor_base->get_frame_pool_statistics();
+}
+HANDLE_EXCEPTIONS_AND_RETURN(, sensor, statistics)
+
 void rs2_software_device_set_destruction_callback(const rs2_device* dev, rs2_software_device_destruction_callback_ptr on_destruction, void* user, rs2_error** error) BEGIN_API_CALL
 {
     VALIDATE_NOT_NULL(dev);
@@ -1126,6 +1164,8 @@ const char* rs2_sr300_visual_preset_to_string(rs2_sr300_visual_preset preset)
 const char* rs2_log_severity_to_string(rs2_log_severity severity)                         { return librealsense::get_string(severity);     }
 const char* rs2_exception_type_to_string(rs2_exception_type type)                         { return librealsense::get_string(type);         }
 const char* rs2_playback_status_to_string(rs2_playback_status status)                     { return librealsense::get_string(status);       }
+const char* rs2_record_overflow_policy_to_string(rs2_record_overflow_policy policy)       { return librealsense::get_string(policy);       }
+const char* rs2_vertex_layout_to_string(rs2_vertex_layout layout)                         { return librealsense::get_string(layout);       }
 const char* rs2_extension_type_to_string(rs2_extension type)                              { return librealsense::get_string(type);         }
 const char* rs2_frame_metadata_to_string(rs2_frame_metadata_value metadata)               { return librealsense::get_string(metadata);     }
 const char* rs2_extension_to_string(rs2_extension type)                                   { return rs2_extension_type_to_string(type);     }
@@ -1534,6 +1574,114 @@ const char* rs2_record_device_filename(const rs2_device* device, rs2_error** err
 }
 HANDLE_EXCEPTIONS_AND_RETURN(nullptr, device)
 
+void rs2_record_device_set_overflow_policy(const rs2_device* device, rs2_record_overflow_policy policy, unsigned long long max_queued_bytes, rs2_error** error) BEGIN_API_CALL
+{
+    VALIDATE_NOT_NULL(device);
+    VALIDATE_ENUM(policy);
+    if (max_queued_bytes == 0)
+        throw librealsense::invalid_value_exception("max_queued_bytes must be positive");
+    auto record_device = VALIDATE_INTERFACE(device->device, librealsense::record_device);
+    record_device->set_overflow_policy(policy, max_queued_bytes);
+}
+HANDLE_EXCEPTIONS_AND_RETURN(, device, policy, max_queued_bytes)
+
+void rs2_record_device_get_statistics(const rs2_device* device, rs2_record_statistics* statistics, rs2_error** error) BEGIN_API_CALL
+{
+    VALIDATE_NOT_NULL(device);
+    VALIDATE_NOT_NULL(statistics);
+    auto record_device = VALIDATE_INTERFACE(device->device, librealsense::record_device);
+    *statistics = record_device->get_statistics();
+}
+HANDLE_EXCEPTIONS_AND_RETURN(, device, statistics)
+
+rs2_playback_batch* rs2_create_playback_batch(rs2_context* ctx, const char** files, int count, int max_concurrent_files, rs2_error** error) BEGIN_API_CALL
+{
+    VALIDATE_NOT_NULL(ctx);
+    VALIDATE_NOT_NULL(files);
+    VALIDATE_RANGE(count, 1, std::numeric_limits<int>::max());
+
+    std::vector<std::string> paths;
+    for (int i = 0; i < count; i++)
+    {
+        VALIDATE_NOT_NULL(files[i]);
+        paths.push_back(files[i]);
+    }
+
+    return new rs2_playback_batch{ std::make_shared<playback_batch>(ctx->ctx, paths, max_concurrent_files) };
+}
+HANDLE_EXCEPTIONS_AND_RETURN(nullptr, ctx, files, count, max_concurrent_files)
+
+void rs2_delete_playback_batch(rs2_playback_batch* batch) BEGIN_API_CALL
+{
+    VALIDATE_NOT_NULL(batch);
+
+    delete batch;
+}
+NOEXCEPT_RETURN(, batch)
+
+void rs2_playback_batch_start(rs2_playback_batch* batch, rs2_playback_batch_frame_callback_ptr callback, void* user, rs2_error** error) BEGIN_API_CALL
+{
+    VALIDATE_NOT_NULL(batch);
+    VALIDATE_NOT_NULL(callback);
+
+    batch->batch->start([callback, user](frame_holder f, int file_index) {
+        frame_interface* frame = nullptr;
+        std::swap(frame, f.frame);
+        callback((rs2_frame*)frame, file_index, user);
+    });
+}
+HANDLE_EXCEPTIONS_AND_RETURN(, batch, callback, user)
+
+int rs2_playback_batch_wait(rs2_playback_batch* batch, unsigned int timeout_ms, rs2_error** error) BEGIN_API_CALL
+{
+    VALIDATE_NOT_NULL(batch);
+
+    return batch->batch->wait(std::chrono::milliseconds(timeout_ms)) ? 1 : 0;
+}
+HANDLE_EXCEPTIONS_AND_RETURN(0, batch, timeout_ms)
+
+void rs2_playback_batch_stop(rs2_playback_batch* batch, rs2_error** error) BEGIN_API_CALL
+{
+    VALIDATE_NOT_NULL(batch);
+
+    batch->batch->stop();
+}
+HANDLE_EXCEPTIONS_AND_RETURN(, batch)
+
+void rs2_playback_batch_get_progress(const rs2_playback_batch* batch, rs2_playback_batch_progress* progress, rs2_error** error) BEGIN_API_CALL
+{
+    VALIDATE_NOT_NULL(batch);
+    VALIDATE_NOT_NULL(progress);
+
+    auto p = batch->batch->get_progress();
+    progress->files_done = p.files_done;
+    progress->files_failed = p.files_failed;
+    progress->frames = p.frames;
+    progress->frames_per_second = p.frames_per_second;
+}
+HANDLE_EXCEPTIONS_AND_RETURN(, batch, progress)
+
+void rs2_playback_batch_get_file_progress(const rs2_playback_batch* batch, int file_index, rs2_playback_batch_file_progress* progress, rs2_error** error) BEGIN_API_CALL
+{
+    VALIDATE_NOT_NULL(batch);
+    VALIDATE_NOT_NULL(progress);
+
+    auto p = batch->batch->get_file_progress(file_index);
+    progress->position = p.position;
+    progress->duration = p.duration;
+    progress->frames = p.frames;
+    progress->done = p.done ? 1 : 0;
+}
+HANDLE_EXCEPTIONS_AND_RETURN(, batch, file_index, progress)
+
+const char* rs2_playback_batch_get_file_error(const rs2_playback_batch* batch, int file_index, rs2_error** error) BEGIN_API_CALL
+{
+    VALIDATE_NOT_NULL(batch);
+
+    return batch->batch->get_file_error(file_index);
+}
+HANDLE_EXCEPTIONS_AND_RETURN(nullptr, batch, file_index)
+
 
 rs2_frame* rs2_allocate_synthetic_video_frame(rs2_source* source, const rs2_stream_profile* new_stream, rs2_frame* original,
     int new_bpp, int new_width, int new_height, int new_stride, rs2_extension frame_type, rs2_error** error) BEGIN_API_CALL
@@ -2024,6 +2172,24 @@ rs2_processing_block* rs2_create_pointcloud(rs2_error** error) BEGIN_API_CALL
 }
 NOARGS_HANDLE_EXCEPTIONS_AND_RETURN(nullptr)
 
+int rs2_pointcloud_calculate_vertices(rs2_processing_block* block, const rs2_frame* depth, rs2_vertex_layout layout, void* buffer, int size, rs2_error** error) BEGIN_API_CALL
+{
+    VALIDATE_NOT_NULL(block);
+    VALIDATE_NOT_NULL(depth);
+    VALIDATE_ENUM(layout);
+    VALIDATE_NOT_NULL(buffer);
+    VALIDATE_RANGE(size, 0, std::numeric_limits<int>::max());
+    auto pc = std::dynamic_pointer_cast<librealsense::pointcloud>(block->block);
+    if (!pc)
+        throw std::runtime_error("Object does not support \"librealsense::pointcloud\" interface! ");
+
+    // The wrapper releases the reference it is given, the caller keeps its own
+    auto f = (frame_interface*)depth;
+    f->acquire();
+    return pc->calculate_vertices(rs2::frame((rs2_frame*)f), layout, buffer, size);
+}
+HANDLE_EXCEPTIONS_AND_RETURN(0, block, depth, layout, buffer, size)
+
 rs2_processing_block* rs2_create_yuy_decoder(rs2_error** error) BEGIN_API_CALL
 {
     return new rs2_processing_block { std::make_shared<yuy2_converter>(RS2_FORMAT_RGB8) };
@@ -2103,6 +2269,23 @@ rs2_processing_block* rs2_create_hole_filling_filter_block(rs2_error** error) BE
 }
 NOARGS_HANDLE_EXCEPTIONS_AND_RETURN(nullptr)
 
+rs2_processing_block* rs2_create_depth_post_processing_block(rs2_processing_block** filters, int count, rs2_error** error) BEGIN_API_CALL
+{
+    VALIDATE_NOT_NULL(filters);
+    VALIDATE_RANGE(count, 1, 6);
+
+    std::vector<std::shared_ptr<librealsense::processing_block_interface>> blocks;
+    for (int i = 0; i < count; i++)
+    {
+        VALIDATE_NOT_NULL(filters[i]);
+        blocks.push_back(filters[i]->block);
+    }
+    auto block = std::make_shared<librealsense::depth_post_processing>(blocks);
+
+    return new rs2_processing_block{ block };
+}
+HANDLE_EXCEPTIONS_AND_RETURN(nullptr, filters, count)
+
 rs2_processing_block* rs2_create_rates_printer_block(rs2_error** error) BEGIN_API_CALL
 {
     auto block = std::make_shared<librealsense::rates_printer>();
@@ -2127,6 +2310,45 @@ rs2_processing_block* rs2_create_huffman_depth_decompress_block(rs2_error** erro
 }
 NOARGS_HANDLE_EXCEPTIONS_AND_RETURN(nullptr)
 
+rs2_processing_block* rs2_create_depth_encoder_block(const char* codecs, rs2_error** error) BEGIN_API_CALL
+{
+    auto block = std::make_shared<librealsense::depth_encoder>(codecs ? codecs : "");
+
+    return new rs2_processing_block{ block };
+}
+HANDLE_EXCEPTIONS_AND_RETURN(nullptr, codecs)
+
+rs2_processing_block* rs2_create_depth_decoder_block(rs2_error** error) BEGIN_API_CALL
+{
+    auto block = std::make_shared<librealsense::depth_decoder>();
+
+    return new rs2_processing_block{ block };
+}
+NOARGS_HANDLE_EXCEPTIONS_AND_RETURN(nullptr)
+
+int rs2_encode_depth(const char* codecs, const void* src, int count, void* dst, int dst_size, rs2_error** error) BEGIN_API_CALL
+{
+    VALIDATE_NOT_NULL(src);
+    VALIDATE_NOT_NULL(dst);
+    VALIDATE_RANGE(count, 0, (std::numeric_limits<int>::max() - 12) / 2);
+    VALIDATE_RANGE(dst_size, int(librealsense::depth_frame_encoder::max_encoded_size(count)), std::numeric_limits<int>::max());
+
+    librealsense::depth_frame_encoder encoder(codecs ? codecs : "", 0);
+    return static_cast<int>(encoder.encode(static_cast<uint8_t*>(dst), static_cast<const uint16_t*>(src), count));
+}
+HANDLE_EXCEPTIONS_AND_RETURN(0, codecs, src, count, dst, dst_size)
+
+void rs2_decode_depth(const void* src, int size, void* dst, int count, rs2_error** error) BEGIN_API_CALL
+{
+    VALIDATE_NOT_NULL(src);
+    VALIDATE_NOT_NULL(dst);
+    VALIDATE_RANGE(size, 0, std::numeric_limits<int>::max());
+    VALIDATE_RANGE(count, 0, std::numeric_limits<int>::max());
+
+    librealsense::decode_depth_frame(static_cast<uint16_t*>(dst), count, static_cast<const uint8_t*>(src), size);
+}
+HANDLE_EXCEPTIONS_AND_RETURN(, src, size, dst, count)
+
 float rs2_get_depth_scale(rs2_sensor* sensor, rs2_error** error) BEGIN_API_CALL
 {
     VALIDATE_NOT_NULL(sensor);
@@ -2414,6 +2636,13 @@ void rs2_log(rs2_log_severity severity, const char * message, rs2_error ** error
 }
 HANDLE_EXCEPTIONS_AND_RETURN(, severity, message)
 
+void rs2_configure_thread_pool(int threads, unsigned long long cpu_affinity_mask, rs2_error** error) BEGIN_API_CALL
+{
+    VALIDATE_RANGE(threads, 0, thread_pool::MAX_WORKERS);
+    thread_pool::get_default().configure(threads, cpu_affinity_mask);
+}
+HANDLE_EXCEPTIONS_AND_RETURN(, threads, cpu_affinity_mask)
+
 void rs2_loopback_enable(const rs2_device* device, const char* from_file, rs2_error** error) BEGIN_API_CALL
 {
     VALIDATE_NOT_NULL(device);
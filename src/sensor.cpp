@@ -102,6 +102,20 @@ namespace librealsense
         return _source.set_callback(callback);
     }
 
+    void sensor_base::set_frame_allocator(std::shared_ptr<frame_memory_provider> provider)
+    {
+        // The frame archives take the pool when the sensor opens
+        if (_is_opened)
+            throw wrong_api_call_sequence_exception("set_frame_allocator(...) failed. Sensor is opened!");
+
+        _source.set_frame_allocator(provider);
+    }
+
+    rs2_frame_pool_statistics sensor_base::get_frame_pool_statistics() const
+    {
+        return _source.get_frame_pool_statistics();
+    }
+
     bool sensor_base::is_streaming() const
     {
         return _is_streaming;
@@ -247,9 +261,8 @@ namespace librealsense
     {
         auto system_time = environment::get_instance().get_time_service()->get_time();
         auto fr = std::make_shared<frame>();
-        byte* pix = (byte*)fo.pixels;
-        std::vector<byte> pixels(pix, pix + fo.frame_size);
-        fr->data = pixels;
+        // Only read while the backend callback runs, so it points at the backend buffer
+        fr->attach_continuation(frame_continuation([]() {}, fo.pixels));
         fr->set_stream(profile);
 
         // generate additional data
@@ -316,12 +329,13 @@ namespace librealsense
             {
                 unsigned long long last_frame_number = 0;
                 rs2_time_t last_timestamp = 0;
+                // Leaves two buffers queued to the kernel while the others are lent to frames
+                auto loans = std::make_shared<buffer_loans>(DEFAULT_V4L2_FRAME_BUFFERS - 2);
                 _device->probe_and_commit(req_profile_base->get_backend_profile(),
-                    [this, req_profile_base, req_profile, last_frame_number, last_timestamp](platform::stream_profile p, platform::frame_object f, std::function<void()> continuation) mutable
+                    [this, req_profile_base, req_profile, last_frame_number, last_timestamp, loans](platform::stream_profile p, platform::frame_object f, std::function<void()> continuation) mutable
                 {
                     const auto&& system_time = environment::get_instance().get_time_service()->get_time();
                     const auto&& fr = generate_frame_from_data(f, _timestamp_reader.get(), last_timestamp, last_frame_number, req_profile_base);
-                    const auto&& requires_processing = true; // TODO - Ariel add option
                     const auto&& timestamp_domain = _timestamp_reader->get_frame_timestamp_domain(fr);
                     const auto&& bpp = get_image_bpp(req_profile_base->get_format());
                     auto&& frame_counter = fr->additional_data.frame_number;
@@ -336,7 +350,24 @@ namespace librealsense
                         return;
                     }
 
-                    frame_continuation release_and_enqueue(continuation, f.pixels);
+                    const auto&& vsp = As<video_stream_profile, stream_profile_interface>(req_profile);
+                    int width = vsp ? vsp->get_width() : 0;
+                    int height = vsp ? vsp->get_height() : 0;
+                    size_t frame_size = width * height * bpp / 8;
+
+#ifdef ZERO_COPY
+                    // Frames that need no unpacking borrow the backend buffer, which goes back to the
+                    // kernel with the last reference to the frame. While the user holds on to all the
+                    // buffers that may be lent, frames are copied instead
+                    const bool lend = val_in_range(req_profile_base->get_format(), { RS2_FORMAT_Z16, RS2_FORMAT_Y8, RS2_FORMAT_Y16 })
+                        && f.lends_buffer && f.frame_size >= frame_size && loans->try_lend();
+#else
+                    const bool lend = false;
+#endif
+                    std::function<void()> enqueue = continuation;
+                    if (lend)
+                        enqueue = [continuation, loans]() { loans->repay(); continuation(); };
+                    frame_continuation release_and_enqueue(enqueue, f.pixels);
 
                     LOG_DEBUG("FrameAccepted," << librealsense::get_string(req_profile_base->get_stream_type())
                         << ",Counter," << std::dec << fr->additional_data.frame_number
@@ -350,14 +381,11 @@ namespace librealsense
                     last_frame_number = frame_counter;
                     last_timestamp = timestamp;
 
-                    const auto&& vsp = As<video_stream_profile, stream_profile_interface>(req_profile);
-                    int width = vsp ? vsp->get_width() : 0;
-                    int height = vsp ? vsp->get_height() : 0;
-
-                    frame_holder fh = _source.alloc_frame(stream_to_frame_types(req_profile_base->get_stream_type()), width * height * bpp / 8, fr->additional_data, requires_processing);
+                    frame_holder fh = _source.alloc_frame(stream_to_frame_types(req_profile_base->get_stream_type()), frame_size, fr->additional_data, !lend);
                     if (fh.frame)
                     {
-                        memcpy((void*)fh->get_frame_data(), fr->data.data(), sizeof(byte)*fr->data.size());
+                        if (!lend)
+                            memcpy((void*)fh->get_frame_data(), f.pixels, std::min(frame_size, f.frame_size));
                         auto&& video = (video_frame*)fh.frame;
                         video->assign(width, height, width * bpp / 8, bpp);
                         video->set_timestamp_domain(timestamp_domain);
@@ -369,7 +397,7 @@ namespace librealsense
                         return;
                     }
 
-                    if (!requires_processing)
+                    if (lend)
                     {
                         fh->attach_continuation(std::move(release_and_enqueue));
                     }
@@ -828,12 +856,12 @@ namespace librealsense
             last_frame_number = frame_counter;
             last_timestamp = timestamp;
             frame_holder frame = _source.alloc_frame(RS2_EXTENSION_MOTION_FRAME, data_size, fr->additional_data, true);
-            memcpy((void*)frame->get_frame_data(), fr->data.data(), sizeof(byte)*fr->data.size());
             if (!frame)
             {
                 LOG_INFO("Dropped frame. alloc_frame(...) returned nullptr");
                 return;
             }
+            memcpy((void*)frame->get_frame_data(), sensor_data.fo.pixels, data_size);
             frame->set_stream(request);
             frame->set_timestamp_domain(timestamp_domain);
             _source.invoke_callback(std::move(frame));
@@ -1517,6 +1545,17 @@ namespace librealsense
         _post_process_callback = callback;
     }
 
+    void synthetic_sensor::set_frame_allocator(std::shared_ptr<frame_memory_provider> provider)
+    {
+        // Frames are allocated by the raw sensor, the synthetic sensor only forwards them
+        _raw_sensor->set_frame_allocator(provider);
+    }
+
+    rs2_frame_pool_statistics synthetic_sensor::get_frame_pool_statistics() const
+    {
+        return _raw_sensor->get_frame_pool_statistics();
+    }
+
     void synthetic_sensor::register_notifications_callback(notifications_callback_ptr callback)
     {
         sensor_base::register_notifications_callback(callback);
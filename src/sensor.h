@@ -61,6 +61,8 @@ namespace librealsense
         virtual std::shared_ptr<notifications_processor> get_notifications_processor() const;
         virtual frame_callback_ptr get_frames_callback() const override;
         virtual void set_frames_callback(frame_callback_ptr callback) override;
+        virtual void set_frame_allocator(std::shared_ptr<frame_memory_provider> provider);
+        virtual rs2_frame_pool_statistics get_frame_pool_statistics() const;
         bool is_streaming() const override;
         virtual bool is_opened() const;
         virtual void register_metadata(rs2_frame_metadata_value metadata, std::shared_ptr<md_attribute_parser_base> metadata_parser) const;
@@ -216,6 +218,8 @@ namespace librealsense
         std::shared_ptr<sensor_base> get_raw_sensor() const { return _raw_sensor; };
         frame_callback_ptr get_frames_callback() const override;
         void set_frames_callback(frame_callback_ptr callback) override;
+        void set_frame_allocator(std::shared_ptr<frame_memory_provider> provider) override;
+        rs2_frame_pool_statistics get_frame_pool_statistics() const override;
         void register_notifications_callback(notifications_callback_ptr callback) override;
         int register_before_streaming_changes_callback(std::function<void(bool)> callback) override;
         void unregister_before_start_callback(int token) override;
@@ -318,6 +322,32 @@ namespace librealsense
         uint32_t fps_to_sampling_frequency(rs2_stream stream, uint32_t fps) const;
     };
 
+    // Counts the backend buffers lent to published frames instead of being copied. The count is
+    // bounded so the kernel always has buffers queued to fill
+    class buffer_loans
+    {
+    public:
+        explicit buffer_loans(int limit) : _limit(limit), _outstanding(0) {}
+
+        bool try_lend()
+        {
+            auto outstanding = _outstanding.load();
+            while (outstanding < _limit)
+            {
+                if (_outstanding.compare_exchange_weak(outstanding, outstanding + 1))
+                    return true;
+            }
+            return false;
+        }
+
+        void repay() { --_outstanding; }
+        int outstanding() const { return _outstanding; }
+
+    private:
+        const int _limit;
+        std::atomic<int> _outstanding;
+    };
+
     class uvc_sensor : public sensor_base
     {
     public:
@@ -44,7 +44,8 @@ namespace librealsense
     frame_source::frame_source(uint32_t max_publish_list_size)
             : _callback(nullptr, [](rs2_frame_callback*) {}),
               _max_publish_list_size(max_publish_list_size),
-              _ts(environment::get_instance().get_time_service())
+              _ts(environment::get_instance().get_time_service()),
+              _pool(std::make_shared<frame_buffer_pool>())
     {}
 
     void frame_source::init(std::shared_ptr<metadata_parser_map> metadata_parsers)
@@ -61,7 +62,7 @@ namespace librealsense
 
         for (auto type : supported)
         {
-            _archive[type] = make_archive(type, &_max_publish_list_size, _ts, metadata_parsers);
+            _archive[type] = make_archive(type, &_max_publish_list_size, _ts, metadata_parsers, _pool);
         }
 
         _metadata_parsers = metadata_parsers;
@@ -82,6 +83,32 @@ namespace librealsense
             kvp.second.reset();
         }
         _metadata_parsers.reset();
+
+        auto stats = _pool->get_statistics();
+        LOG_DEBUG("Frame pool statistics: hits " << stats.hits << ", misses " << stats.misses << ", bypasses " << stats.bypasses
+            << ", high-water mark " << stats.high_water_mark << ", allocated " << stats.bytes_allocated << " bytes");
+        _pool->trim();
+    }
+
+    void frame_source::set_frame_allocator(std::shared_ptr<frame_memory_provider> provider)
+    {
+        std::lock_guard<std::mutex> lock(_callback_mutex);
+        // Buffers still held by frames keep the previous pool alive and return to its provider
+        auto pool = std::make_shared<frame_buffer_pool>(provider ? provider : std::make_shared<default_frame_memory_provider>());
+        pool->continue_statistics(*_pool);
+        _pool = pool;
+    }
+
+    rs2_frame_pool_statistics frame_source::get_frame_pool_statistics() const
+    {
+        std::lock_guard<std::mutex> lock(_callback_mutex);
+        return _pool->get_statistics();
+    }
+
+    std::shared_ptr<frame_buffer_pool> frame_source::get_frame_pool() const
+    {
+        std::lock_guard<std::mutex> lock(_callback_mutex);
+        return _pool;
     }
 
     frame_interface* frame_source::alloc_frame(rs2_extension type, size_t size, frame_additional_data additional_data, bool requires_memory) const
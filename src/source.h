@@ -44,9 +44,14 @@ namespace librealsense
         template<class T>
         void add_extension(rs2_extension ex)
         {
-            _archive[ex] = std::make_shared<frame_archive<T>>(&_max_publish_list_size, _ts, _metadata_parsers);
+            _archive[ex] = std::make_shared<frame_archive<T>>(&_max_publish_list_size, _ts, _metadata_parsers, _pool);
         }
 
+        // Takes effect for archives created by the next init()
+        void set_frame_allocator(std::shared_ptr<frame_memory_provider> provider);
+        rs2_frame_pool_statistics get_frame_pool_statistics() const;
+        std::shared_ptr<frame_buffer_pool> get_frame_pool() const;
+
         void set_max_publish_list_size(int qsize) {_max_publish_list_size = qsize; }
 
     private:
@@ -60,5 +65,6 @@ namespace librealsense
         frame_callback_ptr _callback;
         std::shared_ptr<platform::time_service> _ts;
         std::shared_ptr<metadata_parser_map> _metadata_parsers;
+        std::shared_ptr<frame_buffer_pool> _pool;
     };
 }
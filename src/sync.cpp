@@ -9,23 +9,67 @@ namespace librealsense
 {
     const int MAX_GAP = 1000;
 
-    std::string frame_to_string(frame_holder& f)
+    std::ostream& operator<<(std::ostream& out, const frame_description& f)
     {
-        std::stringstream s;
         auto composite = dynamic_cast<composite_frame*>(f.frame);
-        if(composite)
+        if (composite)
         {
             for (int i = 0; i < composite->get_embedded_frames_count(); i++)
             {
                 auto frame = composite->get_frame(i);
-                s << frame->get_stream()->get_stream_type()<<" "<<frame->get_frame_number()<<" "<<std::fixed << frame->get_frame_timestamp()<<" ";
+                out << frame->get_stream()->get_stream_type() << " " << frame->get_frame_number() << " " << std::fixed << frame->get_frame_timestamp() << " ";
             }
         }
-        else
+        else if (f.frame)
         {
-             s<<f->get_stream()->get_stream_type()<<" "<<f->get_frame_number()<<" "<<std::fixed <<(double)f->get_frame_timestamp()<<" ";
+            out << f.frame->get_stream()->get_stream_type() << " " << f.frame->get_frame_number() << " " << std::fixed << (double)f.frame->get_frame_timestamp() << " ";
+        }
+        return out;
+    }
+
+    namespace
+    {
+        // The frames at the front of some of the slots, for debug logs
+        struct slots_description
+        {
+            std::vector<composite_matcher::stream_slot>& slots;
+            const std::vector<int>& indices;
+        };
+
+        std::ostream& operator<<(std::ostream& out, const slots_description& d)
+        {
+            for (auto i : d.indices)
+            {
+                if (auto f = d.slots[i].front())
+                    out << frame_description{ f->frame };
+            }
+            return out;
+        }
+
+        // The streams of a slot and the next frame expected of them, for debug logs
+        struct expected_description
+        {
+            const composite_matcher::stream_slot& slot;
+        };
+
+        std::ostream& operator<<(std::ostream& out, const expected_description& d)
+        {
+            for (auto&& stream : d.slot.m->get_streams())
+                out << stream << " next expected " << std::fixed << d.slot.next_expected << " ";
+            return out;
+        }
+
+        struct stream_types_description
+        {
+            const matcher& m;
+        };
+
+        std::ostream& operator<<(std::ostream& out, const stream_types_description& d)
+        {
+            for (auto stream : d.m.get_streams_types())
+                out << stream << " ";
+            return out;
         }
-        return s.str();
     }
 
     matcher::matcher(std::vector<stream_id> streams_id)
@@ -94,9 +138,7 @@ namespace librealsense
 
     void identity_matcher::dispatch(frame_holder f, syncronization_environment env)
     {
-        std::stringstream s;
-        s <<_name<<"--> "<< f->get_stream()->get_stream_type() << " " << f->get_frame_number() << ", "<<std::fixed<< f->get_frame_timestamp()<<"\n";
-        LOG_DEBUG(s.str());
+        LOG_DEBUG(_name << "--> " << frame_description{ f.frame });
 
         sync(std::move(f), env);
     }
@@ -114,54 +156,127 @@ namespace librealsense
         return s.str();
     }
 
+    void composite_matcher::stream_slot::push(frame_holder f)
+    {
+        // A full ring drops its oldest frame, as the frame queues always did for non-blocking frames
+        if (count == SLOT_CAPACITY)
+            pop();
+        frames[(head + count) % SLOT_CAPACITY] = std::move(f);
+        count++;
+    }
+
+    frame_holder composite_matcher::stream_slot::pop()
+    {
+        frame_holder f = std::move(frames[head]);
+        head = (head + 1) % SLOT_CAPACITY;
+        count--;
+        accepting = true;
+        return f;
+    }
+
+    void composite_matcher::stream_slot::clear()
+    {
+        while (count)
+            pop();
+        accepting = false;
+    }
+
     composite_matcher::composite_matcher(std::vector<std::shared_ptr<matcher>> matchers, std::string name)
     {
         for (auto&& matcher : matchers)
+            add_slot(matcher);
+
+        _name = create_composite_name(matchers, name);
+    }
+
+    int composite_matcher::add_slot(std::shared_ptr<matcher> m)
+    {
+        m->set_callback([this](frame_holder f, syncronization_environment env)
+        {
+            sync(std::move(f), env);
+        });
+
+        // Streams already matched elsewhere move to the new matcher, dropping their frames
+        for (auto stream : m->get_streams())
         {
-            for (auto&& stream : matcher->get_streams())
+            auto it = std::find_if(_stream_slots.begin(), _stream_slots.end(),
+                [stream](const std::pair<stream_id, int>& p) { return p.first == stream; });
+            if (it != _stream_slots.end())
             {
-                matcher->set_callback([&](frame_holder f, syncronization_environment env)
-                {
-                    sync(std::move(f), env);
-                });
-                _matchers[stream] = matcher;
-                _streams_id.push_back(stream);
+                auto& old = _slots[it->second];
+                old.clear();
+                old.queued = false;
+                old.accepting = true;
+                _stream_slots.erase(it);
             }
-            for (auto&& stream : matcher->get_streams_types())
+        }
+        for (int i = 0; i < static_cast<int>(_slots.size()); i++)
+        {
+            if (_slots[i].m && std::none_of(_stream_slots.begin(), _stream_slots.end(),
+                [i](const std::pair<stream_id, int>& p) { return p.second == i; }))
             {
-                _streams_type.push_back(stream);
+                _slots[i] = stream_slot();
             }
         }
 
-        _name = create_composite_name(matchers, name);
+        int index = 0;
+        while (index < static_cast<int>(_slots.size()) && _slots[index].m)
+            index++;
+        if (index == static_cast<int>(_slots.size()))
+        {
+            _slots.emplace_back();
+            _arrived.reserve(_slots.size());
+            _missing.reserve(_slots.size());
+            _synced.reserve(_slots.size());
+            _match.resize(_slots.size());
+            _match_keys.resize(_slots.size());
+        }
+        _slots[index].m = m;
+
+        for (auto stream : m->get_streams())
+        {
+            _stream_slots.emplace_back(stream, index);
+            _streams_id.push_back(stream);
+        }
+        for (auto stream : m->get_streams_types())
+            _streams_type.push_back(stream);
+
+        return index;
     }
 
     void composite_matcher::dispatch(frame_holder f, syncronization_environment env)
     {
-        std::stringstream s;
-        s <<"DISPATCH "<<_name<<"--> "<< frame_to_string(f) <<"\n";
-        LOG_DEBUG(s.str());
+        LOG_DEBUG("DISPATCH " << _name << "--> " << frame_description{ f.frame });
 
         clean_inactive_streams(f);
-        auto matcher = find_matcher(f);
-        update_last_arrived(f, matcher.get());
+        auto& slot = _slots[find_slot(f)];
+        update_last_arrived(f, slot);
+        auto matcher = slot.m;
         matcher->dispatch(std::move(f), env);
     }
 
-    std::shared_ptr<matcher> composite_matcher::find_matcher(const frame_holder& frame)
+    int composite_matcher::find_slot(const frame_holder& frame)
     {
-        std::shared_ptr<matcher> matcher;
         auto stream_id = frame.frame->get_stream()->get_unique_id();
-        auto stream_type = frame.frame->get_stream()->get_stream_type();
 
-        auto sensor = frame.frame->get_sensor().get(); //TODO: Potential deadlock if get_sensor() gets a hold of the last reference of that sensor
+        int index = -1;
+        for (auto&& p : _stream_slots)
+        {
+            if (p.first == stream_id)
+            {
+                index = p.second;
+                break;
+            }
+        }
+        if (index >= 0 && _slots[index].m->get_active())
+            return index;
 
-        auto dev_exist = false;
+        auto stream_type = frame.frame->get_stream()->get_stream_type();
+        auto sensor = frame.frame->get_sensor().get(); //TODO: Potential deadlock if get_sensor() gets a hold of the last reference of that sensor
 
+        const device_interface* dev = nullptr;
         if (sensor)
         {
-
-            const device_interface* dev = nullptr;
             try
             {
                 dev = sensor->get_device().shared_from_this().get();
@@ -170,149 +285,85 @@ namespace librealsense
             {
                 LOG_WARNING("Device destroyed");
             }
-            if (dev)
-            {
-                dev_exist = true;
-                matcher = _matchers[stream_id];
-                if (!matcher)
-                {
-                    matcher = dev->create_matcher(frame);
-
-
-                    matcher->set_callback([&](frame_holder f, syncronization_environment env)
-                    {
-                        sync(std::move(f), env);
-                    });
-
-                    for (auto stream : matcher->get_streams())
-                    {
-                        if (_matchers[stream])
-                        {
-                            _frames_queue.erase(_matchers[stream].get());
-                        }
-                        _matchers[stream] = matcher;
-                        _streams_id.push_back(stream);
-
-                    }
-                    for (auto stream : matcher->get_streams_types())
-                    {
-                        _streams_type.push_back(stream);
-                    }
-
-                    if (std::find(_streams_type.begin(), _streams_type.end(), stream_type) == _streams_type.end())
-                    {
-                        LOG_ERROR("Stream matcher not found! stream=" << rs2_stream_to_string(stream_type));
-                    }
-                }
-
-                else if(!matcher->get_active())
-                {
-
-                     matcher->set_active(true);
-                     _frames_queue[matcher.get()].start();
-                }
-            }
         }
 
-        if(!dev_exist)
+        if (dev)
         {
-            matcher = _matchers[stream_id];
-            // We don't know what device this frame came from, so just store it under device NULL with ID matcher
-            if (!matcher)
+            if (index < 0)
             {
-                if (_matchers[stream_id])
-                {
-                    _frames_queue.erase(_matchers[stream_id].get());
-                }
-                 _matchers[stream_id] = std::make_shared<identity_matcher>(stream_id, stream_type);
-                _streams_id.push_back(stream_id);
-                _streams_type.push_back(stream_type);
-                matcher = _matchers[stream_id];
+                index = add_slot(dev->create_matcher(frame));
 
-                matcher->set_callback([&](frame_holder f, syncronization_environment env)
+                if (std::find(_streams_type.begin(), _streams_type.end(), stream_type) == _streams_type.end())
                 {
-                    sync(std::move(f), env);
-                });
+                    LOG_ERROR("Stream matcher not found! stream=" << rs2_stream_to_string(stream_type));
+                }
+            }
+            else
+            {
+                auto& slot = _slots[index];
+                slot.m->set_active(true);
+                slot.queued = true;
+                slot.accepting = true;
             }
         }
-        return matcher;
-    }
-
-
-    std::string composite_matcher::frames_to_string(std::vector<librealsense::matcher*> matchers)
-    {
-        std::string str;
-        for (auto m : matchers)
+        else if (index < 0)
         {
-            frame_holder* f;
-            if(_frames_queue[m].peek(&f))
-                str += frame_to_string(*f);
+            // We don't know what device this frame came from, so just store it under device NULL with ID matcher
+            index = add_slot(std::make_shared<identity_matcher>(stream_id, stream_type));
         }
-        return str;
+
+        return index;
     }
 
     void composite_matcher::sync(frame_holder f, syncronization_environment env)
     {
-        std::stringstream s;
-        s <<"SYNC "<<_name<<"--> "<< frame_to_string(f)<<"\n";
-        LOG_DEBUG(s.str());
+        LOG_DEBUG("SYNC " << _name << "--> " << frame_description{ f.frame });
 
-        update_next_expected(f);
-        auto matcher = find_matcher(f);
-        _frames_queue[matcher.get()].enqueue(std::move(f));
-
-        std::vector<frame_holder*> frames_arrived;
-        std::vector<librealsense::matcher*> frames_arrived_matchers;
-        std::vector<librealsense::matcher*> synced_frames;
-        std::vector<librealsense::matcher*> missing_streams;
+        {
+            auto& slot = _slots[find_slot(f)];
+            update_next_expected(slot, f);
+            slot.queued = true;
+            if (slot.accepting)
+                slot.push(std::move(f));
+        }
 
         do
         {
-            std::stringstream s;
             auto old_frames = false;
 
-            synced_frames.clear();
-            missing_streams.clear();
-            frames_arrived_matchers.clear();
-            frames_arrived.clear();
-
+            _synced.clear();
+            _missing.clear();
+            _arrived.clear();
 
-            for (auto s = _frames_queue.begin(); s != _frames_queue.end(); s++)
+            for (int i = 0; i < static_cast<int>(_slots.size()); i++)
             {
-                frame_holder* f;
-                if (s->second.peek(&f))
-                {
-                    frames_arrived.push_back(f);
-                    frames_arrived_matchers.push_back(s->first);
-                }
+                if (!_slots[i].queued)
+                    continue;
+                if (_slots[i].count)
+                    _arrived.push_back(i);
                 else
-                {
-                    missing_streams.push_back(s->first);
-                }
+                    _missing.push_back(i);
             }
 
-            if (frames_arrived.size() == 0)
+            if (_arrived.empty())
                 break;
 
-            frame_holder* curr_sync;
-            if (frames_arrived.size() > 0)
-            {
-                curr_sync = frames_arrived[0];
-                synced_frames.push_back(frames_arrived_matchers[0]);
-            }
+            frame_holder* curr_sync = _slots[_arrived[0]].front();
+            _synced.push_back(_arrived[0]);
 
-            for (auto i = 1; i < frames_arrived.size(); i++)
+            for (size_t i = 1; i < _arrived.size(); i++)
             {
-                if (are_equivalent(*curr_sync, *frames_arrived[i]))
+                auto candidate = _slots[_arrived[i]].front();
+                if (are_equivalent(*curr_sync, *candidate))
                 {
-                    synced_frames.push_back(frames_arrived_matchers[i]);
+                    _synced.push_back(_arrived[i]);
                 }
-                else if (is_smaller_than(*frames_arrived[i], *curr_sync))
+                else if (is_smaller_than(*candidate, *curr_sync))
                 {
                     old_frames = true;
-                    synced_frames.clear();
-                    synced_frames.push_back(frames_arrived_matchers[i]);
-                    curr_sync = frames_arrived[i];
+                    _synced.clear();
+                    _synced.push_back(_arrived[i]);
+                    curr_sync = candidate;
                 }
                 else
                 {
@@ -322,71 +373,56 @@ namespace librealsense
 
             if (!old_frames)
             {
-                for (auto i : missing_streams)
+                for (auto i : _missing)
                 {
-                    if (!skip_missing_stream(synced_frames, i))
+                    if (!skip_missing_stream(*_slots[_synced[0]].front(), _slots[i]))
                     {
-                        s <<  _name<<" "<<frames_to_string(synced_frames )<<" Wait for missing stream: ";
-
-                        for (auto&& stream : i->get_streams())
-                            s << stream<<" next expected "<<std::fixed<< _next_expected[i];
-                        synced_frames.clear();
-                        LOG_DEBUG(s.str());
+                        LOG_DEBUG(_name << " " << slots_description{ _slots, _synced } << " Wait for missing stream: " << expected_description{ _slots[i] });
+                        _synced.clear();
                         break;
                     }
                     else
                     {
-                        std::stringstream s;
-                        s << _name << " " << frames_to_string(synced_frames) << " Skipped missing stream: ";
-                        for (auto&& stream : i->get_streams())
-                            s << stream << " next expected " << std::fixed << _next_expected[i]<<" ";
-                        LOG_DEBUG(s.str());
+                        LOG_DEBUG(_name << " " << slots_description{ _slots, _synced } << " Skipped missing stream: " << expected_description{ _slots[i] });
                     }
-
                 }
             }
             else
             {
-                s << _name << " old frames: ";
+                LOG_DEBUG(_name << " old frames: " << slots_description{ _slots, _synced });
             }
-            if (synced_frames.size())
-            {
-                std::vector<frame_holder> match;
-                match.reserve(synced_frames.size());
 
-                for (auto index : synced_frames)
+            if (_synced.size())
+            {
+                // Ordered by stream, highest unique id first
+                int count = 0;
+                for (auto i : _synced)
                 {
-                    frame_holder frame;
-                    int timeout_ms = 5000;
-                    _frames_queue[index].dequeue(&frame, timeout_ms);
-                    if (old_frames)
+                    auto frame = _slots[i].pop();
+                    auto key = frame->get_stream()->get_unique_id();
+                    int j = count++;
+                    for (; j > 0 && _match_keys[j - 1] < key; j--)
                     {
-                        s  << "--> " << frame_to_string(frame) << "\n";
+                        _match[j] = std::move(_match[j - 1]);
+                        _match_keys[j] = _match_keys[j - 1];
                     }
-                    match.push_back(std::move(frame));
+                    _match[j] = std::move(frame);
+                    _match_keys[j] = key;
                 }
 
-                if (old_frames)
-                {
-                    LOG_DEBUG(s.str());
-                }
-
-                std::sort(match.begin(), match.end(), [](const frame_holder& f1, const frame_holder& f2)
-                {
-                    return ((frame_interface*)f1)->get_stream()->get_unique_id() > ((frame_interface*)f2)->get_stream()->get_unique_id();
-                });
-
+                frame_holder composite = env.source->allocate_composite_frame(_match.data(), count);
+                for (int i = 0; i < count; i++)
+                    _match[i] = frame_holder(); // left over if the composite could not be allocated
 
-                frame_holder composite = env.source->allocate_composite_frame(std::move(match));
                 if (composite.frame)
                 {
-                    s <<"SYNCED "<<_name<<"--> "<< frame_to_string(composite)<<"\n";
+                    LOG_DEBUG("SYNCED " << _name << "--> " << frame_description{ composite.frame });
 
                     auto cb = begin_callback();
                     _callback(std::move(composite), env);
                 }
             }
-        } while (synced_frames.size() > 0);
+        } while (_synced.size() > 0);
     }
 
     frame_number_composite_matcher::frame_number_composite_matcher(std::vector<std::shared_ptr<matcher>> matchers)
@@ -394,9 +430,9 @@ namespace librealsense
     {
     }
 
-    void frame_number_composite_matcher::update_last_arrived(frame_holder& f, matcher* m)
+    void frame_number_composite_matcher::update_last_arrived(frame_holder& f, stream_slot& slot)
     {
-        _last_arrived[m] =f->get_frame_number();
+        slot.last_arrived = (double)f->get_frame_number();
     }
 
     bool frame_number_composite_matcher::are_equivalent(frame_holder& a, frame_holder& b)
@@ -409,52 +445,36 @@ namespace librealsense
     }
     void frame_number_composite_matcher::clean_inactive_streams(frame_holder& f)
     {
-        std::vector<stream_id> inactive_matchers;
-        for(auto m: _matchers)
+        for (auto&& slot : _slots)
         {
-            if (_last_arrived[m.second.get()] && (fabs((long long)f->get_frame_number() - (long long)_last_arrived[m.second.get()])) > 5)
+            if (slot.m && slot.last_arrived && (fabs((long long)f->get_frame_number() - (long long)slot.last_arrived)) > 5)
             {
-                std::stringstream s;
-                s << "clean inactive stream in "<<_name;
-                for (auto stream : m.second->get_streams_types())
-                {
-                    s << stream << " ";
-                }
-                LOG_DEBUG(s.str());
+                LOG_DEBUG("clean inactive stream in " << _name << stream_types_description{ *slot.m });
 
-                inactive_matchers.push_back(m.first);
-                m.second->set_active(false);
+                slot.m->set_active(false);
+                slot.clear();
+                slot.queued = true;
             }
         }
-
-        for(auto id: inactive_matchers)
-        {
-            _frames_queue[_matchers[id].get()].clear();
-        }
     }
 
-    bool frame_number_composite_matcher::skip_missing_stream(std::vector<matcher*> synced, matcher* missing)
+    bool frame_number_composite_matcher::skip_missing_stream(frame_holder& synced, stream_slot& missing)
     {
-        frame_holder* synced_frame;
-
-         if(!missing->get_active())
+         if(!missing.m->get_active())
              return true;
 
-        _frames_queue[synced[0]].peek(&synced_frame);
-
-        auto next_expected = _next_expected[missing];
+        auto next_expected = missing.next_expected;
 
-        if((*synced_frame)->get_frame_number() - next_expected > 4 || (*synced_frame)->get_frame_number() < next_expected)
+        if(synced->get_frame_number() - next_expected > 4 || synced->get_frame_number() < next_expected)
         {
             return true;
         }
         return false;
     }
 
-    void frame_number_composite_matcher::update_next_expected(const frame_holder& f)
+    void frame_number_composite_matcher::update_next_expected(stream_slot& slot, const frame_holder& f)
     {
-        auto matcher = find_matcher(f);
-        _next_expected[matcher.get()] = f.frame->get_frame_number()+1.;
+        slot.next_expected = f.frame->get_frame_number()+1.;
     }
 
     std::pair<double, double> extract_timestamps(frame_holder & a, frame_holder & b)
@@ -496,15 +516,15 @@ namespace librealsense
         return ts.first < ts.second;
     }
 
-    void timestamp_composite_matcher::update_last_arrived(frame_holder& f, matcher* m)
+    void timestamp_composite_matcher::update_last_arrived(frame_holder& f, stream_slot& slot)
     {
         if(f->supports_frame_metadata(RS2_FRAME_METADATA_ACTUAL_FPS))
-            _fps[m] = (uint32_t)f->get_frame_metadata(RS2_FRAME_METADATA_ACTUAL_FPS);
+            slot.fps = (uint32_t)f->get_frame_metadata(RS2_FRAME_METADATA_ACTUAL_FPS);
 
         else
-            _fps[m] = f->get_stream()->get_framerate();
+            slot.fps = f->get_stream()->get_framerate();
 
-        _last_arrived[m] = environment::get_instance().get_time_service()->get_time();
+        slot.last_arrived = environment::get_instance().get_time_service()->get_time();
     }
 
     unsigned int timestamp_composite_matcher::get_fps(const frame_holder & f)
@@ -514,20 +534,19 @@ namespace librealsense
         {
             fps = (uint32_t)f.frame->get_frame_metadata(RS2_FRAME_METADATA_ACTUAL_FPS);
         }
-        LOG_DEBUG("fps " <<fps<<" "<< frame_to_string(const_cast<frame_holder&>(f)));
+        LOG_DEBUG("fps " << fps << " " << frame_description{ f.frame });
         return fps?fps:f.frame->get_stream()->get_framerate();
     }
 
-    void timestamp_composite_matcher::update_next_expected(const frame_holder & f)
+    void timestamp_composite_matcher::update_next_expected(stream_slot& slot, const frame_holder & f)
     {
         auto fps = get_fps(f);
         auto gap = 1000.f / (float)fps;
 
-        auto matcher = find_matcher(f);
-
-        _next_expected[matcher.get()] = f.frame->get_frame_timestamp() + gap;
-        _next_expected_domain[matcher.get()] = f.frame->get_frame_timestamp_domain();
-        LOG_DEBUG(_name << frame_to_string(const_cast<frame_holder&>(f))<<"fps " <<fps<<" gap " <<gap<<" next_expected: "<< _next_expected[matcher.get()]);
+        slot.next_expected = f.frame->get_frame_timestamp() + gap;
+        slot.next_expected_domain = f.frame->get_frame_timestamp_domain();
+        slot.next_expected_domain_known = true;
+        LOG_DEBUG(_name << frame_description{ f.frame } << "fps " << fps << " gap " << gap << " next_expected: " << slot.next_expected);
 
     }
 
@@ -535,62 +554,46 @@ namespace librealsense
     {
         if (f.is_blocking())
             return;
-        std::vector<stream_id> dead_matchers;
         auto now = environment::get_instance().get_time_service()->get_time();
-        for(auto m: _matchers)
+        for (auto&& slot : _slots)
         {
-            auto threshold = _fps[m.second.get()] ? (1000 / _fps[m.second.get()]) * 5 : 500; //if frame of a specific stream didn't arrive for time equivalence to 5 frames duration
-                                                                                             //this stream will be marked as "not active" in order to not stack the other streams
-            if(_last_arrived[m.second.get()] && (now - _last_arrived[m.second.get()]) > threshold)
+            auto threshold = slot.fps ? (1000 / slot.fps) * 5 : 500; //if frame of a specific stream didn't arrive for time equivalence to 5 frames duration
+                                                                     //this stream will be marked as "not active" in order to not stack the other streams
+            if(slot.m && slot.last_arrived && (now - slot.last_arrived) > threshold)
             {
-                std::stringstream s;
-                s << "clean inactive stream in "<<_name;
-                for (auto stream : m.second->get_streams_types())
-                {
-                    s << stream << " ";
-                }
-                LOG_DEBUG(s.str());
+                LOG_DEBUG("clean inactive stream in " << _name << stream_types_description{ *slot.m });
 
-                dead_matchers.push_back(m.first);
-                m.second->set_active(false);
+                slot.m->set_active(false);
+                slot.clear();
+                slot.queued = false;
+                slot.accepting = true;
             }
         }
-
-        for(auto id: dead_matchers)
-        {
-            _frames_queue[_matchers[id].get()].clear();
-            _frames_queue.erase(_matchers[id].get());
-        }
     }
 
-    bool timestamp_composite_matcher::skip_missing_stream(std::vector<matcher*> synced, matcher* missing)
+    bool timestamp_composite_matcher::skip_missing_stream(frame_holder& synced, stream_slot& missing)
     {
-        if(!missing->get_active())
+        if(!missing.m->get_active())
             return true;
 
-        frame_holder* synced_frame;
-
-        _frames_queue[synced[0]].peek(&synced_frame);
-
-        auto next_expected = _next_expected[missing];
+        auto next_expected = missing.next_expected;
 
-        auto it = _next_expected_domain.find(missing);
-        if (it != _next_expected_domain.end())
+        if (missing.next_expected_domain_known)
         {
-            if (it->second != (*synced_frame)->get_frame_timestamp_domain())
+            if (missing.next_expected_domain != synced->get_frame_timestamp_domain())
             {
                 return false;
             }
         }
-        auto gap = 1000.f/ (float)get_fps(*synced_frame);
+        auto gap = 1000.f/ (float)get_fps(synced);
         //next expected of the missing stream didn't updated yet
-        if((*synced_frame)->get_frame_timestamp() > next_expected && abs((*synced_frame)->get_frame_timestamp()- next_expected)<gap*10)
+        if(synced->get_frame_timestamp() > next_expected && abs(synced->get_frame_timestamp()- next_expected)<gap*10)
         {
             LOG_DEBUG("next expected of the missing stream didn't updated yet");
             return false;
         }
 
-        return !are_equivalent((*synced_frame)->get_frame_timestamp(), next_expected, get_fps(*synced_frame));
+        return !are_equivalent(synced->get_frame_timestamp(), next_expected, get_fps(synced));
     }
 
     bool timestamp_composite_matcher::are_equivalent(double a, double b, int fps)
@@ -604,7 +607,7 @@ namespace librealsense
 
     void composite_identity_matcher::sync(frame_holder f, syncronization_environment env)
     {
-        LOG_DEBUG("by_pass_composite_matcher: " << _name << " " << frame_to_string(f));
+        LOG_DEBUG("by_pass_composite_matcher: " << _name << " " << frame_description{ f.frame });
         _callback(std::move(f), env);
     }
 }
@@ -64,6 +64,14 @@ namespace librealsense
     typedef int stream_id;
     typedef std::function<void(frame_holder, syncronization_environment)> sync_callback;
 
+    // Streams a frame, or the frames of a composite, for debug logs. Nothing is formatted
+    // unless the log line is written
+    struct frame_description
+    {
+        frame_interface* frame;
+    };
+    std::ostream& operator<<(std::ostream& out, const frame_description& f);
+
     class matcher_interface
     {
     public:
@@ -112,27 +120,60 @@ namespace librealsense
     class composite_matcher : public matcher
     {
     public:
+        // Frames held per child matcher while waiting for the other streams
+        static const int SLOT_CAPACITY = QUEUE_MAX_SIZE;
+
+        // One per child matcher, kept in a flat array: the frames it delivered that wait for a
+        // match, in a fixed ring, and what the matchers track of its streams
+        struct stream_slot
+        {
+            std::shared_ptr<matcher> m;         // null for a free slot
+            frame_holder frames[SLOT_CAPACITY];
+            int head = 0;
+            int count = 0;
+            bool queued = false;                // takes part in matching
+            bool accepting = true;              // false while a stream cleaned as inactive is turned away
+            double next_expected = 0;
+            bool next_expected_domain_known = false;
+            rs2_timestamp_domain next_expected_domain = RS2_TIMESTAMP_DOMAIN_COUNT;
+            double last_arrived = 0;
+            unsigned int fps = 0;
+
+            frame_holder* front() { return count ? &frames[head] : nullptr; }
+            void push(frame_holder f);
+            frame_holder pop();
+            void clear();
+        };
+
         composite_matcher(std::vector<std::shared_ptr<matcher>> matchers, std::string name);
 
 
         virtual bool are_equivalent(frame_holder& a, frame_holder& b) = 0;
         virtual bool is_smaller_than(frame_holder& a, frame_holder& b) = 0;
-        virtual bool skip_missing_stream(std::vector<matcher*> synced, matcher* missing) = 0;
+        virtual bool skip_missing_stream(frame_holder& synced, stream_slot& missing) = 0;
         virtual void clean_inactive_streams(frame_holder& f) = 0;
-        virtual void update_last_arrived(frame_holder& f, matcher* m) = 0;
+        virtual void update_last_arrived(frame_holder& f, stream_slot& slot) = 0;
 
         void dispatch(frame_holder f, syncronization_environment env) override;
-        std::string frames_to_string(std::vector<librealsense::matcher*> matchers);
         void sync(frame_holder f, syncronization_environment env) override;
-        std::shared_ptr<matcher> find_matcher(const frame_holder& f);
 
     protected:
-        virtual void update_next_expected(const frame_holder& f) = 0;
-
-        std::map<matcher*, single_consumer_frame_queue<frame_holder>> _frames_queue;
-        std::map<stream_id, std::shared_ptr<matcher>> _matchers;
-        std::map<matcher*, double> _next_expected;
-        std::map<matcher*, rs2_timestamp_domain> _next_expected_domain;
+        virtual void update_next_expected(stream_slot& slot, const frame_holder& f) = 0;
+
+        // Index in _slots of the matcher of the frame's stream, creating the matcher when the
+        // stream is new
+        int find_slot(const frame_holder& f);
+        int add_slot(std::shared_ptr<matcher> m);
+
+        std::vector<stream_slot> _slots;
+        std::vector<std::pair<stream_id, int>> _stream_slots;
+
+        // Scratch of sync(), sized along with _slots so matching allocates nothing
+        std::vector<int> _arrived;
+        std::vector<int> _missing;
+        std::vector<int> _synced;
+        std::vector<frame_holder> _match;
+        std::vector<int> _match_keys;
     };
 
     // composite matcher that does not synchronize between any frames, and instead just passes them on to callback
@@ -144,27 +185,24 @@ namespace librealsense
         void sync(frame_holder f, syncronization_environment env) override;
         virtual bool are_equivalent(frame_holder& a, frame_holder& b) override { return false; }
         virtual bool is_smaller_than(frame_holder& a, frame_holder& b) override { return false; }
-        virtual bool skip_missing_stream(std::vector<matcher*> synced, matcher* missing) override { return false; }
+        virtual bool skip_missing_stream(frame_holder& synced, stream_slot& missing) override { return false; }
         virtual void clean_inactive_streams(frame_holder& f) override {}
-        virtual void update_last_arrived(frame_holder& f, matcher* m) override {}
+        virtual void update_last_arrived(frame_holder& f, stream_slot& slot) override {}
 
     protected:
-        virtual void update_next_expected(const frame_holder& f) override {}
+        virtual void update_next_expected(stream_slot& slot, const frame_holder& f) override {}
     };
 
     class frame_number_composite_matcher : public composite_matcher
     {
     public:
         frame_number_composite_matcher(std::vector<std::shared_ptr<matcher>> matchers);
-        virtual void update_last_arrived(frame_holder& f, matcher* m) override;
+        virtual void update_last_arrived(frame_holder& f, stream_slot& slot) override;
         bool are_equivalent(frame_holder& a, frame_holder& b) override;
         bool is_smaller_than(frame_holder& a, frame_holder& b) override;
-        bool skip_missing_stream(std::vector<matcher*> synced, matcher* missing) override;
+        bool skip_missing_stream(frame_holder& synced, stream_slot& missing) override;
         void clean_inactive_streams(frame_holder& f) override;
-        void update_next_expected(const frame_holder& f) override;
-
-    private:
-         std::map<matcher*,unsigned long long> _last_arrived;
+        void update_next_expected(stream_slot& slot, const frame_holder& f) override;
     };
 
     class timestamp_composite_matcher : public composite_matcher
@@ -173,16 +211,13 @@ namespace librealsense
         timestamp_composite_matcher(std::vector<std::shared_ptr<matcher>> matchers);
         bool are_equivalent(frame_holder& a, frame_holder& b) override;
         bool is_smaller_than(frame_holder& a, frame_holder& b) override;
-        virtual void update_last_arrived(frame_holder& f, matcher* m) override;
+        virtual void update_last_arrived(frame_holder& f, stream_slot& slot) override;
         void clean_inactive_streams(frame_holder& f) override;
-        bool skip_missing_stream(std::vector<matcher*> synced, matcher* missing) override;
-        void update_next_expected(const frame_holder & f) override;
+        bool skip_missing_stream(frame_holder& synced, stream_slot& missing) override;
+        void update_next_expected(stream_slot& slot, const frame_holder & f) override;
 
     private:
         unsigned int get_fps(const frame_holder & f);
         bool are_equivalent(double a, double b, int fps);
-        std::map<matcher*, double> _last_arrived;
-        std::map<matcher*, unsigned int> _fps;
-
     };
 }
@@ -0,0 +1,417 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "thread-pool.h"
+
+#include <algorithm>
+#include <exception>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <sched.h>
+#endif
+
+// A spare worker started for a blocked task leaves after staying idle this long
+const std::chrono::seconds SPARE_RETIRE_TIMEOUT(2);
+// Queued work with no task completing for this long means every worker is stuck
+const std::chrono::milliseconds STARVATION_CHECK_PERIOD(100);
+
+thread_pool::thread_pool(unsigned int threads, uint64_t affinity_mask)
+    : _worker_slots(0), _pending(0), _completed(0), _idle(0), _live(0), _blocked(0), _stopping(false),
+      _target(0), _affinity_mask(0), _affinity_generation(0), _next_timer_id(0), _firing(0)
+{
+    configure(threads, affinity_mask);
+    _timer_thread = std::thread([this]() { run_timers(); });
+}
+
+thread_pool::~thread_pool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+        _work_cv.notify_all();
+        _timer_cv.notify_all();
+    }
+    _timer_thread.join();
+    for (auto&& w : _workers)
+    {
+        if (w && w->thread.joinable())
+            w->thread.join();
+    }
+}
+
+thread_pool& thread_pool::get_default()
+{
+    // Never destroyed: dispatchers owned by static objects may outlive any static pool,
+    // and process exit takes the workers down anyway
+    static thread_pool* pool = new thread_pool();
+    return *pool;
+}
+
+void thread_pool::configure(unsigned int threads, uint64_t affinity_mask)
+{
+    if (!threads)
+        threads = std::max(2u, std::thread::hardware_concurrency());
+    threads = std::min(threads, static_cast<unsigned int>(MAX_WORKERS));
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _target = threads;
+    if (_affinity_mask.exchange(affinity_mask) != affinity_mask)
+        ++_affinity_generation;
+    while (_live - _blocked < static_cast<int>(_target) && _live < MAX_WORKERS)
+        add_worker();
+}
+
+unsigned int thread_pool::get_threads() const
+{
+    return _target;
+}
+
+uint64_t thread_pool::get_affinity_mask() const
+{
+    return _affinity_mask;
+}
+
+int thread_pool::get_live_workers() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _live;
+}
+
+void thread_pool::submit(task t)
+{
+    auto& ctx = current();
+    if (ctx.pool == this && ctx.self)
+    {
+        std::lock_guard<std::mutex> lock(ctx.self->mutex);
+        ctx.self->tasks.push_back(std::move(t));
+        ++_pending;
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _injected.push_back(std::move(t));
+        ++_pending;
+        if (_idle.load())
+            _work_cv.notify_one();
+        return;
+    }
+
+    // Pairs with the idle count being raised before a worker re-checks _pending and parks
+    if (_idle.load())
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _work_cv.notify_one();
+    }
+}
+
+namespace
+{
+    struct parallel_for_state
+    {
+        const std::function<void(int, int)>* body;
+        int count;
+        int ranges;
+        std::atomic<int> next;
+        std::atomic<int> done;
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable cv;
+
+        // Helpers that start after the caller claimed every range never touch body,
+        // which lives on the caller's stack
+        void run()
+        {
+            int range;
+            while ((range = next++) < ranges)
+            {
+                try
+                {
+                    (*body)(int(int64_t(range) * count / ranges), int(int64_t(range + 1) * count / ranges));
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!error)
+                        error = std::current_exception();
+                }
+
+                if (++done == ranges)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    cv.notify_all();
+                }
+            }
+        }
+    };
+}
+
+void thread_pool::parallel_for(int count, unsigned int max_workers, const std::function<void(int, int)>& body)
+{
+    if (count <= 0)
+        return;
+
+    auto workers = std::min(max_workers ? max_workers : _target.load(), static_cast<unsigned int>(count));
+    if (workers <= 1)
+    {
+        body(0, count);
+        return;
+    }
+
+    // A few ranges per worker even out stripes of uneven cost
+    auto state = std::make_shared<parallel_for_state>();
+    state->body = &body;
+    state->count = count;
+    state->ranges = std::min(count, static_cast<int>(workers) * 4);
+    state->next = 0;
+    state->done = 0;
+
+    for (unsigned int i = 1; i < workers; i++)
+        submit([state]() { state->run(); });
+    state->run();
+
+    // Only ranges already running on other workers remain, so this wait is short
+    {
+        blocking_scope blocking;
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->cv.wait(lock, [&]() { return state->done.load() == state->ranges; });
+    }
+    if (state->error)
+        std::rethrow_exception(state->error);
+}
+
+uint64_t thread_pool::submit_after(std::chrono::milliseconds delay, task t)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto id = ++_next_timer_id;
+    auto deadline = clock::now() + delay;
+    auto earliest = _timers.empty() || deadline < _timers.begin()->first.first;
+    _timers.emplace(std::make_pair(deadline, id), std::move(t));
+    if (earliest)
+        _timer_cv.notify_one();
+    return id;
+}
+
+bool thread_pool::cancel(uint64_t timer_id)
+{
+    task callback; // destroyed outside the lock
+    std::unique_lock<std::mutex> lock(_mutex);
+    for (auto it = _timers.begin(); it != _timers.end(); ++it)
+    {
+        if (it->first.second == timer_id)
+        {
+            callback = std::move(it->second);
+            _timers.erase(it);
+            lock.unlock();
+            return true;
+        }
+    }
+
+    // The callback may be running right now - unless this is the callback itself, wait it out
+    if (std::this_thread::get_id() != _timer_thread.get_id())
+        _fired_cv.wait(lock, [&]() { return _firing != timer_id; });
+    return false;
+}
+
+void thread_pool::add_worker()
+{
+    if (_stopping)
+        return;
+
+    for (int i = 0; i < MAX_WORKERS; i++)
+    {
+        auto& w = _workers[i];
+        if (!w)
+        {
+            w.reset(new worker());
+            w->index = i;
+            if (_worker_slots.load() < i + 1)
+                _worker_slots = i + 1;
+        }
+        else if (w->live)
+        {
+            continue;
+        }
+
+        // A retired worker exits right after marking itself, so this join is immediate
+        if (w->thread.joinable())
+            w->thread.join();
+        w->live = true;
+        ++_live;
+        w->thread = std::thread(&thread_pool::run, this, w.get());
+        return;
+    }
+}
+
+bool thread_pool::take(worker* self, task& t)
+{
+    {
+        std::lock_guard<std::mutex> lock(self->mutex);
+        if (!self->tasks.empty())
+        {
+            t = std::move(self->tasks.back());
+            self->tasks.pop_back();
+            --_pending;
+            return true;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_injected.empty())
+        {
+            t = std::move(_injected.front());
+            _injected.pop_front();
+            --_pending;
+            return true;
+        }
+    }
+
+    auto slots = _worker_slots.load();
+    for (int i = 1; i < slots; i++)
+    {
+        auto victim = _workers[(self->index + i) % slots].get();
+        if (!victim)
+            continue;
+
+        std::lock_guard<std::mutex> lock(victim->mutex);
+        if (!victim->tasks.empty())
+        {
+            t = std::move(victim->tasks.front());
+            victim->tasks.pop_front();
+            --_pending;
+            return true;
+        }
+    }
+    return false;
+}
+
+void thread_pool::run(worker* self)
+{
+    auto& ctx = current();
+    ctx.pool = this;
+    ctx.self = self;
+
+    while (true)
+    {
+        if (self->affinity_generation != _affinity_generation.load())
+            apply_affinity(self);
+
+        task t;
+        if (take(self, t))
+        {
+            try
+            {
+                t();
+            }
+            catch (...) {}
+            t = nullptr;
+            ++_completed;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (_stopping)
+            break;
+
+        ++_idle;
+        auto woken = _work_cv.wait_for(lock, SPARE_RETIRE_TIMEOUT, [this]() { return _pending.load() > 0 || _stopping; });
+        --_idle;
+
+        if (_stopping)
+            break;
+        if (!woken && surplus())
+        {
+            self->live = false;
+            --_live;
+            break;
+        }
+    }
+
+    ctx.pool = nullptr;
+    ctx.self = nullptr;
+}
+
+void thread_pool::run_timers()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    auto last_completed = _completed.load();
+    auto next_check = clock::now() + STARVATION_CHECK_PERIOD;
+
+    while (!_stopping)
+    {
+        auto now = clock::now();
+        auto first = _timers.begin();
+        if (first != _timers.end() && first->first.first <= now)
+        {
+            _firing = first->first.second;
+            {
+                auto callback = std::move(first->second);
+                _timers.erase(first);
+                lock.unlock();
+                try
+                {
+                    callback();
+                }
+                catch (...) {}
+            }
+            lock.lock();
+            _firing = 0;
+            _fired_cv.notify_all();
+            continue;
+        }
+
+        if (now >= next_check)
+        {
+            // Work has been waiting a whole period without any task completing: every worker is
+            // stuck in something that did not announce itself as blocking, so add one
+            auto completed = _completed.load();
+            if (_pending.load() > 0 && _idle.load() == 0 && completed == last_completed && _live < MAX_WORKERS)
+                add_worker();
+            last_completed = completed;
+            next_check = now + STARVATION_CHECK_PERIOD;
+        }
+
+        auto wake = next_check;
+        if (!_timers.empty())
+            wake = std::min(wake, _timers.begin()->first.first);
+        _timer_cv.wait_until(lock, wake);
+    }
+}
+
+void thread_pool::apply_affinity(worker* self)
+{
+    self->affinity_generation = _affinity_generation.load();
+    auto mask = _affinity_mask.load();
+
+#ifdef _WIN32
+    DWORD_PTR process_mask = 0, system_mask = 0;
+    GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask);
+    SetThreadAffinityMask(GetCurrentThread(), mask ? static_cast<DWORD_PTR>(mask) & process_mask : process_mask);
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    auto cpus = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned int cpu = 0; cpu < 64 && cpu < CPU_SETSIZE; cpu++)
+    {
+        if (mask ? ((mask >> cpu) & 1) : cpu < cpus)
+            CPU_SET(cpu, &set);
+    }
+    sched_setaffinity(0, sizeof(set), &set); // 0 is the calling thread; a failure leaves it unpinned
+#endif
+}
+
+void thread_pool::enter_blocking()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_blocked;
+    // Keep the configured number of workers runnable while this one waits
+    if (_live - _blocked < static_cast<int>(_target) && _idle.load() == 0 && _live < MAX_WORKERS)
+        add_worker();
+}
+
+void thread_pool::leave_blocking()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    --_blocked;
+}
@@ -0,0 +1,157 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+// Shared work-stealing executor behind every dispatcher and active_object.
+// Each worker pushes and pops tasks at the back of its own deque, so a task handed from one
+// dispatcher to the next tends to stay on the same core, and idle workers steal from the
+// front of the other deques or from the injection queue fed by threads outside the pool.
+// A task that blocks (a timed sleep, parking on a queue) announces it with blocking_scope,
+// letting the pool bring in a spare worker instead of starving everything queued behind it
+class thread_pool
+{
+public:
+    typedef std::function<void()> task;
+
+    static const int MAX_WORKERS = 256;
+
+    // 0 threads selects one worker per hardware thread, a 0 affinity mask leaves workers unpinned
+    explicit thread_pool(unsigned int threads = 0, uint64_t affinity_mask = 0);
+    virtual ~thread_pool();
+
+    // The process-wide pool used by dispatchers that were not handed one explicitly
+    static thread_pool& get_default();
+
+    // Can be called at any time: missing workers are started right away, surplus workers
+    // retire once idle, and running workers pick up a new affinity before their next task
+    void configure(unsigned int threads, uint64_t affinity_mask);
+
+    unsigned int get_threads() const;
+    uint64_t get_affinity_mask() const;
+
+    // Number of worker threads currently alive, spares included
+    int get_live_workers() const;
+
+    void submit(task t);
+
+    // Split [0, count) into contiguous ranges and run body(begin, end) on each, using at most
+    // max_workers threads (0 for the pool size) including the caller, which takes part and
+    // returns once every range is done. An exception thrown by body is rethrown to the caller
+    void parallel_for(int count, unsigned int max_workers, const std::function<void(int, int)>& body);
+
+    // Timer callbacks run on the pool's timer thread and are expected to only hand work off
+    // (typically by submitting it). Returns an id for cancel()
+    uint64_t submit_after(std::chrono::milliseconds delay, task t);
+
+    // Once cancel returns the callback is guaranteed not to be running and never to run.
+    // Returns false if the timer already fired or was never scheduled
+    bool cancel(uint64_t timer_id);
+
+    class blocking_scope
+    {
+    public:
+        blocking_scope()
+            : _pool(nullptr)
+        {
+            auto& ctx = current();
+            if (ctx.self && ctx.blocking_depth++ == 0)
+            {
+                _pool = ctx.pool;
+                _pool->enter_blocking();
+            }
+        }
+
+        ~blocking_scope()
+        {
+            auto& ctx = current();
+            if (ctx.self)
+                ctx.blocking_depth--;
+            if (_pool)
+                _pool->leave_blocking();
+        }
+
+    private:
+        blocking_scope(const blocking_scope&) = delete;
+        blocking_scope& operator=(const blocking_scope&) = delete;
+
+        thread_pool* _pool;
+    };
+
+private:
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    typedef std::chrono::steady_clock clock;
+
+    struct worker
+    {
+        std::mutex mutex;
+        std::deque<task> tasks;
+        std::thread thread;
+        int index = 0;
+        bool live = false;                  // guarded by the pool mutex
+        uint64_t affinity_generation = 0;   // owned by the worker thread
+    };
+
+    struct thread_context
+    {
+        thread_pool* pool = nullptr;
+        worker* self = nullptr;
+        int blocking_depth = 0;
+    };
+    static thread_context& current()
+    {
+        static thread_local thread_context ctx;
+        return ctx;
+    }
+
+    void run(worker* self);
+    void run_timers();
+    bool take(worker* self, task& t);
+    void add_worker(); // requires _mutex
+    bool surplus() const { return _live - _blocked > static_cast<int>(_target); }
+    void apply_affinity(worker* self);
+
+    // Virtual, so that code outside the library borrowing single_consumer_queue (the viewer,
+    // some samples) links without the pool; off the pool's threads blocking_scope does nothing
+    virtual void enter_blocking();
+    virtual void leave_blocking();
+
+    std::unique_ptr<worker> _workers[MAX_WORKERS];
+    std::atomic<int> _worker_slots; // slots ever used, bounds the steal scan
+
+    mutable std::mutex _mutex;
+    std::condition_variable _work_cv;
+    std::condition_variable _timer_cv;
+    std::condition_variable _fired_cv;
+    std::deque<task> _injected;
+
+    std::atomic<int> _pending;
+    std::atomic<uint64_t> _completed;
+    std::atomic<int> _idle;
+    int _live;
+    int _blocked;
+    bool _stopping;
+
+    std::atomic<unsigned int> _target;
+    std::atomic<uint64_t> _affinity_mask;
+    std::atomic<uint64_t> _affinity_generation;
+
+    std::map<std::pair<clock::time_point, uint64_t>, task> _timers;
+    uint64_t _next_timer_id;
+    uint64_t _firing;
+    std::thread _timer_thread;
+};
@@ -235,6 +235,32 @@ namespace librealsense
 #undef CASE
     }
 
+    const char* get_string(rs2_record_overflow_policy value)
+    {
+#define CASE(X) STRCASE(RECORD_OVERFLOW_POLICY, X)
+        switch (value)
+        {
+            CASE(BLOCK)
+            CASE(DROP_FRAMES)
+            CASE(STOP_RECORDING)
+        default: assert(!is_valid(value)); return UNKNOWN_VALUE;
+        }
+#undef CASE
+    }
+
+    const char* get_string(rs2_vertex_layout value)
+    {
+#define CASE(X) STRCASE(VERTEX_LAYOUT, X)
+        switch (value)
+        {
+            CASE(XYZ32F)
+            CASE(PLANAR32F)
+            CASE(XYZ16F)
+        default: assert(!is_valid(value)); return UNKNOWN_VALUE;
+        }
+#undef CASE
+    }
+
     const char* get_string(rs2_log_severity value)
     {
 #define CASE(X) STRCASE(LOG_SEVERITY, X)
@@ -328,6 +354,8 @@ namespace librealsense
             CASE(AMBIENT_LIGHT)
             CASE(SENSOR_MODE)
             CASE(EMITTER_ALWAYS_ON)
+            CASE(PROCESSING_THREADS)
+            CASE(OCCLUSION_MASK)
         default: assert(!is_valid(value)); return UNKNOWN_VALUE;
         }
 #undef CASE
@@ -367,6 +395,7 @@ namespace librealsense
             CASE(INVI)
             CASE(W10)
             CASE(Z16H)
+            CASE(Z16C)
         default: assert(!is_valid(value)); return UNKNOWN_VALUE;
         }
 #undef CASE
@@ -46,6 +46,7 @@
 
 #if BUILD_EASYLOGGINGPP
 #include "../third-party/easyloggingpp/src/easylogging++.h"
+#include "log-ring.h"
 #endif // BUILD_EASYLOGGINGPP
 
 typedef unsigned char byte;
@@ -198,6 +199,10 @@ namespace librealsense
     void log_to_console(rs2_log_severity min_severity);
     void log_to_file( rs2_log_severity min_severity, const char* file_path );
     void log_to_callback( rs2_log_severity min_severity, log_callback_ptr callback );
+    // Closes the console, the file and the callbacks, leaving the LOG_* macros to easylogging as before any was open
+    void reset_logger();
+    // Returns once every message logged before it has reached the sinks
+    void flush_log();
 
 #if BUILD_EASYLOGGINGPP
 
@@ -218,11 +223,20 @@ namespace librealsense
 
 #else //RS2_USE_ANDROID_BACKEND
 
-#define LOG_DEBUG(...)   do { CLOG(DEBUG   ,"librealsense") << __VA_ARGS__; } while(false)
-#define LOG_INFO(...)    do { CLOG(INFO    ,"librealsense") << __VA_ARGS__; } while(false)
-#define LOG_WARNING(...) do { CLOG(WARNING ,"librealsense") << __VA_ARGS__; } while(false)
-#define LOG_ERROR(...)   do { CLOG(ERROR   ,"librealsense") << __VA_ARGS__; } while(false)
-#define LOG_FATAL(...)   do { CLOG(FATAL   ,"librealsense") << __VA_ARGS__; } while(false)
+// Messages less severe than LOG_COMPILED_SEVERITY are left out of the build. Once a sink is open, the rest are
+// only evaluated when one takes them, and are formatted on the thread of the log ring (see log-ring.h)
+#ifndef LOG_COMPILED_SEVERITY
+#define LOG_COMPILED_SEVERITY RS2_LOG_SEVERITY_DEBUG
+#endif
+
+#define LOG_RECORD(SEVERITY, ...) do { if (SEVERITY >= LOG_COMPILED_SEVERITY && librealsense::log_enabled(SEVERITY)) { \
+        librealsense::log_record(SEVERITY, __FILE__, __LINE__, ELPP_FUNC) << __VA_ARGS__; } } while(false)
+
+#define LOG_DEBUG(...)   LOG_RECORD(RS2_LOG_SEVERITY_DEBUG, __VA_ARGS__)
+#define LOG_INFO(...)    LOG_RECORD(RS2_LOG_SEVERITY_INFO, __VA_ARGS__)
+#define LOG_WARNING(...) LOG_RECORD(RS2_LOG_SEVERITY_WARN, __VA_ARGS__)
+#define LOG_ERROR(...)   LOG_RECORD(RS2_LOG_SEVERITY_ERROR, __VA_ARGS__)
+#define LOG_FATAL(...)   LOG_RECORD(RS2_LOG_SEVERITY_FATAL, __VA_ARGS__)
 
 #endif // RS2_USE_ANDROID_BACKEND
 
@@ -529,6 +543,8 @@ namespace librealsense
     RS2_ENUM_HELPERS(rs2_log_severity, LOG_SEVERITY)
     RS2_ENUM_HELPERS(rs2_notification_category, NOTIFICATION_CATEGORY)
     RS2_ENUM_HELPERS(rs2_playback_status, PLAYBACK_STATUS)
+    RS2_ENUM_HELPERS(rs2_record_overflow_policy, RECORD_OVERFLOW_POLICY)
+    RS2_ENUM_HELPERS(rs2_vertex_layout, VERTEX_LAYOUT)
     RS2_ENUM_HELPERS(rs2_matchers, MATCHER)
     RS2_ENUM_HELPERS(rs2_sensor_mode, SENSOR_MODE)
     RS2_ENUM_HELPERS(rs2_l500_visual_preset, L500_VISUAL_PRESET)
@@ -1513,7 +1529,7 @@ namespace librealsense
             _backend(backend_ref),_active_object([this](dispatcher::cancellable_timer cancellable_timer)
         {
             polling(cancellable_timer);
-        }), _devices_data()
+        }, 5000), _devices_data()
         {
             _devices_data = {   _backend->query_uvc_devices(),
                                 _backend->query_usb_devices(),
@@ -1527,19 +1543,16 @@ namespace librealsense
 
         void polling(dispatcher::cancellable_timer cancellable_timer)
         {
-            if(cancellable_timer.try_sleep(5000))
+            platform::backend_device_group curr(_backend->query_uvc_devices(), _backend->query_usb_devices(), _backend->query_hid_devices());
+            if(list_changed(_devices_data.uvc_devices, curr.uvc_devices ) ||
+               list_changed(_devices_data.usb_devices, curr.usb_devices ) ||
+               list_changed(_devices_data.hid_devices, curr.hid_devices ))
             {
-                platform::backend_device_group curr(_backend->query_uvc_devices(), _backend->query_usb_devices(), _backend->query_hid_devices());
-                if(list_changed(_devices_data.uvc_devices, curr.uvc_devices ) ||
-                   list_changed(_devices_data.usb_devices, curr.usb_devices ) ||
-                   list_changed(_devices_data.hid_devices, curr.hid_devices ))
+                callback_invocation_holder callback = { _callback_inflight.allocate(), &_callback_inflight };
+                if(callback)
                 {
-                    callback_invocation_holder callback = { _callback_inflight.allocate(), &_callback_inflight };
-                    if(callback)
-                    {
-                        _callback(_devices_data, curr);
-                        _devices_data = curr;
-                    }
+                    _callback(_devices_data, curr);
+                    _devices_data = curr;
                 }
             }
         }
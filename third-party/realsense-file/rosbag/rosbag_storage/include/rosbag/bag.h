@@ -52,6 +52,8 @@
 
 //#include "ros/subscription_callback_helper.h"
 
+#include <deque>
+#include <functional>
 #include <ios>
 #include <map>
 #include <queue>
@@ -124,6 +126,36 @@ public:
     void            setChunkThreshold(uint32_t chunk_threshold);  //!< Set the threshold for creating new chunks
     uint32_t        getChunkThreshold() const;                    //!< Get the threshold for creating new chunks
 
+    //! Compress LZ4 chunks on other threads
+    /*!
+     * \param executor           Runs a task on some worker thread, or is empty to compress on the writing thread
+     * \param max_pending_chunks Number of closed chunks that may wait to be compressed before write() blocks
+     *
+     * Chunks are still written to the file in order, by the thread calling write()
+     */
+    void            setChunkExecutor(std::function<void(std::function<void()>)> executor, uint32_t max_pending_chunks);
+    uint32_t        getPendingChunks() const;                     //!< Get the number of closed chunks not yet written to the file
+
+    //! Decompress the chunks following the one being read on other threads
+    /*!
+     * \param executor     Runs a task on some worker thread, or is empty to decompress on the reading thread
+     * \param chunks_ahead Number of chunks after the one being read to decompress in advance
+     *
+     * The chunks are read from a memory mapping of the file, so the workers never seek the file under
+     * the reading thread. Bags that cannot be mapped are read as if no executor was set
+     */
+    void            setChunkPrefetch(std::function<void(std::function<void()>)> executor, uint32_t chunks_ahead);
+
+    //! Keep the message index of the bags opened for reading in a file
+    /*!
+     * \param path Cache file, or empty not to cache the index
+     *
+     * Takes effect on the next open(). Reading the index otherwise seeks to every chunk of the bag.
+     * A cache that does not match the bag is rewritten through a temporary file beside it; one that
+     * cannot be written is skipped, leaving the bag read as if no path was set
+     */
+    void            setIndexCachePath(std::string const& path);
+
     //! Write a message into the bag file
     /*!
      * \param topic The topic name
@@ -184,14 +216,16 @@ private:
 
     void closeWrite();
 
-    template<class T>
-	std::shared_ptr<T> instantiateBuffer(IndexEntry const& index_entry) const;  //!< deserializes the message held in record_buffer_
+    template<class T, class... Args>
+	std::shared_ptr<T> instantiateBuffer(IndexEntry const& index_entry, Args&&... args) const;  //!< deserializes the message held in record_buffer_
 
     void startWriting();
     void stopWriting();
 
     void startReadingVersion102();
     void startReadingVersion200();
+    bool readIndexCache();
+    void writeIndexCache() const;
 
     // Writing
 
@@ -201,13 +235,17 @@ private:
     void appendConnectionRecordToBuffer(Buffer& buf, ConnectionInfo const* connection_info);
     template<class T>
     void writeMessageDataRecord(uint32_t conn_id, rs2rosinternal::Time const& time, T const& msg);
-    void writeIndexRecords();
+    void writeIndexRecords(std::map<uint32_t, std::multiset<IndexEntry> > const& indexes);
     void writeConnectionRecords();
     void writeChunkInfoRecords();
     void startWritingChunk(rs2rosinternal::Time time);
     void writeChunkHeader(CompressionType compression, uint32_t compressed_size, uint32_t uncompressed_size);
     void stopWritingChunk();
 
+    struct PendingChunk;
+    static void compressPendingChunk(PendingChunk& chunk);
+    void writePendingChunks(size_t max_pending);
+
     // Reading
 
     void readVersion();
@@ -233,6 +271,11 @@ private:
     void     decompressLz4Chunk(ChunkHeader const& chunk_header) const;
     uint32_t getChunkOffset() const;
 
+    struct PrefetchedChunk;
+    static void decompressPrefetchedChunk(PrefetchedChunk& chunk, MappedFile const& file);
+    static void cancelPrefetchedChunk(PrefetchedChunk& chunk);
+    bool        decompressPrefetchedChunks(uint64_t chunk_pos) const;
+
     // Record header I/O
 
     void writeHeader(rs2rosinternal::M_string const& fields);
@@ -287,6 +330,7 @@ private:
 
     // Current chunk
     bool      chunk_open_;
+    bool      chunk_deferred_;                 //!< the chunk is assembled in outgoing_chunk_buffer_ and compressed by chunk_executor_
     ChunkInfo curr_chunk_info_;
     uint64_t  curr_chunk_data_pos_;
 
@@ -310,6 +354,18 @@ private:
     mutable Buffer*  current_buffer_;
 
     mutable uint64_t decompressed_chunk_;      //!< position of decompressed chunk
+
+    std::function<void(std::function<void()>)>   chunk_executor_;
+    uint32_t                                     max_pending_chunks_;
+    std::deque<std::shared_ptr<PendingChunk> >   pending_chunks_;   //!< closed chunks in file order
+    std::shared_ptr<PendingChunk>                spare_chunk_;      //!< written chunk kept for its buffers
+
+    std::string                                  index_cache_path_;
+    std::function<void(std::function<void()>)>   prefetch_executor_;
+    uint32_t                                     prefetch_chunks_ahead_;
+    std::vector<uint64_t>                        chunk_positions_;  //!< sorted, to find the chunks following one
+    mutable std::map<uint64_t, std::shared_ptr<PrefetchedChunk> > prefetched_chunks_;
+    mutable std::shared_ptr<PrefetchedChunk>     current_prefetched_chunk_;
 };
 
 } // namespace rosbag
@@ -382,8 +438,8 @@ void Bag::readMessageDataIntoStream(IndexEntry const& index_entry, Stream& strea
     }
 }
 
-template<class T>
-std::shared_ptr<T> Bag::instantiateBuffer(IndexEntry const& index_entry) const {
+template<class T, class... Args>
+std::shared_ptr<T> Bag::instantiateBuffer(IndexEntry const& index_entry, Args&&... args) const {
     switch (version_)
     {
     case 200:
@@ -405,7 +461,7 @@ std::shared_ptr<T> Bag::instantiateBuffer(IndexEntry const& index_entry) const {
             throw BagFormatException((boost::format("Unknown connection ID: %1%") % connection_id).str());
         ConnectionInfo* connection_info = connection_iter->second;
 
-        std::shared_ptr<T> p = std::make_shared<T>();
+        std::shared_ptr<T> p = std::make_shared<T>(std::forward<Args>(args)...);
 
         rs2rosinternal::serialization::PreDeserializeParams<T> predes_params;
         predes_params.message = p;
@@ -442,7 +498,7 @@ std::shared_ptr<T> Bag::instantiateBuffer(IndexEntry const& index_entry) const {
             throw BagFormatException((boost::format("Unknown connection ID: %1%") % connection_id).str());
         ConnectionInfo* connection_info = connection_iter->second;
 
-        std::shared_ptr<T> p = std::make_shared<T>();
+        std::shared_ptr<T> p = std::make_shared<T>(std::forward<Args>(args)...);
 
         // Create a new connection header, updated with the latching and callerid values
         std::shared_ptr<rs2rosinternal::M_string> message_header(std::make_shared<rs2rosinternal::M_string>());
@@ -543,7 +599,8 @@ void Bag::doWrite(std::string const& topic, rs2rosinternal::Time const& time, T
             }
             connections_[conn_id] = connection_info;
 
-            writeConnectionRecord(connection_info);
+            if (!chunk_deferred_)
+                writeConnectionRecord(connection_info);
             appendConnectionRecordToBuffer(outgoing_chunk_buffer_, connection_info);
         }
 
@@ -555,8 +612,11 @@ void Bag::doWrite(std::string const& topic, rs2rosinternal::Time const& time, T
 
         std::multiset<IndexEntry>& chunk_connection_index = curr_chunk_connection_indexes_[connection_info->id];
         chunk_connection_index.insert(chunk_connection_index.end(), index_entry);
-        std::multiset<IndexEntry>& connection_index = connection_indexes_[connection_info->id];
-        connection_index.insert(connection_index.end(), index_entry);
+        // Deferred chunks are indexed once they have their place in the file
+        if (!chunk_deferred_) {
+            std::multiset<IndexEntry>& connection_index = connection_indexes_[connection_info->id];
+            connection_index.insert(connection_index.end(), index_entry);
+        }
 
         // Increment the connection count
         curr_chunk_info_.connection_counts[connection_info->id]++;
@@ -604,9 +664,11 @@ void Bag::writeMessageDataRecord(uint32_t conn_id, rs2rosinternal::Time const& t
     CONSOLE_BRIDGE_logDebug("Writing MSG_DATA [%llu:%d]: conn=%d sec=%d nsec=%d data_len=%d",
               (unsigned long long) file_.getOffset(), getChunkOffset(), conn_id, time.sec, time.nsec, msg_ser_len);
 
-    writeHeader(header);
-    writeDataLength(msg_ser_len);
-    write((char*) record_buffer_.getData(), msg_ser_len);
+    if (!chunk_deferred_) {
+        writeHeader(header);
+        writeDataLength(msg_ser_len);
+        write((char*) record_buffer_.getData(), msg_ser_len);
+    }
 
     // todo: use better abstraction than appendHeaderToBuffer
     appendHeaderToBuffer(outgoing_chunk_buffer_, header);
@@ -36,6 +36,7 @@
 #define ROSBAG_CHUNKED_FILE_H
 
 #include <ios>
+#include <memory>
 #include <stdint.h>
 #include <string>
 #include "macros.h"
@@ -45,6 +46,30 @@
 
 namespace rosbag {
 
+//! MappedFile is a read-only memory mapping of a whole file
+/*!
+ * The mapping stays valid for as long as a reference to it is held, even after the file it was
+ * made from is closed, so other threads can read from it without seeking the file
+ */
+class ROSBAG_DECL MappedFile
+{
+public:
+    static std::shared_ptr<MappedFile> open(std::string const& filename);  //!< return NULL if the file cannot be mapped
+    ~MappedFile();
+
+    uint8_t const* getData() const;
+    uint64_t       getSize() const;
+
+private:
+    MappedFile();
+    MappedFile(MappedFile const&);
+    MappedFile& operator=(MappedFile const&);
+
+    uint8_t const* data_;
+    uint64_t       size_;
+    void*          handle_;   //!< file mapping object, on Windows
+};
+
 //! ChunkedFile reads and writes files which contain interleaved chunks of compressed and uncompressed data.
 class ROSBAG_DECL ChunkedFile
 {
@@ -78,6 +103,8 @@ public:
     void        seek(uint64_t offset, int origin = std::ios_base::beg); //!< seek to given offset from origin
     void        decompress(CompressionType compression, uint8_t* dest, unsigned int dest_len, uint8_t* source, unsigned int source_len);
 
+    std::shared_ptr<MappedFile const> getMapping() const;       //!< return the file mapped for reading, or NULL if it is open for writing or cannot be mapped
+
 private:
     void open(std::string const& filename, std::string const& mode);
     void clearUnused();
@@ -94,6 +121,8 @@ private:
 
 	std::shared_ptr<Stream> read_stream_;
 	std::shared_ptr<Stream> write_stream_;
+
+    std::shared_ptr<MappedFile const> mapping_;
 };
 
 } // namespace rosbag
@@ -79,12 +79,12 @@ public:
     template<class T>
     bool isType() const;
 
-    //! Templated call to instantiate a message
+    //! Templated call to instantiate a message, constructed from args (such as its allocator)
     /*!
      * returns NULL pointer if incompatible
      */
-    template<class T>
-    std::shared_ptr<T> instantiate() const;
+    template<class T, class... Args>
+    std::shared_ptr<T> instantiate(Args&&... args) const;
   
     //! Write serialized message contents out to a stream
     template<typename Stream>
@@ -157,12 +157,12 @@ bool MessageInstance::isType() const {
     return md5sum == std::string("*") || md5sum == getMD5Sum();
 }
 
-template<class T>
-std::shared_ptr<T> MessageInstance::instantiate() const {
+template<class T, class... Args>
+std::shared_ptr<T> MessageInstance::instantiate(Args&&... args) const {
     if (!isType<T>())
         return std::shared_ptr<T>();
 
-    return bag_->instantiateBuffer<T>(index_entry_);
+    return bag_->instantiateBuffer<T>(index_entry_, std::forward<Args>(args)...);
 }
 
 template<typename Stream>
@@ -29,6 +29,7 @@
 #include "rosbag/message_instance.h"
 #include "rosbag/query.h"
 #include "rosbag/view.h"
+#include "roslz4/lz4s.h"
 
 #if defined(_MSC_VER)
   #include <stdint.h> // only on v2010 and later -> is this enough for msvc and linux?
@@ -38,12 +39,19 @@
 #include <signal.h>
 #include <assert.h>
 #include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
 #include <map>
+#include <mutex>
 #include <tuple>
 #include <boost/foreach.hpp>
 
 #include "console_bridge/console.h"
 #include <memory.h>
+#include <sys/stat.h>
 
 #define foreach BOOST_FOREACH
 
@@ -71,9 +79,12 @@ Bag::Bag() :
     connection_count_(0),
     chunk_count_(0),
     chunk_open_(false),
+    chunk_deferred_(false),
     curr_chunk_data_pos_(0),
     current_buffer_(0),
-    decompressed_chunk_(0)
+    decompressed_chunk_(0),
+    max_pending_chunks_(0),
+    prefetch_chunks_ahead_(0)
 {
 }
 
@@ -87,9 +98,12 @@ Bag::Bag(string const& filename, uint32_t mode) :
     connection_count_(0),
     chunk_count_(0),
     chunk_open_(false),
+    chunk_deferred_(false),
     curr_chunk_data_pos_(0),
     current_buffer_(0),
-    decompressed_chunk_(0)
+    decompressed_chunk_(0),
+    max_pending_chunks_(0),
+    prefetch_chunks_ahead_(0)
 {
     open(filename, mode);
 }
@@ -175,6 +189,16 @@ void Bag::close() {
     chunks_.clear();
     connection_indexes_.clear();
     curr_chunk_connection_indexes_.clear();
+    pending_chunks_.clear();
+    spare_chunk_.reset();
+
+    // Workers already decompressing keep their chunk and the mapping alive
+    for (map<uint64_t, shared_ptr<PrefetchedChunk> >::iterator i = prefetched_chunks_.begin(); i != prefetched_chunks_.end(); i++)
+        cancelPrefetchedChunk(*i->second);
+    prefetched_chunks_.clear();
+    current_prefetched_chunk_.reset();
+    chunk_positions_.clear();
+    decompressed_chunk_ = 0;
 }
 
 void Bag::closeWrite() {
@@ -196,6 +220,25 @@ void Bag::setChunkThreshold(uint32_t chunk_threshold) {
 
 CompressionType Bag::getCompression() const { return compression_; }
 
+void Bag::setChunkExecutor(std::function<void(std::function<void()>)> executor, uint32_t max_pending_chunks) {
+    if (file_.isOpen() && chunk_open_)
+        stopWritingChunk();
+
+    chunk_executor_ = executor;
+    max_pending_chunks_ = max_pending_chunks;
+    if (file_.isOpen())
+        writePendingChunks(max_pending_chunks_);
+}
+
+uint32_t Bag::getPendingChunks() const { return static_cast<uint32_t>(pending_chunks_.size()); }
+
+void Bag::setChunkPrefetch(std::function<void(std::function<void()>)> executor, uint32_t chunks_ahead) {
+    prefetch_executor_ = executor;
+    prefetch_chunks_ahead_ = chunks_ahead;
+}
+
+void Bag::setIndexCachePath(string const& path) { index_cache_path_ = path; }
+
 std::tuple<std::string, uint64_t, uint64_t> Bag::getCompressionInfo() const
 {
     std::map<std::string, uint64_t> compression_counts;
@@ -297,6 +340,7 @@ void Bag::startWriting() {
 void Bag::stopWriting() {
     if (chunk_open_)
         stopWritingChunk();
+    writePendingChunks(0);
 
     seek(0, std::ios::end);
 
@@ -323,24 +367,176 @@ void Bag::startReadingVersion200() {
     for (uint32_t i = 0; i < chunk_count_; i++)
         readChunkInfoRecord();
 
-    // Read the connection indexes for each chunk
-    foreach(ChunkInfo const& chunk_info, chunks_) {
-        curr_chunk_info_ = chunk_info;
+    // Read the connection indexes for each chunk, unless they were cached
+    if (!readIndexCache()) {
+        foreach(ChunkInfo const& chunk_info, chunks_) {
+            curr_chunk_info_ = chunk_info;
 
-        seek(curr_chunk_info_.pos);
+            seek(curr_chunk_info_.pos);
 
-        // Skip over the chunk data
-        ChunkHeader chunk_header;
-        readChunkHeader(chunk_header);
-        seek(chunk_header.compressed_size, std::ios::cur);
+            // Skip over the chunk data
+            ChunkHeader chunk_header;
+            readChunkHeader(chunk_header);
+            seek(chunk_header.compressed_size, std::ios::cur);
+
+            // Read the index records after the chunk
+            for (unsigned int i = 0; i < chunk_info.connection_counts.size(); i++)
+                readConnectionIndexRecord200();
+        }
+
+        // At this point we don't have a curr_chunk_info anymore so we reset it
+        curr_chunk_info_ = ChunkInfo();
+
+        writeIndexCache();
+    }
+
+    chunk_positions_.clear();
+    foreach(ChunkInfo const& chunk_info, chunks_)
+        chunk_positions_.push_back(chunk_info.pos);
+    std::sort(chunk_positions_.begin(), chunk_positions_.end());
+}
+
+// Index cache
+
+namespace {
+
+const char INDEX_CACHE_MAGIC[8] = { '#', 'R', 'O', 'S', 'I', 'D', 'X', '1' };
+
+// Entries are stored as sec, nsec, chunk_pos and offset
+const size_t INDEX_CACHE_ENTRY_SIZE = 4 + 4 + 8 + 4;
+
+// What identifies the bag a cache was made from: its size and modification time, and where its
+// index starts and what it holds
+bool getIndexCacheKey(string const& filename, uint64_t index_data_pos, uint32_t connection_count, uint32_t chunk_count, uint64_t key[5]) {
+#if defined(_MSC_VER)
+    struct __stat64 st;
+    if (_stat64(filename.c_str(), &st) != 0)
+        return false;
+#else
+    struct stat st;
+    if (stat(filename.c_str(), &st) != 0)
+        return false;
+#endif
+    key[0] = static_cast<uint64_t>(st.st_size);
+    key[1] = static_cast<uint64_t>(st.st_mtime);
+    key[2] = index_data_pos;
+    key[3] = connection_count;
+    key[4] = chunk_count;
+    return true;
+}
+
+}
+
+bool Bag::readIndexCache() {
+    if (index_cache_path_.empty() || (mode_ & bagmode::Append))
+        return false;
+
+    uint64_t key[5];
+    if (!getIndexCacheKey(file_.getFileName(), index_data_pos_, connection_count_, chunk_count_, key))
+        return false;
+
+    std::ifstream in(index_cache_path_.c_str(), std::ios::binary);
+    if (!in)
+        return false;
+    vector<char> cache((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    size_t header_size = sizeof(INDEX_CACHE_MAGIC) + sizeof(key) + 4;
+    if (cache.size() < header_size
+        || memcmp(cache.data(), INDEX_CACHE_MAGIC, sizeof(INDEX_CACHE_MAGIC)) != 0
+        || memcmp(cache.data() + sizeof(INDEX_CACHE_MAGIC), key, sizeof(key)) != 0) {
+        CONSOLE_BRIDGE_logDebug("Index cache %s does not match the bag", index_cache_path_.c_str());
+        return false;
+    }
+
+    // Entries with invalid times are not indexed, so there can be fewer than the chunk info records count
+    uint64_t expected_entries = 0;
+    foreach(ChunkInfo const& chunk_info, chunks_)
+        for (map<uint32_t, uint32_t>::const_iterator i = chunk_info.connection_counts.begin(); i != chunk_info.connection_counts.end(); i++)
+            expected_entries += i->second;
+
+    char const* ptr = cache.data() + sizeof(INDEX_CACHE_MAGIC) + sizeof(key);
+    char const* end = cache.data() + cache.size();
+    uint32_t index_count;
+    memcpy(&index_count, ptr, 4);
+    ptr += 4;
+
+    map<uint32_t, multiset<IndexEntry> > indexes;
+    uint64_t entries = 0;
+    for (uint32_t i = 0; i < index_count; i++) {
+        uint32_t connection_id, count;
+        if (end - ptr < 8)
+            return false;
+        memcpy(&connection_id, ptr, 4);
+        memcpy(&count, ptr + 4, 4);
+        ptr += 8;
+        if (static_cast<uint64_t>(end - ptr) < count * INDEX_CACHE_ENTRY_SIZE)
+            return false;
+
+        // The entries were written in order, so each goes at the end
+        multiset<IndexEntry>& index = indexes[connection_id];
+        for (uint32_t j = 0; j < count; j++, ptr += INDEX_CACHE_ENTRY_SIZE) {
+            IndexEntry e;
+            memcpy(&e.time.sec,  ptr,      4);
+            memcpy(&e.time.nsec, ptr + 4,  4);
+            memcpy(&e.chunk_pos, ptr + 8,  8);
+            memcpy(&e.offset,    ptr + 16, 4);
+            index.insert(index.end(), e);
+        }
+        entries += count;
+    }
+    if (ptr != end || entries > expected_entries)
+        return false;
+
+    connection_indexes_.swap(indexes);
+    CONSOLE_BRIDGE_logDebug("Read %llu index entries from %s", (unsigned long long) entries, index_cache_path_.c_str());
+    return true;
+}
+
+void Bag::writeIndexCache() const {
+    if (index_cache_path_.empty() || (mode_ & bagmode::Append))
+        return;
+
+    uint64_t key[5];
+    if (!getIndexCacheKey(file_.getFileName(), index_data_pos_, connection_count_, chunk_count_, key))
+        return;
+
+    // Written beside the cache and moved over it once whole, so a reader never finds half of it
+    string temp_path = index_cache_path_ + ".tmp";
+    std::ofstream out(temp_path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out) {
+        CONSOLE_BRIDGE_logDebug("Cannot write the index cache %s", index_cache_path_.c_str());
+        return;
+    }
+
+    uint32_t index_count = static_cast<uint32_t>(connection_indexes_.size());
+    out.write(INDEX_CACHE_MAGIC, sizeof(INDEX_CACHE_MAGIC));
+    out.write((char const*) key, sizeof(key));
+    out.write((char const*) &index_count, 4);
 
-        // Read the index records after the chunk
-        for (unsigned int i = 0; i < chunk_info.connection_counts.size(); i++)
-            readConnectionIndexRecord200();
+    vector<char> entries;
+    for (map<uint32_t, multiset<IndexEntry> >::const_iterator i = connection_indexes_.begin(); i != connection_indexes_.end(); i++) {
+        uint32_t count = static_cast<uint32_t>(i->second.size());
+        out.write((char const*) &i->first, 4);
+        out.write((char const*) &count, 4);
+
+        entries.resize(count * INDEX_CACHE_ENTRY_SIZE);
+        char* ptr = entries.data();
+        foreach(IndexEntry const& e, i->second) {
+            memcpy(ptr,      &e.time.sec,  4);
+            memcpy(ptr + 4,  &e.time.nsec, 4);
+            memcpy(ptr + 8,  &e.chunk_pos, 8);
+            memcpy(ptr + 16, &e.offset,    4);
+            ptr += INDEX_CACHE_ENTRY_SIZE;
+        }
+        out.write(entries.data(), entries.size());
     }
 
-    // At this point we don't have a curr_chunk_info anymore so we reset it
-    curr_chunk_info_ = ChunkInfo();
+    out.close();
+    std::remove(index_cache_path_.c_str());
+    if (!out || std::rename(temp_path.c_str(), index_cache_path_.c_str()) != 0) {
+        CONSOLE_BRIDGE_logDebug("Cannot write the index cache %s", index_cache_path_.c_str());
+        std::remove(temp_path.c_str());
+    }
 }
 
 void Bag::startReadingVersion102() {
@@ -442,7 +638,9 @@ void Bag::readFileHeaderRecord() {
 }
 
 uint32_t Bag::getChunkOffset() const {
-    if (compression_ == compression::Uncompressed)
+    if (chunk_deferred_)
+        return outgoing_chunk_buffer_.getSize();
+    else if (compression_ == compression::Uncompressed)
         return static_cast<uint32_t>(file_.getOffset() - curr_chunk_data_pos_);
     else
         return file_.getCompressedBytesIn();
@@ -454,6 +652,14 @@ void Bag::startWritingChunk(Time time) {
     curr_chunk_info_.start_time = time;
     curr_chunk_info_.end_time   = time;
 
+    // Deferred chunks only reach the file once compressed, and their position is known then
+    chunk_deferred_ = chunk_executor_ && compression_ == compression::LZ4;
+    if (chunk_deferred_) {
+        outgoing_chunk_buffer_.setSize(0);
+        chunk_open_ = true;
+        return;
+    }
+
     // Write the chunk header, with a place-holder for the data sizes (we'll fill in when the chunk is finished)
     writeChunkHeader(compression_, 0, 0);
 
@@ -466,7 +672,104 @@ void Bag::startWritingChunk(Time time) {
     chunk_open_ = true;
 }
 
+// A chunk closed while deferred compression is on, from the moment it is handed to the executor
+// until it is written. Whichever thread gets to it first compresses it: a worker, or the writing
+// thread when it cannot wait any longer, so a busy executor never stalls the writer
+struct Bag::PendingChunk
+{
+    enum { Queued, Running, Done };
+
+    ChunkInfo                                     info;
+    std::map<uint32_t, std::multiset<IndexEntry> > indexes;
+    Buffer                                        data;
+    Buffer                                        compressed;
+    std::string                                   error;
+
+    std::atomic<int>        state;
+    std::mutex              mutex;
+    std::condition_variable done;
+};
+
+void Bag::compressPendingChunk(PendingChunk& chunk) {
+    int queued = PendingChunk::Queued;
+    if (!chunk.state.compare_exchange_strong(queued, PendingChunk::Running))
+        return;
+
+    // Same framing and block size as LZ4Stream, with room for incompressible data
+    uint32_t size = chunk.data.getSize();
+    unsigned int compressed_size = size + size / 128 + 4096;
+    chunk.compressed.setSize(compressed_size);
+    int ret = roslz4_buffToBuffCompress((char*) chunk.data.getData(), size,
+                                        (char*) chunk.compressed.getData(), &compressed_size, 6);
+    if (ret == ROSLZ4_OK)
+        chunk.compressed.setSize(compressed_size);
+    else
+        chunk.error = (format("LZ4 compression of a chunk failed with error %1%") % ret).str();
+
+    std::lock_guard<std::mutex> lock(chunk.mutex);
+    chunk.state = PendingChunk::Done;
+    chunk.done.notify_all();
+}
+
+void Bag::writePendingChunks(size_t max_pending) {
+    while (!pending_chunks_.empty()) {
+        shared_ptr<PendingChunk> chunk = pending_chunks_.front();
+        if (pending_chunks_.size() > max_pending) {
+            compressPendingChunk(*chunk);
+            std::unique_lock<std::mutex> lock(chunk->mutex);
+            chunk->done.wait(lock, [&]() { return chunk->state == PendingChunk::Done; });
+        }
+        else if (chunk->state != PendingChunk::Done)
+            break;
+
+        pending_chunks_.pop_front();
+        if (!chunk->error.empty())
+            throw BagIOException(chunk->error);
+
+        seek(0, std::ios::end);
+        chunk->info.pos = file_.getOffset();
+        writeChunkHeader(compression::LZ4, chunk->compressed.getSize(), chunk->data.getSize());
+        write((char*) chunk->compressed.getData(), chunk->compressed.getSize());
+        chunks_.push_back(chunk->info);
+
+        writeIndexRecords(chunk->indexes);
+        for (map<uint32_t, multiset<IndexEntry> >::iterator i = chunk->indexes.begin(); i != chunk->indexes.end(); i++) {
+            multiset<IndexEntry>& connection_index = connection_indexes_[i->first];
+            foreach(IndexEntry e, i->second) {
+                e.chunk_pos = chunk->info.pos;
+                connection_index.insert(connection_index.end(), e);
+            }
+        }
+        file_size_ = file_.getOffset();
+
+        // The executor may still hold a reference for a moment after the chunk is done
+        chunk->indexes.clear();
+        spare_chunk_ = chunk;
+    }
+}
+
 void Bag::stopWritingChunk() {
+    if (chunk_deferred_) {
+        shared_ptr<PendingChunk> chunk = spare_chunk_ && spare_chunk_.use_count() == 1 ? spare_chunk_ : std::make_shared<PendingChunk>();
+        spare_chunk_.reset();
+
+        chunk->info = curr_chunk_info_;
+        chunk->indexes.swap(curr_chunk_connection_indexes_);
+        chunk->data.swap(outgoing_chunk_buffer_);
+        chunk->error.clear();
+        chunk->state = PendingChunk::Queued;
+        outgoing_chunk_buffer_.setSize(0);
+        curr_chunk_connection_indexes_.clear();
+        curr_chunk_info_.connection_counts.clear();
+        chunk_open_ = false;
+        chunk_deferred_ = false;
+
+        pending_chunks_.push_back(chunk);
+        chunk_executor_([chunk]() { compressPendingChunk(*chunk); });
+        writePendingChunks(max_pending_chunks_);
+        return;
+    }
+
     // Add this chunk to the index
     chunks_.push_back(curr_chunk_info_);
 
@@ -483,7 +786,7 @@ void Bag::stopWritingChunk() {
 
     // Write out the indexes and clear them
     seek(end_of_chunk_pos);
-    writeIndexRecords();
+    writeIndexRecords(curr_chunk_connection_indexes_);
     curr_chunk_connection_indexes_.clear();
 
     // Clear the connection counts
@@ -534,8 +837,8 @@ void Bag::readChunkHeader(ChunkHeader& chunk_header) const {
 
 // Index records
 
-void Bag::writeIndexRecords() {
-    for (map<uint32_t, multiset<IndexEntry> >::const_iterator i = curr_chunk_connection_indexes_.begin(); i != curr_chunk_connection_indexes_.end(); i++) {
+void Bag::writeIndexRecords(map<uint32_t, multiset<IndexEntry> > const& indexes) {
+    for (map<uint32_t, multiset<IndexEntry> >::const_iterator i = indexes.begin(); i != indexes.end(); i++) {
         uint32_t                    connection_id = i->first;
         multiset<IndexEntry> const& index         = i->second;
 
@@ -791,11 +1094,16 @@ void Bag::decompressChunk(uint64_t chunk_pos) const {
         return;
     }
 
-    current_buffer_ = &decompress_buffer_;
+    if (decompressed_chunk_ == chunk_pos) {
+        current_buffer_ = &decompress_buffer_;
+        return;
+    }
 
-    if (decompressed_chunk_ == chunk_pos)
+    if (decompressPrefetchedChunks(chunk_pos))
         return;
 
+    current_buffer_ = &decompress_buffer_;
+
     // Seek to the start of the chunk
     seek(chunk_pos);
 
@@ -816,6 +1124,149 @@ void Bag::decompressChunk(uint64_t chunk_pos) const {
     decompressed_chunk_ = chunk_pos;
 }
 
+struct Bag::PrefetchedChunk
+{
+    enum { Queued, Running, Done };
+
+    uint64_t    pos;
+    Buffer      data;
+    std::string error;
+
+    std::atomic<int>        state;
+    std::mutex              mutex;
+    std::condition_variable done;
+};
+
+void Bag::decompressPrefetchedChunk(PrefetchedChunk& chunk, MappedFile const& file) {
+    int queued = PrefetchedChunk::Queued;
+    if (!chunk.state.compare_exchange_strong(queued, PrefetchedChunk::Running))
+        return;
+
+    try {
+        // The chunk record: header length, header, data length and data
+        uint8_t const* data = file.getData();
+        uint64_t       size = file.getSize();
+        uint64_t       pos  = chunk.pos;
+        uint32_t header_len, data_len;
+        if (pos + 4 > size)
+            throw BagFormatException("Chunk record past the end of the file");
+        memcpy(&header_len, data + pos, 4);
+        pos += 4;
+        if (pos + header_len + 4 > size)
+            throw BagFormatException("Chunk record past the end of the file");
+
+        rs2rosinternal::Header header;
+        string error_msg;
+        if (!header.parse(data + pos, header_len, error_msg))
+            throw BagFormatException("Error reading CHUNK record: " + error_msg);
+        pos += header_len;
+        memcpy(&data_len, data + pos, 4);
+        pos += 4;
+        if (pos + data_len > size)
+            throw BagFormatException("Chunk record past the end of the file");
+
+        M_string const& fields = *header.getValues();
+        M_string::const_iterator op           = fields.find(OP_FIELD_NAME);
+        M_string::const_iterator compression  = fields.find(COMPRESSION_FIELD_NAME);
+        M_string::const_iterator uncompressed = fields.find(SIZE_FIELD_NAME);
+        if (op == fields.end() || op->second.size() != 1 || (uint8_t) op->second[0] != OP_CHUNK
+            || compression == fields.end() || uncompressed == fields.end() || uncompressed->second.size() != 4)
+            throw BagFormatException("Expected CHUNK op not found");
+
+        uint32_t uncompressed_size;
+        memcpy(&uncompressed_size, uncompressed->second.data(), 4);
+        chunk.data.setSize(uncompressed_size);
+
+        if (compression->second == COMPRESSION_NONE && data_len == uncompressed_size)
+            memcpy(chunk.data.getData(), data + pos, data_len);
+        else if (compression->second == COMPRESSION_LZ4) {
+            unsigned int actual_size = uncompressed_size;
+            int ret = roslz4_buffToBuffDecompress((char*) data + pos, data_len, (char*) chunk.data.getData(), &actual_size);
+            if (ret != ROSLZ4_OK || actual_size != uncompressed_size)
+                throw BagException((format("LZ4 decompression of a chunk failed with error %1%") % ret).str());
+        }
+        else
+            throw BagException("Chunk not prefetched: " + compression->second);
+    }
+    catch (std::exception const& e) {
+        chunk.error = e.what();
+    }
+
+    std::lock_guard<std::mutex> lock(chunk.mutex);
+    chunk.state = PrefetchedChunk::Done;
+    chunk.done.notify_all();
+}
+
+void Bag::cancelPrefetchedChunk(PrefetchedChunk& chunk) {
+    // A chunk no worker has started is dropped without being decompressed
+    int queued = PrefetchedChunk::Queued;
+    chunk.state.compare_exchange_strong(queued, PrefetchedChunk::Done);
+}
+
+bool Bag::decompressPrefetchedChunks(uint64_t chunk_pos) const {
+    shared_ptr<MappedFile const> file = file_.getMapping();
+    if (!prefetch_executor_ || !file)
+        return false;
+
+    if (current_prefetched_chunk_ && current_prefetched_chunk_->pos == chunk_pos) {
+        current_buffer_ = &current_prefetched_chunk_->data;
+        return true;
+    }
+
+    vector<uint64_t>::const_iterator chunk_iter = std::lower_bound(chunk_positions_.begin(), chunk_positions_.end(), chunk_pos);
+    if (chunk_iter == chunk_positions_.end() || *chunk_iter != chunk_pos)
+        return false;
+
+    // Keep the chunk before this one, as messages close in time can be read back and forth across
+    // chunks, and queue the chunks after it that are not decompressed or queued already
+    size_t index = chunk_iter - chunk_positions_.begin();
+    uint64_t first_pos = chunk_positions_[index > 0 ? index - 1 : 0];
+    size_t   last      = std::min<size_t>(index + prefetch_chunks_ahead_, chunk_positions_.size() - 1);
+    uint64_t last_pos  = chunk_positions_[last];
+
+    map<uint64_t, shared_ptr<PrefetchedChunk> >::iterator i = prefetched_chunks_.begin();
+    while (i != prefetched_chunks_.end()) {
+        if (i->first >= first_pos && i->first <= last_pos) {
+            i++;
+            continue;
+        }
+        cancelPrefetchedChunk(*i->second);
+        prefetched_chunks_.erase(i++);
+    }
+
+    for (size_t k = index; k <= last; k++) {
+        shared_ptr<PrefetchedChunk>& chunk = prefetched_chunks_[chunk_positions_[k]];
+        if (chunk)
+            continue;
+        chunk = std::make_shared<PrefetchedChunk>();
+        chunk->pos = chunk_positions_[k];
+        chunk->state = PrefetchedChunk::Queued;
+        if (k > index) {
+            shared_ptr<PrefetchedChunk> queued_chunk = chunk;
+            prefetch_executor_([queued_chunk, file]() { decompressPrefetchedChunk(*queued_chunk, *file); });
+        }
+    }
+
+    // The chunk is decompressed here if no worker got to it yet
+    shared_ptr<PrefetchedChunk> chunk = prefetched_chunks_[chunk_pos];
+    decompressPrefetchedChunk(*chunk, *file);
+    {
+        std::unique_lock<std::mutex> lock(chunk->mutex);
+        chunk->done.wait(lock, [&]() { return chunk->state == PrefetchedChunk::Done; });
+    }
+
+    // Chunks that cannot be read from the mapping are read from the file, which reports the errors
+    if (!chunk->error.empty()) {
+        CONSOLE_BRIDGE_logDebug("%s", chunk->error.c_str());
+        prefetched_chunks_.erase(chunk_pos);
+        return false;
+    }
+
+    current_prefetched_chunk_ = chunk;
+    current_buffer_ = &chunk->data;
+    return true;
+}
+
 void Bag::readMessageDataRecord102(uint64_t offset, rs2rosinternal::Header& header) const {
     CONSOLE_BRIDGE_logDebug("readMessageDataRecord: offset=%llu", (unsigned long long) offset);
 
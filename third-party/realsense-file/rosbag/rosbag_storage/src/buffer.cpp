@@ -56,6 +56,12 @@ void Buffer::setSize(uint32_t size) {
     ensureCapacity(size);
 }
 
+void Buffer::swap(Buffer& other) {
+    uint8_t* buffer = buffer_;     buffer_ = other.buffer_;     other.buffer_ = buffer;
+    uint32_t capacity = capacity_; capacity_ = other.capacity_; other.capacity_ = capacity;
+    uint32_t size = size_;         size_ = other.size_;         other.size_ = size;
+}
+
 void Buffer::ensureCapacity(uint32_t capacity) {
     if (capacity <= capacity_)
         return;
@@ -51,6 +51,18 @@
 #        define fileno _fileno
 #        define ftruncate _chsize_s //Intel Realsense Change, Was: #define ftruncate _chsize 
 #    endif
+#    ifndef WIN32_LEAN_AND_MEAN
+#        define WIN32_LEAN_AND_MEAN
+#    endif
+#    ifndef NOMINMAX
+#        define NOMINMAX
+#    endif
+#    include <windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
 #endif
 
 using std::string;
@@ -60,6 +72,64 @@ using rs2rosinternal::Exception;
 
 namespace rosbag {
 
+// MappedFile
+
+MappedFile::MappedFile() : data_(NULL), size_(0), handle_(NULL) { }
+
+shared_ptr<MappedFile> MappedFile::open(string const& filename) {
+    shared_ptr<MappedFile> mapping(new MappedFile());
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return shared_ptr<MappedFile>();
+
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+        mapping->handle_ = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping->handle_) {
+            mapping->data_ = static_cast<uint8_t const*>(MapViewOfFile(mapping->handle_, FILE_MAP_READ, 0, 0, 0));
+            mapping->size_ = size.QuadPart;
+        }
+    }
+    CloseHandle(file);
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return shared_ptr<MappedFile>();
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* data = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (data != MAP_FAILED) {
+            mapping->data_ = static_cast<uint8_t const*>(data);
+            mapping->size_ = st.st_size;
+        }
+    }
+    ::close(fd);
+#endif
+    if (!mapping->data_)
+        return shared_ptr<MappedFile>();
+    return mapping;
+}
+
+MappedFile::~MappedFile() {
+#ifdef _WIN32
+    if (data_)
+        UnmapViewOfFile(data_);
+    if (handle_)
+        CloseHandle(handle_);
+#else
+    if (data_)
+        munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+}
+
+uint8_t const* MappedFile::getData() const { return data_; }
+uint64_t       MappedFile::getSize() const { return size_; }
+
+// ChunkedFile
+
 ChunkedFile::ChunkedFile() :
     file_(NULL),
     offset_(0),
@@ -76,7 +146,12 @@ ChunkedFile::~ChunkedFile() {
 
 void ChunkedFile::openReadWrite(string const& filename) { open(filename, "r+b"); }
 void ChunkedFile::openWrite    (string const& filename) { open(filename, "w+b");  }
-void ChunkedFile::openRead     (string const& filename) { open(filename, "rb");  }
+void ChunkedFile::openRead     (string const& filename) {
+    open(filename, "rb");
+
+    // Reading works without the mapping, only slower
+    mapping_ = MappedFile::open(filename);
+}
 
 void ChunkedFile::open(string const& filename, string const& mode) {
     // Check if file is already open
@@ -145,6 +220,7 @@ void ChunkedFile::close() {
 
     file_ = NULL;
     filename_.clear();
+    mapping_.reset();
     
     clearUnused();
 }
@@ -217,6 +293,8 @@ void ChunkedFile::decompress(CompressionType compression, uint8_t* dest, unsigne
     stream_factory_->getStream(compression)->decompress(dest, dest_len, source, source_len);
 }
 
+shared_ptr<MappedFile const> ChunkedFile::getMapping() const { return mapping_; }
+
 void ChunkedFile::clearUnused() {
     unused_ = NULL;
     nUnused_ = 0;
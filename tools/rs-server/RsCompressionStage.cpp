@@ -0,0 +1,148 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "RsCompressionStage.hh"
+#include <NetdevLog.h>
+#include <algorithm>
+#include <cstring>
+
+RsCompressionStage::RsCompressionStage(std::vector<std::shared_ptr<ICompression>> t_compressors, rs2::frame_queue t_output, MemoryPool* t_memPool, StreamStatistic* t_statistic, int t_queueSize, SkipPolicy t_policy)
+    : m_output(t_output)
+    , m_memPool(t_memPool)
+    , m_statistic(t_statistic)
+    , m_queueSize(t_queueSize)
+    , m_policy(t_policy)
+{
+    for(auto& compressor : t_compressors)
+    {
+        m_workers.emplace_back(&RsCompressionStage::workerLoop, this, compressor);
+    }
+}
+
+RsCompressionStage::~RsCompressionStage()
+{
+    stop();
+}
+
+void RsCompressionStage::push(rs2::frame t_frame)
+{
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        if(m_stopping)
+        {
+            return;
+        }
+        if(m_queue.size() >= m_queueSize)
+        {
+            m_statistic->m_droppedFrameCounter++;
+            if(m_policy == SkipPolicy::dropNewest)
+            {
+                return;
+            }
+            m_queue.pop_front();
+        }
+        m_queue.push_back({t_frame, std::chrono::high_resolution_clock::now()});
+    }
+    m_frameReady.notify_one();
+}
+
+void RsCompressionStage::stop()
+{
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_stopping = true;
+        m_queue.clear();
+    }
+    m_frameReady.notify_all();
+    for(auto& worker : m_workers)
+    {
+        if(worker.joinable())
+        {
+            worker.join();
+        }
+    }
+    m_done.clear();
+}
+
+void RsCompressionStage::workerLoop(std::shared_ptr<ICompression> t_compressor)
+{
+    while(true)
+    {
+        Pending pending;
+        long long seq;
+        {
+            std::unique_lock<std::mutex> lk(m_mutex);
+            m_frameReady.wait(lk, [this] { return m_stopping || !m_queue.empty(); });
+            if(m_stopping)
+            {
+                return;
+            }
+            pending = m_queue.front();
+            m_queue.pop_front();
+            // numbered as taken, so the frames a full queue skipped leave no gap
+            seq = m_nextSeq++;
+        }
+
+        auto compressionBegin = std::chrono::high_resolution_clock::now();
+        int frameSize = -1;
+        unsigned char* buff = m_memPool->getNextMem(sizeof(RsFrameHeader) + pending.frame.get_data_size());
+        if(buff != nullptr)
+        {
+            frameSize = t_compressor->compressBuffer((unsigned char*)pending.frame.get_data(), pending.frame.get_data_size(), buff);
+            if(frameSize != -1)
+            {
+                memcpy((unsigned char*)pending.frame.get_data(), buff, frameSize);
+            }
+            m_memPool->returnMem(buff);
+        }
+        else
+        {
+            // skipped as a full queue would, the pool having no buffer for it
+            std::lock_guard<std::mutex> lk(m_mutex);
+            m_statistic->m_droppedFrameCounter++;
+        }
+        auto compressionTime = std::chrono::high_resolution_clock::now() - compressionBegin;
+
+        complete(seq, frameSize != -1 ? pending.frame : rs2::frame(), pending.arrival, compressionTime, frameSize);
+    }
+}
+
+void RsCompressionStage::complete(long long t_seq, rs2::frame t_frame, std::chrono::high_resolution_clock::time_point t_arrival, std::chrono::duration<double> t_compressionTime, int t_compressedSize)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if(m_stopping)
+    {
+        return;
+    }
+
+    StreamStatistic& st = *m_statistic;
+    st.m_compressionTime = t_compressionTime;
+    st.m_avgCompressionTime += (1000 * t_compressionTime.count() - st.m_avgCompressionTime) / ++st.m_compressionFrameCounter;
+    if(t_frame)
+    {
+        st.m_decompressedSizeSum += t_frame.get_data_size();
+        st.m_compressedSizeSum += t_compressedSize;
+    }
+
+    // out in the order the frames came, each waiting for those taken before it
+    m_done[t_seq] = {t_frame, t_arrival};
+    while(!m_done.empty() && m_done.begin()->first == m_nextOut)
+    {
+        Pending done = m_done.begin()->second;
+        m_done.erase(m_done.begin());
+        m_nextOut++;
+        if(!done.frame)
+        {
+            continue;
+        }
+        m_output.enqueue(done.frame);
+
+        st.m_processingTime = std::chrono::high_resolution_clock::now() - done.arrival;
+        st.m_avgProcessingTime += (1000 * st.m_processingTime.count() - st.m_avgProcessingTime) / ++st.m_frameCounter;
+        if(st.m_frameCounter % COMPRESSION_REPORT_INTERVAL == 0)
+        {
+            INF << "stream " << done.frame.get_profile().stream_name() << "\tcompression " << st.m_avgCompressionTime << " ms\tlatency " << st.m_avgProcessingTime
+                << " ms\tratio " << (double)st.m_decompressedSizeSum / std::max(1ll, st.m_compressedSizeSum) << "\tskipped " << st.m_droppedFrameCounter;
+        }
+    }
+}
@@ -0,0 +1,74 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#pragma once
+
+#include "compression/ICompression.h"
+#include <ipDeviceCommon/MemoryPool.h>
+#include <ipDeviceCommon/Statistic.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define COMPRESSION_QUEUE_SIZE 4         // frames waiting for a worker, per stream
+#define COMPRESSION_REPORT_INTERVAL 300  // frames between latency reports
+
+// Which frame a full queue skips
+enum class SkipPolicy
+{
+    dropOldest, // the longest waiting, so the freshest frames go out
+    dropNewest, // the one arriving
+};
+
+// Compresses the frames of one stream on a few workers, each with its own compressor, and puts them
+// on the stream's queue in the order they came. Frames the workers cannot keep up with are skipped
+// rather than held up in the sensor callback
+class RsCompressionStage
+{
+public:
+    RsCompressionStage(std::vector<std::shared_ptr<ICompression>> t_compressors, rs2::frame_queue t_output, MemoryPool* t_memPool, StreamStatistic* t_statistic, int t_queueSize = COMPRESSION_QUEUE_SIZE, SkipPolicy t_policy = SkipPolicy::dropOldest);
+    ~RsCompressionStage();
+
+    // From the sensor callback, never waiting for a worker
+    void push(rs2::frame t_frame);
+
+    // Waits for the workers, dropping the frames not yet compressed
+    void stop();
+
+    // Workers per compressed stream, set from the command line
+    static unsigned int& getWorkersPerStream()
+    {
+        static unsigned int m_workersPerStream = 2;
+        return m_workersPerStream;
+    }
+
+private:
+    struct Pending
+    {
+        rs2::frame frame;
+        std::chrono::high_resolution_clock::time_point arrival;
+    };
+
+    void workerLoop(std::shared_ptr<ICompression> t_compressor);
+    void complete(long long t_seq, rs2::frame t_frame, std::chrono::high_resolution_clock::time_point t_arrival, std::chrono::duration<double> t_compressionTime, int t_compressedSize);
+
+    rs2::frame_queue m_output;
+    MemoryPool* m_memPool;
+    StreamStatistic* m_statistic;
+    const size_t m_queueSize;
+    const SkipPolicy m_policy;
+
+    std::mutex m_mutex;
+    std::condition_variable m_frameReady;
+    std::deque<Pending> m_queue;
+    std::map<long long, Pending> m_done; // compressed ahead of an earlier frame, with no frame when compression failed
+    long long m_nextSeq = 0, m_nextOut = 0;
+    bool m_stopping = false;
+    std::vector<std::thread> m_workers;
+};
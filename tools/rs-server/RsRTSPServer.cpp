@@ -143,6 +143,38 @@ void RsRTSPServer::RsRTSPClientConnection::handleCmd_SET_PARAMETER(char const* t
     setRTSPResponse("500 Invalid Option");
 }
 
+// The network protocol version in the User-Agent of a request, 0 for clients from before there was one
+int getClientProtocolVersion(const std::string& t_request)
+{
+    auto agent = t_request.find("User-Agent:");
+    if(agent == std::string::npos)
+    {
+        return 0;
+    }
+    auto line = t_request.substr(agent, t_request.find("\r\n", agent) - agent);
+    auto version = line.find(RS_NETWORK_PROTOCOL_AGENT);
+    if(version == std::string::npos)
+    {
+        return 0;
+    }
+    return atoi(line.c_str() + version + RS_NETWORK_PROTOCOL_AGENT.size());
+}
+
+void RsRTSPServer::RsRTSPClientConnection::handleCmd_DESCRIBE(char const* t_urlPreSuffix, char const* t_urlSuffix, char const* t_fullRequestStr)
+{
+    // Refused before it sees any stream, rather than misreading the frames it would get
+    int version = getClientProtocolVersion(t_fullRequestStr);
+    if(version != RS_NETWORK_PROTOCOL_VERSION)
+    {
+        envir() << "DESCRIBE: refused a client of network protocol " << version << ", this server speaks " << RS_NETWORK_PROTOCOL_VERSION << "\n";
+        std::string error("400 Network protocol " + std::to_string(version) + " is not supported, rs-server speaks " + std::to_string(RS_NETWORK_PROTOCOL_VERSION) +
+                          "; use the same librealsense version on both ends");
+        setRTSPResponse(error.c_str());
+        return;
+    }
+    RTSPClientConnection::handleCmd_DESCRIBE(t_urlPreSuffix, t_urlSuffix, t_fullRequestStr);
+}
+
 // RsRTSPServer::RsRTSPClientSession implementation
 
 RsRTSPServer::RsRTSPClientSession ::RsRTSPClientSession(RTSPServer& t_ourServer, u_int32_t t_sessionId)
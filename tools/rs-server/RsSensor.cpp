@@ -6,6 +6,7 @@
 #include "compression/CompressionFactory.h"
 #include "string.h"
 #include <BasicUsageEnvironment.hh>
+#include <algorithm>
 #include <iostream>
 #include <math.h>
 #include <thread>
@@ -38,10 +39,18 @@ int RsSensor::open(std::unordered_map<long long int, rs2::frame_queue>& t_stream
         if(CompressionFactory::isCompressionSupported(m_streamProfiles.at(streamProfileKey).format(), m_streamProfiles.at(streamProfileKey).stream_type()))
         {
             rs2::video_stream_profile vsp = m_streamProfiles.at(streamProfileKey);
-            std::shared_ptr<ICompression> compressPtr = CompressionFactory::getObject(vsp.width(), vsp.height(), vsp.format(), vsp.stream_type(), RsSensor::getStreamProfileBpp(vsp.format()));
-            if(compressPtr != nullptr)
+            std::vector<std::shared_ptr<ICompression>> compressors;
+            for(unsigned int i = 0; i < std::max(1u, RsCompressionStage::getWorkersPerStream()); i++)
             {
-                m_iCompress.insert(std::pair<long long int, std::shared_ptr<ICompression>>(streamProfileKey, compressPtr));
+                std::shared_ptr<ICompression> compressPtr = CompressionFactory::getObject(vsp.width(), vsp.height(), vsp.format(), vsp.stream_type(), RsSensor::getStreamProfileBpp(vsp.format()));
+                if(compressPtr != nullptr)
+                {
+                    compressors.push_back(compressPtr);
+                }
+            }
+            if(!compressors.empty())
+            {
+                m_iCompress[streamProfileKey] = compressors;
             }
         }
         else
@@ -62,11 +71,31 @@ int RsSensor::close()
 int RsSensor::stop()
 {
     m_sensor.stop();
+    for(auto& stage : m_compressionStages)
+    {
+        stage.second->stop();
+    }
+    m_compressionStages.clear();
     return EXIT_SUCCESS;
 }
 
 int RsSensor::start(std::unordered_map<long long int, rs2::frame_queue>& t_streamProfilesQueues)
 {
+    for(auto& compressors : m_iCompress)
+    {
+        long long int profileKey = compressors.first;
+        if(t_streamProfilesQueues.find(profileKey) == t_streamProfilesQueues.end())
+        {
+            continue;
+        }
+        auto& statistic = Statistic::getStatisticStreams()[m_streamProfiles.at(profileKey).unique_id()];
+        if(statistic == nullptr)
+        {
+            statistic = new StreamStatistic();
+        }
+        m_compressionStages[profileKey] = std::make_shared<RsCompressionStage>(compressors.second, t_streamProfilesQueues[profileKey], m_memPool, statistic);
+    }
+
     auto callback = [&](const rs2::frame& frame) {
         long long int profileKey = getStreamProfileKey(frame.get_profile());
         //check if profile exists in map:
@@ -74,20 +103,17 @@ int RsSensor::start(std::unordered_map<long long int, rs2::frame_queue>& t_strea
         {
             std::chrono::high_resolution_clock::time_point curSample = std::chrono::high_resolution_clock::now();
             std::chrono::duration<double> timeSpan = std::chrono::duration_cast<std::chrono::duration<double>>(curSample - m_prevSample[profileKey]);
-            if(CompressionFactory::isCompressionSupported(frame.get_profile().format(), frame.get_profile().stream_type()))
+            auto stage = m_compressionStages.find(profileKey);
+            if(stage != m_compressionStages.end())
             {
-                unsigned char* buff = m_memPool->getNextMem();
-                int frameSize = m_iCompress.at(profileKey)->compressBuffer((unsigned char*)frame.get_data(), frame.get_data_size(), buff);
-                if(frameSize == -1)
-                {
-                    m_memPool->returnMem(buff);
-                    return;
-                }
-                memcpy((unsigned char*)frame.get_data(), buff, frameSize);
-                m_memPool->returnMem(buff);
+                //compressed on the stream's workers, which queue it in order
+                stage->second->push(frame);
+            }
+            else
+            {
+                //push frame to its queue
+                t_streamProfilesQueues[profileKey].enqueue(frame);
             }
-            //push frame to its queue
-            t_streamProfilesQueues[profileKey].enqueue(frame);
             m_prevSample[profileKey] = curSample;
         }
     };
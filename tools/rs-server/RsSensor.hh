@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include "RsCompressionStage.hh"
 #include "compression/ICompression.h"
 #include <chrono>
 #include <ipDeviceCommon/MemoryPool.h>
@@ -45,7 +46,9 @@ private:
     UsageEnvironment* env;
     rs2::sensor m_sensor;
     std::unordered_map<long long int, rs2::video_stream_profile> m_streamProfiles;
-    std::unordered_map<long long int, std::shared_ptr<ICompression>> m_iCompress;
+    // a compressor per worker of each compressed stream, and the stages running them while streaming
+    std::unordered_map<long long int, std::vector<std::shared_ptr<ICompression>>> m_iCompress;
+    std::unordered_map<long long int, std::shared_ptr<RsCompressionStage>> m_compressionStages;
     rs2::device m_device;
     MemoryPool* m_memPool;
     std::unordered_map<long long int, std::chrono::high_resolution_clock::time_point> m_prevSample;
@@ -42,10 +42,12 @@ struct server
         SwitchArg arg_enable_compression("c", "enable-compression", "Enable video compression");
         ValueArg<std::string> arg_address("i", "interface-address", "Address of the interface to bind on", false, "", "string");
         ValueArg<unsigned int> arg_port("p", "port", "RTSP port to listen on", false, 8554, "integer");
+        ValueArg<unsigned int> arg_workers("w", "compression-workers", "Threads compressing each stream", false, RsCompressionStage::getWorkersPerStream(), "integer");
 
         cmd.add(arg_enable_compression);
         cmd.add(arg_address);
         cmd.add(arg_port);
+        cmd.add(arg_workers);
 
         cmd.parse(argc, argv);
 
@@ -64,6 +66,11 @@ struct server
         {
             port = arg_port.getValue();
         }
+
+        if (arg_workers.isSet())
+        {
+            RsCompressionStage::getWorkersPerStream() = arg_workers.getValue();
+        }
         
         OutPacketBuffer::increaseMaxSizeTo(MAX_MESSAGE_SIZE);
         
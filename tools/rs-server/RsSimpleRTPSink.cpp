@@ -5,6 +5,7 @@
 #include "RsDevice.hh"
 #include <algorithm>
 #include <compression/CompressionFactory.h>
+#include <ipDeviceCommon/RsCommon.h>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -99,6 +100,7 @@ std::string getSdpLineForVideoStream(rs2::video_stream_profile& t_videoStream, s
     str.append(getSdpLineForField("cam_serial_num", device.get()->getDevice().get_info(RS2_CAMERA_INFO_SERIAL_NUMBER)));
     str.append(getSdpLineForField("usb_type", device.get()->getDevice().get_info(RS2_CAMERA_INFO_USB_TYPE_DESCRIPTOR)));
     str.append(getSdpLineForField("compression", CompressionFactory::getIsEnabled()));
+    str.append(getSdpLineForField("protocol", RS_NETWORK_PROTOCOL_VERSION));
 
     str.append(getSdpLineForField("ppx", t_videoStream.get_intrinsics().ppx));
     str.append(getSdpLineForField("ppy", t_videoStream.get_intrinsics().ppy));
@@ -0,0 +1,553 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "catch/catch.hpp"
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "./../include/librealsense2/rsutil.h"
+#include "./../src/proc/sse/sse-align.h"
+
+#ifdef __SSSE3__
+
+#include <tmmintrin.h>
+
+using namespace librealsense;
+
+namespace
+{
+    rs2_intrinsics make_intrinsics(int width, int height, float fov_x, rs2_distortion model)
+    {
+        rs2_intrinsics intrin = {};
+        intrin.width = width;
+        intrin.height = height;
+        intrin.fx = intrin.fy = width / 2 / std::tan(fov_x / 2);
+        intrin.ppx = width / 2.f + 0.3f;
+        intrin.ppy = height / 2.f - 0.7f;
+        intrin.model = model;
+        if (model != RS2_DISTORTION_NONE)
+        {
+            const float coeffs[] = { -0.055f, 0.065f, 0.0004f, 0.0006f, -0.02f };
+            std::copy(std::begin(coeffs), std::end(coeffs), intrin.coeffs);
+        }
+        return intrin;
+    }
+
+    // A slightly turned camera 15mm to the side
+    rs2_extrinsics make_extrinsics()
+    {
+        const float a = 0.01f;
+        rs2_extrinsics extrin = { { std::cos(a), 0, -std::sin(a), 0, 1, 0, std::sin(a), 0, std::cos(a) }, { 0.015f, 0.0002f, 0.0001f } };
+        return extrin;
+    }
+
+    // A slanted wall with a box in front of it, noise and holes, in millimeters
+    std::vector<uint16_t> make_depth(int width, int height, unsigned int seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> noise(-4, 4);
+        std::uniform_real_distribution<float> unit(0, 1);
+        std::vector<uint16_t> depth(width * height);
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                int z = 1500 + x * 600 / width + noise(rng);
+                if (x > width / 3 && x < width / 2 && y > height / 4 && y < height * 3 / 4)
+                    z = 700 + noise(rng);
+                if (unit(rng) < 0.05f || x < 40)
+                    z = 0;
+                depth[y * width + x] = static_cast<uint16_t>(z);
+            }
+        }
+        return depth;
+    }
+
+    struct setup
+    {
+        const char* name;
+        rs2_intrinsics depth, other;
+    };
+
+    const float depth_fov = 1.5f, color_fov = 1.2f;
+    const setup setups[] = {
+        { "1280x720 to 1920x1080", make_intrinsics(1280, 720, depth_fov, RS2_DISTORTION_BROWN_CONRADY), make_intrinsics(1920, 1080, color_fov, RS2_DISTORTION_MODIFIED_BROWN_CONRADY) },
+        { "848x480 to 1280x720", make_intrinsics(848, 480, depth_fov, RS2_DISTORTION_BROWN_CONRADY), make_intrinsics(1280, 720, color_fov, RS2_DISTORTION_NONE) },
+        { "640x480 to 424x240", make_intrinsics(640, 480, depth_fov, RS2_DISTORTION_BROWN_CONRADY), make_intrinsics(424, 240, color_fov, RS2_DISTORTION_MODIFIED_BROWN_CONRADY) },
+        { "90x61 to 101x47", make_intrinsics(90, 61, depth_fov, RS2_DISTORTION_INVERSE_BROWN_CONRADY), make_intrinsics(101, 47, color_fov, RS2_DISTORTION_MODIFIED_BROWN_CONRADY) },
+    };
+
+    std::vector<uint16_t> depth_to_other(const setup& s, const std::vector<uint16_t>& depth, unsigned int workers)
+    {
+        image_transform transform(s.depth, 0.001f);
+        transform.pre_compute_x_y_map_corners();
+        std::vector<uint16_t> aligned(s.other.width * s.other.height, 0);
+        transform.align_depth_to_other(depth.data(), aligned.data(), 2, s.depth, s.other, make_extrinsics(), workers);
+        return aligned;
+    }
+
+    std::vector<uint8_t> other_to_depth(const setup& s, const std::vector<uint16_t>& depth, const std::vector<uint8_t>& other, unsigned int workers)
+    {
+        image_transform transform(s.depth, 0.001f);
+        transform.pre_compute_x_y_map_corners();
+        std::vector<uint8_t> aligned(s.depth.width * s.depth.height * 3, 0);
+        transform.align_other_to_depth(depth.data(), other.data(), aligned.data(), 3, s.other, make_extrinsics(), workers);
+        return aligned;
+    }
+
+    // The SSE align as it was before the projection moved to the image-simd kernels and the frame to
+    // bands on the pool, kept as the reference the new one is checked against. Its 8-pixel loop runs
+    // past the end of frames whose size is not a multiple of 8, so its buffers are padded here
+    class legacy_image_transform
+    {
+    public:
+        legacy_image_transform(const rs2_intrinsics& from, float depth_scale)
+            : _depth(from), _depth_scale(depth_scale),
+            _pixel_top_left_int(padded(from)), _pixel_bottom_right_int(padded(from))
+        {
+            pre_compute_x_y_map(_pre_compute_map_x_top_left, _pre_compute_map_y_top_left, -0.5f);
+            pre_compute_x_y_map(_pre_compute_map_x_bottom_right, _pre_compute_map_y_bottom_right, 0.5f);
+        }
+
+        void align_depth_to_other(const uint16_t* z_pixels, uint16_t* dest, const rs2_intrinsics& to, const rs2_extrinsics& from_to_other)
+        {
+            if (to.model == RS2_DISTORTION_MODIFIED_BROWN_CONRADY)
+                align_depth_to_other_sse<RS2_DISTORTION_MODIFIED_BROWN_CONRADY>(z_pixels, dest, to, from_to_other);
+            else
+                align_depth_to_other_sse<RS2_DISTORTION_NONE>(z_pixels, dest, to, from_to_other);
+        }
+
+        template<class T>
+        void align_other_to_depth(const uint16_t* z_pixels, const T* source, T* dest, const rs2_intrinsics& to, const rs2_extrinsics& from_to_other)
+        {
+            if (to.model == RS2_DISTORTION_MODIFIED_BROWN_CONRADY || to.model == RS2_DISTORTION_INVERSE_BROWN_CONRADY)
+                align_other_to_depth_sse<RS2_DISTORTION_MODIFIED_BROWN_CONRADY>(z_pixels, source, dest, to, from_to_other);
+            else
+                align_other_to_depth_sse<RS2_DISTORTION_NONE>(z_pixels, source, dest, to, from_to_other);
+        }
+
+    private:
+        static size_t padded(const rs2_intrinsics& intrin)
+        {
+            return (intrin.width * intrin.height + 7) / 8 * 8;
+        }
+
+        void pre_compute_x_y_map(std::vector<float>& pre_compute_map_x, std::vector<float>& pre_compute_map_y, float offset)
+        {
+            pre_compute_map_x.resize(padded(_depth));
+            pre_compute_map_y.resize(padded(_depth));
+
+            for (int h = 0; h < _depth.height; ++h)
+            {
+                for (int w = 0; w < _depth.width; ++w)
+                {
+                    const float pixel[] = { (float)w + offset, (float)h + offset };
+
+                    float x = (pixel[0] - _depth.ppx) / _depth.fx;
+                    float y = (pixel[1] - _depth.ppy) / _depth.fy;
+
+                    if (_depth.model == RS2_DISTORTION_INVERSE_BROWN_CONRADY)
+                    {
+                        float r2 = x * x + y * y;
+                        float f = 1 + _depth.coeffs[0] * r2 + _depth.coeffs[1] * r2*r2 + _depth.coeffs[4] * r2*r2*r2;
+                        float ux = x * f + 2 * _depth.coeffs[2] * x*y + _depth.coeffs[3] * (r2 + 2 * x*x);
+                        float uy = y * f + 2 * _depth.coeffs[3] * x*y + _depth.coeffs[2] * (r2 + 2 * y*y);
+                        x = ux;
+                        y = uy;
+                    }
+
+                    pre_compute_map_x[h*_depth.width + w] = x;
+                    pre_compute_map_y[h*_depth.width + w] = y;
+                }
+            }
+        }
+
+        template<rs2_distortion dist>
+        static void distorte_x_y(const __m128& x, const __m128& y, __m128* distorted_x, __m128* distorted_y, const rs2_intrinsics& to)
+        {
+            if (dist != RS2_DISTORTION_MODIFIED_BROWN_CONRADY)
+            {
+                *distorted_x = x;
+                *distorted_y = y;
+                return;
+            }
+
+            __m128 c[5];
+            auto one = _mm_set_ps1(1);
+            auto two = _mm_set_ps1(2);
+
+            for (int i = 0; i < 5; ++i)
+            {
+                c[i] = _mm_set_ps1(to.coeffs[i]);
+            }
+            auto r2_0 = _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y));
+            auto r3_0 = _mm_add_ps(_mm_mul_ps(c[1], _mm_mul_ps(r2_0, r2_0)), _mm_mul_ps(c[4], _mm_mul_ps(r2_0, _mm_mul_ps(r2_0, r2_0))));
+            auto f_0 = _mm_add_ps(one, _mm_add_ps(_mm_mul_ps(c[0], r2_0), r3_0));
+
+            auto x_f0 = _mm_mul_ps(x, f_0);
+            auto y_f0 = _mm_mul_ps(y, f_0);
+
+            auto r4_0 = _mm_mul_ps(c[3], _mm_add_ps(r2_0, _mm_mul_ps(two, _mm_mul_ps(x_f0, x_f0))));
+            auto d_x0 = _mm_add_ps(x_f0, _mm_add_ps(_mm_mul_ps(two, _mm_mul_ps(c[2], _mm_mul_ps(x_f0, y_f0))), r4_0));
+
+            auto r5_0 = _mm_mul_ps(c[2], _mm_add_ps(r2_0, _mm_mul_ps(two, _mm_mul_ps(y_f0, y_f0))));
+            auto d_y0 = _mm_add_ps(y_f0, _mm_add_ps(_mm_mul_ps(two, _mm_mul_ps(c[3], _mm_mul_ps(x_f0, y_f0))), r4_0));
+
+            *distorted_x = d_x0;
+            *distorted_y = d_y0;
+        }
+
+        template<rs2_distortion dist>
+        void get_texture_map_sse(const uint16_t* depth, const float* pre_compute_x, const float* pre_compute_y,
+            std::vector<int2>& pixels, const rs2_intrinsics& to, const rs2_extrinsics& from_to_other)
+        {
+            //mask for shuffle
+            const __m128i mask0 = _mm_set_epi8((char)0xff, (char)0xff, (char)7, (char)6, (char)0xff, (char)0xff, (char)5, (char)4,
+                (char)0xff, (char)0xff, (char)3, (char)2, (char)0xff, (char)0xff, (char)1, (char)0);
+            const __m128i mask1 = _mm_set_epi8((char)0xff, (char)0xff, (char)15, (char)14, (char)0xff, (char)0xff, (char)13, (char)12,
+                (char)0xff, (char)0xff, (char)11, (char)10, (char)0xff, (char)0xff, (char)9, (char)8);
+
+            auto scale = _mm_set_ps1(_depth_scale);
+
+            // The depth is read a padded copy at a time, as the loop runs past the frame
+            std::vector<uint16_t> padded_depth(depth, depth + _depth.width * _depth.height);
+            padded_depth.resize(padded(_depth));
+
+            auto mapx = pre_compute_x;
+            auto mapy = pre_compute_y;
+
+            auto res = reinterpret_cast<__m128i*>(pixels.data());
+
+            __m128 r[9];
+            __m128 t[3];
+
+            for (int i = 0; i < 9; ++i)
+            {
+                r[i] = _mm_set_ps1(from_to_other.rotation[i]);
+            }
+            for (int i = 0; i < 3; ++i)
+            {
+                t[i] = _mm_set_ps1(from_to_other.translation[i]);
+            }
+            auto zero = _mm_set_ps1(0);
+            auto fx = _mm_set_ps1(to.fx);
+            auto fy = _mm_set_ps1(to.fy);
+            auto ppx = _mm_set_ps1(to.ppx);
+            auto ppy = _mm_set_ps1(to.ppy);
+
+            for (size_t i = 0; i < padded_depth.size(); i += 8)
+            {
+                auto x0 = _mm_loadu_ps(mapx + i);
+                auto x1 = _mm_loadu_ps(mapx + i + 4);
+
+                auto y0 = _mm_loadu_ps(mapy + i);
+                auto y1 = _mm_loadu_ps(mapy + i + 4);
+
+                __m128i d = _mm_loadu_si128((__m128i const*)(padded_depth.data() + i));
+
+                //split the depth pixel to 2 registers of 4 floats each
+                __m128i d0 = _mm_shuffle_epi8(d, mask0);
+                __m128i d1 = _mm_shuffle_epi8(d, mask1);
+
+                __m128 depth0 = _mm_cvtepi32_ps(d0); //convert depth to float
+                __m128 depth1 = _mm_cvtepi32_ps(d1); //convert depth to float
+
+                depth0 = _mm_mul_ps(depth0, scale);
+                depth1 = _mm_mul_ps(depth1, scale);
+
+                auto p0x = _mm_mul_ps(depth0, x0);
+                auto p0y = _mm_mul_ps(depth0, y0);
+
+                auto p1x = _mm_mul_ps(depth1, x1);
+                auto p1y = _mm_mul_ps(depth1, y1);
+
+                auto p_x0 = _mm_add_ps(_mm_mul_ps(r[0], p0x), _mm_add_ps(_mm_mul_ps(r[3], p0y), _mm_add_ps(_mm_mul_ps(r[6], depth0), t[0])));
+                auto p_y0 = _mm_add_ps(_mm_mul_ps(r[1], p0x), _mm_add_ps(_mm_mul_ps(r[4], p0y), _mm_add_ps(_mm_mul_ps(r[7], depth0), t[1])));
+                auto p_z0 = _mm_add_ps(_mm_mul_ps(r[2], p0x), _mm_add_ps(_mm_mul_ps(r[5], p0y), _mm_add_ps(_mm_mul_ps(r[8], depth0), t[2])));
+
+                auto p_x1 = _mm_add_ps(_mm_mul_ps(r[0], p1x), _mm_add_ps(_mm_mul_ps(r[3], p1y), _mm_add_ps(_mm_mul_ps(r[6], depth1), t[0])));
+                auto p_y1 = _mm_add_ps(_mm_mul_ps(r[1], p1x), _mm_add_ps(_mm_mul_ps(r[4], p1y), _mm_add_ps(_mm_mul_ps(r[7], depth1), t[1])));
+                auto p_z1 = _mm_add_ps(_mm_mul_ps(r[2], p1x), _mm_add_ps(_mm_mul_ps(r[5], p1y), _mm_add_ps(_mm_mul_ps(r[8], depth1), t[2])));
+
+                p_x0 = _mm_div_ps(p_x0, p_z0);
+                p_y0 = _mm_div_ps(p_y0, p_z0);
+
+                p_x1 = _mm_div_ps(p_x1, p_z1);
+                p_y1 = _mm_div_ps(p_y1, p_z1);
+
+                distorte_x_y<dist>(p_x0, p_y0, &p_x0, &p_y0, to);
+                distorte_x_y<dist>(p_x1, p_y1, &p_x1, &p_y1, to);
+
+                //zero the x and y if z is zero
+                auto cmp = _mm_cmpneq_ps(depth0, zero);
+                p_x0 = _mm_and_ps(_mm_add_ps(_mm_mul_ps(p_x0, fx), ppx), cmp);
+                p_y0 = _mm_and_ps(_mm_add_ps(_mm_mul_ps(p_y0, fy), ppy), cmp);
+
+                p_x1 = _mm_add_ps(_mm_mul_ps(p_x1, fx), ppx);
+                p_y1 = _mm_add_ps(_mm_mul_ps(p_y1, fy), ppy);
+
+                cmp = _mm_cmpneq_ps(depth0, zero);
+                auto half = _mm_set_ps1(0.5);
+                auto u_round0 = _mm_and_ps(_mm_add_ps(p_x0, half), cmp);
+                auto v_round0 = _mm_and_ps(_mm_add_ps(p_y0, half), cmp);
+
+                auto uuvv1_0 = _mm_shuffle_ps(u_round0, v_round0, _MM_SHUFFLE(1, 0, 1, 0));
+                auto uuvv2_0 = _mm_shuffle_ps(u_round0, v_round0, _MM_SHUFFLE(3, 2, 3, 2));
+
+                auto res1_0 = _mm_shuffle_ps(uuvv1_0, uuvv1_0, _MM_SHUFFLE(3, 1, 2, 0));
+                auto res2_0 = _mm_shuffle_ps(uuvv2_0, uuvv2_0, _MM_SHUFFLE(3, 1, 2, 0));
+
+                _mm_storeu_si128(&res[0], _mm_cvtps_epi32(res1_0));
+                _mm_storeu_si128(&res[1], _mm_cvtps_epi32(res2_0));
+                res += 2;
+
+                cmp = _mm_cmpneq_ps(depth1, zero);
+                auto u_round1 = _mm_and_ps(_mm_add_ps(p_x1, half), cmp);
+                auto v_round1 = _mm_and_ps(_mm_add_ps(p_y1, half), cmp);
+
+                auto uuvv1_1 = _mm_shuffle_ps(u_round1, v_round1, _MM_SHUFFLE(1, 0, 1, 0));
+                auto uuvv2_1 = _mm_shuffle_ps(u_round1, v_round1, _MM_SHUFFLE(3, 2, 3, 2));
+
+                auto res1 = _mm_shuffle_ps(uuvv1_1, uuvv1_1, _MM_SHUFFLE(3, 1, 2, 0));
+                auto res2 = _mm_shuffle_ps(uuvv2_1, uuvv2_1, _MM_SHUFFLE(3, 1, 2, 0));
+
+                _mm_storeu_si128(&res[0], _mm_cvtps_epi32(res1));
+                _mm_storeu_si128(&res[1], _mm_cvtps_epi32(res2));
+                res += 2;
+            }
+        }
+
+        static bool is_special_resolution(const rs2_intrinsics& depth, const rs2_intrinsics& to)
+        {
+            return (depth.width == 640 && depth.height == 240 && to.width == 320 && to.height == 180) ||
+                (depth.width == 640 && depth.height == 480 && to.width == 640 && to.height == 360);
+        }
+
+        template<rs2_distortion dist>
+        void align_depth_to_other_sse(const uint16_t* z_pixels, uint16_t* dest, const rs2_intrinsics& to, const rs2_extrinsics& from_to_other)
+        {
+            get_texture_map_sse<dist>(z_pixels, _pre_compute_map_x_top_left.data(), _pre_compute_map_y_top_left.data(), _pixel_top_left_int, to, from_to_other);
+
+            float fov[2];
+            rs2_fov(&_depth, fov);
+            float2 pixels_per_angle_depth = { (float)_depth.width / fov[0], (float)_depth.height / fov[1] };
+
+            rs2_fov(&to, fov);
+            float2 pixels_per_angle_target = { (float)to.width / fov[0], (float)to.height / fov[1] };
+
+            if (pixels_per_angle_depth.x < pixels_per_angle_target.x || pixels_per_angle_depth.y < pixels_per_angle_target.y || is_special_resolution(_depth, to))
+            {
+                get_texture_map_sse<dist>(z_pixels, _pre_compute_map_x_bottom_right.data(), _pre_compute_map_y_bottom_right.data(), _pixel_bottom_right_int, to, from_to_other);
+                move_depth_to_other(z_pixels, dest, to, _pixel_top_left_int, _pixel_bottom_right_int);
+            }
+            else
+            {
+                move_depth_to_other(z_pixels, dest, to, _pixel_top_left_int, _pixel_top_left_int);
+            }
+        }
+
+        void move_depth_to_other(const uint16_t* z_pixels, uint16_t* dest, const rs2_intrinsics& to,
+            const std::vector<int2>& pixel_top_left_int, const std::vector<int2>& pixel_bottom_right_int)
+        {
+            for (int y = 0; y < _depth.height; ++y)
+            {
+                for (int x = 0; x < _depth.width; ++x)
+                {
+                    auto depth_pixel_index = y * _depth.width + x;
+                    if (z_pixels[depth_pixel_index])
+                    {
+                        for (int other_y = pixel_top_left_int[depth_pixel_index].y; other_y <= pixel_bottom_right_int[depth_pixel_index].y; ++other_y)
+                        {
+                            for (int other_x = pixel_top_left_int[depth_pixel_index].x; other_x <= pixel_bottom_right_int[depth_pixel_index].x; ++other_x)
+                            {
+                                if (other_x < 0 || other_y < 0 || other_x >= to.width || other_y >= to.height)
+                                    continue;
+                                auto other_ind = other_y * to.width + other_x;
+
+                                dest[other_ind] = dest[other_ind] ? std::min(dest[other_ind], z_pixels[depth_pixel_index]) : z_pixels[depth_pixel_index];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        template<rs2_distortion dist, class T>
+        void align_other_to_depth_sse(const uint16_t* z_pixels, const T* source, T* dest, const rs2_intrinsics& to, const rs2_extrinsics& from_to_other)
+        {
+            get_texture_map_sse<dist>(z_pixels, _pre_compute_map_x_top_left.data(), _pre_compute_map_y_top_left.data(), _pixel_top_left_int, to, from_to_other);
+
+            // As it was: the reference takes the bottom right corners in over the top left ones
+            std::vector<int2>& bottom_right = _pixel_top_left_int;
+            if (to.height < _depth.height && to.width < _depth.width)
+            {
+                get_texture_map_sse<dist>(z_pixels, _pre_compute_map_x_bottom_right.data(), _pre_compute_map_y_bottom_right.data(), _pixel_bottom_right_int, to, from_to_other);
+                bottom_right = _pixel_bottom_right_int;
+            }
+
+            for (int y = 0; y < _depth.height; ++y)
+            {
+                for (int x = 0; x < _depth.width; ++x)
+                {
+                    auto depth_pixel_index = y * _depth.width + x;
+                    if (z_pixels[depth_pixel_index])
+                    {
+                        for (int other_y = _pixel_top_left_int[depth_pixel_index].y; other_y <= bottom_right[depth_pixel_index].y; ++other_y)
+                        {
+                            for (int other_x = _pixel_top_left_int[depth_pixel_index].x; other_x <= bottom_right[depth_pixel_index].x; ++other_x)
+                            {
+                                if (other_x < 0 || other_y < 0 || other_x >= to.width || other_y >= to.height)
+                                    continue;
+                                auto other_ind = other_y * to.width + other_x;
+
+                                dest[depth_pixel_index] = source[other_ind];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        const rs2_intrinsics _depth;
+        float _depth_scale;
+
+        std::vector<float> _pre_compute_map_x_top_left;
+        std::vector<float> _pre_compute_map_y_top_left;
+        std::vector<float> _pre_compute_map_x_bottom_right;
+        std::vector<float> _pre_compute_map_y_bottom_right;
+
+        std::vector<int2> _pixel_top_left_int;
+        std::vector<int2> _pixel_bottom_right_int;
+    };
+
+    template<int N> struct pixel_bytes { uint8_t b[N]; };
+}
+
+TEST_CASE("align gives the frames of the SSE align it replaced", "[code]")
+{
+    for (auto&& s : setups)
+    {
+        CAPTURE(s.name);
+        auto depth = make_depth(s.depth.width, s.depth.height, 5);
+
+        std::vector<uint16_t> expected(s.other.width * s.other.height, 0);
+        legacy_image_transform(s.depth, 0.001f).align_depth_to_other(depth.data(), expected.data(), s.other, make_extrinsics());
+        for (unsigned int workers : { 1u, 4u })
+        {
+            CAPTURE(workers);
+            REQUIRE(depth_to_other(s, depth, workers) == expected);
+        }
+
+        std::vector<uint8_t> other(s.other.width * s.other.height * 3);
+        for (size_t i = 0; i < other.size(); i++)
+            other[i] = static_cast<uint8_t>(i * 7 + i / 3);
+        std::vector<uint8_t> expected_other(s.depth.width * s.depth.height * 3, 0);
+        legacy_image_transform(s.depth, 0.001f).align_other_to_depth(depth.data(), reinterpret_cast<const pixel_bytes<3>*>(other.data()),
+            reinterpret_cast<pixel_bytes<3>*>(expected_other.data()), s.other, make_extrinsics());
+        for (unsigned int workers : { 1u, 4u })
+        {
+            CAPTURE(workers);
+            REQUIRE(other_to_depth(s, depth, other, workers) == expected_other);
+        }
+    }
+}
+
+TEST_CASE("align gives the same frames split across threads", "[code]")
+{
+    for (auto&& s : setups)
+    {
+        CAPTURE(s.name);
+        auto depth = make_depth(s.depth.width, s.depth.height, 3);
+
+        auto expected = depth_to_other(s, depth, 1);
+        int written = 0;
+        for (auto z : expected)
+            written += z != 0;
+        REQUIRE(written > s.other.width * s.other.height / 4);
+
+        for (unsigned int workers : { 2u, 3u, 8u })
+        {
+            CAPTURE(workers);
+            REQUIRE(depth_to_other(s, depth, workers) == expected);
+        }
+
+        std::vector<uint8_t> other(s.other.width * s.other.height * 3);
+        for (size_t i = 0; i < other.size(); i++)
+            other[i] = static_cast<uint8_t>(i * 7 + i / 3);
+        auto expected_other = other_to_depth(s, depth, other, 1);
+        for (unsigned int workers : { 2u, 8u })
+        {
+            CAPTURE(workers);
+            REQUIRE(other_to_depth(s, depth, other, workers) == expected_other);
+        }
+    }
+}
+
+TEST_CASE("align keeps the nearest depth where pixels land together", "[code]")
+{
+    // Depth pixels are larger than color ones here, so the last row of one band and the first of
+    // the next, near the middle of the frame, cover a shared row of output pixels
+    auto s = setups[1];
+    std::vector<uint16_t> depth(s.depth.width * s.depth.height, 0);
+    const int near_row = image_transform::BAND_ROWS * 7, far_row = near_row - 1;
+    for (int x = 400; x < 500; x++)
+    {
+        depth[near_row * s.depth.width + x] = 800;
+        depth[far_row * s.depth.width + x] = 900;
+    }
+
+    // Each row on its own shows where it lands
+    auto alone = [&](int row, uint16_t z)
+    {
+        std::vector<uint16_t> one(depth.size(), 0);
+        for (int x = 400; x < 500; x++)
+            one[row * s.depth.width + x] = z;
+        return depth_to_other(s, one, 1);
+    };
+    auto near_alone = alone(near_row, 800);
+    auto far_alone = alone(far_row, 900);
+    int shared = 0;
+    for (size_t i = 0; i < near_alone.size(); i++)
+        shared += near_alone[i] && far_alone[i];
+    REQUIRE(shared > 50);
+
+    for (unsigned int workers : { 1u, 4u })
+    {
+        auto aligned = depth_to_other(s, depth, workers);
+        for (size_t i = 0; i < aligned.size(); i++)
+        {
+            uint16_t expected = near_alone[i] ? near_alone[i] : far_alone[i];
+            REQUIRE(aligned[i] == expected);
+        }
+    }
+}
+
+TEST_CASE("align benchmark", "[.][benchmark]")
+{
+    const int iterations = 20;
+    auto& s = setups[0];
+    auto depth = make_depth(s.depth.width, s.depth.height, 7);
+    std::vector<uint16_t> aligned(s.other.width * s.other.height);
+
+    std::cout << "Depth " << s.name << ", ms per frame, kernels " << get_string(get_unpack_kernels().level) << std::endl;
+    for (unsigned int workers : { 1u, 2u, 4u, 8u })
+    {
+        image_transform transform(s.depth, 0.001f);
+        transform.pre_compute_x_y_map_corners();
+        transform.align_depth_to_other(depth.data(), aligned.data(), 2, s.depth, s.other, make_extrinsics(), workers);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++)
+        {
+            std::fill(aligned.begin(), aligned.end(), 0);
+            transform.align_depth_to_other(depth.data(), aligned.data(), 2, s.depth, s.other, make_extrinsics(), workers);
+        }
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << std::setw(3) << workers << " threads " << std::setprecision(3) << elapsed / iterations << std::endl;
+    }
+}
+
+#endif
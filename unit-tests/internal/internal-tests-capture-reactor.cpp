@@ -0,0 +1,353 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#ifdef RS2_USE_V4L2_BACKEND
+
+#include "catch/catch.hpp"
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/select.h>
+#include <time.h>
+#include <unistd.h>
+#include "./../src/linux/capture-reactor.h"
+
+using namespace librealsense::platform;
+
+namespace
+{
+    // A node the kernel fills: frames are written to one end of a pipe and dequeued, as many as are
+    // ready, from the other
+    class mock_node
+    {
+    public:
+        mock_node()
+        {
+            REQUIRE(pipe2(_fds, O_NONBLOCK | O_CLOEXEC) == 0);
+        }
+
+        ~mock_node()
+        {
+            ::close(_fds[0]);
+            ::close(_fds[1]);
+        }
+
+        int fd() const { return _fds[0]; }
+
+        void fill(int64_t timestamp)
+        {
+            REQUIRE(write(_fds[1], &timestamp, sizeof(timestamp)) == sizeof(timestamp));
+        }
+
+        // The timestamp of the next frame, or -1 once none is ready
+        int64_t dequeue()
+        {
+            int64_t timestamp;
+            return read(_fds[0], &timestamp, sizeof(timestamp)) == sizeof(timestamp) ? timestamp : -1;
+        }
+
+    private:
+        int _fds[2];
+    };
+
+    int64_t now_ns()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+TEST_CASE("capture reactor serves each node on one thread at a time", "[capture-reactor]")
+{
+    const int nodes = 6, frames = 2000;
+    std::vector<std::unique_ptr<mock_node>> mocks;
+    std::vector<std::atomic<int>> dequeued(nodes), serving(nodes);
+    std::atomic<int> overlaps(0);
+
+    capture_reactor reactor(3);
+    REQUIRE(reactor.threads() == 3);
+    for (int i = 0; i < nodes; i++)
+    {
+        mocks.emplace_back(new mock_node());
+        dequeued[i] = 0;
+        serving[i] = 0;
+        reactor.add(mocks[i]->fd(), [&, i]()
+        {
+            if (serving[i]++)
+                overlaps++;
+            while (mocks[i]->dequeue() >= 0)
+                dequeued[i]++;
+            serving[i]--;
+        }, []() {}, std::chrono::milliseconds(5000));
+    }
+
+    std::vector<std::thread> cameras;
+    for (int i = 0; i < nodes; i++)
+    {
+        cameras.emplace_back([&, i]()
+        {
+            for (int f = 0; f < frames; f++)
+                mocks[i]->fill(f);
+        });
+    }
+    for (auto&& c : cameras)
+        c.join();
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    for (int i = 0; i < nodes; i++)
+    {
+        while (dequeued[i] < frames && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        REQUIRE(dequeued[i] == frames);
+    }
+    REQUIRE(overlaps == 0);
+
+    for (int i = 0; i < nodes; i++)
+        reactor.remove(mocks[i]->fd());
+}
+
+TEST_CASE("capture reactor serves other nodes while a handler is held", "[capture-reactor]")
+{
+    // A frame callback that does not return, on a reactor started with a single thread
+    const int nodes = 3;
+    std::vector<std::unique_ptr<mock_node>> mocks;
+    std::atomic<int> dequeued(0);
+    std::atomic<bool> held(false), release(false);
+
+    capture_reactor reactor(1);
+    for (int i = 0; i < nodes; i++)
+    {
+        mocks.emplace_back(new mock_node());
+        auto node = mocks.back().get();
+        reactor.add(node->fd(), [&, i, node]()
+        {
+            while (node->dequeue() >= 0)
+            {
+                if (i == 0)
+                {
+                    held = true;
+                    while (!release)
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                else
+                    dequeued++;
+            }
+        }, []() {}, std::chrono::milliseconds(5000));
+    }
+    REQUIRE(reactor.threads() == nodes);
+
+    mocks[0]->fill(0);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!held && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    REQUIRE(held);
+
+    for (int f = 0; f < 100; f++)
+    {
+        mocks[1]->fill(f);
+        mocks[2]->fill(f);
+    }
+    while (dequeued < 200 && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    release = true;
+    REQUIRE(dequeued == 200);
+
+    for (auto&& m : mocks)
+        reactor.remove(m->fd());
+}
+
+TEST_CASE("capture reactor times out nodes with no frames", "[capture-reactor]")
+{
+    mock_node node;
+    std::atomic<int> timeouts(0), dequeued(0);
+    capture_reactor reactor(2);
+    reactor.add(node.fd(), [&]() { while (node.dequeue() >= 0) dequeued++; }, [&]() { timeouts++; }, std::chrono::milliseconds(50));
+
+    // Once per timeout while nothing comes
+    std::this_thread::sleep_for(std::chrono::milliseconds(280));
+    CAPTURE(timeouts.load());
+    REQUIRE(timeouts >= 3);
+    REQUIRE(timeouts <= 6);
+
+    // Not while frames come
+    auto before = timeouts.load();
+    for (int i = 0; i < 20; i++)
+    {
+        node.fill(i);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    REQUIRE(dequeued == 20);
+    REQUIRE(timeouts == before);
+
+    reactor.remove(node.fd());
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    REQUIRE(timeouts == before);
+}
+
+TEST_CASE("capture reactor removes nodes once their handlers return", "[capture-reactor]")
+{
+    capture_reactor reactor(2);
+
+    // From another thread, it waits for the handler
+    mock_node slow;
+    std::atomic<bool> entered(false), left(false);
+    reactor.add(slow.fd(), [&]()
+    {
+        entered = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        while (slow.dequeue() >= 0) {}
+        left = true;
+    }, []() {}, std::chrono::milliseconds(5000));
+    slow.fill(0);
+    while (!entered)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    reactor.remove(slow.fd());
+    REQUIRE(left);
+
+    // From its own handler, as a node failing to dequeue does, it returns right away
+    mock_node failing;
+    std::atomic<int> calls(0);
+    reactor.add(failing.fd(), [&]()
+    {
+        calls++;
+        reactor.remove(failing.fd());
+    }, []() {}, std::chrono::milliseconds(5000));
+    failing.fill(0);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (!calls && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    failing.fill(1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    REQUIRE(calls == 1);
+}
+
+TEST_CASE("capture reactor benchmark", "[.][benchmark]")
+{
+    const int fps = 1000;
+    const auto duration = std::chrono::seconds(2);
+
+    struct result
+    {
+        double latency_us;
+        double cpu_us_per_frame;
+    };
+
+    // Each camera fills its node at fps, the frames taken by one thread per node or by the reactor
+    auto run = [&](int nodes, bool reactor_threads, size_t threads)
+    {
+        std::vector<std::unique_ptr<mock_node>> mocks;
+        for (int i = 0; i < nodes; i++)
+            mocks.emplace_back(new mock_node());
+
+        std::atomic<long long> frames(0), latency(0);
+        auto take = [&](mock_node& node, bool all)
+        {
+            int64_t timestamp;
+            while ((timestamp = node.dequeue()) >= 0)
+            {
+                latency += now_ns() - timestamp;
+                frames++;
+                if (!all)
+                    break;
+            }
+        };
+
+        timespec cpu_start, cpu_end;
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu_start);
+
+        std::atomic<bool> capturing(true);
+        int stop_pipe[2];
+        REQUIRE(pipe(stop_pipe) == 0);
+        std::vector<std::thread> capture_threads;
+        std::unique_ptr<capture_reactor> reactor;
+        if (reactor_threads)
+        {
+            reactor.reset(new capture_reactor(threads));
+            for (auto&& m : mocks)
+            {
+                auto node = m.get();
+                reactor->add(node->fd(), [&, node]() { take(*node, true); }, []() {}, std::chrono::milliseconds(5000));
+            }
+        }
+        else
+        {
+            // As v4l_uvc_device captured: a select() over the node and a stop pipe, a buffer per wake
+            for (auto&& m : mocks)
+            {
+                auto node = m.get();
+                capture_threads.emplace_back([&, node]()
+                {
+                    while (capturing)
+                    {
+                        fd_set fds;
+                        FD_ZERO(&fds);
+                        FD_SET(node->fd(), &fds);
+                        FD_SET(stop_pipe[0], &fds);
+                        timeval timeout = { 5, 0 };
+                        if (select(std::max(node->fd(), stop_pipe[0]) + 1, &fds, nullptr, nullptr, &timeout) > 0 && FD_ISSET(node->fd(), &fds))
+                            take(*node, false);
+                    }
+                });
+            }
+        }
+
+        std::vector<std::thread> cameras;
+        for (auto&& m : mocks)
+        {
+            auto node = m.get();
+            cameras.emplace_back([&, node]()
+            {
+                auto next = std::chrono::steady_clock::now();
+                auto end = next + duration;
+                while (next < end)
+                {
+                    node->fill(now_ns());
+                    next += std::chrono::nanoseconds(1000000000 / fps);
+                    std::this_thread::sleep_until(next);
+                }
+            });
+        }
+        for (auto&& c : cameras)
+            c.join();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+        capturing = false;
+        if (reactor)
+        {
+            for (auto&& m : mocks)
+                reactor->remove(m->fd());
+            reactor.reset();
+        }
+        else
+        {
+            char stop = 0;
+            REQUIRE(write(stop_pipe[1], &stop, 1) == 1);
+            for (auto&& t : capture_threads)
+                t.join();
+        }
+        ::close(stop_pipe[0]);
+        ::close(stop_pipe[1]);
+
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu_end);
+        auto cpu_us = (cpu_end.tv_sec - cpu_start.tv_sec) * 1e6 + (cpu_end.tv_nsec - cpu_start.tv_nsec) / 1e3;
+        return result{ latency / 1000. / std::max(1ll, frames.load()), cpu_us / std::max(1ll, frames.load()) };
+    };
+
+    std::cout << std::left << std::setw(10) << "nodes" << std::setw(30) << "capture" << std::setw(16) << "latency us" << "cpu us per frame" << std::endl;
+    for (int nodes : { 1, 4, 8 })
+    {
+        auto print = [&](const char* name, result r)
+        {
+            std::cout << std::setw(10) << nodes << std::setw(30) << name << std::setw(16) << std::setprecision(3) << r.latency_us << r.cpu_us_per_frame << std::endl;
+        };
+        print("thread and select() per node", run(nodes, false, 0));
+        print("reactor, 1 thread", run(nodes, true, 1));
+        print("reactor, 2 threads", run(nodes, true, 2));
+    }
+}
+
+#endif
@@ -0,0 +1,163 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "catch/catch.hpp"
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "internal-tests-common.h"
+#include "./../src/proc/colorizer.h"
+
+using namespace librealsense;
+
+namespace
+{
+    // The colorizer, and the pixel by pixel colorization through the color map it had before the lookup tables
+    class reference_colorizer : public colorizer
+    {
+    public:
+        // Of a frame the colorizer processed last, with the options it had
+        std::vector<uint8_t> colorize(const rs2::video_frame& depth)
+        {
+            const auto w = depth.get_width(), h = depth.get_height();
+            std::vector<uint8_t> rgb(w * h * 3);
+            std::vector<int> histogram(MAX_DEPTH);
+            auto hist = histogram.data();
+
+            if (depth.get_profile().format() == RS2_FORMAT_DISPARITY32)
+            {
+                auto data = reinterpret_cast<const float*>(depth.get_data());
+                if (_equalize)
+                {
+                    update_histogram(hist, data, w, h);
+                    make_rgb_data<float>(data, rgb.data(), w, h, [&](float d) { return hist[(int)d] / (float)hist[MAX_DEPTH - 1]; });
+                }
+                else
+                {
+                    auto __min = _min;
+                    if (__min < 1e-6f) { __min = 1e-6f; }
+                    auto max = (_d2d_convert_factor / (__min)) * _depth_units + .5f;
+                    auto min = (_d2d_convert_factor / (_max)) * _depth_units + .5f;
+                    make_rgb_data<float>(data, rgb.data(), w, h, [&](float d) { return (d - min) / (max - min); });
+                }
+            }
+            else
+            {
+                auto data = reinterpret_cast<const uint16_t*>(depth.get_data());
+                if (_equalize)
+                {
+                    update_histogram(hist, data, w, h);
+                    make_rgb_data<uint16_t>(data, rgb.data(), w, h, [&](float d) { return hist[(int)d] / (float)hist[MAX_DEPTH - 1]; });
+                }
+                else
+                {
+                    auto min = _min;
+                    auto max = _max;
+                    make_rgb_data<uint16_t>(data, rgb.data(), w, h, [&](float d) { return (d * _depth_units - min) / (max - min); });
+                }
+            }
+            return rgb;
+        }
+    };
+
+    rs2::filter as_filter(std::shared_ptr<processing_block_interface> block)
+    {
+        return rs2::filter(std::shared_ptr<rs2_processing_block>(new rs2_processing_block(block), rs2_delete_processing_block));
+    }
+
+    void require_colors(reference_colorizer& reference, const rs2::filter& filter, const rs2::frame& depth)
+    {
+        auto colored = filter.process(depth).as<rs2::video_frame>();
+        REQUIRE(colored.get_profile().format() == RS2_FORMAT_RGB8);
+        auto expected = reference.colorize(depth);
+        REQUIRE(expected.size() == size_t(colored.get_stride_in_bytes() * colored.get_height()));
+        REQUIRE(memcmp(colored.get_data(), expected.data(), expected.size()) == 0);
+    }
+}
+
+TEST_CASE("colorizer lookup tables give the colors of the color maps", "[code]")
+{
+    depth_source source(173, 61);
+    rs2::disparity_transform to_disparity;
+    auto reference = std::make_shared<reference_colorizer>();
+    auto filter = as_filter(reference);
+    auto schemes = filter.get_option_range(RS2_OPTION_COLOR_SCHEME);
+
+    for (float threads : { 1.f, 0.f })
+    {
+        filter.set_option(RS2_OPTION_PROCESSING_THREADS, threads);
+        for (float preset : { 0.f, 1.f, 2.f, 3.f })
+        {
+            for (float scheme = schemes.min; scheme <= schemes.max; scheme += schemes.step)
+            {
+                CAPTURE(threads);
+                CAPTURE(preset);
+                CAPTURE(scheme);
+                filter.set_option(RS2_OPTION_VISUAL_PRESET, preset);
+                filter.set_option(RS2_OPTION_COLOR_SCHEME, scheme);
+
+                auto depth = source.next_uniform(200, 17000);
+                require_colors(*reference, filter, depth);
+                require_colors(*reference, filter, to_disparity.process(depth));
+            }
+        }
+    }
+
+    // The range of the table follows the options
+    filter.set_option(RS2_OPTION_VISUAL_PRESET, 1.f);
+    for (float max : { 2.f, 10.f, 0.5f })
+    {
+        CAPTURE(max);
+        filter.set_option(RS2_OPTION_MIN_DISTANCE, 0.2f);
+        filter.set_option(RS2_OPTION_MAX_DISTANCE, max);
+        require_colors(*reference, filter, source.next_uniform(200, 17000));
+    }
+    filter.set_option(RS2_OPTION_HISTOGRAM_EQUALIZATION_ENABLED, 1.f);
+    require_colors(*reference, filter, source.next_uniform(200, 17000));
+}
+
+TEST_CASE("colorizer leaves frames without depth black", "[code]")
+{
+    depth_source source(64, 48);
+    auto reference = std::make_shared<reference_colorizer>();
+    auto filter = as_filter(reference);
+
+    for (float equalize : { 1.f, 0.f })
+    {
+        filter.set_option(RS2_OPTION_HISTOGRAM_EQUALIZATION_ENABLED, equalize);
+        auto colored = filter.process(source.next_uniform(200, 17000, 1.f)).as<rs2::video_frame>();
+        auto data = static_cast<const uint8_t*>(colored.get_data());
+        std::vector<uint8_t> black(colored.get_stride_in_bytes() * colored.get_height(), 0);
+        REQUIRE(memcmp(data, black.data(), black.size()) == 0);
+    }
+}
+
+TEST_CASE("colorizer benchmark", "[.][benchmark]")
+{
+    const int iterations = 50;
+    benchmark_table table({ { "depth", 12 }, { "mode", 12 }, { "threads", 8 }, { "per pixel ms", 16 }, { "table ms", 12 } });
+
+    for (auto size : { std::make_pair(848, 480), std::make_pair(1280, 720) })
+    {
+        depth_source source(size.first, size.second);
+        auto depth = source.next_uniform(200, 17000).as<rs2::video_frame>();
+
+        for (float equalize : { 1.f, 0.f })
+        {
+            for (float threads : { 1.f, 0.f })
+            {
+                auto reference = std::make_shared<reference_colorizer>();
+                auto filter = as_filter(reference);
+                filter.set_option(RS2_OPTION_HISTOGRAM_EQUALIZATION_ENABLED, equalize);
+                filter.set_option(RS2_OPTION_PROCESSING_THREADS, threads);
+                auto lookup = time_ms(iterations, [&]() { filter.process(depth); });
+                auto per_pixel = time_ms(iterations, [&]() { reference->colorize(depth); });
+
+                table.row(size_name(size.first, size.second), equalize ? "equalized" : "range", threads ? "1" : "all", per_pixel, lookup);
+            }
+        }
+    }
+}
@@ -0,0 +1,215 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#pragma once
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "./../include/librealsense2/rs.hpp"
+#include "./../include/librealsense2/hpp/rs_internal.hpp"
+
+// Frames of one video stream of a software sensor, depth for Z16 and color for the rest.
+// With a baseline, the disparity transforms take the sensor for a stereo one
+class software_stream
+{
+public:
+    software_stream(int width, int height, rs2_format format = RS2_FORMAT_Z16, int bpp = 2, float baseline = 50.f)
+        : _width(width), _height(height), _bpp(bpp), _sensor(_dev.add_sensor("Stereo Module"))
+    {
+        _sensor.add_read_only_option(RS2_OPTION_DEPTH_UNITS, 0.001f);
+        if (baseline)
+            _sensor.add_read_only_option(RS2_OPTION_STEREO_BASELINE, baseline);
+
+        auto stream = format == RS2_FORMAT_Z16 ? RS2_STREAM_DEPTH : RS2_STREAM_COLOR;
+        rs2_intrinsics intrin = { width, height, width / 2.f, height / 2.f, width * 0.7f, width * 0.7f, RS2_DISTORTION_BROWN_CONRADY, { 0 } };
+        _profile = _sensor.add_video_stream({ stream, 0, 0, width, height, 30, bpp, format, intrin });
+        _sensor.open(_profile);
+        _sensor.start(_queue);
+    }
+
+    ~software_stream()
+    {
+        _sensor.stop();
+        _sensor.close();
+    }
+
+    // The frame the sensor makes of pixels, allocated with new[], which it takes over
+    rs2::frame send(uint8_t* pixels)
+    {
+        _sensor.on_video_frame({ pixels, [](void* p) { delete[] static_cast<uint8_t*>(p); },
+            _width * _bpp, _bpp, _number * 33., RS2_TIMESTAMP_DOMAIN_HARDWARE_CLOCK, _number, _profile });
+        _number++;
+        return _queue.wait_for_frame();
+    }
+
+protected:
+    int _width, _height, _bpp;
+    int _number = 0;
+    rs2::software_device _dev;
+    rs2::software_sensor _sensor;
+    rs2::stream_profile _profile;
+    rs2::frame_queue _queue;
+};
+
+// A slanted wall with a box in front of it, moving with the frame number, in millimeters. There is
+// noise, a share of scattered holes, the invalid band on the left and a shadow beside the box
+inline std::vector<uint16_t> depth_scene(int width, int height, int number, float hole_rate = 0.1f, int noise_mm = 6)
+{
+    std::mt19937 rng(number);
+    std::uniform_int_distribution<int> noise(-noise_mm, noise_mm);
+    std::uniform_real_distribution<float> unit(0, 1);
+    std::vector<uint16_t> depth(width * height);
+    const int box = width / 3 + number % (width / 4 + 1), box_end = box + width / 6;
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            int z = 1500 + x * 600 / width + noise(rng);
+            bool rows = y > height / 4 && y < height * 3 / 4;
+            if (rows && x > box && x < box_end)
+                z = 700 + noise(rng);
+            bool shadow = rows && x >= box_end && x < box_end + width / 40;
+            if (unit(rng) < hole_rate || x < width / 16 || shadow)
+                z = 0;
+            depth[y * width + x] = static_cast<uint16_t>(z);
+        }
+    }
+    return depth;
+}
+
+// Depth frames of a software sensor
+class depth_source : public software_stream
+{
+public:
+    depth_source(int width, int height, bool stereo = true)
+        : software_stream(width, height, RS2_FORMAT_Z16, 2, stereo ? 50.f : 0.f)
+    {
+    }
+
+    // Of the scene above
+    rs2::frame next(float hole_rate = 0.1f)
+    {
+        return next(depth_scene(_width, _height, _number, hole_rate));
+    }
+
+    // Of depth of the sensor's size, as depth_recording() gives
+    rs2::frame next(const std::vector<uint16_t>& depth)
+    {
+        auto pixels = new uint8_t[depth.size() * 2];
+        memcpy(pixels, depth.data(), depth.size() * 2);
+        return send(pixels);
+    }
+
+    // Depth drawn uniformly from [min, max], and holes
+    rs2::frame next_uniform(int min, int max, float hole_rate = 0.1f)
+    {
+        std::mt19937 rng(_number);
+        std::uniform_int_distribution<int> depth_value(min, max);
+        std::uniform_real_distribution<float> unit(0, 1);
+        auto pixels = new uint8_t[_width * _height * 2];
+        auto depth = reinterpret_cast<uint16_t*>(pixels);
+        for (int i = 0; i < _width * _height; i++)
+            depth[i] = unit(rng) < hole_rate ? 0 : static_cast<uint16_t>(depth_value(rng));
+        return send(pixels);
+    }
+};
+
+// Frames of a depth stream, played back from LRS_DEPTH_RECORDING, a rosbag with depth in it,
+// or of the scene above. source tells which
+inline std::vector<std::vector<uint16_t>> depth_recording(int frames, int& width, int& height, std::string& source)
+{
+    std::vector<std::vector<uint16_t>> result;
+    if (auto file = getenv("LRS_DEPTH_RECORDING"))
+    {
+        rs2::config cfg;
+        cfg.enable_device_from_file(file, false);
+        cfg.enable_stream(RS2_STREAM_DEPTH, RS2_FORMAT_Z16);
+        rs2::pipeline pipe;
+        auto profile = pipe.start(cfg);
+        profile.get_device().as<rs2::playback>().set_real_time(false);
+
+        rs2::frameset frameset;
+        while (int(result.size()) < frames && pipe.try_wait_for_frames(&frameset, 1000))
+        {
+            auto depth = frameset.get_depth_frame();
+            if (!depth)
+                continue;
+            width = depth.get_width();
+            height = depth.get_height();
+            auto pixels = static_cast<const uint8_t*>(depth.get_data());
+            std::vector<uint16_t> frame(width * height);
+            for (int y = 0; y < height; y++)
+                memcpy(frame.data() + y * width, pixels + y * depth.get_stride_in_bytes(), width * 2);
+            result.push_back(frame);
+        }
+        pipe.stop();
+        source = file;
+        return result;
+    }
+
+    width = 848;
+    height = 480;
+    for (int i = 0; i < frames; i++)
+        result.push_back(depth_scene(width, height, i));
+    source = "a synthetic scene, set LRS_DEPTH_RECORDING to a rosbag for recorded depth";
+    return result;
+}
+
+// Milliseconds per call of f, over iterations calls after one to warm up
+inline double time_ms(int iterations, const std::function<void()>& f)
+{
+    f();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+        f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+inline std::string size_name(int width, int height)
+{
+    return std::to_string(width) + "x" + std::to_string(height);
+}
+
+// The results of a benchmark, printed a row at a time under the headers of the columns
+class benchmark_table
+{
+public:
+    // Each header with the width of its column
+    benchmark_table(const std::vector<std::pair<std::string, int>>& columns)
+    {
+        std::cout << std::left;
+        for (auto&& column : columns)
+        {
+            std::cout << std::setw(column.second) << column.first;
+            _widths.push_back(column.second);
+        }
+        std::cout << std::endl;
+    }
+
+    template<class... T>
+    void row(const T&... cells)
+    {
+        print(0, cells...);
+        std::cout << std::endl;
+    }
+
+private:
+    void print(size_t) {}
+
+    template<class T, class... Rest>
+    void print(size_t column, const T& cell, const Rest&... rest)
+    {
+        std::cout << std::setw(column < _widths.size() ? _widths[column] : 0) << std::setprecision(3) << cell;
+        print(column + 1, rest...);
+    }
+
+    std::vector<int> _widths;
+};
@@ -0,0 +1,186 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "catch/catch.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "internal-tests-common.h"
+#include "./../tools/rs-server/RsCompressionStage.hh"
+
+namespace
+{
+    // Halves a frame, writing its first byte over the rest, in a time of its own for each frame so the
+    // workers finish out of order. Fails the frames of fail_every, and holds every frame while held
+    class mock_compression : public ICompression
+    {
+    public:
+        mock_compression(int fail_every = 0)
+            : ICompression(64, 48, RS2_FORMAT_Z16, 2), _fail_every(fail_every)
+        {
+        }
+
+        int compressBuffer(unsigned char* t_buffer, int t_size, unsigned char* t_compressedBuf) override
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex());
+                entered()++;
+                released().wait(lock, []() { return !held(); });
+            }
+            int number = t_buffer[0];
+            std::this_thread::sleep_for(std::chrono::milliseconds(number * 7 % 5));
+            if(_fail_every && number % _fail_every == 0)
+                return -1;
+            memset(t_compressedBuf, t_buffer[0], t_size / 2);
+            return t_size / 2;
+        }
+
+        int decompressBuffer(unsigned char*, int, unsigned char*) override
+        {
+            return -1;
+        }
+
+        static void hold(bool on)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex());
+                held() = on;
+            }
+            released().notify_all();
+        }
+
+        static int entered_count()
+        {
+            std::lock_guard<std::mutex> lock(mutex());
+            return entered();
+        }
+
+    private:
+        static std::mutex& mutex() { static std::mutex m; return m; }
+        static std::condition_variable& released() { static std::condition_variable cv; return cv; }
+        static bool& held() { static bool h = false; return h; }
+        static int& entered() { static int n = 0; return n; }
+
+        int _fail_every;
+    };
+
+    // Depth frames numbered in their first byte, as the mock reads them
+    class numbered_source : public depth_source
+    {
+    public:
+        numbered_source() : depth_source(64, 48) {}
+
+        rs2::frame next_numbered()
+        {
+            auto number = _number;
+            auto pixels = new uint8_t[_width * _height * 2];
+            memset(pixels, number, _width * _height * 2);
+            return send(pixels);
+        }
+    };
+
+    std::vector<std::shared_ptr<ICompression>> compressors(int workers, int fail_every = 0)
+    {
+        std::vector<std::shared_ptr<ICompression>> result;
+        for(int i = 0; i < workers; i++)
+            result.push_back(std::make_shared<mock_compression>(fail_every));
+        return result;
+    }
+
+    std::vector<int> received(rs2::frame_queue& output, size_t count)
+    {
+        std::vector<int> numbers;
+        rs2::frame f;
+        while(numbers.size() < count && output.try_wait_for_frame(&f, 2000))
+            numbers.push_back(static_cast<const uint8_t*>(f.get_data())[0]);
+        return numbers;
+    }
+}
+
+TEST_CASE("compression stage keeps the order of frames across workers", "[code]")
+{
+    const int frames = 60;
+    numbered_source source;
+    rs2::frame_queue output(frames);
+    MemoryPool pool;
+    StreamStatistic statistic;
+    RsCompressionStage stage(compressors(4, 7), output, &pool, &statistic, frames);
+
+    // Out in order, with no frame where compression failed
+    std::vector<int> expected;
+    for(int i = 0; i < frames; i++)
+        if(i % 7)
+            expected.push_back(i);
+    std::vector<int> numbers;
+    std::thread consumer([&]() { numbers = received(output, expected.size()); });
+
+    // A few frames in flight at a time, as the sensor holds only so many
+    auto entered = mock_compression::entered_count();
+    for(int i = 0; i < frames; i++)
+    {
+        while(i - (mock_compression::entered_count() - entered) > 6)
+            std::this_thread::yield();
+        stage.push(source.next_numbered());
+    }
+    consumer.join();
+    stage.stop();
+
+    REQUIRE(numbers == expected);
+    REQUIRE(statistic.m_droppedFrameCounter == 0);
+    REQUIRE(statistic.m_frameCounter == int(expected.size()));
+    REQUIRE(statistic.m_compressedSizeSum * 2 == statistic.m_decompressedSizeSum);
+    REQUIRE(pool.getStats().inUse == 0);
+}
+
+TEST_CASE("compression stage skips frames by its policy", "[code]")
+{
+    for(auto policy : { SkipPolicy::dropOldest, SkipPolicy::dropNewest })
+    {
+        CAPTURE(int(policy));
+        numbered_source source;
+        rs2::frame_queue output(8);
+        MemoryPool pool;
+        StreamStatistic statistic;
+        mock_compression::hold(true);
+        auto entered = mock_compression::entered_count();
+        RsCompressionStage stage(compressors(1), output, &pool, &statistic, 2, policy);
+
+        // The one worker holds frame 0 while 1, 2, 3 and 4 come to a queue of two
+        stage.push(source.next_numbered());
+        while(mock_compression::entered_count() == entered)
+            std::this_thread::yield();
+        for(int i = 0; i < 4; i++)
+            stage.push(source.next_numbered());
+        mock_compression::hold(false);
+
+        auto numbers = received(output, 3);
+        stage.stop();
+        REQUIRE(numbers == (policy == SkipPolicy::dropOldest ? std::vector<int>{ 0, 3, 4 } : std::vector<int>{ 0, 1, 2 }));
+        REQUIRE(statistic.m_droppedFrameCounter == 2);
+    }
+}
+
+TEST_CASE("compression stage skips the frames the pool has no buffer for", "[code]")
+{
+    numbered_source source;
+    rs2::frame_queue output(8);
+    MemoryPool pool(0);
+    StreamStatistic statistic;
+    {
+        RsCompressionStage stage(compressors(2), output, &pool, &statistic);
+        for(int i = 0; i < 3; i++)
+        {
+            stage.push(source.next_numbered());
+            while(pool.getStats().exhausted < i + 1)
+                std::this_thread::yield();
+        }
+    }
+
+    rs2::frame f;
+    REQUIRE_FALSE(output.poll_for_frame(&f));
+    REQUIRE(statistic.m_droppedFrameCounter == 3);
+    REQUIRE(pool.getStats().exhausted == 3);
+}
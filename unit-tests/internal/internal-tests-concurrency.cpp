@@ -0,0 +1,450 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "catch/catch.hpp"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <thread>
+#include <vector>
+#include "./../src/concurrency.h"
+
+using namespace std::chrono;
+
+namespace
+{
+    // The std::deque + mutex queue single_consumer_queue was built on before the lock-free ring,
+    // kept as the baseline for the handoff benchmark
+    template<class T>
+    class locking_queue
+    {
+        std::deque<T> _queue;
+        std::mutex _mutex;
+        std::condition_variable _deq_cv;
+        unsigned int _cap;
+
+    public:
+        explicit locking_queue(unsigned int cap) : _cap(cap) {}
+
+        void enqueue(T&& item)
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _queue.push_back(std::move(item));
+            if (_queue.size() > _cap)
+                _queue.pop_front();
+            lock.unlock();
+            _deq_cv.notify_one();
+        }
+
+        bool dequeue(T* item, unsigned int timeout_ms)
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            if (!_deq_cv.wait_for(lock, milliseconds(timeout_ms), [this]() { return _queue.size() > 0; }))
+                return false;
+            *item = std::move(_queue.front());
+            _queue.pop_front();
+            return true;
+        }
+    };
+
+    struct handoff_result
+    {
+        double items_per_second;
+        double median_latency_us;
+        double p99_latency_us;
+    };
+
+    // One producer pushes timestamps at full speed, one consumer measures the time each spent in transit
+    template<class Q>
+    handoff_result measure_handoff(Q& queue, int items)
+    {
+        std::vector<double> latencies;
+        latencies.reserve(items);
+
+        auto start = steady_clock::now();
+        std::thread consumer([&]() {
+            steady_clock::time_point sent;
+            for (int i = 0; i < items; i++)
+            {
+                if (!queue.dequeue(&sent, 1000)) break;
+                latencies.push_back(duration<double, std::micro>(steady_clock::now() - sent).count());
+            }
+        });
+        for (int i = 0; i < items; i++)
+        {
+            queue.enqueue(steady_clock::now());
+            // Leave the consumer room so the queue never drops, as at camera rates
+            if ((i & 0x3F) == 0x3F) std::this_thread::yield();
+        }
+        consumer.join();
+        auto elapsed = duration<double>(steady_clock::now() - start).count();
+
+        std::sort(latencies.begin(), latencies.end());
+        handoff_result res{ 0, 0, 0 };
+        if (!latencies.empty())
+        {
+            res.items_per_second = latencies.size() / elapsed;
+            res.median_latency_us = latencies[latencies.size() / 2];
+            res.p99_latency_us = latencies[latencies.size() * 99 / 100];
+        }
+        return res;
+    }
+}
+
+TEST_CASE("single_consumer_queue drops the oldest item when full", "[code]")
+{
+    single_consumer_queue<int> q(3);
+    for (int i = 0; i < 5; i++)
+        q.enqueue(std::move(i));
+
+    REQUIRE(q.size() == 3);
+    int item = 0;
+    REQUIRE(q.dequeue(&item, 0));
+    REQUIRE(item == 2);
+    int* front = nullptr;
+    REQUIRE(q.peek(&front));
+    REQUIRE(*front == 3);
+}
+
+TEST_CASE("single_consumer_queue dequeue honors timeout and flush", "[code]")
+{
+    single_consumer_queue<int> q(4);
+    int item = 0;
+
+    auto start = steady_clock::now();
+    REQUIRE_FALSE(q.dequeue(&item, 20));
+    REQUIRE(steady_clock::now() - start >= milliseconds(20));
+
+    std::thread flusher([&]() {
+        std::this_thread::sleep_for(milliseconds(20));
+        q.clear();
+    });
+    start = steady_clock::now();
+    REQUIRE_FALSE(q.dequeue(&item, 10000));
+    REQUIRE(steady_clock::now() - start < seconds(5));
+    flusher.join();
+
+    // Nothing is accepted between clear() and start()
+    q.enqueue(1);
+    REQUIRE_FALSE(q.try_dequeue(&item));
+    q.start();
+    q.enqueue(1);
+    REQUIRE(q.try_dequeue(&item));
+    REQUIRE(item == 1);
+}
+
+TEST_CASE("single_consumer_queue blocking_enqueue waits for room", "[code]")
+{
+    single_consumer_queue<int> q(2);
+    q.blocking_enqueue(1);
+    q.blocking_enqueue(2);
+
+    std::atomic<bool> pushed(false);
+    std::thread producer([&]() {
+        q.blocking_enqueue(3);
+        pushed = true;
+    });
+    std::this_thread::sleep_for(milliseconds(20));
+    REQUIRE_FALSE(pushed);
+
+    int item = 0;
+    REQUIRE(q.dequeue(&item, 100));
+    producer.join();
+    REQUIRE(pushed);
+
+    std::vector<int> rest;
+    while (q.try_dequeue(&item))
+        rest.push_back(item);
+    REQUIRE(rest == std::vector<int>({ 2, 3 }));
+}
+
+TEST_CASE("single_consumer_queue delivers every item across producers", "[code]")
+{
+    const int producers = 4, per_producer = 20000;
+    single_consumer_queue<int> q(per_producer * producers);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++)
+        threads.emplace_back([&q, p]() {
+            for (int i = 0; i < per_producer; i++)
+                q.enqueue(p * per_producer + i);
+        });
+
+    std::vector<int> received;
+    int item;
+    while (received.size() < producers * per_producer && q.dequeue(&item, 1000))
+        received.push_back(item);
+    for (auto&& t : threads)
+        t.join();
+
+    std::sort(received.begin(), received.end());
+    std::vector<int> expected(producers * per_producer);
+    std::iota(expected.begin(), expected.end(), 0);
+    REQUIRE(received == expected);
+}
+
+TEST_CASE("single_consumer_queue of a large capacity keeps every item in order", "[code]")
+{
+    // As the record and playback dispatchers are made, far past the cells of the ring
+    single_consumer_queue<int> q(std::numeric_limits<unsigned int>::max());
+    const int items = 5000;
+    for (int i = 0; i < items; i++)
+        q.enqueue(std::move(i));
+    REQUIRE(q.size() == items);
+
+    int* front = nullptr;
+    int item = 0;
+    for (int i = 0; i < items; i++)
+    {
+        REQUIRE(q.peek(&front));
+        REQUIRE(*front == i);
+        REQUIRE(q.dequeue(&item, 0));
+        REQUIRE(item == i);
+        // Items that come while the spill empties go after it
+        if (i == items / 2)
+            for (int j = items; j < items + 10; j++)
+                q.enqueue(std::move(j));
+    }
+    for (int i = items; i < items + 10; i++)
+    {
+        REQUIRE(q.try_dequeue(&item));
+        REQUIRE(item == i);
+    }
+    REQUIRE_FALSE(q.try_dequeue(&item));
+    REQUIRE(q.size() == 0);
+
+    for (int i = 0; i < items; i++)
+        q.enqueue(std::move(i));
+    q.clear();
+    REQUIRE(q.size() == 0);
+    q.start();
+    REQUIRE_FALSE(q.try_dequeue(&item));
+}
+
+TEST_CASE("single_consumer_queue of a large capacity keeps the order of each producer", "[code]")
+{
+    const int producers = 4, per_producer = 20000;
+    single_consumer_queue<int> q(std::numeric_limits<unsigned int>::max());
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++)
+        threads.emplace_back([&q, p]() {
+            for (int i = 0; i < per_producer; i++)
+                q.enqueue(p * per_producer + i);
+        });
+
+    std::vector<int> next(producers, 0);
+    int item, received = 0;
+    bool in_order = true;
+    while (received < producers * per_producer && q.dequeue(&item, 1000))
+    {
+        in_order = in_order && item % per_producer == next[item / per_producer]++;
+        received++;
+    }
+    for (auto&& t : threads)
+        t.join();
+    REQUIRE(received == producers * per_producer);
+    REQUIRE(in_order);
+}
+
+TEST_CASE("dispatchers keep per-dispatcher order on a shared pool", "[code]")
+{
+    const int dispatchers = 32, items = 1000;
+    thread_pool pool(2);
+    {
+        std::vector<std::unique_ptr<dispatcher>> strands;
+        std::vector<std::vector<int>> received(dispatchers);
+        for (int d = 0; d < dispatchers; d++)
+        {
+            strands.emplace_back(new dispatcher(items + 1, pool)); // room for the flush item
+            strands.back()->start();
+        }
+
+        for (int i = 0; i < items; i++)
+            for (int d = 0; d < dispatchers; d++)
+                strands[d]->invoke([&received, d, i](dispatcher::cancellable_timer) { received[d].push_back(i); });
+        for (auto&& s : strands)
+            REQUIRE(s->flush());
+
+        std::vector<int> expected(items);
+        std::iota(expected.begin(), expected.end(), 0);
+        for (auto&& r : received)
+            REQUIRE(r == expected);
+
+        // Dispatchers no longer own threads
+        REQUIRE(pool.get_live_workers() == 2);
+    }
+}
+
+TEST_CASE("sleeping dispatcher items do not starve the pool", "[code]")
+{
+    thread_pool pool(1);
+    dispatcher sleeper(10, pool), worker(10, pool);
+    sleeper.start();
+    worker.start();
+
+    std::atomic<bool> slept(false);
+    sleeper.invoke([&](dispatcher::cancellable_timer t) { slept = t.try_sleep(200); });
+    std::this_thread::sleep_for(milliseconds(20));
+
+    auto start = steady_clock::now();
+    REQUIRE(worker.flush());
+    REQUIRE(steady_clock::now() - start < milliseconds(150));
+
+    REQUIRE(sleeper.flush());
+    REQUIRE(slept);
+}
+
+TEST_CASE("stopping a dispatcher cancels its sleeps and delayed items", "[code]")
+{
+    thread_pool pool(2);
+    dispatcher d(10, pool);
+    d.start();
+
+    std::atomic<bool> delayed_ran(false);
+    std::atomic<bool> sleep_completed(true);
+    d.invoke_after(milliseconds(50), [&](dispatcher::cancellable_timer) { delayed_ran = true; });
+    d.invoke([&](dispatcher::cancellable_timer t) { sleep_completed = t.try_sleep(10000); });
+    std::this_thread::sleep_for(milliseconds(10));
+
+    auto start = steady_clock::now();
+    d.stop();
+    REQUIRE(steady_clock::now() - start < seconds(5));
+    REQUIRE_FALSE(sleep_completed);
+
+    std::this_thread::sleep_for(milliseconds(100));
+    REQUIRE_FALSE(delayed_ran);
+}
+
+TEST_CASE("a dispatcher can be destroyed from its own item", "[code]")
+{
+    thread_pool pool(2);
+    std::atomic<bool> queued(false), destroyed(false), timer_stopped(false), later_ran(false);
+    auto d = new dispatcher(10, pool);
+    d->start();
+
+    d->invoke([&, d](dispatcher::cancellable_timer t)
+    {
+        while (!queued)
+            std::this_thread::yield();
+        delete d;
+        timer_stopped = !t.try_sleep(1); // the strand the timer belongs to outlives its dispatcher
+        destroyed = true;
+    });
+    d->invoke([&](dispatcher::cancellable_timer) { later_ran = true; });
+    queued = true;
+
+    auto start = steady_clock::now();
+    while (!destroyed && steady_clock::now() - start < seconds(5))
+        std::this_thread::sleep_for(milliseconds(1));
+    REQUIRE(destroyed);
+    REQUIRE(timer_stopped);
+
+    // The drain that let go of the strand left the pool working
+    dispatcher other(10, pool);
+    other.start();
+    REQUIRE(other.flush());
+    REQUIRE_FALSE(later_ran);
+}
+
+TEST_CASE("dispatchers can be destroyed while their delayed items fire", "[code]")
+{
+    thread_pool pool(4);
+    std::atomic<int> ran(0);
+    for (int round = 0; round < 200; round++)
+    {
+        std::atomic<bool> destroyed(false);
+        std::atomic<int> late(0);
+        {
+            dispatcher d(10, pool);
+            d.start();
+            for (int i = 0; i < 20; i++)
+            {
+                d.invoke_after(milliseconds(i % 3), [&](dispatcher::cancellable_timer)
+                {
+                    if (destroyed)
+                        late++;
+                    ran++;
+                });
+            }
+            // Destroyed right as the timers come due, some of them on their way into the queue
+            std::this_thread::sleep_for(microseconds(round * 10 % 2000));
+        }
+        destroyed = true;
+
+        // No delayed item runs once its dispatcher is gone
+        std::this_thread::sleep_for(milliseconds(3));
+        REQUIRE(late == 0);
+    }
+    REQUIRE(ran > 0);
+
+    dispatcher other(10, pool);
+    other.start();
+    REQUIRE(other.flush());
+}
+
+TEST_CASE("active_object with an interval runs periodically", "[code]")
+{
+    std::atomic<int> iterations(0);
+    active_object<> poller([&](dispatcher::cancellable_timer) { ++iterations; }, 10);
+
+    poller.start();
+    poller.start(); // a second start does not spawn a second loop
+    std::this_thread::sleep_for(milliseconds(200));
+    poller.stop();
+
+    auto ran = iterations.load();
+    REQUIRE(ran > 2);
+    REQUIRE(ran < 40);
+    std::this_thread::sleep_for(milliseconds(50));
+    REQUIRE(iterations == ran);
+}
+
+TEST_CASE("parallel_for covers every index once and rethrows errors", "[code]")
+{
+    thread_pool pool(4);
+    for (unsigned int workers : { 0u, 1u, 3u, 64u })
+    {
+        std::vector<std::atomic<int>> hits(1000);
+        for (auto&& h : hits)
+            h = 0;
+        pool.parallel_for(int(hits.size()), workers, [&](int begin, int end) {
+            for (int i = begin; i < end; i++)
+                ++hits[i];
+        });
+        REQUIRE(std::all_of(hits.begin(), hits.end(), [](const std::atomic<int>& h) { return h == 1; }));
+    }
+
+    REQUIRE_THROWS(pool.parallel_for(100, 0, [](int begin, int end) {
+        if (begin <= 50 && 50 < end)
+            throw std::runtime_error("range failed");
+    }));
+
+    // Nested loops from inside the pool complete rather than waiting on themselves
+    std::atomic<int> total(0);
+    pool.parallel_for(8, 0, [&](int begin, int end) {
+        for (int i = begin; i < end; i++)
+            pool.parallel_for(100, 0, [&](int b, int e) { total += e - b; });
+    });
+    REQUIRE(total == 800);
+}
+
+TEST_CASE("single_consumer_queue handoff benchmark", "[.][benchmark]")
+{
+    const int items = 200000;
+
+    locking_queue<steady_clock::time_point> baseline(QUEUE_MAX_SIZE * 100);
+    single_consumer_queue<steady_clock::time_point> ring(QUEUE_MAX_SIZE * 100);
+
+    auto before = measure_handoff(baseline, items);
+    auto after = measure_handoff(ring, items);
+
+    std::cout << "queue            items/s      median latency [us]   p99 latency [us]\n";
+    std::cout << "deque + mutex    " << before.items_per_second << "  " << before.median_latency_us << "  " << before.p99_latency_us << "\n";
+    std::cout << "lock-free ring   " << after.items_per_second << "  " << after.median_latency_us << "  " << after.p99_latency_us << std::endl;
+
+    REQUIRE(after.items_per_second > 0);
+}
@@ -0,0 +1,266 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "catch/catch.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "internal-tests-common.h"
+
+namespace
+{
+    // Frames of one format, depth for Z16 and color for the rest
+    class image_source : public software_stream
+    {
+    public:
+        image_source(int width, int height, rs2_format format, int bpp)
+            : software_stream(width, height, format, bpp, 0.f)
+        {
+        }
+
+        // Random bytes; for depth, holes in a share of the pixels that grows across the frame up to
+        // blocks with none but holes, and the largest depth here and there
+        rs2::frame next()
+        {
+            std::mt19937 rng(_number);
+            std::uniform_int_distribution<int> byte_value(0, 255);
+            std::uniform_int_distribution<int> depth_value(1, 65535);
+            std::uniform_real_distribution<float> unit(0, 1);
+            const int size = _width * _height * _bpp;
+            auto data = new uint8_t[size];
+            if (_profile.format() == RS2_FORMAT_Z16)
+            {
+                auto depth = reinterpret_cast<uint16_t*>(data);
+                for (int i = 0; i < _width * _height; i++)
+                {
+                    float hole_rate = float(i % _width) / _width;
+                    depth[i] = unit(rng) < hole_rate ? 0 : i % 17 ? static_cast<uint16_t>(depth_value(rng)) : 65535;
+                }
+            }
+            else
+            {
+                for (int i = 0; i < size; i++)
+                    data[i] = static_cast<uint8_t>(byte_value(rng));
+            }
+
+            return send(data);
+        }
+    };
+
+    struct image_format
+    {
+        rs2_format format;
+        int bpp;
+    };
+
+    const image_format formats[] = {
+        { RS2_FORMAT_Z16, 2 },
+        { RS2_FORMAT_YUYV, 2 },
+        { RS2_FORMAT_UYVY, 2 },
+        { RS2_FORMAT_RGB8, 3 },
+        { RS2_FORMAT_BGRA8, 4 },
+        { RS2_FORMAT_Y8, 1 },
+        { RS2_FORMAT_Y16, 2 },
+    };
+
+    rs2::decimation_filter make_filter(rs2_format format, int scale, float threads)
+    {
+        rs2::decimation_filter filter(static_cast<float>(scale));
+        if (format != RS2_FORMAT_Z16)
+        {
+            filter.set_option(RS2_OPTION_STREAM_FILTER, RS2_STREAM_COLOR);
+            filter.set_option(RS2_OPTION_STREAM_FORMAT_FILTER, format);
+        }
+        filter.set_option(RS2_OPTION_PROCESSING_THREADS, threads);
+        return filter;
+    }
+
+    // The decimation as it was before the kernels, block by block. The medians are the ones the
+    // selection networks picked, the member below the middle for an even number of pixels
+    std::vector<uint8_t> legacy_decimate(const rs2::video_frame& f, int scale)
+    {
+        const int width = f.get_width(), bpp = f.get_bytes_per_pixel();
+        const int real_width = width / scale, real_height = f.get_height() / scale;
+        const int padded_width = (real_width + 3) / 4 * 4, padded_height = (real_height + 3) / 4 * 4;
+        const int patch_size = scale * scale;
+        const auto format = f.get_profile().format();
+        auto from = static_cast<const uint8_t*>(f.get_data());
+        std::vector<uint8_t> out(padded_width * padded_height * bpp);
+
+        if (format == RS2_FORMAT_Z16)
+        {
+            auto in = reinterpret_cast<const uint16_t*>(from);
+            auto q = reinterpret_cast<uint16_t*>(out.data());
+            for (int j = 0; j < real_height; ++j)
+            {
+                for (int i = 0; i < real_width; ++i)
+                {
+                    uint16_t kernel[64];
+                    int ks = 0, sum = 0;
+                    for (int n = 0; n < scale; ++n)
+                    {
+                        for (int m = 0; m < scale; ++m)
+                        {
+                            auto p = in[(j * scale + n) * width + i * scale + m];
+                            if (p)
+                            {
+                                kernel[ks++] = p;
+                                sum += p;
+                            }
+                        }
+                    }
+
+                    uint16_t value = 0;
+                    if (ks && (scale == 2 || scale == 3))
+                    {
+                        std::sort(kernel, kernel + ks);
+                        value = kernel[(ks - 1) / 2];
+                    }
+                    else if (ks)
+                        value = static_cast<uint16_t>(sum / ks);
+                    q[j * padded_width + i] = value;
+                }
+            }
+        }
+        else if (format == RS2_FORMAT_YUYV || format == RS2_FORMAT_UYVY)
+        {
+            const int w_2 = width >> 1, s2 = scale >> 1;
+            const bool odd = (scale & 1);
+            auto average = [&](const uint8_t* p, bool chroma)
+            {
+                int sum = 0;
+                for (int n = 0; n < scale; ++n, p += w_2 * 4)
+                {
+                    if (chroma)
+                    {
+                        for (int m = 0; m < s2; ++m)
+                            sum += 2 * p[m * 4];
+                        if (odd)
+                            sum += p[s2 * 4];
+                    }
+                    else
+                    {
+                        for (int m = 0; m < scale; ++m)
+                            sum += p[m * 2];
+                    }
+                }
+                return static_cast<uint8_t>(sum / patch_size);
+            };
+
+            for (int j = 0; j < real_height; ++j)
+            {
+                for (int i = 0; i < real_width >> 1; ++i)
+                {
+                    auto p = from + scale * (j * w_2 + i) * 4;
+                    auto q = &out[j * padded_width * 2 + i * 4];
+                    if (format == RS2_FORMAT_YUYV)
+                    {
+                        q[0] = average(p, false);
+                        q[1] = average(p + 1, true);
+                        q[2] = average(p + s2 * 4 + (odd ? 2 : 0), false);
+                        q[3] = average(p + 3, true);
+                    }
+                    else
+                    {
+                        q[0] = average(p, true);
+                        q[1] = average(p + 1, false);
+                        q[2] = average(p + 2, true);
+                        q[3] = average(p + s2 * 4 + (odd ? 3 : 1), false);
+                    }
+                }
+            }
+        }
+        else
+        {
+            // Every channel on its own
+            const bool y16 = format == RS2_FORMAT_Y16;
+            const int channels = y16 ? 1 : bpp;
+            auto in16 = reinterpret_cast<const uint16_t*>(from);
+            for (int j = 0; j < real_height; ++j)
+            {
+                for (int i = 0; i < real_width; ++i)
+                {
+                    for (int c = 0; c < channels; ++c)
+                    {
+                        int sum = 0;
+                        for (int n = 0; n < scale; ++n)
+                        {
+                            for (int m = 0; m < scale; ++m)
+                            {
+                                auto index = ((j * scale + n) * width + i * scale + m) * channels + c;
+                                sum += y16 ? in16[index] : from[index];
+                            }
+                        }
+
+                        auto index = (j * padded_width + i) * channels + c;
+                        if (y16)
+                            reinterpret_cast<uint16_t*>(out.data())[index] = static_cast<uint16_t>(sum / patch_size);
+                        else
+                            out[index] = static_cast<uint8_t>(sum / patch_size);
+                    }
+                }
+            }
+        }
+        return out;
+    }
+}
+
+TEST_CASE("decimation gives the frames it gave block by block", "[code]")
+{
+    // Sizes the scales divide and leave remainders of, and rows shorter than the vector kernels
+    for (auto size : { std::make_pair(182, 97), std::make_pair(96, 48), std::make_pair(18, 11) })
+    {
+        for (auto&& format : formats)
+        {
+            image_source source(size.first, size.second, format.format, format.bpp);
+            auto f = source.next().as<rs2::video_frame>();
+            for (int scale = 1; scale <= 8; scale++)
+            {
+                for (float threads : { 1.f, 0.f })
+                {
+                    CAPTURE(size.first);
+                    CAPTURE(size.second);
+                    CAPTURE(format.format);
+                    CAPTURE(scale);
+                    CAPTURE(threads);
+                    auto filter = make_filter(format.format, scale, threads);
+                    auto decimated = filter.process(f).as<rs2::video_frame>();
+                    REQUIRE(decimated.get_profile().format() == format.format);
+
+                    auto expected = legacy_decimate(f, scale);
+                    REQUIRE(expected.size() == size_t(decimated.get_stride_in_bytes() * decimated.get_height()));
+                    REQUIRE(memcmp(decimated.get_data(), expected.data(), expected.size()) == 0);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("decimation benchmark", "[.][benchmark]")
+{
+    const int iterations = 20;
+    std::cout << "1280x720, ms per frame" << std::endl;
+    benchmark_table table({ { "format", 8 }, { "scale", 8 }, { "threads", 8 }, { "block by block", 16 }, { "engine", 12 }, { "Mpixel/s", 12 } });
+
+    for (auto&& format : formats)
+    {
+        image_source source(1280, 720, format.format, format.bpp);
+        auto f = source.next().as<rs2::video_frame>();
+        for (int scale = 2; scale <= 8; scale++)
+        {
+            auto legacy = time_ms(iterations, [&]() { legacy_decimate(f, scale); });
+
+            for (float threads : { 1.f, 0.f })
+            {
+                auto filter = make_filter(format.format, scale, threads);
+                auto engine = time_ms(iterations, [&]() { filter.process(f); });
+
+                table.row(rs2_format_to_string(format.format), scale, threads ? "1" : "all", legacy, engine, 1280 * 720 / engine / 1000);
+            }
+        }
+    }
+}
@@ -0,0 +1,305 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "catch/catch.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "internal-tests-common.h"
+#include "./../src/proc/depth-codec.h"
+
+using namespace librealsense;
+
+namespace
+{
+    std::vector<uint16_t> encode_and_decode(depth_frame_encoder& encoder, const std::vector<uint16_t>& depth, depth_codec_id& codec)
+    {
+        std::vector<uint8_t> encoded(depth_frame_encoder::max_encoded_size(depth.size()));
+        auto size = encoder.encode(encoded.data(), depth.data(), depth.size());
+        REQUIRE(size <= encoded.size());
+        std::vector<uint16_t> decoded(depth.size(), 0xdead);
+        codec = decode_depth_frame(decoded.data(), decoded.size(), encoded.data(), size);
+        return decoded;
+    }
+}
+
+TEST_CASE("depth codecs decode what they encode", "[code]")
+{
+    auto& registry = depth_codec_registry::instance();
+    auto names = registry.names();
+    REQUIRE(names.size() >= 3);
+    REQUIRE(registry.find("rvl")->id() == depth_codec_id::rvl);
+    REQUIRE(registry.find(depth_codec_id::bitplane)->name() == std::string("bitplane"));
+    REQUIRE(!registry.find("gzip"));
+
+    std::mt19937 rng(5);
+    std::vector<std::pair<std::string, std::vector<uint16_t>>> inputs;
+    inputs.emplace_back("scene", depth_scene(640, 480, 3));
+    inputs.emplace_back("scene without holes", depth_scene(320, 240, 1, 0.f));
+    inputs.emplace_back("flat scene", depth_scene(256, 64, 2, 0.f, 0));
+    inputs.emplace_back("all holes", std::vector<uint16_t>(1000, 0));
+    inputs.emplace_back("no pixels", std::vector<uint16_t>());
+    inputs.emplace_back("one pixel", std::vector<uint16_t>(1, 1234));
+    for (int count : { 63, 64, 65, 129 })
+    {
+        std::vector<uint16_t> edge(count);
+        for (int i = 0; i < count; i++)
+            edge[i] = static_cast<uint16_t>(i % 3 ? 65535 - i : 0);
+        inputs.emplace_back("largest deltas, " + std::to_string(count) + " pixels", edge);
+    }
+    std::vector<uint16_t> noise(5000);
+    for (auto&& v : noise)
+        v = static_cast<uint16_t>(rng());
+    inputs.emplace_back("noise", noise);
+
+    for (auto&& name : names)
+    {
+        auto codec = registry.find(name);
+        for (auto&& input : inputs)
+        {
+            CAPTURE(name);
+            CAPTURE(input.first);
+            auto& depth = input.second;
+
+            // On its own, with all the room it may want and with less room than it takes
+            std::vector<uint8_t> encoded(depth.size() * 8 + 256);
+            auto size = codec->encode(encoded.data(), encoded.size(), depth.data(), depth.size());
+            std::vector<uint16_t> decoded(depth.size(), 0xdead);
+            codec->decode(decoded.data(), decoded.size(), encoded.data(), size);
+            REQUIRE(decoded == depth);
+            if (size > 0)
+                REQUIRE(codec->encode(encoded.data(), size - 1, depth.data(), depth.size()) == 0);
+
+            // As frames, stored raw where the codec makes them no smaller
+            depth_frame_encoder encoder(name, 0);
+            depth_codec_id used;
+            REQUIRE(encode_and_decode(encoder, depth, used) == depth);
+            REQUIRE((used == codec->id() || used == depth_codec_id::raw));
+            if (input.first == "noise" || depth.empty())
+                REQUIRE(used == depth_codec_id::raw);
+            if (input.first == "scene")
+                REQUIRE(used == codec->id());
+        }
+    }
+}
+
+TEST_CASE("depth frame encoder picks the smallest codec every few frames", "[code]")
+{
+    auto& registry = depth_codec_registry::instance();
+    const int width = 320, height = 240;
+    auto scene = depth_scene(width, height, 0);
+    std::vector<uint16_t> holes(width * height, 0);
+
+    // The codec each makes the smallest frame of
+    auto smallest = [&](const std::vector<uint16_t>& depth)
+    {
+        size_t best = 0;
+        depth_codec_id id = depth_codec_id::raw;
+        std::vector<uint8_t> encoded(depth_frame_encoder::max_encoded_size(depth.size()));
+        for (auto&& name : { "rvl", "bitplane", "lz4" })
+        {
+            depth_frame_encoder single(name, 0);
+            auto size = single.encode(encoded.data(), depth.data(), depth.size());
+            if (!best || size < best)
+            {
+                best = size;
+                id = registry.find(name)->id();
+            }
+        }
+        return id;
+    };
+
+    depth_frame_encoder encoder("rvl, bitplane,lz4,no-such-codec", 3);
+    REQUIRE(encoder.current() == depth_codec_id::rvl);
+
+    // Probed on the first frame, kept for two more, probed again on the fourth
+    depth_codec_id used;
+    REQUIRE(encode_and_decode(encoder, scene, used) == scene);
+    REQUIRE(used == smallest(scene));
+    for (int i = 0; i < 2; i++)
+    {
+        REQUIRE(encode_and_decode(encoder, holes, used) == holes);
+        REQUIRE(used == smallest(scene));
+    }
+    REQUIRE(encode_and_decode(encoder, holes, used) == holes);
+    REQUIRE(used == smallest(holes));
+    REQUIRE(encoder.current() == smallest(holes));
+
+    // And whenever the frame size changes
+    auto small = depth_scene(64, 48, 1);
+    REQUIRE(encode_and_decode(encoder, small, used) == small);
+    REQUIRE(used == smallest(small));
+
+    REQUIRE_THROWS(depth_frame_encoder("gzip"));
+    REQUIRE(registry.select("").size() == registry.names().size());
+    REQUIRE(registry.select("lz4,rvl,lz4").size() == 2);
+}
+
+TEST_CASE("depth decoding rejects frames that are not whole", "[code]")
+{
+    auto depth = depth_scene(160, 120, 4);
+    std::vector<uint16_t> decoded(depth.size());
+    for (auto&& name : depth_codec_registry::instance().names())
+    {
+        CAPTURE(name);
+        depth_frame_encoder encoder(name, 0);
+        std::vector<uint8_t> encoded(depth_frame_encoder::max_encoded_size(depth.size()));
+        auto size = encoder.encode(encoded.data(), depth.data(), depth.size());
+
+        // Cut short, of another size, or not a frame at all
+        REQUIRE_THROWS(decode_depth_frame(decoded.data(), decoded.size(), encoded.data(), size - 1));
+        REQUIRE_THROWS(decode_depth_frame(decoded.data(), decoded.size(), encoded.data(), 8));
+        REQUIRE_THROWS(decode_depth_frame(decoded.data(), decoded.size() - 1, encoded.data(), size));
+        auto header = encoded;
+        header[1] = 'X';
+        REQUIRE_THROWS(decode_depth_frame(decoded.data(), decoded.size(), header.data(), size));
+        header = encoded;
+        header[3] = 200;
+        REQUIRE_THROWS(decode_depth_frame(decoded.data(), decoded.size(), header.data(), size));
+
+        // The payload cut short under a header that says so
+        auto payload = size - depth_frame_header::SIZE;
+        for (auto cut : { payload / 2, payload - 1 })
+        {
+            auto truncated = encoded;
+            depth_frame_header h;
+            REQUIRE(depth_frame_header::read(truncated.data(), size, h));
+            h.payload = static_cast<uint32_t>(cut);
+            h.write(truncated.data());
+            REQUIRE_THROWS(decode_depth_frame(decoded.data(), decoded.size(), truncated.data(), depth_frame_header::SIZE + cut));
+        }
+
+        // Garbage is either taken for depth or rejected, never read past
+        std::mt19937 rng(9);
+        for (int round = 0; round < 50; round++)
+        {
+            auto garbage = encoded;
+            for (size_t i = depth_frame_header::SIZE; i < size; i += 1 + rng() % 64)
+                garbage[i] = static_cast<uint8_t>(rng());
+            try
+            {
+                decode_depth_frame(decoded.data(), decoded.size(), garbage.data(), size);
+            }
+            catch (const std::exception&)
+            {
+            }
+        }
+    }
+}
+
+TEST_CASE("depth encoder and decoder blocks restore Z16 frames", "[code]")
+{
+    const int width = 424, height = 240;
+    rs2::software_device dev;
+    auto sensor = dev.add_sensor("Stereo Module");
+    sensor.add_read_only_option(RS2_OPTION_DEPTH_UNITS, 0.001f);
+    rs2_intrinsics intrin = { width, height, width / 2.f, height / 2.f, 300.f, 300.f, RS2_DISTORTION_BROWN_CONRADY, { 0 } };
+    auto profile = sensor.add_video_stream({ RS2_STREAM_DEPTH, 0, 0, width, height, 30, 2, RS2_FORMAT_Z16, intrin });
+    rs2::frame_queue queue;
+    sensor.open(profile);
+    sensor.start(queue);
+
+    rs2::depth_encoder encoder;
+    rs2::depth_decoder decoder;
+    for (int i = 0; i < 5; i++)
+    {
+        auto depth = depth_scene(width, height, i, i == 4 ? 1.f : 0.1f);
+        auto pixels = new uint16_t[depth.size()];
+        std::copy(depth.begin(), depth.end(), pixels);
+        sensor.on_video_frame({ pixels, [](void* p) { delete[] static_cast<uint16_t*>(p); },
+            width * 2, 2, i * 33., RS2_TIMESTAMP_DOMAIN_HARDWARE_CLOCK, i, profile });
+        auto f = queue.wait_for_frame();
+
+        auto encoded = encoder.process(f).as<rs2::video_frame>();
+        REQUIRE(encoded);
+        REQUIRE(encoded.get_profile().format() == RS2_FORMAT_Z16C);
+        REQUIRE(encoded.get_width() == width);
+        REQUIRE(encoded.get_height() == height);
+        REQUIRE(encoded.get_frame_number() == f.get_frame_number());
+
+        // As the network device carries it
+        std::vector<uint8_t> buffer(encoded.get_data_size());
+        memcpy(buffer.data(), encoded.get_data(), buffer.size());
+        std::vector<uint16_t> restored(depth.size());
+        rs2_decode_depth(buffer.data(), int(buffer.size()), restored.data(), int(restored.size()), nullptr);
+        REQUIRE(restored == depth);
+
+        auto decoded = decoder.process(encoded).as<rs2::depth_frame>();
+        REQUIRE(decoded);
+        REQUIRE(decoded.get_profile().format() == RS2_FORMAT_Z16);
+        REQUIRE(decoded.get_width() == width);
+        REQUIRE(memcmp(decoded.get_data(), depth.data(), depth.size() * 2) == 0);
+        REQUIRE(decoded.get_units() == f.as<rs2::depth_frame>().get_units());
+
+        // Frames of other formats go through as they are
+        REQUIRE(decoder.process(f).get_profile().format() == RS2_FORMAT_Z16);
+    }
+
+    // Through the C API, as buffers
+    auto depth = depth_scene(width, height, 7);
+    std::vector<uint8_t> encoded(depth.size() * 2 + 12);
+    rs2_error* e = nullptr;
+    auto size = rs2_encode_depth("bitplane", depth.data(), int(depth.size()), encoded.data(), int(encoded.size()), &e);
+    REQUIRE(!e);
+    REQUIRE(size < int(depth.size() * 2));
+    std::vector<uint16_t> decoded(depth.size());
+    rs2_decode_depth(encoded.data(), size, decoded.data(), int(decoded.size()), &e);
+    REQUIRE(!e);
+    REQUIRE(decoded == depth);
+    rs2_encode_depth("bitplane", depth.data(), int(depth.size()), encoded.data(), int(encoded.size()) - 1, &e);
+    REQUIRE(e);
+    rs2_free_error(e);
+
+    sensor.stop();
+    sensor.close();
+}
+
+TEST_CASE("depth codecs benchmark", "[.][benchmark]")
+{
+    int width = 0, height = 0;
+    std::string source;
+    auto frames = depth_recording(100, width, height, source);
+    REQUIRE(!frames.empty());
+    auto frame_bytes = double(width) * height * 2;
+    std::cout << frames.size() << " frames of " << width << "x" << height << " depth from " << source << std::endl;
+
+    auto& registry = depth_codec_registry::instance();
+    std::vector<std::string> names = registry.names();
+    names.push_back("");
+
+    benchmark_table table({ { "codec", 24 }, { "ratio", 12 }, { "encode MB/s", 18 }, { "decode MB/s", 12 } });
+    for (auto&& name : names)
+    {
+        depth_frame_encoder encoder(name);
+        std::vector<std::vector<uint8_t>> encoded(frames.size(), std::vector<uint8_t>(depth_frame_encoder::max_encoded_size(width * height)));
+        std::vector<size_t> sizes(frames.size());
+        std::vector<uint16_t> decoded(width * height);
+
+        // The best of a few passes over the stream
+        double encode_s = 1e9, decode_s = 1e9;
+        for (int pass = 0; pass < 3; pass++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < frames.size(); i++)
+                sizes[i] = encoder.encode(encoded[i].data(), frames[i].data(), frames[i].size());
+            auto middle = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < frames.size(); i++)
+                decode_depth_frame(decoded.data(), decoded.size(), encoded[i].data(), sizes[i]);
+            auto end = std::chrono::steady_clock::now();
+            encode_s = std::min(encode_s, std::chrono::duration<double>(middle - start).count());
+            decode_s = std::min(decode_s, std::chrono::duration<double>(end - middle).count());
+        }
+        REQUIRE(decoded == frames.back());
+
+        double total = 0;
+        for (auto size : sizes)
+            total += size;
+        auto mb = frame_bytes * frames.size() / 1e6;
+        table.row(name.empty() ? "all, probed per frame" : name, frame_bytes * frames.size() / total, mb / encode_s, mb / decode_s);
+    }
+}
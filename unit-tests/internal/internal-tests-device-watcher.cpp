@@ -0,0 +1,394 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#ifdef RS2_USE_V4L2_BACKEND
+
+#include "catch/catch.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <linux/netlink.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "./../src/linux/uevent-device-watcher.h"
+
+using namespace librealsense::platform;
+
+namespace
+{
+    const std::string CAMERA = "/devices/pci0000:00/0000:00:14.0/usb2/2-1/2-1.4";
+    const std::string OTHER_CAMERA = "/devices/pci0000:00/0000:00:14.0/usb2/2-2";
+
+    // The sysfs the watcher scans, one USB device at a time
+    class fake_scanner : public device_scanner
+    {
+    public:
+        std::vector<uvc_device_info> query_uvc_devices(const std::string& usb_path) const override
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            scans.push_back(usb_path);
+            std::vector<uvc_device_info> result;
+            for (auto&& node : _nodes)
+            {
+                if (usb_path.empty() || node.device_path.compare(0, usb_path.size() + 1, usb_path + "/") == 0)
+                    result.push_back(node);
+            }
+            return result;
+        }
+
+        std::vector<hid_device_info> query_hid_devices(const std::string& usb_path) const override
+        {
+            return {};
+        }
+
+        std::vector<usb_device_info> query_usb_devices() const override
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            usb_scans++;
+            return {};
+        }
+
+        // The video nodes of a camera, as the kernel adds them under its interfaces
+        void plug(const std::string& usb_path, int first_node)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (int mi = 0; mi < 2; mi++)
+            {
+                uvc_device_info info{};
+                info.vid = 0x8086;
+                info.pid = 0x0b07;
+                info.mi = mi * 3;
+                info.id = "/dev/video" + std::to_string(first_node + mi);
+                info.unique_id = usb_path;
+                info.device_path = "/sys" + usb_path + "/" + usb_path.substr(usb_path.rfind('/') + 1) +
+                    ":1." + std::to_string(mi * 3) + "/video4linux/video" + std::to_string(first_node + mi);
+                _nodes.push_back(info);
+            }
+        }
+
+        void unplug(const std::string& usb_path)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _nodes.erase(std::remove_if(_nodes.begin(), _nodes.end(), [&](const uvc_device_info& node)
+            {
+                return node.unique_id == usb_path;
+            }), _nodes.end());
+        }
+
+        std::vector<std::string> take_scans()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto result = scans;
+            scans.clear();
+            return result;
+        }
+
+        mutable std::vector<std::string> scans;
+        mutable std::atomic<int> usb_scans{ 0 };
+
+    private:
+        mutable std::mutex _mutex;
+        std::vector<uvc_device_info> _nodes;
+    };
+
+    // One end of a socket pair in place of the netlink socket, the uevents written in the kernel's form
+    class uevent_injector
+    {
+    public:
+        uevent_injector()
+        {
+            REQUIRE(socketpair(AF_UNIX, SOCK_DGRAM, 0, _fds) == 0);
+        }
+
+        ~uevent_injector()
+        {
+            ::close(_fds[1]);
+        }
+
+        // The watcher takes this end over
+        int socket() const { return _fds[0]; }
+
+        void send(const std::string& action, const std::string& devpath, const std::string& subsystem,
+            const std::string& devtype = "")
+        {
+            std::string message = action + "@" + devpath + '\0' + "ACTION=" + action + '\0' +
+                "DEVPATH=" + devpath + '\0' + "SUBSYSTEM=" + subsystem + '\0' + "SEQNUM=" + std::to_string(++_seqnum) + '\0';
+            if (!devtype.empty())
+                message += "DEVTYPE=" + devtype + '\0';
+            REQUIRE(::send(_fds[1], message.data(), message.size(), 0) == ssize_t(message.size()));
+        }
+
+        // What a camera coming up sends
+        void add_camera(const std::string& usb_path, int first_node)
+        {
+            auto name = usb_path.substr(usb_path.rfind('/') + 1);
+            send("add", usb_path, "usb", "usb_device");
+            for (int mi = 0; mi < 2; mi++)
+            {
+                auto interface = usb_path + "/" + name + ":1." + std::to_string(mi * 3);
+                send("add", interface, "usb", "usb_interface");
+                send("add", interface + "/video4linux/video" + std::to_string(first_node + mi), "video4linux");
+                send("bind", interface, "usb", "usb_interface");
+            }
+            send("bind", usb_path, "usb", "usb_device");
+        }
+
+    private:
+        int _fds[2];
+        int _seqnum = 0;
+    };
+
+    // The uevent of a USB device coming, in the kernel's form
+    std::string add_uevent(const std::string& devpath)
+    {
+        return "add@" + devpath + '\0' + "ACTION=add" + '\0' + "DEVPATH=" + devpath + '\0' +
+            "SUBSYSTEM=usb" + '\0' + "DEVTYPE=usb_device" + '\0';
+    }
+
+    bool scanned(fake_scanner& scanner, const std::string& usb_path, std::chrono::milliseconds timeout = std::chrono::milliseconds(2000))
+    {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        do
+        {
+            auto scans = scanner.take_scans();
+            if (std::find(scans.begin(), scans.end(), usb_path) != scans.end())
+                return true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        } while (std::chrono::steady_clock::now() < deadline);
+        return false;
+    }
+
+    // A UDP socket on the loopback, bound to port, or to any for 0, and connected to peer_port unless 0
+    int loopback_socket(uint16_t port, uint16_t peer_port)
+    {
+        auto fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        REQUIRE(fd >= 0);
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+        REQUIRE(bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+        if (peer_port)
+        {
+            address.sin_port = htons(peer_port);
+            REQUIRE(connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+        }
+        return fd;
+    }
+
+    uint16_t port_of(int fd)
+    {
+        sockaddr_in address = {};
+        socklen_t length = sizeof(address);
+        REQUIRE(getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length) == 0);
+        return ntohs(address.sin_port);
+    }
+
+    struct change_log
+    {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::vector<std::pair<backend_device_group, backend_device_group>> changes;
+
+        void operator()(backend_device_group old, backend_device_group curr)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            changes.emplace_back(old, curr);
+            cv.notify_all();
+        }
+
+        bool wait_for(size_t count, std::chrono::milliseconds timeout = std::chrono::milliseconds(2000))
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            return cv.wait_for(lock, timeout, [&]() { return changes.size() >= count; });
+        }
+    };
+}
+
+TEST_CASE("uevents parse in the forms of the kernel and of udevd", "[device-watcher]")
+{
+    std::string kernel = std::string("add@") + CAMERA + "/2-1.4:1.0/video4linux/video0" + '\0' + "ACTION=add" + '\0' +
+        "DEVPATH=" + CAMERA + "/2-1.4:1.0/video4linux/video0" + '\0' + "SUBSYSTEM=video4linux" + '\0' + "DEVNAME=video0" + '\0';
+    uevent event;
+    REQUIRE(uevent::parse(kernel.data(), kernel.size(), event));
+    REQUIRE(event.action == "add");
+    REQUIRE(event.subsystem == "video4linux");
+    REQUIRE(event.usb_path() == "/sys" + CAMERA);
+
+    std::string properties = std::string("ACTION=remove") + '\0' + "DEVPATH=" + CAMERA + '\0' + "SUBSYSTEM=usb" + '\0' + "DEVTYPE=usb_device" + '\0';
+    std::vector<char> udev(40);
+    memcpy(udev.data(), "libudev", 8);
+    uint32_t fields[] = { htonl(0xfeedcafe), 40, 40, uint32_t(properties.size()) };
+    memcpy(udev.data() + 8, fields, sizeof(fields));
+    udev.insert(udev.end(), properties.begin(), properties.end());
+    REQUIRE(uevent::parse(udev.data(), udev.size(), event));
+    REQUIRE(event.action == "remove");
+    REQUIRE(event.devtype == "usb_device");
+    REQUIRE(event.usb_path() == "/sys" + CAMERA);
+
+    // Off the USB buses, or not a uevent
+    std::string platform = std::string("add@/devices/platform/serial8250") + '\0' + "ACTION=add" + '\0' + "DEVPATH=/devices/platform/serial8250" + '\0';
+    REQUIRE(uevent::parse(platform.data(), platform.size(), event));
+    REQUIRE(event.usb_path().empty());
+    std::string garbage = "libudev";
+    REQUIRE(!uevent::parse(garbage.data(), garbage.size(), event));
+    REQUIRE(!uevent::parse(properties.data(), properties.size(), event));
+}
+
+TEST_CASE("uevent device watcher scans only the USB device the uevents were under", "[device-watcher]")
+{
+    auto scanner = std::make_shared<fake_scanner>();
+    scanner->plug(OTHER_CAMERA, 0);
+    uevent_injector injector;
+    change_log log;
+
+    uevent_device_watcher watcher(scanner, injector.socket(), std::chrono::milliseconds(20));
+    REQUIRE(scanner->take_scans() == std::vector<std::string>{ "" });
+    REQUIRE(scanner->usb_scans == 1);
+    watcher.start([&](backend_device_group old, backend_device_group curr) { log(old, curr); });
+
+    // A burst of events, one change
+    scanner->plug(CAMERA, 2);
+    auto start = std::chrono::steady_clock::now();
+    injector.add_camera(CAMERA, 2);
+    REQUIRE(log.wait_for(1));
+    auto latency = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    CAPTURE(latency);
+    REQUIRE(latency < 1000);
+    {
+        std::lock_guard<std::mutex> lock(log.mutex);
+        REQUIRE(log.changes.size() == 1);
+        REQUIRE(log.changes[0].first.uvc_devices.size() == 2);
+        REQUIRE(log.changes[0].second.uvc_devices.size() == 4);
+    }
+    REQUIRE(scanner->take_scans() == std::vector<std::string>{ "/sys" + CAMERA });
+    REQUIRE(scanner->usb_scans == 2);
+
+    // Of no device of interest
+    injector.send("change", CAMERA, "usb", "usb_device");
+    injector.send("add", "/devices/virtual/net/veth0", "net");
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    REQUIRE(scanner->take_scans().empty());
+
+    scanner->unplug(CAMERA);
+    injector.send("remove", CAMERA + "/2-1.4:1.0/video4linux/video2", "video4linux");
+    injector.send("remove", CAMERA + "/2-1.4:1.3/video4linux/video3", "video4linux");
+    injector.send("remove", CAMERA, "usb", "usb_device");
+    REQUIRE(log.wait_for(2));
+    {
+        std::lock_guard<std::mutex> lock(log.mutex);
+        REQUIRE(log.changes.size() == 2);
+        REQUIRE(log.changes[1].second.uvc_devices.size() == 2);
+        for (auto&& node : log.changes[1].second.uvc_devices)
+            REQUIRE(node.unique_id == OTHER_CAMERA);
+    }
+    REQUIRE(scanner->take_scans() == std::vector<std::string>{ "/sys" + CAMERA });
+
+    // Events while stopped wait on the socket
+    watcher.stop();
+    scanner->plug(CAMERA, 2);
+    injector.add_camera(CAMERA, 2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    REQUIRE(log.changes.size() == 2);
+    watcher.start([&](backend_device_group old, backend_device_group curr) { log(old, curr); });
+    REQUIRE(log.wait_for(3));
+    watcher.stop();
+}
+
+TEST_CASE("uevent device watcher enumerates all devices after a socket error", "[device-watcher]")
+{
+    // The socket of the watcher is connected to a port no one has open, so sending to it makes an error,
+    // as the kernel overrunning a netlink socket does
+    auto closed_peer = loopback_socket(0, 0);
+    auto peer_port = port_of(closed_peer);
+    ::close(closed_peer);
+    auto socket = loopback_socket(0, peer_port);
+    auto port = port_of(socket);
+
+    auto scanner = std::make_shared<fake_scanner>();
+    uevent_device_watcher watcher(scanner, socket, std::chrono::milliseconds(20));
+    REQUIRE(scanner->take_scans() == std::vector<std::string>{ "" });
+    change_log log;
+    watcher.start([&](backend_device_group old, backend_device_group curr) { log(old, curr); });
+
+    char probe = 0;
+    REQUIRE(::send(socket, &probe, 1, 0) == 1);
+    REQUIRE(scanned(*scanner, ""));
+
+    // And it keeps watching
+    auto peer = loopback_socket(peer_port, port);
+    scanner->plug(CAMERA, 2);
+    auto message = add_uevent(CAMERA);
+    REQUIRE(::send(peer, message.data(), message.size(), 0) == ssize_t(message.size()));
+    REQUIRE(log.wait_for(1));
+    watcher.stop();
+    ::close(peer);
+}
+
+TEST_CASE("uevent device watcher drops netlink uevents of other processes", "[device-watcher]")
+{
+    auto socket = uevent_device_watcher::open_netlink_socket();
+    if (socket < 0)
+    {
+        WARN("No uevent netlink socket here, errno " << errno);
+        return;
+    }
+    sockaddr_nl address = {};
+    socklen_t length = sizeof(address);
+    REQUIRE(getsockname(socket, reinterpret_cast<sockaddr*>(&address), &length) == 0);
+    address.nl_groups = 0;
+
+    auto scanner = std::make_shared<fake_scanner>();
+    uevent_device_watcher watcher(scanner, socket, std::chrono::milliseconds(20));
+    scanner->take_scans();
+    watcher.start([](backend_device_group, backend_device_group) {});
+
+    // A process other than root sends the uevent of a camera straight to the socket of the watcher
+    auto message = add_uevent(CAMERA);
+    auto child = fork();
+    REQUIRE(child >= 0);
+    if (child == 0)
+    {
+        if (getuid() == 0 && setuid(65534) != 0)
+            _exit(1);
+        auto sender = ::socket(AF_NETLINK, SOCK_DGRAM, NETLINK_KOBJECT_UEVENT);
+        if (sender < 0)
+            _exit(2);
+        if (sendto(sender, message.data(), message.size(), 0, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != ssize_t(message.size()))
+            _exit(errno == EPERM ? 4 : 3);
+        _exit(0);
+    }
+    int status = 0;
+    REQUIRE(waitpid(child, &status, 0) == child);
+    REQUIRE(WIFEXITED(status));
+    if (WEXITSTATUS(status) == 4)
+        WARN("This kernel itself keeps processes other than root from sending uevents");
+    else
+    {
+        REQUIRE(WEXITSTATUS(status) == 0);
+        REQUIRE_FALSE(scanned(*scanner, "/sys" + CAMERA, std::chrono::milliseconds(200)));
+    }
+
+    // As udevd, a process of root
+    if (getuid() == 0)
+    {
+        auto sender = ::socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
+        REQUIRE(sender >= 0);
+        REQUIRE(sendto(sender, message.data(), message.size(), 0, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == ssize_t(message.size()));
+        REQUIRE(scanned(*scanner, "/sys" + CAMERA));
+        ::close(sender);
+    }
+    watcher.stop();
+}
+
+#endif
@@ -0,0 +1,100 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "catch/catch.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "internal-tests-common.h"
+#include "./../src/proc/disparity-transform.h"
+
+using namespace librealsense;
+
+namespace
+{
+    // The conversion as it was before the kernels, a division per pixel
+    template<typename Tin, typename Tout>
+    std::vector<Tout> per_pixel_convert(const rs2::video_frame& f, float d2d_convert_factor)
+    {
+        auto in = static_cast<const Tin*>(f.get_data());
+        std::vector<Tout> out(f.get_width() * f.get_height());
+        const float round = std::is_floating_point<Tin>::value ? 0.5f : 0.f;
+        for (size_t i = 0; i < out.size(); i++)
+        {
+            float input = in[i];
+            out[i] = std::isnormal(input) ? static_cast<Tout>((d2d_convert_factor / input) + round) : 0;
+        }
+        return out;
+    }
+
+    float convert_factor(const rs2::video_frame& f)
+    {
+        auto intrin = f.get_profile().as<rs2::video_stream_profile>().get_intrinsics();
+        return 50.f * 0.001f * intrin.fx * 32 / 0.001f;
+    }
+}
+
+TEST_CASE("disparity transform converts as it did per pixel", "[code]")
+{
+    depth_source source(181, 97);
+    rs2::disparity_transform to_disparity(true), to_depth(false);
+
+    for (int i = 0; i < 3; i++)
+    {
+        auto depth = source.next_uniform(1, 65535).as<rs2::video_frame>();
+        auto factor = convert_factor(depth);
+
+        auto disparity = to_disparity.process(depth).as<rs2::video_frame>();
+        REQUIRE(disparity.get_profile().format() == RS2_FORMAT_DISPARITY32);
+        auto expected_disparity = per_pixel_convert<uint16_t, float>(depth, factor);
+        REQUIRE(memcmp(disparity.get_data(), expected_disparity.data(), expected_disparity.size() * sizeof(float)) == 0);
+
+        auto back = to_depth.process(disparity).as<rs2::video_frame>();
+        REQUIRE(back.get_profile().format() == RS2_FORMAT_Z16);
+        auto expected_depth = per_pixel_convert<float, uint16_t>(disparity, factor);
+        REQUIRE(memcmp(back.get_data(), expected_depth.data(), expected_depth.size() * sizeof(uint16_t)) == 0);
+    }
+}
+
+TEST_CASE("disparity tables are shared per conversion factor", "[code]")
+{
+    auto lut = disparity_lut::get(960000.f);
+    REQUIRE(disparity_lut::get(960000.f) == lut);
+    REQUIRE(lut->disparity.size() == 65536);
+    REQUIRE(lut->disparity[0] == 0);
+    REQUIRE(lut->disparity[3] == 960000.f / 3);
+
+    auto other = disparity_lut::get(480000.f);
+    REQUIRE(other != lut);
+    std::weak_ptr<const disparity_lut> released = other;
+    other.reset();
+    REQUIRE(released.expired());
+}
+
+TEST_CASE("disparity transform benchmark", "[.][benchmark]")
+{
+    const int iterations = 50;
+    benchmark_table table({ { "depth", 12 }, { "direction", 22 }, { "per pixel ms", 16 }, { "kernel ms", 12 } });
+
+    for (auto size : { std::make_pair(848, 480), std::make_pair(1280, 720) })
+    {
+        depth_source source(size.first, size.second);
+        auto depth = source.next_uniform(1, 65535).as<rs2::video_frame>();
+        auto factor = convert_factor(depth);
+        rs2::disparity_transform to_disparity(true), to_depth(false);
+        auto disparity = to_disparity.process(depth).as<rs2::video_frame>();
+
+        auto name = size_name(size.first, size.second);
+        table.row(name, "depth to disparity",
+            time_ms(iterations, [&]() { per_pixel_convert<uint16_t, float>(depth, factor); }),
+            time_ms(iterations, [&]() { to_disparity.process(depth); }));
+        table.row(name, "disparity to depth",
+            time_ms(iterations, [&]() { per_pixel_convert<float, uint16_t>(disparity, factor); }),
+            time_ms(iterations, [&]() { to_depth.process(disparity); }));
+    }
+}
@@ -0,0 +1,296 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "catch/catch.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+#include "./../src/frame-buffer-pool.h"
+#include "./../src/archive.h"
+#include "./../src/sensor.h"
+
+using namespace librealsense;
+
+namespace
+{
+    class counting_memory_provider : public frame_memory_provider
+    {
+    public:
+        // Each buffer is preceded by its size, to check it is released with the size it was allocated with
+        void* allocate(size_t size) override
+        {
+            ++allocations;
+            auto block = static_cast<size_t*>(::operator new(size + sizeof(std::max_align_t)));
+            *block = size;
+            return reinterpret_cast<uint8_t*>(block) + sizeof(std::max_align_t);
+        }
+
+        void deallocate(void* ptr, size_t size) override
+        {
+            ++releases;
+            auto block = reinterpret_cast<size_t*>(static_cast<uint8_t*>(ptr) - sizeof(std::max_align_t));
+            if (*block != size)
+                ++mismatches;
+            ::operator delete(block);
+        }
+
+        std::atomic<int> allocations{ 0 };
+        std::atomic<int> releases{ 0 };
+        std::atomic<int> mismatches{ 0 };
+    };
+}
+
+TEST_CASE("frame_buffer_pool recycles buffers by size class", "[code]")
+{
+    auto provider = std::make_shared<counting_memory_provider>();
+    {
+        auto pool = std::make_shared<frame_buffer_pool>(provider);
+
+        void* first = pool->allocate(640 * 480 * 2);
+        pool->deallocate(first, 640 * 480 * 2);
+
+        // Same size class is served from the pool, other sizes go to the provider
+        REQUIRE(pool->allocate(640 * 480 * 2) == first);
+        void* other = pool->allocate(1280 * 720 * 2);
+        REQUIRE(other != first);
+
+        auto stats = pool->get_statistics();
+        REQUIRE(stats.hits == 1);
+        REQUIRE(stats.misses == 2);
+        REQUIRE(stats.in_use == 2);
+        REQUIRE(stats.high_water_mark == 2);
+        REQUIRE(provider->allocations == 2);
+
+        pool->deallocate(first, 640 * 480 * 2);
+        pool->deallocate(other, 1280 * 720 * 2);
+        REQUIRE(pool->get_statistics().in_use == 0);
+        REQUIRE(provider->releases == 0);
+    }
+    // Idle buffers are returned to the provider with the pool
+    REQUIRE(provider->releases == 2);
+}
+
+TEST_CASE("frame_buffer_pool bounds idle buffers per class", "[code]")
+{
+    auto provider = std::make_shared<counting_memory_provider>();
+    frame_buffer_pool pool(provider);
+
+    const int buffers = frame_buffer_pool::SLOTS_PER_CLASS + 4;
+    std::vector<void*> held;
+    for (int i = 0; i < buffers; i++)
+        held.push_back(pool.allocate(4096));
+    for (auto ptr : held)
+        pool.deallocate(ptr, 4096);
+
+    REQUIRE(provider->releases == buffers - frame_buffer_pool::SLOTS_PER_CLASS);
+    REQUIRE(pool.get_statistics().high_water_mark == buffers);
+}
+
+TEST_CASE("frame_buffer_pool serves more sizes than it has classes across trims", "[code]")
+{
+    auto provider = std::make_shared<counting_memory_provider>();
+    frame_buffer_pool pool(provider);
+    const int classes = frame_buffer_pool::SIZE_CLASSES, sizes = classes + 4;
+
+    // As a sensor streaming one resolution after another, each stop trimming the pool
+    SECTION("trimmed")
+    {
+        for (int i = 0; i < sizes; i++)
+        {
+            auto size = (i + 1) * 4096;
+            pool.deallocate(pool.allocate(size), size);
+            pool.deallocate(pool.allocate(size), size);
+            pool.trim();
+        }
+        auto stats = pool.get_statistics();
+        REQUIRE(stats.hits == sizes);
+        REQUIRE(stats.misses == sizes);
+        REQUIRE(stats.bypasses == 0);
+    }
+
+    // Without a trim the sizes past the classes go to the provider, and are counted for it
+    SECTION("not trimmed")
+    {
+        for (int i = 0; i < sizes; i++)
+        {
+            auto size = (i + 1) * 4096;
+            pool.deallocate(pool.allocate(size), size);
+            pool.deallocate(pool.allocate(size), size);
+        }
+        auto stats = pool.get_statistics();
+        REQUIRE(stats.hits == classes);
+        REQUIRE(stats.bypasses == 2 * (sizes - classes));
+        REQUIRE(stats.misses == sizes + sizes - classes);
+
+        // Once trimmed, they get the classes back
+        pool.trim();
+        auto size = sizes * 4096;
+        pool.deallocate(pool.allocate(size), size);
+        pool.deallocate(pool.allocate(size), size);
+        REQUIRE(pool.get_statistics().hits == classes + 1);
+    }
+}
+
+TEST_CASE("frame_buffer_pool releases classes while they are in use", "[code]")
+{
+    auto provider = std::make_shared<counting_memory_provider>();
+    {
+        frame_buffer_pool pool(provider);
+        std::atomic<bool> done(false);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; t++)
+        {
+            threads.emplace_back([&pool, t]() {
+                for (int i = 0; i < 10000; i++)
+                {
+                    // More sizes between them than there are classes
+                    auto size = ((t * 3 + i) % (frame_buffer_pool::SIZE_CLASSES + 4) + 1) * 4096;
+                    auto ptr = static_cast<uint8_t*>(pool.allocate(size));
+                    ptr[0] = ptr[size - 1] = 1;
+                    pool.deallocate(ptr, size);
+                }
+            });
+        }
+        std::thread trimming([&]() {
+            while (!done)
+                pool.trim();
+        });
+        for (auto&& t : threads)
+            t.join();
+        done = true;
+        trimming.join();
+
+        REQUIRE(pool.get_statistics().in_use == 0);
+    }
+    REQUIRE(provider->allocations == provider->releases);
+    REQUIRE(provider->mismatches == 0);
+}
+
+TEST_CASE("frame pool statistics carry over to a new allocator", "[code]")
+{
+    frame_source source;
+    auto pool = source.get_frame_pool();
+    void* held = pool->allocate(4096);
+    pool->deallocate(pool->allocate(4096), 4096);
+    pool->deallocate(pool->allocate(4096), 4096);
+
+    source.set_frame_allocator(std::make_shared<counting_memory_provider>());
+    REQUIRE(source.get_frame_pool() != pool);
+    auto stats = source.get_frame_pool_statistics();
+    REQUIRE(stats.hits == 1);
+    REQUIRE(stats.misses == 2);
+    REQUIRE(stats.bytes_allocated == 2 * 4096);
+    REQUIRE(stats.high_water_mark == 2);
+    REQUIRE(stats.in_use == 0);
+
+    // The buffer held goes back to the pool it came from
+    pool->deallocate(held, 4096);
+    source.get_frame_pool()->deallocate(source.get_frame_pool()->allocate(4096), 4096);
+    stats = source.get_frame_pool_statistics();
+    REQUIRE(stats.misses == 3);
+    REQUIRE(stats.in_use == 0);
+}
+
+TEST_CASE("frame_buffer does not zero-fill recycled buffers", "[code]")
+{
+    auto pool = std::make_shared<frame_buffer_pool>();
+    frame_buffer_allocator<uint8_t> allocator(pool);
+    {
+        frame_buffer data(allocator);
+        data.resize(4096);
+        std::fill(data.begin(), data.end(), uint8_t(0xAB));
+    }
+    frame_buffer data(allocator);
+    data.resize(4096);
+    REQUIRE(data[0] == 0xAB);
+    REQUIRE(data[4095] == 0xAB);
+}
+
+TEST_CASE("frame_buffer_pool is safe across threads", "[code]")
+{
+    auto provider = std::make_shared<counting_memory_provider>();
+    {
+        frame_buffer_pool pool(provider);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; t++)
+        {
+            threads.emplace_back([&pool]() {
+                for (int i = 0; i < 10000; i++)
+                {
+                    auto ptr = pool.allocate(1920 * 1080 * 2);
+                    pool.deallocate(ptr, 1920 * 1080 * 2);
+                }
+            });
+        }
+        for (auto&& t : threads)
+            t.join();
+
+        REQUIRE(pool.get_statistics().in_use == 0);
+        REQUIRE(pool.get_statistics().hits + pool.get_statistics().misses == 40000);
+    }
+    REQUIRE(provider->allocations == provider->releases);
+}
+
+TEST_CASE("buffer_loans bounds the buffers lent at a time", "[code]")
+{
+    buffer_loans loans(2);
+    REQUIRE(loans.try_lend());
+    REQUIRE(loans.try_lend());
+    REQUIRE_FALSE(loans.try_lend());
+    REQUIRE(loans.outstanding() == 2);
+
+    // A repaid buffer may be lent again
+    loans.repay();
+    REQUIRE(loans.outstanding() == 1);
+    REQUIRE(loans.try_lend());
+    REQUIRE_FALSE(loans.try_lend());
+    loans.repay();
+    loans.repay();
+    REQUIRE(loans.outstanding() == 0);
+
+    // Never over the limit, however many threads borrow
+    buffer_loans shared(3);
+    std::atomic<int> held(0), most(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 6; t++)
+    {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < 10000; i++)
+            {
+                if (!shared.try_lend())
+                    continue;
+                auto now = ++held;
+                auto seen = most.load();
+                while (now > seen && !most.compare_exchange_weak(seen, now)) {}
+                --held;
+                shared.repay();
+            }
+        });
+    }
+    for (auto&& t : threads)
+        t.join();
+    REQUIRE(most <= 3);
+    REQUIRE(shared.outstanding() == 0);
+}
+
+TEST_CASE("frames lent a buffer report the size of a copy", "[code]")
+{
+    const int width = 640, height = 480, stride = width * 2;
+    // The payload of a V4L2 buffer runs past the image, with padding and metadata
+    std::vector<uint8_t> payload(stride * height + 4096);
+
+    video_frame lent;
+    lent.additional_data.raw_size = static_cast<uint32_t>(payload.size());
+    lent.attach_continuation(frame_continuation([]() {}, payload.data()));
+    lent.assign(width, height, stride, 16);
+
+    video_frame copied;
+    copied.data.resize(stride * height);
+    copied.assign(width, height, stride, 16);
+
+    REQUIRE(lent.get_frame_data_size() == stride * height);
+    REQUIRE(copied.get_frame_data_size() == lent.get_frame_data_size());
+    REQUIRE(lent.get_frame_data() == payload.data());
+}
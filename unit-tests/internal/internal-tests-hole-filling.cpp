@@ -0,0 +1,165 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "catch/catch.hpp"
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "internal-tests-common.h"
+
+namespace
+{
+    // The hole filling as it was before the engine, the emptiness test picked per pixel
+    template<typename T>
+    void legacy_fill_left(T* image_data, size_t width, size_t height)
+    {
+        std::function<bool(T*)> fp_oper = [](T* ptr) { return !*((int *)ptr); };
+        std::function<bool(T*)> uint_oper = [](T* ptr) { return !(*ptr); };
+        auto empty = (std::is_floating_point<T>::value) ? fp_oper : uint_oper;
+
+        T* p = image_data;
+        for (size_t j = 0; j < height; ++j)
+        {
+            ++p;
+            for (size_t i = 1; i < width; ++i)
+            {
+                if (empty(p))
+                    *p = *(p - 1);
+                ++p;
+            }
+        }
+    }
+
+    template<typename T>
+    void legacy_fill_around(T* image_data, size_t width, size_t height, bool farest)
+    {
+        std::function<bool(T*)> fp_oper = [](T* ptr) { return !*((int *)ptr); };
+        std::function<bool(T*)> uint_oper = [](T* ptr) { return !(*ptr); };
+        auto empty = (std::is_floating_point<T>::value) ? fp_oper : uint_oper;
+
+        T* p = image_data + width;
+        for (size_t j = 1; j < height - 1; ++j)
+        {
+            ++p;
+            for (size_t i = 1; i < width; ++i)
+            {
+                if (empty(p))
+                {
+                    T tmp = *(p - width);
+                    for (T* q : { p - width - 1, p - 1, p + width - 1, p + width })
+                    {
+                        if (farest ? *q > tmp : !empty(q) && *q < tmp)
+                            tmp = *q;
+                    }
+                    *p = tmp;
+                }
+                p++;
+            }
+        }
+    }
+
+    template<typename T>
+    void legacy_fill(T* data, size_t width, size_t height, int mode)
+    {
+        if (mode == 0)
+            legacy_fill_left(data, width, height);
+        else
+            legacy_fill_around(data, width, height, mode == 1);
+    }
+
+    // What the legacy filling makes of the frame
+    std::vector<uint8_t> legacy_holes_fill(const rs2::video_frame& f, int mode)
+    {
+        const size_t width = f.get_width(), height = f.get_height();
+        auto begin = static_cast<const uint8_t*>(f.get_data());
+        std::vector<uint8_t> data(begin, begin + f.get_stride_in_bytes() * height);
+        if (f.get_profile().format() == RS2_FORMAT_DISPARITY32)
+            legacy_fill(reinterpret_cast<float*>(data.data()), width, height, mode);
+        else
+            legacy_fill(reinterpret_cast<uint16_t*>(data.data()), width, height, mode);
+        return data;
+    }
+}
+
+TEST_CASE("hole filling fills the holes it filled per pixel", "[code]")
+{
+    rs2::disparity_transform to_disparity;
+    // Rows shorter and longer than the vector scans, and the narrowest frames
+    for (auto size : { std::make_pair(181, 97), std::make_pair(7, 5), std::make_pair(1, 9), std::make_pair(33, 1) })
+    {
+        depth_source source(size.first, size.second);
+        for (float hole_rate : { 0.f, 0.1f, 0.6f, 1.f })
+        {
+            auto depth = source.next(hole_rate);
+            for (auto&& f : { depth, to_disparity.process(depth) })
+            {
+                for (int mode = 0; mode < 3; mode++)
+                {
+                    for (float threads : { 1.f, 0.f })
+                    {
+                        CAPTURE(size.first);
+                        CAPTURE(size.second);
+                        CAPTURE(hole_rate);
+                        CAPTURE(mode);
+                        CAPTURE(threads);
+                        rs2::hole_filling_filter filter(mode);
+                        filter.set_option(RS2_OPTION_PROCESSING_THREADS, threads);
+                        auto filled = filter.process(f).as<rs2::video_frame>();
+                        REQUIRE(filled.get_profile().format() == f.get_profile().format());
+
+                        auto expected = legacy_holes_fill(f, mode);
+                        REQUIRE(expected.size() == size_t(filled.get_stride_in_bytes() * filled.get_height()));
+                        REQUIRE(memcmp(filled.get_data(), expected.data(), expected.size()) == 0);
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("hole filling benchmark", "[.][benchmark]")
+{
+    const int iterations = 50;
+    rs2::disparity_transform to_disparity;
+
+    // Recorded depth has its holes where the cameras leave them, in runs and at edges, which
+    // decides how much of the frame the fill walks
+    int width, height;
+    std::string recording;
+    auto recorded = depth_recording(8, width, height, recording);
+    REQUIRE(!recorded.empty());
+    std::cout << "Depth of " << recording << ", ms per frame" << std::endl;
+
+    depth_source source(width, height);
+    std::vector<rs2::frame> depth, disparity;
+    for (auto&& frame : recorded)
+    {
+        depth.push_back(source.next(frame));
+        disparity.push_back(to_disparity.process(depth.back()));
+    }
+
+    benchmark_table table({ { "depth", 12 }, { "format", 12 }, { "mode", 22 }, { "threads", 8 }, { "per pixel ms", 16 }, { "engine ms", 12 } });
+    const char* modes[] = { "fill from left", "farest from around", "nearest from around" };
+    for (auto&& frames : { depth, disparity })
+    {
+        auto format = frames.front().get_profile().format() == RS2_FORMAT_DISPARITY32 ? "disparity" : "depth";
+        for (int mode = 0; mode < 3; mode++)
+        {
+            for (float threads : { 1.f, 0.f })
+            {
+                rs2::hole_filling_filter filter(mode);
+                filter.set_option(RS2_OPTION_PROCESSING_THREADS, threads);
+
+                size_t next = 0;
+                auto per_pixel = time_ms(iterations, [&]() { legacy_holes_fill(frames[next++ % frames.size()], mode); });
+                auto engine = time_ms(iterations, [&]() { filter.process(frames[next++ % frames.size()]); });
+
+                table.row(size_name(width, height), format, modes[mode], threads ? "1" : "all", per_pixel, engine);
+            }
+        }
+    }
+}
@@ -0,0 +1,281 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "catch/catch.hpp"
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "./../include/librealsense2/rs.hpp"
+#include "./../include/librealsense2/hpp/rs_internal.hpp"
+#include "./../src/log.h"
+
+using namespace librealsense;
+
+namespace
+{
+    // Keeps the raw messages a callback sink is handed
+    class message_sink : public rs2_log_callback
+    {
+    public:
+        void on_log(rs2_log_severity severity, rs2_log_message const& msg) noexcept override
+        {
+            auto& wrapper = reinterpret_cast<log_message const&>(msg);
+            std::lock_guard<std::mutex> lock(_mutex);
+            _messages.push_back(wrapper.el_msg.message());
+        }
+
+        void release() override {}
+
+        std::vector<std::string> messages()
+        {
+            flush_log();
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _messages;
+        }
+
+        std::string last()
+        {
+            auto all = messages();
+            return all.empty() ? std::string() : all.back();
+        }
+
+    private:
+        std::mutex _mutex;
+        std::vector<std::string> _messages;
+    };
+
+    std::shared_ptr<message_sink> open_sink(rs2_log_severity severity)
+    {
+        reset_logger();
+        auto sink = std::make_shared<message_sink>();
+        log_to_callback(severity, sink);
+        return sink;
+    }
+
+    struct position
+    {
+        int x, y;
+    };
+
+    std::ostream& operator<<(std::ostream& out, const position& p)
+    {
+        return out << "(" << p.x << ", " << p.y << ")";
+    }
+}
+
+// The message logged against the same values streamed into an ostringstream
+#define REQUIRE_LOGGED_AS_STREAMED(SINK, ...) do { std::ostringstream expected; expected << __VA_ARGS__; \
+    LOG_INFO(__VA_ARGS__); REQUIRE(SINK->last() == expected.str()); } while(false)
+
+TEST_CASE("log messages read as the stream they were written to", "[log]")
+{
+    auto sink = open_sink(RS2_LOG_SEVERITY_DEBUG);
+    const char* name = "Depth";
+    std::string serial = "012345678901";
+    short negative = -1;
+    unsigned long long frame_number = 18446744073709551615ull;
+
+    REQUIRE_LOGGED_AS_STREAMED(sink, "frame " << 7 << ' ' << name << " of " << serial);
+    REQUIRE_LOGGED_AS_STREAMED(sink, std::hex << negative << " " << -1 << " " << -1L << " " << 255u << std::dec << " " << frame_number);
+    REQUIRE_LOGGED_AS_STREAMED(sink, true << " " << std::boolalpha << false << " " << 'c' << static_cast<unsigned char>('u'));
+    REQUIRE_LOGGED_AS_STREAMED(sink, 1.f / 3 << " " << 2. / 3 << " " << std::fixed << 1e10 << " " << std::scientific << 0.25f);
+    REQUIRE_LOGGED_AS_STREAMED(sink, "at " << static_cast<const void*>(sink.get()) << " " << &frame_number);
+    REQUIRE_LOGGED_AS_STREAMED(sink, "line" << std::endl << "next line");
+
+    // Formatted by the logging thread from the first value with no binary form on, the stream state included
+    REQUIRE_LOGGED_AS_STREAMED(sink, std::hex << 255 << " " << position{ 10, 20 } << " " << 255 << std::setw(8) << 1 << " " << 2);
+    REQUIRE_LOGGED_AS_STREAMED(sink, std::setprecision(3) << 3.14159 << " " << 2.71828f);
+
+    // Larger than an entry holds
+    std::string large(1000, 'x');
+    REQUIRE_LOGGED_AS_STREAMED(sink, "large " << large << " " << 1);
+    REQUIRE_LOGGED_AS_STREAMED(sink, std::string(log_entry::PAYLOAD_SIZE, 'y'));
+
+    reset_logger();
+}
+
+TEST_CASE("log messages are not evaluated below the threshold", "[log]")
+{
+    int evaluated = 0;
+    auto evaluate = [&]() { return ++evaluated; };
+
+    // With no sink open, every message goes to easylogging
+    reset_logger();
+    REQUIRE(log_enabled(RS2_LOG_SEVERITY_DEBUG));
+    LOG_DEBUG("not open " << evaluate());
+    REQUIRE(evaluated == 1);
+
+    auto sink = open_sink(RS2_LOG_SEVERITY_WARN);
+    REQUIRE(log_enabled(RS2_LOG_SEVERITY_WARN));
+    REQUIRE(!log_enabled(RS2_LOG_SEVERITY_INFO));
+    LOG_DEBUG("below " << evaluate());
+    LOG_INFO("below " << evaluate());
+    REQUIRE(evaluated == 1);
+    LOG_WARNING("open " << evaluate());
+    REQUIRE(evaluated == 2);
+    REQUIRE(sink->last() == "open 2");
+
+    reset_logger();
+    LOG_DEBUG("closed again " << evaluate());
+    REQUIRE(evaluated == 3);
+}
+
+TEST_CASE("log ring keeps the order of every thread", "[log]")
+{
+    auto sink = open_sink(RS2_LOG_SEVERITY_INFO);
+    const int threads = 4, messages = 2000;
+
+    std::vector<std::thread> loggers;
+    for (int t = 0; t < threads; t++)
+    {
+        loggers.emplace_back([t]()
+        {
+            for (int i = 0; i < messages; i++)
+                LOG_INFO(t << " " << i);
+        });
+    }
+    for (auto&& l : loggers)
+        l.join();
+
+    auto all = sink->messages();
+    REQUIRE(all.size() == threads * messages);
+    std::vector<int> next(threads, 0);
+    for (auto&& m : all)
+    {
+        std::istringstream in(m);
+        int t, i;
+        in >> t >> i;
+        REQUIRE(i == next[t]);
+        next[t]++;
+    }
+
+    reset_logger();
+}
+
+TEST_CASE("log ring waits for room instead of dropping messages", "[log]")
+{
+    std::mutex mutex;
+    std::vector<std::string> dispatched;
+    log_ring ring([&](const log_entry& entry, const std::string& message)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(10));
+        std::lock_guard<std::mutex> lock(mutex);
+        dispatched.push_back(message);
+    }, 4);
+
+    // Before start, on the spot
+    log_entry entry = {};
+    entry.text = new std::string("first");
+    ring.push(entry);
+    REQUIRE(dispatched.size() == 1);
+    delete entry.text;
+
+    ring.start();
+    std::vector<std::thread> producers;
+    for (int t = 0; t < 2; t++)
+    {
+        producers.emplace_back([&ring, t]()
+        {
+            for (int i = 0; i < 500; i++)
+            {
+                log_entry e = {};
+                e.severity = RS2_LOG_SEVERITY_INFO;
+                e.text = new std::string(std::to_string(t * 1000 + i));
+                ring.push(e);
+                delete e.text;
+            }
+        });
+    }
+    for (auto&& p : producers)
+        p.join();
+    ring.flush();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    REQUIRE(dispatched.size() == 1001);
+}
+
+TEST_CASE("logging benchmark", "[.][benchmark]")
+{
+    const int messages = 102400;
+    const int frames = 300;
+    auto sink = std::make_shared<message_sink>();
+
+    // The message frame_archive logs as a frame callback ends
+    auto log_frame = [](int i)
+    {
+        LOG_DEBUG("CallbackFinished," << rs2_stream_to_string(RS2_STREAM_DEPTH) << "," << std::dec << i << ",DispatchedAt," << 1234.5 + i);
+    };
+    auto log_frame_in_place = [](int i)
+    {
+        CLOG(DEBUG, "librealsense") << "CallbackFinished," << rs2_stream_to_string(RS2_STREAM_DEPTH) << "," << std::dec << i << ",DispatchedAt," << 1234.5 + i;
+    };
+
+    // Frames of a software depth sensor through a syncer, which logs on each of them
+    auto stream_frames = [&]()
+    {
+        rs2::software_device dev;
+        auto sensor = dev.add_sensor("Stereo Module");
+        rs2_intrinsics intrin = { 640, 480, 320, 240, 400, 400, RS2_DISTORTION_BROWN_CONRADY, { 0 } };
+        auto depth = sensor.add_video_stream({ RS2_STREAM_DEPTH, 0, 0, 640, 480, 30, 2, RS2_FORMAT_Z16, intrin });
+        auto ir = sensor.add_video_stream({ RS2_STREAM_INFRARED, 1, 1, 640, 480, 30, 1, RS2_FORMAT_Y8, intrin });
+        sensor.open({ depth, ir });
+        rs2::syncer sync;
+        sensor.start(sync);
+
+        std::vector<uint8_t> pixels(640 * 480 * 2);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < frames; i++)
+        {
+            sensor.on_video_frame({ pixels.data(), [](void*) {}, 640 * 2, 2, i * 33., RS2_TIMESTAMP_DOMAIN_HARDWARE_CLOCK, i, depth });
+            sensor.on_video_frame({ pixels.data(), [](void*) {}, 640, 1, i * 33., RS2_TIMESTAMP_DOMAIN_HARDWARE_CLOCK, i, ir });
+            sync.wait_for_frames();
+        }
+        auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / frames;
+        sensor.stop();
+        sensor.close();
+        return elapsed;
+    };
+
+    // In bursts the ring has room for, the time the logging thread takes, and the time until the sinks have them
+    auto time = [&](std::function<void(int)> f)
+    {
+        const int burst = 512;
+        double logged = 0, dispatched = 0;
+        for (int i = 0; i < messages; i += burst)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (int j = i; j < i + burst; j++)
+                f(j);
+            logged += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            flush_log();
+            dispatched += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        }
+        return std::make_pair(logged / messages, dispatched / messages);
+    };
+
+    std::cout << std::left << std::setw(34) << "debug messages" << std::setw(18) << "ns to log" << std::setw(18) << "ns to dispatch" << std::endl;
+    // Below every sink; with none open at all, messages go to easylogging on the spot
+    reset_logger();
+    log_to_callback(RS2_LOG_SEVERITY_ERROR, sink);
+    auto off = time(log_frame);
+    std::cout << std::setw(34) << "off" << std::setw(18) << std::setprecision(3) << off.first << std::setw(18) << off.second << std::endl;
+
+    log_to_callback(RS2_LOG_SEVERITY_DEBUG, sink);
+    auto ring = time(log_frame);
+    std::cout << std::setw(34) << "on, log ring" << std::setw(18) << ring.first << std::setw(18) << ring.second << std::endl;
+    auto in_place = time(log_frame_in_place);
+    std::cout << std::setw(34) << "on, formatted by the caller" << std::setw(18) << in_place.first << std::setw(18) << in_place.second << std::endl;
+
+    std::cout << std::endl << std::setw(34) << "640x480 depth and infrared" << "us per frameset" << std::endl;
+    open_sink(RS2_LOG_SEVERITY_ERROR);
+    std::cout << std::setw(34) << "debug off" << stream_frames() << std::endl;
+    log_to_callback(RS2_LOG_SEVERITY_DEBUG, sink);
+    std::cout << std::setw(34) << "debug on" << stream_frames() << std::endl;
+    reset_logger();
+}
@@ -0,0 +1,220 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "catch/catch.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <thread>
+#include <vector>
+#include "./../src/ipDeviceCommon/MemoryPool.h"
+
+namespace
+{
+    // The pool as it was: POOL_SIZE buffers of the largest frame, allocated up front, behind a mutex
+    class locked_pool
+    {
+    public:
+        locked_pool()
+        {
+            for(int i = 0; i < POOL_SIZE; i++)
+                _pool.push(new unsigned char[sizeof(RsFrameHeader) + MAX_FRAME_SIZE]);
+        }
+
+        ~locked_pool()
+        {
+            while(!_pool.empty())
+            {
+                delete[] _pool.front();
+                _pool.pop();
+            }
+        }
+
+        unsigned char* getNextMem(size_t)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if(_pool.empty())
+                return nullptr;
+            auto mem = _pool.front();
+            _pool.pop();
+            return mem;
+        }
+
+        void returnMem(unsigned char* mem)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _pool.push(mem);
+        }
+
+    private:
+        std::queue<unsigned char*> _pool;
+        std::mutex _mutex;
+    };
+}
+
+TEST_CASE("memory pool rounds buffers up to a quarter of their size", "[memory-pool]")
+{
+    for(size_t size : { 1, 100, 4096, 4097, 5000, 424 * 240 * 2, 640 * 480 * 2 + 256, 1280 * 720 * 3 + 256 })
+    {
+        CAPTURE(size);
+        auto rounded = MemoryPool::bufferSize(size);
+        REQUIRE(rounded >= size);
+        REQUIRE(rounded >= POOL_MIN_SIZE);
+        if(size > POOL_MIN_SIZE)
+            REQUIRE(rounded <= size + size / 4);
+        REQUIRE(MemoryPool::bufferSize(rounded) == rounded);
+    }
+
+    MemoryPool pool;
+    std::vector<unsigned char*> buffers;
+    for(size_t size : { 1, 5000, 1280 * 720 * 3 + 256 })
+    {
+        auto mem = pool.getNextMem(size);
+        REQUIRE(mem);
+        REQUIRE(reinterpret_cast<uintptr_t>(mem) % 16 == 0);
+        memset(mem, 0xab, MemoryPool::bufferSize(size));
+        buffers.push_back(mem);
+    }
+    for(auto mem : buffers)
+        pool.returnMem(mem);
+}
+
+TEST_CASE("memory pool reuses the buffers of each size", "[memory-pool]")
+{
+    MemoryPool pool(4);
+    const size_t depth = 848 * 480 * 2 + sizeof(RsFrameHeader), color = 848 * 480 * 3 + sizeof(RsFrameHeader);
+
+    auto a = pool.getNextMem(depth);
+    pool.returnMem(a);
+    REQUIRE(pool.getNextMem(depth) == a);
+    auto b = pool.getNextMem(color);
+    REQUIRE(b != a);
+    auto stats = pool.getStats();
+    REQUIRE(stats.inUse == 2);
+    REQUIRE(stats.hits == 1);
+    REQUIRE(stats.misses == 2);
+
+    // Up to its capacity at a time
+    auto c = pool.getNextMem(depth);
+    auto d = pool.getNextMem(depth);
+    REQUIRE(c);
+    REQUIRE(d);
+    REQUIRE(!pool.getNextMem(depth));
+    REQUIRE(!pool.getNextMem(1));
+    stats = pool.getStats();
+    REQUIRE(stats.inUse == 4);
+    REQUIRE(stats.peakInUse == 4);
+    REQUIRE(stats.exhausted == 2);
+
+    pool.returnMem(c);
+    REQUIRE(pool.getNextMem(depth) == c);
+    for(auto mem : { a, b, c, d })
+        pool.returnMem(mem);
+    REQUIRE(pool.getStats().inUse == 0);
+
+    // Keeping POOL_FREE_SLOTS of each, freeing the rest
+    MemoryPool large;
+    std::vector<unsigned char*> buffers;
+    for(int i = 0; i < POOL_FREE_SLOTS + 3; i++)
+        buffers.push_back(large.getNextMem(depth));
+    for(auto mem : buffers)
+        large.returnMem(mem);
+    stats = large.getStats();
+    REQUIRE(stats.released == 3);
+    REQUIRE(stats.misses == POOL_FREE_SLOTS + 3);
+}
+
+TEST_CASE("memory pool hands each buffer to one thread at a time", "[memory-pool]")
+{
+    const int threads = 6, rounds = 20000;
+    MemoryPool pool(threads * 3);
+    std::atomic<long long> taken(0), shared(0), refused(0);
+
+    std::vector<std::thread> workers;
+    for(int t = 0; t < threads; t++)
+    {
+        workers.emplace_back([&, t]()
+        {
+            std::mt19937 rng(t);
+            std::vector<unsigned char*> held;
+            for(int i = 0; i < rounds; i++)
+            {
+                if(held.size() < 3 && (held.empty() || rng() % 2))
+                {
+                    size_t size = 4096 << (rng() % 3);
+                    auto mem = pool.getNextMem(size);
+                    if(!mem)
+                    {
+                        refused++;
+                        continue;
+                    }
+                    memset(mem, t, 64);
+                    mem[size - 1] = static_cast<unsigned char>(t);
+                    held.push_back(mem);
+                    taken++;
+                }
+                else
+                {
+                    auto mem = held.back();
+                    held.pop_back();
+                    for(int j = 0; j < 64; j++)
+                        if(mem[j] != t)
+                            shared++;
+                    pool.returnMem(mem);
+                }
+            }
+            for(auto mem : held)
+                pool.returnMem(mem);
+        });
+    }
+    for(auto&& w : workers)
+        w.join();
+
+    REQUIRE(shared == 0);
+    REQUIRE(refused == 0);
+    auto stats = pool.getStats();
+    REQUIRE(stats.inUse == 0);
+    REQUIRE(stats.exhausted == 0);
+    REQUIRE(stats.peakInUse <= threads * 3);
+    REQUIRE(stats.hits + stats.misses == taken);
+}
+
+TEST_CASE("memory pool benchmark", "[.][benchmark]")
+{
+    const int rounds = 200000;
+    const size_t frame = 848 * 480 * 2 + sizeof(RsFrameHeader);
+
+    // Each thread takes a frame's buffer and gives it back, as the sink and the frames it injects do
+    auto run = [&](int threads, bool lock_free)
+    {
+        locked_pool locked;
+        MemoryPool pool;
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for(int t = 0; t < threads; t++)
+        {
+            workers.emplace_back([&]()
+            {
+                for(int i = 0; i < rounds; i++)
+                {
+                    if(lock_free)
+                        pool.returnMem(pool.getNextMem(frame));
+                    else
+                        locked.returnMem(locked.getNextMem(frame));
+                }
+            });
+        }
+        for(auto&& w : workers)
+            w.join();
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / rounds / threads;
+    };
+
+    std::cout << std::left << std::setw(10) << "threads" << std::setw(24) << "mutex queue ns" << "lock-free ns" << std::endl;
+    for(int threads : { 1, 2, 4 })
+        std::cout << std::setw(10) << threads << std::setw(24) << std::setprecision(3) << run(threads, false) << run(threads, true) << std::endl;
+}
@@ -0,0 +1,458 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "catch/catch.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include "./../src/proc/mjpeg-decoder.h"
+
+#define STB_IMAGE_STATIC
+#define STB_IMAGE_IMPLEMENTATION
+#include "./../third-party/stb_image.h"
+#define STB_IMAGE_WRITE_STATIC
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "./../third-party/stb_image_write.h"
+
+using namespace librealsense;
+
+namespace
+{
+    std::vector<uint8_t> make_rgb(int width, int height)
+    {
+        std::vector<uint8_t> rgb(width * height * 3);
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                auto p = &rgb[(y * width + x) * 3];
+                p[0] = static_cast<uint8_t>(x * 255 / width);
+                p[1] = static_cast<uint8_t>(y * 255 / height);
+                p[2] = static_cast<uint8_t>(((x / 8) ^ (y / 8)) & 1 ? 200 : 40);
+            }
+        }
+        return rgb;
+    }
+
+    // stb_image_write subsamples the chroma 2x2 up to quality 90, and not above
+    std::vector<uint8_t> encode_jpeg(int width, int height, int quality)
+    {
+        auto rgb = make_rgb(width, height);
+        std::vector<uint8_t> jpeg;
+        stbi_write_jpg_to_func([](void* context, void* data, int size) {
+            auto out = static_cast<std::vector<uint8_t>*>(context);
+            out->insert(out->end(), static_cast<uint8_t*>(data), static_cast<uint8_t*>(data) + size);
+        }, &jpeg, width, height, 3, rgb.data(), quality);
+        return jpeg;
+    }
+
+    const int zigzag[64] = {
+        0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18, 11, 4, 5, 12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28,
+        35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51, 58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63,
+    };
+
+    // A baseline encoder for what stb_image_write does not write: 4:2:2 chroma (h = 2, v = 1) and
+    // restart markers every restart_interval MCUs. The tables are those of stb_image_write at quality
+    class jpeg_encoder
+    {
+    public:
+        jpeg_encoder(int quality)
+        {
+            // Takes the DQT and DHT segments of a frame stb_image_write encoded, and the codes of its tables
+            auto jpeg = encode_jpeg(16, 16, quality);
+            for (size_t p = 2; p + 4 <= jpeg.size() && jpeg[p + 1] != 0xDA; )
+            {
+                size_t length = jpeg[p + 2] << 8 | jpeg[p + 3];
+                auto segment = jpeg.begin() + p;
+                if (jpeg[p + 1] == 0xDB || jpeg[p + 1] == 0xC4)
+                    _tables.insert(_tables.end(), segment, segment + 2 + length);
+                for (size_t q = p + 4; q < p + 2 + length; )
+                {
+                    if (jpeg[p + 1] == 0xDB)
+                    {
+                        std::copy(&jpeg[q + 1], &jpeg[q + 65], _quant[jpeg[q] & 1]);
+                        q += 65;
+                    }
+                    else if (jpeg[p + 1] == 0xC4)
+                    {
+                        int count = 0;
+                        for (int i = 0; i < 16; i++)
+                            count += jpeg[q + 1 + i];
+                        auto& table = (jpeg[q] >> 4 ? _ac : _dc)[jpeg[q] & 1];
+                        for (int length = 1, code = 0, k = 0; length <= 16; length++, code <<= 1)
+                        {
+                            for (int i = 0; i < jpeg[q + length]; i++, k++, code++)
+                                table[jpeg[q + 17 + k]] = { code, length };
+                        }
+                        q += 17 + count;
+                    }
+                    else
+                        break;
+                }
+                p += 2 + length;
+            }
+        }
+
+        std::vector<uint8_t> encode(const std::vector<uint8_t>& rgb, int width, int height, int h, int v, int restart_interval)
+        {
+            _out.clear();
+            _bits = _bit_count = 0;
+            put_u16(0xFFD8);
+            _out.insert(_out.end(), _tables.begin(), _tables.end());
+            const uint8_t sof[] = { 0xFF, 0xC0, 0, 17, 8, uint8_t(height >> 8), uint8_t(height), uint8_t(width >> 8), uint8_t(width),
+                3, 1, uint8_t(h << 4 | v), 0, 2, 0x11, 1, 3, 0x11, 1 };
+            _out.insert(_out.end(), std::begin(sof), std::end(sof));
+            if (restart_interval)
+            {
+                const uint8_t dri[] = { 0xFF, 0xDD, 0, 4, uint8_t(restart_interval >> 8), uint8_t(restart_interval) };
+                _out.insert(_out.end(), std::begin(dri), std::end(dri));
+            }
+            const uint8_t sos[] = { 0xFF, 0xDA, 0, 12, 3, 1, 0x00, 2, 0x11, 3, 0x11, 0, 63, 0 };
+            _out.insert(_out.end(), std::begin(sos), std::end(sos));
+
+            // JFIF YCbCr, the chroma averaged over each h x v pixels
+            std::vector<float> planes[3];
+            for (auto& plane : planes)
+                plane.resize(width * height);
+            for (int i = 0; i < width * height; i++)
+            {
+                float r = rgb[i * 3], g = rgb[i * 3 + 1], b = rgb[i * 3 + 2];
+                planes[0][i] = 0.299f * r + 0.587f * g + 0.114f * b;
+                planes[1][i] = -0.168736f * r - 0.331264f * g + 0.5f * b + 128;
+                planes[2][i] = 0.5f * r - 0.418688f * g - 0.081312f * b + 128;
+            }
+
+            const int mcus_x = (width + 8 * h - 1) / (8 * h), mcus_y = (height + 8 * v - 1) / (8 * v);
+            int predictors[3] = {}, mcu = 0;
+            for (int my = 0; my < mcus_y; my++)
+            {
+                for (int mx = 0; mx < mcus_x; mx++, mcu++)
+                {
+                    if (restart_interval && mcu && mcu % restart_interval == 0)
+                    {
+                        flush();
+                        put_u16(0xFFD0 + (mcu / restart_interval - 1) % 8);
+                        predictors[0] = predictors[1] = predictors[2] = 0;
+                    }
+                    for (int by = 0; by < v; by++)
+                        for (int bx = 0; bx < h; bx++)
+                            encode_block(planes[0], width, height, (mx * h + bx) * 8, (my * v + by) * 8, 1, 1, 0, predictors[0]);
+                    for (int c = 1; c < 3; c++)
+                        encode_block(planes[c], width, height, mx * h * 8, my * v * 8, h, v, 1, predictors[c]);
+                }
+            }
+            flush();
+            put_u16(0xFFD9);
+            return _out;
+        }
+
+    private:
+        struct code { int bits, length; };
+
+        void put_u16(int value)
+        {
+            _out.push_back(uint8_t(value >> 8));
+            _out.push_back(uint8_t(value));
+        }
+
+        void put_bits(int bits, int length)
+        {
+            for (int i = length - 1; i >= 0; i--)
+            {
+                _bits = _bits << 1 | (bits >> i & 1);
+                if (++_bit_count == 8)
+                {
+                    _out.push_back(uint8_t(_bits));
+                    if (_bits == 0xFF)
+                        _out.push_back(0);
+                    _bits = _bit_count = 0;
+                }
+            }
+        }
+
+        // Pads the last byte with ones
+        void flush()
+        {
+            while (_bit_count)
+                put_bits(1, 1);
+        }
+
+        static int category(int value)
+        {
+            int bits = 0;
+            for (value = std::abs(value); value; value >>= 1)
+                bits++;
+            return bits;
+        }
+
+        void put_value(int value, int bits)
+        {
+            put_bits(value < 0 ? value + (1 << bits) - 1 : value, bits);
+        }
+
+        // The block at x, y of the plane, taking the average of each sx x sy pixels, edges repeated
+        void encode_block(const std::vector<float>& plane, int width, int height, int x, int y, int sx, int sy, int table, int& predictor)
+        {
+            float pixels[64];
+            for (int j = 0; j < 8; j++)
+            {
+                for (int i = 0; i < 8; i++)
+                {
+                    float sum = 0;
+                    for (int dy = 0; dy < sy; dy++)
+                        for (int dx = 0; dx < sx; dx++)
+                            sum += plane[std::min((y / sy + j) * sy + dy, height - 1) * width + std::min((x / sx + i) * sx + dx, width - 1)];
+                    pixels[j * 8 + i] = sum / (sx * sy) - 128;
+                }
+            }
+
+            const double pi = std::acos(-1.0);
+            int coefficients[64];
+            for (int u = 0; u < 8; u++)
+            {
+                for (int w = 0; w < 8; w++)
+                {
+                    double sum = 0;
+                    for (int j = 0; j < 8; j++)
+                        for (int i = 0; i < 8; i++)
+                            sum += pixels[j * 8 + i] * std::cos((2 * i + 1) * w * pi / 16) * std::cos((2 * j + 1) * u * pi / 16);
+                    sum *= (w ? 0.5 : std::sqrt(0.125)) * (u ? 0.5 : std::sqrt(0.125));
+                    coefficients[u * 8 + w] = int(std::lround(sum));
+                }
+            }
+
+            int quantized[64];
+            for (int k = 0; k < 64; k++)
+                quantized[k] = int(std::lround(double(coefficients[zigzag[k]]) / _quant[table][k]));
+
+            int difference = quantized[0] - predictor;
+            predictor = quantized[0];
+            auto dc = _dc[table][category(difference)];
+            put_bits(dc.bits, dc.length);
+            put_value(difference, category(difference));
+
+            int run = 0;
+            for (int k = 1; k < 64; k++)
+            {
+                if (!quantized[k])
+                {
+                    run++;
+                    continue;
+                }
+                for (; run > 15; run -= 16)
+                    put_bits(_ac[table][0xF0].bits, _ac[table][0xF0].length);
+                int bits = category(quantized[k]);
+                auto ac = _ac[table][run << 4 | bits];
+                put_bits(ac.bits, ac.length);
+                put_value(quantized[k], bits);
+                run = 0;
+            }
+            if (run)
+                put_bits(_ac[table][0].bits, _ac[table][0].length);
+        }
+
+        std::vector<uint8_t> _tables;
+        uint8_t _quant[2][64];
+        code _dc[2][256], _ac[2][256];
+
+        std::vector<uint8_t> _out;
+        int _bits, _bit_count;
+    };
+
+    // The largest and the mean difference of decoded RGB to what stb_image decodes of jpeg
+    std::pair<int, double> difference_to_reference(const std::vector<uint8_t>& jpeg, const std::vector<uint8_t>& decoded, int width, int height)
+    {
+        int w, h, components;
+        auto reference = stbi_load_from_memory(jpeg.data(), static_cast<int>(jpeg.size()), &w, &h, &components, 3);
+        REQUIRE(reference);
+        int max_difference = 0;
+        double total_difference = 0;
+        for (int i = 0; i < width * height * 3; i++)
+        {
+            int difference = std::abs(decoded[i] - reference[i]);
+            max_difference = std::max(max_difference, difference);
+            total_difference += difference;
+        }
+        stbi_image_free(reference);
+        return { max_difference, total_difference / (width * height * 3) };
+    }
+
+    struct format_info { rs2_format format; int channels; bool bgr; };
+    const format_info formats[] = {
+        { RS2_FORMAT_RGB8, 3, false },
+        { RS2_FORMAT_BGR8, 3, true },
+        { RS2_FORMAT_RGBA8, 4, false },
+        { RS2_FORMAT_BGRA8, 4, true },
+        { RS2_FORMAT_Y8, 1, false },
+    };
+}
+
+TEST_CASE("mjpeg_decoder matches the reference decoder", "[code]")
+{
+    mjpeg_decoder decoder(false);
+
+    for (auto size : { std::make_pair(96, 64), std::make_pair(37, 23), std::make_pair(640, 480) })
+    {
+        int width = size.first, height = size.second;
+        for (int quality : { 95, 80 })
+        {
+            CAPTURE(width);
+            CAPTURE(height);
+            CAPTURE(quality);
+            auto jpeg = encode_jpeg(width, height, quality);
+
+            for (auto& info : formats)
+            {
+                CAPTURE(info.format);
+                int w, h, components;
+                auto reference = stbi_load_from_memory(jpeg.data(), static_cast<int>(jpeg.size()), &w, &h, &components, info.channels == 1 ? 1 : 3);
+                REQUIRE(reference);
+
+                std::vector<uint8_t> out(width * height * info.channels + 1, 0x5a);
+                REQUIRE(decoder.decode(jpeg.data(), static_cast<int>(jpeg.size()), info.format, out.data(), width, height, 0));
+                REQUIRE(out.back() == 0x5a);
+
+                // Luma is exact; the colors round differently, and 4:2:0 chroma is not interpolated vertically
+                int max_difference = 0;
+                double total_difference = 0;
+                bool opaque = true;
+                for (int i = 0; i < width * height; i++)
+                {
+                    for (int c = 0; c < std::min(info.channels, 3); c++)
+                    {
+                        int expected = reference[i * (info.channels == 1 ? 1 : 3) + (info.bgr ? 2 - c : c)];
+                        int difference = std::abs(out[i * info.channels + c] - expected);
+                        max_difference = std::max(max_difference, difference);
+                        total_difference += difference;
+                    }
+                    if (info.channels == 4)
+                        opaque &= out[i * 4 + 3] == 255;
+                }
+                stbi_image_free(reference);
+                REQUIRE(opaque);
+
+                if (info.channels == 1)
+                    REQUIRE(max_difference == 0);
+                else if (quality > 90)
+                    REQUIRE(max_difference <= 1);
+                else
+                    REQUIRE(total_difference / (width * height * 3) < 2.0);
+            }
+        }
+    }
+}
+
+TEST_CASE("mjpeg_decoder turns down frames it cannot decode", "[code]")
+{
+    mjpeg_decoder decoder(false);
+    auto jpeg = encode_jpeg(64, 48, 90);
+    std::vector<uint8_t> out(64 * 48 * 3);
+
+    REQUIRE(decoder.decode(jpeg.data(), static_cast<int>(jpeg.size()), RS2_FORMAT_RGB8, out.data(), 64, 48, 0));
+
+    // Not the size of the stream
+    REQUIRE_FALSE(decoder.decode(jpeg.data(), static_cast<int>(jpeg.size()), RS2_FORMAT_RGB8, out.data(), 32, 48, 0));
+    // Not a color format
+    REQUIRE_FALSE(decoder.decode(jpeg.data(), static_cast<int>(jpeg.size()), RS2_FORMAT_Z16, out.data(), 64, 48, 0));
+    // Headers cut short
+    REQUIRE_FALSE(decoder.decode(jpeg.data(), 100, RS2_FORMAT_RGB8, out.data(), 64, 48, 0));
+    // Not a JPEG
+    std::vector<uint8_t> garbage(jpeg.size(), 0x42);
+    REQUIRE_FALSE(decoder.decode(garbage.data(), static_cast<int>(garbage.size()), RS2_FORMAT_RGB8, out.data(), 64, 48, 0));
+
+    // Progressive frames are left to the reference decoder
+    auto sof = std::search_n(jpeg.begin(), jpeg.end(), 1, 0xC0);
+    while (sof != jpeg.end() && *(sof - 1) != 0xFF)
+        sof = std::search_n(sof + 1, jpeg.end(), 1, 0xC0);
+    REQUIRE(sof != jpeg.end());
+    *sof = 0xC2;
+    REQUIRE_FALSE(decoder.decode(jpeg.data(), static_cast<int>(jpeg.size()), RS2_FORMAT_RGB8, out.data(), 64, 48, 0));
+}
+
+TEST_CASE("mjpeg_decoder decodes 4:2:2 chroma", "[code]")
+{
+    mjpeg_decoder decoder(false);
+    jpeg_encoder encoder(95);
+
+    for (auto size : { std::make_pair(96, 64), std::make_pair(37, 23) })
+    {
+        int width = size.first, height = size.second;
+        CAPTURE(width);
+        CAPTURE(height);
+        auto jpeg = encoder.encode(make_rgb(width, height), width, height, 2, 1, 0);
+
+        std::vector<uint8_t> out(width * height * 3 + 1, 0x5a);
+        REQUIRE(decoder.decode(jpeg.data(), static_cast<int>(jpeg.size()), RS2_FORMAT_RGB8, out.data(), width, height, 0));
+        REQUIRE(out.back() == 0x5a);
+
+        // Both upsample the chroma as libjpeg does, rounding some of it one apart
+        auto difference = difference_to_reference(jpeg, out, width, height);
+        REQUIRE(difference.first <= 3);
+        REQUIRE(difference.second < 0.5);
+    }
+}
+
+TEST_CASE("mjpeg_decoder gives the same frames split into bands at restart markers", "[code]")
+{
+    mjpeg_decoder decoder(false);
+    jpeg_encoder encoder(95);
+    const int width = 640, height = 480;
+    auto rgb = make_rgb(width, height);
+
+    // Sampling as h, v, and restart intervals of one MCU row, of a few rows, and off the MCU rows
+    for (auto sampling : { std::make_pair(1, 1), std::make_pair(2, 1), std::make_pair(2, 2) })
+    {
+        int h = sampling.first, v = sampling.second;
+        const int mcus_x = width / (8 * h);
+        for (int restart_interval : { mcus_x, mcus_x * 3, 7, 113 })
+        {
+            CAPTURE(h);
+            CAPTURE(v);
+            CAPTURE(restart_interval);
+            auto jpeg = encoder.encode(rgb, width, height, h, v, restart_interval);
+
+            std::vector<uint8_t> serial(width * height * 3, 0);
+            REQUIRE(decoder.decode(jpeg.data(), static_cast<int>(jpeg.size()), RS2_FORMAT_RGB8, serial.data(), width, height, 1));
+            // Each band is decoded alone, so the chroma rows of 4:2:0 are repeated where stb_image interpolates them
+            auto difference = difference_to_reference(jpeg, serial, width, height);
+            if (v == 1)
+                REQUIRE(difference.first <= 3);
+            REQUIRE(difference.second < (v == 1 ? 2.0 : 4.0));
+
+            for (unsigned int workers : { 0u, 3u })
+            {
+                CAPTURE(workers);
+                std::vector<uint8_t> banded(width * height * 3, 0);
+                REQUIRE(decoder.decode(jpeg.data(), static_cast<int>(jpeg.size()), RS2_FORMAT_RGB8, banded.data(), width, height, workers));
+                REQUIRE(banded == serial);
+            }
+        }
+    }
+}
+
+TEST_CASE("mjpeg_decoder takes the tables of each frame", "[code]")
+{
+    mjpeg_decoder decoder(false);
+    auto fine = encode_jpeg(64, 48, 95);
+    auto coarse = encode_jpeg(64, 48, 50);
+    std::vector<uint8_t> out(64 * 48 * 3), expected(64 * 48 * 3);
+
+    // Of a decoder that saw no frame before
+    REQUIRE(mjpeg_decoder(false).decode(coarse.data(), static_cast<int>(coarse.size()), RS2_FORMAT_RGB8, expected.data(), 64, 48, 0));
+    REQUIRE(decoder.decode(fine.data(), static_cast<int>(fine.size()), RS2_FORMAT_RGB8, out.data(), 64, 48, 0));
+    REQUIRE(decoder.decode(coarse.data(), static_cast<int>(coarse.size()), RS2_FORMAT_RGB8, out.data(), 64, 48, 0));
+    REQUIRE(out == expected);
+
+    // A frame without quantization tables does not take those of the frame before it
+    std::vector<uint8_t> no_dqt(coarse.begin(), coarse.begin() + 2);
+    for (size_t p = 2; p < coarse.size(); )
+    {
+        size_t end = coarse[p + 1] == 0xDA ? coarse.size() : p + 2 + (coarse[p + 2] << 8 | coarse[p + 3]);
+        if (coarse[p + 1] != 0xDB)
+            no_dqt.insert(no_dqt.end(), coarse.begin() + p, coarse.begin() + end);
+        p = end;
+    }
+    REQUIRE(no_dqt.size() < coarse.size());
+    REQUIRE_FALSE(decoder.decode(no_dqt.data(), static_cast<int>(no_dqt.size()), RS2_FORMAT_RGB8, out.data(), 64, 48, 0));
+}
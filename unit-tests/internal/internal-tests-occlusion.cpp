@@ -0,0 +1,274 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "catch/catch.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "internal-tests-common.h"
+#include "./../src/proc/occlusion-filter.h"
+
+using namespace librealsense;
+
+namespace
+{
+    // What the pointcloud hands the filter: vertices and their pixels on a texture of a camera beside
+    // the depth camera, the near pixels shifted further than the far ones, on a quarter pixel grid so
+    // that pixels meet on the same texture x
+    struct mapped_frame
+    {
+        std::vector<float3> points;
+        std::vector<float2> pixels;
+        std::vector<float2> uv;
+
+        mapped_frame(const rs2::depth_frame& depth)
+        {
+            const int width = depth.get_width(), height = depth.get_height();
+            auto data = static_cast<const uint16_t*>(depth.get_data());
+            for (int y = 0; y < height; y++)
+            {
+                for (int x = 0; x < width; x++)
+                {
+                    float z = data[y * width + x] * 0.001f;
+                    points.push_back({ x * 0.01f, y * 0.01f, z });
+                    if (z)
+                        pixels.push_back({ std::round((x * 0.9f + 40.f / z) * 4) / 4, std::round((y * 0.9f + 30.f / z) * 4) / 4 });
+                    else
+                        pixels.push_back({ 0.f, 0.f });
+                    uv.push_back({ pixels.back().x / 200, pixels.back().y / 120 });
+                }
+            }
+        }
+    };
+
+    rs2_intrinsics make_intrinsics(int width, int height)
+    {
+        return { width, height, width / 2.f, height / 2.f, width * 0.7f, width * 0.7f, RS2_DISTORTION_BROWN_CONRADY, { 0 } };
+    }
+
+    // The filter as it was before the engine, pixel by pixel, marking what it invalidates in mask
+    void legacy_horizontal(mapped_frame& m, std::vector<uint8_t>& mask, int width, int height)
+    {
+        float occZTh = 0.1f;
+        int occDilationSz = 1;
+        auto points_ptr = m.points.data();
+        auto pixels_ptr = m.pixels.data();
+        for (int y = 0; y < height; ++y)
+        {
+            float maxInLine = -1;
+            float maxZ = 0;
+            int occDilationLeft = 0;
+            for (int x = 0; x < width; ++x, ++points_ptr, ++pixels_ptr)
+            {
+                if (points_ptr->z)
+                {
+                    if (pixels_ptr->x < maxInLine || (pixels_ptr->x == maxInLine && (points_ptr->z - maxZ) > occZTh))
+                    {
+                        *points_ptr = { 0, 0, 0 };
+                        mask[y * width + x] = 1;
+                        occDilationLeft = occDilationSz;
+                    }
+                    else
+                    {
+                        maxInLine = pixels_ptr->x;
+                        maxZ = points_ptr->z;
+                        if (occDilationLeft > 0)
+                        {
+                            *points_ptr = { 0, 0, 0 };
+                            mask[y * width + x] = 1;
+                            occDilationLeft--;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // In the coordinates of the frame rotated a quarter turn the legacy scan worked in, without the
+    // last rotated column, whose neighbour on the right lay outside the frame
+    void legacy_vertical(mapped_frame& m, std::vector<uint8_t>& mask, const uint16_t* depth, int width, int height, float depth_units)
+    {
+        auto rotated = [&](int i, int j) { return depth[(height - 1 - j) * width + (width - 1 - i)]; };
+        for (int i = 0; i < width; i++)
+        {
+            for (int j = 0; j + 1 < height; j++)
+            {
+                uint16_t diff_right = abs(rotated(i, j) - rotated(i, j + 1));
+                float scaled_threshold = 0.5f / depth_units;
+                if (diff_right > scaled_threshold && j >= 16)
+                {
+                    auto uv_index = (width - i - 1) + (height - j - 1) * width;
+                    float maxInLine = m.pixels[uv_index - width].y;
+                    for (int y = 0; y <= 16; ++y)
+                    {
+                        if (m.pixels[uv_index + y * width].y < maxInLine)
+                        {
+                            m.points[uv_index + y * width] = { 0.f, 0.f, 0.f };
+                            mask[uv_index + y * width] = 1;
+                        }
+                        else
+                            break;
+                    }
+                }
+            }
+        }
+    }
+
+    // Through a texture-sized table cleared on every frame
+    void legacy_z_buffer(mapped_frame& m, std::vector<uint8_t>& mask, size_t tex_width, size_t tex_height)
+    {
+        std::vector<float> texels(tex_width * tex_height, 0.f);
+        const float z_threshold = 0.05f;
+        auto mapped = [&](size_t i)
+        {
+            auto& p = m.pixels[i];
+            return m.points[i].z > 0.0001f && p.x > 0.f && p.x < tex_width && p.y > 0.f && p.y < tex_height;
+        };
+        auto texel = [&](size_t i) { return size_t(m.pixels[i].y) * tex_width + size_t(m.pixels[i].x); };
+
+        for (size_t i = 0; i < m.points.size(); i++)
+        {
+            if (mapped(i) && (texels[texel(i)] < 0.0001f || texels[texel(i)] + z_threshold > m.points[i].z))
+                texels[texel(i)] = m.points[i].z;
+        }
+        for (size_t i = 0; i < m.points.size(); i++)
+        {
+            if (mapped(i) && texels[texel(i)] > 0.0001f && texels[texel(i)] + z_threshold < m.points[i].z)
+            {
+                m.uv[i] = { 0.f, 0.f };
+                mask[i] = 1;
+            }
+        }
+    }
+
+    void legacy_filter(mapped_frame& m, std::vector<uint8_t>& mask, const rs2::depth_frame& depth, int mode, const rs2_intrinsics& texture)
+    {
+        const int width = depth.get_width(), height = depth.get_height();
+        if (mode == 0)
+            legacy_horizontal(m, mask, width, height);
+        else if (mode == 1)
+            legacy_vertical(m, mask, static_cast<const uint16_t*>(depth.get_data()), width, height, 0.001f);
+        else
+            legacy_z_buffer(m, mask, texture.width, texture.height);
+    }
+
+    void set_mode(occlusion_filter& filter, int mode)
+    {
+        filter.set_mode(mode < 2 ? occlusion_monotonic_scan : occlusion_z_buffer);
+        filter.set_scanning(mode == 1 ? vertical : horizontal);
+    }
+
+    const char* modes[] = { "horizontal scan", "vertical scan", "z-buffer" };
+}
+
+TEST_CASE("occlusion filter invalidates what it did pixel by pixel", "[code]")
+{
+    // Frames too short for the vertical window, and rows shorter than the vector scans
+    for (auto size : { std::make_pair(181, 97), std::make_pair(64, 48), std::make_pair(7, 5), std::make_pair(1, 20) })
+    {
+        depth_source source(size.first, size.second, false);
+        for (int mode = 0; mode < 3; mode++)
+        {
+            for (unsigned int threads : { 1u, 0u })
+            {
+                // A texture the pixels fall off of, whose size the tiles do not divide
+                auto texture = make_intrinsics(200, 120);
+                occlusion_filter filter;
+                filter.set_depth_intrinsics(make_intrinsics(size.first, size.second));
+                filter.set_texel_intrinsics(texture);
+                filter.set_depth_units(0.001f);
+                set_mode(filter, mode);
+
+                // The z-buffer is kept from frame to frame
+                for (int i = 0; i < 3; i++)
+                {
+                    CAPTURE(size.first);
+                    CAPTURE(size.second);
+                    CAPTURE(modes[mode]);
+                    CAPTURE(threads);
+                    CAPTURE(i);
+                    auto depth = source.next(0.05f).as<rs2::depth_frame>();
+                    mapped_frame expected(depth), actual(depth);
+                    std::vector<uint8_t> expected_mask(expected.points.size()), mask(expected.points.size(), 7);
+                    legacy_filter(expected, expected_mask, depth, mode, texture);
+                    filter.process(actual.points.data(), actual.uv.data(), actual.pixels, depth, mask.data(), threads);
+
+                    REQUIRE(memcmp(actual.points.data(), expected.points.data(), expected.points.size() * sizeof(float3)) == 0);
+                    REQUIRE(memcmp(actual.uv.data(), expected.uv.data(), expected.uv.size() * sizeof(float2)) == 0);
+                    REQUIRE(mask == expected_mask);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("pointcloud outputs the occlusion mask along with the points", "[code]")
+{
+    depth_source source(64, 48, false);
+    auto depth = source.next(0.05f);
+    rs2::pointcloud pc;
+    REQUIRE(pc.process(depth).is<rs2::points>());
+
+    pc.set_option(RS2_OPTION_OCCLUSION_MASK, 1.f);
+    auto set = pc.process(depth).as<rs2::frameset>();
+    REQUIRE(set);
+    REQUIRE(set.size() == 2);
+    auto mask = set.first(RS2_STREAM_DEPTH, RS2_FORMAT_Y8).as<rs2::video_frame>();
+    REQUIRE(mask.get_width() == 64);
+    REQUIRE(mask.get_height() == 48);
+
+    // Without a texture nothing is invalidated
+    std::vector<uint8_t> none(64 * 48);
+    REQUIRE(memcmp(mask.get_data(), none.data(), none.size()) == 0);
+    REQUIRE(pc.calculate(depth).size() == 64 * 48);
+}
+
+TEST_CASE("occlusion filter benchmark", "[.][benchmark]")
+{
+    const int iterations = 50;
+    benchmark_table table({ { "depth", 12 }, { "mode", 18 }, { "threads", 8 }, { "per pixel ms", 16 }, { "engine ms", 12 } });
+
+    for (auto size : { std::make_pair(848, 480), std::make_pair(1280, 720) })
+    {
+        depth_source source(size.first, size.second, false);
+        auto depth = source.next(0.05f).as<rs2::depth_frame>();
+        mapped_frame m(depth);
+        for (int mode = 0; mode < 3; mode++)
+        {
+            for (unsigned int threads : { 1u, 0u })
+            {
+                auto texture = make_intrinsics(1920, 1080);
+                occlusion_filter filter;
+                filter.set_depth_intrinsics(make_intrinsics(size.first, size.second));
+                filter.set_texel_intrinsics(texture);
+                filter.set_depth_units(0.001f);
+                set_mode(filter, mode);
+                std::vector<uint8_t> mask(m.points.size());
+
+                // Over copies of the frame, as the filter changes what it is given
+                auto time = [&](std::function<void(mapped_frame&)> f)
+                {
+                    double total = 0;
+                    for (int i = 0; i < iterations; i++)
+                    {
+                        auto copy = m;
+                        auto start = std::chrono::steady_clock::now();
+                        f(copy);
+                        total += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                    }
+                    return total / iterations;
+                };
+
+                auto per_pixel = time([&](mapped_frame& f) { legacy_filter(f, mask, depth, mode, texture); });
+                auto engine = time([&](mapped_frame& f) { filter.process(f.points.data(), f.uv.data(), f.pixels, depth, nullptr, threads); });
+
+                table.row(size_name(size.first, size.second), modes[mode], threads ? "1" : "all", per_pixel, engine);
+            }
+        }
+    }
+}
@@ -0,0 +1,166 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "catch/catch.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "./../include/librealsense2/rsutil.h"
+#include "./../src/image-simd.h"
+#include "./../src/proc/pointcloud.h"
+
+using namespace librealsense;
+
+namespace
+{
+    rs2_intrinsics make_intrinsics(int width, int height, rs2_distortion model)
+    {
+        rs2_intrinsics intrin = {};
+        intrin.width = width;
+        intrin.height = height;
+        intrin.fx = intrin.fy = width * 0.7f;
+        intrin.ppx = width / 2.f + 0.3f;
+        intrin.ppy = height / 2.f - 0.7f;
+        intrin.model = model;
+        const float brown_conrady[] = { -0.055f, 0.065f, 0.0004f, 0.0006f, -0.02f };
+        const float kannala_brandt[] = { 0.42f, -0.05f, 0.006f, -0.0004f, 0 };
+        const float ftheta[] = { 0.92f, 0, 0, 0, 0 };
+        auto coeffs = model == RS2_DISTORTION_KANNALA_BRANDT4 ? kannala_brandt : model == RS2_DISTORTION_FTHETA ? ftheta : brown_conrady;
+        if (model != RS2_DISTORTION_NONE)
+            std::copy(coeffs, coeffs + 5, intrin.coeffs);
+        return intrin;
+    }
+
+    std::vector<uint16_t> make_depth(int count, unsigned int seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> depth_value(300, 6000);
+        std::vector<uint16_t> depth(count);
+        for (int i = 0; i < count; i++)
+            depth[i] = i % 7 ? static_cast<uint16_t>(depth_value(rng)) : 0;
+        return depth;
+    }
+}
+
+TEST_CASE("pointcloud rays give the points rsutil deprojects", "[code]")
+{
+    const float depth_scale = 0.001f;
+    for (auto model : { RS2_DISTORTION_NONE, RS2_DISTORTION_BROWN_CONRADY, RS2_DISTORTION_INVERSE_BROWN_CONRADY,
+                        RS2_DISTORTION_KANNALA_BRANDT4, RS2_DISTORTION_FTHETA })
+    {
+        CAPTURE(model);
+        auto intrin = make_intrinsics(83, 47, model);
+        auto rays = depth_rays::get(intrin);
+        auto count = intrin.width * intrin.height;
+        auto depth = make_depth(count, 3);
+
+        std::vector<float> points(count * 3);
+        uint8_t* dst[] = { reinterpret_cast<uint8_t*>(points.data()) };
+        get_unpack_kernels().deproject_xyz(dst, depth.data(), rays->x.data(), rays->y.data(), count, depth_scale);
+
+        for (int y = 0, i = 0; y < intrin.height; y++)
+        {
+            for (int x = 0; x < intrin.width; x++, i++)
+            {
+                const float pixel[] = { (float)x, (float)y };
+                float expected[3];
+                rs2_deproject_pixel_to_point(expected, &intrin, pixel, depth_scale * depth[i]);
+                REQUIRE(memcmp(expected, &points[i * 3], sizeof(expected)) == 0);
+            }
+        }
+    }
+}
+
+TEST_CASE("pointcloud rays are shared until the calibration changes", "[code]")
+{
+    auto intrin = make_intrinsics(64, 48, RS2_DISTORTION_INVERSE_BROWN_CONRADY);
+    auto rays = depth_rays::get(intrin);
+    REQUIRE(depth_rays::get(intrin) == rays);
+
+    auto recalibrated = intrin;
+    recalibrated.ppx += 0.25f;
+    auto other = depth_rays::get(recalibrated);
+    REQUIRE(other != rays);
+    REQUIRE(other->x[0] != rays->x[0]);
+    REQUIRE(depth_rays::get(intrin) == rays);
+
+    // Nothing is kept once no pointcloud holds the table
+    std::weak_ptr<const depth_rays> released = other;
+    other.reset();
+    REQUIRE(released.expired());
+}
+
+TEST_CASE("pointcloud benchmark", "[.][benchmark]")
+{
+    const int iterations = 20;
+    const float depth_scale = 0.001f;
+    auto depth_intrin = make_intrinsics(1280, 720, RS2_DISTORTION_INVERSE_BROWN_CONRADY);
+    auto color_intrin = make_intrinsics(1920, 1080, RS2_DISTORTION_MODIFIED_BROWN_CONRADY);
+    rs2_extrinsics extrin = { { 0.9999f, 0.0001f, -0.0141f, -0.0001f, 1.f, 0.0002f, 0.0141f, -0.0002f, 0.9999f }, { 0.015f, 0.0001f, 0.0003f } };
+    const int count = depth_intrin.width * depth_intrin.height;
+    auto depth = make_depth(count, 5);
+    std::vector<float> points(count * 3), tex(count * 2), pixels(count * 2);
+
+    auto time = [&](std::function<void()> f)
+    {
+        f();
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++)
+            f();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+    };
+
+    // As the pointcloud did before the rays were cached: every pixel deprojected and projected on its own
+    auto per_pixel_points = time([&]() {
+        for (int y = 0, i = 0; y < depth_intrin.height; y++)
+            for (int x = 0; x < depth_intrin.width; x++, i++)
+            {
+                const float pixel[] = { (float)x, (float)y };
+                rs2_deproject_pixel_to_point(&points[i * 3], &depth_intrin, pixel, depth_scale * depth[i]);
+            }
+    });
+    auto per_pixel_texture = time([&]() {
+        for (int i = 0; i < count; i++)
+        {
+            float to[3];
+            rs2_transform_point_to_point(to, &extrin, &points[i * 3]);
+            rs2_project_point_to_pixel(&pixels[i * 2], &color_intrin, to);
+            tex[i * 2] = pixels[i * 2] / color_intrin.width;
+            tex[i * 2 + 1] = pixels[i * 2 + 1] / color_intrin.height;
+        }
+    });
+
+    std::cout << "Depth 1280x720 to 1920x1080, ms per frame" << std::endl;
+    std::cout << std::left << std::setw(12) << "kernels" << std::setw(12) << "vertices" << std::setw(12) << "planar"
+        << std::setw(12) << "half" << std::setw(12) << "texture" << std::endl;
+    std::cout << std::setw(12) << "per pixel" << std::setw(12) << std::setprecision(3) << per_pixel_points
+        << std::setw(12) << "-" << std::setw(12) << "-" << std::setw(12) << per_pixel_texture << std::endl;
+
+    auto rays = depth_rays::get(depth_intrin);
+    point_projection p = { {}, {}, color_intrin.fx, color_intrin.fy, color_intrin.ppx, color_intrin.ppy, {},
+        (float)color_intrin.width, (float)color_intrin.height, true };
+    std::copy(std::begin(extrin.rotation), std::end(extrin.rotation), p.rotation);
+    std::copy(std::begin(extrin.translation), std::end(extrin.translation), p.translation);
+    std::copy(std::begin(color_intrin.coeffs), std::end(color_intrin.coeffs), p.coeffs);
+    std::vector<uint8_t> user_buffer(count * 12);
+
+    for (auto level : { simd_level::scalar, simd_level::sse41, simd_level::avx2, simd_level::avx512, simd_level::neon })
+    {
+        unpack_kernels k;
+        if (!get_unpack_kernels(level, k))
+            continue;
+        uint8_t* xyz[] = { reinterpret_cast<uint8_t*>(points.data()) };
+        uint8_t* planar[] = { user_buffer.data(), user_buffer.data() + count * 4, user_buffer.data() + count * 8 };
+        auto vertices = time([&]() { k.deproject_xyz(xyz, depth.data(), rays->x.data(), rays->y.data(), count, depth_scale); });
+        auto planes = time([&]() { k.deproject_planar(planar, depth.data(), rays->x.data(), rays->y.data(), count, depth_scale); });
+        auto half = time([&]() { k.deproject_xyz_half(planar, depth.data(), rays->x.data(), rays->y.data(), count, depth_scale); });
+        auto texture = time([&]() { k.texture_map(tex.data(), pixels.data(), points.data(), count, p); });
+        std::cout << std::setw(12) << get_string(level) << std::setw(12) << vertices << std::setw(12) << planes
+            << std::setw(12) << half << std::setw(12) << texture << std::endl;
+    }
+}
@@ -0,0 +1,236 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "catch/catch.hpp"
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "internal-tests-common.h"
+
+namespace
+{
+    struct chain
+    {
+        const char* name;
+        int decimation;             // magnitude, 0 for none
+        bool to_disparity;
+        int spatial_iterations;     // 0 for none
+        int spatial_holes;
+        bool temporal;
+        int to_depth;               // the mode of the second transform, -1 for none
+        int hole_filling;           // mode, -1 for none
+    };
+
+    const chain chains[] = {
+        { "all, as the viewer runs them", 2, true, 2, 0, true, 0, 1 },
+        { "no decimation", 0, true, 2, 0, true, 0, 1 },
+        { "decimation 3", 3, true, 1, 0, true, 0, 2 },
+        { "decimation 4, holes filled from the left", 4, true, 2, 0, true, 0, 0 },
+        { "depth domain", 2, false, 2, 0, true, -1, 1 },
+        { "spatial hole filling in disparity", 0, true, 3, 2, true, 0, -1 },
+        { "disparity out", 2, true, 2, 3, true, -1, -1 },
+        { "disparity out, holes filled", 0, true, 0, 0, true, -1, 2 },
+        { "disparity in the middle only", 2, true, 0, 0, false, 0, 0 },
+        { "depth to disparity at the end", 2, false, 2, 0, true, 1, 1 },
+        { "disparity to depth of depth", 2, false, 2, 0, true, 0, -1 },
+        { "temporal alone", 0, false, 0, 0, true, -1, -1 },
+        { "spatial alone", 0, false, 1, 0, false, -1, -1 },
+        { "hole filling alone", 0, false, 0, 0, false, -1, 2 },
+    };
+
+    std::vector<rs2::filter> make_filters(const chain& c)
+    {
+        std::vector<rs2::filter> filters;
+        if (c.decimation)
+            filters.push_back(rs2::decimation_filter(float(c.decimation)));
+        if (c.to_disparity)
+            filters.push_back(rs2::disparity_transform(true));
+        if (c.spatial_iterations)
+            filters.push_back(rs2::spatial_filter(0.5f, 20.f, float(c.spatial_iterations), float(c.spatial_holes)));
+        if (c.temporal)
+            filters.push_back(rs2::temporal_filter(0.4f, 20.f, 3));
+        if (c.to_depth >= 0)
+            filters.push_back(rs2::disparity_transform(c.to_depth != 0));
+        if (c.hole_filling >= 0)
+            filters.push_back(rs2::hole_filling_filter(c.hole_filling));
+        return filters;
+    }
+
+    // The filters as rs2::filter, which a braced list of them would not copy to
+    template<class... F>
+    std::vector<rs2::filter> filter_list(const F&... filters)
+    {
+        return { static_cast<const rs2::filter&>(filters)... };
+    }
+
+    rs2::frame run_chain(const std::vector<rs2::filter>& filters, rs2::frame f)
+    {
+        for (auto&& filter : filters)
+            f = filter.process(f);
+        return f;
+    }
+
+    void require_same(const rs2::frame& fused, const rs2::frame& expected)
+    {
+        REQUIRE(fused);
+        REQUIRE(fused.get_profile().format() == expected.get_profile().format());
+        REQUIRE(fused.is<rs2::disparity_frame>() == expected.is<rs2::disparity_frame>());
+        auto a = fused.as<rs2::video_frame>();
+        auto b = expected.as<rs2::video_frame>();
+        REQUIRE(a.get_width() == b.get_width());
+        REQUIRE(a.get_height() == b.get_height());
+        REQUIRE(a.get_stride_in_bytes() == b.get_stride_in_bytes());
+        REQUIRE(memcmp(a.get_data(), b.get_data(), b.get_stride_in_bytes() * b.get_height()) == 0);
+    }
+}
+
+TEST_CASE("depth post-processing gives the frames of the filters one after the other", "[code]")
+{
+    for (auto stereo : { true, false })
+    {
+        for (auto&& c : chains)
+        {
+            for (float threads : { 1.f, 0.f })
+            {
+                INFO(c.name << (stereo ? "" : ", not stereo") << ", threads " << threads);
+                depth_source source(181, 97, stereo);
+                // The chain and the block share the options; the block keeps its own temporal history
+                auto filters = make_filters(c);
+                rs2::depth_post_processing post(filters);
+                post.set_option(RS2_OPTION_PROCESSING_THREADS, threads);
+
+                for (int i = 0; i < 10; i++)
+                {
+                    INFO("frame " << i);
+                    auto f = source.next();
+                    require_same(post.process(f), run_chain(filters, f));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("spatial and temporal filters give the same frames on any number of threads", "[code]")
+{
+    // Widths off the 32-column stripes and 64-pixel blocks the passes are split on
+    for (auto disparity : { false, true })
+    {
+        for (int holes : { 2, 5 })
+        {
+            INFO((disparity ? "disparity" : "Z16") << ", spatial holes filled " << holes);
+            depth_source source(333, 187);
+            rs2::disparity_transform to_disparity(true);
+            std::vector<rs2::spatial_filter> spatial;
+            std::vector<rs2::temporal_filter> temporal;
+            for (float threads : { 1.f, 4.f, 7.f })
+            {
+                spatial.emplace_back(0.5f, 20.f, 2.f, float(holes));
+                spatial.back().set_option(RS2_OPTION_PROCESSING_THREADS, threads);
+                temporal.emplace_back(0.4f, 20.f, 3);
+                temporal.back().set_option(RS2_OPTION_PROCESSING_THREADS, threads);
+            }
+
+            for (int i = 0; i < 8; i++)
+            {
+                INFO("frame " << i);
+                rs2::frame f = source.next(0.2f);
+                if (disparity)
+                    f = to_disparity.process(f);
+                auto serial = temporal[0].process(spatial[0].process(f));
+                for (size_t t = 1; t < spatial.size(); t++)
+                    require_same(temporal[t].process(spatial[t].process(f)), serial);
+            }
+        }
+    }
+}
+
+TEST_CASE("depth post-processing follows the options of the filters", "[code]")
+{
+    depth_source source(160, 120, true);
+    rs2::decimation_filter decimation(2);
+    rs2::disparity_transform to_disparity(true);
+    rs2::spatial_filter spatial;
+    rs2::temporal_filter temporal;
+    rs2::disparity_transform to_depth(false);
+    rs2::hole_filling_filter hole_filling;
+    auto filters = filter_list(decimation, to_disparity, spatial, temporal, to_depth, hole_filling);
+    rs2::depth_post_processing post(filters);
+
+    std::vector<std::function<void()>> changes = {
+        [&]() { temporal.set_option(RS2_OPTION_FILTER_SMOOTH_ALPHA, 0.7f); },
+        [&]() { decimation.set_option(RS2_OPTION_FILTER_MAGNITUDE, 3); },
+        [&]() { hole_filling.set_option(RS2_OPTION_HOLES_FILL, 2); },
+        [&]() { temporal.set_option(RS2_OPTION_HOLES_FILL, 6); },
+        [&]() { spatial.set_option(RS2_OPTION_FILTER_MAGNITUDE, 4); },
+        [&]() { temporal.set_option(RS2_OPTION_FILTER_SMOOTH_DELTA, 60); },
+        [&]() { decimation.set_option(RS2_OPTION_FILTER_MAGNITUDE, 2); },
+        [&]() { spatial.set_option(RS2_OPTION_HOLES_FILL, 5); },
+    };
+
+    for (size_t i = 0; i < changes.size() * 4; i++)
+    {
+        INFO("frame " << i);
+        if (i % 4 == 3)
+            changes[i / 4]();
+        auto f = source.next();
+        require_same(post.process(f), run_chain(filters, f));
+    }
+}
+
+TEST_CASE("depth post-processing takes the filters in the order they run", "[code]")
+{
+    rs2::decimation_filter decimation;
+    rs2::disparity_transform to_disparity(true), to_depth(false);
+    rs2::spatial_filter spatial;
+    rs2::temporal_filter temporal;
+    rs2::hole_filling_filter hole_filling;
+    rs2::colorizer colorizer;
+
+    REQUIRE_NOTHROW(rs2::depth_post_processing(filter_list(decimation, spatial, temporal)));
+    REQUIRE_NOTHROW(rs2::depth_post_processing(filter_list(to_depth, hole_filling)));
+    REQUIRE_THROWS(rs2::depth_post_processing(filter_list(spatial, decimation)));
+    REQUIRE_THROWS(rs2::depth_post_processing(filter_list(temporal, spatial)));
+    REQUIRE_THROWS(rs2::depth_post_processing(filter_list(hole_filling, temporal)));
+    REQUIRE_THROWS(rs2::depth_post_processing(filter_list(spatial, spatial)));
+    REQUIRE_THROWS(rs2::depth_post_processing(filter_list(colorizer)));
+    REQUIRE_THROWS(rs2::depth_post_processing(std::vector<rs2::filter>()));
+}
+
+TEST_CASE("depth post-processing benchmark", "[.][benchmark]")
+{
+    const int iterations = 50;
+    depth_source source(848, 480, true);
+    std::vector<rs2::frame> frames;
+    for (int i = 0; i < 8; i++)
+        frames.push_back(source.next());
+
+    // Going round the frames, as the temporal filter would make little of the same one over and over
+    auto time = [&](std::function<void(const rs2::frame&)> f)
+    {
+        size_t next = 0;
+        return time_ms(iterations, [&]() { f(frames[next++ % frames.size()]); });
+    };
+
+    std::cout << "Depth 848x480, ms per frame" << std::endl;
+    benchmark_table table({ { "filters", 44 }, { "threads", 8 }, { "chain", 12 }, { "fused", 12 } });
+    for (auto&& c : { chains[0], chains[1], chains[4] })
+    {
+        for (float threads : { 1.f, 0.f })
+        {
+            auto filters = make_filters(c);
+            for (auto&& filter : filters)
+                if (filter.supports(RS2_OPTION_PROCESSING_THREADS))
+                    filter.set_option(RS2_OPTION_PROCESSING_THREADS, threads);
+            rs2::depth_post_processing post(filters);
+            post.set_option(RS2_OPTION_PROCESSING_THREADS, threads);
+
+            auto sequential = time([&](const rs2::frame& f) { run_chain(filters, f); });
+            auto fused = time([&](const rs2::frame& f) { post.process(f); });
+            table.row(c.name, threads ? "1" : "all", sequential, fused);
+        }
+    }
+}
@@ -0,0 +1,588 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "catch/catch.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <vector>
+#ifdef _WIN32
+#include <sys/utime.h>
+#else
+#include <utime.h>
+#endif
+#include "internal-tests-common.h"
+#include "./../src/api.h"
+#include "./../src/thread-pool.h"
+#include "./../src/media/ros/ros_writer.h"
+#include "./../src/media/record/record_device.h"
+#include "rosbag/view.h"
+#include "std_msgs/String.h"
+
+using namespace librealsense;
+
+namespace
+{
+    std::vector<char> read_file(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    void write_file(const std::string& path, const std::vector<char>& data)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(data.data(), data.size());
+    }
+
+    bool file_exists(const std::string& path)
+    {
+        return std::ifstream(path).good();
+    }
+
+    // Text messages of a few kilobytes on two topics, in LZ4 chunks of 64 KB
+    void write_messages(rosbag::Bag& bag, int count)
+    {
+        bag.setCompression(rosbag::CompressionType::LZ4);
+        bag.setChunkThreshold(64 * 1024);
+        for (int i = 0; i < count; i++)
+        {
+            std_msgs::String message;
+            message.data = std::string(1000 + i * 37 % 4000, char('a' + i % 26)) + std::to_string(i);
+            bag.write(i % 3 ? "/a" : "/b", rs2rosinternal::Time(1, i * 1000), message);
+        }
+    }
+
+    // The topic, time and text of each message from begin to end, as a View gives them
+    std::vector<std::string> read_messages(const rosbag::Bag& bag,
+        rs2rosinternal::Time begin = rs2rosinternal::TIME_MIN, rs2rosinternal::Time end = rs2rosinternal::TIME_MAX)
+    {
+        std::vector<std::string> messages;
+        rosbag::View view(bag, begin, end);
+        for (auto&& m : view)
+            messages.push_back(m.getTopic() + " " + std::to_string(m.getTime().toNSec()) + " " + m.instantiate<std_msgs::String>()->data);
+        return messages;
+    }
+
+    // Waits up to a few seconds for what the write thread does
+    bool wait_for(const std::function<bool()>& done)
+    {
+        auto start = std::chrono::steady_clock::now();
+        while (!done())
+        {
+            if (std::chrono::steady_clock::now() - start > std::chrono::seconds(5))
+                return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    // Holds the write thread in write_frame until opened, as a slow disk would
+    class gated_writer : public device_serializer::writer
+    {
+    public:
+        void open()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _open = true;
+            }
+            _opened.notify_all();
+        }
+
+        void write_device_description(const device_serializer::device_snapshot&) override {}
+
+        void write_frame(const device_serializer::stream_identifier&, const device_serializer::nanoseconds&, frame_holder&&) override
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _opened.wait(lock, [this]() { return _open; });
+        }
+
+        void write_snapshot(uint32_t, const device_serializer::nanoseconds&, rs2_extension, const std::shared_ptr<extension_snapshot>&) override {}
+        void write_snapshot(const device_serializer::sensor_identifier&, const device_serializer::nanoseconds&, rs2_extension, const std::shared_ptr<extension_snapshot>&) override {}
+        void write_notification(const device_serializer::sensor_identifier&, const device_serializer::nanoseconds&, const notification&) override {}
+        const std::string& get_file_name() const override { return _file_name; }
+
+    private:
+        std::mutex _mutex;
+        std::condition_variable _opened;
+        bool _open = false;
+        std::string _file_name = "gated";
+    };
+
+    // A software depth sensor streaming through a record device, made over the writer given rather
+    // than a file so a gated writer lets the test decide when frames are written
+    class recording
+    {
+    public:
+        // The size of the frames sent, unless the recording is made with a size of its own
+        static const int width = 64, height = 48, frame_size = width * height * 2;
+
+        recording(std::shared_ptr<device_serializer::writer> writer, int width = recording::width, int height = recording::height)
+            : _writer(writer), _sensor(_dev.add_sensor("Stereo Module")), _width(width), _height(height)
+        {
+            rs2_intrinsics intrin = { width, height, width / 2.f, height / 2.f, width * 0.7f, width * 0.7f, RS2_DISTORTION_BROWN_CONRADY, { 0 } };
+            _profile = _sensor.add_video_stream({ RS2_STREAM_DEPTH, 0, 0, width, height, 30, 2, RS2_FORMAT_Z16, intrin });
+
+            auto dev = _dev.get();
+            _record.reset(new rs2_device{ dev->ctx, dev->info, std::make_shared<record_device>(dev->device, writer) }, rs2_delete_device);
+            _record_sensor = rs2::device(_record).query_sensors()[0];
+            _record_sensor.set_notifications_callback([this](rs2::notification n) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _notifications.push_back(n.get_description());
+            });
+            _record_sensor.open(_record_sensor.get_stream_profiles()[0]);
+            _record_sensor.start([](rs2::frame) {});
+        }
+
+        ~recording()
+        {
+            if (auto gated = std::dynamic_pointer_cast<gated_writer>(_writer))
+                gated->open();
+            _record_sensor.stop();
+            _record_sensor.close();
+        }
+
+        void send()
+        {
+            auto size = _width * _height * 2;
+            auto pixels = new uint8_t[size];
+            memset(pixels, _number, size);
+            _sensor.on_video_frame({ pixels, [](void* p) { delete[] static_cast<uint8_t*>(p); },
+                _width * 2, 2, _number * 33., RS2_TIMESTAMP_DOMAIN_HARDWARE_CLOCK, _number, _profile });
+            _number++;
+        }
+
+        void set_overflow_policy(rs2_record_overflow_policy policy, unsigned long long max_queued_bytes)
+        {
+            rs2_error* e = nullptr;
+            rs2_record_device_set_overflow_policy(_record.get(), policy, max_queued_bytes, &e);
+            REQUIRE(!e);
+        }
+
+        rs2_record_statistics statistics() const
+        {
+            rs2_error* e = nullptr;
+            rs2_record_statistics statistics;
+            rs2_record_device_get_statistics(_record.get(), &statistics, &e);
+            REQUIRE(!e);
+            return statistics;
+        }
+
+        std::vector<std::string> notifications() const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _notifications;
+        }
+
+        rs2_device* get() const { return _record.get(); }
+
+    private:
+        std::shared_ptr<device_serializer::writer> _writer;
+        rs2::software_device _dev;
+        rs2::software_sensor _sensor;
+        rs2::stream_profile _profile;
+        std::shared_ptr<rs2_device> _record;
+        rs2::sensor _record_sensor;
+        int _width, _height;
+        int _number = 0;
+
+        mutable std::mutex _mutex;
+        std::vector<std::string> _notifications;
+    };
+
+    void write_frame(device_serializer::writer& writer, const rs2::frame& f)
+    {
+        auto frame = (frame_interface*)f.get();
+        frame->acquire();
+        writer.write_frame({ 0, 0, RS2_STREAM_DEPTH, 0 }, std::chrono::milliseconds(f.get_frame_number() * 33), frame_holder(frame));
+    }
+}
+
+TEST_CASE("recording compresses chunks on the pool into the file of the write thread", "[code]")
+{
+    // Frames of 600 KB, so a chunk closes every frame or two
+    const uint32_t pending[] = { 0, 1, ros_writer::MAX_PENDING_CHUNKS };
+    std::vector<std::string> files;
+    {
+        depth_source source(640, 480);
+        std::vector<std::shared_ptr<ros_writer>> writers;
+        for (auto max_pending : pending)
+        {
+            files.push_back("record-chunks-" + std::to_string(max_pending) + ".bag");
+            writers.push_back(std::make_shared<ros_writer>(files.back(), true, max_pending));
+        }
+
+        // The same frames to each file, so they have the same system times
+        for (int i = 0; i < 40; i++)
+        {
+            auto f = source.next();
+            for (auto&& writer : writers)
+                write_frame(*writer, f);
+        }
+    }
+
+    auto expected = read_file(files[0]);
+    REQUIRE(expected.size() > 1000000);
+    for (size_t i = 1; i < files.size(); i++)
+    {
+        CAPTURE(pending[i]);
+        REQUIRE(read_file(files[i]) == expected);
+    }
+    for (auto&& file : files)
+        std::remove(file.c_str());
+}
+
+TEST_CASE("rosbag writes the chunks its executor holds back itself", "[code]")
+{
+    // An executor that never gets to the chunks, as a busy pool would not
+    std::vector<std::function<void()>> held;
+    const char* files[] = { "chunks-serial.bag", "chunks-held.bag" };
+    {
+        rosbag::Bag serial(files[0], rosbag::BagMode::Write), deferred(files[1], rosbag::BagMode::Write);
+        for (auto bag : { &serial, &deferred })
+        {
+            bag->setCompression(rosbag::CompressionType::LZ4);
+            bag->setChunkThreshold(64 * 1024);
+        }
+        deferred.setChunkExecutor([&](std::function<void()> task) { held.push_back(task); }, 2);
+
+        uint32_t most_pending = 0;
+        for (int i = 0; i < 200; i++)
+        {
+            std_msgs::String message;
+            message.data = std::string(1000 + i * 37 % 4000, char('a' + i % 26)) + std::to_string(i);
+            auto time = rs2rosinternal::Time(1, i * 1000);
+            auto topic = i % 3 ? "/a" : "/b";
+            serial.write(topic, time, message);
+            deferred.write(topic, time, message);
+            most_pending = std::max(most_pending, deferred.getPendingChunks());
+        }
+        // More chunks closed than may be pending, so the bag wrote some of them itself
+        REQUIRE(most_pending == 2);
+        REQUIRE(held.size() > most_pending);
+    }
+
+    // Run once written, the tasks find their chunks taken
+    for (auto&& task : held)
+        task();
+    REQUIRE(read_file(files[1]) == read_file(files[0]));
+    for (auto file : files)
+        std::remove(file);
+}
+
+TEST_CASE("record device follows its overflow policy", "[code]")
+{
+    const unsigned long long two_frames = 2 * recording::frame_size;
+
+    SECTION("block")
+    {
+        auto writer = std::make_shared<gated_writer>();
+        recording r(writer);
+        r.set_overflow_policy(RS2_RECORD_OVERFLOW_POLICY_BLOCK, two_frames);
+
+        // One frame held in the writer and one waiting fill the queue
+        r.send();
+        r.send();
+        std::atomic<bool> sent(false);
+        std::thread sensor([&]() { r.send(); sent = true; });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        REQUIRE_FALSE(sent);
+        auto statistics = r.statistics();
+        REQUIRE(statistics.queued_frames == 2);
+        REQUIRE(statistics.queued_bytes == two_frames);
+        REQUIRE(statistics.dropped_frames == 0);
+
+        writer->open();
+        sensor.join();
+        REQUIRE(wait_for([&]() { return r.statistics().written_frames == 3; }));
+        statistics = r.statistics();
+        REQUIRE(statistics.queued_frames == 0);
+        REQUIRE(statistics.queued_bytes == 0);
+        REQUIRE(statistics.dropped_frames == 0);
+        REQUIRE(statistics.written_bytes == 3 * recording::frame_size);
+    }
+
+    SECTION("drop frames")
+    {
+        auto writer = std::make_shared<gated_writer>();
+        recording r(writer);
+        r.set_overflow_policy(RS2_RECORD_OVERFLOW_POLICY_DROP_FRAMES, two_frames);
+
+        for (int i = 0; i < 5; i++)
+            r.send();
+        auto statistics = r.statistics();
+        REQUIRE(statistics.queued_frames == 2);
+        REQUIRE(statistics.dropped_frames == 3);
+        REQUIRE(statistics.written_frames == 0);
+
+        // Recording goes on once the queue has room
+        writer->open();
+        REQUIRE(wait_for([&]() { return r.statistics().written_frames == 2; }));
+        r.send();
+        REQUIRE(wait_for([&]() { return r.statistics().written_frames == 3; }));
+        REQUIRE(r.statistics().dropped_frames == 3);
+        REQUIRE(r.notifications().empty());
+    }
+
+    SECTION("stop recording")
+    {
+        auto writer = std::make_shared<gated_writer>();
+        recording r(writer);
+        r.set_overflow_policy(RS2_RECORD_OVERFLOW_POLICY_STOP_RECORDING, two_frames);
+
+        // The first frame that does not fit stops recording the sensor, and the frames after it are not recorded
+        for (int i = 0; i < 5; i++)
+            r.send();
+        auto statistics = r.statistics();
+        REQUIRE(statistics.queued_frames == 2);
+        REQUIRE(statistics.dropped_frames == 1);
+        REQUIRE(wait_for([&]() { return !r.notifications().empty(); }));
+
+        writer->open();
+        REQUIRE(wait_for([&]() { return r.statistics().written_frames == 2; }));
+        r.send();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        statistics = r.statistics();
+        REQUIRE(statistics.written_frames == 2);
+        REQUIRE(statistics.dropped_frames == 1);
+    }
+
+    SECTION("arguments")
+    {
+        auto writer = std::make_shared<gated_writer>();
+        recording r(writer);
+        rs2_error* e = nullptr;
+        rs2_record_device_set_overflow_policy(r.get(), RS2_RECORD_OVERFLOW_POLICY_DROP_FRAMES, 0, &e);
+        REQUIRE(e);
+        rs2_free_error(e);
+        e = nullptr;
+        rs2_record_device_set_overflow_policy(r.get(), RS2_RECORD_OVERFLOW_POLICY_COUNT, two_frames, &e);
+        REQUIRE(e);
+        rs2_free_error(e);
+    }
+}
+
+TEST_CASE("a stalled recording does not hold up another one on the same thread", "[code]")
+{
+    // The frames of both sensors come from one thread, as the callbacks of cameras sharing a capture thread do.
+    // Frames of 1.8 MB fill the default queue in about 135 of them
+    auto stalled_writer = std::make_shared<gated_writer>();
+    auto writer = std::make_shared<gated_writer>();
+    writer->open();
+    recording stalled(stalled_writer, 1280, 720), other(writer);
+
+    const int frames = 150;
+    std::atomic<bool> sent(false);
+    std::thread sensors([&]() {
+        for (int i = 0; i < frames; i++)
+        {
+            stalled.send();
+            other.send();
+        }
+        sent = true;
+    });
+
+    // By default the stalled recording drops what does not fit, rather than holding up the thread
+    bool all_sent = wait_for([&]() { return sent.load(); });
+    if (!all_sent)
+        stalled_writer->open();
+    sensors.join();
+    REQUIRE(all_sent);
+    REQUIRE(wait_for([&]() { return other.statistics().written_frames == frames; }));
+    REQUIRE(other.statistics().dropped_frames == 0);
+
+    auto statistics = stalled.statistics();
+    REQUIRE(statistics.written_frames == 0);
+    REQUIRE(statistics.dropped_frames > 0);
+    REQUIRE(statistics.queued_frames + statistics.dropped_frames == frames);
+    REQUIRE(stalled.notifications().empty());
+}
+
+TEST_CASE("batch playback plays each file to its end in order", "[code]")
+{
+    // Files of their own length, and one that is not there
+    const int lengths[] = { 23, 9 };
+    std::vector<std::string> files = { "batch-a.bag", "batch-b.bag", "batch-missing.bag" };
+    for (int file = 0; file < 2; file++)
+    {
+        recording r(std::make_shared<ros_writer>(files[file], false));
+        for (int i = 0; i < lengths[file]; i++)
+            r.send();
+        REQUIRE(wait_for([&]() { return r.statistics().written_frames == unsigned(lengths[file]); }));
+    }
+
+    std::mutex mutex;
+    std::vector<std::vector<unsigned long long>> numbers(files.size());
+    rs2::context ctx;
+    rs2::playback_batch batch(ctx, files, 2);
+    batch.start([&](rs2::frame f, int file) {
+        std::lock_guard<std::mutex> lock(mutex);
+        numbers[file].push_back(f.get_frame_number());
+    });
+    REQUIRE(batch.wait(10000));
+
+    for (int file = 0; file < 2; file++)
+    {
+        CAPTURE(files[file]);
+        std::vector<unsigned long long> expected(lengths[file]);
+        for (int i = 0; i < lengths[file]; i++)
+            expected[i] = i;
+        REQUIRE(numbers[file] == expected);
+        auto progress = batch.get_file_progress(file);
+        REQUIRE(progress.done);
+        REQUIRE(progress.frames == unsigned(lengths[file]));
+        REQUIRE(progress.position == progress.duration);
+        REQUIRE(batch.get_file_error(file).empty());
+    }
+
+    REQUIRE(numbers[2].empty());
+    REQUIRE(batch.get_file_progress(2).done);
+    REQUIRE(batch.get_progress().files_failed == 1);
+
+    // The message of each file stays put while those of others are asked for
+    auto raw = std::shared_ptr<rs2_playback_batch>(batch);
+    rs2_error* e = nullptr;
+    auto missing = rs2_playback_batch_get_file_error(raw.get(), 2, &e);
+    auto first = rs2_playback_batch_get_file_error(raw.get(), 0, &e);
+    REQUIRE(!e);
+    std::string message = missing;
+    REQUIRE_FALSE(message.empty());
+    REQUIRE(std::string(first).empty());
+    REQUIRE(rs2_playback_batch_get_file_error(raw.get(), 2, &e) == missing);
+    REQUIRE(message == missing);
+
+    for (int file = 0; file < 2; file++)
+        std::remove(files[file].c_str());
+}
+
+TEST_CASE("rosbag takes the index from a cache only while it matches the bag", "[code]")
+{
+    const std::string file = "index-cache.bag", cache = "index-cache.bag.idx";
+    {
+        rosbag::Bag bag(file, rosbag::BagMode::Write);
+        write_messages(bag, 200);
+    }
+    std::remove(cache.c_str());
+
+    auto read = [&](const std::string& cache_path) {
+        rosbag::Bag bag;
+        bag.setIndexCachePath(cache_path);
+        bag.open(file, rosbag::BagMode::Read);
+        return read_messages(bag);
+    };
+    auto expected = read("");
+    REQUIRE(expected.size() == 200);
+    REQUIRE_FALSE(file_exists(cache));
+
+    // Made on the first open, with no temporary file left beside it
+    REQUIRE(read(cache) == expected);
+    auto made = read_file(cache);
+    REQUIRE(made.size() > 200 * 20);
+    REQUIRE_FALSE(file_exists(cache + ".tmp"));
+    REQUIRE(read(cache) == expected);
+
+    // A cache with the key of the bag and no entries gives a bag with no messages, if it is read
+    const size_t header_size = 8 + 5 * 8;
+    std::vector<char> empty(made.begin(), made.begin() + header_size);
+    empty.resize(header_size + 4, 0);
+    write_file(cache, empty);
+    REQUIRE(read(cache).empty());
+
+    SECTION("not matching the modification time")
+    {
+        utimbuf times;
+        times.actime = times.modtime = time(nullptr) - 60;
+        REQUIRE(utime(file.c_str(), &times) == 0);
+        REQUIRE(read(cache) == expected);
+        // and rewritten for the bag as it is now
+        REQUIRE(read(cache) == expected);
+        REQUIRE(read_file(cache).size() == made.size());
+    }
+
+    SECTION("not matching the size")
+    {
+        std::ofstream(file, std::ios::binary | std::ios::app).put(0);
+        REQUIRE(read(cache) == expected);
+    }
+
+    SECTION("cut short")
+    {
+        write_file(cache, std::vector<char>(made.begin(), made.begin() + made.size() / 2));
+        REQUIRE(read(cache) == expected);
+        REQUIRE(read_file(cache) == made);
+    }
+
+    SECTION("that cannot be written")
+    {
+        const std::string nowhere = "no-such-folder/index-cache.bag.idx";
+        REQUIRE(read(nowhere) == expected);
+        REQUIRE_FALSE(file_exists(nowhere));
+        REQUIRE_FALSE(file_exists(nowhere + ".tmp"));
+    }
+
+    std::remove(cache.c_str());
+    std::remove(file.c_str());
+}
+
+TEST_CASE("rosbag prefetches chunks into the messages it reads without them", "[code]")
+{
+    const std::string file = "prefetch.bag";
+    {
+        rosbag::Bag bag(file, rosbag::BagMode::Write);
+        write_messages(bag, 300);
+    }
+
+    std::vector<std::string> expected, expected_range;
+    // From the middle of a chunk to the middle of another
+    rs2rosinternal::Time begin(1, 77 * 1000), end(1, 201 * 1000);
+    {
+        rosbag::Bag serial;
+        serial.open(file, rosbag::BagMode::Read);
+        expected = read_messages(serial);
+        expected_range = read_messages(serial, begin, end);
+    }
+    REQUIRE(expected.size() == 300);
+    REQUIRE(expected_range.size() == 201 - 77 + 1);
+
+    SECTION("on a pool")
+    {
+        thread_pool pool(3);
+        for (uint32_t ahead : { 1u, 4u, 100u })
+        {
+            CAPTURE(ahead);
+            rosbag::Bag bag;
+            bag.setChunkPrefetch([&](std::function<void()> task) { pool.submit(task); }, ahead);
+            bag.open(file, rosbag::BagMode::Read);
+            REQUIRE(read_messages(bag) == expected);
+            REQUIRE(read_messages(bag, begin, end) == expected_range);
+        }
+    }
+
+    SECTION("held back by the executor")
+    {
+        // The reader decompresses what no worker got to, and the tasks run late find it done
+        std::vector<std::function<void()>> held;
+        {
+            rosbag::Bag bag;
+            bag.setChunkPrefetch([&](std::function<void()> task) { held.push_back(task); }, 4);
+            bag.open(file, rosbag::BagMode::Read);
+            REQUIRE(read_messages(bag) == expected);
+            REQUIRE(held.size() > 10);
+            for (auto&& task : held)
+                task();
+            REQUIRE(read_messages(bag, begin, end) == expected_range);
+        }
+        for (auto&& task : held)
+            task();
+    }
+
+    std::remove(file.c_str());
+}
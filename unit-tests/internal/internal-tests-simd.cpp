@@ -0,0 +1,588 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "catch/catch.hpp"
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+#include "./../src/image-simd.h"
+
+using namespace librealsense;
+
+namespace
+{
+    struct kernel_info
+    {
+        const char* name;
+        unpack_kernel unpack_kernels::* kernel;
+        int src_bytes_num, src_bytes_den;  // source bytes per pixel, as a fraction
+        int dst_bytes[2];                  // per pixel in each output plane, 0 for none
+        int pixel_multiple;
+    };
+
+    const kernel_info unpackers[] = {
+        { "YUY2 to Y8",     &unpack_kernels::yuy2_to_y8,      2, 1, { 1, 0 }, 2 },
+        { "YUY2 to Y16",    &unpack_kernels::yuy2_to_y16,     2, 1, { 2, 0 }, 2 },
+        { "YUY2 to RGB8",   &unpack_kernels::yuy2_to_rgb8,    2, 1, { 3, 0 }, 2 },
+        { "YUY2 to RGBA8",  &unpack_kernels::yuy2_to_rgba8,   2, 1, { 4, 0 }, 2 },
+        { "YUY2 to BGR8",   &unpack_kernels::yuy2_to_bgr8,    2, 1, { 3, 0 }, 2 },
+        { "YUY2 to BGRA8",  &unpack_kernels::yuy2_to_bgra8,   2, 1, { 4, 0 }, 2 },
+        { "UYVY to RGB8",   &unpack_kernels::uyvy_to_rgb8,    2, 1, { 3, 0 }, 2 },
+        { "UYVY to RGBA8",  &unpack_kernels::uyvy_to_rgba8,   2, 1, { 4, 0 }, 2 },
+        { "UYVY to BGR8",   &unpack_kernels::uyvy_to_bgr8,    2, 1, { 3, 0 }, 2 },
+        { "UYVY to BGRA8",  &unpack_kernels::uyvy_to_bgra8,   2, 1, { 4, 0 }, 2 },
+        { "BGR8 to RGB8",   &unpack_kernels::bgr8_to_rgb8,    3, 1, { 3, 0 }, 1 },
+        { "Y8I to Y8 Y8",   &unpack_kernels::y8i_to_y8_y8,    2, 1, { 1, 1 }, 1 },
+        { "Y12I to Y16 Y16",&unpack_kernels::y12i_to_y16_y16, 3, 1, { 2, 2 }, 1 },
+        { "Y16 10 to Y8",   &unpack_kernels::y16_10_to_y8,    2, 1, { 1, 0 }, 1 },
+        { "Y16 10 to Y16",  &unpack_kernels::y16_10_to_y16,   2, 1, { 2, 0 }, 1 },
+        { "W10 to Y10BPACK",&unpack_kernels::w10_to_y10bpack, 5, 4, { 2, 0 }, 4 },
+    };
+
+    const simd_level vector_levels[] = { simd_level::sse41, simd_level::avx2, simd_level::avx512, simd_level::neon };
+
+    const uint8_t GUARD = 0xa5;
+    const int GUARD_BYTES = 64;
+
+    // Runs a kernel into planes followed by guard bytes, returning the planes with the guards
+    std::vector<std::vector<uint8_t>> run(unpack_kernel kernel, const kernel_info& info, const std::vector<uint8_t>& src, int count)
+    {
+        std::vector<std::vector<uint8_t>> planes;
+        uint8_t* dst[2] = { nullptr, nullptr };
+        for (int p = 0; p < 2 && info.dst_bytes[p]; p++)
+        {
+            planes.emplace_back(count * info.dst_bytes[p] + GUARD_BYTES, GUARD);
+            dst[p] = planes.back().data();
+        }
+        kernel(dst, src.data(), count);
+        return planes;
+    }
+}
+
+TEST_CASE("SIMD unpack kernels match their scalar references", "[code]")
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> byte(0, 255);
+    auto& reference = get_reference_unpack_kernels();
+
+    for (auto level : vector_levels)
+    {
+        unpack_kernels kernels;
+        if (!get_unpack_kernels(level, kernels))
+            continue;
+        INFO("level " << get_string(level));
+
+        for (auto& info : unpackers)
+        {
+            INFO("kernel " << info.name);
+            // Sizes around the vector widths exercise the scalar tails
+            for (int count : { 4, 8, 12, 16, 20, 28, 32, 36, 60, 64, 68, 100, 128, 132, 1000, 1284, 640 * 480 })
+            {
+                count -= count % info.pixel_multiple;
+                INFO("pixels " << count);
+
+                // Exactly sized, so reads past the end show up under sanitizers
+                std::vector<uint8_t> src(count * info.src_bytes_num / info.src_bytes_den);
+                for (auto&& b : src)
+                    b = static_cast<uint8_t>(byte(rng));
+
+                auto expected = run(reference.*info.kernel, info, src, count);
+                auto actual = run(kernels.*info.kernel, info, src, count);
+                REQUIRE(actual == expected); // including the untouched guard bytes
+            }
+        }
+    }
+}
+
+TEST_CASE("SIMD tile rotations match their scalar references", "[code]")
+{
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> byte(0, 255);
+    auto& reference = get_reference_unpack_kernels();
+
+    const int src_stride = 40, dst_stride = 24;
+    std::vector<uint8_t> src(8 * src_stride);
+    for (auto&& b : src)
+        b = static_cast<uint8_t>(byte(rng));
+
+    for (auto level : vector_levels)
+    {
+        unpack_kernels kernels;
+        if (!get_unpack_kernels(level, kernels))
+            continue;
+        INFO("level " << get_string(level));
+
+        for (auto rotate : { &unpack_kernels::rotate_8x8_u8, &unpack_kernels::rotate_8x8_u16 })
+        {
+            std::vector<uint8_t> expected(8 * dst_stride, GUARD), actual(8 * dst_stride, GUARD);
+            (reference.*rotate)(expected.data(), dst_stride, src.data() + 3, src_stride);
+            (kernels.*rotate)(actual.data(), dst_stride, src.data() + 3, src_stride);
+            REQUIRE(actual == expected);
+        }
+    }
+
+    // Output row r is source column 7 - r read from the bottom up
+    std::vector<uint8_t> out(8 * dst_stride);
+    reference.rotate_8x8_u8(out.data(), dst_stride, src.data(), src_stride);
+    REQUIRE(out[0] == src[7 * src_stride + 7]);
+    REQUIRE(out[7] == src[7]);
+    REQUIRE(out[7 * dst_stride] == src[7 * src_stride]);
+}
+
+TEST_CASE("SIMD depth projection matches its scalar reference", "[code]")
+{
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> depth_value(0, 8000);
+    std::uniform_real_distribution<float> ray(-0.9f, 0.9f);
+    auto& reference = get_reference_unpack_kernels();
+
+    const int count = 1283; // leaves a tail for every vector width
+    std::vector<uint16_t> depth(count);
+    std::vector<float> ray_x(count), ray_y(count);
+    for (int i = 0; i < count; i++)
+    {
+        depth[i] = i % 5 ? static_cast<uint16_t>(depth_value(rng)) : 0;
+        ray_x[i] = ray(rng);
+        ray_y[i] = ray(rng);
+    }
+
+    depth_projection p = { 0.001f, { 0.9999f, 0.0001f, -0.0141f, -0.0001f, 1.f, 0.0002f, 0.0141f, -0.0002f, 0.9999f },
+        { 0.015f, 0.0001f, 0.0003f }, 1380.2f, 1379.8f, 955.5f, 541.2f, { 0.12f, -0.31f, 0.0004f, -0.0002f, 0.27f }, false };
+
+    for (auto level : vector_levels)
+    {
+        unpack_kernels kernels;
+        if (!get_unpack_kernels(level, kernels))
+            continue;
+        INFO("level " << get_string(level));
+
+        for (bool distort : { false, true })
+        {
+            INFO("distort " << distort);
+            p.distort = distort;
+            std::vector<int32_t> expected(count * 2, -1), actual(count * 2, -1);
+            reference.project_depth(expected.data(), depth.data(), ray_x.data(), ray_y.data(), count, p);
+            kernels.project_depth(actual.data(), depth.data(), ray_x.data(), ray_y.data(), count, p);
+            REQUIRE(actual == expected);
+        }
+    }
+}
+
+TEST_CASE("SIMD pointcloud kernels match their scalar references", "[code]")
+{
+    std::mt19937 rng(13);
+    std::uniform_int_distribution<int> depth_value(0, 8000);
+    std::uniform_real_distribution<float> ray(-0.9f, 0.9f);
+    auto& reference = get_reference_unpack_kernels();
+
+    const int count = 1283;
+    const float depth_scale = 0.001f;
+    std::vector<uint16_t> depth(count);
+    std::vector<float> ray_x(count), ray_y(count);
+    for (int i = 0; i < count; i++)
+    {
+        depth[i] = i % 5 ? static_cast<uint16_t>(depth_value(rng)) : 0;
+        ray_x[i] = ray(rng);
+        ray_y[i] = ray(rng);
+    }
+
+    // Compares bytes, which tells apart 0 and -0 too
+    auto deproject = [&](deproject_kernel kernel, int planes, int vertex_bytes)
+    {
+        std::vector<uint8_t> out(count * vertex_bytes + GUARD_BYTES, GUARD);
+        uint8_t* dst[3] = { out.data(), out.data() + count * vertex_bytes / 3, out.data() + count * vertex_bytes / 3 * 2 };
+        if (planes == 1)
+            dst[1] = dst[2] = nullptr;
+        kernel(dst, depth.data(), ray_x.data(), ray_y.data(), count, depth_scale);
+        return out;
+    };
+
+    std::vector<float> points(count * 3);
+    uint8_t* points_plane[] = { reinterpret_cast<uint8_t*>(points.data()) };
+    reference.deproject_xyz(points_plane, depth.data(), ray_x.data(), ray_y.data(), count, depth_scale);
+
+    point_projection p = { { 0.9999f, 0.0001f, -0.0141f, -0.0001f, 1.f, 0.0002f, 0.0141f, -0.0002f, 0.9999f },
+        { 0.015f, 0.0001f, 0.0003f }, 1380.2f, 1379.8f, 955.5f, 541.2f, { 0.12f, -0.31f, 0.0004f, -0.0002f, 0.27f }, 1920, 1080, false };
+
+    for (auto level : vector_levels)
+    {
+        unpack_kernels kernels;
+        if (!get_unpack_kernels(level, kernels))
+            continue;
+        INFO("level " << get_string(level));
+
+        REQUIRE(deproject(kernels.deproject_xyz, 1, 12) == deproject(reference.deproject_xyz, 1, 12));
+        REQUIRE(deproject(kernels.deproject_planar, 3, 12) == deproject(reference.deproject_planar, 3, 12));
+        REQUIRE(deproject(kernels.deproject_xyz_half, 1, 6) == deproject(reference.deproject_xyz_half, 1, 6));
+
+        for (bool distort : { false, true })
+        {
+            INFO("distort " << distort);
+            p.distort = distort;
+            std::vector<float> expected_tex(count * 2, -1), expected_pixels(count * 2, -1);
+            std::vector<float> tex(count * 2, -1), pixels(count * 2, -1);
+            reference.texture_map(expected_tex.data(), expected_pixels.data(), points.data(), count, p);
+            kernels.texture_map(tex.data(), pixels.data(), points.data(), count, p);
+            REQUIRE(memcmp(tex.data(), expected_tex.data(), tex.size() * sizeof(float)) == 0);
+            REQUIRE(memcmp(pixels.data(), expected_pixels.data(), pixels.size() * sizeof(float)) == 0);
+        }
+    }
+}
+
+TEST_CASE("SIMD disparity kernels match their scalar references", "[code]")
+{
+    std::mt19937 rng(17);
+    std::uniform_int_distribution<int> depth_value(0, 65535);
+    std::uniform_real_distribution<float> disparity_value(20.f, 2000.f);
+    auto& reference = get_reference_unpack_kernels();
+
+    const int count = 1283;
+    const float factor = 50.f * 0.001f * 600.f * 32 / 0.001f;
+    std::vector<float> lut(65536);
+    for (size_t d = 1; d < lut.size(); d++)
+        lut[d] = factor / d;
+
+    std::vector<uint16_t> depth(count);
+    for (int i = 0; i < count; i++)
+        depth[i] = i % 5 ? static_cast<uint16_t>(depth_value(rng)) : 0;
+
+    // No disparity, denormal, infinite and not a number disparity all come out as no depth
+    std::vector<float> disparity(count);
+    for (int i = 0; i < count; i++)
+        disparity[i] = disparity_value(rng);
+    disparity[3] = 0;
+    disparity[9] = -0.f;
+    disparity[17] = 1e-40f;
+    disparity[21] = std::numeric_limits<float>::infinity();
+    disparity[30] = std::numeric_limits<float>::quiet_NaN();
+
+    std::vector<float> expected_disparity(count);
+    std::vector<uint16_t> expected_depth(count);
+    reference.depth_to_disparity(expected_disparity.data(), depth.data(), count, lut.data());
+    reference.disparity_to_depth(expected_depth.data(), disparity.data(), count, factor);
+    REQUIRE(expected_depth[3] == 0);
+    REQUIRE(expected_depth[17] == 0);
+    REQUIRE(expected_depth[30] == 0);
+
+    std::vector<simd_level> levels = { simd_level::scalar };
+    levels.insert(levels.end(), std::begin(vector_levels), std::end(vector_levels));
+    for (auto level : levels)
+    {
+        unpack_kernels kernels;
+        if (!get_unpack_kernels(level, kernels))
+            continue;
+        INFO("level " << get_string(level));
+
+        for (int n : { count, 7, 16, 31 })
+        {
+            INFO("count " << n);
+            std::vector<float> to_disparity(n, -1);
+            std::vector<uint16_t> to_depth(n, 1);
+            kernels.depth_to_disparity(to_disparity.data(), depth.data(), n, lut.data());
+            kernels.disparity_to_depth(to_depth.data(), disparity.data(), n, factor);
+            REQUIRE(memcmp(to_disparity.data(), expected_disparity.data(), n * sizeof(float)) == 0);
+            REQUIRE(memcmp(to_depth.data(), expected_depth.data(), n * sizeof(uint16_t)) == 0);
+
+            // In place, in one buffer of the disparity size
+            std::vector<float> buffer(n);
+            memcpy(buffer.data(), depth.data(), n * sizeof(uint16_t));
+            kernels.depth_to_disparity(buffer.data(), reinterpret_cast<const uint16_t*>(buffer.data()), n, lut.data());
+            REQUIRE(memcmp(buffer.data(), expected_disparity.data(), n * sizeof(float)) == 0);
+
+            memcpy(buffer.data(), disparity.data(), n * sizeof(float));
+            kernels.disparity_to_depth(reinterpret_cast<uint16_t*>(buffer.data()), buffer.data(), n, factor);
+            REQUIRE(memcmp(buffer.data(), expected_depth.data(), n * sizeof(uint16_t)) == 0);
+        }
+    }
+}
+
+TEST_CASE("SIMD hole scans match their scalar references", "[code]")
+{
+    auto& reference = get_reference_unpack_kernels();
+
+    // A zero at every position of a row longer than every vector width, one before the row ends,
+    // none at all, and the high half of an element alone set, as -0.f is
+    const int count = 83;
+    std::vector<uint32_t> row(count + 1);
+    for (auto level : vector_levels)
+    {
+        unpack_kernels kernels;
+        if (!get_unpack_kernels(level, kernels))
+            continue;
+        INFO("level " << get_string(level));
+
+        for (int zero = 0; zero <= count; zero++)
+        {
+            INFO("zero at " << zero);
+            for (int i = 0; i <= count; i++)
+                row[i] = i == zero ? 0 : i % 2 ? 0x80000000u : 7u;
+            auto src = reinterpret_cast<const uint8_t*>(row.data());
+            for (int n : { count, zero, count - zero })
+            {
+                REQUIRE(kernels.find_zero_u32(src, n) == reference.find_zero_u32(src, n));
+                REQUIRE(kernels.find_zero_u16(src, n) == reference.find_zero_u16(src, n));
+                REQUIRE(kernels.find_zero_u16(src, n * 2) == reference.find_zero_u16(src, n * 2));
+            }
+            REQUIRE(reference.find_zero_u32(src, count) == std::min(zero, count));
+        }
+
+        // The end of a hole, its one set pixel a high byte alone or a low byte alone
+        std::vector<uint16_t> hole(count + 1);
+        for (int set = 0; set <= count; set++)
+        {
+            INFO("non-zero at " << set);
+            for (int i = 0; i <= count; i++)
+                hole[i] = i == set ? (set % 2 ? 0x100 : 1) : 0;
+            auto src = reinterpret_cast<const uint8_t*>(hole.data());
+            for (int n : { count, set, count - set })
+                REQUIRE(kernels.find_nonzero_u16(src, n) == reference.find_nonzero_u16(src, n));
+            REQUIRE(reference.find_nonzero_u16(src, count) == std::min(set, count));
+        }
+    }
+}
+
+TEST_CASE("SIMD bit planes match their scalar references", "[code]")
+{
+    std::mt19937 rng(23);
+    auto& reference = get_reference_unpack_kernels();
+
+    std::vector<uint16_t> values(64), unpacked(64), expected_values(64);
+    std::vector<uint64_t> planes(16), expected_planes(16);
+    for (auto level : vector_levels)
+    {
+        unpack_kernels kernels;
+        if (!get_unpack_kernels(level, kernels))
+            continue;
+        INFO("level " << get_string(level));
+
+        for (int bits = 0; bits <= 16; bits++)
+        {
+            INFO("bits " << bits);
+            for (int round = 0; round < 20; round++)
+            {
+                // Values of at most bits bits, then values with bits above them to be left out
+                for (auto&& v : values)
+                    v = static_cast<uint16_t>(rng() & (round % 2 ? 0xffff : (1 << bits) - 1));
+                reference.bitplane_pack(expected_planes.data(), values.data(), bits);
+                kernels.bitplane_pack(planes.data(), values.data(), bits);
+                for (int b = 0; b < bits; b++)
+                    REQUIRE(planes[b] == expected_planes[b]);
+
+                reference.bitplane_unpack(expected_values.data(), planes.data(), bits);
+                kernels.bitplane_unpack(unpacked.data(), planes.data(), bits);
+                REQUIRE(unpacked == expected_values);
+                for (int i = 0; i < 64; i++)
+                    REQUIRE(unpacked[i] == (values[i] & ((1 << bits) - 1)));
+            }
+        }
+    }
+}
+
+TEST_CASE("SIMD decimation kernels match their scalar references", "[code]")
+{
+    std::mt19937 rng(18);
+    std::uniform_int_distribution<int> depth_value(1, 65535);
+    std::uniform_int_distribution<int> byte_value(0, 255);
+    std::uniform_int_distribution<int> zeros(0, 9);
+    auto& reference = get_reference_unpack_kernels();
+
+    // Blocks with every number of zeros, the largest depth among them, and 256 rows of bytes for the
+    // 16-bit sums at their limit
+    const int count = 203, rows_count = 256;
+    std::vector<std::vector<uint16_t>> depth(8, std::vector<uint16_t>(count * 3));
+    std::vector<std::vector<uint8_t>> bytes(rows_count, std::vector<uint8_t>(count * 3));
+    for (auto&& row : depth)
+        for (size_t i = 0; i < row.size(); i++)
+            row[i] = zeros(rng) < int(i / 9 % 10) ? 0 : i % 13 ? static_cast<uint16_t>(depth_value(rng)) : 65535;
+    for (auto&& row : bytes)
+        for (auto&& b : row)
+            b = rng() % 4 ? 255 : static_cast<uint8_t>(byte_value(rng));
+
+    const uint16_t* depth_rows[8];
+    for (int n = 0; n < 8; n++)
+        depth_rows[n] = depth[n].data();
+    std::vector<const uint8_t*> byte_rows;
+    for (auto&& row : bytes)
+        byte_rows.push_back(row.data());
+
+    for (auto level : vector_levels)
+    {
+        unpack_kernels kernels;
+        if (!get_unpack_kernels(level, kernels))
+            continue;
+        INFO("level " << get_string(level));
+
+        for (int n : { count, 7, 8, 17, 33 })
+        {
+            INFO("count " << n);
+            std::vector<uint16_t> expected(n), actual(n + 1, 1);
+            reference.median_2x2(expected.data(), depth_rows, n);
+            kernels.median_2x2(actual.data(), depth_rows, n);
+            REQUIRE(memcmp(actual.data(), expected.data(), n * sizeof(uint16_t)) == 0);
+            REQUIRE(actual[n] == 1);
+
+            reference.median_3x3(expected.data(), depth_rows, n);
+            kernels.median_3x3(actual.data(), depth_rows, n);
+            REQUIRE(memcmp(actual.data(), expected.data(), n * sizeof(uint16_t)) == 0);
+
+            for (int rows : { 1, 2, 5, 8, rows_count })
+            {
+                INFO("rows " << rows);
+                std::vector<uint32_t> expected_sums(n), sums(n), expected_nonzero(n), nonzero(n);
+                reference.column_sum_u8(expected_sums.data(), byte_rows.data(), rows, n);
+                kernels.column_sum_u8(sums.data(), byte_rows.data(), rows, n);
+                REQUIRE(sums == expected_sums);
+
+                if (rows > 8)
+                    continue;
+                reference.column_sum_u16(expected_sums.data(), expected_nonzero.data(), depth_rows, rows, n);
+                kernels.column_sum_u16(sums.data(), nonzero.data(), depth_rows, rows, n);
+                REQUIRE(sums == expected_sums);
+                REQUIRE(nonzero == expected_nonzero);
+                kernels.column_sum_u16(sums.data(), nullptr, depth_rows, rows, n);
+                REQUIRE(sums == expected_sums);
+            }
+        }
+    }
+}
+
+TEST_CASE("SIMD occlusion scans match their scalar reference", "[code]")
+{
+    std::mt19937 rng(19);
+    std::uniform_real_distribution<float> step(-0.5f, 2.f);
+    std::uniform_int_distribution<int> chance(0, 99);
+    auto& reference = get_reference_unpack_kernels();
+
+    // Texture x rising in steps, now and then falling back or repeating, with holes, and a NaN late
+    // in the row; each scan starts where the previous one stopped, as the filter runs them
+    const int count = 301;
+    std::vector<float> pixels(count * 2), points(count * 3);
+    float x = 0;
+    for (int i = 0; i < count; i++)
+    {
+        auto roll = chance(rng);
+        x = roll < 3 ? x - 5.f : roll < 6 ? x : x + std::abs(step(rng));
+        pixels[i * 2] = i == 270 ? std::numeric_limits<float>::quiet_NaN() : x;
+        pixels[i * 2 + 1] = step(rng);
+        points[i * 3] = step(rng);
+        points[i * 3 + 1] = step(rng);
+        points[i * 3 + 2] = chance(rng) < 20 ? 0.f : 0.5f + std::abs(step(rng));
+    }
+
+    for (auto level : vector_levels)
+    {
+        unpack_kernels kernels;
+        if (!get_unpack_kernels(level, kernels))
+            continue;
+        INFO("level " << get_string(level));
+
+        for (int from = 0; from < count; from++)
+        {
+            INFO("from " << from);
+            float expected_x = from ? pixels[from * 2 - 2] : -1.f, expected_z = 0.f;
+            float actual_x = expected_x, actual_z = expected_z;
+            auto expected = reference.occlusion_run(pixels.data() + from * 2, points.data() + from * 3, count - from, expected_x, expected_z);
+            auto actual = kernels.occlusion_run(pixels.data() + from * 2, points.data() + from * 3, count - from, actual_x, actual_z);
+            REQUIRE(actual == expected);
+            REQUIRE(memcmp(&actual_x, &expected_x, sizeof(float)) == 0);
+            REQUIRE(memcmp(&actual_z, &expected_z, sizeof(float)) == 0);
+        }
+    }
+}
+
+TEST_CASE("Half-precision vertices round to nearest even", "[code]")
+{
+    struct half_case { float value; uint16_t half; };
+    const half_case cases[] = {
+        { 0.f, 0x0000 },
+        { -0.f, 0x8000 },
+        { 1.f, 0x3c00 },
+        { -2.f, 0xc000 },
+        { 1.f + 1.f / 2048, 0x3c00 },       // halfway, down to even
+        { 1.f + 3.f / 2048, 0x3c02 },       // halfway, up to even
+        { 65504.f, 0x7bff },                // largest half
+        { 65519.f, 0x7bff },
+        { 65520.f, 0x7c00 },                // rounds to infinity
+        { 1e10f, 0x7c00 },
+        { 5.9604645e-8f, 0x0001 },          // smallest subnormal half
+        { 2.9802322e-8f, 0x0000 },          // half of it, down to even
+        { 6.1035156e-5f, 0x0400 },          // smallest normal half
+    };
+
+    for (auto level : { simd_level::scalar, simd_level::avx2 })
+    {
+        unpack_kernels kernels;
+        if (!get_unpack_kernels(level, kernels))
+            continue;
+        INFO("level " << get_string(level));
+
+        // Vertices of depth 1 along the optical axis give the depth scale back in z; 8 of them
+        // fill a vector
+        for (auto& c : cases)
+        {
+            INFO("value " << c.value);
+            std::vector<uint16_t> depth(8, 1);
+            std::vector<float> zeros(8, 0);
+            std::vector<uint16_t> out(8 * 3);
+            uint8_t* dst[] = { reinterpret_cast<uint8_t*>(out.data()) };
+            kernels.deproject_xyz_half(dst, depth.data(), zeros.data(), zeros.data(), 8, c.value);
+            for (int i = 0; i < 8; i++)
+                REQUIRE(out[i * 3 + 2] == c.half);
+        }
+    }
+}
+
+TEST_CASE("SIMD unpack kernels benchmark", "[.][benchmark]")
+{
+    const int count = 1280 * 720;
+    const int iterations = 50;
+
+    std::vector<simd_level> levels = { simd_level::scalar };
+    levels.insert(levels.end(), std::begin(vector_levels), std::end(vector_levels));
+
+    std::cout << "Kernel throughput for 1280x720 frames, GB/s of input and output" << std::endl;
+    std::cout << std::left << std::setw(18) << "format";
+    for (auto level : levels)
+        std::cout << std::setw(10) << get_string(level);
+    std::cout << std::endl;
+
+    for (auto& info : unpackers)
+    {
+        std::vector<uint8_t> src(count * info.src_bytes_num / info.src_bytes_den, 0x80);
+        std::vector<uint8_t> planes[2];
+        uint8_t* dst[2] = { nullptr, nullptr };
+        size_t bytes = src.size();
+        for (int p = 0; p < 2 && info.dst_bytes[p]; p++)
+        {
+            planes[p].resize(count * info.dst_bytes[p]);
+            dst[p] = planes[p].data();
+            bytes += planes[p].size();
+        }
+
+        std::cout << std::setw(18) << info.name;
+        for (auto level : levels)
+        {
+            unpack_kernels kernels;
+            if (!get_unpack_kernels(level, kernels))
+            {
+                std::cout << std::setw(10) << "-";
+                continue;
+            }
+
+            auto kernel = kernels.*info.kernel;
+            kernel(dst, src.data(), count); // warm up
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; i++)
+                kernel(dst, src.data(), count);
+            auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cout << std::setw(10) << std::setprecision(3) << bytes * iterations / elapsed / 1e9;
+        }
+        std::cout << std::endl;
+    }
+
+    std::cout << "selected: " << get_string(get_unpack_kernels().level) << std::endl;
+}
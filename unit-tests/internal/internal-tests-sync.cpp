@@ -0,0 +1,260 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Intel Corporation. All Rights Reserved.
+
+#include "catch/catch.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "./../src/source.h"
+#include "./../src/stream.h"
+#include "./../src/environment.h"
+#include "./../src/proc/syncer-processing-block.h"
+
+using namespace librealsense;
+
+namespace
+{
+    struct trace_stream
+    {
+        rs2_stream type;
+        int fps;
+        double jitter_ms;   // of the timestamps, and again of the arrival times
+        double drop_rate;
+    };
+
+    struct trace_frame
+    {
+        int stream;
+        double timestamp;
+        double arrival;
+        unsigned long long number;  // unique across the trace
+    };
+
+    // Frames of every stream over duration_ms, in order of arrival
+    std::vector<trace_frame> make_trace(const std::vector<trace_stream>& streams, double duration_ms, unsigned int seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<double> unit(0, 1);
+        std::vector<trace_frame> trace;
+        for (int s = 0; s < static_cast<int>(streams.size()); s++)
+        {
+            auto period = 1000. / streams[s].fps;
+            for (double t = 0; t < duration_ms; t += period)
+            {
+                if (unit(rng) < streams[s].drop_rate)
+                    continue;
+                trace_frame f;
+                f.stream = s;
+                f.timestamp = 100 + t + (unit(rng) - 0.5) * streams[s].jitter_ms;
+                f.arrival = f.timestamp + 2 + unit(rng) * streams[s].jitter_ms;
+                trace.push_back(f);
+            }
+        }
+        std::stable_sort(trace.begin(), trace.end(), [](const trace_frame& a, const trace_frame& b) { return a.arrival < b.arrival; });
+        for (size_t i = 0; i < trace.size(); i++)
+            trace[i].number = i;
+        return trace;
+    }
+
+    // The syncer tells inactive streams by the time service a context would have set up
+    bool use_os_time_service()
+    {
+        if (!environment::get_instance().get_time_service())
+            environment::get_instance().set_time_service(std::make_shared<platform::os_time_service>());
+        return true;
+    }
+
+    // Feeds a trace through a syncer, as the pipeline does, and records the framesets it puts out
+    class sync_harness
+    {
+    public:
+        struct frameset
+        {
+            std::vector<unsigned long long> frames;  // trace numbers
+            double arrival;                          // of the frame that completed the set
+        };
+
+        explicit sync_harness(const std::vector<trace_stream>& streams)
+            : _time_service(use_os_time_service()), _source(0)
+        {
+            _source.init(std::make_shared<metadata_parser_map>());
+            for (auto&& s : streams)
+            {
+                auto profile = std::make_shared<video_stream_profile>(platform::stream_profile{ 640, 480, static_cast<uint32_t>(s.fps), 0 });
+                profile->set_stream_type(s.type);
+                profile->set_format(RS2_FORMAT_Z16);
+                profile->set_framerate(s.fps);
+                profile->set_dims(640, 480);
+                profile->set_unique_id(environment::get_instance().generate_stream_id());
+                _profiles.push_back(profile);
+            }
+
+            auto on_frame = [this](frame_interface* f)
+            {
+                frameset set;
+                set.arrival = _now;
+                auto composite = dynamic_cast<composite_frame*>(f);
+                for (size_t i = 0; composite && i < composite->get_embedded_frames_count(); i++)
+                    set.frames.push_back(composite->get_frame(static_cast<int>(i))->get_frame_number());
+                if (!composite)
+                    set.frames.push_back(f->get_frame_number());
+                framesets.push_back(std::move(set));
+                f->release();
+            };
+            _syncer.set_output_callback(std::make_shared<internal_frame_callback<decltype(on_frame)>>(on_frame));
+        }
+
+        void feed(const trace_frame& t)
+        {
+            frame_additional_data data;
+            data.timestamp = t.timestamp;
+            data.frame_number = t.number;
+            data.timestamp_domain = RS2_TIMESTAMP_DOMAIN_HARDWARE_CLOCK;
+            data.system_time = t.arrival;
+
+            auto f = _source.alloc_frame(RS2_EXTENSION_VIDEO_FRAME, 0, data, false);
+            REQUIRE(f);
+            f->set_stream(_profiles[t.stream]);
+            _now = t.arrival;
+            _syncer.invoke(frame_holder(f));
+        }
+
+        std::vector<frameset> framesets;
+
+    private:
+        bool _time_service;
+        frame_source _source;
+        std::vector<std::shared_ptr<stream_profile_interface>> _profiles;
+        syncer_process_unit _syncer;
+        double _now = 0;
+    };
+
+    const std::vector<trace_stream> same_fps = {
+        { RS2_STREAM_DEPTH, 30, 1.0, 0 },
+        { RS2_STREAM_COLOR, 30, 3.0, 0 },
+        { RS2_STREAM_INFRARED, 30, 1.0, 0 },
+    };
+
+    const std::vector<trace_stream> drops = {
+        { RS2_STREAM_DEPTH, 30, 1.0, 0.1 },
+        { RS2_STREAM_COLOR, 30, 3.0, 0.1 },
+        { RS2_STREAM_INFRARED, 30, 1.0, 0.1 },
+    };
+
+    const std::vector<trace_stream> mixed_fps = {
+        { RS2_STREAM_DEPTH, 90, 0.5, 0.02 },
+        { RS2_STREAM_COLOR, 30, 4.0, 0.05 },
+        { RS2_STREAM_INFRARED, 90, 0.5, 0.02 },
+        { RS2_STREAM_FISHEYE, 60, 1.0, 0.02 },
+    };
+}
+
+TEST_CASE("syncer matches frames of the same period", "[code]")
+{
+    for (auto streams : { same_fps, drops, mixed_fps })
+    {
+        auto trace = make_trace(streams, 2000, 3);
+        sync_harness harness(streams);
+        for (auto&& f : trace)
+            harness.feed(f);
+
+        CAPTURE(streams.size());
+        CAPTURE(streams[0].drop_rate);
+        REQUIRE(!harness.framesets.empty());
+
+        std::vector<int> delivered(trace.size(), 0);
+        for (auto&& set : harness.framesets)
+        {
+            std::vector<int> streams_in_set;
+            double first = 1e9, last = -1e9;
+            int slowest_fps = 1000;
+            for (auto number : set.frames)
+            {
+                auto& f = trace[number];
+                delivered[number]++;
+                streams_in_set.push_back(f.stream);
+                first = std::min(first, f.timestamp);
+                last = std::max(last, f.timestamp);
+                slowest_fps = std::min(slowest_fps, streams[f.stream].fps);
+            }
+
+            // One frame per stream, all within half a period of the slowest stream in the set
+            std::sort(streams_in_set.begin(), streams_in_set.end());
+            REQUIRE(std::adjacent_find(streams_in_set.begin(), streams_in_set.end()) == streams_in_set.end());
+            REQUIRE(last - first < 500. / slowest_fps);
+        }
+
+        // Every frame goes out once, apart from the last ones still waiting for their match
+        int pending = 0;
+        for (size_t i = 0; i < trace.size(); i++)
+        {
+            REQUIRE(delivered[i] <= 1);
+            if (!delivered[i])
+            {
+                pending++;
+                REQUIRE(trace[i].arrival > trace.back().arrival - 100);
+            }
+        }
+        REQUIRE(pending <= static_cast<int>(streams.size()) * composite_matcher::SLOT_CAPACITY);
+    }
+}
+
+TEST_CASE("syncer waits for a frame of every stream when none drop", "[code]")
+{
+    auto trace = make_trace(same_fps, 2000, 5);
+    sync_harness harness(same_fps);
+    for (auto&& f : trace)
+        harness.feed(f);
+
+    // A stream is only waited for once its first frame came in, so the first framesets may be partial
+    REQUIRE(harness.framesets.size() >= 60);
+    for (size_t i = same_fps.size(); i < harness.framesets.size(); i++)
+    {
+        CAPTURE(i);
+        REQUIRE(harness.framesets[i].frames.size() == same_fps.size());
+    }
+}
+
+TEST_CASE("syncer benchmark", "[.][benchmark]")
+{
+    struct scenario { const char* name; std::vector<trace_stream> streams; };
+    const scenario scenarios[] = {
+        { "3 streams, 30 fps", same_fps },
+        { "3 streams, drops", drops },
+        { "4 streams, mixed fps", mixed_fps },
+    };
+
+    std::cout << std::left << std::setw(24) << "trace" << std::setw(12) << "framesets"
+        << std::setw(14) << "us/frameset" << std::setw(16) << "mean wait ms" << std::setw(16) << "max wait ms" << std::endl;
+
+    for (auto&& s : scenarios)
+    {
+        auto trace = make_trace(s.streams, 60000, 11);
+        sync_harness harness(s.streams);
+
+        auto start = std::chrono::steady_clock::now();
+        for (auto&& f : trace)
+            harness.feed(f);
+        auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+        // Time the frames of a set spent in the syncer, from the first of them to arrive
+        double total_wait = 0, max_wait = 0;
+        for (auto&& set : harness.framesets)
+        {
+            double first = set.arrival;
+            for (auto number : set.frames)
+                first = std::min(first, trace[number].arrival);
+            total_wait += set.arrival - first;
+            max_wait = std::max(max_wait, set.arrival - first);
+        }
+
+        auto sets = std::max<size_t>(1, harness.framesets.size());
+        std::cout << std::setw(24) << s.name << std::setw(12) << harness.framesets.size()
+            << std::setw(14) << std::setprecision(3) << elapsed / sets
+            << std::setw(16) << total_wait / sets << std::setw(16) << max_wait << std::endl;
+    }
+}
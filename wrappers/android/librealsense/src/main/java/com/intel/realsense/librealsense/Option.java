@@ -72,7 +72,9 @@ public enum Option {
     INVALIDATION_BYPASS(68),
     AMBIENT_LIGHT(69),
     SENSOR_MODE(70),
-    EMITTER_ALWAYS_ON(71);
+    EMITTER_ALWAYS_ON(71),
+    PROCESSING_THREADS(72),
+    OCCLUSION_MASK(73);
 
     private final int mValue;
 
@@ -29,7 +29,8 @@ public enum StreamFormat {
     INZI(25),
     INVI(26),
     W10(27),
-    Z16H(28);
+    Z16H(28),
+    Z16C(29);
     private final int mValue;
 
     private StreamFormat(int value) { mValue = value; }
@@ -125,6 +125,8 @@ enum class ERealSenseOptionType : uint8
     AMBIENT_LIGHT                              , /**< Change the depth ambient light see rs2_ambient_light for values */
     SENSOR_MODE                                , /**< The resolution mode: see rs2_sensor_mode for values */
     EMITTER_ALWAYS_ON                          , /**< Enable Laser On constantly (GS SKU Only) */
+    PROCESSING_THREADS                         , /**< Maximum number of threads a processing block may use on a single frame */
+    OCCLUSION_MASK                             , /**< Output the mask of the pixels the pointcloud occlusion removal invalidated */
 };
 
 UENUM(Blueprintable)